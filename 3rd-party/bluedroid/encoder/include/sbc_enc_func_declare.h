@@ -41,6 +41,8 @@ extern void sbc_enc_bit_alloc_mono(SBC_ENC_PARAMS *CodecParams);
 extern void sbc_enc_bit_alloc_ste(SBC_ENC_PARAMS *CodecParams);
 
 extern void SbcAnalysisInit (void);
+extern void SbcAnalysisSaveState (SINT16 *ps16History, SINT16 *ps16ShiftCounter);
+extern void SbcAnalysisRestoreState (const SINT16 *ps16History, SINT16 s16ShiftCounter);
 
 extern void SbcAnalysisFilter4(SBC_ENC_PARAMS *strEncParams);
 extern void SbcAnalysisFilter8(SBC_ENC_PARAMS *strEncParams);
@@ -1106,3 +1106,16 @@ void SbcAnalysisInit (void)
     memset(s16X,0,ENC_VX_BUFFER_SIZE*sizeof(SINT16));
     ShiftCounter=0;
 }
+
+/* BTstack: save/restore analysis filter history to support multiple encoder instances */
+void SbcAnalysisSaveState (SINT16 *ps16History, SINT16 *ps16ShiftCounter)
+{
+    memcpy(ps16History,s16X,ENC_VX_BUFFER_SIZE*sizeof(SINT16));
+    *ps16ShiftCounter=ShiftCounter;
+}
+
+void SbcAnalysisRestoreState (const SINT16 *ps16History, SINT16 s16ShiftCounter)
+{
+    memcpy(s16X,ps16History,ENC_VX_BUFFER_SIZE*sizeof(SINT16));
+    ShiftCounter=s16ShiftCounter;
+}
@@ -67,6 +67,16 @@
 static int send_download_command;
 static uint32_t init_script_offset;
 
+// Write RAM commands can be sent without waiting for the previous one, Download Minidriver and Launch RAM cannot
+#define BCM_OPCODE_WRITE_RAM 0xfc4c
+
+static btstack_chipset_result_t chipset_command_result(const uint8_t * hci_cmd_buffer){
+    if (little_endian_read_16(hci_cmd_buffer, 0) == BCM_OPCODE_WRITE_RAM){
+        return BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED;
+    }
+    return BTSTACK_CHIPSET_VALID_COMMAND;
+}
+
 // Embedded == non posix systems
 
 // actual init script provided by separate bt_firmware_image.c from WICED SDK
@@ -167,7 +177,7 @@ static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
         init_script_offset += param_len;
 
     } while (memcmp(hci_cmd_buffer, download_command, sizeof(download_command)) == 1);
-    return BTSTACK_CHIPSET_VALID_COMMAND;
+    return chipset_command_result(hci_cmd_buffer);
 }
 
 void btstack_chipset_bcm_set_hcd_file_path(const char * path){
@@ -256,10 +266,34 @@ void btstack_chipset_bcm_set_device_name(const char * device_name){
 
 #else
 
+static int init_script_valid;
+
+// walk patchram once: every command must fit into it
+static int init_script_validate(void){
+    uint32_t offset = 0;
+    uint32_t num_commands = 0;
+    while (offset < brcm_patch_ram_length){
+        if (offset + 3 > brcm_patch_ram_length){
+            log_error("chipset-bcm: init script truncated command header at offset %u", (unsigned int) offset);
+            return 0;
+        }
+        uint32_t cmd_len = 3 + brcm_patchram_buf[offset+2];
+        if (offset + cmd_len > brcm_patch_ram_length){
+            log_error("chipset-bcm: init script truncated command at offset %u", (unsigned int) offset);
+            return 0;
+        }
+        offset += cmd_len;
+        num_commands++;
+    }
+    log_info("chipset-bcm: init script with %u commands", (unsigned int) num_commands);
+    return 1;
+}
+
 static void chipset_init(const void * config){
     log_info("chipset-bcm: init script %s, len %u", brcm_patch_version, brcm_patch_ram_length);
     init_script_offset = 0;
     send_download_command = 1;
+    init_script_valid = init_script_validate();
 }
 
 static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
@@ -272,7 +306,8 @@ static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
         return BTSTACK_CHIPSET_VALID_COMMAND;
     }
 
-    if (init_script_offset >= brcm_patch_ram_length) {
+    // don't upload parts of an invalid init script
+    if (!init_script_valid || init_script_offset >= brcm_patch_ram_length) {
         
         // It takes up to 2 ms for the BCM to raise its RTS line
         // If we send the next command right away, the raise of the RTS will fall happen during
@@ -286,7 +321,7 @@ static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
     int cmd_len = 3 + brcm_patchram_buf[init_script_offset+2];
     memcpy(&hci_cmd_buffer[0], &brcm_patchram_buf[init_script_offset], cmd_len); 
     init_script_offset += cmd_len;
-    return BTSTACK_CHIPSET_VALID_COMMAND;     
+    return chipset_command_result(hci_cmd_buffer);
 }
 #endif
 
@@ -49,9 +49,16 @@
 #include "bluetooth.h"
 #include "btstack_debug.h"
 #include "btstack_chipset.h"
+#include "btstack_run_loop.h"
+
+// max number of Write RAM commands in flight, further limited by Num_HCI_Command_Packets
+#ifndef BCM_DOWNLOAD_FIRMWARE_MAX_CMDS_IN_FLIGHT
+#define BCM_DOWNLOAD_FIRMWARE_MAX_CMDS_IN_FLIGHT 4
+#endif
 
 static void bcm_send_hci_baudrate(void);
-static void bcm_send_next_init_script_command(void);
+static void bcm_start_init_script(void);
+static void bcm_init_script_run(void);
 static void bcm_set_local_baudrate(void);
 static void bcm_w4_command_complete(void);
 
@@ -67,6 +74,23 @@ static const uint8_t hci_reset_cmd[] = { 0x03, 0x0c, 0x00 };
 static void (*download_complete)(int result);
 static int baudrate;
 
+// init script upload
+static int      init_script_cmds_in_flight;
+static int      init_script_cmds_allowed;
+static int      init_script_cmd_prepared;
+static btstack_chipset_result_t init_script_cmd_result;
+static int      init_script_cmd_sending;
+static int      init_script_done;
+static uint32_t init_script_cmds_num;
+static uint32_t phase_start_ms;
+
+// log duration of download phase and start next one
+static void bcm_phase_done(const char * phase){
+    uint32_t now = btstack_run_loop_get_time_ms();
+    log_info("bcm: %s took %u ms", phase, (unsigned int) (now - phase_start_ms));
+    phase_start_ms = now;
+}
+
 static void bcm_send_prepared_command(void){
     uart_driver->receive_block(&response_buffer[0], hci_command_complete_len);
     int size = 1 + 3 + command_buffer[3];
@@ -89,6 +113,7 @@ static void bcm_send_hci_reset(void){
 
 static void bcm_send_hci_baudrate(void){
     hci_dump_packet(HCI_EVENT_PACKET, 0, &response_buffer[1], hci_command_complete_len-1);
+    bcm_phase_done("reset");
     chipset->set_baudrate_command(baudrate, &command_buffer[1]);
     uart_driver->set_block_received(&bcm_set_local_baudrate);
     uart_driver->receive_block(&response_buffer[0], hci_command_complete_len);
@@ -99,33 +124,95 @@ static void bcm_send_hci_baudrate(void){
 static void bcm_set_local_baudrate(void){
     hci_dump_packet(HCI_EVENT_PACKET, 0, &response_buffer[1], hci_command_complete_len-1);
     uart_driver->set_baudrate(baudrate);
-    uart_driver->set_block_received(&bcm_w4_command_complete);
-    bcm_send_next_init_script_command();
+    bcm_phase_done("baud rate change");
+    bcm_start_init_script();
 }
 
 static void bcm_w4_command_complete(void){
     hci_dump_packet(HCI_EVENT_PACKET, 0, &response_buffer[1], hci_command_complete_len-1);
-    bcm_send_next_init_script_command();
+    bcm_phase_done("reset");
+    bcm_start_init_script();
+}
+
+static void bcm_w4_init_script_command_complete(void){
+    hci_dump_packet(HCI_EVENT_PACKET, 0, &response_buffer[1], hci_command_complete_len-1);
+    init_script_cmds_in_flight--;
+    // Num_HCI_Command_Packets, 0 is treated as 1 as we did before
+    init_script_cmds_allowed = btstack_max(1, btstack_min(response_buffer[3], BCM_DOWNLOAD_FIRMWARE_MAX_CMDS_IN_FLIGHT));
+    // receive is only active while commands are in flight
+    if (init_script_cmds_in_flight > 0){
+        uart_driver->receive_block(&response_buffer[0], hci_command_complete_len);
+    }
+    bcm_init_script_run();
+}
+
+static void bcm_init_script_command_sent(void){
+    init_script_cmd_sending = 0;
+    bcm_init_script_run();
+}
+
+static void bcm_start_init_script(void){
+    init_script_cmds_in_flight = 0;
+    init_script_cmds_allowed   = 1;
+    init_script_cmd_prepared   = 0;
+    init_script_cmd_sending    = 0;
+    init_script_done           = 0;
+    init_script_cmds_num       = 0;
+    uart_driver->set_block_received(&bcm_w4_init_script_command_complete);
+    uart_driver->set_block_sent(&bcm_init_script_command_sent);
+    bcm_init_script_run();
 }
 
-static void bcm_send_next_init_script_command(void){
-    int res = chipset->next_command(&command_buffer[1]);
-    switch (res){
-        case BTSTACK_CHIPSET_VALID_COMMAND:
-            bcm_send_prepared_command();
-            break;
-        case BTSTACK_CHIPSET_DONE:
-            log_info("bcm: init script done");
-            // disable init script for main startup
-            btstack_chipset_bcm_enable_init_script(0);
-            // reset baudreate to default
-            uart_driver->set_baudrate(115200);
-            // notify main
-            download_complete(0);
-            break;
-        default:
-            break;
-    } 
+// keep Write RAM commands in flight as allowed by the controller, other commands wait for all previous ones
+static void bcm_init_script_run(void){
+    if (init_script_cmd_sending) return;
+
+    if (!init_script_cmd_prepared && !init_script_done){
+        init_script_cmd_result = chipset->next_command(&command_buffer[1]);
+        switch (init_script_cmd_result){
+            case BTSTACK_CHIPSET_VALID_COMMAND:
+            case BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED:
+                init_script_cmd_prepared = 1;
+                break;
+            default:
+                init_script_done = 1;
+                break;
+        }
+    }
+
+    if (init_script_cmd_prepared){
+        int pipelined = init_script_cmd_result == BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED;
+        if (!pipelined && init_script_cmds_in_flight > 0) return;
+        if (init_script_cmds_in_flight >= init_script_cmds_allowed) return;
+        if (!pipelined){
+            // no other command until this one is complete
+            init_script_cmds_allowed = 1;
+        }
+        if (init_script_cmds_in_flight == 0){
+            uart_driver->receive_block(&response_buffer[0], hci_command_complete_len);
+        }
+        init_script_cmd_prepared = 0;
+        init_script_cmd_sending  = 1;
+        init_script_cmds_in_flight++;
+        init_script_cmds_num++;
+        int size = 1 + 3 + command_buffer[3];
+        command_buffer[0] = 1;
+        hci_dump_packet(HCI_COMMAND_DATA_PACKET, 0, &command_buffer[1], size-1);
+        uart_driver->send_block(command_buffer, size);
+        return;
+    }
+
+    if (!init_script_done || init_script_cmds_in_flight > 0) return;
+
+    log_info("bcm: init script done, %u commands", (unsigned int) init_script_cmds_num);
+    bcm_phase_done("init script");
+    uart_driver->set_block_sent(NULL);
+    // disable init script for main startup
+    btstack_chipset_bcm_enable_init_script(0);
+    // reset baudreate to default
+    uart_driver->set_baudrate(115200);
+    // notify main
+    download_complete(0);
 }
 
 /**
@@ -149,5 +236,6 @@ void btstack_chipset_bcm_download_firmware(const btstack_uart_block_t * the_uart
         return;
     }
 
+    phase_start_ms = btstack_run_loop_get_time_ms();
     bcm_send_hci_reset();
 }
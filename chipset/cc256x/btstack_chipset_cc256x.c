@@ -65,6 +65,7 @@
 #include "btstack_chipset_cc256x.h"
 #include "btstack_debug.h"
 
+#include <inttypes.h>
 #include <stddef.h>   /* NULL */
 #include <stdio.h> 
 #include <string.h>   /* memcpy */
@@ -99,6 +100,9 @@ static int16_t    init_power_in_dB    = 13; // 13 dBm
 // upload position
 static uint32_t   init_script_offset  = 0;
 
+// init script has been validated
+static int        init_script_valid;
+
 // support for SCO over HCI
 #ifdef ENABLE_SCO_OVER_HCI
 static int      init_send_route_sco_over_hci = 0;
@@ -159,6 +163,34 @@ static const uint8_t hci_route_sco_over_hci[] = {
 };
 #endif
 
+#if !(defined(__GNUC__) && defined(__MSP430X__) && (__MSP430X__ > 0)) && !defined(__AVR__)
+// walk init script once: every command must start with packet type 0x01 and fit into the script,
+// then chipset_next_command can copy each command with a single memcpy
+static int init_script_validate(void){
+    uint32_t offset = 0;
+    uint32_t init_script_num_commands = 0;
+    while (offset < init_script_size){
+        if (init_script[offset] != 0x01){
+            log_error("cc256x: init script invalid packet type 0x%02x at offset %"PRIu32, init_script[offset], offset);
+            return 0;
+        }
+        if (offset + 4 > init_script_size){
+            log_error("cc256x: init script truncated command header at offset %"PRIu32, offset);
+            return 0;
+        }
+        uint32_t cmd_len = 3 + init_script[offset + 3];
+        if (offset + 1 + cmd_len > init_script_size){
+            log_error("cc256x: init script truncated command at offset %"PRIu32, offset);
+            return 0;
+        }
+        offset += 1 + cmd_len;
+        init_script_num_commands++;
+    }
+    log_info("cc256x: init script with %"PRIu32" commands, %"PRIu32" bytes", init_script_num_commands, init_script_size);
+    return 1;
+}
+#endif
+
 static void chipset_init(const void * config){
     init_script_offset = 0;
 #if defined(__GNUC__) && defined(__MSP430X__) && (__MSP430X__ > 0)
@@ -175,6 +207,12 @@ static void chipset_init(const void * config){
         init_script_size = cc256x_init_script_size;
     }
 #endif
+#if (defined(__GNUC__) && defined(__MSP430X__) && (__MSP430X__ > 0)) || defined(__AVR__)
+    // init script in far/program memory cannot be validated upfront
+    init_script_valid = 1;
+#else
+    init_script_valid = init_script_validate();
+#endif
 #ifdef ENABLE_SCO_OVER_HCI
     init_send_route_sco_over_hci = 1;
 #endif
@@ -300,7 +338,8 @@ static void update_init_script_command(uint8_t *hci_cmd_buffer){
 }
 
 static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
-    if (init_script_offset >= init_script_size) {
+    // don't upload parts of an invalid init script
+    if (!init_script_valid || init_script_offset >= init_script_size) {
 
 #ifdef ENABLE_SCO_OVER_HCI
         // append send route SCO over HCI if requested
@@ -336,12 +375,10 @@ static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
 
 #else    
 
-    // use memcpy with pointer
-    uint8_t * init_script_ptr = (uint8_t*) &init_script[0];
-    memcpy(&hci_cmd_buffer[0], init_script_ptr + init_script_offset, 3);  // cmd header
+    // use memcpy with pointer, command fits into init script as it has been validated
+    int payload_len = init_script[init_script_offset + 2];
+    memcpy(&hci_cmd_buffer[0], &init_script[init_script_offset], 3 + payload_len);  // cmd header + payload
     init_script_offset += 3;
-    int payload_len = hci_cmd_buffer[2];
-    memcpy(&hci_cmd_buffer[3], init_script_ptr + init_script_offset, payload_len);  // cmd payload
 
 #endif
 
@@ -350,7 +387,11 @@ static btstack_chipset_result_t chipset_next_command(uint8_t * hci_cmd_buffer){
     // control power commands and ehcill 
     update_init_script_command(hci_cmd_buffer);
 
-    return BTSTACK_CHIPSET_VALID_COMMAND; 
+    // controller processes init script commands in order, only a baud rate change has to complete first
+    if (little_endian_read_16(hci_cmd_buffer, 0) == 0xFF36){
+        return BTSTACK_CHIPSET_VALID_COMMAND;
+    }
+    return BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED; 
 }
 
 
@@ -33,6 +33,7 @@ apis = [
     ["src/btstack_control.h","BTstack Hardware Control","btControl"],
     ["src/btstack_event.h","HCI Event Getter","btEvent"],
     ["src/btstack_memory.h","BTstack Memory Management","btMemory"],
+    ["src/btstack_latency_trace.h","BTstack Latency Trace","btLatencyTrace"],
     ["src/btstack_linked_list.h","BTstack Linked List","btList"],
     ["src/btstack_run_loop.h", "Run Loop", "runLoop"],
     ["src/btstack_util.h", "Common Utils", "btUtil"],
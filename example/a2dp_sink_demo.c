@@ -75,12 +75,11 @@
 #endif
 
 #ifdef HAVE_AUDIO_DMA
-#include "btstack_ring_buffer.h"
 #include "hal_audio_dma.h"
 #endif
 
 #ifdef HAVE_PORTAUDIO
-#include "btstack_ring_buffer.h"
+#include "btstack_spsc_ring_buffer.h"
 #include <portaudio.h>
 #endif
 
@@ -90,13 +89,13 @@
 #define STORE_SBC_TO_WAV_FILE 
 #endif
 
-#if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE) || defined(HAVE_AUDIO_DMA)
+// with HAVE_AUDIO_DMA, the SBC decoder is used by the A2DP Sink media engine
+#if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE)
 #define DECODE_SBC
 #endif
 
 #define NUM_CHANNELS 2
 #define BYTES_PER_FRAME     (2*NUM_CHANNELS)
-#define MAX_SBC_FRAME_SIZE 120
 
 // SBC Decoder for WAV file or PortAudio
 #ifdef DECODE_SBC
@@ -108,26 +107,20 @@ static btstack_sbc_mode_t mode = SBC_MODE_STANDARD;
 #define PREBUFFER_MS        200
 static int audio_stream_started = 0;
 static int audio_stream_paused = 0;
-static btstack_ring_buffer_t ring_buffer;
 #endif
 
 #ifdef HAVE_AUDIO_DMA
-// below 30: add samples, 30-40: fine, above 40: drop samples
-#define OPTIMAL_FRAMES_MIN 30
-#define OPTIMAL_FRAMES_MAX 40
-#define ADDITIONAL_FRAMES  10
+// SBC frames are buffered by the media engine, which also compensates the clock drift
+#define JITTER_BUFFER_FRAMES 64
 #define DMA_AUDIO_FRAMES 128
-#define DMA_MAX_FILL_FRAMES 1
 #define NUM_AUDIO_BUFFERS 2
 static void hal_audio_dma_process(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type);
-static uint16_t audio_samples[(DMA_AUDIO_FRAMES + DMA_MAX_FILL_FRAMES)*2*NUM_AUDIO_BUFFERS];
-static uint16_t audio_samples_len[NUM_AUDIO_BUFFERS];
-static uint8_t ring_buffer_storage[(OPTIMAL_FRAMES_MAX + ADDITIONAL_FRAMES) * MAX_SBC_FRAME_SIZE];
+static uint16_t audio_samples[DMA_AUDIO_FRAMES*2*NUM_AUDIO_BUFFERS];
+static uint8_t jitter_buffer_storage[A2DP_SINK_MEDIA_ENGINE_STORAGE_SIZE(JITTER_BUFFER_FRAMES)];
+static a2dp_sink_media_engine_t media_engine;
 static const uint16_t silent_buffer[DMA_AUDIO_FRAMES*2];
 static volatile int playback_buffer;
 static int write_buffer;
-static uint8_t sbc_frame_size;
-static int sbc_samples_fix;
 #endif
 
 // PortAudio - live playback
@@ -137,6 +130,8 @@ static int sbc_samples_fix;
 #define FRAMES_PER_BUFFER   128
 #define PREBUFFER_BYTES     (PREBUFFER_MS*SAMPLE_RATE/1000*BYTES_PER_FRAME)
 static PaStream * stream;
+// written by main thread, read by PortAudio thread; size gets rounded down to power of two
+static btstack_spsc_ring_buffer_t ring_buffer;
 static uint8_t ring_buffer_storage[2*PREBUFFER_BYTES];
 #endif
 
@@ -244,7 +239,7 @@ static void handle_l2cap_media_data_packet(uint8_t seid, uint8_t *packet, uint16
 #ifdef HAVE_BTSTACK_STDIN
 static void stdin_process(char cmd);
 #endif
-#if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE) || defined(HAVE_AUDIO_DMA)
+#if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE)
 static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context);
 #endif
 
@@ -295,6 +290,8 @@ static int a2dp_sink_and_avrcp_services_init(void){
     gap_set_class_of_device(0x200408);
 
 #ifdef HAVE_AUDIO_DMA
+    a2dp_sink_media_engine_init(&media_engine, jitter_buffer_storage, sizeof(jitter_buffer_storage));
+
     static btstack_data_source_t hal_audio_dma_data_source;
     // Set up polling data source.
     btstack_run_loop_set_data_source_handler(&hal_audio_dma_data_source, &hal_audio_dma_process);
@@ -330,7 +327,7 @@ static int portaudio_callback( const void *inputBuffer, void *outputBuffer,
 
     // fill ring buffer with silence while stream is paused
     if (audio_stream_paused){
-        if (btstack_ring_buffer_bytes_available(&ring_buffer) < PREBUFFER_BYTES){
+        if (btstack_spsc_ring_buffer_bytes_available(&ring_buffer) < PREBUFFER_BYTES){
             memset(outputBuffer, 0, bytes_to_copy);
             return 0;
         } else {
@@ -340,8 +337,7 @@ static int portaudio_callback( const void *inputBuffer, void *outputBuffer,
     }
 
     // get data from ring buffer
-    uint32_t bytes_read = 0;
-    btstack_ring_buffer_read(&ring_buffer, outputBuffer, bytes_to_copy, &bytes_read);
+    uint32_t bytes_read = btstack_spsc_ring_buffer_read(&ring_buffer, outputBuffer, bytes_to_copy);
     bytes_to_copy -= bytes_read;
 
     // fill ring buffer  with silence if there are not enough bytes to copy
@@ -376,12 +372,12 @@ void hal_audio_dma_done(void){
 		// start playing silence
 		audio_stream_paused = 1;
 		hal_audio_dma_play((const uint8_t *) silent_buffer, DMA_AUDIO_FRAMES*4);
-		printf("%6u - paused - bytes in buffer %"PRIu32"\n", (int) btstack_run_loop_get_time_ms(), btstack_ring_buffer_bytes_available(&ring_buffer));
+		printf("%6u - paused\n", (int) btstack_run_loop_get_time_ms());
 		return;
 	}
 	playback_buffer = next_playback_buffer;
 	playback_data = start_of_buffer(playback_buffer);
-	hal_audio_dma_play(playback_data, audio_samples_len[playback_buffer]);
+	hal_audio_dma_play(playback_data, DMA_AUDIO_FRAMES*4);
     // btstack_run_loop_embedded_trigger();
 }
 #endif
@@ -394,23 +390,18 @@ static void hal_audio_dma_process(btstack_data_source_t * ds, btstack_data_sourc
 
 	if (!media_initialized) return;
 
+	// media engine provides silence until enough audio is buffered
 	int trigger_resume = 0;
 	if (audio_stream_paused) {
-		if (sbc_frame_size && btstack_ring_buffer_bytes_available(&ring_buffer) >= OPTIMAL_FRAMES_MIN * sbc_frame_size){
-			trigger_resume = 1;
-			// reset buffers
-			playback_buffer = NUM_AUDIO_BUFFERS - 1;
-			write_buffer = 0;
-		} else {
-			return;
-		}
+		trigger_resume = 1;
+		// reset buffers
+		playback_buffer = NUM_AUDIO_BUFFERS - 1;
+		write_buffer = 0;
 	}
 
-	while (playback_buffer != write_buffer && btstack_ring_buffer_bytes_available(&ring_buffer) >= sbc_frame_size ){
-		uint8_t frame[MAX_SBC_FRAME_SIZE];
-	    uint32_t bytes_read = 0;
-	    btstack_ring_buffer_read(&ring_buffer, frame, sbc_frame_size, &bytes_read);
-	    btstack_sbc_decoder_process_data(&state, 0, frame, sbc_frame_size);
+	while (playback_buffer != write_buffer){
+		a2dp_sink_media_engine_read_pcm(&media_engine, (int16_t *) start_of_buffer(write_buffer), DMA_AUDIO_FRAMES);
+		write_buffer = next_buffer(write_buffer);
 	}
 
 	if (trigger_resume){
@@ -474,6 +465,7 @@ static int media_processing_init(avdtp_media_codec_configuration_sbc_t configura
     printf("PortAudio: stream opened\n");
 #endif
 #ifdef HAVE_AUDIO_DMA
+    a2dp_sink_media_engine_start(&media_engine);
     audio_stream_paused  = 1;
     hal_audio_dma_init(configuration.sampling_frequency);
     hal_audio_dma_set_audio_played(&hal_audio_dma_done);
@@ -481,9 +473,11 @@ static int media_processing_init(avdtp_media_codec_configuration_sbc_t configura
     hal_audio_dma_done();
 #endif
 
- #if defined(HAVE_PORTAUDIO) || defined (HAVE_AUDIO_DMA)
+#ifdef HAVE_PORTAUDIO
     memset(ring_buffer_storage, 0, sizeof(ring_buffer_storage));
-    btstack_ring_buffer_init(&ring_buffer, ring_buffer_storage, sizeof(ring_buffer_storage));
+    btstack_spsc_ring_buffer_init(&ring_buffer, ring_buffer_storage, sizeof(ring_buffer_storage));
+#endif
+#if defined(HAVE_PORTAUDIO) || defined (HAVE_AUDIO_DMA)
     audio_stream_started = 0;
     audio_stream_paused = 1;
 #endif 
@@ -537,6 +531,7 @@ static void media_processing_close(void){
 
 #ifdef HAVE_AUDIO_DMA
     hal_audio_dma_close();
+    a2dp_sink_media_engine_stop(&media_engine);
 #endif
 }
 
@@ -556,6 +551,19 @@ static int read_sbc_header(uint8_t * packet, int size, int * offset, avdtp_sbc_c
 static void handle_l2cap_media_data_packet(uint8_t seid, uint8_t *packet, uint16_t size){
     UNUSED(seid);
     int pos = 0;
+
+#ifdef HAVE_AUDIO_DMA
+    // jitter buffer, decoding and drift compensation
+    a2dp_sink_media_engine_handle_media_packet(&media_engine, packet, size);
+
+    static int media_packet_count = 0;
+    if (++media_packet_count % 100 == 0){
+        a2dp_sink_media_engine_stats_t stats;
+        a2dp_sink_media_engine_get_stats(&media_engine, &stats);
+        printf("%6u - fill %3u ms, target %3u ms, drift %+d ppm, late %u, underruns %u\n", (int) btstack_run_loop_get_time_ms(),
+            stats.fill_level_ms, stats.target_latency_ms, (int) stats.drift_ppm, (int) stats.num_frames_late, (int) stats.num_underruns);
+    }
+#endif
     
     avdtp_media_packet_header_t media_header;
     if (!read_media_data_header(packet, size, &pos, &media_header)) return;
@@ -563,32 +571,10 @@ static void handle_l2cap_media_data_packet(uint8_t seid, uint8_t *packet, uint16
     avdtp_sbc_codec_header_t sbc_header;
     if (!read_sbc_header(packet, size, &pos, &sbc_header)) return;
 
-#ifdef HAVE_AUDIO_DMA
-    // store sbc frame size for buffer management
-    sbc_frame_size = (size-pos)/ sbc_header.num_frames;
-#endif
-    
 #if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE)
     btstack_sbc_decoder_process_data(&state, 0, packet+pos, size-pos);
 #endif
 
-#ifdef HAVE_AUDIO_DMA
-    btstack_ring_buffer_write(&ring_buffer,  packet+pos, size-pos);
-
-    // decide on audio sync drift based on number of sbc frames in queue
-    int sbc_frames_in_buffer = btstack_ring_buffer_bytes_available(&ring_buffer) / sbc_frame_size;
-    if (sbc_frames_in_buffer < OPTIMAL_FRAMES_MIN){
-    	sbc_samples_fix = 1;	// duplicate last sample
-    } else if (sbc_frames_in_buffer <= OPTIMAL_FRAMES_MAX){
-    	sbc_samples_fix = 0;	// nothing to do
-    } else {
-    	sbc_samples_fix = -1;	// drop last sample
-    }
-
-    // dump
-    printf("%6u %03u %d\n",  (int) btstack_run_loop_get_time_ms(), sbc_frames_in_buffer, sbc_samples_fix);
-#endif
-
 #ifdef STORE_SBC_TO_SBC_FILE
     fwrite(packet+pos, size-pos, 1, sbc_file);
 #endif
@@ -600,7 +586,7 @@ static void handle_l2cap_media_data_packet(uint8_t seid, uint8_t *packet, uint16
  * The PCM data are bufferd in a ring buffer.
  * Aditionally, tha audio data can be stored in the avdtp_sink.wav file. 
  */
-#if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE) || defined(HAVE_AUDIO_DMA) 
+#if defined(HAVE_PORTAUDIO) || defined(STORE_SBC_TO_WAV_FILE)
 static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context){
     UNUSED(sample_rate);
     UNUSED(context);
@@ -612,7 +598,7 @@ static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, i
 
 #ifdef HAVE_PORTAUDIO
     // store pcm samples in ring buffer
-    btstack_ring_buffer_write(&ring_buffer, (uint8_t *)data, num_samples*num_channels*2);
+    btstack_spsc_ring_buffer_write(&ring_buffer, (uint8_t *)data, num_samples*num_channels*2);
 
     if (!audio_stream_started){
         audio_stream_paused  = 1;
@@ -625,25 +611,6 @@ static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, i
         audio_stream_started = 1; 
     }
 #endif
-
-#ifdef HAVE_AUDIO_DMA
-    // store in ring buffer
-    uint8_t * write_data = start_of_buffer(write_buffer);
-    uint16_t len = num_samples*num_channels*2;
-    memcpy(write_data, data, len);
-    audio_samples_len[write_buffer] = len;
-
-    // add/drop audio frame to fix drift
-    if (sbc_samples_fix > 0){
-        memcpy(write_data + len, write_data + len - 4, 4);
-        audio_samples_len[write_buffer] += 4;
-    }
-    if (sbc_samples_fix < 0){
-        audio_samples_len[write_buffer] -= 4;
-    }
-
-    write_buffer = next_buffer(write_buffer);
-#endif
 }
 #endif
 
@@ -78,7 +78,8 @@
 #define AUDIO_TIMEOUT_MS            10 
 #define TABLE_SIZE_441HZ            100
 
-#define SBC_STORAGE_SIZE 1030
+// PCM ring buffer size must be a power of two, 16 kB hold 93 ms of audio
+#define PCM_STORAGE_SIZE            16384
 
 typedef enum {
     STREAM_SINE = 0,
@@ -94,14 +95,11 @@ typedef struct {
 
     uint32_t time_audio_data_sent; // ms
     uint32_t acc_num_missed_samples;
-    uint32_t samples_ready;
     btstack_timer_source_t audio_timer;
     uint8_t  streaming;
-    int      max_media_payload_size;
-    
-    uint8_t  sbc_storage[SBC_STORAGE_SIZE];
-    uint16_t sbc_storage_count;
-    uint8_t  sbc_ready_to_send;
+
+    a2dp_source_pipeline_t pipeline;
+    uint8_t  pcm_storage[PCM_STORAGE_SIZE];
 } a2dp_media_sending_context_t;
 
 static  uint8_t media_sbc_codec_capabilities[] = {
@@ -251,6 +249,7 @@ static int a2dp_source_and_avrcp_services_init(void){
         return 1;
     }
     media_tracker.local_seid = avdtp_local_seid(local_stream_endpoint);
+    a2dp_source_pipeline_init(&media_tracker.pipeline, media_tracker.pcm_storage, sizeof(media_tracker.pcm_storage));
 
     // Initialize AVRCP Target.
     avrcp_target_init();
@@ -293,15 +292,6 @@ static int a2dp_source_and_avrcp_services_init(void){
 }
 /* LISTING_END */
 
-static void a2dp_demo_send_media_packet(void){
-    int num_bytes_in_frame = btstack_sbc_encoder_sbc_buffer_length();
-    int bytes_in_storage = media_tracker.sbc_storage_count;
-    uint8_t num_frames = bytes_in_storage / num_bytes_in_frame;
-    a2dp_source_stream_send_media_payload(media_tracker.a2dp_cid, media_tracker.local_seid, media_tracker.sbc_storage, bytes_in_storage, num_frames, 0);
-    media_tracker.sbc_storage_count = 0;
-    media_tracker.sbc_ready_to_send = 0;
-}
-
 static void produce_sine_audio(int16_t * pcm_buffer, int num_samples_to_write){
     int count;
     for (count = 0; count < num_samples_to_write ; count++){
@@ -341,27 +331,15 @@ static void produce_audio(int16_t * pcm_buffer, int num_samples){
 #endif
 }
 
-static int a2dp_demo_fill_sbc_audio_buffer(a2dp_media_sending_context_t * context){
-    // perform sbc encodin
-    int total_num_bytes_read = 0;
-    unsigned int num_audio_samples_per_sbc_buffer = btstack_sbc_encoder_num_audio_frames();
-    while (context->samples_ready >= num_audio_samples_per_sbc_buffer
-        && (context->max_media_payload_size - context->sbc_storage_count) >= btstack_sbc_encoder_sbc_buffer_length()){
-
-        int16_t pcm_frame[256*NUM_CHANNELS];
-
-        produce_audio(pcm_frame, num_audio_samples_per_sbc_buffer);
-        btstack_sbc_encoder_process_data(pcm_frame);
-        
-        uint16_t sbc_frame_size = btstack_sbc_encoder_sbc_buffer_length(); 
-        uint8_t * sbc_frame = btstack_sbc_encoder_sbc_buffer();
-        
-        total_num_bytes_read += num_audio_samples_per_sbc_buffer;
-        memcpy(&context->sbc_storage[context->sbc_storage_count], sbc_frame, sbc_frame_size);
-        context->sbc_storage_count += sbc_frame_size;
-        context->samples_ready -= num_audio_samples_per_sbc_buffer;
+static void a2dp_demo_fill_audio_buffer(a2dp_media_sending_context_t * context, uint32_t num_samples){
+    // the pipeline takes care of SBC encoding, packetization and pacing
+    int16_t pcm_frame[128*NUM_CHANNELS];
+    while (num_samples > 0){
+        uint32_t num_samples_to_write = btstack_min(num_samples, 128);
+        produce_audio(pcm_frame, num_samples_to_write);
+        a2dp_source_pipeline_write_pcm(&context->pipeline, pcm_frame, num_samples_to_write);
+        num_samples -= num_samples_to_write;
     }
-    return total_num_bytes_read;
 }
 
 static void a2dp_demo_audio_timeout_handler(btstack_timer_source_t * timer){
@@ -383,23 +361,12 @@ static void a2dp_demo_audio_timeout_handler(btstack_timer_source_t * timer){
         context->acc_num_missed_samples -= 1000;
     }
     context->time_audio_data_sent = now;
-    context->samples_ready += num_samples;
-
-    if (context->sbc_ready_to_send) return;
 
-    a2dp_demo_fill_sbc_audio_buffer(context);
-
-    if ((context->sbc_storage_count + btstack_sbc_encoder_sbc_buffer_length()) > context->max_media_payload_size){
-        // schedule sending
-        context->sbc_ready_to_send = 1;
-        a2dp_source_stream_endpoint_request_can_send_now(context->a2dp_cid, context->local_seid);
-    }
+    a2dp_demo_fill_audio_buffer(context, num_samples);
 }
 
 static void a2dp_demo_timer_start(a2dp_media_sending_context_t * context){
-    context->max_media_payload_size = btstack_min(a2dp_max_media_payload_size(context->a2dp_cid, context->local_seid), SBC_STORAGE_SIZE);
-    context->sbc_storage_count = 0;
-    context->sbc_ready_to_send = 0;
+    a2dp_source_pipeline_start(&context->pipeline, context->a2dp_cid, context->local_seid, NUM_CHANNELS);
     context->streaming = 1;
     btstack_run_loop_remove_timer(&context->audio_timer);
     btstack_run_loop_set_timer_handler(&context->audio_timer, a2dp_demo_audio_timeout_handler);
@@ -411,10 +378,8 @@ static void a2dp_demo_timer_start(a2dp_media_sending_context_t * context){
 static void a2dp_demo_timer_stop(a2dp_media_sending_context_t * context){
     context->time_audio_data_sent = 0;
     context->acc_num_missed_samples = 0;
-    context->samples_ready = 0;
-    context->streaming = 1;
-    context->sbc_storage_count = 0;
-    context->sbc_ready_to_send = 0;
+    context->streaming = 0;
+    a2dp_source_pipeline_stop(&context->pipeline);
     btstack_run_loop_remove_timer(&context->audio_timer);
 } 
 
@@ -519,7 +484,7 @@ static void a2dp_source_packet_handler(uint8_t packet_type, uint16_t channel, ui
             break;
 
         case A2DP_SUBEVENT_STREAMING_CAN_SEND_MEDIA_PACKET_NOW:
-            a2dp_demo_send_media_packet();
+            a2dp_source_pipeline_handle_can_send_now(&media_tracker.pipeline);
             break;        
 
         case A2DP_SUBEVENT_STREAM_SUSPENDED:
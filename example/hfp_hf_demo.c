@@ -486,6 +486,9 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t * even
                                         break;
                                 }
                                 sco_demo_set_codec(negotiated_codec);
+#ifdef ENABLE_SCO_OVER_HCI
+                                sco_demo_set_audio_engine(hfp_hf_get_audio_engine(acl_handle));
+#endif
                                 hci_request_sco_can_send_now_event();
                             }
                             break;
@@ -59,6 +59,14 @@
 static uint8_t            hid_descriptor[MAX_ATTRIBUTE_VALUE_SIZE];
 static uint16_t           hid_descriptor_len;
 
+// HID Descriptor compiled into report layout
+#define MAX_HID_REPORTS 8
+#define MAX_HID_FIELDS  64
+static btstack_hid_descriptor_layout_t hid_layout;
+static btstack_hid_report_layout_t     hid_layout_reports[MAX_HID_REPORTS];
+static btstack_hid_field_t             hid_layout_fields[MAX_HID_FIELDS];
+static int                             hid_layout_valid;
+
 static uint16_t           hid_control_psm;
 static uint16_t           hid_interrupt_psm;
 
@@ -232,6 +240,8 @@ static void handle_sdp_client_query_result(uint8_t packet_type, uint16_t channel
                                     memcpy(hid_descriptor, descriptor, hid_descriptor_len);
                                     printf("HID Descriptor:\n");
                                     printf_hexdump(hid_descriptor, hid_descriptor_len);
+                                    hid_layout_valid = btstack_hid_descriptor_layout_compile(&hid_layout, hid_descriptor, hid_descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT,
+                                        hid_layout_reports, MAX_HID_REPORTS, hid_layout_fields, MAX_HID_FIELDS) == ERROR_CODE_SUCCESS;
                                 }
                             }                        
                             break;
@@ -266,6 +276,8 @@ static void handle_sdp_client_query_result(uint8_t packet_type, uint16_t channel
  * @section HID Report Handler
  * 
  * @text Use BTstack's compact HID Parser to process incoming HID Report
+ * If the HID Descriptor was compiled into a report layout, fields are extracted from the layout
+ * without walking the descriptor for each report
  * Iterate over all fields and process fields with usage page = 0x07 / Keyboard
  * Check if SHIFT is down and process first character (don't handle multiple key presses)
  * 
@@ -279,7 +291,11 @@ static void hid_host_handle_interrupt_report(const uint8_t * report, uint16_t re
     report++;
     report_len--;
     btstack_hid_parser_t parser;
-    btstack_hid_parser_init(&parser, hid_descriptor, hid_descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT, report, report_len);
+    if (hid_layout_valid){
+        btstack_hid_parser_init_with_layout(&parser, &hid_layout, report, report_len);
+    } else {
+        btstack_hid_parser_init(&parser, hid_descriptor, hid_descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT, report, report_len);
+    }
     int shift = 0;
     uint8_t new_keys[NUM_KEYS];
     memset(new_keys, 0, sizeof(new_keys));
@@ -47,7 +47,6 @@
 #include "btstack_debug.h"
 #include "classic/btstack_sbc.h"
 #include "classic/btstack_cvsd_plc.h"
-#include "classic/hfp_msbc.h"
 #include "classic/hfp.h"
 
 #ifdef HAVE_POSIX_FILE_IO
@@ -94,6 +93,7 @@
 #define CVSD_SAMPLE_RATE        8000
 #define MSBC_SAMPLE_RATE        16000
 #define MSBC_BYTES_PER_FRAME    (2*NUM_CHANNELS)
+#define MAX_NUM_SAMPLES         (16*8)
 
 #if defined(HAVE_PORTAUDIO) && (SCO_DEMO_MODE == SCO_DEMO_MODE_SINE || SCO_DEMO_MODE == SCO_DEMO_MODE_MICROPHONE)
 #define USE_PORTAUDIO
@@ -129,8 +129,9 @@ static int count_sent = 0;
 static int count_received = 0;
 static int negotiated_codec = -1; 
 
-#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
-btstack_sbc_decoder_state_t decoder_state;
+#ifdef ENABLE_SCO_OVER_HCI
+// HFP encodes and decodes via audio engine of the connection, HSP uses CVSD PLC below
+static hfp_audio_engine_t * audio_engine;
 #endif
 
 btstack_cvsd_plc_state_t cvsd_plc_state;
@@ -174,28 +175,27 @@ static void sco_demo_sine_wave_int16_at_8000_hz_little_endian(unsigned int num_s
     }
 }
 
-// 16 kHz samples for mSBC encoder in host endianess
-#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
-static void sco_demo_sine_wave_int16_at_16000_hz_host_endian(unsigned int num_samples, int16_t * data){
-    unsigned int i;
-    for (i=0; i < num_samples; i++){
-        data[i] = sine_int16_at_16000hz[phase++];
-        if (phase >= (sizeof(sine_int16_at_16000hz) / sizeof(int16_t))){
-            phase = 0;
+// samples in host endianess at sample rate of audio engine, keeps its PCM buffer filled
+#ifdef ENABLE_SCO_OVER_HCI
+static void sco_demo_audio_engine_fill_sine_wave(void){
+    unsigned int step = (hfp_audio_engine_sample_rate(audio_engine) == MSBC_SAMPLE_RATE) ? 1 : 2;
+    int num_samples = btstack_ring_buffer_bytes_free(&audio_engine->tx_pcm_buffer) / 2;
+    int16_t sample_buffer[MAX_NUM_SAMPLES];
+    while (num_samples){
+        int num_chunk = btstack_min(num_samples, MAX_NUM_SAMPLES);
+        int i;
+        for (i=0; i < num_chunk; i++){
+            sample_buffer[i] = sine_int16_at_16000hz[phase];
+            phase += step;
+            if (phase >= (sizeof(sine_int16_at_16000hz) / sizeof(int16_t))){
+                phase = 0;
+            }
         }
+        hfp_audio_engine_write_pcm(audio_engine, sample_buffer, num_chunk);
+        num_samples -= num_chunk;
+        num_audio_frames++;
     }
 }
-
-#define MAX_NUM_SAMPLES (16*8)
-static void sco_demo_msbc_fill_sine_audio_frame(void){
-    if (!hfp_msbc_can_encode_audio_frame_now()) return;
-    int num_samples = hfp_msbc_num_audio_samples_per_frame();
-    if (num_samples > MAX_NUM_SAMPLES) return;
-    int16_t sample_buffer[MAX_NUM_SAMPLES];
-    sco_demo_sine_wave_int16_at_16000_hz_host_endian(num_samples, sample_buffer);
-    hfp_msbc_encode_audio_frame(sample_buffer);
-    num_audio_frames++;
-}
 #endif
 #endif
 
@@ -360,20 +360,20 @@ static void portaudio_terminate(void){
 
 #if (SCO_DEMO_MODE == SCO_DEMO_MODE_SINE) || (SCO_DEMO_MODE == SCO_DEMO_MODE_MICROPHONE)
 
-#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
-static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context){
+#ifdef ENABLE_SCO_OVER_HCI
+static void handle_pcm_data(hfp_audio_engine_t * engine, int16_t * data, int num_samples, int sample_rate, void * context){
+    UNUSED(engine);
     UNUSED(context);
     UNUSED(sample_rate);
     UNUSED(data);
     UNUSED(num_samples);
-    UNUSED(num_channels);
 
 #if (SCO_DEMO_MODE == SCO_DEMO_MODE_SINE) || (SCO_DEMO_MODE == SCO_DEMO_MODE_MICROPHONE)
 
-    // printf("handle_pcm_data num samples %u, sample rate %d\n", num_samples, num_channels);
+    // printf("handle_pcm_data num samples %u, sample rate %d\n", num_samples, sample_rate);
 #ifdef HAVE_PORTAUDIO
     // samples in callback in host endianess, ready for PortAudio playback
-    btstack_ring_buffer_write(&pa_output_ring_buffer, (uint8_t *)data, num_samples*num_channels*2);
+    btstack_ring_buffer_write(&pa_output_ring_buffer, (uint8_t *)data, num_samples*NUM_CHANNELS*2);
 #endif /* HAVE_PORTAUDIO */
 
 #ifdef SCO_WAV_FILENAME
@@ -388,7 +388,7 @@ static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, i
 
 #endif /* Demo mode sine or microphone */
 }
-#endif /* ENABLE_HFP_WIDE_BAND_SPEECH */
+#endif /* ENABLE_SCO_OVER_HCI */
 
 
 #ifdef ENABLE_HFP_WIDE_BAND_SPEECH
@@ -396,18 +396,11 @@ static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, i
 static void sco_demo_init_mSBC(void){
     printf("SCO Demo: Init mSBC\n");
 
-    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_mSBC, &handle_pcm_data, NULL);    
-    hfp_msbc_init();
-
 #ifdef SCO_WAV_FILENAME
     num_samples_to_write = MSBC_SAMPLE_RATE * SCO_WAV_DURATION_IN_SECONDS;
     wav_writer_open(SCO_WAV_FILENAME, 1, MSBC_SAMPLE_RATE);
 #endif
 
-#if SCO_DEMO_MODE == SCO_DEMO_MODE_SINE
-    sco_demo_msbc_fill_sine_audio_frame();
-#endif
-
 #ifdef SCO_MSBC_IN_FILENAME
     msbc_file_in = fopen(SCO_MSBC_IN_FILENAME, "wb");
     printf("SCO Demo: creating mSBC in file %s, %p\n", SCO_MSBC_IN_FILENAME, msbc_file_in);
@@ -430,7 +423,11 @@ static void sco_demo_receive_mSBC(uint8_t * packet, uint16_t size){
             fwrite(packet+3, size-3, 1, msbc_file_in);
         }
     }
-    btstack_sbc_decoder_process_data(&decoder_state, (packet[1] >> 4) & 3, packet+3, size-3);  
+#ifdef ENABLE_SCO_OVER_HCI
+    // mSBC is only negotiated by HFP, which provides the audio engine
+    if (!audio_engine) return;
+    hfp_audio_engine_receive_sco_packet(audio_engine, packet, size);
+#endif
 }
 #endif
 
@@ -452,6 +449,13 @@ static void sco_demo_init_CVSD(void){
 }
 
 static void sco_demo_receive_CVSD(uint8_t * packet, uint16_t size){
+#ifdef ENABLE_SCO_OVER_HCI
+    if (audio_engine){
+        hfp_audio_engine_receive_sco_packet(audio_engine, packet, size);
+        return;
+    }
+#endif
+
     if (!num_samples_to_write) return;
 
     int16_t audio_frame_out[128];    // 
@@ -497,9 +501,13 @@ void sco_demo_close(void){
     printf("SCO demo close\n");
 
     printf("SCO demo statistics: ");
-#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
-    if (negotiated_codec == HFP_CODEC_MSBC){
-        printf("Used mSBC with PLC, number of processed frames: \n - %d good frames, \n - %d zero frames, \n - %d bad frames.\n", decoder_state.good_frames_nr, decoder_state.zero_frames_nr, decoder_state.bad_frames_nr);
+#ifdef ENABLE_SCO_OVER_HCI
+    if (audio_engine){
+        hfp_audio_engine_stats_t stats;
+        hfp_audio_engine_get_stats(audio_engine, &stats);
+        printf("Used %s with PLC, number of processed frames: \n - %u good frames, \n - %u concealed frames, \n - %u tx underruns.\n",
+            negotiated_codec == HFP_CODEC_MSBC ? "mSBC" : "CVSD", (unsigned int) stats.frames_decoded, (unsigned int) stats.frames_concealed, (unsigned int) stats.tx_underruns);
+        audio_engine = NULL;
     } else 
 #endif
     {
@@ -536,6 +544,16 @@ void sco_demo_set_codec(uint8_t codec){
 #endif
 }
 
+#ifdef ENABLE_SCO_OVER_HCI
+void sco_demo_set_audio_engine(hfp_audio_engine_t * engine){
+    audio_engine = engine;
+    if (!audio_engine) return;
+#if (SCO_DEMO_MODE == SCO_DEMO_MODE_SINE) || (SCO_DEMO_MODE == SCO_DEMO_MODE_MICROPHONE)
+    hfp_audio_engine_set_pcm_handler(audio_engine, &handle_pcm_data, NULL);
+#endif
+}
+#endif
+
 void sco_demo_init(void){
 	// status
 #if SCO_DEMO_MODE == SCO_DEMO_MODE_MICROPHONE
@@ -581,22 +599,21 @@ void sco_demo_send(hci_con_handle_t sco_handle){
     hci_reserve_packet_buffer();
     uint8_t * sco_packet = hci_get_outgoing_packet_buffer();
 #if SCO_DEMO_MODE == SCO_DEMO_MODE_SINE
-#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
-    if (negotiated_codec == HFP_CODEC_MSBC){
-        // overwrite
-        sco_payload_length = 24;
-        sco_packet_length = sco_payload_length + 3;
-
-        if (hfp_msbc_num_bytes_in_stream() < sco_payload_length){
-            log_error("mSBC stream is empty.");
+#ifdef ENABLE_SCO_OVER_HCI
+    if (audio_engine){
+        if (negotiated_codec == HFP_CODEC_MSBC){
+            // overwrite
+            sco_payload_length = 24;
+            sco_packet_length = sco_payload_length + 3;
         }
-        hfp_msbc_read_from_stream(sco_packet + 3, sco_payload_length);
-        if (msbc_file_out){
+        sco_demo_audio_engine_fill_sine_wave();
+        hfp_audio_engine_fill_sco_payload(audio_engine, sco_packet + 3, sco_payload_length);
+#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
+        if (negotiated_codec == HFP_CODEC_MSBC && msbc_file_out){
             // log outgoing mSBC data for testing
             fwrite(sco_packet + 3, sco_payload_length, 1, msbc_file_out);
         }
-
-        sco_demo_msbc_fill_sine_audio_frame();
+#endif
     } else
 #endif
     {
@@ -608,44 +625,51 @@ void sco_demo_send(hci_con_handle_t sco_handle){
 #if SCO_DEMO_MODE == SCO_DEMO_MODE_MICROPHONE
 
 #ifdef HAVE_PORTAUDIO
-    if (negotiated_codec == HFP_CODEC_MSBC){
-        // MSBC
-
-        // overwrite
-        sco_payload_length = 24;
-        sco_packet_length = sco_payload_length + 3;
+#ifdef ENABLE_SCO_OVER_HCI
+    if (audio_engine){
+        uint32_t prebuffer_bytes = CVSD_PA_PREBUFFER_BYTES;
+        if (negotiated_codec == HFP_CODEC_MSBC){
+            // overwrite
+            sco_payload_length = 24;
+            sco_packet_length = sco_payload_length + 3;
+            prebuffer_bytes = MSBC_PA_PREBUFFER_BYTES;
+        }
 
         if (pa_input_paused){
-            if (btstack_ring_buffer_bytes_available(&pa_input_ring_buffer) >= MSBC_PA_PREBUFFER_BYTES){
+            if (btstack_ring_buffer_bytes_available(&pa_input_ring_buffer) >= prebuffer_bytes){
                 // resume sending
                 pa_input_paused = 0;
             }
         }
 
+        // forward microphone samples to audio engine, it inserts silence on underrun
         if (!pa_input_paused){
-            int num_samples = hfp_msbc_num_audio_samples_per_frame();
-            if (hfp_msbc_can_encode_audio_frame_now() && btstack_ring_buffer_bytes_available(&pa_input_ring_buffer) >= (num_samples * MSBC_BYTES_PER_FRAME)){
-                int16_t sample_buffer[num_samples];
+            int num_samples = btstack_ring_buffer_bytes_free(&audio_engine->tx_pcm_buffer) / 2;
+            int16_t sample_buffer[MAX_NUM_SAMPLES];
+            while (num_samples){
                 uint32_t bytes_read;
-                btstack_ring_buffer_read(&pa_input_ring_buffer, (uint8_t*) sample_buffer, num_samples * MSBC_BYTES_PER_FRAME, &bytes_read);
-                hfp_msbc_encode_audio_frame(sample_buffer);
+                int num_chunk = btstack_min(num_samples, MAX_NUM_SAMPLES);
+                btstack_ring_buffer_read(&pa_input_ring_buffer, (uint8_t*) sample_buffer, num_chunk * 2, &bytes_read);
+                hfp_audio_engine_write_pcm(audio_engine, sample_buffer, bytes_read / 2);
+                if (bytes_read < num_chunk * 2){
+                    pa_input_paused = 1;
+                    break;
+                }
+                num_samples -= num_chunk;
                 num_audio_frames++;
             }
         }
 
-        if (hfp_msbc_num_bytes_in_stream() < sco_payload_length){
-            log_error("mSBC stream should not be empty.");
-            memset(sco_packet + 3, 0, sco_payload_length);
-            pa_input_paused = 1;
-        } else {
-            hfp_msbc_read_from_stream(sco_packet + 3, sco_payload_length);
-            if (msbc_file_out){
-                // log outgoing mSBC data for testing
-                fwrite(sco_packet + 3, sco_payload_length, 1, msbc_file_out);
-            }
+        hfp_audio_engine_fill_sco_payload(audio_engine, sco_packet + 3, sco_payload_length);
+#ifdef ENABLE_HFP_WIDE_BAND_SPEECH
+        if (negotiated_codec == HFP_CODEC_MSBC && msbc_file_out){
+            // log outgoing mSBC data for testing
+            fwrite(sco_packet + 3, sco_payload_length, 1, msbc_file_out);
         }
-
-    } else {
+#endif
+    } else
+#endif
+    {
         // CVSD
 
         log_info("send: bytes avail %u, free %u, counter %u", btstack_ring_buffer_bytes_available(&pa_input_ring_buffer), btstack_ring_buffer_bytes_free(&pa_input_ring_buffer), pa_input_counter);
@@ -45,6 +45,10 @@
 
 #include "hci.h"
 
+#ifdef ENABLE_SCO_OVER_HCI
+#include "classic/hfp_audio_engine.h"
+#endif
+
 #if defined __cplusplus
 extern "C" {
 #endif
@@ -60,6 +64,15 @@ void sco_demo_init(void);
  */
  void sco_demo_set_codec(uint8_t codec);
 
+#ifdef ENABLE_SCO_OVER_HCI
+/**
+ * @brief Encode and decode audio with HFP audio engine of the connection, call after sco_demo_set_codec. 
+ * HSP does not provide an engine and uses CVSD without it.
+ * @param engine
+ */
+void sco_demo_set_audio_engine(hfp_audio_engine_t * engine);
+#endif
+
 /**
  * @brief Send next data on con_handle
  * @param con_handle
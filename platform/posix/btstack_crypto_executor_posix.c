@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_crypto_executor_posix.c"
+
+/*
+ *  btstack_crypto_executor_posix.c
+ *
+ *  A single worker thread executes one work item at a time. When done, it writes a byte into a pipe
+ *  which is monitored by a run loop data source that calls the done handler on the run loop.
+ */
+
+#include "btstack_crypto_executor_posix.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+
+static pthread_t       worker_thread;
+static pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  worker_cond  = PTHREAD_COND_INITIALIZER;
+static int             worker_pipe[2];
+static int             worker_started;
+static btstack_data_source_t worker_data_source;
+
+// current work item, guarded by worker_mutex
+static void (*worker_work)(void * context);
+static void (*worker_done)(void * context);
+static void * worker_context;
+static int    worker_pending;
+// errno of failed write to pipe, logged on the run loop
+static int    worker_write_errno;
+
+static void * btstack_crypto_executor_posix_thread(void * arg){
+    UNUSED(arg);
+    while (1){
+        pthread_mutex_lock(&worker_mutex);
+        while (!worker_pending){
+            pthread_cond_wait(&worker_cond, &worker_mutex);
+        }
+        void (*work)(void * context) = worker_work;
+        void * context = worker_context;
+        pthread_mutex_unlock(&worker_mutex);
+
+        (*work)(context);
+
+        pthread_mutex_lock(&worker_mutex);
+        worker_pending = 0;
+        pthread_mutex_unlock(&worker_mutex);
+
+        // wake up run loop, no logging on this thread
+        uint8_t done = 1;
+        ssize_t res;
+        do {
+            res = write(worker_pipe[1], &done, 1);
+        } while (res < 0 && errno == EINTR);
+        if (res != 1){
+            int write_errno = (res < 0) ? errno : EIO;
+            pthread_mutex_lock(&worker_mutex);
+            worker_write_errno = write_errno;
+            pthread_mutex_unlock(&worker_mutex);
+        }
+    }
+    return NULL;
+}
+
+static void btstack_crypto_executor_posix_process(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(callback_type);
+    uint8_t done;
+    if (read(ds->fd, &done, 1) != 1) return;
+    pthread_mutex_lock(&worker_mutex);
+    void (*done_handler)(void * context) = worker_done;
+    void * context = worker_context;
+    pthread_mutex_unlock(&worker_mutex);
+    (*done_handler)(context);
+}
+
+static int btstack_crypto_executor_posix_start(void){
+    if (pipe(worker_pipe)){
+        log_error("crypto executor: pipe failed");
+        return -1;
+    }
+    if (pthread_create(&worker_thread, NULL, &btstack_crypto_executor_posix_thread, NULL)){
+        log_error("crypto executor: pthread_create failed");
+        close(worker_pipe[0]);
+        close(worker_pipe[1]);
+        return -1;
+    }
+    btstack_run_loop_set_data_source_fd(&worker_data_source, worker_pipe[0]);
+    btstack_run_loop_set_data_source_handler(&worker_data_source, &btstack_crypto_executor_posix_process);
+    btstack_run_loop_enable_data_source_callbacks(&worker_data_source, DATA_SOURCE_CALLBACK_READ);
+    btstack_run_loop_add_data_source(&worker_data_source);
+    worker_started = 1;
+    return 0;
+}
+
+static void btstack_crypto_executor_posix_execute(void (*work)(void * context), void (*done)(void * context), void * context){
+    if (!worker_started && btstack_crypto_executor_posix_start()){
+        // no thread, execute directly
+        (*work)(context);
+        (*done)(context);
+        return;
+    }
+    pthread_mutex_lock(&worker_mutex);
+    if (worker_write_errno){
+        log_error("crypto executor: write to pipe failed: %s", strerror(worker_write_errno));
+        worker_write_errno = 0;
+    }
+    if (worker_pending){
+        log_error("crypto executor: work item already active");
+    }
+    worker_work    = work;
+    worker_done    = done;
+    worker_context = context;
+    worker_pending = 1;
+    pthread_cond_signal(&worker_cond);
+    pthread_mutex_unlock(&worker_mutex);
+}
+
+static const btstack_crypto_executor_t btstack_crypto_executor_posix = {
+    &btstack_crypto_executor_posix_execute,
+};
+
+const btstack_crypto_executor_t * btstack_crypto_executor_posix_get_instance(void){
+    return &btstack_crypto_executor_posix;
+}
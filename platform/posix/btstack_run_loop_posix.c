@@ -52,6 +52,8 @@
 #include "Winsock2.h"
 #else
 #include <sys/select.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include <stdio.h>
@@ -67,6 +69,14 @@ static btstack_linked_list_t timers;
 // start time. tv_usec = 0
 static struct timeval init_tv;
 
+#ifndef _WIN32
+// callbacks posted from other threads: lock-free LIFO list, reversed on the run loop thread
+static btstack_linked_item_t * main_thread_callbacks;
+// pipe to wake up select
+static int main_thread_pipe_fds[2] = { -1, -1 };
+static btstack_data_source_t main_thread_data_source;
+#endif
+
 /**
  * Add data_source to run_loop
  */
@@ -231,6 +241,63 @@ static void btstack_run_loop_posix_execute(void) {
     }
 }
 
+#ifndef _WIN32
+static void btstack_run_loop_posix_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    // push with compare-and-swap, callback_registration->item links to older entries
+    btstack_linked_item_t * item = (btstack_linked_item_t *) callback_registration;
+    btstack_linked_item_t * head = __atomic_load_n(&main_thread_callbacks, __ATOMIC_RELAXED);
+    do {
+        item->next = head;
+    } while (!__atomic_compare_exchange_n(&main_thread_callbacks, &head, item, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // only the first entry needs to wake up the run loop, it grabs all entries at once
+    if (head != NULL) return;
+    const uint8_t token = 0;
+    ssize_t bytes_written = write(main_thread_pipe_fds[1], &token, 1);
+    UNUSED(bytes_written);
+}
+
+static void btstack_run_loop_posix_process_main_thread_callbacks(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(callback_type);
+    // drain pipe before taking the list, a post afterwards writes a new token
+    uint8_t tokens[16];
+    while (read(ds->fd, tokens, sizeof(tokens)) > 0);
+
+    btstack_linked_item_t * head = __atomic_exchange_n(&main_thread_callbacks, NULL, __ATOMIC_ACQUIRE);
+
+    // reverse to execute callbacks in order of posting
+    btstack_linked_item_t * fifo = NULL;
+    while (head){
+        btstack_linked_item_t * next = head->next;
+        head->next = fifo;
+        fifo = head;
+        head = next;
+    }
+    while (fifo){
+        btstack_context_callback_registration_t * callback_registration = (btstack_context_callback_registration_t *) fifo;
+        // fetch next before callback, as it may post the registration again
+        fifo = fifo->next;
+        callback_registration->callback(callback_registration->context);
+    }
+}
+
+static void btstack_run_loop_posix_init_main_thread_callbacks(void){
+    main_thread_callbacks = NULL;
+    if (main_thread_pipe_fds[0] < 0){
+        if (pipe(main_thread_pipe_fds) < 0){
+            log_error("btstack_run_loop_posix_init: pipe for main thread callbacks failed");
+            return;
+        }
+        fcntl(main_thread_pipe_fds[0], F_SETFL, fcntl(main_thread_pipe_fds[0], F_GETFL) | O_NONBLOCK);
+        fcntl(main_thread_pipe_fds[1], F_SETFL, fcntl(main_thread_pipe_fds[1], F_GETFL) | O_NONBLOCK);
+    }
+    btstack_run_loop_set_data_source_fd(&main_thread_data_source, main_thread_pipe_fds[0]);
+    btstack_run_loop_set_data_source_handler(&main_thread_data_source, &btstack_run_loop_posix_process_main_thread_callbacks);
+    btstack_run_loop_posix_enable_data_source_callbacks(&main_thread_data_source, DATA_SOURCE_CALLBACK_READ);
+    btstack_run_loop_posix_add_data_source(&main_thread_data_source);
+}
+#endif
+
 // set timer
 static void btstack_run_loop_posix_set_timer(btstack_timer_source_t *a, uint32_t timeout_in_ms){
     uint32_t time_ms = btstack_run_loop_posix_get_time_ms();
@@ -245,6 +312,9 @@ static void btstack_run_loop_posix_init(void){
     gettimeofday(&init_tv, NULL);
     init_tv.tv_usec = 0;
     log_debug("btstack_run_loop_posix_init at %u/%u", (int) init_tv.tv_sec, 0);
+#ifndef _WIN32
+    btstack_run_loop_posix_init_main_thread_callbacks();
+#endif
 }
 
 
@@ -260,6 +330,9 @@ static const btstack_run_loop_t btstack_run_loop_posix = {
     &btstack_run_loop_posix_execute,
     &btstack_run_loop_posix_dump_timer,
     &btstack_run_loop_posix_get_time_ms,
+#ifndef _WIN32
+    &btstack_run_loop_posix_execute_on_main_thread,
+#endif
 };
 
 /**
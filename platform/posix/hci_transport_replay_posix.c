@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hci_transport_replay_posix.c"
+
+/*
+ *  hci_transport_replay_posix.c
+ *
+ *  HCI Transport API implementation that replays a PacketLogger or BTSnoop file
+ *
+ *  The file is memory-mapped. Controller to host packets are delivered to the stack, host to
+ *  controller packets sent by the stack are compared against the capture. A received packet is
+ *  only delivered after all packets recorded before it have been sent by the stack.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_transport.h"
+
+// time to wait for stack to send the next recorded packet before it gets skipped
+#ifndef HCI_TRANSPORT_REPLAY_STALL_TIMEOUT_MS
+#define HCI_TRANSPORT_REPLAY_STALL_TIMEOUT_MS 1000
+#endif
+
+#define PKTLOG_HDR_SIZE     13
+#define BTSNOOP_FILE_HEADER 16
+#define BTSNOOP_HDR_SIZE    24
+
+#define BTSNOOP_DATALINK_HCI_UNENCAPSULATED 1001
+#define BTSNOOP_DATALINK_HCI_UART           1002
+
+typedef enum {
+    REPLAY_FORMAT_PACKETLOGGER,
+    REPLAY_FORMAT_BTSNOOP,
+} replay_format_t;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t next_offset;
+    uint8_t  packet_type;
+    uint8_t  incoming;
+    uint8_t  truncated;
+    const uint8_t * packet;
+    uint16_t len;
+    uint64_t timestamp_us;
+} replay_record_t;
+
+static const hci_transport_config_replay_t * replay_config;
+static void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size) = NULL;
+static void (*done_handler)(void);
+
+static replay_format_t replay_format;
+static uint32_t        replay_datalink;
+static const uint8_t * replay_data;
+static uint32_t        replay_size;
+
+// next packet to deliver and next packet expected from stack
+static replay_record_t rx_record;
+static replay_record_t tx_record;
+static int             rx_valid;
+static int             tx_valid;
+
+static uint64_t replay_timestamp_us;
+static int      replay_delay_done;
+static int      replay_waiting;
+static int      replay_done;
+
+static btstack_timer_source_t replay_timer;
+static hci_transport_replay_stats_t replay_stats;
+
+static uint8_t hci_packet_with_pre_buffer[HCI_INCOMING_PRE_BUFFER_SIZE + HCI_PACKET_BUFFER_SIZE];
+static uint8_t * hci_packet = &hci_packet_with_pre_buffer[HCI_INCOMING_PRE_BUFFER_SIZE];
+
+static void hci_transport_replay_process(btstack_timer_source_t * ts);
+
+// @returns 1 if record at offset could be parsed, 0 at end of file
+static int hci_transport_replay_parse_record(uint32_t offset, replay_record_t * record){
+    const uint8_t * data = &replay_data[offset];
+    uint32_t payload_offset;
+    uint32_t payload_len;
+
+    record->offset    = offset;
+    record->truncated = 0;
+    switch (replay_format){
+        case REPLAY_FORMAT_PACKETLOGGER: {
+            if (replay_size - offset < PKTLOG_HDR_SIZE) return 0;
+            uint32_t len = big_endian_read_32(data, 0);
+            if (len < PKTLOG_HDR_SIZE - 4) return 0;
+            payload_offset = offset + PKTLOG_HDR_SIZE;
+            payload_len    = len - (PKTLOG_HDR_SIZE - 4);
+            record->timestamp_us = (uint64_t) big_endian_read_32(data, 4) * 1000000 + big_endian_read_32(data, 8);
+            switch (data[12]){
+                case 0x00:
+                    record->packet_type = HCI_COMMAND_DATA_PACKET;
+                    record->incoming    = 0;
+                    break;
+                case 0x01:
+                    record->packet_type = HCI_EVENT_PACKET;
+                    record->incoming    = 1;
+                    break;
+                case 0x02:
+                case 0x03:
+                    record->packet_type = HCI_ACL_DATA_PACKET;
+                    record->incoming    = data[12] & 1;
+                    break;
+                case 0x08:
+                case 0x09:
+                    record->packet_type = HCI_SCO_DATA_PACKET;
+                    record->incoming    = data[12] & 1;
+                    break;
+                default:
+                    // log messages and other notes
+                    record->packet_type = 0;
+                    break;
+            }
+            break;
+        }
+        case REPLAY_FORMAT_BTSNOOP: {
+            if (replay_size - offset < BTSNOOP_HDR_SIZE) return 0;
+            uint32_t original_len = big_endian_read_32(data, 0);
+            uint32_t flags        = big_endian_read_32(data, 8);
+            payload_offset = offset + BTSNOOP_HDR_SIZE;
+            payload_len    = big_endian_read_32(data, 4);
+            record->truncated    = payload_len < original_len;
+            record->timestamp_us = ((uint64_t) big_endian_read_32(data, 16) << 32) | big_endian_read_32(data, 20);
+            record->incoming     = flags & 1;
+            if (replay_datalink == BTSNOOP_DATALINK_HCI_UART){
+                if (payload_len < 1) return 0;
+                if (payload_offset >= replay_size) return 0;
+                record->packet_type = replay_data[payload_offset];
+                payload_offset++;
+                payload_len--;
+            } else if (flags & 2){
+                record->packet_type = record->incoming ? HCI_EVENT_PACKET : HCI_COMMAND_DATA_PACKET;
+            } else {
+                record->packet_type = HCI_ACL_DATA_PACKET;
+            }
+            break;
+        }
+        default:
+            return 0;
+    }
+    // payload_offset <= replay_size, compare without overflow
+    if (payload_len > replay_size - payload_offset) return 0;
+    if (payload_len > 0xffff) return 0;
+    record->packet      = &replay_data[payload_offset];
+    record->len         = payload_len;
+    record->next_offset = payload_offset + payload_len;
+    return 1;
+}
+
+// find next record in given direction at or after offset, @returns 1 if found
+static int hci_transport_replay_find_record(uint32_t offset, int incoming, replay_record_t * record){
+    while (hci_transport_replay_parse_record(offset, record)){
+        offset = record->next_offset;
+        if (record->packet_type == 0) continue;
+        if (record->incoming != incoming) continue;
+        if (record->len > HCI_PACKET_BUFFER_SIZE) {
+            log_error("replay: skip packet of size %u at offset %" PRIu32, record->len, record->offset);
+            continue;
+        }
+        if (incoming && record->truncated){
+            log_error("replay: skip truncated packet at offset %" PRIu32, record->offset);
+            continue;
+        }
+        return 1;
+    }
+    if (offset < replay_size){
+        log_error("replay: invalid record at offset %" PRIu32, offset);
+    }
+    return 0;
+}
+
+static void hci_transport_replay_schedule(uint32_t timeout_ms){
+    btstack_run_loop_remove_timer(&replay_timer);
+    btstack_run_loop_set_timer_handler(&replay_timer, &hci_transport_replay_process);
+    btstack_run_loop_set_timer(&replay_timer, timeout_ms);
+    btstack_run_loop_add_timer(&replay_timer);
+}
+
+static void hci_transport_replay_process(btstack_timer_source_t * ts){
+    UNUSED(ts);
+
+    if (replay_waiting){
+        // stall timeout
+        replay_waiting = 0;
+        log_error("replay: stack did not send packet recorded at offset %" PRIu32 ", skip", tx_record.offset);
+        replay_stats.stalls++;
+        tx_valid = hci_transport_replay_find_record(tx_record.next_offset, 0, &tx_record);
+    }
+
+    while (rx_valid){
+        
+        // wait for stack to send packets recorded before next received packet
+        if (tx_valid && (tx_record.offset < rx_record.offset)){
+            replay_waiting = 1;
+            hci_transport_replay_schedule(HCI_TRANSPORT_REPLAY_STALL_TIMEOUT_MS);
+            return;
+        }
+
+        // wait for recorded delay
+        if (replay_config->realtime && !replay_delay_done && (rx_record.timestamp_us > replay_timestamp_us)){
+            uint32_t delay_ms = (uint32_t) ((rx_record.timestamp_us - replay_timestamp_us) / 1000);
+            if (delay_ms){
+                replay_delay_done = 1;
+                hci_transport_replay_schedule(delay_ms);
+                return;
+            }
+        }
+        replay_delay_done = 0;
+
+        // copy into buffer with pre-buffer and advance before delivery, stack might send packets
+        uint8_t  packet_type = rx_record.packet_type;
+        uint16_t len         = rx_record.len;
+        memcpy(hci_packet, rx_record.packet, len);
+        replay_timestamp_us = rx_record.timestamp_us;
+        replay_stats.packets_received++;
+        rx_valid = hci_transport_replay_find_record(rx_record.next_offset, 1, &rx_record);
+        packet_handler(packet_type, hci_packet, len);
+
+        // stack might have closed transport
+        if (!replay_data) return;
+    }
+
+    // wait for remaining packets from stack
+    if (tx_valid){
+        replay_waiting = 1;
+        hci_transport_replay_schedule(HCI_TRANSPORT_REPLAY_STALL_TIMEOUT_MS);
+        return;
+    }
+
+    if (replay_done) return;
+    replay_done = 1;
+    log_info("replay: done, received %" PRIu32 ", sent %" PRIu32 ", mismatched %" PRIu32 ", unexpected %" PRIu32 ", stalls %" PRIu32,
+        replay_stats.packets_received, replay_stats.packets_sent, replay_stats.packets_mismatched,
+        replay_stats.packets_unexpected, replay_stats.stalls);
+    if (done_handler){
+        (*done_handler)();
+    }
+}
+
+static void hci_transport_replay_init(const void * transport_config){
+    replay_config = (const hci_transport_config_replay_t *) transport_config;
+}
+
+static int hci_transport_replay_open(void){
+    int fd = open(replay_config->file_name, O_RDONLY);
+    if (fd < 0) {
+        log_error("replay: cannot open %s", replay_config->file_name);
+        return -1;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || (file_stat.st_size == 0)){
+        close(fd);
+        return -1;
+    }
+    void * data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED){
+        log_error("replay: cannot map %s", replay_config->file_name);
+        return -1;
+    }
+    replay_data = (const uint8_t *) data;
+    replay_size = (uint32_t) file_stat.st_size;
+
+    uint32_t offset = 0;
+    if ((replay_size >= BTSNOOP_FILE_HEADER) && (memcmp(replay_data, "btsnoop\0", 8) == 0)){
+        replay_format   = REPLAY_FORMAT_BTSNOOP;
+        replay_datalink = big_endian_read_32(replay_data, 12);
+        offset          = BTSNOOP_FILE_HEADER;
+        if ((replay_datalink != BTSNOOP_DATALINK_HCI_UART) && (replay_datalink != BTSNOOP_DATALINK_HCI_UNENCAPSULATED)){
+            log_error("replay: unsupported BTSnoop datalink %" PRIu32, replay_datalink);
+            munmap(data, replay_size);
+            replay_data = NULL;
+            return -1;
+        }
+    } else {
+        replay_format = REPLAY_FORMAT_PACKETLOGGER;
+    }
+
+    memset(&replay_stats, 0, sizeof(replay_stats));
+    replay_delay_done = 0;
+    replay_waiting = 0;
+    replay_done = 0;
+    rx_valid = hci_transport_replay_find_record(offset, 1, &rx_record);
+    tx_valid = hci_transport_replay_find_record(offset, 0, &tx_record);
+    replay_timestamp_us = 0;
+    if (rx_valid || tx_valid){
+        replay_timestamp_us = (tx_valid && (!rx_valid || tx_record.offset < rx_record.offset)) ? tx_record.timestamp_us : rx_record.timestamp_us;
+    }
+    hci_transport_replay_schedule(0);
+    return 0;
+}
+
+static int hci_transport_replay_close(void){
+    btstack_run_loop_remove_timer(&replay_timer);
+    if (replay_data){
+        munmap((void *) replay_data, replay_size);
+        replay_data = NULL;
+    }
+    rx_valid = 0;
+    tx_valid = 0;
+    return 0;
+}
+
+static void hci_transport_replay_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    packet_handler = handler;
+}
+
+static int hci_transport_replay_send_packet(uint8_t packet_type, uint8_t * packet, int size){
+    replay_stats.packets_sent++;
+    if (!tx_valid){
+        log_error("replay: unexpected packet type %u, size %u", packet_type, size);
+        replay_stats.packets_unexpected++;
+        return 0;
+    }
+    uint16_t compare_len = tx_record.len;
+    if (!tx_record.truncated){
+        compare_len = size;
+    }
+    if ((packet_type != tx_record.packet_type) || (size < compare_len) || (!tx_record.truncated && (size != tx_record.len))
+     || memcmp(packet, tx_record.packet, compare_len)){
+        log_error("replay: packet type %u, size %u does not match packet recorded at offset %" PRIu32, packet_type, size, tx_record.offset);
+        replay_stats.packets_mismatched++;
+    }
+    replay_timestamp_us = tx_record.timestamp_us;
+    tx_valid = hci_transport_replay_find_record(tx_record.next_offset, 0, &tx_record);
+
+    // continue with next received packet from run loop
+    replay_waiting = 0;
+    hci_transport_replay_schedule(0);
+    return 0;
+}
+
+static const hci_transport_t hci_transport_replay = {
+    /* const char * name; */                                        "Replay",
+    /* void   (*init) (const void *transport_config); */            &hci_transport_replay_init,
+    /* int    (*open)(void); */                                     &hci_transport_replay_open,
+    /* int    (*close)(void); */                                    &hci_transport_replay_close,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &hci_transport_replay_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       NULL,
+    /* int    (*send_packet)(...); */                               &hci_transport_replay_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL, 
+};
+
+const hci_transport_t * hci_transport_replay_instance(void){
+    return &hci_transport_replay;
+}
+
+void hci_transport_replay_register_done_handler(void (*handler)(void)){
+    done_handler = handler;
+}
+
+void hci_transport_replay_get_stats(hci_transport_replay_stats_t * stats){
+    *stats = replay_stats;
+}
@@ -60,6 +60,11 @@ static btstack_linked_list_t timers;
 // start time. 
 static ULARGE_INTEGER start_time;
 
+// callbacks posted from other threads: lock-free LIFO list, reversed on the run loop thread
+static btstack_linked_item_t * volatile main_thread_callbacks;
+// auto-reset event to wake up WaitForMultipleObjects
+static btstack_data_source_t main_thread_data_source;
+
 /**
  * Add data_source to run_loop
  */
@@ -222,6 +227,42 @@ static void btstack_run_loop_windows_execute(void) {
     }
 }
 
+static void btstack_run_loop_windows_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    // push with compare-and-swap, callback_registration->item links to older entries
+    btstack_linked_item_t * item = (btstack_linked_item_t *) callback_registration;
+    btstack_linked_item_t * head;
+    do {
+        head = main_thread_callbacks;
+        item->next = head;
+    } while (InterlockedCompareExchangePointer((PVOID volatile *) &main_thread_callbacks, item, head) != head);
+
+    // only the first entry needs to wake up the run loop, it grabs all entries at once
+    if (head != NULL) return;
+    SetEvent(main_thread_data_source.handle);
+}
+
+static void btstack_run_loop_windows_process_main_thread_callbacks(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(ds);
+    UNUSED(callback_type);
+    // event was reset by the wait, a post afterwards sets it again
+    btstack_linked_item_t * head = (btstack_linked_item_t *) InterlockedExchangePointer((PVOID volatile *) &main_thread_callbacks, NULL);
+
+    // reverse to execute callbacks in order of posting
+    btstack_linked_item_t * fifo = NULL;
+    while (head){
+        btstack_linked_item_t * next = head->next;
+        head->next = fifo;
+        fifo = head;
+        head = next;
+    }
+    while (fifo){
+        btstack_context_callback_registration_t * callback_registration = (btstack_context_callback_registration_t *) fifo;
+        // fetch next before callback, as it may post the registration again
+        fifo = fifo->next;
+        callback_registration->callback(callback_registration->context);
+    }
+}
+
 // set timer
 static void btstack_run_loop_windows_set_timer(btstack_timer_source_t *a, uint32_t timeout_in_ms){
     uint32_t time_ms = btstack_run_loop_windows_get_time_ms();
@@ -241,6 +282,15 @@ static void btstack_run_loop_windows_init(void){
     start_time.LowPart =  file_time.dwLowDateTime;
     start_time.HighPart = file_time.dwHighDateTime;
 
+    // wake-up for callbacks posted from other threads
+    main_thread_callbacks = NULL;
+    if (main_thread_data_source.handle == NULL){
+        main_thread_data_source.handle = CreateEvent(NULL, FALSE, FALSE, NULL);
+    }
+    btstack_run_loop_set_data_source_handler(&main_thread_data_source, &btstack_run_loop_windows_process_main_thread_callbacks);
+    btstack_run_loop_windows_enable_data_source_callbacks(&main_thread_data_source, DATA_SOURCE_CALLBACK_READ);
+    btstack_run_loop_windows_add_data_source(&main_thread_data_source);
+
     log_debug("btstack_run_loop_windows_init");
 }
 
@@ -257,6 +307,7 @@ static const btstack_run_loop_t btstack_run_loop_windows = {
     &btstack_run_loop_windows_execute,
     &btstack_run_loop_windows_dump_timer,
     &btstack_run_loop_windows_get_time_ms,
+    &btstack_run_loop_windows_execute_on_main_thread,
 };
 
 /**
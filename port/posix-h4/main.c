@@ -51,6 +51,7 @@
 
 #include "btstack_config.h"
 
+#include "btstack_crypto_executor_posix.h"
 #include "btstack_debug.h"
 #include "btstack_event.h"
 #include "btstack_link_key_db_fs.h"
@@ -244,6 +245,11 @@ int main(int argc, const char * argv[]){
 	hci_init(transport, (void*) &config);
     hci_set_link_key_db(link_key_db);
 
+#ifdef ENABLE_LE_SECURE_CONNECTIONS
+    // run ECC key generation and DHKey calculation on worker thread
+    btstack_crypto_ecc_p256_set_executor(btstack_crypto_executor_posix_get_instance());
+#endif
+
     // set BD_ADDR for CSR without Flash/unique address
     // bd_addr_t own_address = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
     // btstack_chipset_csr_set_bd_addr(own_address);
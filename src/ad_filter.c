@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "ad_filter.c"
+
+// *****************************************************************************
+//
+// Advertising Report Filter
+//
+// *****************************************************************************
+
+#include <string.h>
+
+#include "ad_filter.h"
+#include "bluetooth_data_types.h"
+#include "btstack_defines.h"
+#include "btstack_util.h"
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+// UUID matchers are evaluated for complete and incomplete lists
+static uint8_t ad_filter_lookup_type(uint8_t ad_type){
+    switch (ad_type){
+        case BLUETOOTH_DATA_TYPE_INCOMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS:
+            return BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS;
+        case BLUETOOTH_DATA_TYPE_INCOMPLETE_LIST_OF_128_BIT_SERVICE_CLASS_UUIDS:
+            return BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_128_BIT_SERVICE_CLASS_UUIDS;
+        default:
+            return ad_type;
+    }
+}
+
+static int ad_filter_address_compare(const ad_filter_address_t * a, uint8_t address_type, const uint8_t * address){
+    if (a->address_type != address_type) return (int) a->address_type - (int) address_type;
+    return memcmp(a->address, address, BD_ADDR_LEN);
+}
+
+static uint8_t ad_filter_add_matcher(ad_filter_t * filter, ad_filter_matcher_type_t type, uint8_t ad_type, const uint8_t * data, uint8_t len){
+    if (filter->matchers_num >= filter->matchers_max) return BTSTACK_MEMORY_ALLOC_FAILED;
+    ad_filter_matcher_t * matcher = &filter->matchers[filter->matchers_num++];
+    matcher->type    = (uint8_t) type;
+    matcher->ad_type = ad_filter_lookup_type(ad_type);
+    matcher->len     = len;
+    memcpy(matcher->data, data, len);
+    filter->compiled = 0;
+    return 0;
+}
+
+void ad_filter_init(ad_filter_t * filter, ad_filter_address_t * addresses, uint16_t addresses_max, ad_filter_matcher_t * matchers, uint16_t matchers_max){
+    memset(filter, 0, sizeof(ad_filter_t));
+    filter->addresses     = addresses;
+    filter->addresses_max = addresses ? addresses_max : 0;
+    filter->matchers      = matchers;
+    filter->matchers_max  = matchers ? matchers_max : 0;
+    filter->rssi_min      = -128;
+}
+
+void ad_filter_set_rssi_threshold(ad_filter_t * filter, int8_t rssi_min){
+    filter->rssi_min = rssi_min;
+}
+
+void ad_filter_set_duplicate_suppression(ad_filter_t * filter, ad_filter_duplicate_t * duplicates, uint16_t duplicates_num, uint32_t window_ms){
+    filter->duplicates          = duplicates;
+    filter->duplicates_num      = duplicates ? duplicates_num : 0;
+    filter->duplicate_window_ms = window_ms;
+    if (duplicates){
+        memset(duplicates, 0, duplicates_num * sizeof(ad_filter_duplicate_t));
+    }
+}
+
+uint8_t ad_filter_add_address(ad_filter_t * filter, bd_addr_type_t address_type, const bd_addr_t address){
+    if (filter->addresses_num >= filter->addresses_max) return BTSTACK_MEMORY_ALLOC_FAILED;
+    ad_filter_address_t * entry = &filter->addresses[filter->addresses_num++];
+    entry->address_type = (uint8_t) address_type;
+    memcpy(entry->address, address, BD_ADDR_LEN);
+    filter->compiled = 0;
+    return 0;
+}
+
+uint8_t ad_filter_add_ad_type(ad_filter_t * filter, uint8_t ad_type){
+    return ad_filter_add_matcher(filter, AD_FILTER_MATCHER_AD_TYPE, ad_type, &ad_type, 1);
+}
+
+uint8_t ad_filter_add_uuid16(ad_filter_t * filter, uint16_t uuid16){
+    uint8_t data[2];
+    little_endian_store_16(data, 0, uuid16);
+    return ad_filter_add_matcher(filter, AD_FILTER_MATCHER_UUID16, BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS, data, 2);
+}
+
+uint8_t ad_filter_add_uuid128(ad_filter_t * filter, const uint8_t * uuid128){
+    // stored in little endian as in Advertising Data
+    uint8_t data[16];
+    reverse_128(uuid128, data);
+    return ad_filter_add_matcher(filter, AD_FILTER_MATCHER_UUID128, BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_128_BIT_SERVICE_CLASS_UUIDS, data, 16);
+}
+
+uint8_t ad_filter_add_manufacturer_prefix(ad_filter_t * filter, uint16_t company_id, const uint8_t * prefix, uint8_t prefix_len){
+    if (prefix_len > AD_FILTER_MATCHER_DATA_MAX_LEN - 2) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    uint8_t data[AD_FILTER_MATCHER_DATA_MAX_LEN];
+    little_endian_store_16(data, 0, company_id);
+    if (prefix_len){
+        memcpy(&data[2], prefix, prefix_len);
+    }
+    return ad_filter_add_matcher(filter, AD_FILTER_MATCHER_MANUFACTURER_PREFIX, BLUETOOTH_DATA_TYPE_MANUFACTURER_SPECIFIC_DATA, data, 2 + prefix_len);
+}
+
+void ad_filter_compile(ad_filter_t * filter){
+    int i;
+    int j;
+
+    // sort allow-list by address type and address for binary search
+    for (i = 1; i < filter->addresses_num; i++){
+        ad_filter_address_t entry = filter->addresses[i];
+        for (j = i; j > 0 && ad_filter_address_compare(&filter->addresses[j-1], entry.address_type, entry.address) > 0; j--){
+            filter->addresses[j] = filter->addresses[j-1];
+        }
+        filter->addresses[j] = entry;
+    }
+
+    // sort matchers by AD type, stable to keep order of insertion
+    for (i = 1; i < filter->matchers_num; i++){
+        ad_filter_matcher_t matcher = filter->matchers[i];
+        for (j = i; j > 0 && filter->matchers[j-1].ad_type > matcher.ad_type; j--){
+            filter->matchers[j] = filter->matchers[j-1];
+        }
+        filter->matchers[j] = matcher;
+    }
+
+    memset(filter->ad_types, 0, sizeof(filter->ad_types));
+    for (i = 0; i < filter->matchers_num; i++){
+        uint8_t ad_type = filter->matchers[i].ad_type;
+        filter->ad_types[ad_type >> 3] |= 1 << (ad_type & 7);
+    }
+    filter->compiled = 1;
+}
+
+static int ad_filter_address_allowed(const ad_filter_t * filter, uint8_t address_type, const uint8_t * address){
+    int lo = 0;
+    int hi = filter->addresses_num - 1;
+    while (lo <= hi){
+        int mid = (lo + hi) / 2;
+        int res = ad_filter_address_compare(&filter->addresses[mid], address_type, address);
+        if (res == 0) return 1;
+        if (res < 0){
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
+
+static int ad_filter_list_contains(const uint8_t * list, uint8_t list_len, const uint8_t * item, uint8_t item_len){
+    uint8_t pos;
+    for (pos = 0; pos + item_len <= list_len; pos += item_len){
+        if (memcmp(&list[pos], item, item_len) == 0) return 1;
+    }
+    return 0;
+}
+
+static int ad_filter_matcher_match(const ad_filter_matcher_t * matcher, uint8_t ad_type, const uint8_t * data, uint8_t len){
+    switch ((ad_filter_matcher_type_t) matcher->type){
+        case AD_FILTER_MATCHER_AD_TYPE:
+            return ad_type == matcher->data[0];
+        case AD_FILTER_MATCHER_UUID16:
+        case AD_FILTER_MATCHER_UUID128:
+            return ad_filter_list_contains(data, len, matcher->data, matcher->len);
+        case AD_FILTER_MATCHER_MANUFACTURER_PREFIX:
+            return (len >= matcher->len) && (memcmp(data, matcher->data, matcher->len) == 0);
+        default:
+            return 0;
+    }
+}
+
+static int ad_filter_ad_structure_matches(const ad_filter_t * filter, uint8_t ad_type, const uint8_t * data, uint8_t len){
+    uint8_t lookup_type = ad_filter_lookup_type(ad_type);
+    if ((filter->ad_types[lookup_type >> 3] & (1 << (lookup_type & 7))) == 0) return 0;
+
+    // find first matcher for lookup type
+    int lo = 0;
+    int hi = filter->matchers_num;
+    while (lo < hi){
+        int mid = (lo + hi) / 2;
+        if (filter->matchers[mid].ad_type < lookup_type){
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    int i;
+    for (i = lo; i < filter->matchers_num && filter->matchers[i].ad_type == lookup_type; i++){
+        if (ad_filter_matcher_match(&filter->matchers[i], ad_type, data, len)) return 1;
+    }
+    return 0;
+}
+
+static int ad_filter_data_matches(const ad_filter_t * filter, uint8_t ad_len, const uint8_t * ad_data){
+    uint8_t pos = 0;
+    while (pos < ad_len){
+        uint8_t len = ad_data[pos];
+        // ignore padding and truncated AD structures
+        if (len == 0) break;
+        if (pos + 1 + len > ad_len) break;
+        if (ad_filter_ad_structure_matches(filter, ad_data[pos + 1], &ad_data[pos + 2], len - 1)) return 1;
+        pos += 1 + len;
+    }
+    return 0;
+}
+
+static uint32_t ad_filter_hash(uint8_t address_type, const uint8_t * address, uint8_t ad_len, const uint8_t * ad_data){
+    uint32_t hash = FNV_OFFSET_BASIS;
+    int i;
+    hash = (hash ^ address_type) * FNV_PRIME;
+    for (i = 0; i < BD_ADDR_LEN; i++){
+        hash = (hash ^ address[i]) * FNV_PRIME;
+    }
+    for (i = 0; i < ad_len; i++){
+        hash = (hash ^ ad_data[i]) * FNV_PRIME;
+    }
+    // 0 marks unused entry
+    return hash ? hash : 1;
+}
+
+static int ad_filter_is_duplicate(ad_filter_t * filter, uint8_t address_type, const uint8_t * address, uint8_t ad_len, const uint8_t * ad_data, uint32_t now_ms){
+    uint32_t hash = ad_filter_hash(address_type, address, ad_len, ad_data);
+    ad_filter_duplicate_t * entry = &filter->duplicates[hash % filter->duplicates_num];
+    if ((entry->hash == hash) && ((uint32_t) (now_ms - entry->timestamp_ms) < filter->duplicate_window_ms)) return 1;
+    // new report or window expired: (re-)start window, replaces older entry on collision
+    entry->hash = hash;
+    entry->timestamp_ms = now_ms;
+    return 0;
+}
+
+int ad_filter_match(ad_filter_t * filter, uint8_t address_type, const bd_addr_t address, int8_t rssi, uint8_t ad_len, const uint8_t * ad_data, uint32_t now_ms){
+    if (!filter->compiled){
+        ad_filter_compile(filter);
+    }
+    if (rssi < filter->rssi_min){
+        filter->reports_dropped_rssi++;
+        return 0;
+    }
+    if (filter->addresses_num && !ad_filter_address_allowed(filter, address_type, address)){
+        filter->reports_dropped_address++;
+        return 0;
+    }
+    if (filter->matchers_num && !ad_filter_data_matches(filter, ad_len, ad_data)){
+        filter->reports_dropped_data++;
+        return 0;
+    }
+    if (filter->duplicates_num && ad_filter_is_duplicate(filter, address_type, address, ad_len, ad_data, now_ms)){
+        filter->reports_dropped_duplicate++;
+        return 0;
+    }
+    filter->reports_matched++;
+    return 1;
+}
+
+void ad_filter_reset_counters(ad_filter_t * filter){
+    filter->reports_matched           = 0;
+    filter->reports_dropped_rssi      = 0;
+    filter->reports_dropped_address   = 0;
+    filter->reports_dropped_data      = 0;
+    filter->reports_dropped_duplicate = 0;
+}
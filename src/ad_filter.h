@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+// *****************************************************************************
+//
+// Advertising Report Filter
+//
+// Evaluates LE Advertising Reports against an address allow-list, AD matchers
+// (AD type, 16/128-bit Service UUID, Manufacturer Specific Data prefix), an RSSI
+// threshold, and suppresses duplicates within a time window.
+//
+// All storage is provided by the caller. After adding entries, the filter is
+// compiled into sorted tables that are evaluated in a single pass over the
+// Advertising Data.
+//
+// *****************************************************************************
+
+#ifndef __AD_FILTER_H
+#define __AD_FILTER_H
+
+#include "btstack_config.h"
+#include "bluetooth.h"
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#define AD_FILTER_MATCHER_DATA_MAX_LEN 16
+
+typedef enum {
+    AD_FILTER_MATCHER_AD_TYPE = 0,
+    AD_FILTER_MATCHER_UUID16,
+    AD_FILTER_MATCHER_UUID128,
+    AD_FILTER_MATCHER_MANUFACTURER_PREFIX,
+} ad_filter_matcher_type_t;
+
+typedef struct {
+    uint8_t   address_type;
+    bd_addr_t address;
+} ad_filter_address_t;
+
+typedef struct {
+    uint8_t  type;      // ad_filter_matcher_type_t
+    uint8_t  ad_type;   // AD type this matcher is evaluated for
+    uint8_t  len;
+    uint8_t  data[AD_FILTER_MATCHER_DATA_MAX_LEN];
+} ad_filter_matcher_t;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t timestamp_ms;
+} ad_filter_duplicate_t;
+
+typedef struct {
+    // address allow-list, empty list allows all addresses
+    ad_filter_address_t   * addresses;
+    uint16_t                addresses_max;
+    uint16_t                addresses_num;
+
+    // AD matchers, report passes if any matcher matches. Empty list allows all
+    ad_filter_matcher_t   * matchers;
+    uint16_t                matchers_max;
+    uint16_t                matchers_num;
+
+    // compiled: bitmap of AD types referenced by matchers, matchers sorted by AD type
+    uint8_t                 ad_types[32];
+    int                     compiled;
+
+    // duplicate suppression: direct-mapped hash set over address and advertising data
+    ad_filter_duplicate_t * duplicates;
+    uint16_t                duplicates_num;
+    uint32_t                duplicate_window_ms;
+
+    int8_t                  rssi_min;
+
+    // counters
+    uint32_t                reports_matched;
+    uint32_t                reports_dropped_rssi;
+    uint32_t                reports_dropped_address;
+    uint32_t                reports_dropped_data;
+    uint32_t                reports_dropped_duplicate;
+} ad_filter_t;
+
+/* API_START */
+
+/**
+ * @brief Init Advertising Report Filter with storage for address allow-list and AD matchers
+ * @param filter
+ * @param addresses storage for address allow-list, can be NULL
+ * @param addresses_max
+ * @param matchers storage for AD matchers, can be NULL
+ * @param matchers_max
+ */
+void ad_filter_init(ad_filter_t * filter, ad_filter_address_t * addresses, uint16_t addresses_max, ad_filter_matcher_t * matchers, uint16_t matchers_max);
+
+/**
+ * @brief Drop reports with RSSI below threshold
+ * @param filter
+ * @param rssi_min in dBm, use -128 to accept all reports
+ */
+void ad_filter_set_rssi_threshold(ad_filter_t * filter, int8_t rssi_min);
+
+/**
+ * @brief Drop reports with identical address and advertising data within a time window
+ * @param filter
+ * @param duplicates storage for hash set, NULL disables duplicate suppression
+ * @param duplicates_num
+ * @param window_ms
+ */
+void ad_filter_set_duplicate_suppression(ad_filter_t * filter, ad_filter_duplicate_t * duplicates, uint16_t duplicates_num, uint32_t window_ms);
+
+/**
+ * @brief Add address to allow-list
+ * @param filter
+ * @param address_type
+ * @param address
+ * @return 0 if ok, BTSTACK_MEMORY_ALLOC_FAILED if allow-list is full
+ */
+uint8_t ad_filter_add_address(ad_filter_t * filter, bd_addr_type_t address_type, const bd_addr_t address);
+
+/**
+ * @brief Match reports that contain given AD type
+ * @param filter
+ * @param ad_type
+ * @return 0 if ok, BTSTACK_MEMORY_ALLOC_FAILED if matcher table is full
+ */
+uint8_t ad_filter_add_ad_type(ad_filter_t * filter, uint8_t ad_type);
+
+/**
+ * @brief Match reports that list 16-bit Service UUID in complete or incomplete list
+ * @param filter
+ * @param uuid16
+ * @return 0 if ok, BTSTACK_MEMORY_ALLOC_FAILED if matcher table is full
+ */
+uint8_t ad_filter_add_uuid16(ad_filter_t * filter, uint16_t uuid16);
+
+/**
+ * @brief Match reports that list 128-bit Service UUID in complete or incomplete list
+ * @param filter
+ * @param uuid128 in big endian
+ * @return 0 if ok, BTSTACK_MEMORY_ALLOC_FAILED if matcher table is full
+ */
+uint8_t ad_filter_add_uuid128(ad_filter_t * filter, const uint8_t * uuid128);
+
+/**
+ * @brief Match reports with Manufacturer Specific Data from company that start with given prefix
+ * @param filter
+ * @param company_id
+ * @param prefix data following the company id, can be NULL if prefix_len is 0
+ * @param prefix_len up to AD_FILTER_MATCHER_DATA_MAX_LEN - 2
+ * @return 0 if ok, BTSTACK_MEMORY_ALLOC_FAILED if matcher table is full, ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS if prefix is too long
+ */
+uint8_t ad_filter_add_manufacturer_prefix(ad_filter_t * filter, uint16_t company_id, const uint8_t * prefix, uint8_t prefix_len);
+
+/**
+ * @brief Compile filter into sorted tables. Needs to be called after adding entries
+ * @param filter
+ */
+void ad_filter_compile(ad_filter_t * filter);
+
+/**
+ * @brief Evaluate Advertising Report and update counters
+ * @param filter
+ * @param address_type
+ * @param address
+ * @param rssi
+ * @param ad_len
+ * @param ad_data
+ * @param now_ms current time for duplicate suppression
+ * @return 1 if report passes filter
+ */
+int ad_filter_match(ad_filter_t * filter, uint8_t address_type, const bd_addr_t address, int8_t rssi, uint8_t ad_len, const uint8_t * ad_data, uint32_t now_ms);
+
+/**
+ * @brief Reset matched and dropped counters
+ * @param filter
+ */
+void ad_filter_reset_counters(ad_filter_t * filter);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+#endif // __AD_FILTER_H
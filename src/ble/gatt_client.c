@@ -51,10 +51,12 @@
 #include "ble/gatt_client.h"
 #include "ble/le_device_db.h"
 #include "ble/sm.h"
+#include "bluetooth_gatt.h"
 #include "btstack_debug.h"
 #include "btstack_event.h"
 #include "btstack_memory.h"
 #include "btstack_run_loop.h"
+#include "btstack_tlv.h"
 #include "btstack_util.h"
 #include "classic/sdp_util.h"
 #include "hci.h"
@@ -76,6 +78,23 @@ static void gatt_client_report_error_if_pending(gatt_client_t *peripheral, uint8
 static void att_signed_write_handle_cmac_result(uint8_t hash[8]);
 #endif
 
+#ifdef ENABLE_GATT_CLIENT_CACHE
+static void gatt_client_cache_init(void);
+static void gatt_client_cache_add_service(gatt_client_t * peripheral, uint16_t start_group_handle, uint16_t end_group_handle, const uint8_t * uuid128);
+static void gatt_client_cache_add_characteristic(gatt_client_t * peripheral, uint16_t start_handle, uint16_t value_handle, uint16_t end_handle, uint16_t properties, const uint8_t * uuid128);
+static void gatt_client_cache_add_descriptor(gatt_client_t * peripheral, uint16_t descriptor_handle, const uint8_t * uuid128);
+static void gatt_client_cache_query_complete(gatt_client_t * peripheral, uint8_t status);
+static int  gatt_client_cache_report_pending(gatt_client_t * peripheral);
+static int  gatt_client_cache_report(gatt_client_t * peripheral);
+static void gatt_client_run(void);
+#endif
+
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+static void gatt_client_queue_init(gatt_client_t * peripheral);
+static int  gatt_client_queue_will_queue(gatt_client_t * peripheral);
+static void gatt_client_queue_flush(gatt_client_t * peripheral, uint8_t status);
+#endif
+
 static uint16_t peripheral_mtu(gatt_client_t *peripheral){
     if (peripheral->mtu > l2cap_max_le_mtu()){
         log_error("Peripheral mtu is not initialized");
@@ -87,6 +106,9 @@ static uint16_t peripheral_mtu(gatt_client_t *peripheral){
 void gatt_client_init(void){
     gatt_client_connections = NULL;
     mtu_exchange_enabled = 1;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    gatt_client_cache_init();
+#endif
     // regsister for HCI Events
     hci_event_callback_registration.callback = &gatt_client_hci_event_packet_handler;
     hci_add_event_handler(&hci_event_callback_registration);
@@ -111,7 +133,10 @@ static void gatt_client_timeout_handler(btstack_timer_source_t * timer){
     gatt_client_t * peripheral = gatt_client_for_timer(timer);
     if (!peripheral) return;
     log_info("GATT client timeout handle, handle 0x%02x", peripheral->con_handle);
-    gatt_client_report_error_if_pending(peripheral, ATT_ERROR_TIMEOUT);           
+    gatt_client_report_error_if_pending(peripheral, ATT_ERROR_TIMEOUT);
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    gatt_client_queue_flush(peripheral, ATT_ERROR_TIMEOUT);
+#endif
 }
 
 static void gatt_client_timeout_start(gatt_client_t * peripheral){
@@ -162,6 +187,9 @@ static gatt_client_t * provide_context_for_conn_handle(hci_con_handle_t con_hand
         context->mtu_state = MTU_AUTO_EXCHANGE_DISABLED;
     }
     context->gatt_client_state = P_READY;
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    gatt_client_queue_init(context);
+#endif
     btstack_linked_list_add(&gatt_client_connections, (btstack_linked_item_t*)context);
     return context;
 }
@@ -169,6 +197,10 @@ static gatt_client_t * provide_context_for_conn_handle(hci_con_handle_t con_hand
 static gatt_client_t * provide_context_for_conn_handle_and_start_timer(hci_con_handle_t con_handle){
     gatt_client_t * context = provide_context_for_conn_handle(con_handle);
     if (!context) return NULL;
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    // queued operation: timer is started when it gets dispatched
+    if (gatt_client_queue_will_queue(context)) return context;
+#endif
     gatt_client_timeout_start(context);
     return context;
 }
@@ -411,6 +443,10 @@ static void send_gatt_read_multiple_request(gatt_client_t * peripheral){
     att_read_multiple_request(peripheral->con_handle, peripheral->read_multiple_handle_count, peripheral->read_multiple_handles);
 }
 
+static void send_gatt_read_multiple_batch_request(gatt_client_t * peripheral){
+    att_read_multiple_request(peripheral->con_handle, peripheral->read_multiple_batch_count, &peripheral->read_multiple_handles[peripheral->read_multiple_index]);
+}
+
 static void send_gatt_write_attribute_value_request(gatt_client_t * peripheral){
     att_write_request(ATT_WRITE_REQUEST, peripheral->con_handle, peripheral->attribute_handle, peripheral->attribute_length, peripheral->attribute_value);
 }
@@ -500,6 +536,9 @@ static void emit_gatt_complete_event(gatt_client_t * peripheral, uint8_t status)
     packet[1] = 3;
     little_endian_store_16(packet, 2, peripheral->con_handle);
     packet[4] = status;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    gatt_client_cache_query_complete(peripheral, status);
+#endif
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
 
@@ -513,6 +552,9 @@ static void emit_gatt_service_query_result_event(gatt_client_t * peripheral, uin
     little_endian_store_16(packet, 4, start_group_handle);
     little_endian_store_16(packet, 6, end_group_handle);
     reverse_128(uuid128, &packet[8]);
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    gatt_client_cache_add_service(peripheral, start_group_handle, end_group_handle, uuid128);
+#endif
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
 
@@ -544,6 +586,9 @@ static void emit_gatt_characteristic_query_result_event(gatt_client_t * peripher
     little_endian_store_16(packet, 8,  end_handle);
     little_endian_store_16(packet, 10, properties);
     reverse_128(uuid128, &packet[12]);
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    gatt_client_cache_add_characteristic(peripheral, start_handle, value_handle, end_handle, properties, uuid128);
+#endif
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
 
@@ -557,6 +602,9 @@ static void emit_gatt_all_characteristic_descriptors_result_event(
     ///
     little_endian_store_16(packet, 4,  descriptor_handle);
     reverse_128(uuid128, &packet[6]);
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    gatt_client_cache_add_descriptor(peripheral, descriptor_handle, uuid128);
+#endif
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
 
@@ -570,6 +618,436 @@ static void emit_gatt_mtu_exchanged_result_event(gatt_client_t * peripheral, uin
     att_dispatch_client_mtu_exchanged(peripheral->con_handle, new_mtu);
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
+#ifdef ENABLE_GATT_CLIENT_CACHE
+
+// Discovery cache: attribute layout of bonded devices, keyed by identity address and stored in the TLV
+// per LE Device DB entry. Services, the characteristics of a service and the descriptors of a characteristic
+// are only reported from the cache after a complete discovery of them has been recorded.
+
+#ifndef GATT_CLIENT_CACHE_NUM_ENTRIES
+#define GATT_CLIENT_CACHE_NUM_ENTRIES 1
+#endif
+
+#ifndef GATT_CLIENT_CACHE_MAX_SERVICES
+#define GATT_CLIENT_CACHE_MAX_SERVICES 8
+#endif
+
+#ifndef GATT_CLIENT_CACHE_MAX_CHARACTERISTICS
+#define GATT_CLIENT_CACHE_MAX_CHARACTERISTICS 24
+#endif
+
+#ifndef GATT_CLIENT_CACHE_MAX_DESCRIPTORS
+#define GATT_CLIENT_CACHE_MAX_DESCRIPTORS 24
+#endif
+
+typedef enum {
+    GATT_CLIENT_CACHE_QUERY_NONE = 0,
+    GATT_CLIENT_CACHE_QUERY_SERVICES,
+    GATT_CLIENT_CACHE_QUERY_CHARACTERISTICS,
+    GATT_CLIENT_CACHE_QUERY_DESCRIPTORS,
+} gatt_client_cache_query_t;
+
+typedef struct {
+    uint16_t start_group_handle;
+    uint16_t end_group_handle;
+    uint8_t  uuid128[16];
+    uint8_t  characteristics_complete;
+} gatt_client_cache_service_t;
+
+typedef struct {
+    uint16_t start_handle;
+    uint16_t value_handle;
+    uint16_t end_handle;
+    uint16_t properties;
+    uint8_t  uuid128[16];
+    uint8_t  descriptors_complete;
+} gatt_client_cache_characteristic_t;
+
+typedef struct {
+    uint16_t handle;
+    uint8_t  uuid128[16];
+} gatt_client_cache_descriptor_t;
+
+typedef struct gatt_client_cache {
+    // identity address
+    int       addr_type;
+    bd_addr_t addr;
+    int       le_device_index;
+
+    uint8_t   valid;
+    uint8_t   services_complete;
+    uint8_t   num_services;
+    uint8_t   num_characteristics;
+    uint8_t   num_descriptors;
+
+    gatt_client_cache_service_t        services[GATT_CLIENT_CACHE_MAX_SERVICES];
+    gatt_client_cache_characteristic_t characteristics[GATT_CLIENT_CACHE_MAX_CHARACTERISTICS];
+    gatt_client_cache_descriptor_t     descriptors[GATT_CLIENT_CACHE_MAX_DESCRIPTORS];
+} gatt_client_cache_t;
+
+static gatt_client_cache_t gatt_client_cache_entries[GATT_CLIENT_CACHE_NUM_ENTRIES];
+static int                 gatt_client_cache_next_entry;
+
+static void gatt_client_cache_init(void){
+    memset(gatt_client_cache_entries, 0, sizeof(gatt_client_cache_entries));
+    gatt_client_cache_next_entry = 0;
+}
+
+static const char gatt_client_cache_tag_0 = 'G';
+static const char gatt_client_cache_tag_1 = 'C';
+static const char gatt_client_cache_tag_2 = 'C';
+static const char gatt_client_cache_tag_1_extended = 'c';
+
+static uint32_t gatt_client_cache_tag_for_index(int index){
+    if (index < 0x100){
+        return (gatt_client_cache_tag_0 << 24) | (gatt_client_cache_tag_1 << 16) | (gatt_client_cache_tag_2 << 8) | index;
+    }
+    // more than 256 entries
+    return (gatt_client_cache_tag_0 << 24) | (gatt_client_cache_tag_1_extended << 16) | index;
+}
+
+static int gatt_client_cache_uuid16_matches(const uint8_t * uuid128, uint16_t uuid16){
+    if (!uuid_has_bluetooth_prefix(uuid128)) return 0;
+    return big_endian_read_32(uuid128, 0) == uuid16;
+}
+
+static void gatt_client_cache_store(gatt_client_cache_t * cache){
+    const btstack_tlv_t * tlv_impl;
+    void * tlv_context;
+    btstack_tlv_get_instance(&tlv_impl, &tlv_context);
+    if (!tlv_impl) return;
+    tlv_impl->store_tag(tlv_context, gatt_client_cache_tag_for_index(cache->le_device_index), (const uint8_t *) cache, sizeof(gatt_client_cache_t));
+}
+
+// stop recording into cache entry, e.g. when it gets reused or invalidated
+static void gatt_client_cache_detach(gatt_client_cache_t * cache){
+    btstack_linked_item_t *it;
+    for (it = (btstack_linked_item_t *) gatt_client_connections; it ; it = it->next){
+        gatt_client_t * peripheral = (gatt_client_t *) it;
+        if (peripheral->cache != cache) continue;
+        peripheral->cache = NULL;
+        peripheral->cache_query = GATT_CLIENT_CACHE_QUERY_NONE;
+    }
+}
+
+static void gatt_client_cache_invalidate(gatt_client_cache_t * cache){
+    log_info("GATT client cache invalidated for %s", bd_addr_to_str(cache->addr));
+    gatt_client_cache_detach(cache);
+    cache->services_complete   = 0;
+    cache->num_services        = 0;
+    cache->num_characteristics = 0;
+    cache->num_descriptors     = 0;
+    const btstack_tlv_t * tlv_impl;
+    void * tlv_context;
+    btstack_tlv_get_instance(&tlv_impl, &tlv_context);
+    if (!tlv_impl) return;
+    tlv_impl->delete_tag(tlv_context, gatt_client_cache_tag_for_index(cache->le_device_index));
+}
+
+// @returns cache entry for bonded device, loaded from TLV if needed, or NULL if device is not bonded
+static gatt_client_cache_t * gatt_client_cache_for_peripheral(gatt_client_t * peripheral){
+    int le_device_index = sm_le_device_index(peripheral->con_handle);
+    if (le_device_index < 0) return NULL;
+    int addr_type;
+    bd_addr_t addr;
+    le_device_db_info(le_device_index, &addr_type, addr, NULL);
+
+    int i;
+    for (i=0;i<GATT_CLIENT_CACHE_NUM_ENTRIES;i++){
+        gatt_client_cache_t * cache = &gatt_client_cache_entries[i];
+        if (!cache->valid) continue;
+        if (cache->le_device_index != le_device_index) continue;
+        if (cache->addr_type != addr_type) continue;
+        if (bd_addr_cmp(cache->addr, addr) != 0) continue;
+        return cache;
+    }
+
+    // reuse entries round-robin
+    gatt_client_cache_t * cache = &gatt_client_cache_entries[gatt_client_cache_next_entry];
+    gatt_client_cache_next_entry = (gatt_client_cache_next_entry + 1) % GATT_CLIENT_CACHE_NUM_ENTRIES;
+    gatt_client_cache_detach(cache);
+
+    // stored entry belongs to identity address unless LE Device DB entry was reused
+    const btstack_tlv_t * tlv_impl;
+    void * tlv_context;
+    btstack_tlv_get_instance(&tlv_impl, &tlv_context);
+    int size = 0;
+    if (tlv_impl){
+        size = tlv_impl->get_tag(tlv_context, gatt_client_cache_tag_for_index(le_device_index), (uint8_t *) cache, sizeof(gatt_client_cache_t));
+    }
+    if (size != sizeof(gatt_client_cache_t) || cache->addr_type != addr_type || bd_addr_cmp(cache->addr, addr) != 0){
+        memset(cache, 0, sizeof(gatt_client_cache_t));
+        cache->addr_type = addr_type;
+        memcpy(cache->addr, addr, 6);
+    } else {
+        log_info("GATT client cache loaded for %s, %u services", bd_addr_to_str(addr), cache->num_services);
+    }
+    cache->le_device_index = le_device_index;
+    cache->valid = 1;
+    return cache;
+}
+
+static void gatt_client_cache_record(gatt_client_t * peripheral, gatt_client_cache_t * cache, gatt_client_cache_query_t query, uint16_t index){
+    peripheral->cache = cache;
+    peripheral->cache_query = query;
+    peripheral->cache_query_index = index;
+}
+
+static void gatt_client_cache_remove_characteristics(gatt_client_cache_t * cache, uint16_t start_handle, uint16_t end_handle){
+    int i;
+    int pos = 0;
+    for (i=0;i<cache->num_characteristics;i++){
+        gatt_client_cache_characteristic_t * characteristic = &cache->characteristics[i];
+        if (characteristic->start_handle >= start_handle && characteristic->start_handle <= end_handle) continue;
+        cache->characteristics[pos++] = *characteristic;
+    }
+    cache->num_characteristics = pos;
+}
+
+static void gatt_client_cache_remove_descriptors(gatt_client_cache_t * cache, uint16_t start_handle, uint16_t end_handle){
+    int i;
+    int pos = 0;
+    for (i=0;i<cache->num_descriptors;i++){
+        gatt_client_cache_descriptor_t * descriptor = &cache->descriptors[i];
+        if (descriptor->handle >= start_handle && descriptor->handle <= end_handle) continue;
+        cache->descriptors[pos++] = *descriptor;
+    }
+    cache->num_descriptors = pos;
+}
+
+static void gatt_client_cache_add_service(gatt_client_t * peripheral, uint16_t start_group_handle, uint16_t end_group_handle, const uint8_t * uuid128){
+    if (peripheral->cache_query != GATT_CLIENT_CACHE_QUERY_SERVICES) return;
+    gatt_client_cache_t * cache = peripheral->cache;
+    if (cache->num_services >= GATT_CLIENT_CACHE_MAX_SERVICES){
+        log_info("GATT client cache: too many services, increase GATT_CLIENT_CACHE_MAX_SERVICES");
+        peripheral->cache_query = GATT_CLIENT_CACHE_QUERY_NONE;
+        return;
+    }
+    gatt_client_cache_service_t * service = &cache->services[cache->num_services++];
+    service->start_group_handle = start_group_handle;
+    service->end_group_handle   = end_group_handle;
+    memcpy(service->uuid128, uuid128, 16);
+    service->characteristics_complete = 0;
+}
+
+static void gatt_client_cache_add_characteristic(gatt_client_t * peripheral, uint16_t start_handle, uint16_t value_handle, uint16_t end_handle, uint16_t properties, const uint8_t * uuid128){
+    if (peripheral->cache_query != GATT_CLIENT_CACHE_QUERY_CHARACTERISTICS) return;
+    gatt_client_cache_t * cache = peripheral->cache;
+    if (cache->num_characteristics >= GATT_CLIENT_CACHE_MAX_CHARACTERISTICS){
+        log_info("GATT client cache: too many characteristics, increase GATT_CLIENT_CACHE_MAX_CHARACTERISTICS");
+        peripheral->cache_query = GATT_CLIENT_CACHE_QUERY_NONE;
+        return;
+    }
+    gatt_client_cache_characteristic_t * characteristic = &cache->characteristics[cache->num_characteristics++];
+    characteristic->start_handle = start_handle;
+    characteristic->value_handle = value_handle;
+    characteristic->end_handle   = end_handle;
+    characteristic->properties   = properties;
+    memcpy(characteristic->uuid128, uuid128, 16);
+    characteristic->descriptors_complete = 0;
+}
+
+static void gatt_client_cache_add_descriptor(gatt_client_t * peripheral, uint16_t descriptor_handle, const uint8_t * uuid128){
+    if (peripheral->cache_query != GATT_CLIENT_CACHE_QUERY_DESCRIPTORS) return;
+    gatt_client_cache_t * cache = peripheral->cache;
+    if (cache->num_descriptors >= GATT_CLIENT_CACHE_MAX_DESCRIPTORS){
+        log_info("GATT client cache: too many descriptors, increase GATT_CLIENT_CACHE_MAX_DESCRIPTORS");
+        peripheral->cache_query = GATT_CLIENT_CACHE_QUERY_NONE;
+        return;
+    }
+    gatt_client_cache_descriptor_t * descriptor = &cache->descriptors[cache->num_descriptors++];
+    descriptor->handle = descriptor_handle;
+    memcpy(descriptor->uuid128, uuid128, 16);
+}
+
+static void gatt_client_cache_query_complete(gatt_client_t * peripheral, uint8_t status){
+    gatt_client_cache_query_t query = (gatt_client_cache_query_t) peripheral->cache_query;
+    peripheral->cache_query = GATT_CLIENT_CACHE_QUERY_NONE;
+    if (query == GATT_CLIENT_CACHE_QUERY_NONE) return;
+    if (status) return;
+    gatt_client_cache_t * cache = peripheral->cache;
+    switch (query){
+        case GATT_CLIENT_CACHE_QUERY_SERVICES:
+            cache->services_complete = 1;
+            break;
+        case GATT_CLIENT_CACHE_QUERY_CHARACTERISTICS:
+            cache->services[peripheral->cache_query_index].characteristics_complete = 1;
+            break;
+        case GATT_CLIENT_CACHE_QUERY_DESCRIPTORS:
+            cache->characteristics[peripheral->cache_query_index].descriptors_complete = 1;
+            break;
+        default:
+            return;
+    }
+    gatt_client_cache_store(cache);
+}
+
+// cached results are reported from the run loop, not from within the discover call
+static void gatt_client_cache_report_handler(btstack_timer_source_t * timer){
+    UNUSED(timer);
+    gatt_client_run();
+}
+
+static void gatt_client_cache_report_schedule(gatt_client_t * peripheral, gatt_client_cache_t * cache, gatt_client_state_t state){
+    peripheral->cache = cache;
+    peripheral->gatt_client_state = state;
+    // no ATT transaction, use ATT timer to get called from the run loop
+    btstack_run_loop_remove_timer(&peripheral->gc_timeout);
+    btstack_run_loop_set_timer_handler(&peripheral->gc_timeout, gatt_client_cache_report_handler);
+    btstack_run_loop_set_timer(&peripheral->gc_timeout, 0);
+    btstack_run_loop_add_timer(&peripheral->gc_timeout);
+}
+
+// @returns 1 if services will be reported from cache, uuid128 == NULL for all services
+static int gatt_client_cache_report_services(gatt_client_t * peripheral, const uint8_t * uuid128){
+    gatt_client_cache_t * cache = gatt_client_cache_for_peripheral(peripheral);
+    if (!cache) return 0;
+    if (!cache->services_complete){
+        if (uuid128) return 0;
+        // start recording
+        cache->num_services        = 0;
+        cache->num_characteristics = 0;
+        cache->num_descriptors     = 0;
+        gatt_client_cache_record(peripheral, cache, GATT_CLIENT_CACHE_QUERY_SERVICES, 0);
+        return 0;
+    }
+    gatt_client_cache_report_schedule(peripheral, cache, P_W2_REPORT_CACHED_SERVICES);
+    return 1;
+}
+
+// @returns 1 if characteristics will be reported from cache, uuid128 == NULL for all characteristics
+static int gatt_client_cache_report_characteristics(gatt_client_t * peripheral, uint16_t start_handle, uint16_t end_handle, const uint8_t * uuid128){
+    gatt_client_cache_t * cache = gatt_client_cache_for_peripheral(peripheral);
+    if (!cache) return 0;
+    if (!cache->services_complete) return 0;
+    int i;
+    for (i=0;i<cache->num_services;i++){
+        gatt_client_cache_service_t * service = &cache->services[i];
+        if (service->start_group_handle == start_handle && service->end_group_handle == end_handle) break;
+    }
+    if (i == cache->num_services) return 0;
+    if (!cache->services[i].characteristics_complete){
+        if (uuid128) return 0;
+        // start recording
+        gatt_client_cache_remove_characteristics(cache, start_handle, end_handle);
+        gatt_client_cache_remove_descriptors(cache, start_handle, end_handle);
+        gatt_client_cache_record(peripheral, cache, GATT_CLIENT_CACHE_QUERY_CHARACTERISTICS, i);
+        return 0;
+    }
+    gatt_client_cache_report_schedule(peripheral, cache, P_W2_REPORT_CACHED_CHARACTERISTICS);
+    return 1;
+}
+
+// @returns 1 if descriptors will be reported from cache
+static int gatt_client_cache_report_descriptors(gatt_client_t * peripheral, gatt_client_characteristic_t * characteristic){
+    gatt_client_cache_t * cache = gatt_client_cache_for_peripheral(peripheral);
+    if (!cache) return 0;
+    int i;
+    for (i=0;i<cache->num_characteristics;i++){
+        gatt_client_cache_characteristic_t * cached = &cache->characteristics[i];
+        if (cached->value_handle == characteristic->value_handle && cached->end_handle == characteristic->end_handle) break;
+    }
+    if (i == cache->num_characteristics) return 0;
+    if (!cache->characteristics[i].descriptors_complete){
+        // start recording
+        gatt_client_cache_remove_descriptors(cache, characteristic->value_handle + 1, characteristic->end_handle);
+        gatt_client_cache_record(peripheral, cache, GATT_CLIENT_CACHE_QUERY_DESCRIPTORS, i);
+        return 0;
+    }
+    gatt_client_cache_report_schedule(peripheral, cache, P_W2_REPORT_CACHED_DESCRIPTORS);
+    return 1;
+}
+
+static int gatt_client_cache_report_pending(gatt_client_t * peripheral){
+    switch (peripheral->gatt_client_state){
+        case P_W2_REPORT_CACHED_SERVICES:
+        case P_W2_REPORT_CACHED_CHARACTERISTICS:
+        case P_W2_REPORT_CACHED_DESCRIPTORS:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// report results of scheduled query from cache, query is sent instead if cache was invalidated meanwhile
+// @returns 1 if query has been completed
+static int gatt_client_cache_report(gatt_client_t * peripheral){
+    gatt_client_cache_t * cache = peripheral->cache;
+    gatt_client_state_t state = peripheral->gatt_client_state;
+    uint16_t start_handle = peripheral->start_group_handle;
+    uint16_t end_handle   = peripheral->end_group_handle;
+    int i;
+
+    if (!cache){
+        gatt_client_timeout_start(peripheral);
+        switch (state){
+            case P_W2_REPORT_CACHED_SERVICES:
+                peripheral->gatt_client_state = peripheral->filter_with_uuid ? P_W2_SEND_SERVICE_WITH_UUID_QUERY : P_W2_SEND_SERVICE_QUERY;
+                break;
+            case P_W2_REPORT_CACHED_CHARACTERISTICS:
+                peripheral->characteristic_start_handle = 0;
+                peripheral->gatt_client_state = peripheral->filter_with_uuid ? P_W2_SEND_CHARACTERISTIC_WITH_UUID_QUERY : P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY;
+                break;
+            default:
+                peripheral->gatt_client_state = P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY;
+                break;
+        }
+        return 0;
+    }
+
+    gatt_client_handle_transaction_complete(peripheral);
+    switch (state){
+        case P_W2_REPORT_CACHED_SERVICES:
+            for (i=0;i<cache->num_services;i++){
+                gatt_client_cache_service_t * service = &cache->services[i];
+                if (peripheral->filter_with_uuid && memcmp(service->uuid128, peripheral->uuid128, 16) != 0) continue;
+                emit_gatt_service_query_result_event(peripheral, service->start_group_handle, service->end_group_handle, service->uuid128);
+            }
+            break;
+        case P_W2_REPORT_CACHED_CHARACTERISTICS:
+            for (i=0;i<cache->num_characteristics;i++){
+                gatt_client_cache_characteristic_t * characteristic = &cache->characteristics[i];
+                if (characteristic->start_handle < start_handle || characteristic->start_handle > end_handle) continue;
+                if (peripheral->filter_with_uuid && memcmp(characteristic->uuid128, peripheral->uuid128, 16) != 0) continue;
+                emit_gatt_characteristic_query_result_event(peripheral, characteristic->start_handle, characteristic->value_handle,
+                    characteristic->end_handle, characteristic->properties, characteristic->uuid128);
+            }
+            break;
+        default:
+            for (i=0;i<cache->num_descriptors;i++){
+                gatt_client_cache_descriptor_t * descriptor = &cache->descriptors[i];
+                if (descriptor->handle < start_handle || descriptor->handle > end_handle) continue;
+                emit_gatt_all_characteristic_descriptors_result_event(peripheral, descriptor->handle, descriptor->uuid128);
+            }
+            break;
+    }
+    emit_gatt_complete_event(peripheral, 0);
+    return 1;
+}
+
+// Service Changed indication invalidates the complete cache of the bonded device
+static void gatt_client_cache_handle_indication(gatt_client_t * peripheral, uint16_t value_handle){
+    gatt_client_cache_t * cache = gatt_client_cache_for_peripheral(peripheral);
+    if (!cache) return;
+    int i;
+    for (i=0;i<cache->num_characteristics;i++){
+        gatt_client_cache_characteristic_t * characteristic = &cache->characteristics[i];
+        if (characteristic->value_handle != value_handle) continue;
+        if (!gatt_client_cache_uuid16_matches(characteristic->uuid128, ORG_BLUETOOTH_CHARACTERISTIC_GATT_SERVICE_CHANGED)) return;
+        gatt_client_cache_invalidate(cache);
+        return;
+    }
+    // Service Changed characteristic not discovered yet, treat all indications from the GATT Service as such
+    for (i=0;i<cache->num_services;i++){
+        gatt_client_cache_service_t * service = &cache->services[i];
+        if (!gatt_client_cache_uuid16_matches(service->uuid128, ORG_BLUETOOTH_SERVICE_GENERIC_ATTRIBUTE)) continue;
+        if (value_handle < service->start_group_handle || value_handle > service->end_group_handle) continue;
+        gatt_client_cache_invalidate(cache);
+        return;
+    }
+}
+#endif
+
 ///
 static void report_gatt_services(gatt_client_t * peripheral, uint8_t * packet,  uint16_t size){
     uint8_t attr_length = packet[1];
@@ -808,6 +1286,77 @@ static void trigger_next_blob_query(gatt_client_t * peripheral, gatt_client_stat
     peripheral->gatt_client_state = next_query_state;
 }
 
+// batched reads: pack values with known length into Read Multiple Request, read others one by one
+static void trigger_next_read_batch(gatt_client_t * peripheral){
+    uint16_t index = peripheral->read_multiple_index;
+    if (index >= peripheral->read_multiple_handle_count){
+        gatt_client_handle_transaction_complete(peripheral);
+        emit_gatt_complete_event(peripheral, 0);
+        return;
+    }
+
+    uint16_t mtu = peripheral_mtu(peripheral);
+    uint16_t max_value_length = mtu - 1;
+    peripheral->attribute_handle = peripheral->read_multiple_handles[index];
+    peripheral->attribute_offset = 0;
+
+    uint16_t num_values = 0;
+    if (peripheral->read_multiple_single_count == 0){
+        uint16_t request_length  = 1;
+        uint16_t response_length = 1;
+        while ((index + num_values) < peripheral->read_multiple_handle_count){
+            uint16_t value_length = peripheral->read_multiple_lengths[index + num_values];
+            if (value_length == 0 || value_length > max_value_length) break;
+            if ((request_length + 2) > mtu) break;
+            if ((response_length + value_length) > mtu) break;
+            request_length  += 2;
+            response_length += value_length;
+            num_values++;
+        }
+    }
+
+    if (num_values >= 2){
+        peripheral->read_multiple_batch_count = num_values;
+        peripheral->gatt_client_state = P_W2_SEND_READ_MULTIPLE_BATCH_REQUEST;
+    } else if (peripheral->read_multiple_lengths[index] > max_value_length){
+        peripheral->gatt_client_state = P_W2_SEND_READ_BATCH_BLOB_QUERY;
+    } else {
+        peripheral->gatt_client_state = P_W2_SEND_READ_BATCH_VALUE_QUERY;
+    }
+}
+
+static void trigger_next_read_batch_after_single_value(gatt_client_t * peripheral){
+    peripheral->read_multiple_index++;
+    if (peripheral->read_multiple_single_count){
+        peripheral->read_multiple_single_count--;
+    }
+    trigger_next_read_batch(peripheral);
+}
+
+static void handle_read_multiple_batch_response(gatt_client_t * peripheral, uint8_t * packet, uint16_t size){
+    uint16_t index = peripheral->read_multiple_index;
+    uint16_t expected_length = 0;
+    int i;
+    for (i=0;i<peripheral->read_multiple_batch_count;i++){
+        expected_length += peripheral->read_multiple_lengths[index + i];
+    }
+    if ((size - 1) != expected_length){
+        log_info("Read Multiple Response with %u bytes instead of %u, read values one by one", size - 1, expected_length);
+        peripheral->read_multiple_single_count = peripheral->read_multiple_batch_count;
+        trigger_next_read_batch(peripheral);
+        return;
+    }
+    // report values in order, each event header overwrites the end of the previous value
+    uint16_t offset = 1;
+    for (i=0;i<peripheral->read_multiple_batch_count;i++){
+        uint16_t value_length = peripheral->read_multiple_lengths[index + i];
+        report_gatt_characteristic_value(peripheral, peripheral->read_multiple_handles[index + i], &packet[offset], value_length);
+        offset += value_length;
+    }
+    peripheral->read_multiple_index += peripheral->read_multiple_batch_count;
+    trigger_next_read_batch(peripheral);
+}
+
 
 static int is_value_valid(gatt_client_t *peripheral, uint8_t *packet, uint16_t size){
     uint16_t attribute_handle = little_endian_read_16(packet, 1);
@@ -819,6 +1368,236 @@ static int is_value_valid(gatt_client_t *peripheral, uint8_t *packet, uint16_t s
 }
 
 // returns 1 if packet was sent
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+
+// Operation queue: operations started while another one is active are stored per connection
+// and started in order by gatt_client_run. Write Commands are copied into a ring buffer instead.
+
+typedef enum {
+    GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES,
+    GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES_BY_UUID16,
+    GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES_BY_UUID128,
+    GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_FOR_SERVICE,
+    GATT_CLIENT_OPERATION_FIND_INCLUDED_SERVICES_FOR_SERVICE,
+    GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_BY_UUID16,
+    GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_BY_UUID128,
+    GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTIC_DESCRIPTORS,
+    GATT_CLIENT_OPERATION_READ_VALUE,
+    GATT_CLIENT_OPERATION_READ_VALUES_BY_UUID16,
+    GATT_CLIENT_OPERATION_READ_VALUES_BY_UUID128,
+    GATT_CLIENT_OPERATION_READ_LONG_VALUE,
+    GATT_CLIENT_OPERATION_READ_MULTIPLE_VALUES,
+    GATT_CLIENT_OPERATION_READ_VALUES_BATCHED,
+    GATT_CLIENT_OPERATION_WRITE_VALUE,
+    GATT_CLIENT_OPERATION_WRITE_LONG_VALUE,
+    GATT_CLIENT_OPERATION_RELIABLE_WRITE_LONG_VALUE,
+    GATT_CLIENT_OPERATION_WRITE_CLIENT_CHARACTERISTIC_CONFIGURATION,
+    GATT_CLIENT_OPERATION_READ_DESCRIPTOR,
+    GATT_CLIENT_OPERATION_READ_LONG_DESCRIPTOR,
+    GATT_CLIENT_OPERATION_WRITE_DESCRIPTOR,
+    GATT_CLIENT_OPERATION_WRITE_LONG_DESCRIPTOR,
+    GATT_CLIENT_OPERATION_PREPARE_WRITE,
+    GATT_CLIENT_OPERATION_EXECUTE_WRITE,
+    GATT_CLIENT_OPERATION_CANCEL_WRITE,
+} gatt_client_operation_type_t;
+
+// set while a queued operation is started, consumed by gatt_client_queue_required
+static int gatt_client_queue_dispatch_active;
+
+static void gatt_client_queue_init(gatt_client_t * peripheral){
+    peripheral->queue_head  = 0;
+    peripheral->queue_count = 0;
+    btstack_ring_buffer_init(&peripheral->write_command_queue, peripheral->write_command_storage, sizeof(peripheral->write_command_storage));
+}
+
+// @returns 1 if operation will be queued by gatt_client_queue_required
+static int gatt_client_queue_will_queue(gatt_client_t * peripheral){
+    if (gatt_client_queue_dispatch_active) return 0;
+    if (!is_ready(peripheral)) return 1;
+    return peripheral->queue_count > 0;
+}
+
+// @returns 1 if operation has to be queued to keep order
+static int gatt_client_queue_required(gatt_client_t * peripheral){
+    if (gatt_client_queue_dispatch_active){
+        gatt_client_queue_dispatch_active = 0;
+        return 0;
+    }
+    return gatt_client_queue_will_queue(peripheral);
+}
+
+// @returns operation to fill in or NULL if queue is full
+static gatt_client_operation_t * gatt_client_queue_add(gatt_client_t * peripheral, gatt_client_operation_type_t type, btstack_packet_handler_t callback){
+    if (peripheral->queue_count >= GATT_CLIENT_QUEUE_SIZE) return NULL;
+    int index = (peripheral->queue_head + peripheral->queue_count) % GATT_CLIENT_QUEUE_SIZE;
+    peripheral->queue_count++;
+    gatt_client_operation_t * operation = &peripheral->queue[index];
+    memset(operation, 0, sizeof(gatt_client_operation_t));
+    operation->type = type;
+    operation->callback = callback;
+    return operation;
+}
+
+// start next queued operation
+// @returns status of started operation
+static uint8_t gatt_client_queue_dispatch(gatt_client_t * peripheral){
+    gatt_client_operation_t operation = peripheral->queue[peripheral->queue_head];
+    peripheral->queue_head = (peripheral->queue_head + 1) % GATT_CLIENT_QUEUE_SIZE;
+    peripheral->queue_count--;
+
+    gatt_client_service_t service;
+    memset(&service, 0, sizeof(gatt_client_service_t));
+    service.start_group_handle = operation.start_handle;
+    service.end_group_handle   = operation.end_handle;
+
+    gatt_client_characteristic_t characteristic;
+    memset(&characteristic, 0, sizeof(gatt_client_characteristic_t));
+    characteristic.start_handle = operation.start_handle;
+    characteristic.value_handle = operation.attribute_handle;
+    characteristic.end_handle   = operation.end_handle;
+    characteristic.properties   = operation.properties;
+
+    hci_con_handle_t con_handle = peripheral->con_handle;
+    btstack_packet_handler_t callback = operation.callback;
+    uint8_t status;
+
+    gatt_client_queue_dispatch_active = 1;
+    switch ((gatt_client_operation_type_t) operation.type){
+        case GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES:
+            status = gatt_client_discover_primary_services(callback, con_handle);
+            break;
+        case GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES_BY_UUID16:
+            status = gatt_client_discover_primary_services_by_uuid16(callback, con_handle, operation.uuid16);
+            break;
+        case GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES_BY_UUID128:
+            status = gatt_client_discover_primary_services_by_uuid128(callback, con_handle, operation.uuid128);
+            break;
+        case GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_FOR_SERVICE:
+            status = gatt_client_discover_characteristics_for_service(callback, con_handle, &service);
+            break;
+        case GATT_CLIENT_OPERATION_FIND_INCLUDED_SERVICES_FOR_SERVICE:
+            status = gatt_client_find_included_services_for_service(callback, con_handle, &service);
+            break;
+        case GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_BY_UUID16:
+            status = gatt_client_discover_characteristics_for_handle_range_by_uuid16(callback, con_handle, operation.start_handle, operation.end_handle, operation.uuid16);
+            break;
+        case GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_BY_UUID128:
+            status = gatt_client_discover_characteristics_for_handle_range_by_uuid128(callback, con_handle, operation.start_handle, operation.end_handle, operation.uuid128);
+            break;
+        case GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTIC_DESCRIPTORS:
+            status = gatt_client_discover_characteristic_descriptors(callback, con_handle, &characteristic);
+            break;
+        case GATT_CLIENT_OPERATION_READ_VALUE:
+            status = gatt_client_read_value_of_characteristic_using_value_handle(callback, con_handle, operation.attribute_handle);
+            break;
+        case GATT_CLIENT_OPERATION_READ_VALUES_BY_UUID16:
+            status = gatt_client_read_value_of_characteristics_by_uuid16(callback, con_handle, operation.start_handle, operation.end_handle, operation.uuid16);
+            break;
+        case GATT_CLIENT_OPERATION_READ_VALUES_BY_UUID128:
+            status = gatt_client_read_value_of_characteristics_by_uuid128(callback, con_handle, operation.start_handle, operation.end_handle, operation.uuid128);
+            break;
+        case GATT_CLIENT_OPERATION_READ_LONG_VALUE:
+            status = gatt_client_read_long_value_of_characteristic_using_value_handle_with_offset(callback, con_handle, operation.attribute_handle, operation.offset);
+            break;
+        case GATT_CLIENT_OPERATION_READ_MULTIPLE_VALUES:
+            status = gatt_client_read_multiple_characteristic_values(callback, con_handle, operation.length, operation.value_handles);
+            break;
+        case GATT_CLIENT_OPERATION_READ_VALUES_BATCHED:
+            status = gatt_client_read_values_of_characteristics_using_value_handles(callback, con_handle, operation.length, operation.value_handles, operation.value_lengths);
+            break;
+        case GATT_CLIENT_OPERATION_WRITE_VALUE:
+            status = gatt_client_write_value_of_characteristic(callback, con_handle, operation.attribute_handle, operation.length, operation.data);
+            break;
+        case GATT_CLIENT_OPERATION_WRITE_LONG_VALUE:
+            status = gatt_client_write_long_value_of_characteristic_with_offset(callback, con_handle, operation.attribute_handle, operation.offset, operation.length, operation.data);
+            break;
+        case GATT_CLIENT_OPERATION_RELIABLE_WRITE_LONG_VALUE:
+            status = gatt_client_reliable_write_long_value_of_characteristic(callback, con_handle, operation.attribute_handle, operation.length, operation.data);
+            break;
+        case GATT_CLIENT_OPERATION_WRITE_CLIENT_CHARACTERISTIC_CONFIGURATION:
+            status = gatt_client_write_client_characteristic_configuration(callback, con_handle, &characteristic, operation.configuration);
+            break;
+        case GATT_CLIENT_OPERATION_READ_DESCRIPTOR:
+            status = gatt_client_read_characteristic_descriptor_using_descriptor_handle(callback, con_handle, operation.attribute_handle);
+            break;
+        case GATT_CLIENT_OPERATION_READ_LONG_DESCRIPTOR:
+            status = gatt_client_read_long_characteristic_descriptor_using_descriptor_handle_with_offset(callback, con_handle, operation.attribute_handle, operation.offset);
+            break;
+        case GATT_CLIENT_OPERATION_WRITE_DESCRIPTOR:
+            status = gatt_client_write_characteristic_descriptor_using_descriptor_handle(callback, con_handle, operation.attribute_handle, operation.length, operation.data);
+            break;
+        case GATT_CLIENT_OPERATION_WRITE_LONG_DESCRIPTOR:
+            status = gatt_client_write_long_characteristic_descriptor_using_descriptor_handle_with_offset(callback, con_handle, operation.attribute_handle, operation.offset, operation.length, operation.data);
+            break;
+        case GATT_CLIENT_OPERATION_PREPARE_WRITE:
+            status = gatt_client_prepare_write(callback, con_handle, operation.attribute_handle, operation.offset, operation.length, operation.data);
+            break;
+        case GATT_CLIENT_OPERATION_EXECUTE_WRITE:
+            status = gatt_client_execute_write(callback, con_handle);
+            break;
+        case GATT_CLIENT_OPERATION_CANCEL_WRITE:
+            status = gatt_client_cancel_write(callback, con_handle);
+            break;
+        default:
+            status = GATT_CLIENT_IN_WRONG_STATE;
+            break;
+    }
+    gatt_client_queue_dispatch_active = 0;
+
+    if (status){
+        // operation could not be started, report to its callback
+        log_info("GATT client queued operation %u failed with status 0x%02x", operation.type, status);
+        gatt_client_timeout_stop(peripheral);
+        peripheral->callback = callback;
+        emit_gatt_complete_event(peripheral, status);
+    }
+    return status;
+}
+
+// report error to all queued operations, e.g. on disconnect
+static void gatt_client_queue_flush(gatt_client_t * peripheral, uint8_t status){
+    while (peripheral->queue_count){
+        gatt_client_operation_t * operation = &peripheral->queue[peripheral->queue_head];
+        peripheral->queue_head = (peripheral->queue_head + 1) % GATT_CLIENT_QUEUE_SIZE;
+        peripheral->queue_count--;
+        peripheral->callback = operation->callback;
+        emit_gatt_complete_event(peripheral, status);
+    }
+}
+
+static uint8_t gatt_client_queue_write_command(gatt_client_t * peripheral, uint16_t value_handle, uint16_t value_length, uint8_t * value){
+    if (btstack_ring_buffer_bytes_free(&peripheral->write_command_queue) < 4u + value_length) return GATT_CLIENT_BUSY;
+    uint8_t header[4];
+    little_endian_store_16(header, 0, value_handle);
+    little_endian_store_16(header, 2, value_length);
+    btstack_ring_buffer_write(&peripheral->write_command_queue, header, sizeof(header));
+    btstack_ring_buffer_write(&peripheral->write_command_queue, value, value_length);
+    att_dispatch_client_request_can_send_now_event(peripheral->con_handle);
+    return 0;
+}
+
+// send queued Write Commands back to back as long as possible
+// @returns number of packets sent
+static int gatt_client_queue_send_write_commands(gatt_client_t * peripheral){
+    int packets_sent = 0;
+    while (!btstack_ring_buffer_empty(&peripheral->write_command_queue)){
+        if (packets_sent && !att_dispatch_client_can_send_now(peripheral->con_handle)) break;
+        uint8_t header[4];
+        uint32_t bytes_read;
+        btstack_ring_buffer_read(&peripheral->write_command_queue, header, sizeof(header), &bytes_read);
+        uint16_t value_length = little_endian_read_16(header, 2);
+        l2cap_reserve_packet_buffer();
+        uint8_t * request = l2cap_get_outgoing_buffer();
+        request[0] = ATT_WRITE_COMMAND;
+        little_endian_store_16(request, 1, little_endian_read_16(header, 0));
+        btstack_ring_buffer_read(&peripheral->write_command_queue, &request[3], value_length, &bytes_read);
+        l2cap_send_prepared_connectionless(peripheral->con_handle, L2CAP_CID_ATTRIBUTE_PROTOCOL, 3 + value_length);
+        packets_sent++;
+    }
+    return packets_sent;
+}
+#endif
+
 static int gatt_client_run_for_peripheral( gatt_client_t * peripheral){
     // log_info("- handle_peripheral_list, mtu state %u, client state %u", peripheral->mtu_state, peripheral->gatt_client_state);
 
@@ -909,6 +1688,21 @@ static int gatt_client_run_for_peripheral( gatt_client_t * peripheral){
             send_gatt_read_multiple_request(peripheral);
             return 1;
 
+        case P_W2_SEND_READ_MULTIPLE_BATCH_REQUEST:
+            peripheral->gatt_client_state = P_W4_READ_MULTIPLE_BATCH_RESPONSE;
+            send_gatt_read_multiple_batch_request(peripheral);
+            return 1;
+
+        case P_W2_SEND_READ_BATCH_VALUE_QUERY:
+            peripheral->gatt_client_state = P_W4_READ_BATCH_VALUE_RESULT;
+            send_gatt_read_characteristic_value_request(peripheral);
+            return 1;
+
+        case P_W2_SEND_READ_BATCH_BLOB_QUERY:
+            peripheral->gatt_client_state = P_W4_READ_BATCH_BLOB_RESULT;
+            send_gatt_read_blob_request(peripheral);
+            return 1;
+
         case P_W2_SEND_WRITE_CHARACTERISTIC_VALUE:
             peripheral->gatt_client_state = P_W4_WRITE_CHARACTERISTIC_VALUE_RESULT;
             send_gatt_write_attribute_value_request(peripheral);
@@ -1007,6 +1801,10 @@ static int gatt_client_run_for_peripheral( gatt_client_t * peripheral){
             break;
     }
 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_send_write_commands(peripheral)) return 1;
+#endif
+
     // requested can send snow?
     if (peripheral->write_without_response_callback){
         btstack_packet_handler_t packet_handler = peripheral->write_without_response_callback;
@@ -1026,6 +1824,27 @@ static void gatt_client_run(void){
     btstack_linked_item_t *it;
     for (it = (btstack_linked_item_t *) gatt_client_connections; it ; it = it->next){
         gatt_client_t * peripheral = (gatt_client_t *) it;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+        if (gatt_client_cache_report_pending(peripheral) && gatt_client_cache_report(peripheral)){
+            // continue with queued operations
+            // note: iterator has become invalid
+            gatt_client_run();
+            return;
+        }
+#endif
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+        if (is_ready(peripheral) && peripheral->queue_count){
+            // started operation calls gatt_client_run, dispatch next one if it failed to start or completed right away
+            while (is_ready(peripheral) && peripheral->queue_count){
+                gatt_client_queue_dispatch(peripheral);
+            }
+            // note: iterator has become invalid
+            if (is_ready(peripheral)){
+                gatt_client_run();
+            }
+            return;
+        }
+#endif
         if (!att_dispatch_client_can_send_now(peripheral->con_handle)) {
             att_dispatch_client_request_can_send_now_event(peripheral->con_handle);
             return;
@@ -1040,6 +1859,14 @@ static void gatt_client_run(void){
             btstack_linked_list_add_tail(&gatt_client_connections, (btstack_linked_item_t *) peripheral);
             return;
         }
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+        if (is_ready(peripheral) && peripheral->queue_count){
+            // operation completed without sending a packet, continue with queued ones
+            // note: iterator has become invalid
+            gatt_client_run();
+            return;
+        }
+#endif
     }
 }
 
@@ -1063,6 +1890,9 @@ static void gatt_client_hci_event_packet_handler(uint8_t packet_type, uint16_t c
             gatt_client_t * peripheral = get_gatt_client_context_for_handle(con_handle);
             if (!peripheral) break;
             gatt_client_report_error_if_pending(peripheral, ATT_ERROR_HCI_DISCONNECT_RECEIVED);
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+            gatt_client_queue_flush(peripheral, ATT_ERROR_HCI_DISCONNECT_RECEIVED);
+#endif
             
             btstack_linked_list_remove(&gatt_client_connections, (btstack_linked_item_t *) peripheral);
             btstack_memory_gatt_client_free(peripheral);
@@ -1135,6 +1965,9 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
             }
             break;
         case ATT_HANDLE_VALUE_INDICATION:
+#ifdef ENABLE_GATT_CLIENT_CACHE
+            gatt_client_cache_handle_indication(peripheral, little_endian_read_16(packet,1));
+#endif
             report_gatt_indication(handle, little_endian_read_16(packet,1), &packet[3], size-3);
             peripheral->send_confirmation = 1;
             break;
@@ -1214,6 +2047,12 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
                     emit_gatt_complete_event(peripheral, 0);
                     break;
 
+                case P_W4_READ_BATCH_VALUE_RESULT:
+                    report_gatt_characteristic_value(peripheral, peripheral->attribute_handle, &packet[1], size-1);
+                    trigger_next_read_batch_after_single_value(peripheral);
+                    // GATT_EVENT_QUERY_COMPLETE is emitted by trigger_next_xxx when done
+                    break;
+
                 case P_W4_READ_CHARACTERISTIC_DESCRIPTOR_RESULT:{
                     gatt_client_handle_transaction_complete(peripheral);
                     report_gatt_characteristic_descriptor(peripheral, peripheral->attribute_handle, &packet[1], size-1, 0);
@@ -1280,6 +2119,16 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
                     trigger_next_blob_query(peripheral, P_W2_SEND_READ_BLOB_QUERY, received_blob_length);
                     // GATT_EVENT_QUERY_COMPLETE is emitted by trigger_next_xxx when done
                     break;
+                case P_W4_READ_BATCH_BLOB_RESULT:
+                    report_gatt_long_characteristic_value_blob(peripheral, peripheral->attribute_handle, &packet[1], received_blob_length, peripheral->attribute_offset);
+                    if (received_blob_length < (peripheral_mtu(peripheral) - 1)){
+                        trigger_next_read_batch_after_single_value(peripheral);
+                    } else {
+                        peripheral->attribute_offset += received_blob_length;
+                        peripheral->gatt_client_state = P_W2_SEND_READ_BATCH_BLOB_QUERY;
+                    }
+                    // GATT_EVENT_QUERY_COMPLETE is emitted by trigger_next_xxx when done
+                    break;
                 case P_W4_READ_BLOB_CHARACTERISTIC_DESCRIPTOR_RESULT:
                     report_gatt_long_characteristic_descriptor(peripheral, peripheral->attribute_handle,
                                                           &packet[1], received_blob_length,
@@ -1361,6 +2210,10 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
                     gatt_client_handle_transaction_complete(peripheral);
                     emit_gatt_complete_event(peripheral, 0);
                     break;
+                case P_W4_READ_MULTIPLE_BATCH_RESPONSE:
+                    handle_read_multiple_batch_response(peripheral, packet, size);
+                    // GATT_EVENT_QUERY_COMPLETE is emitted by trigger_next_xxx when done
+                    break;
                 default:
                     break;
             }
@@ -1368,6 +2221,13 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
 
         case ATT_ERROR_RESPONSE:
 
+            if (peripheral->gatt_client_state == P_W4_READ_MULTIPLE_BATCH_RESPONSE){
+                // read values of batch one by one to report the failing one
+                peripheral->read_multiple_single_count = peripheral->read_multiple_batch_count;
+                trigger_next_read_batch(peripheral);
+                break;
+            }
+
             switch (packet[4]){
                 case ATT_ERROR_ATTRIBUTE_NOT_FOUND: {
                     switch(peripheral->gatt_client_state){
@@ -1448,6 +2308,13 @@ uint8_t gatt_client_signed_write_without_response(btstack_packet_handler_t callb
 uint8_t gatt_client_discover_primary_services(btstack_packet_handler_t callback, hci_con_handle_t con_handle){
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
 
     peripheral->callback = callback;
@@ -1455,6 +2322,10 @@ uint8_t gatt_client_discover_primary_services(btstack_packet_handler_t callback,
     peripheral->end_group_handle   = 0xffff;
     peripheral->gatt_client_state = P_W2_SEND_SERVICE_QUERY;
     peripheral->uuid16 = 0;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    peripheral->filter_with_uuid = 0;
+    if (gatt_client_cache_report_services(peripheral, NULL)) return 0;
+#endif
     gatt_client_run();
     return 0;
 }
@@ -1464,6 +2335,14 @@ uint8_t gatt_client_discover_primary_services_by_uuid16(btstack_packet_handler_t
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES_BY_UUID16, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->uuid16 = uuid16;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
 
     peripheral->callback = callback;
@@ -1472,6 +2351,10 @@ uint8_t gatt_client_discover_primary_services_by_uuid16(btstack_packet_handler_t
     peripheral->gatt_client_state = P_W2_SEND_SERVICE_WITH_UUID_QUERY;
     peripheral->uuid16 = uuid16;
     uuid_add_bluetooth_prefix((uint8_t*) &(peripheral->uuid128), peripheral->uuid16);
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    peripheral->filter_with_uuid = 1;
+    if (gatt_client_cache_report_services(peripheral, peripheral->uuid128)) return 0;
+#endif
     gatt_client_run();
     return 0;
 }
@@ -1480,6 +2363,14 @@ uint8_t gatt_client_discover_primary_services_by_uuid128(btstack_packet_handler_
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_PRIMARY_SERVICES_BY_UUID128, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        memcpy(operation->uuid128, uuid128, 16);
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
 
     peripheral->callback = callback;
@@ -1488,6 +2379,10 @@ uint8_t gatt_client_discover_primary_services_by_uuid128(btstack_packet_handler_
     peripheral->uuid16 = 0;
     memcpy(peripheral->uuid128, uuid128, 16);
     peripheral->gatt_client_state = P_W2_SEND_SERVICE_WITH_UUID_QUERY;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    peripheral->filter_with_uuid = 1;
+    if (gatt_client_cache_report_services(peripheral, peripheral->uuid128)) return 0;
+#endif
     gatt_client_run();
     return 0;
 }
@@ -1496,6 +2391,15 @@ uint8_t gatt_client_discover_characteristics_for_service(btstack_packet_handler_
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_FOR_SERVICE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle = service->start_group_handle;
+        operation->end_handle   = service->end_group_handle;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
 
     peripheral->callback = callback;
@@ -1504,6 +2408,9 @@ uint8_t gatt_client_discover_characteristics_for_service(btstack_packet_handler_
     peripheral->filter_with_uuid = 0;
     peripheral->characteristic_start_handle = 0;
     peripheral->gatt_client_state = P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    if (gatt_client_cache_report_characteristics(peripheral, service->start_group_handle, service->end_group_handle, NULL)) return 0;
+#endif
     gatt_client_run();
     return 0;
 }
@@ -1512,6 +2419,15 @@ uint8_t gatt_client_find_included_services_for_service(btstack_packet_handler_t
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_FIND_INCLUDED_SERVICES_FOR_SERVICE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle = service->start_group_handle;
+        operation->end_handle   = service->end_group_handle;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1527,6 +2443,16 @@ uint8_t gatt_client_discover_characteristics_for_handle_range_by_uuid16(btstack_
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_BY_UUID16, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle = start_handle;
+        operation->end_handle   = end_handle;
+        operation->uuid16 = uuid16;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1537,6 +2463,9 @@ uint8_t gatt_client_discover_characteristics_for_handle_range_by_uuid16(btstack_
     uuid_add_bluetooth_prefix((uint8_t*) &(peripheral->uuid128), uuid16);
     peripheral->characteristic_start_handle = 0;
     peripheral->gatt_client_state = P_W2_SEND_CHARACTERISTIC_WITH_UUID_QUERY;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    if (gatt_client_cache_report_characteristics(peripheral, start_handle, end_handle, peripheral->uuid128)) return 0;
+#endif
     
     gatt_client_run();
     return 0;
@@ -1546,6 +2475,16 @@ uint8_t gatt_client_discover_characteristics_for_handle_range_by_uuid128(btstack
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTICS_BY_UUID128, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle = start_handle;
+        operation->end_handle   = end_handle;
+        memcpy(operation->uuid128, uuid128, 16);
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1556,6 +2495,9 @@ uint8_t gatt_client_discover_characteristics_for_handle_range_by_uuid128(btstack
     memcpy(peripheral->uuid128, uuid128, 16);
     peripheral->characteristic_start_handle = 0;
     peripheral->gatt_client_state = P_W2_SEND_CHARACTERISTIC_WITH_UUID_QUERY;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    if (gatt_client_cache_report_characteristics(peripheral, start_handle, end_handle, peripheral->uuid128)) return 0;
+#endif
     
     gatt_client_run();
     return 0;
@@ -1574,9 +2516,23 @@ uint8_t gatt_client_discover_characteristic_descriptors(btstack_packet_handler_t
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_DISCOVER_CHARACTERISTIC_DESCRIPTORS, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle     = characteristic->start_handle;
+        operation->attribute_handle = characteristic->value_handle;
+        operation->end_handle       = characteristic->end_handle;
+        operation->properties       = characteristic->properties;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     if (characteristic->value_handle == characteristic->end_handle){
+        // no descriptors, complete without ATT transaction
+        gatt_client_timeout_stop(peripheral);
+        peripheral->callback = callback;
         emit_gatt_complete_event(peripheral, 0);
         return 0;
     }
@@ -1584,6 +2540,9 @@ uint8_t gatt_client_discover_characteristic_descriptors(btstack_packet_handler_t
     peripheral->start_group_handle = characteristic->value_handle + 1;
     peripheral->end_group_handle   = characteristic->end_handle;
     peripheral->gatt_client_state = P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY;
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    if (gatt_client_cache_report_descriptors(peripheral, characteristic)) return 0;
+#endif
     
     gatt_client_run();
     return 0;
@@ -1593,6 +2552,14 @@ uint8_t gatt_client_read_value_of_characteristic_using_value_handle(btstack_pack
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_VALUE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = value_handle;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1607,6 +2574,16 @@ uint8_t gatt_client_read_value_of_characteristics_by_uuid16(btstack_packet_handl
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_VALUES_BY_UUID16, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle = start_handle;
+        operation->end_handle   = end_handle;
+        operation->uuid16 = uuid16;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1625,6 +2602,16 @@ uint8_t gatt_client_read_value_of_characteristics_by_uuid128(btstack_packet_hand
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_VALUES_BY_UUID128, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle = start_handle;
+        operation->end_handle   = end_handle;
+        memcpy(operation->uuid128, uuid128, 16);
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1648,6 +2635,15 @@ uint8_t gatt_client_read_long_value_of_characteristic_using_value_handle_with_of
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_LONG_VALUE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = characteristic_value_handle;
+        operation->offset = offset;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1670,6 +2666,15 @@ uint8_t gatt_client_read_multiple_characteristic_values(btstack_packet_handler_t
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_MULTIPLE_VALUES, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->length = num_value_handles;
+        operation->value_handles = value_handles;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1680,14 +2685,49 @@ uint8_t gatt_client_read_multiple_characteristic_values(btstack_packet_handler_t
     return 0;
 }
 
+
+uint8_t gatt_client_read_values_of_characteristics_using_value_handles(btstack_packet_handler_t callback, hci_con_handle_t con_handle, int num_value_handles, uint16_t * value_handles, uint16_t * value_lengths){
+    gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
+
+    if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_VALUES_BATCHED, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->length = num_value_handles;
+        operation->value_handles = value_handles;
+        operation->value_lengths = value_lengths;
+        return 0;
+    }
+#endif
+    if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
+
+    peripheral->callback = callback;
+    peripheral->read_multiple_handle_count = num_value_handles;
+    peripheral->read_multiple_handles = value_handles;
+    peripheral->read_multiple_lengths = value_lengths;
+    peripheral->read_multiple_index = 0;
+    peripheral->read_multiple_single_count = 0;
+    trigger_next_read_batch(peripheral);
+    gatt_client_run();
+    return 0;
+}
 uint8_t gatt_client_write_value_of_characteristic_without_response(hci_con_handle_t con_handle, uint16_t value_handle, uint16_t value_length, uint8_t * value){
     gatt_client_t * peripheral = provide_context_for_conn_handle(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    // Write Commands don't wait for active operation, queue if they cannot be sent right away
+    if (value_length > peripheral_mtu(peripheral) - 3) return GATT_CLIENT_VALUE_TOO_LONG;
+    if (!btstack_ring_buffer_empty(&peripheral->write_command_queue) || !att_dispatch_client_can_send_now(peripheral->con_handle)){
+        return gatt_client_queue_write_command(peripheral, value_handle, value_length, value);
+    }
+#else
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     if (value_length > peripheral_mtu(peripheral) - 3) return GATT_CLIENT_VALUE_TOO_LONG;
     if (!att_dispatch_client_can_send_now(peripheral->con_handle)) return GATT_CLIENT_BUSY;
+#endif
 
     att_write_request(ATT_WRITE_COMMAND, peripheral->con_handle, value_handle, value_length, value);
     return 0;
@@ -1697,6 +2737,16 @@ uint8_t gatt_client_write_value_of_characteristic(btstack_packet_handler_t callb
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_WRITE_VALUE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = value_handle;
+        operation->length = value_length;
+        operation->data = data;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1712,6 +2762,17 @@ uint8_t gatt_client_write_long_value_of_characteristic_with_offset(btstack_packe
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_WRITE_LONG_VALUE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = value_handle;
+        operation->offset = offset;
+        operation->length = value_length;
+        operation->data = data;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1732,6 +2793,16 @@ uint8_t gatt_client_reliable_write_long_value_of_characteristic(btstack_packet_h
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_RELIABLE_WRITE_LONG_VALUE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = value_handle;
+        operation->length = value_length;
+        operation->data = value;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1748,6 +2819,18 @@ uint8_t gatt_client_write_client_characteristic_configuration(btstack_packet_han
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_WRITE_CLIENT_CHARACTERISTIC_CONFIGURATION, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->start_handle     = characteristic->start_handle;
+        operation->attribute_handle = characteristic->value_handle;
+        operation->end_handle       = characteristic->end_handle;
+        operation->properties       = characteristic->properties;
+        operation->configuration    = configuration;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     if ( (configuration & GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION) &&
@@ -1774,6 +2857,14 @@ uint8_t gatt_client_read_characteristic_descriptor_using_descriptor_handle(btsta
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_DESCRIPTOR, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = descriptor_handle;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1792,6 +2883,15 @@ uint8_t gatt_client_read_long_characteristic_descriptor_using_descriptor_handle_
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_READ_LONG_DESCRIPTOR, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = descriptor_handle;
+        operation->offset = offset;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1814,6 +2914,16 @@ uint8_t gatt_client_write_characteristic_descriptor_using_descriptor_handle(btst
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_WRITE_DESCRIPTOR, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = descriptor_handle;
+        operation->length = length;
+        operation->data = data;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1834,6 +2944,17 @@ uint8_t gatt_client_write_long_characteristic_descriptor_using_descriptor_handle
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_WRITE_LONG_DESCRIPTOR, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = descriptor_handle;
+        operation->offset = offset;
+        operation->length = length;
+        operation->data = data;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1861,6 +2982,17 @@ uint8_t gatt_client_prepare_write(btstack_packet_handler_t callback, hci_con_han
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_PREPARE_WRITE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        operation->attribute_handle = attribute_handle;
+        operation->offset = offset;
+        operation->length = length;
+        operation->data = data;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1880,6 +3012,13 @@ uint8_t gatt_client_execute_write(btstack_packet_handler_t callback, hci_con_han
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
 
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_EXECUTE_WRITE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
@@ -1895,6 +3034,13 @@ uint8_t gatt_client_cancel_write(btstack_packet_handler_t callback, hci_con_hand
     gatt_client_t * peripheral = provide_context_for_conn_handle_and_start_timer(con_handle);
     
     if (!peripheral) return BTSTACK_MEMORY_ALLOC_FAILED; 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    if (gatt_client_queue_required(peripheral)){
+        gatt_client_operation_t * operation = gatt_client_queue_add(peripheral, GATT_CLIENT_OPERATION_CANCEL_WRITE, callback);
+        if (!operation) return GATT_CLIENT_BUSY;
+        return 0;
+    }
+#endif
     if (!is_ready(peripheral)) return GATT_CLIENT_IN_WRONG_STATE;
     
     peripheral->callback = callback;
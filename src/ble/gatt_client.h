@@ -40,11 +40,43 @@
 #define btstack_gatt_client_h
 
 #include "hci.h"
+#include "btstack_ring_buffer.h"
 
 #if defined __cplusplus
 extern "C" {
 #endif
 
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+
+// max number of operations queued per connection while another operation is active
+#ifndef GATT_CLIENT_QUEUE_SIZE
+#define GATT_CLIENT_QUEUE_SIZE 4
+#endif
+
+// buffer per connection for Write Commands (4 bytes header + value each)
+#ifndef GATT_CLIENT_QUEUE_WRITE_COMMAND_BUFFER_SIZE
+#define GATT_CLIENT_QUEUE_WRITE_COMMAND_BUFFER_SIZE 128
+#endif
+
+typedef struct {
+    uint8_t  type;
+    btstack_packet_handler_t callback;
+    uint16_t start_handle;
+    uint16_t end_handle;
+    uint16_t attribute_handle;
+    uint16_t properties;
+    uint16_t configuration;
+    uint16_t uuid16;
+    uint8_t  uuid128[16];
+    uint16_t offset;
+    uint16_t length;
+    uint8_t  * data;
+    uint16_t * value_handles;
+    uint16_t * value_lengths;
+} gatt_client_operation_t;
+
+#endif
+
 typedef enum {
     P_READY,
     P_W2_SEND_SERVICE_QUERY,
@@ -77,6 +109,14 @@ typedef enum {
     P_W2_SEND_READ_MULTIPLE_REQUEST,
     P_W4_READ_MULTIPLE_RESPONSE,
 
+    // batched reads
+    P_W2_SEND_READ_MULTIPLE_BATCH_REQUEST,
+    P_W4_READ_MULTIPLE_BATCH_RESPONSE,
+    P_W2_SEND_READ_BATCH_VALUE_QUERY,
+    P_W4_READ_BATCH_VALUE_RESULT,
+    P_W2_SEND_READ_BATCH_BLOB_QUERY,
+    P_W4_READ_BATCH_BLOB_RESULT,
+
     P_W2_SEND_WRITE_CHARACTERISTIC_VALUE,
     P_W4_WRITE_CHARACTERISTIC_VALUE_RESULT,
     
@@ -120,6 +160,12 @@ typedef enum {
     P_W4_CMAC_RESULT,
     P_W2_SEND_SIGNED_WRITE,
     P_W4_SEND_SINGED_WRITE_DONE,
+
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    P_W2_REPORT_CACHED_SERVICES,
+    P_W2_REPORT_CACHED_CHARACTERISTICS,
+    P_W2_REPORT_CACHED_DESCRIPTORS,
+#endif
 } gatt_client_state_t;
     
     
@@ -169,6 +215,12 @@ typedef struct gatt_client{
     uint16_t    read_multiple_handle_count;
     uint16_t  * read_multiple_handles;
 
+    // batched reads: expected value lengths, next value, values in current Read Multiple Request, values to read one by one
+    uint16_t  * read_multiple_lengths;
+    uint16_t    read_multiple_index;
+    uint16_t    read_multiple_batch_count;
+    uint16_t    read_multiple_single_count;
+
     uint16_t client_characteristic_configuration_handle;
     uint8_t  client_characteristic_configuration_value[2];
     
@@ -179,6 +231,23 @@ typedef struct gatt_client{
     uint8_t  cmac[8];
 
     btstack_timer_source_t gc_timeout;
+
+#ifdef ENABLE_GATT_CLIENT_CACHE
+    // discovery cache of bonded peer and discovery currently recorded into it
+    struct gatt_client_cache * cache;
+    uint8_t  cache_query;
+    uint16_t cache_query_index;
+#endif
+
+#ifdef ENABLE_GATT_CLIENT_QUEUE
+    // operations started while another one is active
+    gatt_client_operation_t queue[GATT_CLIENT_QUEUE_SIZE];
+    uint8_t  queue_head;
+    uint8_t  queue_count;
+    // Write Commands waiting for can send now
+    btstack_ring_buffer_t write_command_queue;
+    uint8_t  write_command_storage[GATT_CLIENT_QUEUE_WRITE_COMMAND_BUFFER_SIZE];
+#endif
 } gatt_client_t;
 
 typedef struct gatt_client_notification {
@@ -234,11 +303,13 @@ void gatt_client_send_mtu_negotiation(btstack_packet_handler_t callback, hci_con
 
 /** 
  * @brief Returns if the GATT client is ready to receive a query. It is used with daemon. 
+ * With ENABLE_GATT_CLIENT_QUEUE, queries are accepted while another one is active: up to GATT_CLIENT_QUEUE_SIZE queries per connection are queued and started in order, each reporting to its own callback. GATT_CLIENT_BUSY is returned if the queue is full.
  */
 int gatt_client_is_ready(hci_con_handle_t con_handle);
 
 /** 
  * @brief Discovers all primary services. For each found service, an le_service_event_t with type set to GATT_EVENT_SERVICE_QUERY_RESULT will be generated and passed to the registered callback. The gatt_complete_event_t, with type set to GATT_EVENT_QUERY_COMPLETE, marks the end of discovery. 
+ * With ENABLE_GATT_CLIENT_CACHE, services, characteristics and descriptors of bonded devices are stored in the TLV and later discoveries are answered without ATT requests until a Service Changed indication is received.
  */
 uint8_t gatt_client_discover_primary_services(btstack_packet_handler_t callback, hci_con_handle_t con_handle);
 
@@ -297,8 +368,19 @@ uint8_t gatt_client_read_long_value_of_characteristic_using_value_handle_with_of
  */
 uint8_t gatt_client_read_multiple_characteristic_values(btstack_packet_handler_t callback, hci_con_handle_t con_handle, int num_value_handles, uint16_t * value_handles);
 
+/**
+ * @brief Reads the values of a list of characteristics. Consecutive values with known length are packed into as few Read Multiple Requests as the MTU allows.
+ * Values with unknown length (0) are read with a Read Request and reported as GATT_EVENT_CHARACTERISTIC_VALUE_QUERY_RESULT as well. Values longer than MTU - 1 are read with Read Blob Requests and reported as GATT_EVENT_LONG_CHARACTERISTIC_VALUE_QUERY_RESULT.
+ * If a Read Multiple Response doesn't match the expected lengths or fails, the values are read one by one. The gatt_complete_event_t with type set to GATT_EVENT_QUERY_COMPLETE marks the end of the read or reports the first error of a single read.
+ * @param num_value_handles
+ * @param value_handles list of value handles, must stay valid until GATT_EVENT_QUERY_COMPLETE
+ * @param value_lengths list of expected value lengths or 0 if unknown, must stay valid until GATT_EVENT_QUERY_COMPLETE
+ */
+uint8_t gatt_client_read_values_of_characteristics_using_value_handles(btstack_packet_handler_t callback, hci_con_handle_t con_handle, int num_value_handles, uint16_t * value_handles, uint16_t * value_lengths);
+
 /** 
  * @brief Writes the characteristic value using the characteristic's value handle without an acknowledgment that the write was successfully performed.
+ * With ENABLE_GATT_CLIENT_QUEUE, the value is copied into a per-connection buffer if it cannot be sent right away. Queued Write Commands are sent back to back as soon as possible. GATT_CLIENT_BUSY is returned if the buffer is full.
  */
 uint8_t gatt_client_write_value_of_characteristic_without_response(hci_con_handle_t con_handle, uint16_t characteristic_value_handle, uint16_t length, uint8_t  * data);
 
@@ -43,6 +43,7 @@
 #include "ble/core.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "btstack_debug.h"
 
@@ -92,9 +93,31 @@ typedef struct le_device_db_entry_t {
 #error "NVM_NUM_DEVICE_DB_ENTRIES must not be 0, please update in btstack_config.h"
 #endif
 
-// only stores if entry present
-static uint8_t  entry_map[NVM_NUM_DEVICE_DB_ENTRIES];
+#if NVM_NUM_DEVICE_DB_ENTRIES > 0xfffe
+#error "NVM_NUM_DEVICE_DB_ENTRIES must be smaller than 0xffff"
+#endif
+
+#define LE_DEVICE_DB_TLV_INVALID_INDEX 0xffff
+
+// in-RAM index of stored entries, built in le_device_db_tlv_configure
+typedef struct {
+    bd_addr_t addr;
+    uint8_t   addr_type;
+    uint8_t   used;
+    uint32_t  seq_nr;
+    // least recently stored list, or list of free entries
+    uint16_t  prev;
+    uint16_t  next;
+} le_device_db_tlv_index_entry_t;
+
+static le_device_db_tlv_index_entry_t entry_map[NVM_NUM_DEVICE_DB_ENTRIES];
+// indices of used entries sorted by address type and address
+static uint16_t sorted_entries[NVM_NUM_DEVICE_DB_ENTRIES];
 static uint32_t num_valid_entries;
+static uint16_t lru_head;   // least recently stored
+static uint16_t lru_tail;   // most recently stored
+static uint16_t free_head;
+static uint32_t highest_seq_nr;
 
 static const btstack_tlv_t * le_device_db_tlv_btstack_tlv_impl;
 static       void *          le_device_db_tlv_btstack_tlv_context;
@@ -102,9 +125,14 @@ static       void *          le_device_db_tlv_btstack_tlv_context;
 static const char tag_0 = 'B';
 static const char tag_1 = 'T';
 static const char tag_2 = 'D';
+static const char tag_1_extended = 'd';
 
-static uint32_t le_device_db_tlv_tag_for_index(uint8_t index){
-    return (tag_0 << 24) | (tag_1 << 16) | (tag_2 << 8) | index;
+static uint32_t le_device_db_tlv_tag_for_index(uint16_t index){
+    if (index < 0x100){
+        return (tag_0 << 24) | (tag_1 << 16) | (tag_2 << 8) | index;
+    }
+    // more than 256 entries
+    return (tag_0 << 24) | (tag_1_extended << 16) | index;
 }
 
 // @returns success
@@ -142,18 +170,114 @@ static int le_device_db_tlv_delete(int index){
 	return 1;
 }
 
+// LRU list
+static void le_device_db_tlv_lru_remove(uint16_t index){
+    le_device_db_tlv_index_entry_t * entry = &entry_map[index];
+    if (entry->prev == LE_DEVICE_DB_TLV_INVALID_INDEX){
+        lru_head = entry->next;
+    } else {
+        entry_map[entry->prev].next = entry->next;
+    }
+    if (entry->next == LE_DEVICE_DB_TLV_INVALID_INDEX){
+        lru_tail = entry->prev;
+    } else {
+        entry_map[entry->next].prev = entry->prev;
+    }
+}
+
+static void le_device_db_tlv_lru_append(uint16_t index){
+    le_device_db_tlv_index_entry_t * entry = &entry_map[index];
+    entry->prev = lru_tail;
+    entry->next = LE_DEVICE_DB_TLV_INVALID_INDEX;
+    if (lru_tail == LE_DEVICE_DB_TLV_INVALID_INDEX){
+        lru_head = index;
+    } else {
+        entry_map[lru_tail].next = index;
+    }
+    lru_tail = index;
+}
+
+// sorted address index
+static int le_device_db_tlv_compare(const le_device_db_tlv_index_entry_t * entry, uint8_t addr_type, const uint8_t * addr){
+    if (entry->addr_type != addr_type) return (int) entry->addr_type - (int) addr_type;
+    return memcmp(entry->addr, addr, 6);
+}
+
+// @returns position of address in sorted_entries, or position to insert at as -(pos+1)
+static int le_device_db_tlv_find(uint8_t addr_type, const uint8_t * addr){
+    int lo = 0;
+    int hi = num_valid_entries - 1;
+    while (lo <= hi){
+        int mid = (lo + hi) / 2;
+        int res = le_device_db_tlv_compare(&entry_map[sorted_entries[mid]], addr_type, addr);
+        if (res == 0) return mid;
+        if (res < 0){
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -(lo + 1);
+}
+
+static int le_device_db_tlv_compare_address(const void * a, const void * b){
+    const le_device_db_tlv_index_entry_t * entry_b = &entry_map[*(const uint16_t *) b];
+    return le_device_db_tlv_compare(&entry_map[*(const uint16_t *) a], entry_b->addr_type, entry_b->addr);
+}
+
+static int le_device_db_tlv_compare_seq_nr(const void * a, const void * b){
+    uint32_t seq_nr_a = entry_map[*(const uint16_t *) a].seq_nr;
+    uint32_t seq_nr_b = entry_map[*(const uint16_t *) b].seq_nr;
+    if (seq_nr_a < seq_nr_b) return -1;
+    if (seq_nr_a > seq_nr_b) return 1;
+    return 0;
+}
+
+static void le_device_db_tlv_index_remove(uint16_t index){
+    int pos = le_device_db_tlv_find(entry_map[index].addr_type, entry_map[index].addr);
+    if (pos >= 0){
+        memmove(&sorted_entries[pos], &sorted_entries[pos+1], (num_valid_entries - pos - 1) * sizeof(uint16_t));
+    }
+    num_valid_entries--;
+    le_device_db_tlv_lru_remove(index);
+    entry_map[index].used = 0;
+    entry_map[index].next = free_head;
+    free_head = index;
+}
+
 static void le_device_db_tlv_scan(void){
     int i;
     num_valid_entries = 0;
-    memset(entry_map, 0, sizeof(entry_map));
-    for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
+    highest_seq_nr = 0;
+    lru_head  = LE_DEVICE_DB_TLV_INVALID_INDEX;
+    lru_tail  = LE_DEVICE_DB_TLV_INVALID_INDEX;
+    free_head = LE_DEVICE_DB_TLV_INVALID_INDEX;
+    // collect stored entries, build free list in ascending order
+    for (i=NVM_NUM_DEVICE_DB_ENTRIES-1;i>=0;i--){
         // lookup entry
         le_device_db_entry_t entry;
-        if (!le_device_db_tlv_fetch(i, &entry)) continue;
+        if (!le_device_db_tlv_fetch(i, &entry)) {
+            entry_map[i].used = 0;
+            entry_map[i].next = free_head;
+            free_head = i;
+            continue;
+        }
 
-        entry_map[i] = 1;
-        num_valid_entries++;
+        entry_map[i].used = 1;
+        entry_map[i].addr_type = entry.addr_type;
+        entry_map[i].seq_nr = entry.seq_nr;
+        memcpy(entry_map[i].addr, entry.addr, 6);
+        sorted_entries[num_valid_entries++] = i;
+        if (entry.seq_nr > highest_seq_nr){
+            highest_seq_nr = entry.seq_nr;
+        }
+    }
+    // initial LRU order from seq nr
+    qsort(sorted_entries, num_valid_entries, sizeof(uint16_t), &le_device_db_tlv_compare_seq_nr);
+    for (i=0;i<(int)num_valid_entries;i++){
+        le_device_db_tlv_lru_append(sorted_entries[i]);
     }
+    qsort(sorted_entries, num_valid_entries, sizeof(uint16_t), &le_device_db_tlv_compare_address);
     log_info("num valid le device entries %u", num_valid_entries);
 }
 
@@ -175,64 +299,45 @@ int le_device_db_max_count(void){
 }
 
 void le_device_db_remove(int index){
+    if (index < 0 || index >= NVM_NUM_DEVICE_DB_ENTRIES) return;
+
     // check if entry exists
-    if (entry_map[index] == 0) return; 
+    if (entry_map[index].used == 0) return; 
 
 	// delete entry in TLV
 	le_device_db_tlv_delete(index);
 
-	// mark as unused
-    entry_map[index] = 0;
-
-    // keep track
-    num_valid_entries--;
+	// mark as unused and keep track
+    le_device_db_tlv_index_remove(index);
 }
 
 int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
 
-    uint32_t highest_seq_nr = 0;
-    uint32_t lowest_seq_nr  = 0;
-    int index_for_lowest_seq_nr = -1;
-    int index_for_addr  = -1;
-    int index_for_empty = -1;
-
-	// find unused entry in the used list
-    int i;
-    for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
-         if (entry_map[i]) {
-            le_device_db_entry_t entry;
-            le_device_db_tlv_fetch(i, &entry);
-            // found addr?
-            if ((memcmp(addr, entry.addr, 6) == 0) && addr_type == entry.addr_type){
-                index_for_addr = i;
-            }
-            // update highest seq nr
-            if (entry.seq_nr > highest_seq_nr){
-                highest_seq_nr = entry.seq_nr;
-            }
-            // find entry with lowest seq nr
-            if ((index_for_lowest_seq_nr == 0) || (entry.seq_nr < lowest_seq_nr)){
-                index_for_lowest_seq_nr = i;
-                lowest_seq_nr = entry.seq_nr;
-            }
-        } else {
-            index_for_empty = i;
-        }
-    }
-
-    log_info("index_for_addr %x, index_for_empy %x, index_for_lowest_seq_nr %x", index_for_addr, index_for_empty, index_for_lowest_seq_nr);
-
-    uint32_t index_to_use = 0;
-    if (index_for_addr >= 0){
-        index_to_use = index_for_addr;
-    } else if (index_for_empty >= 0){
-        index_to_use = index_for_empty;
-    } else if (index_for_lowest_seq_nr >= 0){
-        index_to_use = index_for_lowest_seq_nr;
+    uint16_t index_to_use;
+    int pos = le_device_db_tlv_find(addr_type, addr);
+    if (pos >= 0){
+        // replace entry for same address
+        index_to_use = sorted_entries[pos];
+        le_device_db_tlv_lru_remove(index_to_use);
     } else {
-        // should not happen
-        return -1;
+        if (free_head == LE_DEVICE_DB_TLV_INVALID_INDEX){
+            // replace least recently stored entry
+            log_info("le device db full, replace index %u", lru_head);
+            le_device_db_tlv_index_remove(lru_head);
+        }
+        index_to_use = free_head;
+        free_head = entry_map[index_to_use].next;
+        // insert into sorted index
+        pos = -le_device_db_tlv_find(addr_type, addr) - 1;
+        memmove(&sorted_entries[pos+1], &sorted_entries[pos], (num_valid_entries - pos) * sizeof(uint16_t));
+        sorted_entries[pos] = index_to_use;
+        num_valid_entries++;
+        entry_map[index_to_use].used = 1;
+        entry_map[index_to_use].addr_type = addr_type;
+        memcpy(entry_map[index_to_use].addr, addr, 6);
     }
+    entry_map[index_to_use].seq_nr = ++highest_seq_nr;
+    le_device_db_tlv_lru_append(index_to_use);
 
     log_info("new entry for index %u", index_to_use);
 
@@ -243,6 +348,7 @@ int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
 
     memset(&entry, 0, sizeof(le_device_db_entry_t));
 
+    entry.seq_nr = highest_seq_nr;
     entry.addr_type = addr_type;
     memcpy(entry.addr, addr, 6);
     memcpy(entry.irk, irk, 16);
@@ -252,14 +358,6 @@ int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
 
     // store
     le_device_db_tlv_store(index_to_use, &entry);
-    
-    // set in entry_mape
-    entry_map[index_to_use] = 1;
-
-    // keep track - don't increase if old entry found
-    if (index_for_addr < 0){
-        num_valid_entries++;
-    }
 
     return index_to_use;
 }
@@ -433,7 +531,7 @@ void le_device_db_dump(void){
     uint32_t i;
 
     for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
-        if (!entry_map[i]) continue;
+        if (!entry_map[i].used) continue;
 		// fetch entry
 		le_device_db_entry_t entry;
 		le_device_db_tlv_fetch(i, &entry);
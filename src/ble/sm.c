@@ -148,6 +148,7 @@ typedef enum {
 typedef enum {
     EC_KEY_GENERATION_ACTIVE,
     EC_KEY_GENERATION_DONE,
+    EC_KEY_GENERATION_W2_NEW_KEY,
 } ec_key_generation_state_t;
 
 typedef enum {
@@ -249,6 +250,7 @@ static btstack_crypto_random_t   sm_crypto_random_request;
 static btstack_crypto_aes128_t   sm_crypto_aes128_request;
 #ifdef ENABLE_LE_SECURE_CONNECTIONS
 static btstack_crypto_ecc_p256_t sm_crypto_ecc_p256_request;
+static btstack_crypto_ecc_p256_t sm_crypto_ecc_p256_key_request;
 static btstack_crypto_random_t   sm_crypto_random_oob_request;
 #endif
 
@@ -414,6 +416,7 @@ static void sm_handle_random_result_rau(void * arg);
 #ifdef ENABLE_LE_SECURE_CONNECTIONS
 static void sm_handle_random_result_sc_get_random(void * arg);
 static int sm_passkey_entry(stk_generation_method_t method);
+static void sm_ec_generated(void * arg);
 #endif
 static void sm_notify_client_status_reason(sm_connection_t * sm_conn, uint8_t status, uint8_t reason);
 
@@ -1856,8 +1859,17 @@ static void sm_run(void){
     }
 
 #ifdef ENABLE_LE_SECURE_CONNECTIONS
+#ifdef ENABLE_ECC_P256_KEY_POOL
+    // key pair was sent to a peer, get new one before next pairing
+    if ((ec_key_generation_state == EC_KEY_GENERATION_W2_NEW_KEY) && (sm_active_connection_handle == HCI_CON_HANDLE_INVALID)){
+        ec_key_generation_state = EC_KEY_GENERATION_ACTIVE;
+        btstack_crypto_ecc_p256_generate_key(&sm_crypto_ecc_p256_key_request, ec_q, &sm_ec_generated, NULL);
+        return;
+    }
+#endif
     switch (sm_sc_oob_state){
         case SM_SC_OOB_W2_CALC_CONFIRM:
+            if (ec_key_generation_state != EC_KEY_GENERATION_DONE) break;
             if (!sm_cmac_ready()) break;
             sm_sc_oob_state = SM_SC_OOB_W4_CONFIRM;
             f4_engine(NULL, ec_q, ec_q, sm_sc_oob_random, 0);
@@ -2166,6 +2178,10 @@ static void sm_run(void){
 #ifdef ENABLE_LE_SECURE_CONNECTIONS
 
             case SM_SC_SEND_PUBLIC_KEY_COMMAND: {
+                if (ec_key_generation_state == EC_KEY_GENERATION_ACTIVE) break;
+#ifdef ENABLE_ECC_P256_KEY_POOL
+                ec_key_generation_state = EC_KEY_GENERATION_W2_NEW_KEY;
+#endif
                 int trigger_user_response = 0;
 
                 uint8_t buffer[65];
@@ -3649,6 +3665,8 @@ void sm_test_use_fixed_local_csrk(void){
 static void sm_ec_generated(void * arg){
     UNUSED(arg);
     ec_key_generation_state = EC_KEY_GENERATION_DONE;
+    // trigger pairing or OOB data generation waiting for key pair
+    sm_run();
 }
 #endif
 
@@ -3709,7 +3727,7 @@ void sm_init(void){
 
 #ifdef ENABLE_LE_SECURE_CONNECTIONS
     ec_key_generation_state = EC_KEY_GENERATION_ACTIVE;
-    btstack_crypto_ecc_p256_generate_key(&sm_crypto_ecc_p256_request, ec_q, &sm_ec_generated, NULL);
+    btstack_crypto_ecc_p256_generate_key(&sm_crypto_ecc_p256_key_request, ec_q, &sm_ec_generated, NULL);
 #endif
 }
 
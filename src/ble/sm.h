@@ -226,6 +226,7 @@ void sm_allow_ltk_reconstruction_without_le_device_db_entry(int allow);
  * @brief Generate OOB data for LE Secure Connections
  * @note This generates a 128 bit random number ra and then calculates Ca = f4(PKa, PKa, ra, 0)
  *       New OOB data should be generated for each pairing. Ra is used for subsequent OOB pairings
+ *       With ENABLE_ECC_P256_KEY_POOL, OOB data is only valid until the next LE Secure Connections pairing
  * @param callback
  * @returns status
  */
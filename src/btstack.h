@@ -85,7 +85,9 @@
 
 // #ifdef ENABLE_CLASSIC
 #include "classic/a2dp_sink.h"
+#include "classic/a2dp_sink_media_engine.h"
 #include "classic/a2dp_source.h"
+#include "classic/a2dp_source_pipeline.h"
 #include "classic/avdtp.h"
 #include "classic/avdtp_acceptor.h"
 #include "classic/avdtp_initiator.h"
@@ -56,6 +56,8 @@ typedef enum {
   BTSTACK_CHIPSET_DONE = 0,
   BTSTACK_CHIPSET_VALID_COMMAND,
   BTSTACK_CHIPSET_WARMSTART_REQUIRED,
+  // valid command that can be sent before the previous one is complete, e.g. patch RAM writes
+  BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED,
 } btstack_chipset_result_t;
 
 
@@ -78,6 +78,14 @@
 #define ENABLE_ECC_P256
 #endif
 
+// Key pool requires access to the private key
+#if defined(ENABLE_ECC_P256_KEY_POOL) && defined(USE_SOFTWARE_ECC_P256_IMPLEMENTATION)
+#define USE_ECC_P256_KEY_POOL
+#ifndef ECC_P256_KEY_POOL_SIZE
+#define ECC_P256_KEY_POOL_SIZE 2
+#endif
+#endif
+
 // Software AES128
 #ifdef HAVE_AES128
 #define USE_BTSTACK_AES128
@@ -133,6 +141,21 @@ static btstack_crypto_ecc_p256_key_generation_state_t btstack_crypto_ecc_p256_ke
 
 #ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
 static uint8_t btstack_crypto_ecc_p256_d[32];
+// key pair written by key generation
+static uint8_t * btstack_crypto_ecc_p256_target_public_key;
+static uint8_t * btstack_crypto_ecc_p256_target_d;
+// key generation and DHKey calculation outside of the run loop
+static const btstack_crypto_executor_t * btstack_crypto_ecc_p256_executor;
+static uint8_t btstack_crypto_ecc_p256_executor_active;
+static int     btstack_crypto_ecc_p256_generate_key_result;
+#endif
+
+#ifdef USE_ECC_P256_KEY_POOL
+static btstack_crypto_ecc_p256_t btstack_crypto_ecc_p256_key_pool_request;
+static uint8_t btstack_crypto_ecc_p256_key_pool_public_keys[ECC_P256_KEY_POOL_SIZE][64];
+static uint8_t btstack_crypto_ecc_p256_key_pool_private_keys[ECC_P256_KEY_POOL_SIZE][32];
+static uint8_t btstack_crypto_ecc_p256_key_pool_count;
+static uint8_t btstack_crypto_ecc_p256_key_pool_refill_active;
 #endif
 
 #endif /* ENABLE_ECC_P256 */
@@ -374,7 +397,6 @@ static void btstack_crypto_log_ec_publickey(const uint8_t * ec_q){
 // @return OK
 static int sm_generate_f_rng(unsigned char * buffer, unsigned size){
     if (btstack_crypto_ecc_p256_key_generation_state != ECC_P256_KEY_GENERATION_ACTIVE) return 0;
-    log_info("sm_generate_f_rng: size %u - offset %u", (int) size, btstack_crypto_ecc_p256_random_offset);
     while (size) {
         *buffer++ = btstack_crypto_ecc_p256_random[btstack_crypto_ecc_p256_random_offset++];
         size--;
@@ -390,29 +412,31 @@ static int sm_generate_f_rng_mbedtls(void * context, unsigned char * buffer, siz
 }
 #endif /* USE_MBEDTLS_ECC_P256 */
 
-static void btstack_crypto_ecc_p256_generate_key_software(void){
+// may run on executor thread: no logging, result is logged by btstack_crypto_ecc_p256_log_generate_key
+// @return 0 if ok
+static int btstack_crypto_ecc_p256_generate_key_software(void){
 
+    int res = 0;
     btstack_crypto_ecc_p256_random_offset = 0;
     
     // generate EC key
 #ifdef USE_MICRO_ECC_P256
 
 #ifndef WICED_VERSION
-    log_info("set uECC RNG for initial key generation with 64 random bytes");
+    // set uECC RNG for initial key generation with 64 random bytes
     // micro-ecc from WICED SDK uses its wiced_crypto_get_random by default - no need to set it
     uECC_set_rng(&sm_generate_f_rng);
 #endif /* WICED_VERSION */
 
 #if uECC_SUPPORTS_secp256r1
     // standard version
-    uECC_make_key(btstack_crypto_ecc_p256_public_key, btstack_crypto_ecc_p256_d, uECC_secp256r1());
+    res = !uECC_make_key(btstack_crypto_ecc_p256_target_public_key, btstack_crypto_ecc_p256_target_d, uECC_secp256r1());
 
     // disable RNG again, as returning no randmon data lets shared key generation fail
-    log_info("disable uECC RNG in standard version after key generation");
     uECC_set_rng(NULL);
 #else
     // static version
-    uECC_make_key(btstack_crypto_ecc_p256_public_key, btstack_crypto_ecc_p256_d);
+    res = !uECC_make_key(btstack_crypto_ecc_p256_target_public_key, btstack_crypto_ecc_p256_target_d);
 #endif
 #endif /* USE_MICRO_ECC_P256 */
 
@@ -421,17 +445,26 @@ static void btstack_crypto_ecc_p256_generate_key_software(void){
     mbedtls_ecp_point P;
     mbedtls_mpi_init(&d);
     mbedtls_ecp_point_init(&P);
-    int res = mbedtls_ecp_gen_keypair(&mbedtls_ec_group, &d, &P, &sm_generate_f_rng_mbedtls, NULL);
-    log_info("gen keypair %x", res);
-    mbedtls_mpi_write_binary(&P.X, &btstack_crypto_ecc_p256_public_key[0],  32);
-    mbedtls_mpi_write_binary(&P.Y, &btstack_crypto_ecc_p256_public_key[32], 32);
-    mbedtls_mpi_write_binary(&d, btstack_crypto_ecc_p256_d, 32);
+    res = mbedtls_ecp_gen_keypair(&mbedtls_ec_group, &d, &P, &sm_generate_f_rng_mbedtls, NULL);
+    mbedtls_mpi_write_binary(&P.X, &btstack_crypto_ecc_p256_target_public_key[0],  32);
+    mbedtls_mpi_write_binary(&P.Y, &btstack_crypto_ecc_p256_target_public_key[32], 32);
+    mbedtls_mpi_write_binary(&d, btstack_crypto_ecc_p256_target_d, 32);
     mbedtls_ecp_point_free(&P);
     mbedtls_mpi_free(&d);
 #endif  /* USE_MBEDTLS_ECC_P256 */
+    return res;
+}
+
+static void btstack_crypto_ecc_p256_log_generate_key(int res){
+    if (res){
+        log_error("ecc key generation failed, res %x", res);
+    } else {
+        log_info("ecc key generated with %u random bytes", btstack_crypto_ecc_p256_random_offset);
+    }
 }
 
 #ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
+// may run on executor thread: no logging, result is logged by btstack_crypto_ecc_p256_log_dhkey
 static void btstack_crypto_ecc_p256_calculate_dhkey_software(btstack_crypto_ecc_p256_t * btstack_crypto_ec_p192){
     memset(btstack_crypto_ec_p192->dhkey, 0, 32);
 
@@ -463,10 +496,74 @@ static void btstack_crypto_ecc_p256_calculate_dhkey_software(btstack_crypto_ecc_
     mbedtls_mpi_free(&d);
     mbedtls_ecp_point_free(&Q);
 #endif
+}
 
+static void btstack_crypto_ecc_p256_log_dhkey(btstack_crypto_ecc_p256_t * btstack_crypto_ec_p192){
     log_info("dhkey");
     log_info_hexdump(btstack_crypto_ec_p192->dhkey, 32);
 }
+
+// executor work functions run on another thread and must not log, done functions run on the run loop
+static void btstack_crypto_ecc_p256_generate_key_work(void * context){
+    UNUSED(context);
+    btstack_crypto_ecc_p256_generate_key_result = btstack_crypto_ecc_p256_generate_key_software();
+}
+
+static void btstack_crypto_ecc_p256_generate_key_done(void * context){
+    UNUSED(context);
+    btstack_crypto_ecc_p256_executor_active = 0;
+    btstack_crypto_ecc_p256_log_generate_key(btstack_crypto_ecc_p256_generate_key_result);
+    btstack_crypto_ecc_p256_key_generation_state = ECC_P256_KEY_GENERATION_DONE;
+    btstack_crypto_run();
+}
+
+static void btstack_crypto_ecc_p256_calculate_dhkey_work(void * context){
+    btstack_crypto_ecc_p256_calculate_dhkey_software((btstack_crypto_ecc_p256_t *) context);
+}
+
+static void btstack_crypto_ecc_p256_calculate_dhkey_done(void * context){
+    btstack_crypto_ecc_p256_t * btstack_crypto_ec_p192 = (btstack_crypto_ecc_p256_t *) context;
+    btstack_crypto_ecc_p256_executor_active = 0;
+    btstack_crypto_ecc_p256_log_dhkey(btstack_crypto_ec_p192);
+    btstack_linked_list_pop(&btstack_crypto_operations);
+    (*btstack_crypto_ec_p192->btstack_crypto.context_callback.callback)(btstack_crypto_ec_p192->btstack_crypto.context_callback.context);
+    btstack_crypto_run();
+}
+#endif
+
+#ifdef USE_ECC_P256_KEY_POOL
+static void btstack_crypto_ecc_p256_key_pool_handle_key(void * arg){
+    UNUSED(arg);
+    btstack_crypto_ecc_p256_key_pool_count++;
+    btstack_crypto_ecc_p256_key_pool_refill_active = 0;
+    log_info("ecc key pool: %u of %u key pairs ready", btstack_crypto_ecc_p256_key_pool_count, ECC_P256_KEY_POOL_SIZE);
+}
+
+// generate key pairs for the pool when there's nothing else to do
+static void btstack_crypto_ecc_p256_key_pool_refill(void){
+    // without executor, key generation would block the run loop
+    if (!btstack_crypto_ecc_p256_executor) return;
+    if (btstack_crypto_ecc_p256_key_pool_refill_active) return;
+    if (btstack_crypto_ecc_p256_key_pool_count >= ECC_P256_KEY_POOL_SIZE) return;
+    if (!btstack_linked_list_empty(&btstack_crypto_operations)) return;
+    btstack_crypto_ecc_p256_key_pool_refill_active = 1;
+    btstack_crypto_ecc_p256_t * request = &btstack_crypto_ecc_p256_key_pool_request;
+    request->btstack_crypto.context_callback.callback  = &btstack_crypto_ecc_p256_key_pool_handle_key;
+    request->btstack_crypto.context_callback.context   = NULL;
+    request->btstack_crypto.operation                  = BTSTACK_CRYPTO_ECC_P256_GENERATE_KEY;
+    request->public_key                                = NULL;
+    btstack_linked_list_add_tail(&btstack_crypto_operations, (btstack_linked_item_t*) request);
+}
+
+// @return 1 if key pair was taken from pool
+static int btstack_crypto_ecc_p256_key_pool_get(void){
+    if (btstack_crypto_ecc_p256_key_pool_count == 0) return 0;
+    btstack_crypto_ecc_p256_key_pool_count--;
+    memcpy(btstack_crypto_ecc_p256_public_key, btstack_crypto_ecc_p256_key_pool_public_keys[btstack_crypto_ecc_p256_key_pool_count], 64);
+    memcpy(btstack_crypto_ecc_p256_d, btstack_crypto_ecc_p256_key_pool_private_keys[btstack_crypto_ecc_p256_key_pool_count], 32);
+    memset(btstack_crypto_ecc_p256_key_pool_private_keys[btstack_crypto_ecc_p256_key_pool_count], 0, 32);
+    return 1;
+}
 #endif
 
 #endif
@@ -554,6 +651,15 @@ static void btstack_crypto_run(void){
 	// already active?
 	if (btstack_crypto_wait_for_hci_result) return;
 
+#ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
+    // key generation or DHKey calculation in progress?
+    if (btstack_crypto_ecc_p256_executor_active) return;
+#endif
+
+#ifdef USE_ECC_P256_KEY_POOL
+    btstack_crypto_ecc_p256_key_pool_refill();
+#endif
+
 	// anything to do?
 	if (btstack_linked_list_empty(&btstack_crypto_operations)) return;
 
@@ -617,6 +723,16 @@ static void btstack_crypto_run(void){
             switch (btstack_crypto_ecc_p256_key_generation_state){
                 case ECC_P256_KEY_GENERATION_DONE:
                     // done
+#ifdef USE_ECC_P256_KEY_POOL
+                    // every request gets a new key pair, pool key pairs are not used until handed out
+                    btstack_crypto_ecc_p256_key_generation_state = ECC_P256_KEY_GENERATION_IDLE;
+                    if (btstack_crypto_ec_p192 == &btstack_crypto_ecc_p256_key_pool_request){
+                        btstack_linked_list_pop(&btstack_crypto_operations);
+                        btstack_crypto_ecc_p256_key_pool_handle_key(NULL);
+                        btstack_crypto_run();
+                        break;
+                    }
+#endif
                     btstack_crypto_log_ec_publickey(btstack_crypto_ecc_p256_public_key);
                     memcpy(btstack_crypto_ec_p192->public_key, btstack_crypto_ecc_p256_public_key, 64);
                     btstack_linked_list_pop(&btstack_crypto_operations);
@@ -624,8 +740,22 @@ static void btstack_crypto_run(void){
                     break;
                 case ECC_P256_KEY_GENERATION_IDLE:
 #ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
+                    btstack_crypto_ecc_p256_target_public_key = btstack_crypto_ecc_p256_public_key;
+                    btstack_crypto_ecc_p256_target_d          = btstack_crypto_ecc_p256_d;
+#ifdef USE_ECC_P256_KEY_POOL
+                    if (btstack_crypto_ec_p192 == &btstack_crypto_ecc_p256_key_pool_request){
+                        btstack_crypto_ecc_p256_target_public_key = btstack_crypto_ecc_p256_key_pool_public_keys[btstack_crypto_ecc_p256_key_pool_count];
+                        btstack_crypto_ecc_p256_target_d          = btstack_crypto_ecc_p256_key_pool_private_keys[btstack_crypto_ecc_p256_key_pool_count];
+                    } else if (btstack_crypto_ecc_p256_key_pool_get()){
+                        log_info("ecc key pair from pool");
+                        btstack_crypto_ecc_p256_key_generation_state = ECC_P256_KEY_GENERATION_DONE;
+                        btstack_crypto_run();
+                        break;
+                    }
+#endif
                     log_info("start ecc random");
                     btstack_crypto_ecc_p256_key_generation_state = ECC_P256_KEY_GENERATION_GENERATING_RANDOM;
+                    btstack_crypto_ecc_p256_random_len = 0;
                     btstack_crypto_ecc_p256_random_offset = 0;
                     btstack_crypto_wait_for_hci_result = 1;
                     hci_send_cmd(&hci_le_rand);
@@ -649,7 +779,13 @@ static void btstack_crypto_run(void){
         case BTSTACK_CRYPTO_ECC_P256_CALCULATE_DHKEY:
             btstack_crypto_ec_p192 = (btstack_crypto_ecc_p256_t *) btstack_crypto;
 #ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
+            if (btstack_crypto_ecc_p256_executor){
+                btstack_crypto_ecc_p256_executor_active = 1;
+                (*btstack_crypto_ecc_p256_executor->execute)(&btstack_crypto_ecc_p256_calculate_dhkey_work, &btstack_crypto_ecc_p256_calculate_dhkey_done, btstack_crypto_ec_p192);
+                break;
+            }
             btstack_crypto_ecc_p256_calculate_dhkey_software(btstack_crypto_ec_p192);
+            btstack_crypto_ecc_p256_log_dhkey(btstack_crypto_ec_p192);
             // done
             btstack_linked_list_pop(&btstack_crypto_operations);
             (*btstack_crypto_ec_p192->btstack_crypto.context_callback.callback)(btstack_crypto_ec_p192->btstack_crypto.context_callback.context);                    
@@ -689,7 +825,14 @@ static void btstack_crypto_handle_random_data(const uint8_t * data, uint16_t len
             btstack_crypto_ecc_p256_random_len += 8;
             if (btstack_crypto_ecc_p256_random_len >= 64) {
                 btstack_crypto_ecc_p256_key_generation_state = ECC_P256_KEY_GENERATION_ACTIVE;
-                btstack_crypto_ecc_p256_generate_key_software();
+#ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
+                if (btstack_crypto_ecc_p256_executor){
+                    btstack_crypto_ecc_p256_executor_active = 1;
+                    (*btstack_crypto_ecc_p256_executor->execute)(&btstack_crypto_ecc_p256_generate_key_work, &btstack_crypto_ecc_p256_generate_key_done, NULL);
+                    break;
+                }
+#endif
+                btstack_crypto_ecc_p256_log_generate_key(btstack_crypto_ecc_p256_generate_key_software());
                 btstack_crypto_ecc_p256_key_generation_state = ECC_P256_KEY_GENERATION_DONE;
             }
             break;
@@ -938,6 +1081,15 @@ void btstack_crypto_ecc_p256_calculate_dhkey(btstack_crypto_ecc_p256_t * request
     btstack_crypto_run();
 }
 
+void btstack_crypto_ecc_p256_set_executor(const btstack_crypto_executor_t * executor){
+#ifdef USE_SOFTWARE_ECC_P256_IMPLEMENTATION
+    btstack_crypto_ecc_p256_executor = executor;
+#else
+    UNUSED(executor);
+    log_info("ECC P-256 provided by HCI Controller, executor not used");
+#endif
+}
+
 int btstack_crypto_ecc_p256_validate_public_key(const uint8_t * public_key){
 
     // validate public key using micro-ecc
@@ -123,6 +123,17 @@ typedef struct {
 	uint16_t        counter;
 } btstack_crypto_ccm_t;
 
+/**
+ * Executor for long running software ECC P-256 operations
+ */
+typedef struct {
+	/**
+	 * Call work(context) outside of the run loop, e.g. on a worker thread, and done(context) on the run loop afterwards.
+	 * Only a single work item is active at any time. work must not call into BTstack, including log_* and hci_dump.
+	 */
+	void (*execute)(void (*work)(void * context), void (*done)(void * context), void * context);
+} btstack_crypto_executor_t;
+
 /** 
  * Initialize crypto functions
  */
@@ -187,7 +198,8 @@ void btstack_crypto_aes128_cmac_zero(btstack_crypto_aes128_cmac_t * request, uin
 
 /**
  * Generate Elliptic Curve Public/Private Key Pair (FIPS P-256)
- * @note BTstack uses a single ECC key pair per reset. 
+ * @note BTstack uses a single ECC key pair per reset. With ENABLE_ECC_P256_KEY_POOL, each call provides
+ *       a new key pair. If an executor is set, the key pairs are taken from a pool that is refilled while idle. 
  * @note If LE Controller is used for ECC, private key cannot be read or managed
  * @param request
  * @param public_key (64 bytes)
@@ -206,6 +218,13 @@ void btstack_crypto_ecc_p256_generate_key(btstack_crypto_ecc_p256_t * request, u
  */
 void btstack_crypto_ecc_p256_calculate_dhkey(btstack_crypto_ecc_p256_t * request, const uint8_t * public_key, uint8_t * dhkey, void (* callback)(void * arg), void * callback_arg);
 
+/**
+ * Set executor for software ECC P-256 key generation and DHKey calculation
+ * @note Without executor, micro-ecc or mbedTLS are called on the run loop and block it until done
+ * @param executor or NULL
+ */
+void btstack_crypto_ecc_p256_set_executor(const btstack_crypto_executor_t * executor);
+
 /*
  * Validate public key (not implemented for LE Controller ECC)
  * @param public_key (64 bytes)
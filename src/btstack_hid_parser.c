@@ -40,6 +40,7 @@
 #include <string.h>
 
 #include "btstack_hid_parser.h"
+#include "bluetooth.h"
 #include "btstack_util.h"
 #include "btstack_debug.h"
 
@@ -397,8 +398,15 @@ int  btstack_hid_parser_has_more(btstack_hid_parser_t * parser){
     return parser->state == BTSTACK_HID_PARSER_USAGES_AVAILABLE;
 }
 
+static void btstack_hid_layout_get_field(btstack_hid_parser_t * parser, uint16_t * usage_page, uint16_t * usage, int32_t * value);
+
 void btstack_hid_parser_get_field(btstack_hid_parser_t * parser, uint16_t * usage_page, uint16_t * usage, int32_t * value){
 
+    if (parser->layout){
+        btstack_hid_layout_get_field(parser, usage_page, usage, value);
+        return;
+    }
+
     *usage_page = parser->usage_minimum >> 16;
 
     // read field (up to 32 bit unsigned, up to 31 bit signed - 32 bit signed behaviour is undefined) - check report len
@@ -451,3 +459,183 @@ void btstack_hid_parser_get_field(btstack_hid_parser_t * parser, uint16_t * usag
         }
     }
 }
+
+// Compiled Layout
+
+// read up to 32 bits starting at bit_offset, bits beyond end of report are read as zero
+static uint32_t btstack_hid_extract_bits(const uint8_t * report, uint16_t report_len, uint16_t bit_offset, uint8_t bit_size){
+    uint16_t pos = bit_offset >> 3;
+    uint64_t word;
+    if ((pos + 8) <= report_len){
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        memcpy(&word, &report[pos], 8);
+#else
+        word = little_endian_read_32(report, pos) | (((uint64_t) little_endian_read_32(report, pos + 4)) << 32);
+#endif
+    } else {
+        word = 0;
+        int i;
+        for (i = 0; (pos + i) < report_len; i++){
+            word |= ((uint64_t) report[pos + i]) << (8 * i);
+        }
+    }
+    word >>= bit_offset & 0x07;
+    if (bit_size >= 32) return (uint32_t) word;
+    return ((uint32_t) word) & ((1u << bit_size) - 1);
+}
+
+static void btstack_hid_field_decode(const btstack_hid_field_t * field, const uint8_t * report, uint16_t report_len, uint16_t * usage, int32_t * value){
+    uint32_t unsigned_value = btstack_hid_extract_bits(report, report_len, field->bit_offset, field->bit_size);
+    if ((field->flags & BTSTACK_HID_FIELD_FLAG_VARIABLE) == 0){
+        *usage = (uint16_t) unsigned_value;
+        *value = 1;
+        return;
+    }
+    *usage = field->usage;
+    if ((field->flags & BTSTACK_HID_FIELD_FLAG_SIGNED) && (field->bit_size > 0) && (field->bit_size < 32) && (unsigned_value & (1u << (field->bit_size - 1)))){
+        // sign extend
+        unsigned_value |= ~((1u << field->bit_size) - 1);
+    }
+    *value = (int32_t) unsigned_value;
+}
+
+static void btstack_hid_layout_get_field(btstack_hid_parser_t * parser, uint16_t * usage_page, uint16_t * usage, int32_t * value){
+    if (parser->state != BTSTACK_HID_PARSER_USAGES_AVAILABLE) return;
+    const btstack_hid_report_layout_t * report_layout = parser->layout_report;
+    const btstack_hid_field_t * field = &parser->layout->fields[report_layout->first_field + parser->layout_field_index];
+    *usage_page = field->usage_page;
+    btstack_hid_field_decode(field, parser->report, parser->report_len, usage, value);
+    parser->report_pos_in_bit = field->bit_offset + field->bit_size;
+    parser->layout_field_index++;
+    if (parser->layout_field_index >= report_layout->num_fields){
+        parser->report_pos_in_bit = report_layout->size_in_bits;
+        parser->state = BTSTACK_HID_PARSER_COMPLETE;
+    }
+}
+
+static uint8_t btstack_hid_layout_add_report_id(btstack_hid_descriptor_layout_t * layout, uint8_t report_id){
+    int i;
+    for (i=0;i<layout->num_reports;i++){
+        if (layout->reports[i].report_id == report_id) return ERROR_CODE_SUCCESS;
+    }
+    if (layout->num_reports >= layout->reports_max) return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+    memset(&layout->reports[layout->num_reports], 0, sizeof(btstack_hid_report_layout_t));
+    layout->reports[layout->num_reports].report_id = report_id;
+    layout->num_reports++;
+    return ERROR_CODE_SUCCESS;
+}
+
+// run parser over empty report and record position and usage of each field
+static uint8_t btstack_hid_layout_compile_report(btstack_hid_descriptor_layout_t * layout, btstack_hid_report_layout_t * report_layout, const uint8_t * hid_descriptor, uint16_t hid_descriptor_len){
+    const uint8_t empty_report[2] = { report_layout->report_id, 0 };
+    btstack_hid_parser_t parser;
+    btstack_hid_parser_init(&parser, hid_descriptor, hid_descriptor_len, layout->report_type, empty_report, 1);
+    report_layout->first_field = layout->num_fields;
+    while (btstack_hid_parser_has_more(&parser)){
+        if (layout->num_fields >= layout->fields_max) return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+        btstack_hid_field_t * field = &layout->fields[layout->num_fields++];
+        field->bit_offset = parser.report_pos_in_bit;
+        field->bit_size   = parser.global_report_size;
+        field->flags      = 0;
+        if (parser.descriptor_item.item_value & 2){
+            field->flags |= BTSTACK_HID_FIELD_FLAG_VARIABLE;
+        }
+        if (parser.global_logical_minimum < 0){
+            field->flags |= BTSTACK_HID_FIELD_FLAG_SIGNED;
+        }
+        uint16_t usage_page;
+        uint16_t usage;
+        int32_t  value;
+        btstack_hid_parser_get_field(&parser, &usage_page, &usage, &value);
+        field->usage_page = usage_page;
+        field->usage      = (field->flags & BTSTACK_HID_FIELD_FLAG_VARIABLE) ? usage : 0;
+    }
+    report_layout->num_fields   = layout->num_fields - report_layout->first_field;
+    report_layout->size_in_bits = parser.report_pos_in_bit;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t btstack_hid_descriptor_layout_compile(btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_descriptor, uint16_t hid_descriptor_len, 
+    btstack_hid_report_type_t hid_report_type, btstack_hid_report_layout_t * reports, uint16_t max_reports, btstack_hid_field_t * fields, uint16_t max_fields){
+
+    memset(layout, 0, sizeof(btstack_hid_descriptor_layout_t));
+    layout->report_type = hid_report_type;
+    layout->reports     = reports;
+    layout->reports_max = max_reports;
+    layout->fields      = fields;
+    layout->fields_max  = max_fields;
+
+    // collect Report IDs
+    uint16_t pos = 0;
+    while (pos < hid_descriptor_len){
+        hid_descriptor_item_t item;
+        memset(&item, 0, sizeof(item));
+        btstack_hid_parse_descriptor_item(&item, &hid_descriptor[pos], hid_descriptor_len - pos);
+        if (item.item_size == 0) break;
+        if (item.item_type == Global && item.item_tag == ReportID){
+            uint8_t status = btstack_hid_layout_add_report_id(layout, item.item_value);
+            if (status != ERROR_CODE_SUCCESS) return status;
+        }
+        pos += item.item_size;
+    }
+    layout->has_report_ids = layout->num_reports > 0;
+    if (!layout->has_report_ids){
+        uint8_t status = btstack_hid_layout_add_report_id(layout, 0);
+        if (status != ERROR_CODE_SUCCESS) return status;
+    }
+
+    int i;
+    for (i=0;i<layout->num_reports;i++){
+        uint8_t status = btstack_hid_layout_compile_report(layout, &layout->reports[i], hid_descriptor, hid_descriptor_len);
+        if (status != ERROR_CODE_SUCCESS) return status;
+    }
+    log_info("HID layout: %u reports, %u fields", layout->num_reports, layout->num_fields);
+    return ERROR_CODE_SUCCESS;
+}
+
+const btstack_hid_report_layout_t * btstack_hid_descriptor_layout_get_report(const btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_report, uint16_t hid_report_len){
+    if (!layout->has_report_ids){
+        return layout->num_reports ? &layout->reports[0] : NULL;
+    }
+    if (hid_report_len < 1) return NULL;
+    int i;
+    for (i=0;i<layout->num_reports;i++){
+        if (layout->reports[i].report_id == hid_report[0]) return &layout->reports[i];
+    }
+    return NULL;
+}
+
+int btstack_hid_descriptor_layout_process_report(const btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_report, uint16_t hid_report_len,
+    void (*callback)(uint16_t usage_page, uint16_t usage, int32_t value, void * context), void * context){
+
+    const btstack_hid_report_layout_t * report_layout = btstack_hid_descriptor_layout_get_report(layout, hid_report, hid_report_len);
+    if (!report_layout) return 0;
+    const btstack_hid_field_t * field = &layout->fields[report_layout->first_field];
+    const btstack_hid_field_t * fields_end = field + report_layout->num_fields;
+    for (; field < fields_end; field++){
+        uint16_t usage;
+        int32_t  value;
+        btstack_hid_field_decode(field, hid_report, hid_report_len, &usage, &value);
+        (*callback)(field->usage_page, usage, value, context);
+    }
+    return report_layout->num_fields;
+}
+
+void btstack_hid_parser_init_with_layout(btstack_hid_parser_t * parser, const btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_report, uint16_t hid_report_len){
+
+    memset(parser, 0, sizeof(btstack_hid_parser_t));
+
+    parser->layout         = layout;
+    parser->report_type    = layout->report_type;
+    parser->report         = hid_report;
+    parser->report_len     = hid_report_len;
+    parser->layout_report  = btstack_hid_descriptor_layout_get_report(layout, hid_report, hid_report_len);
+    parser->state          = BTSTACK_HID_PARSER_COMPLETE;
+
+    if (!parser->layout_report) return;
+    if (parser->layout_report->num_fields == 0){
+        parser->report_pos_in_bit = parser->layout_report->size_in_bits;
+        return;
+    }
+    parser->state = BTSTACK_HID_PARSER_USAGES_AVAILABLE;
+}
@@ -39,6 +39,7 @@
  *  btstack_hid_parser.h
  *
  *  Single-pass HID Report Parser: HID Report is directly parsed without preprocessing HID Descriptor to minimize memory
+ *  For high report rates, the HID Descriptor can be compiled into a table of fields once instead
  */
 
 #ifndef __BTSTACK_HID_PARSER_H
@@ -71,6 +72,37 @@ typedef enum {
     BTSTACK_HID_PARSER_COMPLETE,
 } btstack_hid_parser_state_t;
 
+#define BTSTACK_HID_FIELD_FLAG_VARIABLE 0x01
+#define BTSTACK_HID_FIELD_FLAG_SIGNED   0x02
+
+// single field of a report, array fields provide usage as value
+typedef struct {
+    uint16_t usage_page;
+    uint16_t usage;
+    uint16_t bit_offset;
+    uint8_t  bit_size;
+    uint8_t  flags;
+} btstack_hid_field_t;
+
+typedef struct {
+    uint8_t  report_id;
+    uint16_t first_field;
+    uint16_t num_fields;
+    uint16_t size_in_bits;
+} btstack_hid_report_layout_t;
+
+// fields of all reports of one type, compiled from HID Descriptor
+typedef struct {
+    btstack_hid_report_type_t     report_type;
+    uint8_t                       has_report_ids;
+    btstack_hid_report_layout_t * reports;
+    uint16_t                      reports_max;
+    uint16_t                      num_reports;
+    btstack_hid_field_t *         fields;
+    uint16_t                      fields_max;
+    uint16_t                      num_fields;
+} btstack_hid_descriptor_layout_t;
+
 typedef struct {
 
     // Descriptor
@@ -110,6 +142,11 @@ typedef struct {
     uint8_t         global_report_size;
     uint8_t         global_report_count;
     uint8_t         global_report_id;
+
+    // compiled layout, see btstack_hid_parser_init_with_layout
+    const btstack_hid_descriptor_layout_t * layout;
+    const btstack_hid_report_layout_t     * layout_report;
+    uint16_t        layout_field_index;
 } btstack_hid_parser_t;
 
 /* API_START */
@@ -140,6 +177,52 @@ int  btstack_hid_parser_has_more(btstack_hid_parser_t * parser);
  */
 void btstack_hid_parser_get_field(btstack_hid_parser_t * parser, uint16_t * usage_page, uint16_t * usage, int32_t * value);
 
+/**
+ * @brief Compile HID Descriptor into flat per-report field tables for fast report processing.
+ * @note  Walks the descriptor once for each Report ID, storage is provided by caller.
+ * @param layout
+ * @param hid_descriptor
+ * @param hid_descriptor_len
+ * @param hid_report_type
+ * @param reports storage for report table
+ * @param max_reports
+ * @param fields storage for field table
+ * @param max_fields
+ * @return ERROR_CODE_SUCCESS or ERROR_CODE_MEMORY_CAPACITY_EXCEEDED if storage is too small
+ */
+uint8_t btstack_hid_descriptor_layout_compile(btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_descriptor, uint16_t hid_descriptor_len, 
+    btstack_hid_report_type_t hid_report_type, btstack_hid_report_layout_t * reports, uint16_t max_reports, btstack_hid_field_t * fields, uint16_t max_fields);
+
+/**
+ * @brief Get report layout for HID report
+ * @param layout
+ * @param hid_report
+ * @param hid_report_len
+ * @return report layout or NULL if report ID unknown
+ */
+const btstack_hid_report_layout_t * btstack_hid_descriptor_layout_get_report(const btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_report, uint16_t hid_report_len);
+
+/**
+ * @brief Extract all fields of a HID report in a single pass
+ * @param layout
+ * @param hid_report
+ * @param hid_report_len
+ * @param callback for each field with usage page, usage and value as provided by btstack_hid_parser_get_field
+ * @param context for callback
+ * @return number of fields
+ */
+int btstack_hid_descriptor_layout_process_report(const btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_report, uint16_t hid_report_len,
+    void (*callback)(uint16_t usage_page, uint16_t usage, int32_t value, void * context), void * context);
+
+/**
+ * @brief Initialize HID Parser with compiled layout. Fields are then provided by btstack_hid_parser_has_more/btstack_hid_parser_get_field
+ * @param parser state
+ * @param layout compiled by btstack_hid_descriptor_layout_compile
+ * @param hid_report
+ * @param hid_report_len
+ */
+void btstack_hid_parser_init_with_layout(btstack_hid_parser_t * parser, const btstack_hid_descriptor_layout_t * layout, const uint8_t * hid_report, uint16_t hid_report_len);
+
 /* API_END */
 
 #if defined __cplusplus
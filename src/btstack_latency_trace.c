@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_latency_trace.c"
+
+/*
+ *  btstack_latency_trace.c
+ *
+ */
+
+#include "btstack_config.h"
+#include "btstack_latency_trace.h"
+
+#ifdef ENABLE_LATENCY_TRACE
+
+#include <stddef.h>
+#include <string.h>
+
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+
+static const char * btstack_latency_trace_segment_names[] = {
+    "RX HCI",
+    "RX L2CAP",
+    "RX ATT",
+    "RX SM",
+    "RX RFCOMM",
+    "RX AVDTP",
+    "RX Other",
+    "TX L2CAP",
+    "TX HCI",
+    "TX Transport",
+    "TX Controller",
+};
+
+static btstack_latency_trace_histogram_t btstack_latency_trace_histograms[BTSTACK_LATENCY_TRACE_NUM_SEGMENTS];
+
+static uint32_t (*btstack_latency_trace_get_time_us)(void);
+
+// incoming: time of last layer boundary of packet that is currently processed
+static uint32_t btstack_latency_trace_rx_timestamp;
+
+// outgoing: HCI and HCI Transport only handle a single ACL packet / fragment at a time
+static uint32_t btstack_latency_trace_tx_reserved_timestamp;
+static uint32_t btstack_latency_trace_tx_acl_timestamp;
+static uint32_t btstack_latency_trace_tx_fragment_timestamp;
+static uint8_t  btstack_latency_trace_tx_reserved_active;
+static uint8_t  btstack_latency_trace_tx_fragment_active;
+
+static int btstack_latency_trace_bucket_for_latency(uint32_t latency_us){
+    int bucket = 0;
+    while (latency_us && (bucket < (BTSTACK_LATENCY_TRACE_NUM_BUCKETS - 1))){
+        latency_us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void btstack_latency_trace_set_clock(uint32_t (*get_time_us)(void)){
+    btstack_latency_trace_get_time_us = get_time_us;
+}
+
+uint32_t btstack_latency_trace_now(void){
+    if (btstack_latency_trace_get_time_us){
+        return (*btstack_latency_trace_get_time_us)();
+    }
+    return btstack_run_loop_get_time_ms() * 1000;
+}
+
+uint32_t btstack_latency_trace_record(btstack_latency_trace_segment_t segment, uint32_t start_us){
+    uint32_t now = btstack_latency_trace_now();
+    if (segment >= BTSTACK_LATENCY_TRACE_NUM_SEGMENTS) return now;
+    // unsigned arithmetic handles wrap around of clock
+    uint32_t latency_us = now - start_us;
+    btstack_latency_trace_histogram_t * histogram = &btstack_latency_trace_histograms[segment];
+    histogram->count++;
+    histogram->buckets[btstack_latency_trace_bucket_for_latency(latency_us)]++;
+    if (latency_us > histogram->max_us){
+        histogram->max_us = latency_us;
+    }
+    return now;
+}
+
+const btstack_latency_trace_histogram_t * btstack_latency_trace_get_histogram(btstack_latency_trace_segment_t segment){
+    if (segment >= BTSTACK_LATENCY_TRACE_NUM_SEGMENTS) return NULL;
+    return &btstack_latency_trace_histograms[segment];
+}
+
+uint32_t btstack_latency_trace_histogram_percentile(const btstack_latency_trace_histogram_t * histogram, uint8_t percent){
+    if (histogram->count == 0) return 0;
+    if (percent > 100){
+        percent = 100;
+    }
+    uint32_t target = (uint32_t) ((((uint64_t) histogram->count) * percent + 99) / 100);
+    uint32_t samples = 0;
+    int bucket;
+    for (bucket = 0; bucket < BTSTACK_LATENCY_TRACE_NUM_BUCKETS - 1; bucket++){
+        samples += histogram->buckets[bucket];
+        if (samples >= target) break;
+    }
+    if (bucket == 0) return 0;
+    uint32_t limit_us = (1u << bucket) - 1;
+    // bucket limit might be larger than largest sample, last bucket has no limit
+    if ((bucket == BTSTACK_LATENCY_TRACE_NUM_BUCKETS - 1) || (limit_us > histogram->max_us)){
+        return histogram->max_us;
+    }
+    return limit_us;
+}
+
+const char * btstack_latency_trace_segment_name(btstack_latency_trace_segment_t segment){
+    if (segment >= BTSTACK_LATENCY_TRACE_NUM_SEGMENTS) return "Unknown";
+    return btstack_latency_trace_segment_names[segment];
+}
+
+void btstack_latency_trace_reset(void){
+    memset(btstack_latency_trace_histograms, 0, sizeof(btstack_latency_trace_histograms));
+    btstack_latency_trace_tx_reserved_active = 0;
+    btstack_latency_trace_tx_fragment_active = 0;
+}
+
+void btstack_latency_trace_dump(void){
+    int segment;
+    for (segment = 0; segment < BTSTACK_LATENCY_TRACE_NUM_SEGMENTS; segment++){
+        const btstack_latency_trace_histogram_t * histogram = &btstack_latency_trace_histograms[segment];
+        if (histogram->count == 0) continue;
+        log_info("%-13s: count %6u, p50 %7u us, p99 %7u us, max %7u us",
+            btstack_latency_trace_segment_names[segment],
+            (unsigned int) histogram->count,
+            (unsigned int) btstack_latency_trace_histogram_percentile(histogram, 50),
+            (unsigned int) btstack_latency_trace_histogram_percentile(histogram, 99),
+            (unsigned int) histogram->max_us);
+    }
+}
+
+void btstack_latency_trace_rx_acl(uint32_t received_us){
+    btstack_latency_trace_rx_timestamp = btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_HCI, received_us);
+}
+
+void btstack_latency_trace_rx_dispatch(void){
+    btstack_latency_trace_rx_timestamp = btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_L2CAP, btstack_latency_trace_rx_timestamp);
+}
+
+void btstack_latency_trace_rx_handled(btstack_latency_trace_segment_t segment){
+    btstack_latency_trace_record(segment, btstack_latency_trace_rx_timestamp);
+}
+
+void btstack_latency_trace_tx_reserved(void){
+    btstack_latency_trace_tx_reserved_timestamp = btstack_latency_trace_now();
+    btstack_latency_trace_tx_reserved_active = 1;
+}
+
+void btstack_latency_trace_tx_released(void){
+    btstack_latency_trace_tx_reserved_active = 0;
+}
+
+void btstack_latency_trace_tx_acl(void){
+    if (btstack_latency_trace_tx_reserved_active){
+        btstack_latency_trace_tx_reserved_active = 0;
+        btstack_latency_trace_tx_acl_timestamp = btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_TX_L2CAP, btstack_latency_trace_tx_reserved_timestamp);
+    } else {
+        // L2CAP signaling and retransmissions don't use l2cap_reserve_packet_buffer
+        btstack_latency_trace_tx_acl_timestamp = btstack_latency_trace_now();
+    }
+}
+
+uint32_t btstack_latency_trace_tx_fragment(int last_fragment){
+    uint32_t now;
+    if (last_fragment){
+        now = btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_TX_HCI, btstack_latency_trace_tx_acl_timestamp);
+    } else {
+        now = btstack_latency_trace_now();
+    }
+    btstack_latency_trace_tx_fragment_timestamp = now;
+    btstack_latency_trace_tx_fragment_active = 1;
+    return now;
+}
+
+void btstack_latency_trace_tx_sent(void){
+    // also called for HCI Commands and SCO packets
+    if (!btstack_latency_trace_tx_fragment_active) return;
+    btstack_latency_trace_tx_fragment_active = 0;
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_TX_TRANSPORT, btstack_latency_trace_tx_fragment_timestamp);
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_latency_trace.h
+ *
+ *  Optional latency tracing, enabled with ENABLE_LATENCY_TRACE. Incoming and outgoing ACL packets
+ *  are time stamped at the layer boundaries (HCI Transport, HCI, L2CAP, protocol handler) and the
+ *  time spent in each segment is collected in a histogram with logarithmic buckets.
+ *  Recording a sample takes a single clock read and a few additions, no memory is allocated.
+ */
+
+#ifndef __BTSTACK_LATENCY_TRACE_H
+#define __BTSTACK_LATENCY_TRACE_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// bucket 0: 0 us, bucket i: [2^(i-1), 2^i) us, last bucket: everything above
+#define BTSTACK_LATENCY_TRACE_NUM_BUCKETS 24
+
+// timestamps of outgoing ACL packets kept per connection until Number of Completed Packets, power of two
+#ifndef LATENCY_TRACE_TX_TIMESTAMPS
+#define LATENCY_TRACE_TX_TIMESTAMPS 8
+#endif
+
+typedef enum {
+    // incoming: first ACL fragment received from HCI Transport -> complete packet passed to L2CAP
+    BTSTACK_LATENCY_TRACE_RX_HCI = 0,
+    // incoming: L2CAP -> packet handler of channel or fixed channel called
+    BTSTACK_LATENCY_TRACE_RX_L2CAP,
+    // incoming: packet handler execution time per protocol
+    BTSTACK_LATENCY_TRACE_RX_ATT,
+    BTSTACK_LATENCY_TRACE_RX_SM,
+    BTSTACK_LATENCY_TRACE_RX_RFCOMM,
+    BTSTACK_LATENCY_TRACE_RX_AVDTP,
+    BTSTACK_LATENCY_TRACE_RX_OTHER,
+    // outgoing: L2CAP packet buffer reserved -> packet passed to HCI
+    BTSTACK_LATENCY_TRACE_TX_L2CAP,
+    // outgoing: HCI -> last ACL fragment passed to HCI Transport
+    BTSTACK_LATENCY_TRACE_TX_HCI,
+    // outgoing: ACL fragment passed to HCI Transport -> transport packet sent
+    BTSTACK_LATENCY_TRACE_TX_TRANSPORT,
+    // outgoing: ACL fragment passed to HCI Transport -> reported by Number of Completed Packets Event
+    BTSTACK_LATENCY_TRACE_TX_CONTROLLER,
+    BTSTACK_LATENCY_TRACE_NUM_SEGMENTS
+} btstack_latency_trace_segment_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t buckets[BTSTACK_LATENCY_TRACE_NUM_BUCKETS];
+} btstack_latency_trace_histogram_t;
+
+/* API_START */
+
+/**
+ * @brief Set monotonic clock with microsecond resolution, e.g. based on a hardware timer
+ * @note Defaults to btstack_run_loop_get_time_ms, which is too coarse for most segments
+ * @param get_time_us returns current time in us, may wrap around
+ */
+void btstack_latency_trace_set_clock(uint32_t (*get_time_us)(void));
+
+/**
+ * @brief Get current time from configured clock
+ * @return time in us
+ */
+uint32_t btstack_latency_trace_now(void);
+
+/**
+ * @brief Add latency from start until now to histogram of segment
+ * @param segment
+ * @param start_us as returned by btstack_latency_trace_now
+ * @return now in us
+ */
+uint32_t btstack_latency_trace_record(btstack_latency_trace_segment_t segment, uint32_t start_us);
+
+/**
+ * @brief Get histogram for segment
+ * @param segment
+ * @return histogram or NULL if segment invalid
+ */
+const btstack_latency_trace_histogram_t * btstack_latency_trace_get_histogram(btstack_latency_trace_segment_t segment);
+
+/**
+ * @brief Get upper bound for percentile of histogram
+ * @param histogram
+ * @param percent 0..100
+ * @return latency in us that percent of the samples do not exceed, rounded up to bucket limit
+ */
+uint32_t btstack_latency_trace_histogram_percentile(const btstack_latency_trace_histogram_t * histogram, uint8_t percent);
+
+/**
+ * @brief Get name of segment
+ * @param segment
+ * @return name
+ */
+const char * btstack_latency_trace_segment_name(btstack_latency_trace_segment_t segment);
+
+/**
+ * @brief Clear all histograms and pending time stamps
+ */
+void btstack_latency_trace_reset(void);
+
+/**
+ * @brief Log count, median, 99th percentile and maximum of all segments
+ */
+void btstack_latency_trace_dump(void);
+
+/* API_END */
+
+// internal use by HCI and L2CAP
+
+/**
+ * @brief HCI: complete ACL packet received at received_us is passed to L2CAP
+ */
+void btstack_latency_trace_rx_acl(uint32_t received_us);
+
+/**
+ * @brief L2CAP: packet handler is about to be called
+ */
+void btstack_latency_trace_rx_dispatch(void);
+
+/**
+ * @brief L2CAP: packet handler returned
+ * @param segment for protocol
+ */
+void btstack_latency_trace_rx_handled(btstack_latency_trace_segment_t segment);
+
+/**
+ * @brief L2CAP: outgoing packet buffer reserved
+ */
+void btstack_latency_trace_tx_reserved(void);
+
+/**
+ * @brief L2CAP: outgoing packet buffer released without sending
+ */
+void btstack_latency_trace_tx_released(void);
+
+/**
+ * @brief HCI: ACL packet from L2CAP to send
+ */
+void btstack_latency_trace_tx_acl(void);
+
+/**
+ * @brief HCI: ACL fragment is passed to HCI Transport
+ * @param last_fragment
+ * @return now in us
+ */
+uint32_t btstack_latency_trace_tx_fragment(int last_fragment);
+
+/**
+ * @brief HCI: HCI Transport packet sent
+ */
+void btstack_latency_trace_tx_sent(void);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __BTSTACK_LATENCY_TRACE_H
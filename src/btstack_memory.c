@@ -47,8 +47,12 @@
 
 #include "btstack_memory.h"
 #include "btstack_memory_pool.h"
+#ifdef ENABLE_MEMORY_SLAB
+#include "btstack_memory_slab.h"
+#endif
 
 #include <stdlib.h>
+#include <string.h>
 
 
 
@@ -71,6 +75,9 @@ hci_connection_t * btstack_memory_hci_connection_get(void){
 void btstack_memory_hci_connection_free(hci_connection_t *hci_connection){
     btstack_memory_pool_free(&hci_connection_pool, hci_connection);
 }
+void btstack_memory_hci_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&hci_connection_pool, stats);
+}
 #else
 hci_connection_t * btstack_memory_hci_connection_get(void){
     return NULL;
@@ -79,14 +86,35 @@ void btstack_memory_hci_connection_free(hci_connection_t *hci_connection){
     // silence compiler warning about unused parameter in a portable way
     (void) hci_connection;
 };
+void btstack_memory_hci_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t hci_connection_slab;
+hci_connection_t * btstack_memory_hci_connection_get(void){
+    return (hci_connection_t *) btstack_memory_slab_get(&hci_connection_slab);
+}
+void btstack_memory_hci_connection_free(hci_connection_t *hci_connection){
+    btstack_memory_slab_free(&hci_connection_slab, hci_connection);
+}
+void btstack_memory_hci_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&hci_connection_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t hci_connection_stats;
 hci_connection_t * btstack_memory_hci_connection_get(void){
-    return (hci_connection_t*) malloc(sizeof(hci_connection_t));
+    hci_connection_t * hci_connection = (hci_connection_t*) malloc(sizeof(hci_connection_t));
+    btstack_memory_pool_stats_record_get(&hci_connection_stats, hci_connection);
+    return hci_connection;
 }
 void btstack_memory_hci_connection_free(hci_connection_t *hci_connection){
+    btstack_memory_pool_stats_record_free(&hci_connection_stats);
     free(hci_connection);
 }
+void btstack_memory_hci_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = hci_connection_stats;
+}
 #endif
 
 
@@ -110,6 +138,9 @@ l2cap_service_t * btstack_memory_l2cap_service_get(void){
 void btstack_memory_l2cap_service_free(l2cap_service_t *l2cap_service){
     btstack_memory_pool_free(&l2cap_service_pool, l2cap_service);
 }
+void btstack_memory_l2cap_service_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&l2cap_service_pool, stats);
+}
 #else
 l2cap_service_t * btstack_memory_l2cap_service_get(void){
     return NULL;
@@ -118,14 +149,35 @@ void btstack_memory_l2cap_service_free(l2cap_service_t *l2cap_service){
     // silence compiler warning about unused parameter in a portable way
     (void) l2cap_service;
 };
+void btstack_memory_l2cap_service_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t l2cap_service_slab;
+l2cap_service_t * btstack_memory_l2cap_service_get(void){
+    return (l2cap_service_t *) btstack_memory_slab_get(&l2cap_service_slab);
+}
+void btstack_memory_l2cap_service_free(l2cap_service_t *l2cap_service){
+    btstack_memory_slab_free(&l2cap_service_slab, l2cap_service);
+}
+void btstack_memory_l2cap_service_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&l2cap_service_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t l2cap_service_stats;
 l2cap_service_t * btstack_memory_l2cap_service_get(void){
-    return (l2cap_service_t*) malloc(sizeof(l2cap_service_t));
+    l2cap_service_t * l2cap_service = (l2cap_service_t*) malloc(sizeof(l2cap_service_t));
+    btstack_memory_pool_stats_record_get(&l2cap_service_stats, l2cap_service);
+    return l2cap_service;
 }
 void btstack_memory_l2cap_service_free(l2cap_service_t *l2cap_service){
+    btstack_memory_pool_stats_record_free(&l2cap_service_stats);
     free(l2cap_service);
 }
+void btstack_memory_l2cap_service_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = l2cap_service_stats;
+}
 #endif
 
 
@@ -148,6 +200,9 @@ l2cap_channel_t * btstack_memory_l2cap_channel_get(void){
 void btstack_memory_l2cap_channel_free(l2cap_channel_t *l2cap_channel){
     btstack_memory_pool_free(&l2cap_channel_pool, l2cap_channel);
 }
+void btstack_memory_l2cap_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&l2cap_channel_pool, stats);
+}
 #else
 l2cap_channel_t * btstack_memory_l2cap_channel_get(void){
     return NULL;
@@ -156,14 +211,35 @@ void btstack_memory_l2cap_channel_free(l2cap_channel_t *l2cap_channel){
     // silence compiler warning about unused parameter in a portable way
     (void) l2cap_channel;
 };
+void btstack_memory_l2cap_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t l2cap_channel_slab;
+l2cap_channel_t * btstack_memory_l2cap_channel_get(void){
+    return (l2cap_channel_t *) btstack_memory_slab_get(&l2cap_channel_slab);
+}
+void btstack_memory_l2cap_channel_free(l2cap_channel_t *l2cap_channel){
+    btstack_memory_slab_free(&l2cap_channel_slab, l2cap_channel);
+}
+void btstack_memory_l2cap_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&l2cap_channel_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t l2cap_channel_stats;
 l2cap_channel_t * btstack_memory_l2cap_channel_get(void){
-    return (l2cap_channel_t*) malloc(sizeof(l2cap_channel_t));
+    l2cap_channel_t * l2cap_channel = (l2cap_channel_t*) malloc(sizeof(l2cap_channel_t));
+    btstack_memory_pool_stats_record_get(&l2cap_channel_stats, l2cap_channel);
+    return l2cap_channel;
 }
 void btstack_memory_l2cap_channel_free(l2cap_channel_t *l2cap_channel){
+    btstack_memory_pool_stats_record_free(&l2cap_channel_stats);
     free(l2cap_channel);
 }
+void btstack_memory_l2cap_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = l2cap_channel_stats;
+}
 #endif
 
 
@@ -187,6 +263,9 @@ rfcomm_multiplexer_t * btstack_memory_rfcomm_multiplexer_get(void){
 void btstack_memory_rfcomm_multiplexer_free(rfcomm_multiplexer_t *rfcomm_multiplexer){
     btstack_memory_pool_free(&rfcomm_multiplexer_pool, rfcomm_multiplexer);
 }
+void btstack_memory_rfcomm_multiplexer_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&rfcomm_multiplexer_pool, stats);
+}
 #else
 rfcomm_multiplexer_t * btstack_memory_rfcomm_multiplexer_get(void){
     return NULL;
@@ -195,14 +274,35 @@ void btstack_memory_rfcomm_multiplexer_free(rfcomm_multiplexer_t *rfcomm_multipl
     // silence compiler warning about unused parameter in a portable way
     (void) rfcomm_multiplexer;
 };
+void btstack_memory_rfcomm_multiplexer_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t rfcomm_multiplexer_slab;
+rfcomm_multiplexer_t * btstack_memory_rfcomm_multiplexer_get(void){
+    return (rfcomm_multiplexer_t *) btstack_memory_slab_get(&rfcomm_multiplexer_slab);
+}
+void btstack_memory_rfcomm_multiplexer_free(rfcomm_multiplexer_t *rfcomm_multiplexer){
+    btstack_memory_slab_free(&rfcomm_multiplexer_slab, rfcomm_multiplexer);
+}
+void btstack_memory_rfcomm_multiplexer_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&rfcomm_multiplexer_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t rfcomm_multiplexer_stats;
 rfcomm_multiplexer_t * btstack_memory_rfcomm_multiplexer_get(void){
-    return (rfcomm_multiplexer_t*) malloc(sizeof(rfcomm_multiplexer_t));
+    rfcomm_multiplexer_t * rfcomm_multiplexer = (rfcomm_multiplexer_t*) malloc(sizeof(rfcomm_multiplexer_t));
+    btstack_memory_pool_stats_record_get(&rfcomm_multiplexer_stats, rfcomm_multiplexer);
+    return rfcomm_multiplexer;
 }
 void btstack_memory_rfcomm_multiplexer_free(rfcomm_multiplexer_t *rfcomm_multiplexer){
+    btstack_memory_pool_stats_record_free(&rfcomm_multiplexer_stats);
     free(rfcomm_multiplexer);
 }
+void btstack_memory_rfcomm_multiplexer_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = rfcomm_multiplexer_stats;
+}
 #endif
 
 
@@ -225,6 +325,9 @@ rfcomm_service_t * btstack_memory_rfcomm_service_get(void){
 void btstack_memory_rfcomm_service_free(rfcomm_service_t *rfcomm_service){
     btstack_memory_pool_free(&rfcomm_service_pool, rfcomm_service);
 }
+void btstack_memory_rfcomm_service_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&rfcomm_service_pool, stats);
+}
 #else
 rfcomm_service_t * btstack_memory_rfcomm_service_get(void){
     return NULL;
@@ -233,14 +336,35 @@ void btstack_memory_rfcomm_service_free(rfcomm_service_t *rfcomm_service){
     // silence compiler warning about unused parameter in a portable way
     (void) rfcomm_service;
 };
+void btstack_memory_rfcomm_service_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t rfcomm_service_slab;
+rfcomm_service_t * btstack_memory_rfcomm_service_get(void){
+    return (rfcomm_service_t *) btstack_memory_slab_get(&rfcomm_service_slab);
+}
+void btstack_memory_rfcomm_service_free(rfcomm_service_t *rfcomm_service){
+    btstack_memory_slab_free(&rfcomm_service_slab, rfcomm_service);
+}
+void btstack_memory_rfcomm_service_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&rfcomm_service_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t rfcomm_service_stats;
 rfcomm_service_t * btstack_memory_rfcomm_service_get(void){
-    return (rfcomm_service_t*) malloc(sizeof(rfcomm_service_t));
+    rfcomm_service_t * rfcomm_service = (rfcomm_service_t*) malloc(sizeof(rfcomm_service_t));
+    btstack_memory_pool_stats_record_get(&rfcomm_service_stats, rfcomm_service);
+    return rfcomm_service;
 }
 void btstack_memory_rfcomm_service_free(rfcomm_service_t *rfcomm_service){
+    btstack_memory_pool_stats_record_free(&rfcomm_service_stats);
     free(rfcomm_service);
 }
+void btstack_memory_rfcomm_service_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = rfcomm_service_stats;
+}
 #endif
 
 
@@ -263,6 +387,9 @@ rfcomm_channel_t * btstack_memory_rfcomm_channel_get(void){
 void btstack_memory_rfcomm_channel_free(rfcomm_channel_t *rfcomm_channel){
     btstack_memory_pool_free(&rfcomm_channel_pool, rfcomm_channel);
 }
+void btstack_memory_rfcomm_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&rfcomm_channel_pool, stats);
+}
 #else
 rfcomm_channel_t * btstack_memory_rfcomm_channel_get(void){
     return NULL;
@@ -271,14 +398,35 @@ void btstack_memory_rfcomm_channel_free(rfcomm_channel_t *rfcomm_channel){
     // silence compiler warning about unused parameter in a portable way
     (void) rfcomm_channel;
 };
+void btstack_memory_rfcomm_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t rfcomm_channel_slab;
+rfcomm_channel_t * btstack_memory_rfcomm_channel_get(void){
+    return (rfcomm_channel_t *) btstack_memory_slab_get(&rfcomm_channel_slab);
+}
+void btstack_memory_rfcomm_channel_free(rfcomm_channel_t *rfcomm_channel){
+    btstack_memory_slab_free(&rfcomm_channel_slab, rfcomm_channel);
+}
+void btstack_memory_rfcomm_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&rfcomm_channel_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t rfcomm_channel_stats;
 rfcomm_channel_t * btstack_memory_rfcomm_channel_get(void){
-    return (rfcomm_channel_t*) malloc(sizeof(rfcomm_channel_t));
+    rfcomm_channel_t * rfcomm_channel = (rfcomm_channel_t*) malloc(sizeof(rfcomm_channel_t));
+    btstack_memory_pool_stats_record_get(&rfcomm_channel_stats, rfcomm_channel);
+    return rfcomm_channel;
 }
 void btstack_memory_rfcomm_channel_free(rfcomm_channel_t *rfcomm_channel){
+    btstack_memory_pool_stats_record_free(&rfcomm_channel_stats);
     free(rfcomm_channel);
 }
+void btstack_memory_rfcomm_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = rfcomm_channel_stats;
+}
 #endif
 
 
@@ -302,6 +450,9 @@ btstack_link_key_db_memory_entry_t * btstack_memory_btstack_link_key_db_memory_e
 void btstack_memory_btstack_link_key_db_memory_entry_free(btstack_link_key_db_memory_entry_t *btstack_link_key_db_memory_entry){
     btstack_memory_pool_free(&btstack_link_key_db_memory_entry_pool, btstack_link_key_db_memory_entry);
 }
+void btstack_memory_btstack_link_key_db_memory_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&btstack_link_key_db_memory_entry_pool, stats);
+}
 #else
 btstack_link_key_db_memory_entry_t * btstack_memory_btstack_link_key_db_memory_entry_get(void){
     return NULL;
@@ -310,14 +461,35 @@ void btstack_memory_btstack_link_key_db_memory_entry_free(btstack_link_key_db_me
     // silence compiler warning about unused parameter in a portable way
     (void) btstack_link_key_db_memory_entry;
 };
+void btstack_memory_btstack_link_key_db_memory_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t btstack_link_key_db_memory_entry_slab;
+btstack_link_key_db_memory_entry_t * btstack_memory_btstack_link_key_db_memory_entry_get(void){
+    return (btstack_link_key_db_memory_entry_t *) btstack_memory_slab_get(&btstack_link_key_db_memory_entry_slab);
+}
+void btstack_memory_btstack_link_key_db_memory_entry_free(btstack_link_key_db_memory_entry_t *btstack_link_key_db_memory_entry){
+    btstack_memory_slab_free(&btstack_link_key_db_memory_entry_slab, btstack_link_key_db_memory_entry);
+}
+void btstack_memory_btstack_link_key_db_memory_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&btstack_link_key_db_memory_entry_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t btstack_link_key_db_memory_entry_stats;
 btstack_link_key_db_memory_entry_t * btstack_memory_btstack_link_key_db_memory_entry_get(void){
-    return (btstack_link_key_db_memory_entry_t*) malloc(sizeof(btstack_link_key_db_memory_entry_t));
+    btstack_link_key_db_memory_entry_t * btstack_link_key_db_memory_entry = (btstack_link_key_db_memory_entry_t*) malloc(sizeof(btstack_link_key_db_memory_entry_t));
+    btstack_memory_pool_stats_record_get(&btstack_link_key_db_memory_entry_stats, btstack_link_key_db_memory_entry);
+    return btstack_link_key_db_memory_entry;
 }
 void btstack_memory_btstack_link_key_db_memory_entry_free(btstack_link_key_db_memory_entry_t *btstack_link_key_db_memory_entry){
+    btstack_memory_pool_stats_record_free(&btstack_link_key_db_memory_entry_stats);
     free(btstack_link_key_db_memory_entry);
 }
+void btstack_memory_btstack_link_key_db_memory_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = btstack_link_key_db_memory_entry_stats;
+}
 #endif
 
 
@@ -341,6 +513,9 @@ bnep_service_t * btstack_memory_bnep_service_get(void){
 void btstack_memory_bnep_service_free(bnep_service_t *bnep_service){
     btstack_memory_pool_free(&bnep_service_pool, bnep_service);
 }
+void btstack_memory_bnep_service_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&bnep_service_pool, stats);
+}
 #else
 bnep_service_t * btstack_memory_bnep_service_get(void){
     return NULL;
@@ -349,14 +524,35 @@ void btstack_memory_bnep_service_free(bnep_service_t *bnep_service){
     // silence compiler warning about unused parameter in a portable way
     (void) bnep_service;
 };
+void btstack_memory_bnep_service_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t bnep_service_slab;
+bnep_service_t * btstack_memory_bnep_service_get(void){
+    return (bnep_service_t *) btstack_memory_slab_get(&bnep_service_slab);
+}
+void btstack_memory_bnep_service_free(bnep_service_t *bnep_service){
+    btstack_memory_slab_free(&bnep_service_slab, bnep_service);
+}
+void btstack_memory_bnep_service_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&bnep_service_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t bnep_service_stats;
 bnep_service_t * btstack_memory_bnep_service_get(void){
-    return (bnep_service_t*) malloc(sizeof(bnep_service_t));
+    bnep_service_t * bnep_service = (bnep_service_t*) malloc(sizeof(bnep_service_t));
+    btstack_memory_pool_stats_record_get(&bnep_service_stats, bnep_service);
+    return bnep_service;
 }
 void btstack_memory_bnep_service_free(bnep_service_t *bnep_service){
+    btstack_memory_pool_stats_record_free(&bnep_service_stats);
     free(bnep_service);
 }
+void btstack_memory_bnep_service_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = bnep_service_stats;
+}
 #endif
 
 
@@ -379,6 +575,9 @@ bnep_channel_t * btstack_memory_bnep_channel_get(void){
 void btstack_memory_bnep_channel_free(bnep_channel_t *bnep_channel){
     btstack_memory_pool_free(&bnep_channel_pool, bnep_channel);
 }
+void btstack_memory_bnep_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&bnep_channel_pool, stats);
+}
 #else
 bnep_channel_t * btstack_memory_bnep_channel_get(void){
     return NULL;
@@ -387,14 +586,35 @@ void btstack_memory_bnep_channel_free(bnep_channel_t *bnep_channel){
     // silence compiler warning about unused parameter in a portable way
     (void) bnep_channel;
 };
+void btstack_memory_bnep_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t bnep_channel_slab;
+bnep_channel_t * btstack_memory_bnep_channel_get(void){
+    return (bnep_channel_t *) btstack_memory_slab_get(&bnep_channel_slab);
+}
+void btstack_memory_bnep_channel_free(bnep_channel_t *bnep_channel){
+    btstack_memory_slab_free(&bnep_channel_slab, bnep_channel);
+}
+void btstack_memory_bnep_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&bnep_channel_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t bnep_channel_stats;
 bnep_channel_t * btstack_memory_bnep_channel_get(void){
-    return (bnep_channel_t*) malloc(sizeof(bnep_channel_t));
+    bnep_channel_t * bnep_channel = (bnep_channel_t*) malloc(sizeof(bnep_channel_t));
+    btstack_memory_pool_stats_record_get(&bnep_channel_stats, bnep_channel);
+    return bnep_channel;
 }
 void btstack_memory_bnep_channel_free(bnep_channel_t *bnep_channel){
+    btstack_memory_pool_stats_record_free(&bnep_channel_stats);
     free(bnep_channel);
 }
+void btstack_memory_bnep_channel_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = bnep_channel_stats;
+}
 #endif
 
 
@@ -418,6 +638,9 @@ hfp_connection_t * btstack_memory_hfp_connection_get(void){
 void btstack_memory_hfp_connection_free(hfp_connection_t *hfp_connection){
     btstack_memory_pool_free(&hfp_connection_pool, hfp_connection);
 }
+void btstack_memory_hfp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&hfp_connection_pool, stats);
+}
 #else
 hfp_connection_t * btstack_memory_hfp_connection_get(void){
     return NULL;
@@ -426,14 +649,35 @@ void btstack_memory_hfp_connection_free(hfp_connection_t *hfp_connection){
     // silence compiler warning about unused parameter in a portable way
     (void) hfp_connection;
 };
+void btstack_memory_hfp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t hfp_connection_slab;
+hfp_connection_t * btstack_memory_hfp_connection_get(void){
+    return (hfp_connection_t *) btstack_memory_slab_get(&hfp_connection_slab);
+}
+void btstack_memory_hfp_connection_free(hfp_connection_t *hfp_connection){
+    btstack_memory_slab_free(&hfp_connection_slab, hfp_connection);
+}
+void btstack_memory_hfp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&hfp_connection_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t hfp_connection_stats;
 hfp_connection_t * btstack_memory_hfp_connection_get(void){
-    return (hfp_connection_t*) malloc(sizeof(hfp_connection_t));
+    hfp_connection_t * hfp_connection = (hfp_connection_t*) malloc(sizeof(hfp_connection_t));
+    btstack_memory_pool_stats_record_get(&hfp_connection_stats, hfp_connection);
+    return hfp_connection;
 }
 void btstack_memory_hfp_connection_free(hfp_connection_t *hfp_connection){
+    btstack_memory_pool_stats_record_free(&hfp_connection_stats);
     free(hfp_connection);
 }
+void btstack_memory_hfp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = hfp_connection_stats;
+}
 #endif
 
 
@@ -457,6 +701,9 @@ service_record_item_t * btstack_memory_service_record_item_get(void){
 void btstack_memory_service_record_item_free(service_record_item_t *service_record_item){
     btstack_memory_pool_free(&service_record_item_pool, service_record_item);
 }
+void btstack_memory_service_record_item_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&service_record_item_pool, stats);
+}
 #else
 service_record_item_t * btstack_memory_service_record_item_get(void){
     return NULL;
@@ -465,14 +712,35 @@ void btstack_memory_service_record_item_free(service_record_item_t *service_reco
     // silence compiler warning about unused parameter in a portable way
     (void) service_record_item;
 };
+void btstack_memory_service_record_item_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t service_record_item_slab;
+service_record_item_t * btstack_memory_service_record_item_get(void){
+    return (service_record_item_t *) btstack_memory_slab_get(&service_record_item_slab);
+}
+void btstack_memory_service_record_item_free(service_record_item_t *service_record_item){
+    btstack_memory_slab_free(&service_record_item_slab, service_record_item);
+}
+void btstack_memory_service_record_item_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&service_record_item_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t service_record_item_stats;
 service_record_item_t * btstack_memory_service_record_item_get(void){
-    return (service_record_item_t*) malloc(sizeof(service_record_item_t));
+    service_record_item_t * service_record_item = (service_record_item_t*) malloc(sizeof(service_record_item_t));
+    btstack_memory_pool_stats_record_get(&service_record_item_stats, service_record_item);
+    return service_record_item;
 }
 void btstack_memory_service_record_item_free(service_record_item_t *service_record_item){
+    btstack_memory_pool_stats_record_free(&service_record_item_stats);
     free(service_record_item);
 }
+void btstack_memory_service_record_item_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = service_record_item_stats;
+}
 #endif
 
 
@@ -496,6 +764,9 @@ avdtp_stream_endpoint_t * btstack_memory_avdtp_stream_endpoint_get(void){
 void btstack_memory_avdtp_stream_endpoint_free(avdtp_stream_endpoint_t *avdtp_stream_endpoint){
     btstack_memory_pool_free(&avdtp_stream_endpoint_pool, avdtp_stream_endpoint);
 }
+void btstack_memory_avdtp_stream_endpoint_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&avdtp_stream_endpoint_pool, stats);
+}
 #else
 avdtp_stream_endpoint_t * btstack_memory_avdtp_stream_endpoint_get(void){
     return NULL;
@@ -504,14 +775,35 @@ void btstack_memory_avdtp_stream_endpoint_free(avdtp_stream_endpoint_t *avdtp_st
     // silence compiler warning about unused parameter in a portable way
     (void) avdtp_stream_endpoint;
 };
+void btstack_memory_avdtp_stream_endpoint_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t avdtp_stream_endpoint_slab;
+avdtp_stream_endpoint_t * btstack_memory_avdtp_stream_endpoint_get(void){
+    return (avdtp_stream_endpoint_t *) btstack_memory_slab_get(&avdtp_stream_endpoint_slab);
+}
+void btstack_memory_avdtp_stream_endpoint_free(avdtp_stream_endpoint_t *avdtp_stream_endpoint){
+    btstack_memory_slab_free(&avdtp_stream_endpoint_slab, avdtp_stream_endpoint);
+}
+void btstack_memory_avdtp_stream_endpoint_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&avdtp_stream_endpoint_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t avdtp_stream_endpoint_stats;
 avdtp_stream_endpoint_t * btstack_memory_avdtp_stream_endpoint_get(void){
-    return (avdtp_stream_endpoint_t*) malloc(sizeof(avdtp_stream_endpoint_t));
+    avdtp_stream_endpoint_t * avdtp_stream_endpoint = (avdtp_stream_endpoint_t*) malloc(sizeof(avdtp_stream_endpoint_t));
+    btstack_memory_pool_stats_record_get(&avdtp_stream_endpoint_stats, avdtp_stream_endpoint);
+    return avdtp_stream_endpoint;
 }
 void btstack_memory_avdtp_stream_endpoint_free(avdtp_stream_endpoint_t *avdtp_stream_endpoint){
+    btstack_memory_pool_stats_record_free(&avdtp_stream_endpoint_stats);
     free(avdtp_stream_endpoint);
 }
+void btstack_memory_avdtp_stream_endpoint_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = avdtp_stream_endpoint_stats;
+}
 #endif
 
 
@@ -535,6 +827,9 @@ avdtp_connection_t * btstack_memory_avdtp_connection_get(void){
 void btstack_memory_avdtp_connection_free(avdtp_connection_t *avdtp_connection){
     btstack_memory_pool_free(&avdtp_connection_pool, avdtp_connection);
 }
+void btstack_memory_avdtp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&avdtp_connection_pool, stats);
+}
 #else
 avdtp_connection_t * btstack_memory_avdtp_connection_get(void){
     return NULL;
@@ -543,14 +838,35 @@ void btstack_memory_avdtp_connection_free(avdtp_connection_t *avdtp_connection){
     // silence compiler warning about unused parameter in a portable way
     (void) avdtp_connection;
 };
+void btstack_memory_avdtp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t avdtp_connection_slab;
+avdtp_connection_t * btstack_memory_avdtp_connection_get(void){
+    return (avdtp_connection_t *) btstack_memory_slab_get(&avdtp_connection_slab);
+}
+void btstack_memory_avdtp_connection_free(avdtp_connection_t *avdtp_connection){
+    btstack_memory_slab_free(&avdtp_connection_slab, avdtp_connection);
+}
+void btstack_memory_avdtp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&avdtp_connection_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t avdtp_connection_stats;
 avdtp_connection_t * btstack_memory_avdtp_connection_get(void){
-    return (avdtp_connection_t*) malloc(sizeof(avdtp_connection_t));
+    avdtp_connection_t * avdtp_connection = (avdtp_connection_t*) malloc(sizeof(avdtp_connection_t));
+    btstack_memory_pool_stats_record_get(&avdtp_connection_stats, avdtp_connection);
+    return avdtp_connection;
 }
 void btstack_memory_avdtp_connection_free(avdtp_connection_t *avdtp_connection){
+    btstack_memory_pool_stats_record_free(&avdtp_connection_stats);
     free(avdtp_connection);
 }
+void btstack_memory_avdtp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = avdtp_connection_stats;
+}
 #endif
 
 
@@ -574,6 +890,9 @@ avrcp_connection_t * btstack_memory_avrcp_connection_get(void){
 void btstack_memory_avrcp_connection_free(avrcp_connection_t *avrcp_connection){
     btstack_memory_pool_free(&avrcp_connection_pool, avrcp_connection);
 }
+void btstack_memory_avrcp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&avrcp_connection_pool, stats);
+}
 #else
 avrcp_connection_t * btstack_memory_avrcp_connection_get(void){
     return NULL;
@@ -582,14 +901,35 @@ void btstack_memory_avrcp_connection_free(avrcp_connection_t *avrcp_connection){
     // silence compiler warning about unused parameter in a portable way
     (void) avrcp_connection;
 };
+void btstack_memory_avrcp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t avrcp_connection_slab;
+avrcp_connection_t * btstack_memory_avrcp_connection_get(void){
+    return (avrcp_connection_t *) btstack_memory_slab_get(&avrcp_connection_slab);
+}
+void btstack_memory_avrcp_connection_free(avrcp_connection_t *avrcp_connection){
+    btstack_memory_slab_free(&avrcp_connection_slab, avrcp_connection);
+}
+void btstack_memory_avrcp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&avrcp_connection_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t avrcp_connection_stats;
 avrcp_connection_t * btstack_memory_avrcp_connection_get(void){
-    return (avrcp_connection_t*) malloc(sizeof(avrcp_connection_t));
+    avrcp_connection_t * avrcp_connection = (avrcp_connection_t*) malloc(sizeof(avrcp_connection_t));
+    btstack_memory_pool_stats_record_get(&avrcp_connection_stats, avrcp_connection);
+    return avrcp_connection;
 }
 void btstack_memory_avrcp_connection_free(avrcp_connection_t *avrcp_connection){
+    btstack_memory_pool_stats_record_free(&avrcp_connection_stats);
     free(avrcp_connection);
 }
+void btstack_memory_avrcp_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = avrcp_connection_stats;
+}
 #endif
 
 
@@ -613,6 +953,9 @@ avrcp_browsing_connection_t * btstack_memory_avrcp_browsing_connection_get(void)
 void btstack_memory_avrcp_browsing_connection_free(avrcp_browsing_connection_t *avrcp_browsing_connection){
     btstack_memory_pool_free(&avrcp_browsing_connection_pool, avrcp_browsing_connection);
 }
+void btstack_memory_avrcp_browsing_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&avrcp_browsing_connection_pool, stats);
+}
 #else
 avrcp_browsing_connection_t * btstack_memory_avrcp_browsing_connection_get(void){
     return NULL;
@@ -621,14 +964,35 @@ void btstack_memory_avrcp_browsing_connection_free(avrcp_browsing_connection_t *
     // silence compiler warning about unused parameter in a portable way
     (void) avrcp_browsing_connection;
 };
+void btstack_memory_avrcp_browsing_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t avrcp_browsing_connection_slab;
+avrcp_browsing_connection_t * btstack_memory_avrcp_browsing_connection_get(void){
+    return (avrcp_browsing_connection_t *) btstack_memory_slab_get(&avrcp_browsing_connection_slab);
+}
+void btstack_memory_avrcp_browsing_connection_free(avrcp_browsing_connection_t *avrcp_browsing_connection){
+    btstack_memory_slab_free(&avrcp_browsing_connection_slab, avrcp_browsing_connection);
+}
+void btstack_memory_avrcp_browsing_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&avrcp_browsing_connection_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t avrcp_browsing_connection_stats;
 avrcp_browsing_connection_t * btstack_memory_avrcp_browsing_connection_get(void){
-    return (avrcp_browsing_connection_t*) malloc(sizeof(avrcp_browsing_connection_t));
+    avrcp_browsing_connection_t * avrcp_browsing_connection = (avrcp_browsing_connection_t*) malloc(sizeof(avrcp_browsing_connection_t));
+    btstack_memory_pool_stats_record_get(&avrcp_browsing_connection_stats, avrcp_browsing_connection);
+    return avrcp_browsing_connection;
 }
 void btstack_memory_avrcp_browsing_connection_free(avrcp_browsing_connection_t *avrcp_browsing_connection){
+    btstack_memory_pool_stats_record_free(&avrcp_browsing_connection_stats);
     free(avrcp_browsing_connection);
 }
+void btstack_memory_avrcp_browsing_connection_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = avrcp_browsing_connection_stats;
+}
 #endif
 
 
@@ -653,6 +1017,9 @@ gatt_client_t * btstack_memory_gatt_client_get(void){
 void btstack_memory_gatt_client_free(gatt_client_t *gatt_client){
     btstack_memory_pool_free(&gatt_client_pool, gatt_client);
 }
+void btstack_memory_gatt_client_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&gatt_client_pool, stats);
+}
 #else
 gatt_client_t * btstack_memory_gatt_client_get(void){
     return NULL;
@@ -661,14 +1028,35 @@ void btstack_memory_gatt_client_free(gatt_client_t *gatt_client){
     // silence compiler warning about unused parameter in a portable way
     (void) gatt_client;
 };
+void btstack_memory_gatt_client_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t gatt_client_slab;
+gatt_client_t * btstack_memory_gatt_client_get(void){
+    return (gatt_client_t *) btstack_memory_slab_get(&gatt_client_slab);
+}
+void btstack_memory_gatt_client_free(gatt_client_t *gatt_client){
+    btstack_memory_slab_free(&gatt_client_slab, gatt_client);
+}
+void btstack_memory_gatt_client_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&gatt_client_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t gatt_client_stats;
 gatt_client_t * btstack_memory_gatt_client_get(void){
-    return (gatt_client_t*) malloc(sizeof(gatt_client_t));
+    gatt_client_t * gatt_client = (gatt_client_t*) malloc(sizeof(gatt_client_t));
+    btstack_memory_pool_stats_record_get(&gatt_client_stats, gatt_client);
+    return gatt_client;
 }
 void btstack_memory_gatt_client_free(gatt_client_t *gatt_client){
+    btstack_memory_pool_stats_record_free(&gatt_client_stats);
     free(gatt_client);
 }
+void btstack_memory_gatt_client_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = gatt_client_stats;
+}
 #endif
 
 
@@ -691,6 +1079,9 @@ whitelist_entry_t * btstack_memory_whitelist_entry_get(void){
 void btstack_memory_whitelist_entry_free(whitelist_entry_t *whitelist_entry){
     btstack_memory_pool_free(&whitelist_entry_pool, whitelist_entry);
 }
+void btstack_memory_whitelist_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&whitelist_entry_pool, stats);
+}
 #else
 whitelist_entry_t * btstack_memory_whitelist_entry_get(void){
     return NULL;
@@ -699,14 +1090,35 @@ void btstack_memory_whitelist_entry_free(whitelist_entry_t *whitelist_entry){
     // silence compiler warning about unused parameter in a portable way
     (void) whitelist_entry;
 };
+void btstack_memory_whitelist_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t whitelist_entry_slab;
+whitelist_entry_t * btstack_memory_whitelist_entry_get(void){
+    return (whitelist_entry_t *) btstack_memory_slab_get(&whitelist_entry_slab);
+}
+void btstack_memory_whitelist_entry_free(whitelist_entry_t *whitelist_entry){
+    btstack_memory_slab_free(&whitelist_entry_slab, whitelist_entry);
+}
+void btstack_memory_whitelist_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&whitelist_entry_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t whitelist_entry_stats;
 whitelist_entry_t * btstack_memory_whitelist_entry_get(void){
-    return (whitelist_entry_t*) malloc(sizeof(whitelist_entry_t));
+    whitelist_entry_t * whitelist_entry = (whitelist_entry_t*) malloc(sizeof(whitelist_entry_t));
+    btstack_memory_pool_stats_record_get(&whitelist_entry_stats, whitelist_entry);
+    return whitelist_entry;
 }
 void btstack_memory_whitelist_entry_free(whitelist_entry_t *whitelist_entry){
+    btstack_memory_pool_stats_record_free(&whitelist_entry_stats);
     free(whitelist_entry);
 }
+void btstack_memory_whitelist_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = whitelist_entry_stats;
+}
 #endif
 
 
@@ -729,6 +1141,9 @@ sm_lookup_entry_t * btstack_memory_sm_lookup_entry_get(void){
 void btstack_memory_sm_lookup_entry_free(sm_lookup_entry_t *sm_lookup_entry){
     btstack_memory_pool_free(&sm_lookup_entry_pool, sm_lookup_entry);
 }
+void btstack_memory_sm_lookup_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&sm_lookup_entry_pool, stats);
+}
 #else
 sm_lookup_entry_t * btstack_memory_sm_lookup_entry_get(void){
     return NULL;
@@ -737,14 +1152,35 @@ void btstack_memory_sm_lookup_entry_free(sm_lookup_entry_t *sm_lookup_entry){
     // silence compiler warning about unused parameter in a portable way
     (void) sm_lookup_entry;
 };
+void btstack_memory_sm_lookup_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t sm_lookup_entry_slab;
+sm_lookup_entry_t * btstack_memory_sm_lookup_entry_get(void){
+    return (sm_lookup_entry_t *) btstack_memory_slab_get(&sm_lookup_entry_slab);
+}
+void btstack_memory_sm_lookup_entry_free(sm_lookup_entry_t *sm_lookup_entry){
+    btstack_memory_slab_free(&sm_lookup_entry_slab, sm_lookup_entry);
+}
+void btstack_memory_sm_lookup_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&sm_lookup_entry_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t sm_lookup_entry_stats;
 sm_lookup_entry_t * btstack_memory_sm_lookup_entry_get(void){
-    return (sm_lookup_entry_t*) malloc(sizeof(sm_lookup_entry_t));
+    sm_lookup_entry_t * sm_lookup_entry = (sm_lookup_entry_t*) malloc(sizeof(sm_lookup_entry_t));
+    btstack_memory_pool_stats_record_get(&sm_lookup_entry_stats, sm_lookup_entry);
+    return sm_lookup_entry;
 }
 void btstack_memory_sm_lookup_entry_free(sm_lookup_entry_t *sm_lookup_entry){
+    btstack_memory_pool_stats_record_free(&sm_lookup_entry_stats);
     free(sm_lookup_entry);
 }
+void btstack_memory_sm_lookup_entry_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = sm_lookup_entry_stats;
+}
 #endif
 
 
@@ -753,58 +1189,197 @@ void btstack_memory_sm_lookup_entry_free(sm_lookup_entry_t *sm_lookup_entry){
 void btstack_memory_init(void){
 #if MAX_NR_HCI_CONNECTIONS > 0
     btstack_memory_pool_create(&hci_connection_pool, hci_connection_storage, MAX_NR_HCI_CONNECTIONS, sizeof(hci_connection_t));
+#elif !defined(MAX_NR_HCI_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&hci_connection_slab, sizeof(hci_connection_t));
 #endif
 #if MAX_NR_L2CAP_SERVICES > 0
     btstack_memory_pool_create(&l2cap_service_pool, l2cap_service_storage, MAX_NR_L2CAP_SERVICES, sizeof(l2cap_service_t));
+#elif !defined(MAX_NR_L2CAP_SERVICES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&l2cap_service_slab, sizeof(l2cap_service_t));
 #endif
 #if MAX_NR_L2CAP_CHANNELS > 0
     btstack_memory_pool_create(&l2cap_channel_pool, l2cap_channel_storage, MAX_NR_L2CAP_CHANNELS, sizeof(l2cap_channel_t));
+#elif !defined(MAX_NR_L2CAP_CHANNELS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&l2cap_channel_slab, sizeof(l2cap_channel_t));
 #endif
 #if MAX_NR_RFCOMM_MULTIPLEXERS > 0
     btstack_memory_pool_create(&rfcomm_multiplexer_pool, rfcomm_multiplexer_storage, MAX_NR_RFCOMM_MULTIPLEXERS, sizeof(rfcomm_multiplexer_t));
+#elif !defined(MAX_NR_RFCOMM_MULTIPLEXERS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&rfcomm_multiplexer_slab, sizeof(rfcomm_multiplexer_t));
 #endif
 #if MAX_NR_RFCOMM_SERVICES > 0
     btstack_memory_pool_create(&rfcomm_service_pool, rfcomm_service_storage, MAX_NR_RFCOMM_SERVICES, sizeof(rfcomm_service_t));
+#elif !defined(MAX_NR_RFCOMM_SERVICES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&rfcomm_service_slab, sizeof(rfcomm_service_t));
 #endif
 #if MAX_NR_RFCOMM_CHANNELS > 0
     btstack_memory_pool_create(&rfcomm_channel_pool, rfcomm_channel_storage, MAX_NR_RFCOMM_CHANNELS, sizeof(rfcomm_channel_t));
+#elif !defined(MAX_NR_RFCOMM_CHANNELS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&rfcomm_channel_slab, sizeof(rfcomm_channel_t));
 #endif
 #if MAX_NR_BTSTACK_LINK_KEY_DB_MEMORY_ENTRIES > 0
     btstack_memory_pool_create(&btstack_link_key_db_memory_entry_pool, btstack_link_key_db_memory_entry_storage, MAX_NR_BTSTACK_LINK_KEY_DB_MEMORY_ENTRIES, sizeof(btstack_link_key_db_memory_entry_t));
+#elif !defined(MAX_NR_BTSTACK_LINK_KEY_DB_MEMORY_ENTRIES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&btstack_link_key_db_memory_entry_slab, sizeof(btstack_link_key_db_memory_entry_t));
 #endif
 #if MAX_NR_BNEP_SERVICES > 0
     btstack_memory_pool_create(&bnep_service_pool, bnep_service_storage, MAX_NR_BNEP_SERVICES, sizeof(bnep_service_t));
+#elif !defined(MAX_NR_BNEP_SERVICES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&bnep_service_slab, sizeof(bnep_service_t));
 #endif
 #if MAX_NR_BNEP_CHANNELS > 0
     btstack_memory_pool_create(&bnep_channel_pool, bnep_channel_storage, MAX_NR_BNEP_CHANNELS, sizeof(bnep_channel_t));
+#elif !defined(MAX_NR_BNEP_CHANNELS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&bnep_channel_slab, sizeof(bnep_channel_t));
 #endif
 #if MAX_NR_HFP_CONNECTIONS > 0
     btstack_memory_pool_create(&hfp_connection_pool, hfp_connection_storage, MAX_NR_HFP_CONNECTIONS, sizeof(hfp_connection_t));
+#elif !defined(MAX_NR_HFP_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&hfp_connection_slab, sizeof(hfp_connection_t));
 #endif
 #if MAX_NR_SERVICE_RECORD_ITEMS > 0
     btstack_memory_pool_create(&service_record_item_pool, service_record_item_storage, MAX_NR_SERVICE_RECORD_ITEMS, sizeof(service_record_item_t));
+#elif !defined(MAX_NR_SERVICE_RECORD_ITEMS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&service_record_item_slab, sizeof(service_record_item_t));
 #endif
 #if MAX_NR_AVDTP_STREAM_ENDPOINTS > 0
     btstack_memory_pool_create(&avdtp_stream_endpoint_pool, avdtp_stream_endpoint_storage, MAX_NR_AVDTP_STREAM_ENDPOINTS, sizeof(avdtp_stream_endpoint_t));
+#elif !defined(MAX_NR_AVDTP_STREAM_ENDPOINTS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&avdtp_stream_endpoint_slab, sizeof(avdtp_stream_endpoint_t));
 #endif
 #if MAX_NR_AVDTP_CONNECTIONS > 0
     btstack_memory_pool_create(&avdtp_connection_pool, avdtp_connection_storage, MAX_NR_AVDTP_CONNECTIONS, sizeof(avdtp_connection_t));
+#elif !defined(MAX_NR_AVDTP_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&avdtp_connection_slab, sizeof(avdtp_connection_t));
 #endif
 #if MAX_NR_AVRCP_CONNECTIONS > 0
     btstack_memory_pool_create(&avrcp_connection_pool, avrcp_connection_storage, MAX_NR_AVRCP_CONNECTIONS, sizeof(avrcp_connection_t));
+#elif !defined(MAX_NR_AVRCP_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&avrcp_connection_slab, sizeof(avrcp_connection_t));
 #endif
 #if MAX_NR_AVRCP_BROWSING_CONNECTIONS > 0
     btstack_memory_pool_create(&avrcp_browsing_connection_pool, avrcp_browsing_connection_storage, MAX_NR_AVRCP_BROWSING_CONNECTIONS, sizeof(avrcp_browsing_connection_t));
+#elif !defined(MAX_NR_AVRCP_BROWSING_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&avrcp_browsing_connection_slab, sizeof(avrcp_browsing_connection_t));
 #endif
 #ifdef ENABLE_BLE
 #if MAX_NR_GATT_CLIENTS > 0
     btstack_memory_pool_create(&gatt_client_pool, gatt_client_storage, MAX_NR_GATT_CLIENTS, sizeof(gatt_client_t));
+#elif !defined(MAX_NR_GATT_CLIENTS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&gatt_client_slab, sizeof(gatt_client_t));
 #endif
 #if MAX_NR_WHITELIST_ENTRIES > 0
     btstack_memory_pool_create(&whitelist_entry_pool, whitelist_entry_storage, MAX_NR_WHITELIST_ENTRIES, sizeof(whitelist_entry_t));
+#elif !defined(MAX_NR_WHITELIST_ENTRIES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&whitelist_entry_slab, sizeof(whitelist_entry_t));
 #endif
 #if MAX_NR_SM_LOOKUP_ENTRIES > 0
     btstack_memory_pool_create(&sm_lookup_entry_pool, sm_lookup_entry_storage, MAX_NR_SM_LOOKUP_ENTRIES, sizeof(sm_lookup_entry_t));
+#elif !defined(MAX_NR_SM_LOOKUP_ENTRIES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&sm_lookup_entry_slab, sizeof(sm_lookup_entry_t));
 #endif
 #endif
 }
+
+// deinit
+void btstack_memory_deinit(void){
+#if !defined(MAX_NR_HCI_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&hci_connection_slab);
+#endif
+#if !defined(MAX_NR_L2CAP_SERVICES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&l2cap_service_slab);
+#endif
+#if !defined(MAX_NR_L2CAP_CHANNELS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&l2cap_channel_slab);
+#endif
+#if !defined(MAX_NR_RFCOMM_MULTIPLEXERS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&rfcomm_multiplexer_slab);
+#endif
+#if !defined(MAX_NR_RFCOMM_SERVICES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&rfcomm_service_slab);
+#endif
+#if !defined(MAX_NR_RFCOMM_CHANNELS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&rfcomm_channel_slab);
+#endif
+#if !defined(MAX_NR_BTSTACK_LINK_KEY_DB_MEMORY_ENTRIES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&btstack_link_key_db_memory_entry_slab);
+#endif
+#if !defined(MAX_NR_BNEP_SERVICES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&bnep_service_slab);
+#endif
+#if !defined(MAX_NR_BNEP_CHANNELS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&bnep_channel_slab);
+#endif
+#if !defined(MAX_NR_HFP_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&hfp_connection_slab);
+#endif
+#if !defined(MAX_NR_SERVICE_RECORD_ITEMS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&service_record_item_slab);
+#endif
+#if !defined(MAX_NR_AVDTP_STREAM_ENDPOINTS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&avdtp_stream_endpoint_slab);
+#endif
+#if !defined(MAX_NR_AVDTP_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&avdtp_connection_slab);
+#endif
+#if !defined(MAX_NR_AVRCP_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&avrcp_connection_slab);
+#endif
+#if !defined(MAX_NR_AVRCP_BROWSING_CONNECTIONS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&avrcp_browsing_connection_slab);
+#endif
+#ifdef ENABLE_BLE
+#if !defined(MAX_NR_GATT_CLIENTS) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&gatt_client_slab);
+#endif
+#if !defined(MAX_NR_WHITELIST_ENTRIES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&whitelist_entry_slab);
+#endif
+#if !defined(MAX_NR_SM_LOOKUP_ENTRIES) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&sm_lookup_entry_slab);
+#endif
+#endif
+}
+
+// stats
+void btstack_memory_dump_stats(void){
+    btstack_memory_pool_stats_t stats;
+    btstack_memory_hci_connection_get_stats(&stats);
+    btstack_memory_pool_stats_log("hci_connection", &stats);
+    btstack_memory_l2cap_service_get_stats(&stats);
+    btstack_memory_pool_stats_log("l2cap_service", &stats);
+    btstack_memory_l2cap_channel_get_stats(&stats);
+    btstack_memory_pool_stats_log("l2cap_channel", &stats);
+    btstack_memory_rfcomm_multiplexer_get_stats(&stats);
+    btstack_memory_pool_stats_log("rfcomm_multiplexer", &stats);
+    btstack_memory_rfcomm_service_get_stats(&stats);
+    btstack_memory_pool_stats_log("rfcomm_service", &stats);
+    btstack_memory_rfcomm_channel_get_stats(&stats);
+    btstack_memory_pool_stats_log("rfcomm_channel", &stats);
+    btstack_memory_btstack_link_key_db_memory_entry_get_stats(&stats);
+    btstack_memory_pool_stats_log("btstack_link_key_db_memory_entry", &stats);
+    btstack_memory_bnep_service_get_stats(&stats);
+    btstack_memory_pool_stats_log("bnep_service", &stats);
+    btstack_memory_bnep_channel_get_stats(&stats);
+    btstack_memory_pool_stats_log("bnep_channel", &stats);
+    btstack_memory_hfp_connection_get_stats(&stats);
+    btstack_memory_pool_stats_log("hfp_connection", &stats);
+    btstack_memory_service_record_item_get_stats(&stats);
+    btstack_memory_pool_stats_log("service_record_item", &stats);
+    btstack_memory_avdtp_stream_endpoint_get_stats(&stats);
+    btstack_memory_pool_stats_log("avdtp_stream_endpoint", &stats);
+    btstack_memory_avdtp_connection_get_stats(&stats);
+    btstack_memory_pool_stats_log("avdtp_connection", &stats);
+    btstack_memory_avrcp_connection_get_stats(&stats);
+    btstack_memory_pool_stats_log("avrcp_connection", &stats);
+    btstack_memory_avrcp_browsing_connection_get_stats(&stats);
+    btstack_memory_pool_stats_log("avrcp_browsing_connection", &stats);
+#ifdef ENABLE_BLE
+    btstack_memory_gatt_client_get_stats(&stats);
+    btstack_memory_pool_stats_log("gatt_client", &stats);
+    btstack_memory_whitelist_entry_get_stats(&stats);
+    btstack_memory_pool_stats_log("whitelist_entry", &stats);
+    btstack_memory_sm_lookup_entry_get_stats(&stats);
+    btstack_memory_pool_stats_log("sm_lookup_entry", &stats);
+#endif
+}
@@ -42,7 +42,7 @@
  *
  *  Fixed-size block allocation
  *
- *  Free blocks are kept in singly linked list
+ *  Free blocks are kept in singly linked list, get and free are O(1)
  *
  */
 
@@ -55,45 +55,121 @@ typedef struct node {
     struct node * next;
 } node_t;
 
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+// @returns block index or -1 if block not tracked by occupancy bitmap
+static int btstack_memory_pool_block_index(btstack_memory_pool_t *pool, void * block){
+    int offset = (int) ((uint8_t *) block - pool->storage);
+    if (offset < 0) return -1;
+    if (offset % pool->block_size) return -1;
+    int index = offset / pool->block_size;
+    if (index >= pool->stats.count) return -1;
+    if (index >= MAX_NR_MEMORY_POOL_DEBUG_BLOCKS) return -1;
+    return index;
+}
+#endif
+
 void btstack_memory_pool_create(btstack_memory_pool_t *pool, void * storage, int count, int block_size){
-    node_t *free_blocks = (node_t*) pool;
     char   *mem_ptr = (char *) storage;
     int i;
-    
-    // create singly linked list of all available blocks
-    free_blocks->next = NULL;
+
+    pool->stats.count      = count;
+    pool->stats.in_use     = 0;
+    pool->stats.max_in_use = 0;
+    pool->stats.failed     = 0;
+
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+    pool->storage    = (uint8_t *) storage;
+    pool->block_size = block_size;
+    for (i = 0; i < (int) sizeof(pool->occupancy); i++){
+        pool->occupancy[i] = 0;
+    }
+    if (count > MAX_NR_MEMORY_POOL_DEBUG_BLOCKS){
+        log_error("btstack_memory_pool_create: only %u of %u blocks tracked for pool %p", MAX_NR_MEMORY_POOL_DEBUG_BLOCKS, count, pool);
+    }
+#endif
+
+    // create singly linked list of all available blocks, first block at head
+    pool->free_list = NULL;
+    mem_ptr += count * block_size;
     for (i = 0 ; i < count ; i++){
-        btstack_memory_pool_free(pool, mem_ptr);
-        mem_ptr += block_size;
+        mem_ptr -= block_size;
+        node_t * node = (node_t *) mem_ptr;
+        node->next = (node_t *) pool->free_list;
+        pool->free_list = node;
     }
 }
 
 void * btstack_memory_pool_get(btstack_memory_pool_t *pool){
-    node_t *free_blocks = (node_t*) pool;
-    
-    if (!free_blocks->next) return NULL;
-    
+    node_t * node = (node_t *) pool->free_list;
+
+    if (!node) {
+        pool->stats.failed++;
+        return NULL;
+    }
+
     // remove first
-    node_t *node      = free_blocks->next;
-    free_blocks->next = node->next;
-    
+    pool->free_list = node->next;
+
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.max_in_use){
+        pool->stats.max_in_use = pool->stats.in_use;
+    }
+
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+    int index = btstack_memory_pool_block_index(pool, node);
+    if (index >= 0){
+        pool->occupancy[index >> 3] |= 1 << (index & 7);
+    }
+#endif
+
     return (void*) node;
 }
 
 void btstack_memory_pool_free(btstack_memory_pool_t *pool, void * block){
-    node_t *free_blocks = (node_t*) pool;
-    node_t *node        = (node_t*) block;
+    node_t *node = (node_t*) block;
 
-    // raise error and abort if node already in list
-    node_t * it;
-    for (it = free_blocks->next; it ; it = it->next){
-        if (it == node) {
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+    // raise error and abort if block not handed out by this pool
+    int index = btstack_memory_pool_block_index(pool, block);
+    if (index >= 0){
+        if ((pool->occupancy[index >> 3] & (1 << (index & 7))) == 0){
             log_error("btstack_memory_pool_free: block %p freed twice for pool %p", block, pool);
             return;
         }
+        pool->occupancy[index >> 3] &= ~(1 << (index & 7));
+    } else if (((uint8_t *) block < pool->storage) || ((uint8_t *) block >= pool->storage + pool->stats.count * pool->block_size)){
+        log_error("btstack_memory_pool_free: block %p not part of pool %p", block, pool);
+        return;
     }
+#endif
 
     // add block as node to list
-    node->next          = free_blocks->next;
-    free_blocks->next   = node;
+    node->next      = (node_t *) pool->free_list;
+    pool->free_list = node;
+
+    pool->stats.in_use--;
+}
+
+void btstack_memory_pool_get_stats(btstack_memory_pool_t *pool, btstack_memory_pool_stats_t * stats){
+    *stats = pool->stats;
+}
+
+void btstack_memory_pool_stats_record_get(btstack_memory_pool_stats_t * stats, void * block){
+    if (!block) {
+        stats->failed++;
+        return;
+    }
+    stats->in_use++;
+    if (stats->in_use > stats->max_in_use){
+        stats->max_in_use = stats->in_use;
+    }
+}
+
+void btstack_memory_pool_stats_record_free(btstack_memory_pool_stats_t * stats){
+    stats->in_use--;
+}
+
+void btstack_memory_pool_stats_log(const char * name, const btstack_memory_pool_stats_t * stats){
+    log_info("memory pool %-32s in use %3u, max %3u, count %3u, failed %u", name,
+        stats->in_use, stats->max_in_use, stats->count, stats->failed);
 }
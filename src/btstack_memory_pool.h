@@ -43,7 +43,8 @@
  *  @Assumption block_size >= sizeof(void *)
  *  @Assumption size of storage >= count * block_size
  *
- *  @Note minimal implementation, no error checking/handling
+ *  @Note get and free are O(1). Double free detection via per-pool occupancy
+ *        bitmap is only available with ENABLE_MEMORY_POOL_DEBUG
  */
 
 #ifndef __btstack_memory_pool_H
@@ -53,7 +54,32 @@
 extern "C" {
 #endif
 
-typedef void * btstack_memory_pool_t;
+#include <stdint.h>
+#include "btstack_config.h"
+
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+// number of blocks per pool tracked by occupancy bitmap
+#ifndef MAX_NR_MEMORY_POOL_DEBUG_BLOCKS
+#define MAX_NR_MEMORY_POOL_DEBUG_BLOCKS 128
+#endif
+#endif
+
+typedef struct {
+    uint16_t count;         // number of blocks, 0 if not bounded (malloc)
+    uint16_t in_use;        // blocks currently handed out
+    uint16_t max_in_use;    // high-water mark
+    uint16_t failed;        // get requests that could not be served
+} btstack_memory_pool_stats_t;
+
+typedef struct {
+    void * free_list;
+    btstack_memory_pool_stats_t stats;
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+    uint8_t * storage;
+    uint16_t  block_size;
+    uint8_t   occupancy[(MAX_NR_MEMORY_POOL_DEBUG_BLOCKS + 7) / 8];
+#endif
+} btstack_memory_pool_t;
 
 // initialize memory pool with with given storage, block size and count
 void   btstack_memory_pool_create(btstack_memory_pool_t *pool, void * storage, int count, int block_size);
@@ -64,6 +90,16 @@ void * btstack_memory_pool_get(btstack_memory_pool_t *pool);
 // return previously reserved block to memory pool
 void   btstack_memory_pool_free(btstack_memory_pool_t *pool, void * block);
 
+// get current usage statistics of memory pool
+void   btstack_memory_pool_get_stats(btstack_memory_pool_t *pool, btstack_memory_pool_stats_t * stats);
+
+// update statistics for allocators not backed by a memory pool, e.g. malloc
+void   btstack_memory_pool_stats_record_get(btstack_memory_pool_stats_t * stats, void * block);
+void   btstack_memory_pool_stats_record_free(btstack_memory_pool_stats_t * stats);
+
+// log statistics via log_info
+void   btstack_memory_pool_stats_log(const char * name, const btstack_memory_pool_stats_t * stats);
+
 #if defined __cplusplus
 }
 #endif
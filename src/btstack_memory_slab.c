@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_memory_slab.c"
+
+/*
+ *  btstack_memory_slab.c
+ *
+ *  Chunks are kept in singly linked list, first block starts at the first aligned address
+ *  after the chunk header. Free blocks of all chunks are kept in singly linked list.
+ *
+ */
+
+#include "btstack_memory_slab.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "btstack_debug.h"
+
+typedef struct node {
+    struct node * next;
+} node_t;
+
+void btstack_memory_slab_init(btstack_memory_slab_t * slab, uint32_t object_size){
+    uint32_t block_size = (object_size + MEMORY_SLAB_ALIGNMENT - 1) & ~(MEMORY_SLAB_ALIGNMENT - 1);
+    if (block_size < sizeof(node_t)){
+        block_size = MEMORY_SLAB_ALIGNMENT;
+    }
+    slab->chunks           = NULL;
+    slab->free_list        = NULL;
+    slab->block_size       = block_size;
+    slab->blocks_per_chunk = MEMORY_SLAB_CHUNK_SIZE / block_size;
+    if (slab->blocks_per_chunk == 0){
+        slab->blocks_per_chunk = 1;
+    }
+    slab->stats.count      = 0;
+    slab->stats.in_use     = 0;
+    slab->stats.max_in_use = 0;
+    slab->stats.failed     = 0;
+}
+
+static int btstack_memory_slab_add_chunk(btstack_memory_slab_t * slab){
+    uint32_t size = sizeof(node_t) + MEMORY_SLAB_ALIGNMENT - 1 + slab->blocks_per_chunk * slab->block_size;
+    node_t * chunk = (node_t *) malloc(size);
+    if (!chunk) return 0;
+
+    chunk->next  = (node_t *) slab->chunks;
+    slab->chunks = chunk;
+
+    // add blocks to free list in address order
+    uintptr_t first = ((uintptr_t) (chunk + 1) + MEMORY_SLAB_ALIGNMENT - 1) & ~((uintptr_t) MEMORY_SLAB_ALIGNMENT - 1);
+    uint8_t * mem_ptr = (uint8_t *) first + slab->blocks_per_chunk * slab->block_size;
+    int i;
+    for (i = 0; i < slab->blocks_per_chunk; i++){
+        mem_ptr -= slab->block_size;
+        node_t * node = (node_t *) mem_ptr;
+        node->next = (node_t *) slab->free_list;
+        slab->free_list = node;
+    }
+    slab->stats.count += slab->blocks_per_chunk;
+    return 1;
+}
+
+void * btstack_memory_slab_get(btstack_memory_slab_t * slab){
+    if (!slab->free_list && !btstack_memory_slab_add_chunk(slab)){
+        log_error("btstack_memory_slab_get: out of memory for block size %u", (unsigned int) slab->block_size);
+        slab->stats.failed++;
+        return NULL;
+    }
+
+    node_t * node   = (node_t *) slab->free_list;
+    slab->free_list = node->next;
+
+    slab->stats.in_use++;
+    if (slab->stats.in_use > slab->stats.max_in_use){
+        slab->stats.max_in_use = slab->stats.in_use;
+    }
+    return (void *) node;
+}
+
+void btstack_memory_slab_free(btstack_memory_slab_t * slab, void * block){
+    node_t * node   = (node_t *) block;
+    node->next      = (node_t *) slab->free_list;
+    slab->free_list = node;
+    slab->stats.in_use--;
+}
+
+void btstack_memory_slab_release(btstack_memory_slab_t * slab){
+    node_t * chunk = (node_t *) slab->chunks;
+    while (chunk){
+        node_t * next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    slab->chunks       = NULL;
+    slab->free_list    = NULL;
+    slab->stats.count  = 0;
+    slab->stats.in_use = 0;
+}
+
+void btstack_memory_slab_get_stats(btstack_memory_slab_t * slab, btstack_memory_pool_stats_t * stats){
+    *stats = slab->stats;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_memory_slab.h
+ *
+ *  @brief Fixed-size block allocation from malloc'ed chunks
+ *
+ *  Block size is rounded up to MEMORY_SLAB_ALIGNMENT and blocks are cache line aligned.
+ *  Chunks of about MEMORY_SLAB_CHUNK_SIZE bytes are allocated when the free list is empty
+ *  and only returned to the heap by btstack_memory_slab_release.
+ *
+ */
+
+#ifndef __BTSTACK_MEMORY_SLAB_H
+#define __BTSTACK_MEMORY_SLAB_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "btstack_config.h"
+#include "btstack_memory_pool.h"
+
+// alignment and size granularity of blocks
+#ifndef MEMORY_SLAB_ALIGNMENT
+#define MEMORY_SLAB_ALIGNMENT 64
+#endif
+
+// target size of a chunk, a chunk holds at least one block
+#ifndef MEMORY_SLAB_CHUNK_SIZE
+#define MEMORY_SLAB_CHUNK_SIZE 4096
+#endif
+
+typedef struct {
+    void *   chunks;
+    void *   free_list;
+    uint32_t block_size;
+    uint16_t blocks_per_chunk;
+    btstack_memory_pool_stats_t stats;
+} btstack_memory_slab_t;
+
+/* API_START */
+
+/**
+ * @brief Init slab for objects of given size. No memory is allocated until first get
+ * @param slab
+ * @param object_size
+ */
+void   btstack_memory_slab_init(btstack_memory_slab_t * slab, uint32_t object_size);
+
+/**
+ * @brief Get block from slab, allocates new chunk if needed
+ * @param slab
+ * @returns block or NULL if out of memory
+ */
+void * btstack_memory_slab_get(btstack_memory_slab_t * slab);
+
+/**
+ * @brief Return block to slab
+ * @param slab
+ * @param block
+ */
+void   btstack_memory_slab_free(btstack_memory_slab_t * slab, void * block);
+
+/**
+ * @brief Free all chunks of slab, invalidates all blocks handed out
+ * @param slab
+ */
+void   btstack_memory_slab_release(btstack_memory_slab_t * slab);
+
+/**
+ * @brief Get usage statistics, count is the number of blocks in allocated chunks
+ * @param slab
+ * @param stats
+ */
+void   btstack_memory_slab_get_stats(btstack_memory_slab_t * slab, btstack_memory_pool_stats_t * stats);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __BTSTACK_MEMORY_SLAB_H
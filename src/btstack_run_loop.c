@@ -173,6 +173,15 @@ void btstack_run_loop_timer_dump(void){
     the_run_loop->dump_timer();
 }
 
+void btstack_run_loop_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    btstack_run_loop_assert();
+    if (the_run_loop->execute_on_main_thread){
+        the_run_loop->execute_on_main_thread(callback_registration);
+    } else {
+        log_error("btstack_run_loop_execute_on_main_thread not implemented");
+    }
+}
+
 /**
  * Execute run_loop
  */
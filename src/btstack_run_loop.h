@@ -46,6 +46,7 @@
 
 #include "btstack_config.h"
 
+#include "btstack_defines.h"
 #include "btstack_linked_list.h"
 
 #include <stdint.h>
@@ -105,6 +106,8 @@ typedef struct btstack_run_loop {
 	void (*execute)(void);
 	void (*dump_timer)(void);
 	uint32_t (*get_time_ms)(void);
+	// optional, thread-safe
+	void (*execute_on_main_thread)(btstack_context_callback_registration_t * callback_registration);
 } btstack_run_loop_t;
 
 void btstack_run_loop_timer_dump(void);
@@ -199,6 +202,14 @@ void btstack_run_loop_add_data_source(btstack_data_source_t * data_source);
  */
 int btstack_run_loop_remove_data_source(btstack_data_source_t * data_source);
 
+/**
+ * @brief Execute callback from run loop thread. Can be called from any thread.
+ *        The run loop is woken up immediately and calls callback_registration->callback(context).
+ * @param callback_registration must stay valid and must not be posted again until its callback was called
+ * @note Supported by POSIX, Windows and FreeRTOS run loops
+ */
+void btstack_run_loop_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration);
+
 /**
  * @brief Execute configured run loop. This function does not return.
  */
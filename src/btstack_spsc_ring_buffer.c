@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_spsc_ring_buffer.c"
+
+/*
+ *  btstack_spsc_ring_buffer.c
+ *
+ */
+
+#include <string.h>
+
+#include "btstack_spsc_ring_buffer.h"
+
+// producer publishes written data with release store of write index, consumer returns space with
+// release store of read index. Without C11 atomics, GCC builtins or volatile accesses are used,
+// the latter is only safe on single core MCUs where it is used between ISR and main loop
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define INDEX_LOAD_RELAXED(index)         atomic_load_explicit((_Atomic uint32_t *) &(index), memory_order_relaxed)
+#define INDEX_LOAD_ACQUIRE(index)         atomic_load_explicit((_Atomic uint32_t *) &(index), memory_order_acquire)
+#define INDEX_STORE_RELEASE(index, value) atomic_store_explicit((_Atomic uint32_t *) &(index), (value), memory_order_release)
+#elif defined(__GNUC__)
+#define INDEX_LOAD_RELAXED(index)         __atomic_load_n(&(index), __ATOMIC_RELAXED)
+#define INDEX_LOAD_ACQUIRE(index)         __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define INDEX_STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#else
+#define INDEX_LOAD_RELAXED(index)         (*(volatile uint32_t *) &(index))
+#define INDEX_LOAD_ACQUIRE(index)         (*(volatile uint32_t *) &(index))
+#define INDEX_STORE_RELEASE(index, value) (*(volatile uint32_t *) &(index) = (value))
+#endif
+
+// local helper, ring buffer doesn't depend on other BTstack modules
+static uint32_t btstack_spsc_ring_buffer_min(uint32_t a, uint32_t b){
+    return a < b ? a : b;
+}
+
+static void btstack_spsc_ring_buffer_span(btstack_spsc_ring_buffer_t * ring_buffer, btstack_spsc_ring_buffer_span_t * span, uint32_t index, uint32_t length){
+    uint32_t offset = index & ring_buffer->mask;
+    uint32_t bytes_until_end = ring_buffer->size - offset;
+    span->data[0] = &ring_buffer->storage[offset];
+    span->len[0]  = btstack_spsc_ring_buffer_min(length, bytes_until_end);
+    span->data[1] = ring_buffer->storage;
+    span->len[1]  = length - span->len[0];
+}
+
+uint32_t btstack_spsc_ring_buffer_init(btstack_spsc_ring_buffer_t * ring_buffer, uint8_t * storage, uint32_t storage_size){
+    uint32_t size = 0;
+    if (storage_size){
+        size = 1;
+        while (size <= storage_size / 2){
+            size <<= 1;
+        }
+    }
+    ring_buffer->storage = storage;
+    ring_buffer->size = size;
+    ring_buffer->mask = size ? size - 1 : 0;
+    btstack_spsc_ring_buffer_reset(ring_buffer);
+    return size;
+}
+
+void btstack_spsc_ring_buffer_reset(btstack_spsc_ring_buffer_t * ring_buffer){
+    INDEX_STORE_RELEASE(ring_buffer->write_index, 0);
+    INDEX_STORE_RELEASE(ring_buffer->read_index, 0);
+}
+
+uint32_t btstack_spsc_ring_buffer_bytes_available(btstack_spsc_ring_buffer_t * ring_buffer){
+    uint32_t read_index  = INDEX_LOAD_ACQUIRE(ring_buffer->read_index);
+    uint32_t write_index = INDEX_LOAD_ACQUIRE(ring_buffer->write_index);
+    return write_index - read_index;
+}
+
+uint32_t btstack_spsc_ring_buffer_bytes_free(btstack_spsc_ring_buffer_t * ring_buffer){
+    return ring_buffer->size - btstack_spsc_ring_buffer_bytes_available(ring_buffer);
+}
+
+uint32_t btstack_spsc_ring_buffer_reserve(btstack_spsc_ring_buffer_t * ring_buffer, btstack_spsc_ring_buffer_span_t * span, uint32_t max_length){
+    uint32_t write_index = INDEX_LOAD_RELAXED(ring_buffer->write_index);
+    uint32_t read_index  = INDEX_LOAD_ACQUIRE(ring_buffer->read_index);
+    uint32_t length = btstack_spsc_ring_buffer_min(max_length, ring_buffer->size - (write_index - read_index));
+    btstack_spsc_ring_buffer_span(ring_buffer, span, write_index, length);
+    return length;
+}
+
+void btstack_spsc_ring_buffer_commit(btstack_spsc_ring_buffer_t * ring_buffer, uint32_t length){
+    uint32_t write_index = INDEX_LOAD_RELAXED(ring_buffer->write_index);
+    INDEX_STORE_RELEASE(ring_buffer->write_index, write_index + length);
+}
+
+uint32_t btstack_spsc_ring_buffer_peek(btstack_spsc_ring_buffer_t * ring_buffer, btstack_spsc_ring_buffer_span_t * span, uint32_t max_length){
+    uint32_t read_index  = INDEX_LOAD_RELAXED(ring_buffer->read_index);
+    uint32_t write_index = INDEX_LOAD_ACQUIRE(ring_buffer->write_index);
+    uint32_t length = btstack_spsc_ring_buffer_min(max_length, write_index - read_index);
+    btstack_spsc_ring_buffer_span(ring_buffer, span, read_index, length);
+    return length;
+}
+
+void btstack_spsc_ring_buffer_consume(btstack_spsc_ring_buffer_t * ring_buffer, uint32_t length){
+    uint32_t read_index = INDEX_LOAD_RELAXED(ring_buffer->read_index);
+    INDEX_STORE_RELEASE(ring_buffer->read_index, read_index + length);
+}
+
+uint32_t btstack_spsc_ring_buffer_write(btstack_spsc_ring_buffer_t * ring_buffer, const uint8_t * data, uint32_t data_length){
+    btstack_spsc_ring_buffer_span_t span;
+    uint32_t length = btstack_spsc_ring_buffer_reserve(ring_buffer, &span, data_length);
+    memcpy(span.data[0], data, span.len[0]);
+    memcpy(span.data[1], data + span.len[0], span.len[1]);
+    btstack_spsc_ring_buffer_commit(ring_buffer, length);
+    return length;
+}
+
+uint32_t btstack_spsc_ring_buffer_read(btstack_spsc_ring_buffer_t * ring_buffer, uint8_t * buffer, uint32_t length){
+    btstack_spsc_ring_buffer_span_t span;
+    length = btstack_spsc_ring_buffer_peek(ring_buffer, &span, length);
+    memcpy(buffer, span.data[0], span.len[0]);
+    memcpy(buffer + span.len[0], span.data[1], span.len[1]);
+    btstack_spsc_ring_buffer_consume(ring_buffer, length);
+    return length;
+}
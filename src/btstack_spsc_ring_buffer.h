@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_spsc_ring_buffer.h
+ *
+ *  Lock-free ring buffer for a single producer and a single consumer, e.g. an audio thread
+ *  and the BTstack run loop. The producer only modifies the write index, the consumer only
+ *  the read index. Both indices run freely and are masked with the power-of-two size.
+ *  Data can be accessed in place via spans, which consist of up to two contiguous regions.
+ */
+
+#ifndef __BTSTACK_SPSC_RING_BUFFER_H
+#define __BTSTACK_SPSC_RING_BUFFER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef struct btstack_spsc_ring_buffer {
+    uint8_t  * storage;
+    uint32_t size;
+    uint32_t mask;
+    // only written by producer, accessed atomically
+    uint32_t write_index;
+    // only written by consumer, accessed atomically
+    uint32_t read_index;
+} btstack_spsc_ring_buffer_t;
+
+typedef struct {
+    uint8_t  * data[2];
+    uint32_t len[2];
+} btstack_spsc_ring_buffer_span_t;
+
+/**
+ * Init ring buffer, not thread-safe
+ * @param ring_buffer object
+ * @param storage
+ * @param storage_size in bytes, rounded down to power of two
+ * @return size of ring buffer
+ */
+uint32_t btstack_spsc_ring_buffer_init(btstack_spsc_ring_buffer_t * ring_buffer, uint8_t * storage, uint32_t storage_size);
+
+/**
+ * Drop all data, not thread-safe
+ * @param ring_buffer object
+ */
+void btstack_spsc_ring_buffer_reset(btstack_spsc_ring_buffer_t * ring_buffer);
+
+/**
+ * Get number of bytes available for read. Exact for consumer, lower bound for producer
+ * @param ring_buffer object
+ * @return number of bytes available for read
+ */
+uint32_t btstack_spsc_ring_buffer_bytes_available(btstack_spsc_ring_buffer_t * ring_buffer);
+
+/**
+ * Get free space available for write. Exact for producer, lower bound for consumer
+ * @param ring_buffer object
+ * @return number of bytes available for write
+ */
+uint32_t btstack_spsc_ring_buffer_bytes_free(btstack_spsc_ring_buffer_t * ring_buffer);
+
+/**
+ * Producer: get free space to write into in place
+ * @param ring_buffer object
+ * @param span filled with up to two regions
+ * @param max_length
+ * @return total length of span, at most max_length
+ */
+uint32_t btstack_spsc_ring_buffer_reserve(btstack_spsc_ring_buffer_t * ring_buffer, btstack_spsc_ring_buffer_span_t * span, uint32_t max_length);
+
+/**
+ * Producer: make data written into reserved span available to consumer
+ * @param ring_buffer object
+ * @param length not larger than reserved span
+ */
+void btstack_spsc_ring_buffer_commit(btstack_spsc_ring_buffer_t * ring_buffer, uint32_t length);
+
+/**
+ * Consumer: get data to read in place
+ * @param ring_buffer object
+ * @param span filled with up to two regions
+ * @param max_length
+ * @return total length of span, at most max_length
+ */
+uint32_t btstack_spsc_ring_buffer_peek(btstack_spsc_ring_buffer_t * ring_buffer, btstack_spsc_ring_buffer_span_t * span, uint32_t max_length);
+
+/**
+ * Consumer: release data that has been read from peeked span
+ * @param ring_buffer object
+ * @param length not larger than peeked span
+ */
+void btstack_spsc_ring_buffer_consume(btstack_spsc_ring_buffer_t * ring_buffer, uint32_t length);
+
+/**
+ * Producer: copy data into ring buffer
+ * @param ring_buffer object
+ * @param data to store
+ * @param data_length
+ * @return number of bytes written, less than data_length if not enough space in buffer
+ */
+uint32_t btstack_spsc_ring_buffer_write(btstack_spsc_ring_buffer_t * ring_buffer, const uint8_t * data, uint32_t data_length);
+
+/**
+ * Consumer: copy data from ring buffer
+ * @param ring_buffer object
+ * @param buffer to store read data
+ * @param length to read
+ * @return number of bytes read
+ */
+uint32_t btstack_spsc_ring_buffer_read(btstack_spsc_ring_buffer_t * ring_buffer, uint8_t * buffer, uint32_t length);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __BTSTACK_SPSC_RING_BUFFER_H
@@ -0,0 +1,429 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "a2dp_sink_media_engine.c"
+
+/*
+ * a2dp_sink_media_engine.c
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+#include "btstack_util.h"
+#include "classic/a2dp_sink_media_engine.h"
+#include "classic/btstack_sbc.h"
+
+#define RTP_HEADER_LEN 12
+#define SBC_SYNCWORD 0x9c
+#define SBC_FRAME_HEADER_LEN 4
+
+#define SBC_CHANNEL_MODE_MONO         0
+#define SBC_CHANNEL_MODE_DUAL_CHANNEL 1
+#define SBC_CHANNEL_MODE_STEREO       2
+#define SBC_CHANNEL_MODE_JOINT_STEREO 3
+
+// target latency = packet duration + JITTER_FACTOR * interarrival jitter
+#define A2DP_SINK_MEDIA_ENGINE_JITTER_FACTOR 4
+
+// drift controller: fill level error is corrected within P_SECONDS, integral term uses I_SECONDS,
+// with I_SECONDS = 4 * P_SECONDS the control loop is critically damped
+#define A2DP_SINK_MEDIA_ENGINE_P_SECONDS  4
+#define A2DP_SINK_MEDIA_ENGINE_I_SECONDS 16
+
+// time constant of fill level low-pass filter
+#define A2DP_SINK_MEDIA_ENGINE_FILL_LEVEL_SECONDS 1
+
+// 2^32 / 1000000
+#define PPM_TO_Q32 4295
+
+static const uint16_t sbc_sample_rates[] = { 16000, 32000, 44100, 48000 };
+
+static uint32_t a2dp_sink_media_engine_samples_for_ms(a2dp_sink_media_engine_t * engine, uint32_t ms){
+    return ms * engine->sample_rate / 1000;
+}
+
+static uint16_t a2dp_sink_media_engine_ms_for_samples(a2dp_sink_media_engine_t * engine, uint32_t samples){
+    if (engine->sample_rate == 0) return 0;
+    return samples * 1000 / engine->sample_rate;
+}
+
+static uint32_t a2dp_sink_media_engine_capacity(a2dp_sink_media_engine_t * engine){
+    return engine->num_frames * engine->samples_per_frame;
+}
+
+static int a2dp_sink_media_engine_sbc_frame_len(const uint8_t * frame, int size){
+    if (size < SBC_FRAME_HEADER_LEN) return 0;
+    if (frame[0] != SBC_SYNCWORD) return 0;
+    int blocks       = 4 * (((frame[1] >> 4) & 0x03) + 1);
+    int channel_mode = (frame[1] >> 2) & 0x03;
+    int subbands     = (frame[1] & 0x01) ? 8 : 4;
+    int bitpool      = frame[2];
+    int num_channels = (channel_mode == SBC_CHANNEL_MODE_MONO) ? 1 : 2;
+    int len = SBC_FRAME_HEADER_LEN + (4 * subbands * num_channels) / 8;
+    switch (channel_mode){
+        case SBC_CHANNEL_MODE_MONO:
+        case SBC_CHANNEL_MODE_DUAL_CHANNEL:
+            len += (blocks * num_channels * bitpool + 7) / 8;
+            break;
+        case SBC_CHANNEL_MODE_STEREO:
+            len += (blocks * bitpool + 7) / 8;
+            break;
+        default:
+            len += (subbands + blocks * bitpool + 7) / 8;
+            break;
+    }
+    return len;
+}
+
+static a2dp_sink_media_engine_frame_t * a2dp_sink_media_engine_frame_for_timestamp(a2dp_sink_media_engine_t * engine, uint32_t timestamp){
+    // round to nearest frame, source might not use exact frame boundaries
+    uint32_t frame_nr = ((uint32_t)(timestamp - engine->base_timestamp) + engine->samples_per_frame / 2) / engine->samples_per_frame;
+    return &engine->frames[frame_nr % engine->num_frames];
+}
+
+static uint32_t a2dp_sink_media_engine_buffered_samples(a2dp_sink_media_engine_t * engine){
+    if (!engine->timestamps_valid) return 0;
+    int32_t buffered = (int32_t)(engine->end_timestamp - engine->play_timestamp);
+    if (buffered < 0) buffered = 0;
+    if (engine->state == A2DP_SINK_MEDIA_ENGINE_PLAYING){
+        // decoded audio not played yet
+        uint32_t index = (uint32_t)(engine->position >> 32);
+        if (index + 1 < engine->pcm_count){
+            buffered += engine->pcm_count - 1 - index;
+        }
+    }
+    return (uint32_t) buffered;
+}
+
+static void a2dp_sink_media_engine_reset_resampler(a2dp_sink_media_engine_t * engine){
+    engine->pcm[0] = 0;
+    engine->pcm[1] = 0;
+    engine->pcm_count = 1;
+    engine->position = 0;
+}
+
+static void a2dp_sink_media_engine_reset_buffer(a2dp_sink_media_engine_t * engine){
+    int i;
+    for (i=0;i<engine->num_frames;i++){
+        engine->frames[i].valid = 0;
+    }
+    engine->timestamps_valid = 0;
+    engine->last_transit_valid = 0;
+    a2dp_sink_media_engine_reset_resampler(engine);
+}
+
+static void a2dp_sink_media_engine_handle_pcm_data(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context){
+    UNUSED(num_channels);
+    UNUSED(sample_rate);
+    a2dp_sink_media_engine_t * engine = (a2dp_sink_media_engine_t *) context;
+    // SBC decoder always provides stereo output, also for mono streams
+    if (engine->pcm_count + num_samples > 1 + A2DP_SINK_MEDIA_ENGINE_MAX_SAMPLES_PER_FRAME){
+        log_error("A2DP Sink Media Engine: decoded %u samples, too many", num_samples);
+        return;
+    }
+    memcpy(&engine->pcm[engine->pcm_count * 2], data, num_samples * 4);
+    engine->pcm_count += num_samples;
+    engine->pcm_decoded = 1;
+}
+
+static void a2dp_sink_media_engine_update_jitter(a2dp_sink_media_engine_t * engine, uint32_t timestamp){
+    // RFC 3550, A.8: arrival time and timestamp in samples
+    uint32_t arrival = (uint32_t)(((uint64_t) btstack_run_loop_get_time_ms() * engine->sample_rate) / 1000);
+    int32_t transit = (int32_t)(arrival - timestamp);
+    if (engine->last_transit_valid){
+        int32_t d = transit - engine->last_transit;
+        if (d < 0) d = -d;
+        engine->jitter_q4 += d - ((engine->jitter_q4 + 8) >> 4);
+    }
+    engine->last_transit = transit;
+    engine->last_transit_valid = 1;
+}
+
+static void a2dp_sink_media_engine_update_target_latency(a2dp_sink_media_engine_t * engine, int num_frames){
+    uint32_t capacity = a2dp_sink_media_engine_capacity(engine);
+    uint32_t max_latency = btstack_min(a2dp_sink_media_engine_samples_for_ms(engine, engine->max_latency_ms), capacity - capacity / 4);
+    uint32_t min_latency = btstack_min(a2dp_sink_media_engine_samples_for_ms(engine, engine->min_latency_ms), max_latency);
+    uint32_t desired = num_frames * engine->samples_per_frame + A2DP_SINK_MEDIA_ENGINE_JITTER_FACTOR * (engine->jitter_q4 >> 4);
+    if (desired < min_latency) desired = min_latency;
+    if (desired > max_latency) desired = max_latency;
+    if (desired > engine->target_latency){
+        // increase immediately
+        engine->target_latency = desired;
+    } else {
+        // decrease slowly
+        engine->target_latency -= (engine->target_latency - desired) / 256;
+        if (engine->target_latency < min_latency){
+            engine->target_latency = min_latency;
+        }
+    }
+}
+
+static void a2dp_sink_media_engine_store_frame(a2dp_sink_media_engine_t * engine, uint32_t timestamp, const uint8_t * data, int len){
+    engine->stats.num_frames_received++;
+    if (len > A2DP_SINK_MEDIA_ENGINE_MAX_SBC_FRAME_SIZE){
+        log_error("A2DP Sink Media Engine: SBC frame size %u > %u", len, A2DP_SINK_MEDIA_ENGINE_MAX_SBC_FRAME_SIZE);
+        engine->stats.num_frames_overflow++;
+        return;
+    }
+
+    int32_t capacity = a2dp_sink_media_engine_capacity(engine);
+    if (engine->timestamps_valid){
+        int32_t delta = (int32_t)(timestamp - engine->play_timestamp);
+        if (delta <= -2 * capacity || delta >= 2 * capacity){
+            log_info("A2DP Sink Media Engine: timestamp jump %d, resync", (int) delta);
+            a2dp_sink_media_engine_reset_buffer(engine);
+            engine->state = A2DP_SINK_MEDIA_ENGINE_PREBUFFERING;
+        } else if (delta < -(int32_t)(engine->samples_per_frame / 2)){
+            engine->stats.num_frames_late++;
+            return;
+        } else if (delta >= capacity){
+            engine->stats.num_frames_overflow++;
+            return;
+        }
+    }
+
+    if (!engine->timestamps_valid){
+        engine->base_timestamp = timestamp;
+        engine->play_timestamp = timestamp;
+        engine->end_timestamp  = timestamp;
+        engine->timestamps_valid = 1;
+    }
+
+    a2dp_sink_media_engine_frame_t * frame = a2dp_sink_media_engine_frame_for_timestamp(engine, timestamp);
+    frame->timestamp = timestamp;
+    frame->len = len;
+    frame->valid = 1;
+    memcpy(frame->data, data, len);
+
+    uint32_t frame_end = timestamp + engine->samples_per_frame;
+    if ((int32_t)(frame_end - engine->end_timestamp) > 0){
+        engine->end_timestamp = frame_end;
+    }
+}
+
+// decode next frame into pcm after last audio frame of previous one, returns 0 on underrun
+static int a2dp_sink_media_engine_fetch_frame(a2dp_sink_media_engine_t * engine){
+    // keep last audio frame for interpolation
+    engine->pcm[0] = engine->pcm[(engine->pcm_count - 1) * 2];
+    engine->pcm[1] = engine->pcm[(engine->pcm_count - 1) * 2 + 1];
+    engine->position -= ((uint64_t)(engine->pcm_count - 1)) << 32;
+    engine->pcm_count = 1;
+
+    if (!engine->timestamps_valid) return 0;
+    if ((int32_t)(engine->end_timestamp - engine->play_timestamp) <= 0) return 0;
+
+    a2dp_sink_media_engine_frame_t * frame = a2dp_sink_media_engine_frame_for_timestamp(engine, engine->play_timestamp);
+    engine->pcm_decoded = 0;
+    if (frame->valid){
+        btstack_sbc_decoder_process_data(&engine->decoder_state, 0, frame->data, frame->len);
+        frame->valid = 0;
+    }
+    if (!engine->pcm_decoded){
+        // conceal missing or corrupt frame with silence
+        memset(&engine->pcm[2], 0, engine->samples_per_frame * 4);
+        engine->pcm_count += engine->samples_per_frame;
+        engine->stats.num_frames_concealed++;
+    }
+    engine->play_timestamp += engine->samples_per_frame;
+    return 1;
+}
+
+static void a2dp_sink_media_engine_update_drift_controller(a2dp_sink_media_engine_t * engine, int num_audio_frames){
+    int32_t fill_level = a2dp_sink_media_engine_buffered_samples(engine);
+    int64_t sample_rate = engine->sample_rate;
+    // low-pass filter fill level, as media packets arrive in bursts and with jitter
+    engine->fill_level_q16 += ((((int64_t) fill_level) << 16) - engine->fill_level_q16) * num_audio_frames /
+        (A2DP_SINK_MEDIA_ENGINE_FILL_LEVEL_SECONDS * sample_rate);
+    int64_t error = (engine->fill_level_q16 >> 16) - (int32_t) engine->target_latency;
+
+    int64_t p_ppm = error * 1000000 / (A2DP_SINK_MEDIA_ENGINE_P_SECONDS * sample_rate);
+    if (p_ppm > -A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM && p_ppm < A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM){
+        // only integrate if proportional term is not saturated
+        engine->drift_integral_q16 += error * num_audio_frames * 1000000 * 65536 /
+            (A2DP_SINK_MEDIA_ENGINE_P_SECONDS * A2DP_SINK_MEDIA_ENGINE_I_SECONDS * sample_rate * sample_rate);
+    }
+    int64_t max_integral_q16 = ((int64_t) A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM) << 16;
+    if (engine->drift_integral_q16 >  max_integral_q16) engine->drift_integral_q16 =  max_integral_q16;
+    if (engine->drift_integral_q16 < -max_integral_q16) engine->drift_integral_q16 = -max_integral_q16;
+
+    int64_t correction_ppm = p_ppm + (engine->drift_integral_q16 / 65536);
+    if (correction_ppm >  A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM) correction_ppm =  A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM;
+    if (correction_ppm < -A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM) correction_ppm = -A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM;
+    engine->correction_ppm = (int32_t) correction_ppm;
+}
+
+void a2dp_sink_media_engine_init(a2dp_sink_media_engine_t * engine, uint8_t * storage, uint32_t storage_size){
+    memset(engine, 0, sizeof(a2dp_sink_media_engine_t));
+    engine->frames = (a2dp_sink_media_engine_frame_t *) storage;
+    engine->num_frames = storage_size / sizeof(a2dp_sink_media_engine_frame_t);
+    engine->min_latency_ms = A2DP_SINK_MEDIA_ENGINE_DEFAULT_MIN_LATENCY_MS;
+    engine->max_latency_ms = A2DP_SINK_MEDIA_ENGINE_DEFAULT_MAX_LATENCY_MS;
+    engine->state = A2DP_SINK_MEDIA_ENGINE_IDLE;
+    a2dp_sink_media_engine_reset_buffer(engine);
+}
+
+void a2dp_sink_media_engine_set_latency_range(a2dp_sink_media_engine_t * engine, uint16_t min_latency_ms, uint16_t max_latency_ms){
+    engine->min_latency_ms = min_latency_ms;
+    engine->max_latency_ms = btstack_max(min_latency_ms, max_latency_ms);
+}
+
+void a2dp_sink_media_engine_start(a2dp_sink_media_engine_t * engine){
+    btstack_sbc_decoder_init(&engine->decoder_state, SBC_MODE_STANDARD, &a2dp_sink_media_engine_handle_pcm_data, engine);
+    a2dp_sink_media_engine_reset_buffer(engine);
+    engine->target_latency = 0;
+    engine->jitter_q4 = 0;
+    engine->state = A2DP_SINK_MEDIA_ENGINE_PREBUFFERING;
+}
+
+void a2dp_sink_media_engine_stop(a2dp_sink_media_engine_t * engine){
+    a2dp_sink_media_engine_reset_buffer(engine);
+    engine->state = A2DP_SINK_MEDIA_ENGINE_IDLE;
+}
+
+void a2dp_sink_media_engine_handle_media_packet(a2dp_sink_media_engine_t * engine, uint8_t * packet, uint16_t size){
+    if (engine->state == A2DP_SINK_MEDIA_ENGINE_IDLE) return;
+    if (engine->num_frames == 0) return;
+
+    // RTP header
+    if (size < RTP_HEADER_LEN) return;
+    int pos = RTP_HEADER_LEN + (packet[0] & 0x0f) * 4;
+    if (packet[0] & 0x10){
+        // header extension
+        if (size < pos + 4) return;
+        pos += 4 + big_endian_read_16(packet, pos + 2) * 4;
+    }
+    uint32_t timestamp = big_endian_read_32(packet, 4);
+
+    // SBC media payload header
+    if (size < pos + 1) return;
+    uint8_t sbc_header = packet[pos++];
+    if (sbc_header & 0x80){
+        log_info("A2DP Sink Media Engine: fragmented SBC frames not supported");
+        return;
+    }
+    int num_frames = sbc_header & 0x0f;
+    if (num_frames == 0) return;
+
+    // stream parameters from first SBC frame
+    if (a2dp_sink_media_engine_sbc_frame_len(&packet[pos], size - pos) == 0) return;
+    uint32_t sample_rate = sbc_sample_rates[packet[pos + 1] >> 6];
+    uint16_t samples_per_frame = 4 * (((packet[pos + 1] >> 4) & 0x03) + 1) * ((packet[pos + 1] & 0x01) ? 8 : 4);
+    if (sample_rate != engine->sample_rate || samples_per_frame != engine->samples_per_frame){
+        log_info("A2DP Sink Media Engine: sample rate %u, %u samples per frame", (int) sample_rate, samples_per_frame);
+        a2dp_sink_media_engine_reset_buffer(engine);
+        engine->sample_rate = sample_rate;
+        engine->samples_per_frame = samples_per_frame;
+        engine->target_latency = 0;
+        engine->jitter_q4 = 0;
+        engine->drift_integral_q16 = 0;
+        engine->state = A2DP_SINK_MEDIA_ENGINE_PREBUFFERING;
+    }
+
+    a2dp_sink_media_engine_update_jitter(engine, timestamp);
+    a2dp_sink_media_engine_update_target_latency(engine, num_frames);
+
+    int i;
+    for (i=0;i<num_frames;i++){
+        int frame_len = a2dp_sink_media_engine_sbc_frame_len(&packet[pos], size - pos);
+        if (frame_len == 0 || frame_len > size - pos){
+            log_info("A2DP Sink Media Engine: invalid SBC frame %u of %u", i, num_frames);
+            break;
+        }
+        a2dp_sink_media_engine_store_frame(engine, timestamp, &packet[pos], frame_len);
+        pos += frame_len;
+        timestamp += samples_per_frame;
+    }
+}
+
+uint32_t a2dp_sink_media_engine_sample_rate(a2dp_sink_media_engine_t * engine){
+    return engine->sample_rate;
+}
+
+int a2dp_sink_media_engine_read_pcm(a2dp_sink_media_engine_t * engine, int16_t * pcm_samples, int num_audio_frames){
+    if (engine->state == A2DP_SINK_MEDIA_ENGINE_PREBUFFERING && engine->timestamps_valid){
+        uint32_t buffered = a2dp_sink_media_engine_buffered_samples(engine);
+        if (buffered >= engine->target_latency){
+            log_info("A2DP Sink Media Engine: start playback, %u ms buffered", a2dp_sink_media_engine_ms_for_samples(engine, buffered));
+            a2dp_sink_media_engine_reset_resampler(engine);
+            engine->fill_level_q16 = ((int64_t) buffered) << 16;
+            engine->state = A2DP_SINK_MEDIA_ENGINE_PLAYING;
+        }
+    }
+
+    if (engine->state != A2DP_SINK_MEDIA_ENGINE_PLAYING){
+        memset(pcm_samples, 0, num_audio_frames * 4);
+        return 0;
+    }
+
+    a2dp_sink_media_engine_update_drift_controller(engine, num_audio_frames);
+    uint64_t step = (1ULL << 32) + (int64_t) engine->correction_ppm * PPM_TO_Q32;
+
+    int i;
+    for (i=0;i<num_audio_frames;i++){
+        uint32_t index = (uint32_t)(engine->position >> 32);
+        while (index + 1 >= engine->pcm_count){
+            if (!a2dp_sink_media_engine_fetch_frame(engine)) break;
+            index = (uint32_t)(engine->position >> 32);
+        }
+        if (index + 1 >= engine->pcm_count){
+            log_info("A2DP Sink Media Engine: underrun");
+            engine->stats.num_underruns++;
+            engine->timestamps_valid = 0;
+            engine->state = A2DP_SINK_MEDIA_ENGINE_PREBUFFERING;
+            memset(&pcm_samples[i * 2], 0, (num_audio_frames - i) * 4);
+            return i;
+        }
+        // linear interpolation with 15 bit fraction
+        int32_t fraction = (int32_t)((engine->position >> 17) & 0x7fff);
+        const int16_t * sample = &engine->pcm[index * 2];
+        pcm_samples[i * 2]     = sample[0] + ((((int32_t) sample[2] - sample[0]) * fraction) >> 15);
+        pcm_samples[i * 2 + 1] = sample[1] + ((((int32_t) sample[3] - sample[1]) * fraction) >> 15);
+        engine->position += step;
+    }
+    return num_audio_frames;
+}
+
+void a2dp_sink_media_engine_get_stats(a2dp_sink_media_engine_t * engine, a2dp_sink_media_engine_stats_t * stats){
+    *stats = engine->stats;
+    stats->fill_level_ms     = a2dp_sink_media_engine_ms_for_samples(engine, a2dp_sink_media_engine_buffered_samples(engine));
+    stats->target_latency_ms = a2dp_sink_media_engine_ms_for_samples(engine, engine->target_latency);
+    stats->jitter_ms         = a2dp_sink_media_engine_ms_for_samples(engine, engine->jitter_q4 >> 4);
+    stats->drift_ppm         = (int32_t)(engine->drift_integral_q16 / 65536);
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ * a2dp_sink_media_engine.h
+ *
+ * A2DP Sink media engine: jitter buffer, SBC decoding and clock drift compensation
+ *
+ * SBC frames from received media packets are stored in a jitter buffer indexed by their
+ * RTP timestamp. Late frames are dropped, missing frames are concealed with silence.
+ * The target latency follows the measured packet arrival jitter. Audio is pulled by the
+ * audio output at its own clock and resampled with a fractional ratio that keeps the
+ * jitter buffer fill level at the target latency, which compensates the clock drift
+ * between A2DP Source and the local audio output.
+ *
+ * The engine uses the SBC decoder singleton, hence only a single engine can be active.
+ * All functions have to be called from the main thread, e.g. from a DMA completion
+ * data source or a timer that refills the audio output buffers.
+ */
+
+#ifndef __A2DP_SINK_MEDIA_ENGINE_H
+#define __A2DP_SINK_MEDIA_ENGINE_H
+
+#include <stdint.h>
+
+#include "btstack_config.h"
+#include "classic/btstack_sbc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#ifndef A2DP_SINK_MEDIA_ENGINE_MAX_SBC_FRAME_SIZE
+#define A2DP_SINK_MEDIA_ENGINE_MAX_SBC_FRAME_SIZE 128
+#endif
+
+#ifndef A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM
+#define A2DP_SINK_MEDIA_ENGINE_MAX_DRIFT_PPM 2000
+#endif
+
+#define A2DP_SINK_MEDIA_ENGINE_DEFAULT_MIN_LATENCY_MS  60
+#define A2DP_SINK_MEDIA_ENGINE_DEFAULT_MAX_LATENCY_MS 250
+
+// max SBC frame: 16 blocks * 8 subbands, decoder always provides stereo output
+#define A2DP_SINK_MEDIA_ENGINE_MAX_SAMPLES_PER_FRAME (16 * 8)
+
+typedef struct {
+    uint32_t timestamp;
+    uint16_t len;
+    uint8_t  valid;
+    uint8_t  data[A2DP_SINK_MEDIA_ENGINE_MAX_SBC_FRAME_SIZE];
+} a2dp_sink_media_engine_frame_t;
+
+// storage size for given number of SBC frames in jitter buffer
+#define A2DP_SINK_MEDIA_ENGINE_STORAGE_SIZE(num_frames) ((num_frames) * sizeof(a2dp_sink_media_engine_frame_t))
+
+typedef enum {
+    A2DP_SINK_MEDIA_ENGINE_IDLE = 0,
+    A2DP_SINK_MEDIA_ENGINE_PREBUFFERING,
+    A2DP_SINK_MEDIA_ENGINE_PLAYING,
+} a2dp_sink_media_engine_state_t;
+
+typedef struct {
+    uint32_t num_frames_received;
+    uint32_t num_frames_late;
+    uint32_t num_frames_overflow;
+    uint32_t num_frames_concealed;
+    uint32_t num_underruns;
+    // jitter buffer fill level, including decoded audio not played yet
+    uint16_t fill_level_ms;
+    uint16_t target_latency_ms;
+    uint16_t jitter_ms;
+    // estimated clock drift of A2DP Source relative to audio output
+    int32_t  drift_ppm;
+} a2dp_sink_media_engine_stats_t;
+
+typedef struct {
+    a2dp_sink_media_engine_state_t state;
+
+    // jitter buffer
+    a2dp_sink_media_engine_frame_t * frames;
+    uint16_t num_frames;
+    uint32_t base_timestamp;
+    uint32_t play_timestamp;
+    uint32_t end_timestamp;
+    uint8_t  timestamps_valid;
+
+    // stream parameters from SBC frame header
+    uint32_t sample_rate;
+    uint16_t samples_per_frame;
+
+    // latency
+    uint16_t min_latency_ms;
+    uint16_t max_latency_ms;
+    uint32_t target_latency;
+
+    // RFC 3550 interarrival jitter, in samples, scaled by 16
+    uint32_t jitter_q4;
+    int32_t  last_transit;
+    uint8_t  last_transit_valid;
+
+    // decoded audio, stereo, index 0 holds last audio frame of previous SBC frame
+    btstack_sbc_decoder_state_t decoder_state;
+    int16_t  pcm[(1 + A2DP_SINK_MEDIA_ENGINE_MAX_SAMPLES_PER_FRAME) * 2];
+    uint16_t pcm_count;
+    uint8_t  pcm_decoded;
+
+    // resampler: read position in pcm in Q32, drift controller in ppm
+    uint64_t position;
+    int64_t  fill_level_q16;
+    int64_t  drift_integral_q16;
+    int32_t  correction_ppm;
+
+    a2dp_sink_media_engine_stats_t stats;
+} a2dp_sink_media_engine_t;
+
+/* API_START */
+
+/**
+ * @brief Init A2DP Sink media engine
+ * @param engine
+ * @param storage for jitter buffer, see A2DP_SINK_MEDIA_ENGINE_STORAGE_SIZE
+ * @param storage_size in bytes
+ */
+void a2dp_sink_media_engine_init(a2dp_sink_media_engine_t * engine, uint8_t * storage, uint32_t storage_size);
+
+/**
+ * @brief Set range for target latency, which is adapted to the measured packet arrival jitter
+ * @param engine
+ * @param min_latency_ms, default A2DP_SINK_MEDIA_ENGINE_DEFAULT_MIN_LATENCY_MS
+ * @param max_latency_ms, default A2DP_SINK_MEDIA_ENGINE_DEFAULT_MAX_LATENCY_MS, limited by jitter buffer size
+ */
+void a2dp_sink_media_engine_set_latency_range(a2dp_sink_media_engine_t * engine, uint16_t min_latency_ms, uint16_t max_latency_ms);
+
+/**
+ * @brief Start engine and setup SBC decoder. Call on A2DP_SUBEVENT_STREAM_STARTED
+ * @param engine
+ */
+void a2dp_sink_media_engine_start(a2dp_sink_media_engine_t * engine);
+
+/**
+ * @brief Stop engine and drop buffered audio. Call on A2DP_SUBEVENT_STREAM_SUSPENDED or A2DP_SUBEVENT_STREAM_RELEASED
+ * @param engine
+ */
+void a2dp_sink_media_engine_stop(a2dp_sink_media_engine_t * engine);
+
+/**
+ * @brief Process media packet received via the handler registered with a2dp_sink_register_media_handler
+ * @param engine
+ * @param packet with media packet header and SBC payload
+ * @param size
+ */
+void a2dp_sink_media_engine_handle_media_packet(a2dp_sink_media_engine_t * engine, uint8_t * packet, uint16_t size);
+
+/**
+ * @brief Get sample rate of current stream
+ * @param engine
+ * @return sample_rate or 0 if not known yet
+ */
+uint32_t a2dp_sink_media_engine_sample_rate(a2dp_sink_media_engine_t * engine);
+
+/**
+ * @brief Read PCM audio for playback. Silence is provided while prebuffering or on underrun
+ * @param engine
+ * @param pcm_samples stereo, interleaved, in host endianess
+ * @param num_audio_frames to read
+ * @return number of audio frames that contain audio from the stream
+ */
+int a2dp_sink_media_engine_read_pcm(a2dp_sink_media_engine_t * engine, int16_t * pcm_samples, int num_audio_frames);
+
+/**
+ * @brief Get statistics
+ * @param engine
+ * @param stats
+ */
+void a2dp_sink_media_engine_get_stats(a2dp_sink_media_engine_t * engine, a2dp_sink_media_engine_stats_t * stats);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __A2DP_SINK_MEDIA_ENGINE_H
@@ -482,7 +482,7 @@ uint8_t a2dp_source_pause_stream(uint16_t a2dp_cid, uint8_t local_seid){
     return avdtp_suspend_stream(a2dp_cid, local_seid, &a2dp_source_context);
 }
 
-static void a2dp_source_setup_media_header(uint8_t * media_packet, int size, int *offset, uint8_t marker, uint16_t sequence_number){
+static void a2dp_source_setup_media_header(uint8_t * media_packet, int size, int *offset, uint8_t marker, uint16_t sequence_number, uint32_t timestamp){
     if (size < AVDTP_MEDIA_PAYLOAD_HEADER_SIZE){
         log_error("small outgoing buffer");
         return;
@@ -494,7 +494,6 @@ static void a2dp_source_setup_media_header(uint8_t * media_packet, int size, int
     uint8_t  csrc_count = 0;
     uint8_t  payload_type = 0x60;
     // uint16_t sequence_number = stream_endpoint->sequence_number;
-    uint32_t timestamp = btstack_run_loop_get_time_ms();
     uint32_t ssrc = 0x11223344;
 
     // rtp header (min size 12B)
@@ -558,6 +557,10 @@ static void a2dp_source_copy_media_payload(uint8_t * media_packet, int size, int
 }
 
 int a2dp_source_stream_send_media_payload(uint16_t a2dp_cid, uint8_t local_seid, uint8_t * storage, int num_bytes_to_copy, uint8_t num_frames, uint8_t marker){
+    return a2dp_source_stream_send_media_payload_rtp(a2dp_cid, local_seid, btstack_run_loop_get_time_ms(), storage, num_bytes_to_copy, num_frames, marker);
+}
+
+int a2dp_source_stream_send_media_payload_rtp(uint16_t a2dp_cid, uint8_t local_seid, uint32_t timestamp, uint8_t * storage, int num_bytes_to_copy, uint8_t num_frames, uint8_t marker){
     avdtp_stream_endpoint_t * stream_endpoint = avdtp_stream_endpoint_for_seid(local_seid, &a2dp_source_context);
     if (!stream_endpoint) {
         log_error("A2DP source: no stream_endpoint with seid %d", local_seid);
@@ -579,9 +582,17 @@ int a2dp_source_stream_send_media_payload(uint16_t a2dp_cid, uint8_t local_seid,
     l2cap_reserve_packet_buffer();
     uint8_t * media_packet = l2cap_get_outgoing_buffer();
     //int size = l2cap_get_remote_mtu_for_local_cid(stream_endpoint->l2cap_media_cid);
-    a2dp_source_setup_media_header(media_packet, size, &offset, marker, stream_endpoint->sequence_number);
+    a2dp_source_setup_media_header(media_packet, size, &offset, marker, stream_endpoint->sequence_number, timestamp);
     a2dp_source_copy_media_payload(media_packet, size, &offset, storage, num_bytes_to_copy, num_frames);
     stream_endpoint->sequence_number++;
     l2cap_send_prepared(stream_endpoint->l2cap_media_cid, offset);
     return size;
 }
+
+hci_con_handle_t a2dp_source_media_con_handle(uint16_t a2dp_cid, uint8_t local_seid){
+    avdtp_stream_endpoint_t * stream_endpoint = avdtp_stream_endpoint_for_seid(local_seid, &a2dp_source_context);
+    if (!stream_endpoint) return HCI_CON_HANDLE_INVALID;
+    if (a2dp_source_context.avdtp_cid != a2dp_cid) return HCI_CON_HANDLE_INVALID;
+    if (stream_endpoint->l2cap_media_cid == 0) return HCI_CON_HANDLE_INVALID;
+    return stream_endpoint->media_con_handle;
+}
@@ -155,6 +155,27 @@ int 	a2dp_max_media_payload_size(uint16_t a2dp_cid, uint8_t local_seid);
  */
 int  	a2dp_source_stream_send_media_payload(uint16_t a2dp_cid, uint8_t local_seid, uint8_t * storage, int num_bytes_to_copy, uint8_t num_frames, uint8_t marker);
 
+/**
+ * @brief Send media payload with given RTP timestamp.
+ * @param a2dp_cid 			A2DP channel identifyer.
+ * @param local_seid  		ID of a local stream endpoint.
+ * @param timestamp 		RTP timestamp, e.g. number of audio samples sent before this packet.
+ * @param storage
+ * @param num_bytes_to_copy
+ * @param num_frames
+ * @param marker
+ * @return max_media_payload_size_without_media_header
+ */
+int  	a2dp_source_stream_send_media_payload_rtp(uint16_t a2dp_cid, uint8_t local_seid, uint32_t timestamp, uint8_t * storage, int num_bytes_to_copy, uint8_t num_frames, uint8_t marker);
+
+/**
+ * @brief Get HCI connection handle of media channel
+ * @param a2dp_cid 			A2DP channel identifyer.
+ * @param local_seid  		ID of a local stream endpoint.
+ * @return con_handle or HCI_CON_HANDLE_INVALID if media channel is not open
+ */
+hci_con_handle_t a2dp_source_media_con_handle(uint16_t a2dp_cid, uint8_t local_seid);
+
 /* API_END */
 
 #if defined __cplusplus
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "a2dp_source_pipeline.c"
+
+/*
+ * a2dp_source_pipeline.c
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "btstack.h"
+#include "classic/a2dp_source.h"
+#include "classic/a2dp_source_pipeline.h"
+#include "classic/btstack_sbc.h"
+
+// SBC media payload header contains 4 bit number of frames
+#define A2DP_SOURCE_PIPELINE_MAX_SBC_FRAMES 15
+#define A2DP_SOURCE_PIPELINE_MAX_PCM_SAMPLES (16 * 8 * 2)
+
+// flags shared with the producer thread use sequentially consistent accesses: producer sets producer_active
+// before it checks streaming, stop clears streaming before it checks producer_active. Without C11 atomics,
+// GCC builtins or volatile accesses are used, the latter is only safe on single core MCUs
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define FLAG_LOAD(flag)         atomic_load((_Atomic uint8_t *) &(flag))
+#define FLAG_STORE(flag, value) atomic_store((_Atomic uint8_t *) &(flag), (value))
+#elif defined(__GNUC__)
+#define FLAG_LOAD(flag)         __atomic_load_n(&(flag), __ATOMIC_SEQ_CST)
+#define FLAG_STORE(flag, value) __atomic_store_n(&(flag), (value), __ATOMIC_SEQ_CST)
+#else
+#define FLAG_LOAD(flag)         (*(volatile uint8_t *) &(flag))
+#define FLAG_STORE(flag, value) (*(volatile uint8_t *) &(flag) = (value))
+#endif
+
+static btstack_linked_list_t pipelines;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+
+static void a2dp_source_pipeline_run(a2dp_source_pipeline_t * pipeline);
+
+static int a2dp_source_pipeline_pcm_frame_size(a2dp_source_pipeline_t * pipeline){
+    return pipeline->num_channels * 2;
+}
+
+static int a2dp_source_pipeline_num_acl_packets_queued(a2dp_source_pipeline_t * pipeline){
+    hci_connection_t * connection = hci_connection_for_handle(pipeline->con_handle);
+    if (!connection) return 0;
+    return connection->num_acl_packets_sent;
+}
+
+// consumer side only, safe while producer writes
+static void a2dp_source_pipeline_discard_pcm(a2dp_source_pipeline_t * pipeline){
+    btstack_spsc_ring_buffer_span_t span;
+    uint32_t bytes_available = btstack_spsc_ring_buffer_bytes_available(&pipeline->pcm_buffer);
+    uint32_t bytes_to_discard = btstack_spsc_ring_buffer_peek(&pipeline->pcm_buffer, &span, bytes_available);
+    btstack_spsc_ring_buffer_consume(&pipeline->pcm_buffer, bytes_to_discard);
+}
+
+static void a2dp_source_pipeline_reset(a2dp_source_pipeline_t * pipeline){
+    a2dp_source_pipeline_discard_pcm(pipeline);
+    pipeline->discard_pending = 0;
+    pipeline->sbc_storage_count = 0;
+    pipeline->sbc_frame_size = 0;
+    pipeline->num_sbc_frames = 0;
+    pipeline->send_requested = 0;
+    pipeline->rtp_timestamp = 0;
+}
+
+static void hci_event_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (hci_event_packet_get_type(packet) != HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS) return;
+
+    // controller has sent packets, check if next media packet can be queued
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &pipelines);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        a2dp_source_pipeline_t * pipeline = (a2dp_source_pipeline_t *) btstack_linked_list_iterator_next(&it);
+        a2dp_source_pipeline_run(pipeline);
+    }
+}
+
+static void a2dp_source_pipeline_encode(a2dp_source_pipeline_t * pipeline){
+    int16_t pcm_frame[A2DP_SOURCE_PIPELINE_MAX_PCM_SAMPLES];
+    uint32_t pcm_frame_bytes = btstack_sbc_encoder_num_audio_frames() * a2dp_source_pipeline_pcm_frame_size(pipeline);
+    if (pcm_frame_bytes > sizeof(pcm_frame)) return;
+
+    while (btstack_spsc_ring_buffer_bytes_available(&pipeline->pcm_buffer) >= pcm_frame_bytes){
+        if (pipeline->num_sbc_frames >= A2DP_SOURCE_PIPELINE_MAX_SBC_FRAMES) break;
+        if (pipeline->sbc_storage_count + pipeline->sbc_frame_size > pipeline->max_media_payload_size) break;
+
+        btstack_spsc_ring_buffer_read(&pipeline->pcm_buffer, (uint8_t *) pcm_frame, pcm_frame_bytes);
+        btstack_sbc_encoder_process_data(pcm_frame);
+
+        uint16_t sbc_frame_size = btstack_sbc_encoder_sbc_buffer_length();
+        if (pipeline->sbc_storage_count + sbc_frame_size > pipeline->max_media_payload_size){
+            log_error("A2DP Source pipeline: SBC frame size %u exceeds max media payload size %u", sbc_frame_size, pipeline->max_media_payload_size);
+            break;
+        }
+        memcpy(&pipeline->sbc_storage[pipeline->sbc_storage_count], btstack_sbc_encoder_sbc_buffer(), sbc_frame_size);
+        pipeline->sbc_storage_count += sbc_frame_size;
+        pipeline->sbc_frame_size = sbc_frame_size;
+        pipeline->num_sbc_frames++;
+    }
+}
+
+static int a2dp_source_pipeline_media_packet_ready(a2dp_source_pipeline_t * pipeline){
+    if (pipeline->num_sbc_frames == 0) return 0;
+    if (pipeline->num_sbc_frames >= A2DP_SOURCE_PIPELINE_MAX_SBC_FRAMES) return 1;
+    return pipeline->sbc_storage_count + pipeline->sbc_frame_size > pipeline->max_media_payload_size;
+}
+
+static void a2dp_source_pipeline_run(a2dp_source_pipeline_t * pipeline){
+    if (!pipeline->streaming) return;
+    if (pipeline->send_requested) return;
+
+    a2dp_source_pipeline_encode(pipeline);
+
+    if (!a2dp_source_pipeline_media_packet_ready(pipeline)) return;
+    if (a2dp_source_pipeline_num_acl_packets_queued(pipeline) >= pipeline->target_queue_depth) return;
+
+    pipeline->send_requested = 1;
+    a2dp_source_stream_endpoint_request_can_send_now(pipeline->a2dp_cid, pipeline->local_seid);
+}
+
+static void a2dp_source_pipeline_poll_timer_handler(btstack_timer_source_t * ts){
+    a2dp_source_pipeline_t * pipeline = (a2dp_source_pipeline_t *) btstack_run_loop_get_timer_context(ts);
+    if (pipeline->discard_pending){
+        // producer was writing when streaming was stopped, wait until it has seen the stop
+        if (FLAG_LOAD(pipeline->producer_active) == 0){
+            a2dp_source_pipeline_discard_pcm(pipeline);
+            pipeline->discard_pending = 0;
+            return;
+        }
+        btstack_run_loop_set_timer(ts, A2DP_SOURCE_PIPELINE_POLL_INTERVAL_MS);
+        btstack_run_loop_add_timer(ts);
+        return;
+    }
+    if (!pipeline->streaming) return;
+    // PCM might be written by another thread, poll ring buffer
+    a2dp_source_pipeline_run(pipeline);
+    btstack_run_loop_set_timer(ts, A2DP_SOURCE_PIPELINE_POLL_INTERVAL_MS);
+    btstack_run_loop_add_timer(ts);
+}
+
+void a2dp_source_pipeline_init(a2dp_source_pipeline_t * pipeline, uint8_t * pcm_storage, uint32_t pcm_storage_size){
+    memset(pipeline, 0, sizeof(a2dp_source_pipeline_t));
+    btstack_spsc_ring_buffer_init(&pipeline->pcm_buffer, pcm_storage, pcm_storage_size);
+    pipeline->target_queue_depth = A2DP_SOURCE_PIPELINE_DEFAULT_TARGET_QUEUE_DEPTH;
+    pipeline->con_handle = HCI_CON_HANDLE_INVALID;
+}
+
+void a2dp_source_pipeline_set_target_queue_depth(a2dp_source_pipeline_t * pipeline, uint8_t num_packets){
+    pipeline->target_queue_depth = btstack_max(1, num_packets);
+}
+
+void a2dp_source_pipeline_start(a2dp_source_pipeline_t * pipeline, uint16_t a2dp_cid, uint8_t local_seid, int num_channels){
+    a2dp_source_pipeline_reset(pipeline);
+    pipeline->a2dp_cid = a2dp_cid;
+    pipeline->local_seid = local_seid;
+    pipeline->num_channels = num_channels;
+    pipeline->con_handle = a2dp_source_media_con_handle(a2dp_cid, local_seid);
+    // media payload starts with SBC header containing number of frames
+    int max_media_payload_size = a2dp_max_media_payload_size(a2dp_cid, local_seid);
+    if (max_media_payload_size <= 1){
+        log_error("A2DP Source pipeline: no media payload size for a2dp cid 0x%02x, local seid %u", a2dp_cid, local_seid);
+        return;
+    }
+    pipeline->max_media_payload_size = btstack_min(max_media_payload_size - 1, A2DP_SOURCE_PIPELINE_SBC_STORAGE_SIZE);
+    FLAG_STORE(pipeline->streaming, 1);
+
+    if (pipelines == NULL){
+        hci_event_callback_registration.callback = &hci_event_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+    }
+    btstack_linked_list_remove(&pipelines, (btstack_linked_item_t *) pipeline);
+    btstack_linked_list_add(&pipelines, (btstack_linked_item_t *) pipeline);
+
+    btstack_run_loop_remove_timer(&pipeline->poll_timer);
+    btstack_run_loop_set_timer_handler(&pipeline->poll_timer, &a2dp_source_pipeline_poll_timer_handler);
+    btstack_run_loop_set_timer_context(&pipeline->poll_timer, pipeline);
+    btstack_run_loop_set_timer(&pipeline->poll_timer, A2DP_SOURCE_PIPELINE_POLL_INTERVAL_MS);
+    btstack_run_loop_add_timer(&pipeline->poll_timer);
+    log_info("A2DP Source pipeline: start, a2dp cid 0x%02x, max media payload %u", a2dp_cid, pipeline->max_media_payload_size);
+}
+
+void a2dp_source_pipeline_stop(a2dp_source_pipeline_t * pipeline){
+    FLAG_STORE(pipeline->streaming, 0);
+    btstack_run_loop_remove_timer(&pipeline->poll_timer);
+    a2dp_source_pipeline_reset(pipeline);
+    // producer might have checked streaming before it was cleared, discard its data after it returned
+    if (FLAG_LOAD(pipeline->producer_active)){
+        pipeline->discard_pending = 1;
+        btstack_run_loop_set_timer(&pipeline->poll_timer, A2DP_SOURCE_PIPELINE_POLL_INTERVAL_MS);
+        btstack_run_loop_add_timer(&pipeline->poll_timer);
+    }
+    btstack_linked_list_remove(&pipelines, (btstack_linked_item_t *) pipeline);
+    if (pipelines == NULL){
+        hci_remove_event_handler(&hci_event_callback_registration);
+    }
+}
+
+int a2dp_source_pipeline_num_audio_frames_free(a2dp_source_pipeline_t * pipeline){
+    if (pipeline->num_channels == 0) return 0;
+    return btstack_spsc_ring_buffer_bytes_free(&pipeline->pcm_buffer) / a2dp_source_pipeline_pcm_frame_size(pipeline);
+}
+
+int a2dp_source_pipeline_write_pcm(a2dp_source_pipeline_t * pipeline, int16_t * pcm_samples, int num_audio_frames){
+    FLAG_STORE(pipeline->producer_active, 1);
+    if (!FLAG_LOAD(pipeline->streaming)){
+        FLAG_STORE(pipeline->producer_active, 0);
+        return 0;
+    }
+    int num_frames_to_write = btstack_min(num_audio_frames, a2dp_source_pipeline_num_audio_frames_free(pipeline));
+    if (num_frames_to_write < num_audio_frames){
+        pipeline->num_audio_frames_dropped += num_audio_frames - num_frames_to_write;
+    }
+    btstack_spsc_ring_buffer_write(&pipeline->pcm_buffer, (uint8_t *) pcm_samples, num_frames_to_write * a2dp_source_pipeline_pcm_frame_size(pipeline));
+    FLAG_STORE(pipeline->producer_active, 0);
+    return num_frames_to_write;
+}
+
+void a2dp_source_pipeline_handle_can_send_now(a2dp_source_pipeline_t * pipeline){
+    if (!pipeline->streaming) return;
+    pipeline->send_requested = 0;
+    if (pipeline->num_sbc_frames == 0) return;
+
+    a2dp_source_stream_send_media_payload_rtp(pipeline->a2dp_cid, pipeline->local_seid, pipeline->rtp_timestamp,
+        pipeline->sbc_storage, pipeline->sbc_storage_count, pipeline->num_sbc_frames, 0);
+    pipeline->rtp_timestamp += pipeline->num_sbc_frames * btstack_sbc_encoder_num_audio_frames();
+    pipeline->sbc_storage_count = 0;
+    pipeline->num_sbc_frames = 0;
+    pipeline->num_media_packets_sent++;
+
+    a2dp_source_pipeline_run(pipeline);
+}
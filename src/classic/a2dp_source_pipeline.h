@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ * a2dp_source_pipeline.h
+ *
+ * A2DP Source media pipeline: PCM input, SBC encoding, packetization and pacing
+ *
+ * PCM audio is written into a lock-free ring buffer, which allows to provide audio from
+ * an audio thread, and encoded with the SBC encoder on the main thread, polled by a timer.
+ * As many SBC frames as fit into the L2CAP MTU are sent in a single media packet. The RTP
+ * timestamp is derived from the number of audio samples sent. Media packets are paced
+ * against the outgoing ACL packets for the media connection that are queued in the
+ * Bluetooth Controller, keeping at most target_queue_depth packets in flight.
+ */
+
+#ifndef __A2DP_SOURCE_PIPELINE_H
+#define __A2DP_SOURCE_PIPELINE_H
+
+#include <stdint.h>
+
+#include "btstack_config.h"
+#include "btstack_linked_list.h"
+#include "btstack_run_loop.h"
+#include "btstack_spsc_ring_buffer.h"
+#include "bluetooth.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#ifndef A2DP_SOURCE_PIPELINE_SBC_STORAGE_SIZE
+#define A2DP_SOURCE_PIPELINE_SBC_STORAGE_SIZE 1030
+#endif
+
+#ifndef A2DP_SOURCE_PIPELINE_POLL_INTERVAL_MS
+#define A2DP_SOURCE_PIPELINE_POLL_INTERVAL_MS 5
+#endif
+
+#define A2DP_SOURCE_PIPELINE_DEFAULT_TARGET_QUEUE_DEPTH 2
+
+typedef struct {
+    btstack_linked_item_t item;
+
+    // stream
+    uint16_t a2dp_cid;
+    uint8_t  local_seid;
+    uint8_t  num_channels;
+    hci_con_handle_t con_handle;
+    uint16_t max_media_payload_size;
+    uint8_t  target_queue_depth;
+    // set by main thread, read by producer, accessed atomically
+    uint8_t  streaming;
+
+    // PCM input, written by producer, e.g. audio thread
+    btstack_spsc_ring_buffer_t pcm_buffer;
+    btstack_timer_source_t poll_timer;
+    // set by producer while writing, accessed atomically
+    uint8_t  producer_active;
+    // stop waits for producer to finish current write before discarding PCM
+    uint8_t  discard_pending;
+
+    // SBC frames for next media packet
+    uint8_t  sbc_storage[A2DP_SOURCE_PIPELINE_SBC_STORAGE_SIZE];
+    uint16_t sbc_storage_count;
+    uint16_t sbc_frame_size;
+    uint8_t  num_sbc_frames;
+    uint8_t  send_requested;
+
+    // RTP timestamp of first SBC frame in storage, in audio samples
+    uint32_t rtp_timestamp;
+
+    // statistics, num_audio_frames_dropped is updated by producer
+    uint32_t num_media_packets_sent;
+    uint32_t num_audio_frames_dropped;
+} a2dp_source_pipeline_t;
+
+/* API_START */
+
+/**
+ * @brief Init A2DP Source pipeline
+ * @param pipeline
+ * @param pcm_storage for PCM ring buffer
+ * @param pcm_storage_size in bytes, rounded down to power of two, should hold at least two SBC packets worth of audio
+ */
+void a2dp_source_pipeline_init(a2dp_source_pipeline_t * pipeline, uint8_t * pcm_storage, uint32_t pcm_storage_size);
+
+/**
+ * @brief Set max number of outgoing media packets queued in the Bluetooth Controller
+ * @param pipeline
+ * @param num_packets, default A2DP_SOURCE_PIPELINE_DEFAULT_TARGET_QUEUE_DEPTH
+ */
+void a2dp_source_pipeline_set_target_queue_depth(a2dp_source_pipeline_t * pipeline, uint8_t num_packets);
+
+/**
+ * @brief Start streaming. Call on A2DP_SUBEVENT_STREAM_STARTED after SBC encoder was initialized with the stream configuration
+ * @param pipeline
+ * @param a2dp_cid
+ * @param local_seid
+ * @param num_channels of PCM input
+ */
+void a2dp_source_pipeline_start(a2dp_source_pipeline_t * pipeline, uint16_t a2dp_cid, uint8_t local_seid, int num_channels);
+
+/**
+ * @brief Stop streaming and drop buffered audio. Call on A2DP_SUBEVENT_STREAM_SUSPENDED or A2DP_SUBEVENT_STREAM_RELEASED
+ * @note If the producer is inside a2dp_source_pipeline_write_pcm, its audio is dropped after it returned
+ * @param pipeline
+ */
+void a2dp_source_pipeline_stop(a2dp_source_pipeline_t * pipeline);
+
+/**
+ * @brief Get number of audio frames that can be written. Can be called from producer thread
+ * @param pipeline
+ * @return num_audio_frames
+ */
+int a2dp_source_pipeline_num_audio_frames_free(a2dp_source_pipeline_t * pipeline);
+
+/**
+ * @brief Write PCM audio frames, audio frames that don't fit into the ring buffer are dropped.
+ * @note Can be called from a single producer thread, e.g. audio callback, while streaming
+ * @param pipeline
+ * @param pcm_samples interleaved, in host endianess
+ * @param num_audio_frames, each audio frame contains one sample per channel
+ * @return number of audio frames stored
+ */
+int a2dp_source_pipeline_write_pcm(a2dp_source_pipeline_t * pipeline, int16_t * pcm_samples, int num_audio_frames);
+
+/**
+ * @brief Send next media packet. Call on A2DP_SUBEVENT_STREAMING_CAN_SEND_MEDIA_PACKET_NOW
+ * @param pipeline
+ */
+void a2dp_source_pipeline_handle_can_send_now(a2dp_source_pipeline_t * pipeline);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __A2DP_SOURCE_PIPELINE_H
@@ -51,6 +51,12 @@
 #define NVM_NUM_LINK_KEYS 1
 #endif
 
+#if NVM_NUM_LINK_KEYS > 0xfffe
+#error "NVM_NUM_LINK_KEYS must be smaller than 0xffff"
+#endif
+
+#define LINK_KEY_DB_TLV_INVALID_INDEX 0xffff
+
 typedef struct {
     const btstack_tlv_t * btstack_tlv_impl;
     void * btstack_tlv_context;
@@ -63,105 +69,213 @@ typedef struct link_key_nvm {
     link_key_type_t link_key_type;
 } link_key_nvm_t;   // sizeof(link_key_nvm_t) = 27 bytes
 
+// in-RAM index of stored entries, built in btstack_link_key_db_tlv_get_instance
+typedef struct {
+    bd_addr_t bd_addr;
+    uint8_t   used;
+    uint32_t  seq_nr;
+    // least recently used list, or list of free entries
+    uint16_t  prev;
+    uint16_t  next;
+} link_key_db_tlv_entry_t;
+
 static btstack_link_key_db_tlv_h singleton;
 static btstack_link_key_db_tlv_h * self = &singleton;
 
+static link_key_db_tlv_entry_t entries[NVM_NUM_LINK_KEYS];
+// indices of used entries sorted by address
+static uint16_t sorted_entries[NVM_NUM_LINK_KEYS];
+static uint16_t num_entries;
+static uint16_t lru_head;   // least recently used
+static uint16_t lru_tail;   // most recently used
+static uint16_t free_head;
+static uint32_t highest_seq_nr;
+
 static const char tag_0 = 'B';
 static const char tag_1 = 'T';
 static const char tag_2 = 'L';
+static const char tag_1_extended = 'l';
 
-static uint32_t btstack_link_key_db_tag_for_index(uint8_t index){
-    return (tag_0 << 24) | (tag_1 << 16) | (tag_2 << 8) | index;
+static uint32_t btstack_link_key_db_tag_for_index(uint16_t index){
+    if (index < 0x100){
+        return (tag_0 << 24) | (tag_1 << 16) | (tag_2 << 8) | index;
+    }
+    // more than 256 entries
+    return (tag_0 << 24) | (tag_1_extended << 16) | index;
 }
 
-// Device info
-static void btstack_link_key_db_tlv_open(void){
+// LRU list
+static void btstack_link_key_db_tlv_lru_remove(uint16_t index){
+    link_key_db_tlv_entry_t * entry = &entries[index];
+    if (entry->prev == LINK_KEY_DB_TLV_INVALID_INDEX){
+        lru_head = entry->next;
+    } else {
+        entries[entry->prev].next = entry->next;
+    }
+    if (entry->next == LINK_KEY_DB_TLV_INVALID_INDEX){
+        lru_tail = entry->prev;
+    } else {
+        entries[entry->next].prev = entry->prev;
+    }
 }
 
-static void btstack_link_key_db_tlv_set_bd_addr(bd_addr_t bd_addr){
-    (void)bd_addr;
+static void btstack_link_key_db_tlv_lru_append(uint16_t index){
+    link_key_db_tlv_entry_t * entry = &entries[index];
+    entry->prev = lru_tail;
+    entry->next = LINK_KEY_DB_TLV_INVALID_INDEX;
+    if (lru_tail == LINK_KEY_DB_TLV_INVALID_INDEX){
+        lru_head = index;
+    } else {
+        entries[lru_tail].next = index;
+    }
+    lru_tail = index;
 }
 
-static void btstack_link_key_db_tlv_close(void){ 
+// sorted address index
+// @returns position of address in sorted_entries, or position to insert at as -(pos+1)
+static int btstack_link_key_db_tlv_find(const uint8_t * bd_addr){
+    int lo = 0;
+    int hi = num_entries - 1;
+    while (lo <= hi){
+        int mid = (lo + hi) / 2;
+        int res = memcmp(entries[sorted_entries[mid]].bd_addr, bd_addr, BD_ADDR_LEN);
+        if (res == 0) return mid;
+        if (res < 0){
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -(lo + 1);
 }
 
-static int btstack_link_key_db_tlv_get_link_key(bd_addr_t bd_addr, link_key_t link_key, link_key_type_t * link_key_type) {
-    int i;
-    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
-        link_key_nvm_t entry;
-        uint32_t tag = btstack_link_key_db_tag_for_index(i);
-        int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
-        if (size == 0) continue;
-        log_info("tag %x, addr %s", tag, bd_addr_to_str(entry.bd_addr));
-        if (memcmp(bd_addr, entry.bd_addr, 6)) continue;
-        // found, pass back
-        memcpy(link_key, entry.link_key, 16);
-        *link_key_type = entry.link_key_type;
-        return 1;
-    }
-	return 0;
+static int btstack_link_key_db_tlv_compare_address(const void * a, const void * b){
+    return memcmp(entries[*(const uint16_t *) a].bd_addr, entries[*(const uint16_t *) b].bd_addr, BD_ADDR_LEN);
 }
 
-static void btstack_link_key_db_tlv_delete_link_key(bd_addr_t bd_addr){
-    int i;
-    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
-        link_key_nvm_t entry;
-        uint32_t tag = btstack_link_key_db_tag_for_index(i);
-        int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
-        if (size == 0) continue;
-        if (memcmp(bd_addr, entry.bd_addr, 6)) continue;
-        // found, delete tag
-        self->btstack_tlv_impl->delete_tag(self->btstack_tlv_context, tag);
-        break;
-    }
+static int btstack_link_key_db_tlv_compare_seq_nr(const void * a, const void * b){
+    uint32_t seq_nr_a = entries[*(const uint16_t *) a].seq_nr;
+    uint32_t seq_nr_b = entries[*(const uint16_t *) b].seq_nr;
+    if (seq_nr_a < seq_nr_b) return -1;
+    if (seq_nr_a > seq_nr_b) return 1;
+    return 0;
 }
 
-static void btstack_link_key_db_tlv_put_link_key(bd_addr_t bd_addr, link_key_t link_key, link_key_type_t link_key_type){
-    int i;
-    uint32_t highest_seq_nr = 0;
-    uint32_t lowest_seq_nr = 0;
-    uint32_t tag_for_lowest_seq_nr = 0;
-    uint32_t tag_for_addr = 0;
-    uint32_t tag_for_empty = 0;
-
-    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
+static void btstack_link_key_db_tlv_remove_entry(int pos){
+    uint16_t index = sorted_entries[pos];
+    memmove(&sorted_entries[pos], &sorted_entries[pos+1], (num_entries - pos - 1) * sizeof(uint16_t));
+    num_entries--;
+    btstack_link_key_db_tlv_lru_remove(index);
+    entries[index].used = 0;
+    entries[index].next = free_head;
+    free_head = index;
+}
+
+static void btstack_link_key_db_tlv_scan(void){
+    uint16_t i;
+    num_entries = 0;
+    highest_seq_nr = 0;
+    lru_head  = LINK_KEY_DB_TLV_INVALID_INDEX;
+    lru_tail  = LINK_KEY_DB_TLV_INVALID_INDEX;
+    free_head = LINK_KEY_DB_TLV_INVALID_INDEX;
+    // collect stored entries, build free list in ascending order
+    for (i=NVM_NUM_LINK_KEYS;i>0;i--){
+        uint16_t index = i - 1;
         link_key_nvm_t entry;
-        uint32_t tag = btstack_link_key_db_tag_for_index(i);
+        uint32_t tag = btstack_link_key_db_tag_for_index(index);
         int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
-        // empty/deleted tag
         if (size == 0) {
-            tag_for_empty = tag;
+            entries[index].used = 0;
+            entries[index].next = free_head;
+            free_head = index;
             continue;
         }
-        // found addr?
-        if (memcmp(bd_addr, entry.bd_addr, 6) == 0){
-            tag_for_addr = tag;
-        }
-        // update highest seq nr
+        entries[index].used = 1;
+        entries[index].seq_nr = entry.seq_nr;
+        memcpy(entries[index].bd_addr, entry.bd_addr, BD_ADDR_LEN);
+        sorted_entries[num_entries++] = index;
         if (entry.seq_nr > highest_seq_nr){
             highest_seq_nr = entry.seq_nr;
         }
-        // find entry with lowest seq nr
-        if ((tag_for_lowest_seq_nr == 0) || (entry.seq_nr < lowest_seq_nr)){
-            tag_for_lowest_seq_nr = tag;
-            lowest_seq_nr = entry.seq_nr;
-        }
     }
+    // initial LRU order from seq nr
+    qsort(sorted_entries, num_entries, sizeof(uint16_t), &btstack_link_key_db_tlv_compare_seq_nr);
+    for (i=0;i<num_entries;i++){
+        btstack_link_key_db_tlv_lru_append(sorted_entries[i]);
+    }
+    qsort(sorted_entries, num_entries, sizeof(uint16_t), &btstack_link_key_db_tlv_compare_address);
+    log_info("link key db: %u entries, highest seq nr %u", num_entries, (unsigned int) highest_seq_nr);
+}
+
+// Device info
+static void btstack_link_key_db_tlv_open(void){
+}
 
-    log_info("tag_for_addr %x, tag_for_empy %x, tag_for_lowest_seq_nr %x", tag_for_addr, tag_for_empty, tag_for_lowest_seq_nr);
+static void btstack_link_key_db_tlv_set_bd_addr(bd_addr_t bd_addr){
+    (void)bd_addr;
+}
 
-    uint32_t tag_to_use = 0;
-    if (tag_for_addr){
-        tag_to_use = tag_for_addr;
-    } else if (tag_for_empty){
-        tag_to_use = tag_for_empty;
-    } else if (tag_for_lowest_seq_nr){
-        tag_to_use = tag_for_lowest_seq_nr;
+static void btstack_link_key_db_tlv_close(void){ 
+}
+
+static int btstack_link_key_db_tlv_get_link_key(bd_addr_t bd_addr, link_key_t link_key, link_key_type_t * link_key_type) {
+    int pos = btstack_link_key_db_tlv_find(bd_addr);
+    if (pos < 0) return 0;
+    uint16_t index = sorted_entries[pos];
+    link_key_nvm_t entry;
+    uint32_t tag = btstack_link_key_db_tag_for_index(index);
+    int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
+    if (size == 0 || memcmp(bd_addr, entry.bd_addr, 6)){
+        log_error("link key db: tag %x does not match index", tag);
+        return 0;
+    }
+    // found, pass back
+    memcpy(link_key, entry.link_key, 16);
+    *link_key_type = entry.link_key_type;
+    // mark as most recently used
+    btstack_link_key_db_tlv_lru_remove(index);
+    btstack_link_key_db_tlv_lru_append(index);
+	return 1;
+}
+
+static void btstack_link_key_db_tlv_delete_link_key(bd_addr_t bd_addr){
+    int pos = btstack_link_key_db_tlv_find(bd_addr);
+    if (pos < 0) return;
+    uint16_t index = sorted_entries[pos];
+    // found, delete tag
+    self->btstack_tlv_impl->delete_tag(self->btstack_tlv_context, btstack_link_key_db_tag_for_index(index));
+    btstack_link_key_db_tlv_remove_entry(pos);
+}
+
+static void btstack_link_key_db_tlv_put_link_key(bd_addr_t bd_addr, link_key_t link_key, link_key_type_t link_key_type){
+    int pos = btstack_link_key_db_tlv_find(bd_addr);
+    uint16_t index;
+    if (pos >= 0){
+        // update existing entry
+        index = sorted_entries[pos];
+        btstack_link_key_db_tlv_lru_remove(index);
     } else {
-        // should not happen
-        return;
+        if (free_head == LINK_KEY_DB_TLV_INVALID_INDEX){
+            // evict least recently used entry, tag gets overwritten
+            uint16_t lru_index = lru_head;
+            log_info("link key db full, replace %s", bd_addr_to_str(entries[lru_index].bd_addr));
+            btstack_link_key_db_tlv_remove_entry(btstack_link_key_db_tlv_find(entries[lru_index].bd_addr));
+        }
+        index = free_head;
+        free_head = entries[index].next;
+        // insert into sorted index
+        pos = btstack_link_key_db_tlv_find(bd_addr);
+        pos = -pos - 1;
+        memmove(&sorted_entries[pos+1], &sorted_entries[pos], (num_entries - pos) * sizeof(uint16_t));
+        sorted_entries[pos] = index;
+        num_entries++;
+        entries[index].used = 1;
+        memcpy(entries[index].bd_addr, bd_addr, BD_ADDR_LEN);
     }
+    entries[index].seq_nr = ++highest_seq_nr;
+    btstack_link_key_db_tlv_lru_append(index);
 
+    uint32_t tag_to_use = btstack_link_key_db_tag_for_index(index);
     log_info("store with tag %x", tag_to_use);
 
     link_key_nvm_t entry;
@@ -169,7 +283,7 @@ static void btstack_link_key_db_tlv_put_link_key(bd_addr_t bd_addr, link_key_t l
     memcpy(entry.bd_addr, bd_addr, 6);
     memcpy(entry.link_key, link_key, 16);
     entry.link_key_type = link_key_type;
-    entry.seq_nr = highest_seq_nr + 1;
+    entry.seq_nr = highest_seq_nr;
 
     self->btstack_tlv_impl->store_tag(self->btstack_tlv_context, tag_to_use, (uint8_t*) &entry, sizeof(entry));
 }
@@ -184,6 +298,10 @@ static int  btstack_link_key_db_tlv_iterator_get_next(btstack_link_key_iterator_
     int found = 0;
     while (i<NVM_NUM_LINK_KEYS){
         link_key_nvm_t entry;
+        if (!entries[i].used) {
+            i++;
+            continue;
+        }
         uint32_t tag = btstack_link_key_db_tag_for_index(i++);
         int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
         if (size == 0) continue;
@@ -216,6 +334,7 @@ static const btstack_link_key_db_t btstack_link_key_db_tlv = {
 const btstack_link_key_db_t * btstack_link_key_db_tlv_get_instance(const btstack_tlv_t * btstack_tlv_impl, void * btstack_tlv_context){
     self->btstack_tlv_impl = btstack_tlv_impl;
     self->btstack_tlv_context = btstack_tlv_context;
+    btstack_link_key_db_tlv_scan();
     return &btstack_link_key_db_tlv;
 }
 
@@ -51,9 +51,11 @@
 #include <string.h>
 
 #include "btstack_sbc.h"
+#include "btstack_sbc_encoder_bluedroid.h"
 #include "btstack_sbc_plc.h"
 
 #include "sbc_encoder.h"
+#include "sbc_enc_func_declare.h"
 #include "btstack.h"
 
 #define mSBC_SYNCWORD 0xad
@@ -61,76 +63,91 @@
 #define SBC_MAX_CHANNELS 2
 // #define LOG_FRAME_STATUS
 
-
-typedef struct {
-    SBC_ENC_PARAMS context;
-    int num_data_bytes;
-    uint8_t sbc_packet[1000];
-} bludroid_encoder_state_t;
+// Bluedroid keeps the analysis filter history in globals. It is swapped into the instance
+// that encodes next, so all instances share the same code and tables. 
+extern SINT16 EncMaxShiftCounter;
 
 static btstack_sbc_encoder_state_t * sbc_encoder_state_singleton = NULL;
-static bludroid_encoder_state_t bd_encoder_state;
+static btstack_sbc_encoder_bluedroid_t bd_encoder_state;
 
+// instance whose analysis filter state is currently loaded
+static btstack_sbc_encoder_bluedroid_t * bd_encoder_active = NULL;
 
-void btstack_sbc_encoder_init(btstack_sbc_encoder_state_t * state, btstack_sbc_mode_t mode, 
-                        int blocks, int subbands, int allmethod, int sample_rate, int bitpool, int channel_mode){
+static void btstack_sbc_encoder_bluedroid_store_active(void){
+    if (!bd_encoder_active) return;
+    SbcAnalysisSaveState((SINT16 *) bd_encoder_active->analysis_history, &bd_encoder_active->analysis_shift_counter);
+    bd_encoder_active->analysis_max_shift_counter = EncMaxShiftCounter;
+}
 
-    if (sbc_encoder_state_singleton && sbc_encoder_state_singleton != state ){
-        log_error("SBC encoder: different sbc decoder state is allready registered");
-    } 
-    
-    sbc_encoder_state_singleton = state;
+static void btstack_sbc_encoder_bluedroid_activate(btstack_sbc_encoder_bluedroid_t * encoder){
+    if (bd_encoder_active == encoder) return;
+    btstack_sbc_encoder_bluedroid_store_active();
+    SbcAnalysisRestoreState((const SINT16 *) encoder->analysis_history, encoder->analysis_shift_counter);
+    EncMaxShiftCounter = encoder->analysis_max_shift_counter;
+    bd_encoder_active = encoder;
+}
 
-    if (!sbc_encoder_state_singleton){
+void btstack_sbc_encoder_bluedroid_init(btstack_sbc_encoder_state_t * state, btstack_sbc_encoder_bluedroid_t * encoder, btstack_sbc_mode_t mode, 
+                        int blocks, int subbands, int allmethod, int sample_rate, int bitpool, int channel_mode){
+
+    if (!state || !encoder){
         log_error("SBC encoder init: sbc state is NULL");
+        return;
     }
 
-    sbc_encoder_state_singleton->mode = mode;
+    state->mode = mode;
 
-    switch (sbc_encoder_state_singleton->mode){
+    switch (state->mode){
         case SBC_MODE_STANDARD:
-            bd_encoder_state.context.s16NumOfBlocks = blocks;                          
-            bd_encoder_state.context.s16NumOfSubBands = subbands;                       
-            bd_encoder_state.context.s16AllocationMethod = allmethod;                     
-            bd_encoder_state.context.s16BitPool = bitpool;  
-            bd_encoder_state.context.mSBCEnabled = 0;
-            bd_encoder_state.context.s16ChannelMode = channel_mode;
-            bd_encoder_state.context.s16NumOfChannels = 2;
-            if (bd_encoder_state.context.s16ChannelMode == SBC_MONO){
-                bd_encoder_state.context.s16NumOfChannels = 1;
+            encoder->context.s16NumOfBlocks = blocks;                          
+            encoder->context.s16NumOfSubBands = subbands;                       
+            encoder->context.s16AllocationMethod = allmethod;                     
+            encoder->context.s16BitPool = bitpool;  
+            encoder->context.mSBCEnabled = 0;
+            encoder->context.s16ChannelMode = channel_mode;
+            encoder->context.s16NumOfChannels = 2;
+            if (encoder->context.s16ChannelMode == SBC_MONO){
+                encoder->context.s16NumOfChannels = 1;
             }
             switch(sample_rate){
-                case 16000: bd_encoder_state.context.s16SamplingFreq = SBC_sf16000; break;
-                case 32000: bd_encoder_state.context.s16SamplingFreq = SBC_sf32000; break;
-                case 44100: bd_encoder_state.context.s16SamplingFreq = SBC_sf44100; break;
-                case 48000: bd_encoder_state.context.s16SamplingFreq = SBC_sf48000; break;
-                default: bd_encoder_state.context.s16SamplingFreq = 0; break;
+                case 16000: encoder->context.s16SamplingFreq = SBC_sf16000; break;
+                case 32000: encoder->context.s16SamplingFreq = SBC_sf32000; break;
+                case 44100: encoder->context.s16SamplingFreq = SBC_sf44100; break;
+                case 48000: encoder->context.s16SamplingFreq = SBC_sf48000; break;
+                default: encoder->context.s16SamplingFreq = 0; break;
             }
             break;
         case SBC_MODE_mSBC:
-            bd_encoder_state.context.s16NumOfBlocks    = 15;
-            bd_encoder_state.context.s16NumOfSubBands  = 8;
-            bd_encoder_state.context.s16AllocationMethod = SBC_LOUDNESS;
-            bd_encoder_state.context.s16BitPool   = 26;
-            bd_encoder_state.context.s16ChannelMode = SBC_MONO;
-            bd_encoder_state.context.s16NumOfChannels = 1;
-            bd_encoder_state.context.mSBCEnabled = 1;
-            bd_encoder_state.context.s16SamplingFreq = SBC_sf16000;
+            encoder->context.s16NumOfBlocks    = 15;
+            encoder->context.s16NumOfSubBands  = 8;
+            encoder->context.s16AllocationMethod = SBC_LOUDNESS;
+            encoder->context.s16BitPool   = 26;
+            encoder->context.s16ChannelMode = SBC_MONO;
+            encoder->context.s16NumOfChannels = 1;
+            encoder->context.mSBCEnabled = 1;
+            encoder->context.s16SamplingFreq = SBC_sf16000;
             break;
     }
-    bd_encoder_state.context.pu8Packet = bd_encoder_state.sbc_packet;
+    encoder->context.pu8Packet = encoder->sbc_packet;
     
-    sbc_encoder_state_singleton->encoder_state = &bd_encoder_state;
-    SBC_ENC_PARAMS * context = &((bludroid_encoder_state_t *)sbc_encoder_state_singleton->encoder_state)->context;
-    SBC_Encoder_Init(context);
-}
+    state->encoder_state = encoder;
 
+    // SBC_Encoder_Init resets the shared analysis filter, keep state of previous instance 
+    if (bd_encoder_active != encoder){
+        btstack_sbc_encoder_bluedroid_store_active();
+    }
+    SBC_Encoder_Init(&encoder->context);
+    bd_encoder_active = encoder;
+}
 
-void btstack_sbc_encoder_process_data(int16_t * input_buffer){
-    if (!sbc_encoder_state_singleton){
+void btstack_sbc_encoder_bluedroid_process_data(btstack_sbc_encoder_state_t * state, int16_t * input_buffer){
+    if (!state || !state->encoder_state){
         log_error("SBC encoder: sbc state is NULL, call btstack_sbc_encoder_init to initialize it");
+        return;
     }
-    SBC_ENC_PARAMS * context = &((bludroid_encoder_state_t *)sbc_encoder_state_singleton->encoder_state)->context;
+    btstack_sbc_encoder_bluedroid_t * encoder = (btstack_sbc_encoder_bluedroid_t *) state->encoder_state;
+    btstack_sbc_encoder_bluedroid_activate(encoder);
+    SBC_ENC_PARAMS * context = &encoder->context;
     context->ps16PcmBuffer = input_buffer;
     if (context->mSBCEnabled){
         context->pu8Packet[0] = 0xad;
@@ -138,17 +155,56 @@ void btstack_sbc_encoder_process_data(int16_t * input_buffer){
     SBC_Encoder(context);
 }
 
-int btstack_sbc_encoder_num_audio_frames(void){
-    SBC_ENC_PARAMS * context = &((bludroid_encoder_state_t *)sbc_encoder_state_singleton->encoder_state)->context;
+int btstack_sbc_encoder_bluedroid_num_audio_frames(btstack_sbc_encoder_state_t * state){
+    SBC_ENC_PARAMS * context = &((btstack_sbc_encoder_bluedroid_t *)state->encoder_state)->context;
     return context->s16NumOfSubBands * context->s16NumOfBlocks;
 }
 
-uint8_t * btstack_sbc_encoder_sbc_buffer(void){
-    SBC_ENC_PARAMS * context = &((bludroid_encoder_state_t *)sbc_encoder_state_singleton->encoder_state)->context;
+uint8_t * btstack_sbc_encoder_bluedroid_sbc_buffer(btstack_sbc_encoder_state_t * state){
+    SBC_ENC_PARAMS * context = &((btstack_sbc_encoder_bluedroid_t *)state->encoder_state)->context;
     return context->pu8Packet;
 }
 
-uint16_t  btstack_sbc_encoder_sbc_buffer_length(void){
-    SBC_ENC_PARAMS * context = &((bludroid_encoder_state_t *)sbc_encoder_state_singleton->encoder_state)->context;
+uint16_t  btstack_sbc_encoder_bluedroid_sbc_buffer_length(btstack_sbc_encoder_state_t * state){
+    SBC_ENC_PARAMS * context = &((btstack_sbc_encoder_bluedroid_t *)state->encoder_state)->context;
     return context->u16PacketLength;
 }
+
+// singleton API
+
+void btstack_sbc_encoder_init(btstack_sbc_encoder_state_t * state, btstack_sbc_mode_t mode, 
+                        int blocks, int subbands, int allmethod, int sample_rate, int bitpool, int channel_mode){
+
+    if (sbc_encoder_state_singleton && sbc_encoder_state_singleton != state ){
+        log_error("SBC encoder: different sbc decoder state is allready registered");
+    } 
+    
+    sbc_encoder_state_singleton = state;
+
+    if (!sbc_encoder_state_singleton){
+        log_error("SBC encoder init: sbc state is NULL");
+        return;
+    }
+
+    btstack_sbc_encoder_bluedroid_init(state, &bd_encoder_state, mode, blocks, subbands, allmethod, sample_rate, bitpool, channel_mode);
+}
+
+void btstack_sbc_encoder_process_data(int16_t * input_buffer){
+    if (!sbc_encoder_state_singleton){
+        log_error("SBC encoder: sbc state is NULL, call btstack_sbc_encoder_init to initialize it");
+        return;
+    }
+    btstack_sbc_encoder_bluedroid_process_data(sbc_encoder_state_singleton, input_buffer);
+}
+
+int btstack_sbc_encoder_num_audio_frames(void){
+    return btstack_sbc_encoder_bluedroid_num_audio_frames(sbc_encoder_state_singleton);
+}
+
+uint8_t * btstack_sbc_encoder_sbc_buffer(void){
+    return btstack_sbc_encoder_bluedroid_sbc_buffer(sbc_encoder_state_singleton);
+}
+
+uint16_t  btstack_sbc_encoder_sbc_buffer_length(void){
+    return btstack_sbc_encoder_bluedroid_sbc_buffer_length(sbc_encoder_state_singleton);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+// *****************************************************************************
+//
+// SBC encoder instances based on Bluedroid library
+//
+// *****************************************************************************
+
+#ifndef __BTSTACK_SBC_ENCODER_BLUEDROID_H
+#define __BTSTACK_SBC_ENCODER_BLUEDROID_H
+
+#include <stdint.h>
+
+#include "btstack_sbc.h"
+#include "sbc_encoder.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    SBC_ENC_PARAMS context;
+    int num_data_bytes;
+    uint8_t sbc_packet[1000];
+    // analysis filter history, saved while another instance uses the encoder
+    SINT32 analysis_history[ENC_VX_BUFFER_SIZE/2];
+    SINT16 analysis_shift_counter;
+    SINT16 analysis_max_shift_counter;
+} btstack_sbc_encoder_bluedroid_t;
+
+/* API_START */
+
+/**
+ * @brief Init SBC encoder instance with caller provided storage.
+ * @note  Several instances can be used in parallel, e.g. one per HFP connection. The btstack_sbc_encoder_* 
+ *        functions without state parameter operate on the instance registered via btstack_sbc_encoder_init.
+ * @param state
+ * @param encoder storage
+ * @param mode
+ * @param blocks
+ * @param subbands
+ * @param allocation_method
+ * @param sample_rate
+ * @param bitpool
+ * @param channel_mode
+ */
+void btstack_sbc_encoder_bluedroid_init(btstack_sbc_encoder_state_t * state, btstack_sbc_encoder_bluedroid_t * encoder, btstack_sbc_mode_t mode, 
+                        int blocks, int subbands, int allocation_method, int sample_rate, int bitpool, int channel_mode);
+
+/**
+ * @brief Encode PCM data
+ * @param state
+ * @param buffer with samples in host endianess
+ */
+void btstack_sbc_encoder_bluedroid_process_data(btstack_sbc_encoder_state_t * state, int16_t * input_buffer);
+
+/**
+ * @brief Return SBC frame
+ * @param state
+ */
+uint8_t * btstack_sbc_encoder_bluedroid_sbc_buffer(btstack_sbc_encoder_state_t * state);
+
+/**
+ * @brief Return SBC frame length
+ * @param state
+ */
+uint16_t  btstack_sbc_encoder_bluedroid_sbc_buffer_length(btstack_sbc_encoder_state_t * state);
+
+/**
+ * @brief Return number of audio frames required for one SBC packet
+ * @param state
+ */
+int  btstack_sbc_encoder_bluedroid_num_audio_frames(btstack_sbc_encoder_state_t * state);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __BTSTACK_SBC_ENCODER_BLUEDROID_H
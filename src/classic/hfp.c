@@ -367,11 +367,18 @@ static hfp_connection_t * create_hfp_connection_context(void){
     
     hfp_reset_context_flags(hfp_connection);
 
+#ifdef ENABLE_SCO_OVER_HCI
+    hfp_audio_engine_init(&hfp_connection->audio_engine, NULL, NULL);
+#endif
+
     btstack_linked_list_add(&hfp_connections, (btstack_linked_item_t*)hfp_connection);
     return hfp_connection;
 }
 
 static void remove_hfp_connection_context(hfp_connection_t * hfp_connection){
+#ifdef ENABLE_SCO_OVER_HCI
+    hfp_audio_engine_stop(&hfp_connection->audio_engine);
+#endif
     btstack_linked_list_remove(&hfp_connections, (btstack_linked_item_t*) hfp_connection);
     btstack_memory_hfp_connection_free(hfp_connection);
 }
@@ -657,6 +664,9 @@ void hfp_handle_hci_event(uint8_t packet_type, uint16_t channel, uint8_t *packet
             hfp_connection->sco_handle = sco_handle;
             hfp_connection->establish_audio_connection = 0;
             hfp_connection->state = HFP_AUDIO_CONNECTION_ESTABLISHED;
+#ifdef ENABLE_SCO_OVER_HCI
+            hfp_audio_engine_start(&hfp_connection->audio_engine, sco_handle, hfp_connection->negotiated_codec);
+#endif
             hfp_emit_sco_event(hfp_connection, packet[2], sco_handle, event_addr, hfp_connection->negotiated_codec);
             break;                
         }
@@ -675,6 +685,9 @@ void hfp_handle_hci_event(uint8_t packet_type, uint16_t channel, uint8_t *packet
             if (handle == hfp_connection->sco_handle){
                 log_info("SCO disconnected, w2 disconnect RFCOMM\n");
                 hfp_connection->sco_handle = 0;
+#ifdef ENABLE_SCO_OVER_HCI
+                hfp_audio_engine_stop(&hfp_connection->audio_engine);
+#endif
                 hfp_connection->release_audio_connection = 0;
                 hfp_connection->state = HFP_SERVICE_LEVEL_CONNECTION_ESTABLISHED;
                 hfp_emit_event(hfp_connection, HFP_SUBEVENT_AUDIO_CONNECTION_RELEASED, 0);
@@ -771,42 +784,133 @@ void hfp_handle_rfcomm_event(uint8_t packet_type, uint16_t channel, uint8_t *pac
             break;
     }
 }
-// translates command string into hfp_command_t CMD
-static hfp_command_t parse_command(const char * line_buffer, int isHandsFree){
-    int offset = isHandsFree ? 0 : 2;
+// resolve commands that depend on the characters following the command name
+static hfp_command_t hfp_command_resolve_response_and_hold(const char * suffix, int isHandsFree){
+    UNUSED(isHandsFree);
+    if (suffix[0] == '?') return HFP_CMD_RESPONSE_AND_HOLD_QUERY;
+    if (suffix[0] == '=') return HFP_CMD_RESPONSE_AND_HOLD_COMMAND;
+    return HFP_CMD_RESPONSE_AND_HOLD_STATUS;
+}
 
-    if (strncmp(line_buffer+offset, HFP_LIST_CURRENT_CALLS, strlen(HFP_LIST_CURRENT_CALLS)) == 0){
-        return HFP_CMD_LIST_CURRENT_CALLS;
-    }
+static hfp_command_t hfp_command_resolve_indicator(const char * suffix, int isHandsFree){
+    UNUSED(isHandsFree);
+    if (suffix[0] == '?') return HFP_CMD_RETRIEVE_AG_INDICATORS_STATUS;
+    if (suffix[0] == '=' && suffix[1] == '?') return HFP_CMD_RETRIEVE_AG_INDICATORS;
+    return HFP_CMD_UNKNOWN;
+}
 
-    if (strncmp(line_buffer+offset, HFP_SUBSCRIBER_NUMBER_INFORMATION, strlen(HFP_SUBSCRIBER_NUMBER_INFORMATION)) == 0){
-        return HFP_CMD_GET_SUBSCRIBER_NUMBER_INFORMATION;
-    }
+static hfp_command_t hfp_command_resolve_call_hold(const char * suffix, int isHandsFree){
+    if (isHandsFree) return HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES;
+    if (suffix[0] == '=' && suffix[1] == '?') return HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES;
+    if (suffix[0] == '=') return HFP_CMD_CALL_HOLD;
+    return HFP_CMD_UNKNOWN;
+}
 
-    if (strncmp(line_buffer+offset, HFP_PHONE_NUMBER_FOR_VOICE_TAG, strlen(HFP_PHONE_NUMBER_FOR_VOICE_TAG)) == 0){
-        if (isHandsFree) return HFP_CMD_AG_SENT_PHONE_NUMBER;
-        return HFP_CMD_HF_REQUEST_PHONE_NUMBER;
-    }
+static hfp_command_t hfp_command_resolve_generic_status_indicator(const char * suffix, int isHandsFree){
+    if (isHandsFree) return HFP_CMD_SET_GENERIC_STATUS_INDICATOR_STATUS;
+    if (suffix[0] == '=' && suffix[1] == '?') return HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS;
+    if (suffix[0] == '=') return HFP_CMD_LIST_GENERIC_STATUS_INDICATORS;
+    return HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS_STATE;
+}
 
-    if (strncmp(line_buffer+offset, HFP_TRANSMIT_DTMF_CODES, strlen(HFP_TRANSMIT_DTMF_CODES)) == 0){
-        return HFP_CMD_TRANSMIT_DTMF_CODES;
-    }
+static hfp_command_t hfp_command_resolve_operator_selection(const char * suffix, int isHandsFree){
+    UNUSED(isHandsFree);
+    if (suffix[0] == '=') return HFP_CMD_QUERY_OPERATOR_SELECTION_NAME_FORMAT;
+    return HFP_CMD_QUERY_OPERATOR_SELECTION_NAME;
+}
 
-    if (strncmp(line_buffer+offset, HFP_SET_MICROPHONE_GAIN, strlen(HFP_SET_MICROPHONE_GAIN)) == 0){
-        return HFP_CMD_SET_MICROPHONE_GAIN;
-    }
+typedef struct {
+    // command name without leading '+'
+    const char * name;
+    // command received by HF / by AG, HFP_CMD_NONE if not valid for role
+    uint8_t hf_command;
+    uint8_t ag_command;
+    // optional, resolves command from following characters
+    hfp_command_t (*resolve)(const char * suffix, int isHandsFree);
+} hfp_command_entry_t;
+
+// sorted by name for binary search. As no name is a prefix of another, the entry matching a line is the
+// last one that sorts before or equal to the line
+static const hfp_command_entry_t hfp_command_table[] = {
+    { "BAC",       HFP_CMD_AVAILABLE_CODECS,                         HFP_CMD_AVAILABLE_CODECS,                      NULL },
+    { "BCC",       HFP_CMD_TRIGGER_CODEC_CONNECTION_SETUP,           HFP_CMD_TRIGGER_CODEC_CONNECTION_SETUP,        NULL },
+    { "BCS",       HFP_CMD_AG_SUGGESTED_CODEC,                       HFP_CMD_HF_CONFIRMED_CODEC,                    NULL },
+    { "BIA",       HFP_CMD_ENABLE_INDIVIDUAL_AG_INDICATOR_STATUS_UPDATE, HFP_CMD_ENABLE_INDIVIDUAL_AG_INDICATOR_STATUS_UPDATE, NULL },
+    { "BIEV",      HFP_CMD_HF_INDICATOR_STATUS,                      HFP_CMD_HF_INDICATOR_STATUS,                   NULL },
+    { "BIND",      HFP_CMD_NONE,                                     HFP_CMD_NONE,                                  &hfp_command_resolve_generic_status_indicator },
+    { "BINP",      HFP_CMD_AG_SENT_PHONE_NUMBER,                     HFP_CMD_HF_REQUEST_PHONE_NUMBER,               NULL },
+    { "BLDN",      HFP_CMD_REDIAL_LAST_NUMBER,                       HFP_CMD_REDIAL_LAST_NUMBER,                    NULL },
+    { "BRSF",      HFP_CMD_SUPPORTED_FEATURES,                       HFP_CMD_SUPPORTED_FEATURES,                    NULL },
+    { "BSIR",      HFP_CMD_CHANGE_IN_BAND_RING_TONE_SETTING,         HFP_CMD_CHANGE_IN_BAND_RING_TONE_SETTING,      NULL },
+    { "BTRH",      HFP_CMD_NONE,                                     HFP_CMD_NONE,                                  &hfp_command_resolve_response_and_hold },
+    { "BVRA",      HFP_CMD_AG_ACTIVATE_VOICE_RECOGNITION,            HFP_CMD_HF_ACTIVATE_VOICE_RECOGNITION,         NULL },
+    { "CCWA",      HFP_CMD_AG_SENT_CALL_WAITING_NOTIFICATION_UPDATE, HFP_CMD_ENABLE_CALL_WAITING_NOTIFICATION,      NULL },
+    { "CHLD",      HFP_CMD_NONE,                                     HFP_CMD_NONE,                                  &hfp_command_resolve_call_hold },
+    { "CHUP",      HFP_CMD_HANG_UP_CALL,                             HFP_CMD_HANG_UP_CALL,                          NULL },
+    { "CIEV",      HFP_CMD_TRANSFER_AG_INDICATOR_STATUS,             HFP_CMD_TRANSFER_AG_INDICATOR_STATUS,          NULL },
+    { "CIND",      HFP_CMD_NONE,                                     HFP_CMD_NONE,                                  &hfp_command_resolve_indicator },
+    { "CLCC",      HFP_CMD_LIST_CURRENT_CALLS,                       HFP_CMD_LIST_CURRENT_CALLS,                    NULL },
+    { "CLIP",      HFP_CMD_AG_SENT_CLIP_INFORMATION,                 HFP_CMD_ENABLE_CLIP,                           NULL },
+    { "CME ERROR", HFP_CMD_EXTENDED_AUDIO_GATEWAY_ERROR,             HFP_CMD_NONE,                                  NULL },
+    { "CMEE",      HFP_CMD_NONE,                                     HFP_CMD_ENABLE_EXTENDED_AUDIO_GATEWAY_ERROR,   NULL },
+    { "CMER",      HFP_CMD_ENABLE_INDICATOR_STATUS_UPDATE,           HFP_CMD_ENABLE_INDICATOR_STATUS_UPDATE,        NULL },
+    { "CNUM",      HFP_CMD_GET_SUBSCRIBER_NUMBER_INFORMATION,        HFP_CMD_GET_SUBSCRIBER_NUMBER_INFORMATION,     NULL },
+    { "COPS",      HFP_CMD_NONE,                                     HFP_CMD_NONE,                                  &hfp_command_resolve_operator_selection },
+    { "NREC",      HFP_CMD_TURN_OFF_EC_AND_NR,                       HFP_CMD_TURN_OFF_EC_AND_NR,                    NULL },
+    { "VGM",       HFP_CMD_SET_MICROPHONE_GAIN,                      HFP_CMD_SET_MICROPHONE_GAIN,                   NULL },
+    { "VGS",       HFP_CMD_SET_SPEAKER_GAIN,                         HFP_CMD_SET_SPEAKER_GAIN,                      NULL },
+    { "VTS",       HFP_CMD_TRANSMIT_DTMF_CODES,                      HFP_CMD_TRANSMIT_DTMF_CODES,                   NULL },
+};
 
-    if (strncmp(line_buffer+offset, HFP_SET_SPEAKER_GAIN, strlen(HFP_SET_SPEAKER_GAIN)) == 0){
-        return HFP_CMD_SET_SPEAKER_GAIN;
+// returns length of name if line starts with it, 0 otherwise. Sets *order to comparison of name with line
+static int hfp_command_name_match(const char * name, const char * line, int * order){
+    int pos = 0;
+    while (name[pos]){
+        if (name[pos] != line[pos]){
+            *order = (uint8_t) name[pos] < (uint8_t) line[pos] ? -1 : 1;
+            return 0;
+        }
+        pos++;
     }
-    
-    if (strncmp(line_buffer+offset, HFP_ACTIVATE_VOICE_RECOGNITION, strlen(HFP_ACTIVATE_VOICE_RECOGNITION)) == 0){
-        if (isHandsFree) return HFP_CMD_AG_ACTIVATE_VOICE_RECOGNITION;
-        return HFP_CMD_HF_ACTIVATE_VOICE_RECOGNITION;
+    *order = 0;
+    return pos;
+}
+
+// translates command name after '+' into hfp_command_t CMD with binary search over hfp_command_table
+static hfp_command_t hfp_command_lookup(const char * line, int isHandsFree){
+    int left  = 0;
+    int right = sizeof(hfp_command_table) / sizeof(hfp_command_entry_t);
+    while (left < right){
+        int middle = (left + right) / 2;
+        const hfp_command_entry_t * entry = &hfp_command_table[middle];
+        int order;
+        int len = hfp_command_name_match(entry->name, line, &order);
+        if (len){
+            if (entry->resolve) return (*entry->resolve)(&line[len], isHandsFree);
+            hfp_command_t command = (hfp_command_t) (isHandsFree ? entry->hf_command : entry->ag_command);
+            if (command == HFP_CMD_NONE) return HFP_CMD_UNKNOWN;
+            return command;
+        }
+        if (order < 0){
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
     }
+    return HFP_CMD_UNKNOWN;
+}
 
-    if (strncmp(line_buffer+offset, HFP_TURN_OFF_EC_AND_NR, strlen(HFP_TURN_OFF_EC_AND_NR)) == 0){
-        return HFP_CMD_TURN_OFF_EC_AND_NR;
+// translates command string into hfp_command_t CMD
+static hfp_command_t parse_command(const char * line_buffer, int isHandsFree){
+    int offset = isHandsFree ? 0 : 2;
+    const char * line = line_buffer + offset;
+
+    if (line[0] == '+'){
+        hfp_command_t command = hfp_command_lookup(&line[1], isHandsFree);
+        if (command == HFP_CMD_UNKNOWN){
+            log_info(" process unknown AG command %s \n", line_buffer);
+        }
+        return command;
     }
 
     if (strncmp(line_buffer, HFP_ANSWER_CALL, strlen(HFP_ANSWER_CALL)) == 0){
@@ -817,153 +921,23 @@ static hfp_command_t parse_command(const char * line_buffer, int isHandsFree){
         return HFP_CMD_CALL_PHONE_NUMBER;
     }
 
-    if (strncmp(line_buffer+offset, HFP_REDIAL_LAST_NUMBER, strlen(HFP_REDIAL_LAST_NUMBER)) == 0){
-        return HFP_CMD_REDIAL_LAST_NUMBER;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_CHANGE_IN_BAND_RING_TONE_SETTING, strlen(HFP_CHANGE_IN_BAND_RING_TONE_SETTING)) == 0){
-        return HFP_CMD_CHANGE_IN_BAND_RING_TONE_SETTING;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_HANG_UP_CALL, strlen(HFP_HANG_UP_CALL)) == 0){
-        return HFP_CMD_HANG_UP_CALL;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_ERROR, strlen(HFP_ERROR)) == 0){
+    if (strncmp(line, HFP_ERROR, strlen(HFP_ERROR)) == 0){
         return HFP_CMD_ERROR;
     }
 
-    if (strncmp(line_buffer+offset, HFP_RING, strlen(HFP_RING)) == 0){
+    if (strncmp(line, HFP_RING, strlen(HFP_RING)) == 0){
         return HFP_CMD_RING;
     }
 
-    if (isHandsFree && strncmp(line_buffer+offset, HFP_OK, strlen(HFP_OK)) == 0){
+    if (isHandsFree && strncmp(line, HFP_OK, strlen(HFP_OK)) == 0){
         return HFP_CMD_OK;
     }
 
-    if (strncmp(line_buffer+offset, HFP_SUPPORTED_FEATURES, strlen(HFP_SUPPORTED_FEATURES)) == 0){
-        return HFP_CMD_SUPPORTED_FEATURES;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_TRANSFER_HF_INDICATOR_STATUS, strlen(HFP_TRANSFER_HF_INDICATOR_STATUS)) == 0){
-        return HFP_CMD_HF_INDICATOR_STATUS;
-    }
-    
-    if (strncmp(line_buffer+offset, HFP_RESPONSE_AND_HOLD, strlen(HFP_RESPONSE_AND_HOLD)) == 0){
-        if (strncmp(line_buffer+strlen(HFP_RESPONSE_AND_HOLD)+offset, "?", 1) == 0){
-            return HFP_CMD_RESPONSE_AND_HOLD_QUERY;
-        }
-        if (strncmp(line_buffer+strlen(HFP_RESPONSE_AND_HOLD)+offset, "=", 1) == 0){
-            return HFP_CMD_RESPONSE_AND_HOLD_COMMAND;
-        }
-        return HFP_CMD_RESPONSE_AND_HOLD_STATUS;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_INDICATOR, strlen(HFP_INDICATOR)) == 0){
-        if (strncmp(line_buffer+strlen(HFP_INDICATOR)+offset, "?", 1) == 0){
-            return HFP_CMD_RETRIEVE_AG_INDICATORS_STATUS;
-        }
-
-        if (strncmp(line_buffer+strlen(HFP_INDICATOR)+offset, "=?", 2) == 0){
-            return HFP_CMD_RETRIEVE_AG_INDICATORS;
-        }
-    }
-
-    if (strncmp(line_buffer+offset, HFP_AVAILABLE_CODECS, strlen(HFP_AVAILABLE_CODECS)) == 0){
-        return HFP_CMD_AVAILABLE_CODECS;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_ENABLE_STATUS_UPDATE_FOR_AG_INDICATORS, strlen(HFP_ENABLE_STATUS_UPDATE_FOR_AG_INDICATORS)) == 0){
-        return HFP_CMD_ENABLE_INDICATOR_STATUS_UPDATE;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_ENABLE_CLIP, strlen(HFP_ENABLE_CLIP)) == 0){
-        if (isHandsFree) return HFP_CMD_AG_SENT_CLIP_INFORMATION;
-        return HFP_CMD_ENABLE_CLIP;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_ENABLE_CALL_WAITING_NOTIFICATION, strlen(HFP_ENABLE_CALL_WAITING_NOTIFICATION)) == 0){
-        if (isHandsFree) return HFP_CMD_AG_SENT_CALL_WAITING_NOTIFICATION_UPDATE;
-        return HFP_CMD_ENABLE_CALL_WAITING_NOTIFICATION;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES, strlen(HFP_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES)) == 0){
-        
-        if (isHandsFree) return HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES;
-
-        if (strncmp(line_buffer+strlen(HFP_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES)+offset, "=?", 2) == 0){
-            return HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES;
-        }
-        if (strncmp(line_buffer+strlen(HFP_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES)+offset, "=", 1) == 0){
-            return HFP_CMD_CALL_HOLD;    
-        }
-
-        return HFP_CMD_UNKNOWN;
-    } 
-
-    if (strncmp(line_buffer+offset, HFP_GENERIC_STATUS_INDICATOR, strlen(HFP_GENERIC_STATUS_INDICATOR)) == 0){
-        if (isHandsFree) {
-            return HFP_CMD_SET_GENERIC_STATUS_INDICATOR_STATUS;
-        }
-        if (strncmp(line_buffer+strlen(HFP_GENERIC_STATUS_INDICATOR)+offset, "=?", 2) == 0){
-            return HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS;
-        } 
-        if (strncmp(line_buffer+strlen(HFP_GENERIC_STATUS_INDICATOR)+offset, "=", 1) == 0){
-            return HFP_CMD_LIST_GENERIC_STATUS_INDICATORS;    
-        }
-        return HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS_STATE;
-    } 
-
-    if (strncmp(line_buffer+offset, HFP_UPDATE_ENABLE_STATUS_FOR_INDIVIDUAL_AG_INDICATORS, strlen(HFP_UPDATE_ENABLE_STATUS_FOR_INDIVIDUAL_AG_INDICATORS)) == 0){
-        return HFP_CMD_ENABLE_INDIVIDUAL_AG_INDICATOR_STATUS_UPDATE;
-    } 
-    
-
-    if (strncmp(line_buffer+offset, HFP_QUERY_OPERATOR_SELECTION, strlen(HFP_QUERY_OPERATOR_SELECTION)) == 0){
-        if (strncmp(line_buffer+strlen(HFP_QUERY_OPERATOR_SELECTION)+offset, "=", 1) == 0){
-            return HFP_CMD_QUERY_OPERATOR_SELECTION_NAME_FORMAT;
-        } 
-        return HFP_CMD_QUERY_OPERATOR_SELECTION_NAME;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_TRANSFER_AG_INDICATOR_STATUS, strlen(HFP_TRANSFER_AG_INDICATOR_STATUS)) == 0){
-        return HFP_CMD_TRANSFER_AG_INDICATOR_STATUS;
-    } 
-
-    if (isHandsFree && strncmp(line_buffer+offset, HFP_EXTENDED_AUDIO_GATEWAY_ERROR, strlen(HFP_EXTENDED_AUDIO_GATEWAY_ERROR)) == 0){
-        return HFP_CMD_EXTENDED_AUDIO_GATEWAY_ERROR;
-    }
-
-    if (!isHandsFree && strncmp(line_buffer+offset, HFP_ENABLE_EXTENDED_AUDIO_GATEWAY_ERROR, strlen(HFP_ENABLE_EXTENDED_AUDIO_GATEWAY_ERROR)) == 0){
-        return HFP_CMD_ENABLE_EXTENDED_AUDIO_GATEWAY_ERROR;
-    }
-
-    if (strncmp(line_buffer+offset, HFP_TRIGGER_CODEC_CONNECTION_SETUP, strlen(HFP_TRIGGER_CODEC_CONNECTION_SETUP)) == 0){
-        return HFP_CMD_TRIGGER_CODEC_CONNECTION_SETUP;
-    } 
-
-    if (strncmp(line_buffer+offset, HFP_CONFIRM_COMMON_CODEC, strlen(HFP_CONFIRM_COMMON_CODEC)) == 0){
-        if (isHandsFree){
-            return HFP_CMD_AG_SUGGESTED_CODEC;
-        } else {
-            return HFP_CMD_HF_CONFIRMED_CODEC;
-        }
-    } 
-    
-    if (strncmp(line_buffer+offset, "AT+", 3) == 0){
+    if (strncmp(line, "AT+", 3) == 0){
         log_info("process unknown HF command %s \n", line_buffer);
         return HFP_CMD_UNKNOWN;
     } 
-    
-    if (strncmp(line_buffer+offset, "+", 1) == 0){
-        log_info(" process unknown AG command %s \n", line_buffer);
-        return HFP_CMD_UNKNOWN;
-    }
-    
-    if (strncmp(line_buffer+offset, "NOP", 3) == 0){
-        return HFP_CMD_NONE;
-    } 
-    
+
     return HFP_CMD_NONE;
 }
 
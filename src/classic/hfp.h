@@ -48,6 +48,10 @@
 #include "hci.h"
 #include "classic/sdp_client_rfcomm.h"
 
+#ifdef ENABLE_SCO_OVER_HCI
+#include "classic/hfp_audio_engine.h"
+#endif
+
 #if defined __cplusplus
 extern "C" {
 #endif
@@ -486,6 +490,10 @@ typedef struct hfp_connection {
     bd_addr_t remote_addr;
     hci_con_handle_t acl_handle;
     hci_con_handle_t sco_handle;
+#ifdef ENABLE_SCO_OVER_HCI
+    // started while SCO connection exists
+    hfp_audio_engine_t audio_engine;
+#endif
     uint16_t rfcomm_channel_nr;
     uint16_t rfcomm_cid;
     
@@ -2163,6 +2163,17 @@ void hfp_ag_release_audio_connection(hci_con_handle_t acl_handle){
     hfp_run_for_context(hfp_connection);
 }
 
+#ifdef ENABLE_SCO_OVER_HCI
+hfp_audio_engine_t * hfp_ag_get_audio_engine(hci_con_handle_t acl_handle){
+    hfp_connection_t * hfp_connection = get_hfp_ag_connection_context_for_acl_handle(acl_handle);
+    if (!hfp_connection){
+        log_error("HFP AG: ACL connection 0x%2x is not found.", acl_handle);
+        return NULL;
+    }
+    return &hfp_connection->audio_engine;
+}
+#endif
+
 /**
  * @brief Enable in-band ring tone
  */
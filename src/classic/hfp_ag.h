@@ -168,6 +168,16 @@ void hfp_ag_establish_audio_connection(hci_con_handle_t acl_handle);
  */
 void hfp_ag_release_audio_connection(hci_con_handle_t acl_handle);
 
+#ifdef ENABLE_SCO_OVER_HCI
+/**
+ * @brief Get audio engine of the connection. It is started on HFP_SUBEVENT_AUDIO_CONNECTION_ESTABLISHED
+ * with the negotiated codec and stopped on HFP_SUBEVENT_AUDIO_CONNECTION_RELEASED.
+ * @param acl_handle of the HF
+ * @return engine or NULL if connection not found
+ */
+hfp_audio_engine_t * hfp_ag_get_audio_engine(hci_con_handle_t acl_handle);
+#endif
+
 /**
  * @brief Put the current call on hold, if it exists, and accept incoming call. 
  */
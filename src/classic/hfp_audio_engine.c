@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hfp_audio_engine.c"
+ 
+// *****************************************************************************
+//
+// HFP audio engine: per-connection mSBC/CVSD encode, decode and PLC
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <string.h>
+
+#include "btstack_debug.h"
+#include "btstack_util.h"
+#include "classic/hfp.h"
+#include "classic/hfp_audio_engine.h"
+
+#define MSBC_SYNCWORD 0xad
+#define MSBC_HEADER_H2_SIZE 2
+
+#define CVSD_SAMPLE_RATE 8000
+#define MSBC_SAMPLE_RATE 16000
+
+// largest chunk of samples forwarded to a bridged call at once (mSBC frame upsampled)
+#define BRIDGE_MAX_SAMPLES (2 * HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME)
+
+static const uint8_t msbc_header_h2_byte_0         = 1;
+static const uint8_t msbc_header_h2_byte_1_table[] = { 0x08, 0x38, 0xc8, 0xf8 };
+
+static btstack_linked_list_t hfp_audio_engines;
+
+static int16_t hfp_audio_engine_saturate(int32_t value){
+    if (value >  32767) return  32767;
+    if (value < -32768) return -32768;
+    return (int16_t) value;
+}
+
+// H2 header: 0x01 followed by sequence number with redundancy bits, returns sequence number or -1
+static int hfp_audio_engine_h2_sequence_number(const uint8_t * header){
+    if (header[0] != msbc_header_h2_byte_0) return -1;
+    int i;
+    for (i=0;i<4;i++){
+        if (header[1] == msbc_header_h2_byte_1_table[i]) return i;
+    }
+    return -1;
+}
+
+static int hfp_audio_engine_pcm_write(btstack_ring_buffer_t * ring_buffer, const int16_t * samples, int num_samples){
+    int num_samples_free = btstack_ring_buffer_bytes_free(ring_buffer) / 2;
+    if (num_samples > num_samples_free){
+        num_samples = num_samples_free;
+    }
+    if (num_samples == 0) return 0;
+    btstack_ring_buffer_write(ring_buffer, (uint8_t *) samples, num_samples * 2);
+    return num_samples;
+}
+
+static int hfp_audio_engine_pcm_read(btstack_ring_buffer_t * ring_buffer, int16_t * samples, int num_samples){
+    uint32_t bytes_read = 0;
+    btstack_ring_buffer_read(ring_buffer, (uint8_t *) samples, num_samples * 2, &bytes_read);
+    return bytes_read / 2;
+}
+
+// forward decoded audio to bridged call, converting between 8 and 16 kHz if needed
+static void hfp_audio_engine_bridge_write(hfp_audio_engine_t * engine, const int16_t * samples, int num_samples, int sample_rate){
+    hfp_audio_engine_t * peer = engine->bridge;
+    if (!peer || !peer->sample_rate) return;
+    if (peer->sample_rate == sample_rate){
+        hfp_audio_engine_pcm_write(&peer->tx_bridge_buffer, samples, num_samples);
+        return;
+    }
+    int16_t converted[BRIDGE_MAX_SAMPLES];
+    int num_converted = 0;
+    int i;
+    if (peer->sample_rate > sample_rate){
+        // 8 -> 16 kHz: sample and hold
+        num_samples = btstack_min(num_samples, BRIDGE_MAX_SAMPLES / 2);
+        for (i=0;i<num_samples;i++){
+            converted[num_converted++] = samples[i];
+            converted[num_converted++] = samples[i];
+        }
+    } else {
+        // 16 -> 8 kHz: average pairs
+        num_samples = btstack_min(num_samples, BRIDGE_MAX_SAMPLES * 2);
+        for (i=0;i+1<num_samples;i+=2){
+            converted[num_converted++] = (int16_t) (((int32_t) samples[i] + samples[i+1]) / 2);
+        }
+    }
+    hfp_audio_engine_pcm_write(&peer->tx_bridge_buffer, converted, num_converted);
+}
+
+static void hfp_audio_engine_emit_pcm(hfp_audio_engine_t * engine, int16_t * samples, int num_samples, int sample_rate){
+    hfp_audio_engine_bridge_write(engine, samples, num_samples, sample_rate);
+    if (!engine->pcm_handler) return;
+    (*engine->pcm_handler)(engine, samples, num_samples, sample_rate, engine->pcm_context);
+}
+
+static void hfp_audio_engine_handle_decoded_msbc(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context){
+    UNUSED(num_channels);
+    hfp_audio_engine_emit_pcm((hfp_audio_engine_t *) context, data, num_samples, sample_rate);
+}
+
+// collect next outgoing audio frame from application, bridged call and mixing hook
+static void hfp_audio_engine_next_tx_frame(hfp_audio_engine_t * engine, int16_t * samples, int num_samples){
+    int num_local = hfp_audio_engine_pcm_read(&engine->tx_pcm_buffer, samples, num_samples);
+    if (num_local < num_samples){
+        memset(&samples[num_local], 0, (num_samples - num_local) * 2);
+    }
+
+    int num_bridged = 0;
+    if (btstack_ring_buffer_bytes_available(&engine->tx_bridge_buffer)){
+        int16_t bridged[HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME];
+        int offset = 0;
+        while (offset < num_samples){
+            int num_chunk = btstack_min(num_samples - offset, HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME);
+            int num_read  = hfp_audio_engine_pcm_read(&engine->tx_bridge_buffer, bridged, num_chunk);
+            int i;
+            for (i=0;i<num_read;i++){
+                samples[offset+i] = hfp_audio_engine_saturate((int32_t) samples[offset+i] + bridged[i]);
+            }
+            num_bridged += num_read;
+            offset += num_chunk;
+            if (num_read < num_chunk) break;
+        }
+    }
+
+    if (num_local < num_samples && num_bridged < num_samples){
+        engine->stats.tx_underruns++;
+    }
+
+    if (!engine->mix_handler) return;
+    (*engine->mix_handler)(engine, samples, num_samples, engine->sample_rate, engine->mix_context);
+}
+
+static void hfp_audio_engine_msbc_encode_frame(hfp_audio_engine_t * engine){
+    int16_t samples[HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME];
+    hfp_audio_engine_next_tx_frame(engine, samples, HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME);
+    hfp_msbc_encode_audio_frame(&engine->msbc_encoder, samples);
+    engine->stats.frames_encoded++;
+}
+
+static void hfp_audio_engine_msbc_fill_payload(hfp_audio_engine_t * engine, uint8_t * payload, uint16_t size){
+    uint16_t pos = 0;
+    while (pos < size){
+        if (hfp_msbc_num_bytes_in_stream(&engine->msbc_encoder) == 0){
+            hfp_audio_engine_msbc_encode_frame(engine);
+        }
+        uint16_t bytes_to_copy = btstack_min(size - pos, hfp_msbc_num_bytes_in_stream(&engine->msbc_encoder));
+        hfp_msbc_read_from_stream(&engine->msbc_encoder, &payload[pos], bytes_to_copy);
+        pos += bytes_to_copy;
+    }
+}
+
+static void hfp_audio_engine_cvsd_fill_payload(hfp_audio_engine_t * engine, uint8_t * payload, uint16_t size){
+    int16_t samples[HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME];
+    uint16_t num_samples = size / 2;
+    uint16_t pos = 0;
+    while (pos < num_samples){
+        int num_chunk = btstack_min(num_samples - pos, HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME);
+        hfp_audio_engine_next_tx_frame(engine, samples, num_chunk);
+        int i;
+        for (i=0;i<num_chunk;i++){
+            little_endian_store_16(payload, (pos + i) * 2, (uint16_t) samples[i]);
+        }
+        pos += num_chunk;
+    }
+    engine->stats.frames_encoded++;
+}
+
+static void hfp_audio_engine_msbc_consume(hfp_audio_engine_t * engine, uint16_t num_bytes){
+    memmove(engine->msbc_rx_buffer, &engine->msbc_rx_buffer[num_bytes], engine->msbc_rx_offset - num_bytes);
+    engine->msbc_rx_offset -= num_bytes;
+    if (engine->msbc_rx_bad_bytes > num_bytes){
+        engine->msbc_rx_bad_bytes -= num_bytes;
+    } else {
+        engine->msbc_rx_bad_bytes = 0;
+    }
+}
+
+static void hfp_audio_engine_msbc_decode_frames(hfp_audio_engine_t * engine){
+    uint8_t * buffer = engine->msbc_rx_buffer;
+    while (1){
+        if (!engine->msbc_rx_synced){
+            // search H2 header followed by mSBC syncword
+            int pos;
+            int found = -1;
+            for (pos=0; pos + MSBC_HEADER_H2_SIZE < engine->msbc_rx_offset; pos++){
+                if (hfp_audio_engine_h2_sequence_number(&buffer[pos]) < 0) continue;
+                if (buffer[pos + MSBC_HEADER_H2_SIZE] != MSBC_SYNCWORD) continue;
+                found = pos;
+                break;
+            }
+            if (found < 0){
+                // keep last bytes, they might be the start of the next header
+                if (engine->msbc_rx_offset > MSBC_HEADER_H2_SIZE){
+                    hfp_audio_engine_msbc_consume(engine, engine->msbc_rx_offset - MSBC_HEADER_H2_SIZE);
+                }
+                return;
+            }
+            hfp_audio_engine_msbc_consume(engine, found);
+            engine->msbc_rx_synced = 1;
+            engine->msbc_rx_sequence_number = hfp_audio_engine_h2_sequence_number(buffer);
+        }
+
+        if (engine->msbc_rx_offset < HFP_AUDIO_ENGINE_MSBC_STREAM_FRAME_SIZE) return;
+
+        int bad_frame = engine->msbc_rx_bad_bytes > 0;
+        int sequence_number = hfp_audio_engine_h2_sequence_number(buffer);
+        if (sequence_number < 0 || buffer[MSBC_HEADER_H2_SIZE] != MSBC_SYNCWORD){
+            if (!bad_frame){
+                // H2 header missing in data reported as good: conceal frame and re-sync
+                log_info("mSBC: H2 sync lost");
+                engine->stats.h2_sync_lost++;
+                engine->msbc_rx_synced = 0;
+                btstack_sbc_decoder_process_data(&engine->msbc_decoder_state, 1, &buffer[MSBC_HEADER_H2_SIZE], HFP_AUDIO_ENGINE_MSBC_FRAME_SIZE);
+                hfp_audio_engine_msbc_consume(engine, 1);
+                continue;
+            }
+            // frame reported as erroneous, stay in sync
+            sequence_number = engine->msbc_rx_sequence_number;
+        } else if (sequence_number != engine->msbc_rx_sequence_number){
+            engine->stats.h2_sequence_errors++;
+        }
+        engine->msbc_rx_sequence_number = (sequence_number + 1) & 3;
+
+        btstack_sbc_decoder_process_data(&engine->msbc_decoder_state, bad_frame, &buffer[MSBC_HEADER_H2_SIZE], HFP_AUDIO_ENGINE_MSBC_FRAME_SIZE);
+        hfp_audio_engine_msbc_consume(engine, HFP_AUDIO_ENGINE_MSBC_STREAM_FRAME_SIZE);
+    }
+}
+
+static void hfp_audio_engine_msbc_receive(hfp_audio_engine_t * engine, int packet_status_flag, const uint8_t * data, uint16_t size){
+    while (size){
+        uint16_t bytes_to_copy = btstack_min(size, sizeof(engine->msbc_rx_buffer) - engine->msbc_rx_offset);
+        memcpy(&engine->msbc_rx_buffer[engine->msbc_rx_offset], data, bytes_to_copy);
+        engine->msbc_rx_offset += bytes_to_copy;
+        if (packet_status_flag){
+            engine->msbc_rx_bad_bytes = engine->msbc_rx_offset;
+        }
+        data += bytes_to_copy;
+        size -= bytes_to_copy;
+        hfp_audio_engine_msbc_decode_frames(engine);
+    }
+}
+
+static void hfp_audio_engine_cvsd_receive(hfp_audio_engine_t * engine, int packet_status_flag, const uint8_t * data, uint16_t size){
+    int16_t samples_out[HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME];
+    uint16_t num_samples = size / 2;
+    uint16_t i;
+    for (i=0;i<num_samples;i++){
+        engine->cvsd_rx_frame[engine->cvsd_rx_samples++] = (int16_t) little_endian_read_16(data, i * 2);
+        if (packet_status_flag){
+            engine->cvsd_rx_bad = 1;
+        }
+        if (engine->cvsd_rx_samples < HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME) continue;
+
+        // PLC detects lost frames by constant signal
+        if (engine->cvsd_rx_bad){
+            memset(engine->cvsd_rx_frame, 0, sizeof(engine->cvsd_rx_frame));
+        }
+        btstack_cvsd_plc_process_data(&engine->cvsd_plc_state, engine->cvsd_rx_frame, HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME, samples_out);
+        hfp_audio_engine_emit_pcm(engine, samples_out, HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME, CVSD_SAMPLE_RATE);
+        engine->cvsd_rx_samples = 0;
+        engine->cvsd_rx_bad = 0;
+    }
+}
+
+static void hfp_audio_engine_reset_buffers(hfp_audio_engine_t * engine){
+    btstack_ring_buffer_init(&engine->tx_pcm_buffer, engine->tx_pcm_storage, sizeof(engine->tx_pcm_storage));
+    btstack_ring_buffer_init(&engine->tx_bridge_buffer, engine->tx_bridge_storage, sizeof(engine->tx_bridge_storage));
+    engine->msbc_rx_offset = 0;
+    engine->msbc_rx_bad_bytes = 0;
+    engine->msbc_rx_synced = 0;
+    engine->msbc_rx_sequence_number = 0;
+    engine->cvsd_rx_samples = 0;
+    engine->cvsd_rx_bad = 0;
+}
+
+void hfp_audio_engine_init(hfp_audio_engine_t * engine, hfp_audio_engine_pcm_handler_t pcm_handler, void * context){
+    memset(engine, 0, sizeof(hfp_audio_engine_t));
+    engine->pcm_handler = pcm_handler;
+    engine->pcm_context = context;
+    engine->sco_handle  = HCI_CON_HANDLE_INVALID;
+    hfp_audio_engine_reset_buffers(engine);
+}
+
+void hfp_audio_engine_set_pcm_handler(hfp_audio_engine_t * engine, hfp_audio_engine_pcm_handler_t pcm_handler, void * context){
+    engine->pcm_handler = pcm_handler;
+    engine->pcm_context = context;
+}
+
+void hfp_audio_engine_start(hfp_audio_engine_t * engine, hci_con_handle_t sco_handle, uint8_t codec){
+    btstack_linked_list_remove(&hfp_audio_engines, (btstack_linked_item_t *) engine);
+
+    engine->sco_handle = sco_handle;
+    engine->codec = codec;
+    memset(&engine->stats, 0, sizeof(hfp_audio_engine_stats_t));
+    hfp_audio_engine_reset_buffers(engine);
+
+    switch (codec){
+        case HFP_CODEC_MSBC:
+            engine->sample_rate = MSBC_SAMPLE_RATE;
+            hfp_msbc_init(&engine->msbc_encoder);
+            btstack_sbc_decoder_bluedroid_init(&engine->msbc_decoder_state, &engine->msbc_decoder, SBC_MODE_mSBC, &hfp_audio_engine_handle_decoded_msbc, engine);
+            break;
+        case HFP_CODEC_CVSD:
+            engine->sample_rate = CVSD_SAMPLE_RATE;
+            btstack_cvsd_plc_init(&engine->cvsd_plc_state);
+            break;
+        default:
+            log_error("HFP audio engine: unsupported codec %u", codec);
+            engine->sample_rate = 0;
+            return;
+    }
+
+    btstack_linked_list_add(&hfp_audio_engines, (btstack_linked_item_t *) engine);
+}
+
+void hfp_audio_engine_stop(hfp_audio_engine_t * engine){
+    hfp_audio_engine_unbridge(engine);
+    btstack_linked_list_remove(&hfp_audio_engines, (btstack_linked_item_t *) engine);
+    engine->sco_handle = HCI_CON_HANDLE_INVALID;
+    engine->sample_rate = 0;
+}
+
+hfp_audio_engine_t * hfp_audio_engine_for_sco_handle(hci_con_handle_t sco_handle){
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &hfp_audio_engines);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        hfp_audio_engine_t * engine = (hfp_audio_engine_t *) btstack_linked_list_iterator_next(&it);
+        if (engine->sco_handle == sco_handle) return engine;
+    }
+    return NULL;
+}
+
+int hfp_audio_engine_sample_rate(hfp_audio_engine_t * engine){
+    return engine->sample_rate;
+}
+
+int hfp_audio_engine_write_pcm(hfp_audio_engine_t * engine, const int16_t * samples, int num_samples){
+    return hfp_audio_engine_pcm_write(&engine->tx_pcm_buffer, samples, num_samples);
+}
+
+void hfp_audio_engine_set_mix_handler(hfp_audio_engine_t * engine, hfp_audio_engine_mix_handler_t mix_handler, void * context){
+    engine->mix_handler = mix_handler;
+    engine->mix_context = context;
+}
+
+void hfp_audio_engine_bridge(hfp_audio_engine_t * engine_a, hfp_audio_engine_t * engine_b){
+    if (engine_a == engine_b) return;
+    hfp_audio_engine_unbridge(engine_a);
+    hfp_audio_engine_unbridge(engine_b);
+    engine_a->bridge = engine_b;
+    engine_b->bridge = engine_a;
+}
+
+void hfp_audio_engine_unbridge(hfp_audio_engine_t * engine){
+    hfp_audio_engine_t * peer = engine->bridge;
+    engine->bridge = NULL;
+    btstack_ring_buffer_init(&engine->tx_bridge_buffer, engine->tx_bridge_storage, sizeof(engine->tx_bridge_storage));
+    if (!peer) return;
+    peer->bridge = NULL;
+    btstack_ring_buffer_init(&peer->tx_bridge_buffer, peer->tx_bridge_storage, sizeof(peer->tx_bridge_storage));
+}
+
+void hfp_audio_engine_receive_sco_packet(hfp_audio_engine_t * engine, uint8_t * packet, uint16_t size){
+    if (size < 3) return;
+    int packet_status_flag = (packet[1] >> 4) & 3;
+    uint16_t payload_size = btstack_min(size - 3, packet[2]);
+    switch (engine->codec){
+        case HFP_CODEC_MSBC:
+            hfp_audio_engine_msbc_receive(engine, packet_status_flag, &packet[3], payload_size);
+            break;
+        case HFP_CODEC_CVSD:
+            hfp_audio_engine_cvsd_receive(engine, packet_status_flag, &packet[3], payload_size);
+            break;
+        default:
+            break;
+    }
+}
+
+void hfp_audio_engine_fill_sco_payload(hfp_audio_engine_t * engine, uint8_t * payload, uint16_t size){
+    switch (engine->codec){
+        case HFP_CODEC_MSBC:
+            hfp_audio_engine_msbc_fill_payload(engine, payload, size);
+            break;
+        case HFP_CODEC_CVSD:
+            hfp_audio_engine_cvsd_fill_payload(engine, payload, size);
+            break;
+        default:
+            memset(payload, 0, size);
+            break;
+    }
+}
+
+void hfp_audio_engine_get_stats(hfp_audio_engine_t * engine, hfp_audio_engine_stats_t * stats){
+    *stats = engine->stats;
+    switch (engine->codec){
+        case HFP_CODEC_MSBC:
+            stats->frames_decoded   = engine->msbc_decoder_state.good_frames_nr;
+            stats->frames_concealed = engine->msbc_decoder_state.bad_frames_nr + engine->msbc_decoder_state.zero_frames_nr;
+            break;
+        case HFP_CODEC_CVSD:
+            stats->frames_decoded   = engine->cvsd_plc_state.good_frames_nr;
+            stats->frames_concealed = engine->cvsd_plc_state.bad_frames_nr;
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// HFP audio engine: per-connection mSBC/CVSD encode, decode and PLC
+//
+// *****************************************************************************
+
+#ifndef __HFP_AUDIO_ENGINE_H
+#define __HFP_AUDIO_ENGINE_H
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+
+#include "bluetooth.h"
+#include "btstack_defines.h"
+#include "btstack_linked_list.h"
+#include "btstack_ring_buffer.h"
+#include "classic/btstack_cvsd_plc.h"
+#include "classic/btstack_sbc.h"
+#include "classic/btstack_sbc_decoder_bluedroid.h"
+#include "classic/hfp_msbc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#define HFP_AUDIO_ENGINE_MSBC_FRAME_SIZE         HFP_MSBC_FRAME_SIZE
+#define HFP_AUDIO_ENGINE_MSBC_STREAM_FRAME_SIZE  HFP_MSBC_STREAM_FRAME_SIZE
+#define HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME  120
+#define HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME  24
+
+// PCM FIFOs hold 4 mSBC frames (30 ms at 16 kHz)
+#ifndef HFP_AUDIO_ENGINE_PCM_BUFFER_SAMPLES
+#define HFP_AUDIO_ENGINE_PCM_BUFFER_SAMPLES      (4 * HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME)
+#endif
+
+struct hfp_audio_engine;
+
+/**
+ * @brief Receives decoded PCM samples (mono, host endianess)
+ */
+typedef void (*hfp_audio_engine_pcm_handler_t)(struct hfp_audio_engine * engine, int16_t * samples, int num_samples, int sample_rate, void * context);
+
+/**
+ * @brief Called with the next outgoing audio frame before it gets encoded, can modify/mix into the samples
+ */
+typedef void (*hfp_audio_engine_mix_handler_t)(struct hfp_audio_engine * engine, int16_t * samples, int num_samples, int sample_rate, void * context);
+
+typedef struct {
+    uint32_t frames_encoded;
+    uint32_t frames_decoded;
+    uint32_t frames_concealed;
+    uint32_t h2_sync_lost;
+    uint32_t h2_sequence_errors;
+    uint32_t tx_underruns;
+} hfp_audio_engine_stats_t;
+
+typedef struct hfp_audio_engine {
+    btstack_linked_item_t item;
+
+    hci_con_handle_t sco_handle;
+    uint8_t          codec;
+    int              sample_rate;
+
+    hfp_audio_engine_pcm_handler_t pcm_handler;
+    void *                         pcm_context;
+    hfp_audio_engine_mix_handler_t mix_handler;
+    void *                         mix_context;
+
+    // bridged call receives our decoded audio
+    struct hfp_audio_engine * bridge;
+
+    // outgoing PCM from application and from bridged call
+    btstack_ring_buffer_t tx_pcm_buffer;
+    uint8_t               tx_pcm_storage[HFP_AUDIO_ENGINE_PCM_BUFFER_SAMPLES * 2];
+    btstack_ring_buffer_t tx_bridge_buffer;
+    uint8_t               tx_bridge_storage[HFP_AUDIO_ENGINE_PCM_BUFFER_SAMPLES * 2];
+
+    // mSBC encoder with H2 header
+    hfp_msbc_encoder_t msbc_encoder;
+
+    // mSBC decoder with H2 sync tracking
+    btstack_sbc_decoder_state_t     msbc_decoder_state;
+    btstack_sbc_decoder_bluedroid_t msbc_decoder;
+    uint8_t  msbc_rx_buffer[2 * HFP_AUDIO_ENGINE_MSBC_STREAM_FRAME_SIZE];
+    uint16_t msbc_rx_offset;
+    uint16_t msbc_rx_bad_bytes;
+    uint8_t  msbc_rx_synced;
+    uint8_t  msbc_rx_sequence_number;
+
+    // CVSD with PLC
+    btstack_cvsd_plc_state_t cvsd_plc_state;
+    int16_t  cvsd_rx_frame[HFP_AUDIO_ENGINE_CVSD_SAMPLES_PER_FRAME];
+    uint16_t cvsd_rx_samples;
+    uint8_t  cvsd_rx_bad;
+
+    hfp_audio_engine_stats_t stats;
+} hfp_audio_engine_t;
+
+/* API_START */
+
+/**
+ * @brief Init audio engine instance, e.g. one per HFP connection
+ * @param engine
+ * @param pcm_handler for decoded audio
+ * @param context for pcm_handler
+ */
+void hfp_audio_engine_init(hfp_audio_engine_t * engine, hfp_audio_engine_pcm_handler_t pcm_handler, void * context);
+
+/**
+ * @brief Register handler for decoded audio, e.g. for engine provided by hfp_ag_get_audio_engine or hfp_hf_get_audio_engine
+ * @param engine
+ * @param pcm_handler
+ * @param context
+ */
+void hfp_audio_engine_set_pcm_handler(hfp_audio_engine_t * engine, hfp_audio_engine_pcm_handler_t pcm_handler, void * context);
+
+/**
+ * @brief Start audio processing for SCO connection, e.g. on HFP_SUBEVENT_AUDIO_CONNECTION_ESTABLISHED
+ * @param engine
+ * @param sco_handle
+ * @param codec HFP_CODEC_CVSD or HFP_CODEC_MSBC
+ */
+void hfp_audio_engine_start(hfp_audio_engine_t * engine, hci_con_handle_t sco_handle, uint8_t codec);
+
+/**
+ * @brief Stop audio processing, also removes bridge
+ * @param engine
+ */
+void hfp_audio_engine_stop(hfp_audio_engine_t * engine);
+
+/**
+ * @brief Find started engine by SCO handle
+ * @param sco_handle
+ * @return engine or NULL
+ */
+hfp_audio_engine_t * hfp_audio_engine_for_sco_handle(hci_con_handle_t sco_handle);
+
+/**
+ * @brief Get sample rate of current codec: 8000 for CVSD, 16000 for mSBC
+ * @param engine
+ */
+int hfp_audio_engine_sample_rate(hfp_audio_engine_t * engine);
+
+/**
+ * @brief Queue PCM samples for transmission
+ * @param engine
+ * @param samples (mono, host endianess) at hfp_audio_engine_sample_rate
+ * @param num_samples
+ * @return number of samples queued
+ */
+int hfp_audio_engine_write_pcm(hfp_audio_engine_t * engine, const int16_t * samples, int num_samples);
+
+/**
+ * @brief Register mixing hook called for each outgoing audio frame
+ * @param engine
+ * @param mix_handler
+ * @param context
+ */
+void hfp_audio_engine_set_mix_handler(hfp_audio_engine_t * engine, hfp_audio_engine_mix_handler_t mix_handler, void * context);
+
+/**
+ * @brief Bridge two calls: decoded audio of each engine is mixed into the outgoing audio of the other one
+ * @note  Sample rates are converted if CVSD and mSBC calls are bridged
+ * @param engine_a
+ * @param engine_b
+ */
+void hfp_audio_engine_bridge(hfp_audio_engine_t * engine_a, hfp_audio_engine_t * engine_b);
+
+/**
+ * @brief Remove bridge from engine and its peer
+ * @param engine
+ */
+void hfp_audio_engine_unbridge(hfp_audio_engine_t * engine);
+
+/**
+ * @brief Process received SCO packet
+ * @param engine
+ * @param packet incl. SCO header
+ * @param size
+ */
+void hfp_audio_engine_receive_sco_packet(hfp_audio_engine_t * engine, uint8_t * packet, uint16_t size);
+
+/**
+ * @brief Fill payload of outgoing SCO packet, encodes queued PCM as needed and inserts silence on underrun
+ * @param engine
+ * @param payload
+ * @param size of payload
+ */
+void hfp_audio_engine_fill_sco_payload(hfp_audio_engine_t * engine, uint8_t * payload, uint16_t size);
+
+/**
+ * @brief Get statistics
+ * @param engine
+ * @param stats
+ */
+void hfp_audio_engine_get_stats(hfp_audio_engine_t * engine, hfp_audio_engine_stats_t * stats);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __HFP_AUDIO_ENGINE_H
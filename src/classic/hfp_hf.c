@@ -1275,6 +1275,17 @@ void hfp_hf_release_audio_connection(hci_con_handle_t acl_handle){
     hfp_run_for_context(hfp_connection);
 }
 
+#ifdef ENABLE_SCO_OVER_HCI
+hfp_audio_engine_t * hfp_hf_get_audio_engine(hci_con_handle_t acl_handle){
+    hfp_connection_t * hfp_connection = get_hfp_hf_connection_context_for_acl_handle(acl_handle);
+    if (!hfp_connection){
+        log_error("HFP HF: ACL connection 0x%2x is not found.", acl_handle);
+        return NULL;
+    }
+    return &hfp_connection->audio_engine;
+}
+#endif
+
 void hfp_hf_answer_incoming_call(hci_con_handle_t acl_handle){
     hfp_connection_t * hfp_connection = get_hfp_hf_connection_context_for_acl_handle(acl_handle);
     if (!hfp_connection) {
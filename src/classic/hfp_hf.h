@@ -195,6 +195,16 @@ void hfp_hf_establish_audio_connection(hci_con_handle_t acl_handle);
  */
 void hfp_hf_release_audio_connection(hci_con_handle_t acl_handle);
 
+#ifdef ENABLE_SCO_OVER_HCI
+/**
+ * @brief Get audio engine of the connection. It is started on HFP_SUBEVENT_AUDIO_CONNECTION_ESTABLISHED
+ * with the negotiated codec and stopped on HFP_SUBEVENT_AUDIO_CONNECTION_RELEASED.
+ * @param acl_handle of the AG
+ * @return engine or NULL if connection not found
+ */
+hfp_audio_engine_t * hfp_hf_get_audio_engine(hci_con_handle_t acl_handle);
+#endif
+
 /**
  * @brief Answer incoming call.
  * @param bd_addr Bluetooth address of the AG
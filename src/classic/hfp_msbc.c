@@ -48,69 +48,54 @@
 #include <string.h>
 
 #include "btstack_debug.h"
-#include "btstack_sbc.h"
 #include "hfp_msbc.h"
 
-#define MSBC_FRAME_SIZE 57
-#define MSBC_HEADER_H2_SIZE 2
-#define MSBC_PADDING_SIZE 1
-#define MSBC_EXTRA_SIZE (MSBC_HEADER_H2_SIZE + MSBC_PADDING_SIZE)
-
 static const uint8_t msbc_header_h2_byte_0         = 1;
 static const uint8_t msbc_header_h2_byte_1_table[] = { 0x08, 0x38, 0xc8, 0xf8 };
 
-static btstack_sbc_encoder_state_t state;
-static int msbc_sequence_number;
-
-static uint8_t msbc_buffer[2*(MSBC_FRAME_SIZE + MSBC_EXTRA_SIZE)];
-static int msbc_buffer_offset = 0; 
-
-void hfp_msbc_init(void){
-    btstack_sbc_encoder_init(&state, SBC_MODE_mSBC, 16, 8, 0, 16000, 26, 0);
-    msbc_buffer_offset = 0;
-    msbc_sequence_number = 0;
+void hfp_msbc_init(hfp_msbc_encoder_t * msbc){
+    btstack_sbc_encoder_bluedroid_init(&msbc->sbc_encoder_state, &msbc->sbc_encoder, SBC_MODE_mSBC, 16, 8, 0, 16000, 26, 0);
+    msbc->buffer_offset = 0;
+    msbc->sequence_number = 0;
 }
 
-int hfp_msbc_can_encode_audio_frame_now(void){
-    return sizeof(msbc_buffer) - msbc_buffer_offset >= MSBC_FRAME_SIZE + MSBC_EXTRA_SIZE; 
+int hfp_msbc_can_encode_audio_frame_now(hfp_msbc_encoder_t * msbc){
+    return sizeof(msbc->buffer) - msbc->buffer_offset >= HFP_MSBC_STREAM_FRAME_SIZE; 
 }
 
-void hfp_msbc_encode_audio_frame(int16_t * pcm_samples){
-    if (!hfp_msbc_can_encode_audio_frame_now()) return;
+void hfp_msbc_encode_audio_frame(hfp_msbc_encoder_t * msbc, int16_t * pcm_samples){
+    if (!hfp_msbc_can_encode_audio_frame_now(msbc)) return;
 
     // Synchronization Header H2
-    msbc_buffer[msbc_buffer_offset++] = msbc_header_h2_byte_0;
-    msbc_buffer[msbc_buffer_offset++] = msbc_header_h2_byte_1_table[msbc_sequence_number];
-    msbc_sequence_number = (msbc_sequence_number + 1) & 3;
+    msbc->buffer[msbc->buffer_offset++] = msbc_header_h2_byte_0;
+    msbc->buffer[msbc->buffer_offset++] = msbc_header_h2_byte_1_table[msbc->sequence_number];
+    msbc->sequence_number = (msbc->sequence_number + 1) & 3;
 
     // SBC Frame
-    btstack_sbc_encoder_process_data(pcm_samples);
-    memcpy(msbc_buffer + msbc_buffer_offset, btstack_sbc_encoder_sbc_buffer(), MSBC_FRAME_SIZE);
-    msbc_buffer_offset += MSBC_FRAME_SIZE;
+    btstack_sbc_encoder_bluedroid_process_data(&msbc->sbc_encoder_state, pcm_samples);
+    memcpy(msbc->buffer + msbc->buffer_offset, btstack_sbc_encoder_bluedroid_sbc_buffer(&msbc->sbc_encoder_state), HFP_MSBC_FRAME_SIZE);
+    msbc->buffer_offset += HFP_MSBC_FRAME_SIZE;
 
     // Final padding to use 60 bytes for 120 audio samples
-    msbc_buffer[msbc_buffer_offset++] = 0;
+    msbc->buffer[msbc->buffer_offset++] = 0;
 }
 
-void hfp_msbc_read_from_stream(uint8_t * buf, int size){
-    int bytes_to_copy = size;
-    if (size > msbc_buffer_offset){
-        bytes_to_copy = msbc_buffer_offset;
+void hfp_msbc_read_from_stream(hfp_msbc_encoder_t * msbc, uint8_t * buf, int size){
+    if (size > msbc->buffer_offset){
         log_error("sbc frame storage is smaller then the output buffer");
         return;
     }
 
-    memcpy(buf, msbc_buffer, bytes_to_copy);
-    memmove(msbc_buffer, msbc_buffer + bytes_to_copy, sizeof(msbc_buffer) - bytes_to_copy);
-    msbc_buffer_offset -= bytes_to_copy;
+    memcpy(buf, msbc->buffer, size);
+    memmove(msbc->buffer, msbc->buffer + size, msbc->buffer_offset - size);
+    msbc->buffer_offset -= size;
 }
 
-int hfp_msbc_num_bytes_in_stream(void){
-    return msbc_buffer_offset;
+int hfp_msbc_num_bytes_in_stream(hfp_msbc_encoder_t * msbc){
+    return msbc->buffer_offset;
 }
 
-int hfp_msbc_num_audio_samples_per_frame(void){
-    return btstack_sbc_encoder_num_audio_frames();
+int hfp_msbc_num_audio_samples_per_frame(hfp_msbc_encoder_t * msbc){
+    return btstack_sbc_encoder_bluedroid_num_audio_frames(&msbc->sbc_encoder_state);
 }
 
-
@@ -48,43 +48,58 @@
 
 #include <stdint.h>
 
+#include "classic/btstack_sbc.h"
+#include "classic/btstack_sbc_encoder_bluedroid.h"
+
 #if defined __cplusplus
 extern "C" {
 #endif
 
+#define HFP_MSBC_FRAME_SIZE         57
+#define HFP_MSBC_STREAM_FRAME_SIZE  60
+
+typedef struct {
+    btstack_sbc_encoder_state_t     sbc_encoder_state;
+    btstack_sbc_encoder_bluedroid_t sbc_encoder;
+    uint8_t buffer[2 * HFP_MSBC_STREAM_FRAME_SIZE];
+    int     buffer_offset;
+    int     sequence_number;
+} hfp_msbc_encoder_t;
+
 /* API_START */
 
 /**
- *
+ * @param msbc encoder instance, e.g. one per HFP connection
  */
-void hfp_msbc_init(void);
+void hfp_msbc_init(hfp_msbc_encoder_t * msbc);
 
 /**
- *
+ * @param msbc
  */
-int  hfp_msbc_num_audio_samples_per_frame(void);
+int  hfp_msbc_num_audio_samples_per_frame(hfp_msbc_encoder_t * msbc);
 
 /**
- *
+ * @param msbc
  */
-int  hfp_msbc_can_encode_audio_frame_now(void);
+int  hfp_msbc_can_encode_audio_frame_now(hfp_msbc_encoder_t * msbc);
 
 /**
+ * @param msbc
  * @param pcm_samples - complete audio frame of hfp_msbc_num_audio_samples_per_frame int16 samples
  */
-void hfp_msbc_encode_audio_frame(int16_t * pcm_samples);
+void hfp_msbc_encode_audio_frame(hfp_msbc_encoder_t * msbc, int16_t * pcm_samples);
 
 /**
- *
+ * @param msbc
  */
-int  hfp_msbc_num_bytes_in_stream(void);
+int  hfp_msbc_num_bytes_in_stream(hfp_msbc_encoder_t * msbc);
 
 /**
- *
+ * @param msbc
  * @param buffer to store stream
  * @param size num bytes to read from stream
  */
-void hfp_msbc_read_from_stream(uint8_t * buffer, int size);
+void hfp_msbc_read_from_stream(hfp_msbc_encoder_t * msbc, uint8_t * buffer, int size);
 
 /* API_END */
 
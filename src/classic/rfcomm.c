@@ -71,6 +71,33 @@
 
 #define RFCOMM_CREDITS 10
 
+// upper limit for credits granted automatically
+#ifndef RFCOMM_CREDITS_MAX
+#define RFCOMM_CREDITS_MAX 60
+#endif
+
+// credits granted automatically should last for this period at the measured rate of incoming frames
+#ifndef RFCOMM_CREDITS_WINDOW_MS
+#define RFCOMM_CREDITS_WINDOW_MS 100
+#endif
+
+// max number of frames sent by all channels of a multiplexer per L2CAP can send now event
+#ifndef RFCOMM_MAX_FRAMES_PER_CAN_SEND_NOW
+#define RFCOMM_MAX_FRAMES_PER_CAN_SEND_NOW 8
+#endif
+
+// number of hash buckets for lookup of channels by rfcomm_cid and (multiplexer, dlci) and multiplexers by l2cap_cid, power of two
+#ifndef RFCOMM_LOOKUP_TABLE_SIZE
+#define RFCOMM_LOOKUP_TABLE_SIZE 32
+#endif
+
+#if (RFCOMM_LOOKUP_TABLE_SIZE & (RFCOMM_LOOKUP_TABLE_SIZE - 1)) != 0
+#error "RFCOMM_LOOKUP_TABLE_SIZE must be a power of two"
+#endif
+
+// server channels are 5 bit (DLCI = server channel << 1 | direction)
+#define RFCOMM_MAX_SERVER_CHANNEL 31
+
 // FCS calc 
 #define BT_RFCOMM_CODE_WORD         0xE0 // pol = x8+x2+x1+1
 #define BT_RFCOMM_CRC_CHECK_LEN     3
@@ -132,8 +159,18 @@ static btstack_linked_list_t rfcomm_multiplexers = NULL;
 static btstack_linked_list_t rfcomm_channels = NULL;
 static btstack_linked_list_t rfcomm_services = NULL;
 
+// hash tables for lookup on every frame and API call
+static rfcomm_channel_t *     rfcomm_channels_by_rfcomm_cid[RFCOMM_LOOKUP_TABLE_SIZE];
+static rfcomm_channel_t *     rfcomm_channels_by_dlci[RFCOMM_LOOKUP_TABLE_SIZE];
+static rfcomm_multiplexer_t * rfcomm_multiplexers_by_l2cap_cid[RFCOMM_LOOKUP_TABLE_SIZE];
+static rfcomm_service_t *     rfcomm_services_by_server_channel[RFCOMM_MAX_SERVER_CHANNEL + 1];
+
 static gap_security_level_t rfcomm_security_level;
 
+// requests for L2CAP can send now events are deferred while rfcomm_handle_can_send_now is active
+static uint16_t rfcomm_can_send_now_active_cid;
+static int      rfcomm_can_send_now_requested;
+
 static int  rfcomm_channel_can_send(rfcomm_channel_t * channel);
 static int  rfcomm_channel_ready_for_open(rfcomm_channel_t *channel);
 static int rfcomm_channel_ready_to_send(rfcomm_channel_t * channel);
@@ -274,11 +311,67 @@ static void rfcomm_rpn_data_update(rfcomm_rpn_data_t * dest, rfcomm_rpn_data_t *
     dest->parameter_mask_0 = src->parameter_mask_0;
     dest->parameter_mask_1 = src->parameter_mask_1;
 }
+
+// MARK: RFCOMM LOOKUP TABLES
+
+static inline uint16_t rfcomm_lookup_bucket_for_cid(uint16_t cid){
+    return cid & (RFCOMM_LOOKUP_TABLE_SIZE - 1);
+}
+
+static uint16_t rfcomm_lookup_bucket_for_dlci(const rfcomm_multiplexer_t * multiplexer, uint8_t dlci){
+    // multiplexers are at least 16 byte apart, mix in dlci
+    uint32_t key = (uint32_t) (((uintptr_t) multiplexer) >> 4);
+    key = (key ^ dlci) * 0x9E3779B1u;
+    return (key >> 16) & (RFCOMM_LOOKUP_TABLE_SIZE - 1);
+}
+
+static void rfcomm_lookup_add_multiplexer(rfcomm_multiplexer_t * multiplexer){
+    uint16_t bucket = rfcomm_lookup_bucket_for_cid(multiplexer->l2cap_cid);
+    multiplexer->next_for_l2cap_cid = rfcomm_multiplexers_by_l2cap_cid[bucket];
+    rfcomm_multiplexers_by_l2cap_cid[bucket] = multiplexer;
+}
+
+static void rfcomm_lookup_remove_multiplexer(rfcomm_multiplexer_t * multiplexer){
+    rfcomm_multiplexer_t ** it = &rfcomm_multiplexers_by_l2cap_cid[rfcomm_lookup_bucket_for_cid(multiplexer->l2cap_cid)];
+    for (; *it ; it = &(*it)->next_for_l2cap_cid){
+        if (*it != multiplexer) continue;
+        *it = multiplexer->next_for_l2cap_cid;
+        multiplexer->next_for_l2cap_cid = NULL;
+        return;
+    }
+}
+
+static void rfcomm_lookup_add_channel(rfcomm_channel_t * channel){
+    uint16_t bucket = rfcomm_lookup_bucket_for_cid(channel->rfcomm_cid);
+    channel->next_for_rfcomm_cid = rfcomm_channels_by_rfcomm_cid[bucket];
+    rfcomm_channels_by_rfcomm_cid[bucket] = channel;
+    bucket = rfcomm_lookup_bucket_for_dlci(channel->multiplexer, channel->dlci);
+    channel->next_for_dlci = rfcomm_channels_by_dlci[bucket];
+    rfcomm_channels_by_dlci[bucket] = channel;
+}
+
+static void rfcomm_lookup_remove_channel(rfcomm_channel_t * channel){
+    rfcomm_channel_t ** it = &rfcomm_channels_by_rfcomm_cid[rfcomm_lookup_bucket_for_cid(channel->rfcomm_cid)];
+    for (; *it ; it = &(*it)->next_for_rfcomm_cid){
+        if (*it != channel) continue;
+        *it = channel->next_for_rfcomm_cid;
+        break;
+    }
+    it = &rfcomm_channels_by_dlci[rfcomm_lookup_bucket_for_dlci(channel->multiplexer, channel->dlci)];
+    for (; *it ; it = &(*it)->next_for_dlci){
+        if (*it != channel) continue;
+        *it = channel->next_for_dlci;
+        break;
+    }
+    channel->next_for_rfcomm_cid = NULL;
+    channel->next_for_dlci = NULL;
+}
+
 // MARK: RFCOMM MULTIPLEXER HELPER
 
 static uint16_t rfcomm_max_frame_size_for_l2cap_mtu(uint16_t l2cap_mtu){
-    // Assume RFCOMM header without credits and 2 byte (14 bit) length field
-    uint16_t max_frame_size = l2cap_mtu - 5;
+    // Assume RFCOMM header with credits (piggybacked on data frames) and 2 byte (14 bit) length field
+    uint16_t max_frame_size = l2cap_mtu - 6;
     log_info("rfcomm_max_frame_size_for_l2cap_mtu:  %u -> %u", l2cap_mtu, max_frame_size);
     return max_frame_size;
 }
@@ -307,6 +400,7 @@ static rfcomm_multiplexer_t * rfcomm_multiplexer_create_for_addr(bd_addr_t addr)
 
     // add to services list
     btstack_linked_list_add(&rfcomm_multiplexers, (btstack_linked_item_t *) multiplexer);
+    rfcomm_lookup_add_multiplexer(multiplexer);
     
     return multiplexer;
 }
@@ -325,9 +419,8 @@ static rfcomm_multiplexer_t * rfcomm_multiplexer_for_addr(bd_addr_t addr){
 }
 
 static rfcomm_multiplexer_t * rfcomm_multiplexer_for_l2cap_cid(uint16_t l2cap_cid) {
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) rfcomm_multiplexers; it ; it = it->next){
-        rfcomm_multiplexer_t * multiplexer = ((rfcomm_multiplexer_t *) it);
+    rfcomm_multiplexer_t * multiplexer = rfcomm_multiplexers_by_l2cap_cid[rfcomm_lookup_bucket_for_cid(l2cap_cid)];
+    for (; multiplexer ; multiplexer = multiplexer->next_for_l2cap_cid){
         if (multiplexer->l2cap_cid == l2cap_cid) {
             return multiplexer;
         };
@@ -335,15 +428,14 @@ static rfcomm_multiplexer_t * rfcomm_multiplexer_for_l2cap_cid(uint16_t l2cap_ci
     return NULL;
 }
 
+static void rfcomm_multiplexer_set_l2cap_cid(rfcomm_multiplexer_t * multiplexer, uint16_t l2cap_cid){
+    rfcomm_lookup_remove_multiplexer(multiplexer);
+    multiplexer->l2cap_cid = l2cap_cid;
+    rfcomm_lookup_add_multiplexer(multiplexer);
+}
+
 static int rfcomm_multiplexer_has_channels(rfcomm_multiplexer_t * multiplexer){
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) rfcomm_channels; it ; it = it->next){
-        rfcomm_channel_t * channel = ((rfcomm_channel_t *) it);
-        if (channel->multiplexer == multiplexer) {
-            return 1;
-        }
-    }
-    return 0;
+    return multiplexer->num_channels > 0;
 }
 
 // MARK: RFCOMM CHANNEL HELPER
@@ -384,6 +476,10 @@ static void rfcomm_channel_initialize(rfcomm_channel_t *channel, rfcomm_multiple
     channel->new_credits_incoming  = RFCOMM_CREDITS;
     channel->incoming_flow_control = 0;
 
+    channel->credits_grant           = RFCOMM_CREDITS;
+    channel->credits_frames_received = 0;
+    channel->credits_grant_time_ms   = btstack_run_loop_get_time_ms();
+
     channel->rls_line_status       = RFCOMM_RLS_STATUS_INVALID;
 
     channel->service = service;
@@ -418,10 +514,19 @@ static rfcomm_channel_t * rfcomm_channel_create(rfcomm_multiplexer_t * multiplex
     
     // add to services list
     btstack_linked_list_add(&rfcomm_channels, (btstack_linked_item_t *) channel);
+    rfcomm_lookup_add_channel(channel);
+    multiplexer->num_channels++;
     
     return channel;
 }
 
+static void rfcomm_channel_free(rfcomm_channel_t * channel){
+    btstack_linked_list_remove(&rfcomm_channels, (btstack_linked_item_t *) channel);
+    rfcomm_lookup_remove_channel(channel);
+    channel->multiplexer->num_channels--;
+    btstack_memory_rfcomm_channel_free(channel);
+}
+
 static void rfcomm_notify_channel_can_send(void){
     btstack_linked_list_iterator_t it;
     btstack_linked_list_iterator_init(&it, &rfcomm_channels);
@@ -436,9 +541,8 @@ static void rfcomm_notify_channel_can_send(void){
 }
 
 static rfcomm_channel_t * rfcomm_channel_for_rfcomm_cid(uint16_t rfcomm_cid){
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) rfcomm_channels; it ; it = it->next){
-        rfcomm_channel_t * channel = ((rfcomm_channel_t *) it);
+    rfcomm_channel_t * channel = rfcomm_channels_by_rfcomm_cid[rfcomm_lookup_bucket_for_cid(rfcomm_cid)];
+    for (; channel ; channel = channel->next_for_rfcomm_cid){
         if (channel->rfcomm_cid == rfcomm_cid) {
             return channel;
         };
@@ -447,9 +551,8 @@ static rfcomm_channel_t * rfcomm_channel_for_rfcomm_cid(uint16_t rfcomm_cid){
 }
 
 static rfcomm_channel_t * rfcomm_channel_for_multiplexer_and_dlci(rfcomm_multiplexer_t * multiplexer, uint8_t dlci){
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) rfcomm_channels; it ; it = it->next){
-        rfcomm_channel_t * channel = ((rfcomm_channel_t *) it);
+    rfcomm_channel_t * channel = rfcomm_channels_by_dlci[rfcomm_lookup_bucket_for_dlci(multiplexer, dlci)];
+    for (; channel ; channel = channel->next_for_dlci){
         if (channel->dlci == dlci && channel->multiplexer == multiplexer) {
             return channel;
         };
@@ -458,14 +561,16 @@ static rfcomm_channel_t * rfcomm_channel_for_multiplexer_and_dlci(rfcomm_multipl
 }
 
 static rfcomm_service_t * rfcomm_service_for_channel(uint8_t server_channel){
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) rfcomm_services; it ; it = it->next){
-        rfcomm_service_t * service = ((rfcomm_service_t *) it);
-        if ( service->server_channel == server_channel){
-            return service;
-        };
+    if (server_channel > RFCOMM_MAX_SERVER_CHANNEL) return NULL;
+    return rfcomm_services_by_server_channel[server_channel];
+}
+
+static void rfcomm_request_l2cap_can_send_now_event(uint16_t l2cap_cid){
+    if (l2cap_cid == rfcomm_can_send_now_active_cid){
+        rfcomm_can_send_now_requested = 1;
+        return;
     }
-    return NULL;
+    l2cap_request_can_send_now_event(l2cap_cid);
 }
 
 // MARK: RFCOMM SEND
@@ -517,11 +622,11 @@ static int rfcomm_send_packet_for_multiplexer(rfcomm_multiplexer_t *multiplexer,
     return err;
 }
 
-// simplified version of rfcomm_send_packet_for_multiplexer for prepared rfcomm packet (UIH, 2 byte len, no credits)
-static int rfcomm_send_uih_prepared(rfcomm_multiplexer_t *multiplexer, uint8_t dlci, uint16_t len){
+// simplified version of rfcomm_send_packet_for_multiplexer for prepared rfcomm packet (UIH, 2 byte len, optional credits)
+static int rfcomm_send_uih_prepared(rfcomm_multiplexer_t *multiplexer, uint8_t dlci, uint8_t credits, uint16_t len){
 
     uint8_t address = (1 << 0) | (multiplexer->outgoing << 1) | (dlci << 2); 
-    uint8_t control = BT_RFCOMM_UIH;
+    uint8_t control = credits ? BT_RFCOMM_UIH_PF : BT_RFCOMM_UIH;
 
     uint8_t * rfcomm_out_buffer = l2cap_get_outgoing_buffer();
     
@@ -531,6 +636,12 @@ static int rfcomm_send_uih_prepared(rfcomm_multiplexer_t *multiplexer, uint8_t d
     rfcomm_out_buffer[pos++] = (len & 0x7f) << 1; // bits 0-6
     rfcomm_out_buffer[pos++] = len >> 7;          // bits 7-14
 
+    // piggyback credits: make room for credit field, max frame size accounts for it
+    if (credits){
+        memmove(&rfcomm_out_buffer[pos+1], &rfcomm_out_buffer[pos], len);
+        rfcomm_out_buffer[pos++] = credits;
+    }
+
     // actual data is already in place
     pos += len;
     
@@ -762,6 +873,7 @@ static void rfcomm_multiplexer_stop_timer(rfcomm_multiplexer_t * multiplexer){
 }
 static void rfcomm_multiplexer_free(rfcomm_multiplexer_t * multiplexer){
     btstack_linked_list_remove( &rfcomm_multiplexers, (btstack_linked_item_t *) multiplexer);
+    rfcomm_lookup_remove_multiplexer(multiplexer);
     btstack_memory_rfcomm_multiplexer_free(multiplexer);
 }
 
@@ -786,10 +898,8 @@ static void rfcomm_multiplexer_finalize(rfcomm_multiplexer_t * multiplexer){
                     rfcomm_emit_channel_opened(channel, RFCOMM_MULTIPLEXER_STOPPED); 
                     break;
             }
-            // remove from list
-            it->next = it->next->next;
-            // free channel struct
-            btstack_memory_rfcomm_channel_free(channel);
+            // remove from list and free channel struct
+            rfcomm_channel_free(channel);
         } else {
             it = it->next;
         }
@@ -837,53 +947,50 @@ static void rfcomm_multiplexer_opened(rfcomm_multiplexer_t *multiplexer){
         if (channel->multiplexer != multiplexer) continue;
         rfcomm_channel_state_machine_with_channel(channel, &event);
         if (rfcomm_channel_ready_to_send(channel)){
-            l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+            rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
         }
     }        
     rfcomm_multiplexer_prepare_idle_timer(multiplexer);
 
     // request can send now for multiplexer if ready
     if (rfcomm_multiplexer_ready_to_send(multiplexer)){
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+        rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
     }
 }
 
-static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
-
-    log_debug("rfcomm_handle_can_send_now enter: %u", l2cap_cid);
-
+// @returns 1 if token was consumed by multiplexer, channel state machine, or client
+static int rfcomm_handle_can_send_now_token(uint16_t l2cap_cid){
     btstack_linked_list_iterator_t it;
-    int token_consumed = 0;
 
     // forward token to multiplexer
     btstack_linked_list_iterator_init(&it, &rfcomm_multiplexers);
-    while (!token_consumed && btstack_linked_list_iterator_has_next(&it)){
+    while (btstack_linked_list_iterator_has_next(&it)){
         rfcomm_multiplexer_t * multiplexer = (rfcomm_multiplexer_t *) btstack_linked_list_iterator_next(&it);
         if (multiplexer->l2cap_cid != l2cap_cid) continue;
         if (rfcomm_multiplexer_ready_to_send(multiplexer)){
             log_debug("rfcomm_handle_can_send_now enter: multiplexer token");
-            token_consumed = 1;
             rfcomm_multiplexer_state_machine(multiplexer, MULT_EV_READY_TO_SEND);
+            return 1;
         }
     }
 
     // forward token to channel state machine
     btstack_linked_list_iterator_init(&it, &rfcomm_channels);
-    while (!token_consumed && btstack_linked_list_iterator_has_next(&it)){
+    while (btstack_linked_list_iterator_has_next(&it)){
         rfcomm_channel_t * channel = (rfcomm_channel_t *) btstack_linked_list_iterator_next(&it);
         if (channel->multiplexer->l2cap_cid != l2cap_cid) continue;
         // channel state machine
         if (rfcomm_channel_ready_to_send(channel)){
             log_debug("rfcomm_handle_can_send_now enter: channel token");
-            token_consumed = 1;
             const rfcomm_channel_event_t event = { CH_EVT_READY_TO_SEND, 0 };
             rfcomm_channel_state_machine_with_channel(channel, &event);
+            return 1;
         }
     }
 
     // forward token to client
     btstack_linked_list_iterator_init(&it, &rfcomm_channels);
-    while (!token_consumed && btstack_linked_list_iterator_has_next(&it)){
+    while (btstack_linked_list_iterator_has_next(&it)){
         rfcomm_channel_t * channel = (rfcomm_channel_t *) btstack_linked_list_iterator_next(&it);
         if (channel->multiplexer->l2cap_cid != l2cap_cid) continue;
         // client waiting for can send now
@@ -892,13 +999,38 @@ static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
         if ((channel->multiplexer->fcon & 1) == 0) continue;
 
         log_debug("rfcomm_handle_can_send_now enter: client token");
-        token_consumed = 1;
+        // requeue for fairness between channels
+        btstack_linked_list_remove(&rfcomm_channels, (btstack_linked_item_t *) channel);
+        btstack_linked_list_add_tail(&rfcomm_channels, (btstack_linked_item_t *) channel);
         channel->waiting_for_can_send_now = 0;
         rfcomm_emit_can_send_now(channel);
+        return 1;
+    }
+    return 0;
+}
+
+static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
+
+    log_debug("rfcomm_handle_can_send_now enter: %u", l2cap_cid);
+
+    // send frames while L2CAP can send, defer can send now requests until done
+    uint16_t active_cid = rfcomm_can_send_now_active_cid;
+    rfcomm_can_send_now_active_cid = l2cap_cid;
+    rfcomm_can_send_now_requested  = 0;
+
+    int token_consumed = 0;
+    int num_frames = 0;
+    while (num_frames < RFCOMM_MAX_FRAMES_PER_CAN_SEND_NOW){
+        if (num_frames && !l2cap_can_send_packet_now(l2cap_cid)) break;
+        if (!rfcomm_handle_can_send_now_token(l2cap_cid)) break;
+        token_consumed = 1;
+        num_frames++;
     }
 
+    rfcomm_can_send_now_active_cid = active_cid;
+
     // if token was consumed, request another one
-    if (token_consumed) {
+    if (token_consumed || rfcomm_can_send_now_requested) {
         l2cap_request_can_send_now_event(l2cap_cid);
     }
 
@@ -907,7 +1039,7 @@ static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
 
 static void rfcomm_multiplexer_set_state_and_request_can_send_now_event(rfcomm_multiplexer_t * multiplexer, RFCOMM_MULTIPLEXER_STATE state){
     multiplexer->state = state;
-    l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+    rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
 }
 
 /**
@@ -953,7 +1085,7 @@ static int rfcomm_hci_event_handler(uint8_t *packet, uint16_t size){
             }
             
             multiplexer->con_handle = con_handle;
-            multiplexer->l2cap_cid = l2cap_cid;
+            rfcomm_multiplexer_set_l2cap_cid(multiplexer, l2cap_cid);
             // 
             multiplexer->state = RFCOMM_MULTIPLEXER_W4_SABM_0;
             log_info("L2CAP_EVENT_INCOMING_CONNECTION (l2cap_cid 0x%02x) for BLUETOOTH_PROTOCOL_RFCOMM => accept", l2cap_cid);
@@ -998,8 +1130,7 @@ static int rfcomm_hci_event_handler(uint8_t *packet, uint16_t size){
                         if (channel->multiplexer == multiplexer){
                             done = 0;
                             rfcomm_emit_channel_opened(channel, status);
-                            btstack_linked_list_remove(&rfcomm_channels, (btstack_linked_item_t *) channel);
-                            btstack_memory_rfcomm_channel_free(channel);
+                            rfcomm_channel_free(channel);
                             break;
                         } else {
                             it = it->next;
@@ -1018,7 +1149,7 @@ static int rfcomm_hci_event_handler(uint8_t *packet, uint16_t size){
                 log_info("L2CAP_EVENT_CHANNEL_OPENED: outgoing connection");
                 // wrong remote addr
                 if (bd_addr_cmp(event_addr, multiplexer->remote_addr)) break;
-                multiplexer->l2cap_cid = l2cap_cid;
+                rfcomm_multiplexer_set_l2cap_cid(multiplexer, l2cap_cid);
                 multiplexer->con_handle = con_handle;
                 // send SABM #0
                 rfcomm_multiplexer_set_state_and_request_can_send_now_event(multiplexer, RFCOMM_MULTIPLEXER_SEND_SABM_0);
@@ -1122,12 +1253,12 @@ static int rfcomm_multiplexer_l2cap_packet_handler(uint16_t channel, uint8_t *pa
 
                 case BT_RFCOMM_FCON_CMD:
                     multiplexer->fcon = 0x81;
-                    l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+                    rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
                     return 1;
 
                 case BT_RFCOMM_FCOFF_CMD:
                     multiplexer->fcon = 0x80;
-                    l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+                    rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
                     return 1;
 
                 case BT_RFCOMM_TEST_CMD: {
@@ -1139,7 +1270,7 @@ static int rfcomm_multiplexer_l2cap_packet_handler(uint16_t channel, uint8_t *pa
                     len = btstack_min(len, size - 1 - payload_offset);  // avoid information leak
                     multiplexer->test_data_len = len;
                     memcpy(multiplexer->test_data, &packet[payload_offset + 2], len);
-                    l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+                    rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
                     return 1;
                 }
                 default:
@@ -1254,6 +1385,27 @@ static void rfcomm_channel_send_credits(rfcomm_channel_t *channel, uint8_t credi
     rfcomm_send_uih_credits(channel->multiplexer, channel->dlci, credits);
 }
 
+// size credit grant to cover RFCOMM_CREDITS_WINDOW_MS at the rate of incoming frames since last grant
+static uint8_t rfcomm_channel_automatic_credits(rfcomm_channel_t * channel){
+    uint32_t now = btstack_run_loop_get_time_ms();
+    uint32_t elapsed_ms = now - channel->credits_grant_time_ms;
+    uint32_t credits;
+    if (elapsed_ms == 0){
+        credits = RFCOMM_CREDITS_MAX;
+    } else {
+        credits = (channel->credits_frames_received * RFCOMM_CREDITS_WINDOW_MS + elapsed_ms - 1) / elapsed_ms;
+    }
+    credits = btstack_max(credits, RFCOMM_CREDITS);
+    credits = btstack_min(credits, RFCOMM_CREDITS_MAX);
+    // credits_incoming is a uint8_t
+    credits = btstack_min(credits, 255 - channel->credits_incoming);
+    channel->credits_grant           = (uint8_t) credits;
+    channel->credits_frames_received = 0;
+    channel->credits_grant_time_ms   = now;
+    log_debug("rfcomm: grant %u credits after %u ms", (unsigned int) credits, (unsigned int) elapsed_ms);
+    return (uint8_t) credits;
+}
+
 static int rfcomm_channel_can_send(rfcomm_channel_t * channel){
     if (!channel->credits_outgoing) return 0;
     if ((channel->multiplexer->fcon & 1) == 0) return 0;
@@ -1279,7 +1431,7 @@ static void rfcomm_channel_opened(rfcomm_channel_t *rfChannel){
     
     // request can send now if channel ready 
     if (rfcomm_channel_ready_to_send(rfChannel)){
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+        rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
     }
 }
 
@@ -1304,7 +1456,7 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         rfcomm_channel_event_t channel_event = { CH_EVT_RCVD_CREDITS, 0 };
         rfcomm_channel_state_machine_with_channel(channel, &channel_event);
         if (rfcomm_channel_ready_to_send(channel)){
-            l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+            rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
         }
     }
     
@@ -1317,6 +1469,7 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         if (channel->credits_incoming > 0){
             channel->credits_incoming--;
         }
+        channel->credits_frames_received++;
         
         // deliver payload
         (channel->packet_handler)(RFCOMM_DATA_PACKET, channel->rfcomm_cid,
@@ -1324,10 +1477,11 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
     }
     
     // automatically provide new credits to remote device, if no incoming flow control
-    if (!channel->incoming_flow_control && channel->credits_incoming < 5){
-        channel->new_credits_incoming = RFCOMM_CREDITS;
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
-    }    
+    if (channel->incoming_flow_control) return;
+    if (channel->new_credits_incoming) return;
+    if (channel->credits_incoming >= (channel->credits_grant / 2)) return;
+    channel->new_credits_incoming = rfcomm_channel_automatic_credits(channel);
+    rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
 }
 
 static void rfcomm_channel_accept_pn(rfcomm_channel_t *channel, rfcomm_channel_event_pn_t *event){
@@ -1351,11 +1505,8 @@ static void rfcomm_channel_finalize(rfcomm_channel_t *channel){
 
     rfcomm_multiplexer_t *multiplexer = channel->multiplexer;
 
-    // remove from list
-    btstack_linked_list_remove( &rfcomm_channels, (btstack_linked_item_t *) channel);
-
-    // free channel
-    btstack_memory_rfcomm_channel_free(channel);
+    // remove from list and free channel
+    rfcomm_channel_free(channel);
     
     // update multiplexer timeout after channel was removed from list
     rfcomm_multiplexer_prepare_idle_timer(multiplexer);
@@ -1374,7 +1525,7 @@ static void rfcomm_channel_state_machine_with_dlci(rfcomm_multiplexer_t * multip
     if (channel) {
         rfcomm_channel_state_machine_with_channel(channel, event);
         if (rfcomm_channel_ready_to_send(channel)){
-            l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+            rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
         }
         return;
     }
@@ -1385,7 +1536,7 @@ static void rfcomm_channel_state_machine_with_dlci(rfcomm_multiplexer_t * multip
     if (!service) {
         // discard request by sending disconnected mode
         multiplexer->send_dm_for_dlci = dlci;
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+        rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
         return;
     }
 
@@ -1400,7 +1551,7 @@ static void rfcomm_channel_state_machine_with_dlci(rfcomm_multiplexer_t * multip
             if (!channel){
                 // discard request by sending disconnected mode
                 multiplexer->send_dm_for_dlci = dlci;
-                l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+                rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
             }
             break;
         default:
@@ -1410,13 +1561,13 @@ static void rfcomm_channel_state_machine_with_dlci(rfcomm_multiplexer_t * multip
     if (!channel) {
         // discard request by sending disconnected mode
         multiplexer->send_dm_for_dlci = dlci;
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+        rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
         return;
     }
 
     rfcomm_channel_state_machine_with_channel(channel, event);
     if (rfcomm_channel_ready_to_send(channel)){
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+        rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
     }
 }
 
@@ -1569,7 +1720,7 @@ static void rfcomm_channel_packet_handler(rfcomm_multiplexer_t * multiplexer,  u
     
     // trigger next action - example W4_PN_RSP: transition to SEND_SABM which only depends on "can send"
     if (rfcomm_multiplexer_ready_to_send(multiplexer)){
-        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+        rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
     }
 }
 
@@ -1654,6 +1805,8 @@ static int rfcomm_channel_ready_to_send(rfcomm_channel_t * channel){
             return 1;
         case RFCOMM_CHANNEL_OPEN:
             if (channel->new_credits_incoming) { 
+                // credits are piggybacked on next data frame if client is about to send
+                if (channel->waiting_for_can_send_now && channel->credits_outgoing && (channel->multiplexer->fcon & 1)) break;
                 log_debug("ch-ready: channel open & new_credits_incoming") ; 
                 return 1;
             }
@@ -2034,6 +2187,10 @@ void rfcomm_init(void){
     rfcomm_multiplexers = NULL;
     rfcomm_services     = NULL;
     rfcomm_channels     = NULL;
+    memset(rfcomm_channels_by_rfcomm_cid,     0, sizeof(rfcomm_channels_by_rfcomm_cid));
+    memset(rfcomm_channels_by_dlci,           0, sizeof(rfcomm_channels_by_dlci));
+    memset(rfcomm_multiplexers_by_l2cap_cid,  0, sizeof(rfcomm_multiplexers_by_l2cap_cid));
+    memset(rfcomm_services_by_server_channel, 0, sizeof(rfcomm_services_by_server_channel));
     rfcomm_security_level = LEVEL_2;
 }
 
@@ -2057,7 +2214,7 @@ void rfcomm_request_can_send_now_event(uint16_t rfcomm_cid){
         return;
     }
     channel->waiting_for_can_send_now = 1;
-    l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+    rfcomm_request_l2cap_can_send_now_event(channel->multiplexer->l2cap_cid);
 }
 
 static int rfcomm_assert_send_valid(rfcomm_channel_t * channel , uint16_t len){
@@ -2089,7 +2246,7 @@ void rfcomm_release_packet_buffer(void){
 
 uint8_t * rfcomm_get_outgoing_buffer(void){
     uint8_t * rfcomm_out_buffer = l2cap_get_outgoing_buffer();
-    // address + control + length (16) + no credit field
+    // address + control + length (16) + no credit field, moved by rfcomm_send_uih_prepared if credits are piggybacked
     return &rfcomm_out_buffer[4];
 }
 
@@ -2122,13 +2279,23 @@ int rfcomm_send_prepared(uint16_t rfcomm_cid, uint16_t len){
     } else {
         log_info("sending empty RFCOMM packet for cid %02x", rfcomm_cid);
     }
+
+    // piggyback pending credits on data frame instead of sending separate credit frame
+    uint8_t new_credits = 0;
+    if (channel->state == RFCOMM_CHANNEL_OPEN && channel->new_credits_incoming){
+        new_credits = channel->new_credits_incoming;
+        channel->new_credits_incoming = 0;
+        channel->credits_incoming += new_credits;
+    }
         
-    int result = rfcomm_send_uih_prepared(channel->multiplexer, channel->dlci, len);
+    int result = rfcomm_send_uih_prepared(channel->multiplexer, channel->dlci, new_credits, len);
     
     if (result != 0) {
         if (len) {
             channel->credits_outgoing++;
         }
+        channel->credits_incoming    -= new_credits;
+        channel->new_credits_incoming = new_credits;
         log_error("rfcomm_send_prepared: error %d", result);
         return result;
     }
@@ -2260,19 +2427,19 @@ static uint8_t rfcomm_channel_create_internal(btstack_packet_handler_t packet_ha
         uint16_t l2cap_cid = 0;
         status = l2cap_create_channel(rfcomm_packet_handler, addr, BLUETOOTH_PROTOCOL_RFCOMM, l2cap_max_mtu(), &l2cap_cid);
         if (status) goto fail;
-        multiplexer->l2cap_cid = l2cap_cid;
+        rfcomm_multiplexer_set_l2cap_cid(multiplexer, l2cap_cid);
         return 0;
     }
     
     channel->state = RFCOMM_CHANNEL_SEND_UIH_PN;
     
     // start connecting, if multiplexer is already up and running
-    l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
+    rfcomm_request_l2cap_can_send_now_event(multiplexer->l2cap_cid);
     return 0;
 
 fail:
-    if (new_multiplexer) btstack_memory_rfcomm_multiplexer_free(multiplexer);
-    if (channel)         btstack_memory_rfcomm_channel_free(channel);
+    if (channel)         rfcomm_channel_free(channel);
+    if (new_multiplexer) rfcomm_multiplexer_free(multiplexer);
     return status;
 }
 
@@ -2290,7 +2457,7 @@ void rfcomm_disconnect(uint16_t rfcomm_cid){
     if (!channel) return;
 
     channel->state = RFCOMM_CHANNEL_SEND_DISC;
-    l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+    rfcomm_request_l2cap_can_send_now_event(channel->multiplexer->l2cap_cid);
 }
 
 static uint8_t rfcomm_register_service_internal(btstack_packet_handler_t packet_handler, 
@@ -2299,6 +2466,12 @@ static uint8_t rfcomm_register_service_internal(btstack_packet_handler_t packet_
     log_info("RFCOMM_REGISTER_SERVICE channel #%u mtu %u flow_control %u credits %u",
              channel, max_frame_size, incoming_flow_control, initial_credits);
 
+    // server channel has to fit into DLCI
+    if (channel == 0 || channel > RFCOMM_MAX_SERVER_CHANNEL){
+        log_error("RFCOMM_REGISTER_SERVICE invalid server channel #%u", channel);
+        return ERROR_CODE_UNSUPPORTED_FEATURE_OR_PARAMETER_VALUE;
+    }
+
     // check if already registered
     rfcomm_service_t * service = rfcomm_service_for_channel(channel);
     if (service){
@@ -2325,6 +2498,7 @@ static uint8_t rfcomm_register_service_internal(btstack_packet_handler_t packet_
     
     // add to services list
     btstack_linked_list_add(&rfcomm_services, (btstack_linked_item_t *) service);
+    rfcomm_services_by_server_channel[channel] = service;
     
     return 0;
 }
@@ -2346,6 +2520,7 @@ void rfcomm_unregister_service(uint8_t service_channel){
     rfcomm_service_t *service = rfcomm_service_for_channel(service_channel);
     if (!service) return;
     btstack_linked_list_remove(&rfcomm_services, (btstack_linked_item_t *) service);
+    rfcomm_services_by_server_channel[service_channel] = NULL;
     btstack_memory_rfcomm_service_free(service);
     
     // unregister if no services active
@@ -2364,11 +2539,11 @@ void rfcomm_accept_connection(uint16_t rfcomm_cid){
             rfcomm_channel_state_add(channel, RFCOMM_CHANNEL_STATE_VAR_CLIENT_ACCEPTED);
             if (channel->state_var & RFCOMM_CHANNEL_STATE_VAR_RCVD_PN){
                 rfcomm_channel_state_add(channel, RFCOMM_CHANNEL_STATE_VAR_SEND_PN_RSP);
-                l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+                rfcomm_request_l2cap_can_send_now_event(channel->multiplexer->l2cap_cid);
             }
             if (channel->state_var & RFCOMM_CHANNEL_STATE_VAR_RCVD_SABM){
                 rfcomm_channel_state_add(channel, RFCOMM_CHANNEL_STATE_VAR_SEND_UA);
-                l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+                rfcomm_request_l2cap_can_send_now_event(channel->multiplexer->l2cap_cid);
             }
             // at least one of { PN RSP, UA } needs to be sent
             // state transistion incoming setup -> dlc setup happens in rfcomm_run after these have been sent
@@ -2386,7 +2561,7 @@ void rfcomm_decline_connection(uint16_t rfcomm_cid){
     switch (channel->state) {
         case RFCOMM_CHANNEL_INCOMING_SETUP:
             channel->state = RFCOMM_CHANNEL_SEND_DM;
-            l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+            rfcomm_request_l2cap_can_send_now_event(channel->multiplexer->l2cap_cid);
             break;
         default:
             break;
@@ -2401,7 +2576,7 @@ void rfcomm_grant_credits(uint16_t rfcomm_cid, uint8_t credits){
     channel->new_credits_incoming += credits;
 
     // process
-    l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+    rfcomm_request_l2cap_can_send_now_event(channel->multiplexer->l2cap_cid);
 }
 
 
@@ -151,7 +151,7 @@ typedef struct {
 
 // info regarding multiplexer
 // note: spec mandates single multiplexer per device combination
-typedef struct {
+typedef struct rfcomm_multiplexer {
     // linked list - assert: first field
     btstack_linked_item_t    item;
     
@@ -161,6 +161,12 @@ typedef struct {
 	RFCOMM_MULTIPLEXER_STATE state;	
     
     uint16_t  l2cap_cid;
+
+    // next multiplexer in hash bucket for l2cap_cid
+    struct rfcomm_multiplexer * next_for_l2cap_cid;
+
+    // number of channels using this multiplexer
+    uint16_t  num_channels;
     
     uint8_t   fcon; // only send if fcon & 1, send rsp if fcon & 0x80
 
@@ -187,7 +193,7 @@ typedef struct {
 } rfcomm_multiplexer_t;
 
 // info regarding an actual connection
-typedef struct {
+typedef struct rfcomm_channel {
 
     // linked list - assert: first field
     btstack_linked_item_t    item;
@@ -206,6 +212,10 @@ typedef struct {
         
     // 
     uint8_t  dlci; 
+
+    // next channel in hash bucket for rfcomm_cid and for (multiplexer, dlci)
+    struct rfcomm_channel * next_for_rfcomm_cid;
+    struct rfcomm_channel * next_for_dlci;
     
     // credits for outgoing traffic
     uint8_t credits_outgoing;
@@ -215,6 +225,11 @@ typedef struct {
 
     // credits for incoming traffic
     uint8_t credits_incoming;
+
+    // automatic credit management: credits granted per round, incoming frames and time since last grant
+    uint8_t  credits_grant;
+    uint16_t credits_frames_received;
+    uint32_t credits_grant_time_ms;
     
     // use incoming flow control
     uint8_t incoming_flow_control;
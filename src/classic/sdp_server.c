@@ -62,6 +62,15 @@
 #define SDP_RESPONSE_BUFFER_SIZE (HCI_ACL_BUFFER_SIZE-HCI_ACL_HEADER_SIZE)
 #endif
 
+// cache for complete ServiceSearchAttribute responses
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+#ifndef SDP_RESPONSE_CACHE_SIZE
+#define SDP_RESPONSE_CACHE_SIZE 1024
+#endif
+// entry: ServiceSearchPattern len (2), AttributeIDList len (2), response len (2), ServiceSearchPattern, AttributeIDList, response
+#define SDP_RESPONSE_CACHE_ENTRY_HEADER_SIZE 6
+#endif
+
 static void sdp_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
 
 // registered service records
@@ -75,6 +84,11 @@ static uint8_t sdp_response_buffer[SDP_RESPONSE_BUFFER_SIZE];
 static uint16_t l2cap_cid = 0;
 static uint16_t sdp_response_size = 0;
 
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+static uint8_t  sdp_response_cache[SDP_RESPONSE_CACHE_SIZE];
+static uint16_t sdp_response_cache_used;
+#endif
+
 void sdp_init(void){
     // register with l2cap psm sevices - max MTU
     l2cap_register_service(sdp_packet_handler, BLUETOOTH_PROTOCOL_SDP, 0xffff, LEVEL_0);
@@ -106,6 +120,74 @@ uint8_t * sdp_get_record_for_handle(uint32_t handle){
     return record_item->service_record;
 }
 
+static void sdp_record_item_add_uuid(service_record_item_t * item, const uint8_t * uuid128){
+    if (!uuid_has_bluetooth_prefix(uuid128)){
+        item->uuid32_index_incomplete = 1;
+        return;
+    }
+    uint32_t uuid32 = big_endian_read_32(uuid128, 0);
+    int i;
+    for (i=0;i<item->uuid32_index_count;i++){
+        if (item->uuid32_index[i] == uuid32) return;
+    }
+    if (item->uuid32_index_count >= SDP_RECORD_UUID_INDEX_SIZE){
+        item->uuid32_index_incomplete = 1;
+        return;
+    }
+    item->uuid32_index[item->uuid32_index_count++] = uuid32;
+}
+
+// collect UUIDs in same way as sdp_record_contains_UUID128: recurse into nested DES
+static void sdp_record_item_index_uuids(service_record_item_t * item, uint8_t * des){
+    des_iterator_t it;
+    for (des_iterator_init(&it, des); des_iterator_has_more(&it); des_iterator_next(&it)){
+        uint8_t * element = des_iterator_get_element(&it);
+        uint8_t uuid128[16];
+        switch (des_iterator_get_type(&it)){
+            case DE_UUID:
+                if (de_get_normalized_uuid(uuid128, element)){
+                    sdp_record_item_add_uuid(item, uuid128);
+                }
+                break;
+            case DE_DES:
+                sdp_record_item_index_uuids(item, element);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static int sdp_record_item_contains_uuid128(service_record_item_t * item, uint8_t * uuid128){
+    if (uuid_has_bluetooth_prefix(uuid128)){
+        uint32_t uuid32 = big_endian_read_32(uuid128, 0);
+        int i;
+        for (i=0;i<item->uuid32_index_count;i++){
+            if (item->uuid32_index[i] == uuid32) return 1;
+        }
+    }
+    if (!item->uuid32_index_incomplete) return 0;
+    return sdp_record_contains_UUID128(item->service_record, uuid128);
+}
+
+// same result as sdp_record_matches_service_search_pattern, but uses UUID index of service record
+static int sdp_record_item_matches_service_search_pattern(service_record_item_t * item, uint8_t * serviceSearchPattern){
+    des_iterator_t it;
+    if (!des_iterator_init(&it, serviceSearchPattern)) return 1;
+    for ( ; des_iterator_has_more(&it); des_iterator_next(&it)){
+        uint8_t uuid128[16];
+        if (!de_get_normalized_uuid(uuid128, des_iterator_get_element(&it))) return 0;
+        if (!sdp_record_item_contains_uuid128(item, uuid128)) return 0;
+    }
+    return 1;
+}
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+static void sdp_response_cache_flush(void){
+    sdp_response_cache_used = 0;
+}
+#endif
+
 // get next free, unregistered service record handle
 uint32_t sdp_create_service_record_handle(void){
     uint32_t handle = 0;
@@ -138,9 +220,18 @@ uint8_t sdp_register_service(const uint8_t * record){
     // set handle and record
     newRecordItem->service_record_handle = record_handle;
     newRecordItem->service_record = (uint8_t*) record;
+
+    // index UUIDs for service search
+    newRecordItem->uuid32_index_count = 0;
+    newRecordItem->uuid32_index_incomplete = 0;
+    sdp_record_item_index_uuids(newRecordItem, newRecordItem->service_record);
     
     // add to linked list
     btstack_linked_list_add(&sdp_service_records, (btstack_linked_item_t *) newRecordItem);
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    sdp_response_cache_flush();
+#endif
     
     return 0;
 }
@@ -153,6 +244,9 @@ void sdp_unregister_service(uint32_t service_record_handle){
     if (!record_item) return;
     btstack_linked_list_remove(&sdp_service_records, (btstack_linked_item_t *) record_item);
     btstack_memory_service_record_item_free(record_item);
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    sdp_response_cache_flush();
+#endif
 }
 
 // PDU
@@ -201,7 +295,7 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     uint16_t total_service_count   = 0;
     for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
         service_record_item_t * item = (service_record_item_t *) it;
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
         total_service_count++;
     }
     if (total_service_count > maximumServiceRecordCount){
@@ -216,7 +310,7 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next, ++current_service_index){
         service_record_item_t * item = (service_record_item_t *) it;
 
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
         matching_service_count++;
         
         if (current_service_index < continuation_index) continue;
@@ -339,7 +433,7 @@ static uint16_t sdp_get_size_for_service_search_attribute_response(uint8_t * ser
     for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
         service_record_item_t * item = (service_record_item_t *) it;
         
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
         
         // for all service records that match
         total_response_size += 3 + spd_get_filtered_size(item->service_record, attributeIDList);
@@ -347,6 +441,103 @@ static uint16_t sdp_get_size_for_service_search_attribute_response(uint8_t * ser
     return total_response_size;
 }
 
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+static const uint8_t * sdp_response_cache_lookup(const uint8_t * serviceSearchPattern, uint16_t serviceSearchPatternLen, 
+    const uint8_t * attributeIDList, uint16_t attributeIDListLen, uint16_t * response_len){
+    uint16_t pos = 0;
+    while (pos < sdp_response_cache_used){
+        const uint8_t * entry = &sdp_response_cache[pos];
+        uint16_t entry_pattern_len   = little_endian_read_16(entry, 0);
+        uint16_t entry_attribute_len = little_endian_read_16(entry, 2);
+        uint16_t entry_response_len  = little_endian_read_16(entry, 4);
+        const uint8_t * entry_pattern   = &entry[SDP_RESPONSE_CACHE_ENTRY_HEADER_SIZE];
+        const uint8_t * entry_attribute = &entry_pattern[entry_pattern_len];
+        if ((entry_pattern_len == serviceSearchPatternLen) && (entry_attribute_len == attributeIDListLen)
+        &&  (memcmp(entry_pattern, serviceSearchPattern, serviceSearchPatternLen) == 0)
+        &&  (memcmp(entry_attribute, attributeIDList, attributeIDListLen) == 0)){
+            *response_len = entry_response_len;
+            return &entry_attribute[entry_attribute_len];
+        }
+        pos += SDP_RESPONSE_CACHE_ENTRY_HEADER_SIZE + entry_pattern_len + entry_attribute_len + entry_response_len;
+    }
+    return NULL;
+}
+
+// serialize complete AttributeLists for all matching service records into cache
+static const uint8_t * sdp_response_cache_add(uint8_t * serviceSearchPattern, uint16_t serviceSearchPatternLen, 
+    uint8_t * attributeIDList, uint16_t attributeIDListLen, uint16_t * response_len){
+    uint32_t response_size = 3 + sdp_get_size_for_service_search_attribute_response(serviceSearchPattern, attributeIDList);
+    uint32_t entry_size = SDP_RESPONSE_CACHE_ENTRY_HEADER_SIZE + serviceSearchPatternLen + attributeIDListLen + response_size;
+    if (entry_size > SDP_RESPONSE_CACHE_SIZE) return NULL;
+
+    // drop all entries if there's not enough space left
+    if (sdp_response_cache_used + entry_size > SDP_RESPONSE_CACHE_SIZE){
+        sdp_response_cache_flush();
+    }
+
+    uint8_t * entry = &sdp_response_cache[sdp_response_cache_used];
+    little_endian_store_16(entry, 0, serviceSearchPatternLen);
+    little_endian_store_16(entry, 2, attributeIDListLen);
+    little_endian_store_16(entry, 4, response_size);
+    uint16_t pos = SDP_RESPONSE_CACHE_ENTRY_HEADER_SIZE;
+    memcpy(&entry[pos], serviceSearchPattern, serviceSearchPatternLen);
+    pos += serviceSearchPatternLen;
+    memcpy(&entry[pos], attributeIDList, attributeIDListLen);
+    pos += attributeIDListLen;
+
+    uint8_t * response = &entry[pos];
+    de_store_descriptor_with_len(response, DE_DES, DE_SIZE_VAR_16, response_size - 3);
+    pos = 3;
+    btstack_linked_item_t *it;
+    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
+        service_record_item_t * item = (service_record_item_t *) it;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
+        uint16_t filtered_attributes_size = spd_get_filtered_size(item->service_record, attributeIDList);
+        de_store_descriptor_with_len(&response[pos], DE_DES, DE_SIZE_VAR_16, filtered_attributes_size);
+        pos += 3;
+        uint16_t bytes_used;
+        sdp_filter_attributes_in_attributeIDList(item->service_record, attributeIDList, 0, filtered_attributes_size, &bytes_used, &response[pos]);
+        pos += bytes_used;
+    }
+
+    sdp_response_cache_used += entry_size;
+    log_info("SDP response cache: added response with %u bytes, %u of %u bytes used", (int) response_size, sdp_response_cache_used, SDP_RESPONSE_CACHE_SIZE);
+    *response_len = response_size;
+    return response;
+}
+
+static int sdp_create_service_search_attribute_response_from_cache(uint16_t transaction_id, const uint8_t * response, uint16_t response_len,
+    uint16_t offset, uint16_t maximumAttributeByteCount){
+    // AttributeLists - starts at offset 7
+    uint16_t pos = 7;
+    uint16_t attributeListsByteCount = response_len - offset;
+    if (attributeListsByteCount > maximumAttributeByteCount){
+        attributeListsByteCount = maximumAttributeByteCount;
+    }
+    memcpy(&sdp_response_buffer[pos], &response[offset], attributeListsByteCount);
+    pos += attributeListsByteCount;
+    offset += attributeListsByteCount;
+
+    // Continuation State: offset into cached response
+    if (offset < response_len){
+        sdp_response_buffer[pos++] = 2;
+        big_endian_store_16(sdp_response_buffer, pos, offset);
+        pos += 2;
+    } else {
+        // complete
+        sdp_response_buffer[pos++] = 0;
+    }
+
+    // create SDP header
+    sdp_response_buffer[0] = SDP_ServiceSearchAttributeResponse;
+    big_endian_store_16(sdp_response_buffer, 1, transaction_id);
+    big_endian_store_16(sdp_response_buffer, 3, pos - 5);  // size of variable payload
+    big_endian_store_16(sdp_response_buffer, 5, attributeListsByteCount);
+    
+    return pos;
+}
+#endif
+
 int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remote_mtu){
     
     // SDP header before attribute sevice list: 7
@@ -379,6 +570,30 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
     if (maximumAttributeByteCount2 < maximumAttributeByteCount) {
         maximumAttributeByteCount = maximumAttributeByteCount2;
     }
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    // serve complete response from cache, continuation state contains: byte offset into cached response
+    if (continuationState[0] == 0 || continuationState[0] == 2){
+        uint16_t cached_response_len = 0;
+        const uint8_t * cached_response = sdp_response_cache_lookup(serviceSearchPattern, serviceSearchPatternLen, attributeIDList, attributeIDListLen, &cached_response_len);
+        if (!cached_response){
+            cached_response = sdp_response_cache_add(serviceSearchPattern, serviceSearchPatternLen, attributeIDList, attributeIDListLen, &cached_response_len);
+        }
+        if (cached_response){
+            uint16_t offset = 0;
+            if (continuationState[0] == 2){
+                offset = big_endian_read_16(continuationState, 1);
+            }
+            if (offset > cached_response_len){
+                return sdp_create_error_response(transaction_id, 0x0005); // invalid continuation state
+            }
+            return sdp_create_service_search_attribute_response_from_cache(transaction_id, cached_response, cached_response_len, offset, maximumAttributeByteCount);
+        }
+        if (continuationState[0] == 2){
+            return sdp_create_error_response(transaction_id, 0x0005); // invalid continuation state
+        }
+    }
+#endif
     
     // continuation state contains: index of next service record to examine
     // continuation state contains: byte offset into this service record
@@ -412,7 +627,7 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
         service_record_item_t * item = (service_record_item_t *) it;
         
         if (current_service_index < continuation_service_index ) continue;
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
 
         if (continuation_offset == 0){
             
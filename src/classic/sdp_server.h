@@ -46,12 +46,23 @@
 extern "C" {
 #endif
     
+// max number of UUIDs based on the Bluetooth Base UUID indexed per service record
+#ifndef SDP_RECORD_UUID_INDEX_SIZE
+#define SDP_RECORD_UUID_INDEX_SIZE 10
+#endif
+
 typedef struct {
     // linked list - assert: first field
     btstack_linked_item_t   item;
 
     uint32_t        service_record_handle;
     uint8_t *       service_record;
+
+    // UUIDs contained in service record, built on registration
+    uint32_t        uuid32_index[SDP_RECORD_UUID_INDEX_SIZE];
+    uint8_t         uuid32_index_count;
+    // record contains UUIDs not listed in index (128-bit UUIDs or index full)
+    uint8_t         uuid32_index_incomplete;
 } service_record_item_t;
 
 int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu);
@@ -602,7 +602,6 @@ struct sdp_context_contains_uuid128 {
     uint8_t * uuid128;
     int result;
 };
-int sdp_record_contains_UUID128(uint8_t *record, uint8_t *uuid128);
 static int sdp_traversal_contains_UUID128(uint8_t * element, de_type_t type, de_size_t de_size, void *my_context){
     UNUSED(de_size);
 
@@ -119,6 +119,7 @@ uint16_t  sdp_append_attributes_in_attributeIDList(uint8_t *record, uint8_t *att
 uint8_t * sdp_get_attribute_value_for_attribute_id(uint8_t * record, uint16_t attributeID);
 uint8_t   sdp_set_attribute_value_for_attribute_id(uint8_t * record, uint16_t attributeID, uint32_t value);
 int       sdp_record_matches_service_search_pattern(uint8_t *record, uint8_t *serviceSearchPattern);
+int       sdp_record_contains_UUID128(uint8_t *record, uint8_t *uuid128);
 int       spd_get_filtered_size(uint8_t *record, uint8_t *attributeIDList);
 int       sdp_filter_attributes_in_attributeIDList(uint8_t *record, uint8_t *attributeIDList, uint16_t startOffset, uint16_t maxBytes, uint16_t *usedBytes, uint8_t *buffer);  
 int       sdp_attribute_list_constains_id(uint8_t *attributeIDList, uint16_t attributeID);
@@ -44,6 +44,7 @@ extern "C" {
 
 #include "btstack_defines.h"
 #include "btstack_util.h"
+#include "ad_filter.h"
 #include "classic/btstack_link_key_db.h"
 
 typedef enum {
@@ -223,6 +224,13 @@ void gap_start_scan(void);
  */
 void gap_stop_scan(void);
 
+/**
+ * @brief Filter LE Advertising Reports before GAP_EVENT_ADVERTISING_REPORT is emitted
+ * @note requires ENABLE_LE_ADVERTISING_REPORT_FILTER
+ * @param filter or NULL to report all advertisements
+ */
+void gap_set_advertising_report_filter(ad_filter_t * filter);
+
 /**
  * @brief Enable privacy by using random addresses
  * @param random_address_type to use (incl. OFF)
@@ -75,6 +75,7 @@
 #include "gap.h"
 #include "hci.h"
 #include "hci_cmd.h"
+#include "hci_cmd_encoder.h"
 #include "hci_dump.h"
 #include "ad_parser.h"
 
@@ -150,6 +151,11 @@ static void hci_emit_dedicated_bonding_result(bd_addr_t address, uint8_t status)
 static void hci_emit_event(uint8_t * event, uint16_t size, int dump);
 static void hci_emit_acl_packet(uint8_t * packet, uint16_t size);
 static void hci_run(void);
+static void hci_initializing_command_complete(void);
+#ifdef ENABLE_BLE
+static uint8_t * hci_reserve_cmd_packet_buffer(void);
+static int  hci_send_encoded_cmd_packet(uint16_t size);
+#endif
 static int  hci_is_le_connection(hci_connection_t * connection);
 static int  hci_number_free_acl_slots_for_connection_type( bd_addr_type_t address_type);
 
@@ -529,9 +535,64 @@ static int hci_can_send_comand_packet_transport(void){
 // new functions replacing hci_can_send_packet_now[_using_packet_buffer]
 int hci_can_send_command_packet_now(void){
     if (hci_can_send_comand_packet_transport() == 0) return 0;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    if (hci_stack->serialized_cmd_opcode) return 0;
+#endif
     return hci_stack->num_cmd_packets > 0;
 }
 
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+// commands that change controller state in a way later commands depend on, or that may not get a regular
+// Command Complete (vendor commands), are not followed by other commands until they are complete
+static int hci_command_requires_serialization(uint16_t opcode){
+    if (opcode == hci_reset.opcode) return 1;
+    if ((opcode >> 10) == OGF_VENDOR) return 1;
+#ifdef ENABLE_BLE
+    if (opcode == hci_le_create_connection_cancel.opcode) return 1;
+#endif
+    return 0;
+}
+#endif
+
+// assume that one command can be sent and forget about commands in flight
+static void hci_command_flow_control_reset(void){
+    hci_stack->num_cmd_packets = 1;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    hci_stack->num_cmds_in_flight = 0;
+    hci_stack->serialized_cmd_opcode = 0;
+#endif
+}
+
+// handle Num_HCI_Command_Packets from HCI Command Complete / Command Status, opcode 0x0000 does not complete a command
+static void hci_command_flow_control_update(uint16_t opcode, uint8_t num_hci_command_packets){
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    if (opcode != 0 && hci_stack->num_cmds_in_flight > 0){
+        hci_stack->num_cmds_in_flight--;
+    }
+    if (opcode == hci_stack->serialized_cmd_opcode){
+        hci_stack->serialized_cmd_opcode = 0;
+    }
+    // HCI Reset discards all pending commands
+    if (opcode == hci_reset.opcode){
+        hci_stack->num_cmds_in_flight = 0;
+    }
+    if (num_hci_command_packets > hci_stack->num_cmd_packets_max){
+        hci_stack->num_cmd_packets_max = num_hci_command_packets;
+    }
+    // Num_HCI_Command_Packets is from the time the event was created: commands sent since then
+    // have not been accounted for by the controller, so limit by the commands still in flight
+    int num_cmd_packets = btstack_min(hci_stack->num_cmd_packets_max, HCI_COMMAND_PIPELINING_DEPTH) - hci_stack->num_cmds_in_flight;
+    if (num_cmd_packets < 0){
+        num_cmd_packets = 0;
+    }
+    hci_stack->num_cmd_packets = btstack_min(num_hci_command_packets, num_cmd_packets);
+#else
+    UNUSED(opcode);
+    // limit to 1 to reduce complexity
+    hci_stack->num_cmd_packets = num_hci_command_packets ? 1 : 0;
+#endif
+}
+
 static int hci_transport_can_send_prepared_packet_now(uint8_t packet_type){
     // check for async hci transport implementations
     if (!hci_stack->hci_transport->can_send_packet_now) return 1;
@@ -605,6 +666,26 @@ static int hci_transport_synchronous(void){
     return hci_stack->hci_transport->can_send_packet_now == NULL;
 }
 
+#ifdef ENABLE_LATENCY_TRACE
+static void hci_latency_trace_acl_sent(hci_connection_t * connection, uint32_t timestamp){
+    connection->latency_trace_tx_timestamps[connection->latency_trace_tx_sent % LATENCY_TRACE_TX_TIMESTAMPS] = timestamp;
+    connection->latency_trace_tx_sent++;
+}
+
+static void hci_latency_trace_acl_completed(hci_connection_t * connection, uint16_t num_packets){
+    while (num_packets--){
+        uint16_t packets_in_flight = connection->latency_trace_tx_sent - connection->latency_trace_tx_completed;
+        if (packets_in_flight == 0) return;
+        // time stamp was overwritten if more than LATENCY_TRACE_TX_TIMESTAMPS packets are in flight
+        if (packets_in_flight <= LATENCY_TRACE_TX_TIMESTAMPS){
+            btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_TX_CONTROLLER,
+                connection->latency_trace_tx_timestamps[connection->latency_trace_tx_completed % LATENCY_TRACE_TX_TIMESTAMPS]);
+        }
+        connection->latency_trace_tx_completed++;
+    }
+}
+#endif
+
 static int hci_send_acl_packet_fragments(hci_connection_t *connection){
 
     // log_info("hci_send_acl_packet_fragments  %u/%u (con 0x%04x)", hci_stack->acl_fragmentation_pos, hci_stack->acl_fragmentation_total_size, connection->con_handle);
@@ -665,6 +746,9 @@ static int hci_send_acl_packet_fragments(hci_connection_t *connection){
         uint8_t * packet = &hci_stack->hci_packet_buffer[acl_header_pos];
         const int size = current_acl_data_packet_length + 4;
         hci_dump_packet(HCI_ACL_DATA_PACKET, 0, packet, size);
+#ifdef ENABLE_LATENCY_TRACE
+        hci_latency_trace_acl_sent(connection, btstack_latency_trace_tx_fragment(!more_fragments));
+#endif
         err = hci_stack->hci_transport->send_packet(HCI_ACL_DATA_PACKET, packet, size);
 
         log_debug("hci_send_acl_packet_fragments loop after send (more fragments %d)", more_fragments);
@@ -680,6 +764,9 @@ static int hci_send_acl_packet_fragments(hci_connection_t *connection){
 
     // release buffer now for synchronous transport
     if (hci_transport_synchronous()){
+#ifdef ENABLE_LATENCY_TRACE
+        btstack_latency_trace_tx_sent();
+#endif
         hci_release_packet_buffer();
         // notify upper stack that it might be possible to send again
         uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
@@ -699,6 +786,11 @@ int hci_send_acl_packet_buffer(int size){
         return 0;
     }
 
+#ifdef ENABLE_LATENCY_TRACE
+    // also consumes time stamp of reserved packet buffer if packet gets dropped
+    btstack_latency_trace_tx_acl();
+#endif
+
     uint8_t * packet = hci_stack->hci_packet_buffer;
     hci_con_handle_t con_handle = READ_ACL_CONNECTION_HANDLE(packet);
 
@@ -777,10 +869,15 @@ int hci_send_sco_packet_buffer(int size){
 }
 #endif
 
-static void acl_handler(uint8_t *packet, int size){
+// @param received_us time the transport delivered the packet, only used with ENABLE_LATENCY_TRACE
+static void acl_handler(uint8_t *packet, int size, uint32_t received_us){
 
     // log_info("acl_handler: size %u", size);
 
+#ifndef ENABLE_LATENCY_TRACE
+    UNUSED(received_us);
+#endif
+
     // get info
     hci_con_handle_t con_handle = READ_ACL_CONNECTION_HANDLE(packet);
     hci_connection_t *conn      = hci_connection_for_handle(con_handle);
@@ -835,6 +932,9 @@ static void acl_handler(uint8_t *packet, int size){
             
             // forward complete L2CAP packet if complete. 
             if (conn->acl_recombination_pos >= conn->acl_recombination_length + 4 + 4){ // pos already incl. ACL header
+#ifdef ENABLE_LATENCY_TRACE
+                btstack_latency_trace_rx_acl(conn->latency_trace_rx_timestamp);
+#endif
                 hci_emit_acl_packet(&conn->acl_recombination_buffer[HCI_INCOMING_PRE_BUFFER_SIZE], conn->acl_recombination_pos);
                 // reset recombination buffer
                 conn->acl_recombination_length = 0;
@@ -858,6 +958,9 @@ static void acl_handler(uint8_t *packet, int size){
             // compare fragment size to L2CAP packet size
             if (acl_length >= l2cap_length + 4){
                 // forward fragment as L2CAP packet
+#ifdef ENABLE_LATENCY_TRACE
+                btstack_latency_trace_rx_acl(received_us);
+#endif
                 hci_emit_acl_packet(packet, acl_length + 4);
             } else {
 
@@ -871,6 +974,9 @@ static void acl_handler(uint8_t *packet, int size){
                 memcpy(&conn->acl_recombination_buffer[HCI_INCOMING_PRE_BUFFER_SIZE], packet, acl_length + 4);
                 conn->acl_recombination_pos    = acl_length + 4;
                 conn->acl_recombination_length = l2cap_length;
+#ifdef ENABLE_LATENCY_TRACE
+                conn->latency_trace_rx_timestamp = received_us;
+#endif
                 little_endian_store_16(conn->acl_recombination_buffer, HCI_INCOMING_PRE_BUFFER_SIZE + 2, l2cap_length +4);
             }
             break;
@@ -1035,6 +1141,20 @@ void le_handle_advertisement_report(uint8_t *packet, uint16_t size){
     uint8_t event[12 + LE_ADVERTISING_DATA_SIZE]; // use upper bound to avoid var size automatic var
     for (i=0; i<num_reports && offset < size;i++){
         uint8_t data_length = btstack_min( packet[offset + 8], LE_ADVERTISING_DATA_SIZE);
+#ifdef ENABLE_LE_ADVERTISING_REPORT_FILTER
+        // drop filtered reports before creating and dumping event
+        if (hci_stack->le_advertising_report_filter){
+            // allow-list uses bd_addr_t, report has little endian address
+            bd_addr_t address;
+            reverse_bd_addr(&packet[offset + 2], address);
+            int8_t rssi = (int8_t) packet[offset + 9 + data_length];
+            if (!ad_filter_match(hci_stack->le_advertising_report_filter, packet[offset + 1], address,
+                                 rssi, data_length, &packet[offset + 9], btstack_run_loop_get_time_ms())){
+                offset += 10 + data_length;
+                continue;
+            }
+        }
+#endif
         uint8_t event_size = 10 + data_length;
         int pos = 0;
         event[pos++] = GAP_EVENT_ADVERTISING_REPORT;
@@ -1097,7 +1217,7 @@ static void hci_initialization_timeout_handler(btstack_timer_source_t * ds){
         case HCI_INIT_W4_SEND_RESET:
             log_info("Resend HCI Reset");
             hci_stack->substate = HCI_INIT_SEND_RESET;
-            hci_stack->num_cmd_packets = 1;
+            hci_command_flow_control_reset();
             hci_run();
             break;
         case HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT_LINK_RESET:
@@ -1109,7 +1229,7 @@ static void hci_initialization_timeout_handler(btstack_timer_source_t * ds){
         case HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT:
             log_info("Resend HCI Reset - CSR Warm Boot");
             hci_stack->substate = HCI_INIT_SEND_RESET_CSR_WARM_BOOT;
-            hci_stack->num_cmd_packets = 1;
+            hci_command_flow_control_reset();
             hci_run();
             break;
         case HCI_INIT_W4_SEND_BAUD_CHANGE:
@@ -1143,6 +1263,97 @@ static void hci_initializing_next_state(void){
     hci_stack->substate = (hci_substate_t )( ((int) hci_stack->substate) + 1);
 }
 
+// log duration of current init phase and start next one
+static void hci_initializing_phase_done(const char * phase){
+    uint32_t now = btstack_run_loop_get_time_ms();
+    log_info("HCI init: %s took %u ms", phase, (unsigned int) (now - hci_stack->init_phase_start_ms));
+    hci_stack->init_phase_start_ms = now;
+}
+
+#if !defined(HAVE_PLATFORM_IPHONE_OS) && !defined (HAVE_HOST_CONTROLLER_API)
+// send init script command in hci packet buffer and wait for its completion
+static void hci_initializing_custom_init_send(int valid_cmd){
+    int size = 3 + hci_stack->hci_packet_buffer[2];
+    hci_stack->last_cmd_opcode = little_endian_read_16(hci_stack->hci_packet_buffer, 0);
+    hci_dump_packet(HCI_COMMAND_DATA_PACKET, 0, hci_stack->hci_packet_buffer, size);
+    switch (valid_cmd) {
+        case BTSTACK_CHIPSET_VALID_COMMAND:
+        case BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED:
+            hci_stack->substate = HCI_INIT_W4_CUSTOM_INIT;
+            break;
+        case BTSTACK_CHIPSET_WARMSTART_REQUIRED:
+            // CSR Warm Boot: Wait a bit, then send HCI Reset until HCI Command Complete
+            log_info("CSR Warm Boot");
+            btstack_run_loop_set_timer(&hci_stack->timeout, HCI_RESET_RESEND_TIMEOUT_MS);
+            btstack_run_loop_set_timer_handler(&hci_stack->timeout, hci_initialization_timeout_handler);
+            btstack_run_loop_add_timer(&hci_stack->timeout);
+            if (hci_stack->manufacturer == BLUETOOTH_COMPANY_ID_CAMBRIDGE_SILICON_RADIO
+                && hci_stack->config
+                && hci_stack->chipset
+                // && hci_stack->chipset->set_baudrate_command -- there's no such command
+                && hci_stack->hci_transport->set_baudrate
+                && hci_transport_uart_get_main_baud_rate()){
+                hci_stack->substate = HCI_INIT_W4_SEND_BAUD_CHANGE;
+            } else {
+               hci_stack->substate = HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT_LINK_RESET;
+            }
+            break;
+        default:
+            // should not get here
+            break;
+    }
+    hci_stack->hci_transport->send_packet(HCI_COMMAND_DATA_PACKET, hci_stack->hci_packet_buffer, size);
+}
+
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+// send init script command without waiting for its Command Complete, substate stays HCI_INIT_CUSTOM_INIT
+static void hci_initializing_custom_init_send_pipelined(void){
+    int size = 3 + hci_stack->hci_packet_buffer[2];
+    hci_stack->init_pipelined_cmd_opcodes[hci_stack->init_pipelined_cmds_num++] = little_endian_read_16(hci_stack->hci_packet_buffer, 0);
+    hci_stack->num_cmd_packets--;
+    hci_stack->num_cmds_in_flight++;
+    hci_dump_packet(HCI_COMMAND_DATA_PACKET, 0, hci_stack->hci_packet_buffer, size);
+    hci_stack->hci_transport->send_packet(HCI_COMMAND_DATA_PACKET, hci_stack->hci_packet_buffer, size);
+}
+#endif
+
+static void hci_initializing_custom_init_done(int init_script_sent){
+    if (init_script_sent){
+        log_info("Init script done, %u commands", hci_stack->init_script_cmds_num);
+        hci_initializing_phase_done("init script");
+
+        // Init script download on Broadcom chipsets causes:
+        if (hci_stack->manufacturer == BLUETOOTH_COMPANY_ID_BROADCOM_CORPORATION 
+        ||  hci_stack->manufacturer == BLUETOOTH_COMPANY_ID_EM_MICROELECTRONIC_MARIN_SA){
+
+            // - baud rate to reset, restore UART baud rate if needed
+            int need_baud_change = hci_stack->config
+                && hci_stack->chipset
+                && hci_stack->chipset->set_baudrate_command
+                && hci_stack->hci_transport->set_baudrate
+                && ((hci_transport_config_uart_t *)hci_stack->config)->baudrate_main;
+            if (need_baud_change) {
+                uint32_t baud_rate = ((hci_transport_config_uart_t *)hci_stack->config)->baudrate_init;
+                log_info("Local baud rate change to %"PRIu32" after init script (bcm)", baud_rate);
+                hci_stack->hci_transport->set_baudrate(baud_rate);
+            }
+
+            // - RTS will raise during update, but manual RTS/CTS in WICED port on RedBear Duo cannot handle this
+            //   -> Work around: wait a few milliseconds here.
+            log_info("BCM delay after init script");
+            hci_stack->substate = HCI_INIT_W4_CUSTOM_INIT_BCM_DELAY;
+            btstack_run_loop_set_timer(&hci_stack->timeout, 10);
+            btstack_run_loop_set_timer_handler(&hci_stack->timeout, hci_initialization_timeout_handler);
+            btstack_run_loop_add_timer(&hci_stack->timeout);
+            return;
+        }
+    }
+    // otherwise continue
+    hci_stack->substate = HCI_INIT_W4_READ_LOCAL_SUPPORTED_COMMANDS;
+    hci_send_cmd(&hci_read_local_supported_commands);
+}
+#endif
+
 #if defined(ENABLE_CLASSIC) || defined(ENABLE_LE_PERIPHERAL)
 static void hci_replace_bd_addr_placeholder(uint8_t * data, uint16_t size){
     const int bd_addr_string_len = 17;
@@ -1159,9 +1370,56 @@ static void hci_replace_bd_addr_placeholder(uint8_t * data, uint16_t size){
 }
 #endif
 
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+// init steps that only configure the controller: the following steps don't depend on their result
+static int hci_initializing_command_can_be_pipelined(hci_substate_t substate){
+    switch (substate){
+        case HCI_INIT_SET_EVENT_MASK:
+#ifdef ENABLE_CLASSIC
+        case HCI_INIT_WRITE_SIMPLE_PAIRING_MODE:
+        case HCI_INIT_WRITE_PAGE_TIMEOUT:
+        case HCI_INIT_WRITE_CLASS_OF_DEVICE:
+        case HCI_INIT_WRITE_LOCAL_NAME:
+        case HCI_INIT_WRITE_EIR_DATA:
+        case HCI_INIT_WRITE_INQUIRY_MODE:
+        case HCI_INIT_WRITE_SCAN_ENABLE:
+        case HCI_INIT_WRITE_SYNCHRONOUS_FLOW_CONTROL_ENABLE:
+        case HCI_INIT_WRITE_DEFAULT_ERRONEOUS_DATA_REPORTING:
+        case HCI_INIT_BCM_WRITE_SCO_PCM_INT:
+#endif
+#ifdef ENABLE_BLE
+        case HCI_INIT_LE_SET_EVENT_MASK:
+        case HCI_INIT_WRITE_LE_HOST_SUPPORTED:
+#endif
+#ifdef ENABLE_LE_DATA_LENGTH_EXTENSION
+        case HCI_INIT_LE_WRITE_SUGGESTED_DATA_LENGTH:
+#endif
+#ifdef ENABLE_LE_CENTRAL
+        case HCI_INIT_LE_SET_SCAN_PARAMETERS:
+#endif
+            return 1;
+        default:
+            return 0;
+    }
+}
+#endif
+
 // assumption: hci_can_send_command_packet_now() == true
 static void hci_initializing_run(void){
     log_debug("hci_initializing_run: substate %u, can send %u", hci_stack->substate, hci_can_send_command_packet_now());
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    // steps that need the result of earlier steps wait until all pipelined commands are complete
+    hci_substate_t substate = hci_stack->substate;
+    int pipeline_command = hci_initializing_command_can_be_pipelined(substate);
+    if (hci_stack->init_pipelined_cmds_num > 0){
+        if (!pipeline_command && substate != HCI_INIT_CUSTOM_INIT) return;
+        if (hci_stack->init_pipelined_cmds_num >= HCI_COMMAND_PIPELINING_DEPTH) return;
+    }
+    // only worth it if the controller accepts more than a single command
+    if (hci_stack->num_cmd_packets_max < 2){
+        pipeline_command = 0;
+    }
+#endif
     switch (hci_stack->substate){
         case HCI_INIT_SEND_RESET:
             hci_state_reset();
@@ -1228,69 +1486,42 @@ static void hci_initializing_run(void){
             if (hci_stack->chipset && hci_stack->chipset->next_command){
                 int valid_cmd = (*hci_stack->chipset->next_command)(hci_stack->hci_packet_buffer);
                 if (valid_cmd){
-                    int size = 3 + hci_stack->hci_packet_buffer[2];
-                    hci_stack->last_cmd_opcode = little_endian_read_16(hci_stack->hci_packet_buffer, 0);
-                    hci_dump_packet(HCI_COMMAND_DATA_PACKET, 0, hci_stack->hci_packet_buffer, size);
-                    switch (valid_cmd) {
-                        case BTSTACK_CHIPSET_VALID_COMMAND:
-                            hci_stack->substate = HCI_INIT_W4_CUSTOM_INIT;
-                            break;
-                        case BTSTACK_CHIPSET_WARMSTART_REQUIRED:
-                            // CSR Warm Boot: Wait a bit, then send HCI Reset until HCI Command Complete
-                            log_info("CSR Warm Boot");
-                            btstack_run_loop_set_timer(&hci_stack->timeout, HCI_RESET_RESEND_TIMEOUT_MS);
-                            btstack_run_loop_set_timer_handler(&hci_stack->timeout, hci_initialization_timeout_handler);
-                            btstack_run_loop_add_timer(&hci_stack->timeout);
-                            if (hci_stack->manufacturer == BLUETOOTH_COMPANY_ID_CAMBRIDGE_SILICON_RADIO
-                                && hci_stack->config
-                                && hci_stack->chipset
-                                // && hci_stack->chipset->set_baudrate_command -- there's no such command
-                                && hci_stack->hci_transport->set_baudrate
-                                && hci_transport_uart_get_main_baud_rate()){
-                                hci_stack->substate = HCI_INIT_W4_SEND_BAUD_CHANGE;
-                            } else {
-                               hci_stack->substate = HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT_LINK_RESET;
-                            }
-                            break;
-                        default:
-                            // should not get here
-                            break;
+                    hci_stack->init_script_cmds_num++;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+                    if (valid_cmd == BTSTACK_CHIPSET_VALID_COMMAND_PIPELINED && hci_stack->num_cmd_packets_max > 1){
+                        hci_initializing_custom_init_send_pipelined();
+                        break;
+                    }
+                    // only regular commands follow pipelined ones (CSR Warm Boot is not combined with pipelining)
+                    if (valid_cmd == BTSTACK_CHIPSET_VALID_COMMAND && hci_stack->init_pipelined_cmds_num > 0){
+                        // wait for pipelined commands, command stays in packet buffer
+                        hci_stack->substate = HCI_INIT_CUSTOM_INIT_SEND_PREPARED;
+                        break;
                     }
-                    hci_stack->hci_transport->send_packet(HCI_COMMAND_DATA_PACKET, hci_stack->hci_packet_buffer, size);
+#endif
+                    hci_initializing_custom_init_send(valid_cmd);
                     break;
                 }
-                log_info("Init script done");
-
-                // Init script download on Broadcom chipsets causes:
-                if (hci_stack->manufacturer == BLUETOOTH_COMPANY_ID_BROADCOM_CORPORATION 
-                ||  hci_stack->manufacturer == BLUETOOTH_COMPANY_ID_EM_MICROELECTRONIC_MARIN_SA){
-
-                    // - baud rate to reset, restore UART baud rate if needed
-                    int need_baud_change = hci_stack->config
-                        && hci_stack->chipset
-                        && hci_stack->chipset->set_baudrate_command
-                        && hci_stack->hci_transport->set_baudrate
-                        && ((hci_transport_config_uart_t *)hci_stack->config)->baudrate_main;
-                    if (need_baud_change) {
-                        uint32_t baud_rate = ((hci_transport_config_uart_t *)hci_stack->config)->baudrate_init;
-                        log_info("Local baud rate change to %"PRIu32" after init script (bcm)", baud_rate);
-                        hci_stack->hci_transport->set_baudrate(baud_rate);
-                    }
-
-                    // - RTS will raise during update, but manual RTS/CTS in WICED port on RedBear Duo cannot handle this
-                    //   -> Work around: wait a few milliseconds here.
-                    log_info("BCM delay after init script");
-                    hci_stack->substate = HCI_INIT_W4_CUSTOM_INIT_BCM_DELAY;
-                    btstack_run_loop_set_timer(&hci_stack->timeout, 10);
-                    btstack_run_loop_set_timer_handler(&hci_stack->timeout, hci_initialization_timeout_handler);
-                    btstack_run_loop_add_timer(&hci_stack->timeout);
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+                if (hci_stack->init_pipelined_cmds_num > 0){
+                    // wait for pipelined init script commands
+                    hci_stack->substate = HCI_INIT_CUSTOM_INIT_SCRIPT_DONE;
                     break;
                 }
+#endif
+                hci_initializing_custom_init_done(1);
+                break;
             }
-            // otherwise continue
-            hci_stack->substate = HCI_INIT_W4_READ_LOCAL_SUPPORTED_COMMANDS;
-            hci_send_cmd(&hci_read_local_supported_commands);
-            break;            
+            hci_initializing_custom_init_done(0);
+            break;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+        case HCI_INIT_CUSTOM_INIT_SEND_PREPARED:
+            hci_initializing_custom_init_send(BTSTACK_CHIPSET_VALID_COMMAND);
+            break;
+        case HCI_INIT_CUSTOM_INIT_SCRIPT_DONE:
+            hci_initializing_custom_init_done(1);
+            break;
+#endif
         case HCI_INIT_SET_BD_ADDR:
             log_info("Set Public BD ADDR to %s", bd_addr_to_str(hci_stack->custom_bd_addr));
             hci_stack->chipset->set_bd_addr_command(hci_stack->custom_bd_addr, hci_stack->hci_packet_buffer);
@@ -1462,9 +1693,26 @@ static void hci_initializing_run(void){
         default:
             return;
     }
+
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    if (pipeline_command){
+        // don't wait for Command Complete, continue with next step right away
+        log_debug("hci_initializing_run: pipelined opcode %04x at substate %u", hci_stack->last_cmd_opcode, substate);
+        hci_stack->init_pipelined_cmd_opcodes[hci_stack->init_pipelined_cmds_num++] = hci_stack->last_cmd_opcode;
+        hci_initializing_command_complete();
+    }
+#endif
 }
 
 static void hci_init_done(void){
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    if (hci_stack->init_pipelined_cmds_num > 0){
+        // wait for pipelined commands, see hci_initializing_pipelined_command_complete
+        hci_stack->substate = HCI_INIT_DONE;
+        return;
+    }
+#endif
+    hci_initializing_phase_done("configuration");
     // done. tell the app
     log_info("hci_init_done -> HCI_STATE_WORKING");
     hci_stack->state = HCI_STATE_WORKING;
@@ -1472,12 +1720,48 @@ static void hci_init_done(void){
     hci_run();
 }
 
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+// returns 1 if event completes a pipelined init command
+static int hci_initializing_pipelined_command_complete(const uint8_t * packet){
+    uint16_t opcode;
+    switch (hci_event_packet_get_type(packet)){
+        case HCI_EVENT_COMMAND_COMPLETE:
+            opcode = little_endian_read_16(packet, 3);
+            break;
+        case HCI_EVENT_COMMAND_STATUS:
+            // Command Status OK is followed by Command Complete
+            if (packet[2] == ERROR_CODE_SUCCESS) return 0;
+            opcode = little_endian_read_16(packet, 4);
+            break;
+        default:
+            return 0;
+    }
+    int i;
+    for (i = 0; i < hci_stack->init_pipelined_cmds_num; i++){
+        if (hci_stack->init_pipelined_cmd_opcodes[i] != opcode) continue;
+        log_debug("Command complete for pipelined opcode %04x at substate %u", opcode, hci_stack->substate);
+        hci_stack->init_pipelined_cmds_num--;
+        memmove(&hci_stack->init_pipelined_cmd_opcodes[i], &hci_stack->init_pipelined_cmd_opcodes[i+1],
+                (hci_stack->init_pipelined_cmds_num - i) * sizeof(uint16_t));
+        if (hci_stack->init_pipelined_cmds_num == 0 && hci_stack->substate == HCI_INIT_DONE){
+            hci_init_done();
+        }
+        return 1;
+    }
+    return 0;
+}
+#endif
+
 static void hci_initializing_event_handler(uint8_t * packet, uint16_t size){
 
     UNUSED(size);   // ok: less than 6 bytes are read from our buffer
     
     uint8_t command_completed = 0;
 
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    if (hci_initializing_pipelined_command_complete(packet)) return;
+#endif
+
     if (hci_event_packet_get_type(packet) == HCI_EVENT_COMMAND_COMPLETE){
         uint16_t opcode = little_endian_read_16(packet,3);
         if (opcode == hci_stack->last_cmd_opcode){
@@ -1516,7 +1800,7 @@ static void hci_initializing_event_handler(uint8_t * packet, uint16_t size){
         // TODO: track actual command
         command_completed = 1;
         // Fix: no HCI Command Complete received, so num_cmd_packets not reset
-        hci_stack->num_cmd_packets = 1;
+        hci_command_flow_control_reset();
     }
 
     // Late response (> 100 ms) for HCI Reset e.g. on Toshiba TC35661:
@@ -1574,6 +1858,12 @@ static void hci_initializing_event_handler(uint8_t * packet, uint16_t size){
 
     if (!command_completed) return;
 
+    hci_initializing_command_complete();
+}
+
+// select next init step after the command for the current substate is complete
+static void hci_initializing_command_complete(void){
+
     int need_baud_change = 0;
     int need_addr_change = 0;
 
@@ -1603,6 +1893,7 @@ static void hci_initializing_event_handler(uint8_t * packet, uint16_t size){
             break;
         case HCI_INIT_W4_SEND_READ_LOCAL_NAME:
             log_info("Received local name, need baud change %d", need_baud_change);
+            hci_initializing_phase_done("reset");
             if (need_baud_change){
                 hci_stack->substate = HCI_INIT_SEND_BAUD_CHANGE;
                 return;
@@ -1618,6 +1909,7 @@ static void hci_initializing_event_handler(uint8_t * packet, uint16_t size){
                 log_info("Local baud rate change to %"PRIu32"(w4_send_baud_change)", baud_rate);
                 hci_stack->hci_transport->set_baudrate(baud_rate);
             }
+            hci_initializing_phase_done("baud rate change");
             hci_stack->substate = HCI_INIT_CUSTOM_INIT;
             return;
         case HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT:
@@ -1806,8 +2098,7 @@ static void event_handler(uint8_t *packet, int size){
     switch (hci_event_packet_get_type(packet)) {
                         
         case HCI_EVENT_COMMAND_COMPLETE:
-            // get num cmd packets - limit to 1 to reduce complexity
-            hci_stack->num_cmd_packets = packet[2] ? 1 : 0;
+            hci_command_flow_control_update(little_endian_read_16(packet, 3), packet[2]);
 
             if (HCI_EVENT_IS_COMMAND_COMPLETE(packet, hci_read_local_name)){
                 if (packet[5]) break;
@@ -1921,8 +2212,7 @@ static void event_handler(uint8_t *packet, int size){
             break;
             
         case HCI_EVENT_COMMAND_STATUS:
-            // get num cmd packets - limit to 1 to reduce complexity
-            hci_stack->num_cmd_packets = packet[3] ? 1 : 0;
+            hci_command_flow_control_update(little_endian_read_16(packet, 4), packet[3]);
             break;
             
         case HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS:{
@@ -1956,6 +2246,9 @@ static void event_handler(uint8_t *packet, int size){
                         log_error("hci_number_completed_packets, more acl slots freed then sent.");
                         conn->num_acl_packets_sent = 0;
                     }
+#ifdef ENABLE_LATENCY_TRACE
+                    hci_latency_trace_acl_completed(conn, num_packets);
+#endif
                 }
                 // log_info("hci_number_completed_packet %u processed for handle %u, outstanding %u", num_packets, handle, conn->num_acl_packets_sent);
             }
@@ -2241,6 +2534,9 @@ static void event_handler(uint8_t *packet, int size){
                 log_error("Synchronous HCI Transport shouldn't send HCI_EVENT_TRANSPORT_PACKET_SENT");
                 return; // instead of break: to avoid re-entering hci_run()
             }
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_tx_sent();
+#endif
             if (hci_stack->acl_fragmentation_total_size) break;
             hci_release_packet_buffer();
             
@@ -2389,7 +2685,7 @@ static void event_handler(uint8_t *packet, int size){
             // To avoid getting stuck as num_cmds_packets is zero, reset it to 1 for controllers with this behaviour
             switch (hci_stack->manufacturer){
                 case BLUETOOTH_COMPANY_ID_CAMBRIDGE_SILICON_RADIO:
-                    hci_stack->num_cmd_packets = 1;
+                    hci_command_flow_control_reset();
                     break;
                 default:
                     break;
@@ -2454,13 +2750,20 @@ static void sco_handler(uint8_t * packet, uint16_t size){
 #endif
 
 static void packet_handler(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    uint32_t received_us = 0;
+#ifdef ENABLE_LATENCY_TRACE
+    // RX HCI segment starts when the transport delivers the packet, before the packet log
+    if (packet_type == HCI_ACL_DATA_PACKET){
+        received_us = btstack_latency_trace_now();
+    }
+#endif
     hci_dump_packet(packet_type, 1, packet, size);
     switch (packet_type) {
         case HCI_EVENT_PACKET:
             event_handler(packet, size);
             break;
         case HCI_ACL_DATA_PACKET:
-            acl_handler(packet, size);
+            acl_handler(packet, size, received_us);
             break;
 #ifdef ENABLE_CLASSIC
         case HCI_SCO_DATA_PACKET:
@@ -2479,6 +2782,10 @@ void hci_add_event_handler(btstack_packet_callback_registration_t * callback_han
     btstack_linked_list_add_tail(&hci_stack->event_handlers, (btstack_linked_item_t*) callback_handler);
 }
 
+void hci_remove_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    btstack_linked_list_remove(&hci_stack->event_handlers, (btstack_linked_item_t*) callback_handler);
+}
+
 
 /** Register HCI packet handlers */
 void hci_register_acl_packet_handler(btstack_packet_handler_t handler){
@@ -2510,6 +2817,9 @@ static void hci_state_reset(void){
     // no pending cmds
     hci_stack->decline_reason = 0;
     hci_stack->new_scan_enable_value = 0xff;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    hci_stack->init_pipelined_cmds_num = 0;
+#endif
     
     // LE
 #ifdef ENABLE_BLE
@@ -2654,6 +2964,9 @@ void hci_close(void){
     }
 
     hci_power_control(HCI_POWER_OFF);
+
+    // release slab allocated objects in bulk
+    btstack_memory_deinit();
     
 #ifdef HAVE_MALLOC
     free(hci_stack);
@@ -2789,7 +3102,12 @@ static int hci_power_control_wake(void){
 
 static void hci_power_transition_to_initializing(void){
     // set up state machine
-    hci_stack->num_cmd_packets = 1; // assume that one cmd can be sent
+    hci_command_flow_control_reset();
+    hci_stack->init_phase_start_ms = btstack_run_loop_get_time_ms();
+    hci_stack->init_script_cmds_num = 0;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    hci_stack->num_cmd_packets_max = 1;
+#endif
     hci_stack->hci_packet_buffer_reserved = 0;
     hci_stack->state = HCI_STATE_INITIALIZING;
     hci_stack->substate = HCI_INIT_SEND_RESET;
@@ -3010,10 +3328,14 @@ static void hci_host_num_completed_packets(void){
 }
 #endif
 
-static void hci_run(void){
+// sends at most one command
+static void hci_run_step(void){
     
     // log_info("hci_run: entered");
     btstack_linked_item_t * it;
+#ifdef ENABLE_BLE
+    uint8_t * packet;
+#endif
 
     // send continuation fragments first, as they block the prepared packet buffer
     if (hci_stack->acl_fragmentation_total_size > 0) {
@@ -3117,14 +3439,18 @@ static void hci_run(void){
         // handle le scan
         if ((hci_stack->le_scanning_enabled != hci_stack->le_scanning_active)){
             hci_stack->le_scanning_active = hci_stack->le_scanning_enabled;
-            hci_send_cmd(&hci_le_set_scan_enable, hci_stack->le_scanning_enabled, 0);
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_scan_enable(packet, hci_stack->le_scanning_enabled, 0));
             return;
         }
         if (hci_stack->le_scan_type != 0xff){
             // defaults: active scanning, accept all advertisement packets
             int scan_type = hci_stack->le_scan_type;
             hci_stack->le_scan_type = 0xff;
-            hci_send_cmd(&hci_le_set_scan_parameters, scan_type, hci_stack->le_scan_interval, hci_stack->le_scan_window, hci_stack->le_own_addr_type, 0);
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_scan_parameters(packet, scan_type, hci_stack->le_scan_interval, hci_stack->le_scan_window, hci_stack->le_own_addr_type, 0));
             return;
         }
 #endif
@@ -3135,12 +3461,16 @@ static void hci_run(void){
         }
         if (hci_stack->le_advertisements_todo & LE_ADVERTISEMENT_TASKS_DISABLE){
             hci_stack->le_advertisements_todo &= ~LE_ADVERTISEMENT_TASKS_DISABLE;
-            hci_send_cmd(&hci_le_set_advertise_enable, 0);
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_advertise_enable(packet, 0));
             return;
         }
         if (hci_stack->le_advertisements_todo & LE_ADVERTISEMENT_TASKS_SET_PARAMS){
             hci_stack->le_advertisements_todo &= ~LE_ADVERTISEMENT_TASKS_SET_PARAMS;
-            hci_send_cmd(&hci_le_set_advertising_parameters,
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_advertising_parameters(packet,
                  hci_stack->le_advertisements_interval_min,
                  hci_stack->le_advertisements_interval_max,
                  hci_stack->le_advertisements_type,
@@ -3148,7 +3478,7 @@ static void hci_run(void){
                  hci_stack->le_advertisements_direct_address_type,
                  hci_stack->le_advertisements_direct_address,
                  hci_stack->le_advertisements_channel_map,
-                 hci_stack->le_advertisements_filter_policy);
+                 hci_stack->le_advertisements_filter_policy));
             return;
         }
         if (hci_stack->le_advertisements_todo & LE_ADVERTISEMENT_TASKS_SET_ADV_DATA){
@@ -3157,7 +3487,9 @@ static void hci_run(void){
             memset(adv_data_clean, 0, sizeof(adv_data_clean));
             memcpy(adv_data_clean, hci_stack->le_advertisements_data, hci_stack->le_advertisements_data_len);
             hci_replace_bd_addr_placeholder(adv_data_clean, hci_stack->le_advertisements_data_len);
-            hci_send_cmd(&hci_le_set_advertising_data, hci_stack->le_advertisements_data_len, adv_data_clean);
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_advertising_data(packet, hci_stack->le_advertisements_data_len, adv_data_clean));
             return;
         }
         if (hci_stack->le_advertisements_todo & LE_ADVERTISEMENT_TASKS_SET_SCAN_DATA){
@@ -3166,12 +3498,16 @@ static void hci_run(void){
             memset(scan_data_clean, 0, sizeof(scan_data_clean));
             memcpy(scan_data_clean, hci_stack->le_scan_response_data, hci_stack->le_scan_response_data_len);
             hci_replace_bd_addr_placeholder(scan_data_clean, hci_stack->le_scan_response_data_len);
-            hci_send_cmd(&hci_le_set_scan_response_data, hci_stack->le_scan_response_data_len, hci_stack->le_scan_response_data);
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_scan_response_data(packet, hci_stack->le_scan_response_data_len, hci_stack->le_scan_response_data));
             return;
         }
         if (hci_stack->le_advertisements_todo & LE_ADVERTISEMENT_TASKS_ENABLE){
             hci_stack->le_advertisements_todo &= ~LE_ADVERTISEMENT_TASKS_ENABLE;
-            hci_send_cmd(&hci_le_set_advertise_enable, 1);
+            packet = hci_reserve_cmd_packet_buffer();
+            if (!packet) return;
+            hci_send_encoded_cmd_packet(hci_cmd_encode_le_set_advertise_enable(packet, 1));
             return;
         }
 #endif
@@ -3405,9 +3741,11 @@ static void hci_run(void){
             // response to L2CAP CON PARAMETER UPDATE REQUEST
             case CON_PARAMETER_UPDATE_CHANGE_HCI_CON_PARAMETERS:
                 connection->le_con_parameter_update_state = CON_PARAMETER_UPDATE_NONE; 
-                hci_send_cmd(&hci_le_connection_update, connection->con_handle, connection->le_conn_interval_min,
+                packet = hci_reserve_cmd_packet_buffer();
+                if (!packet) return;
+                hci_send_encoded_cmd_packet(hci_cmd_encode_le_connection_update(packet, connection->con_handle, connection->le_conn_interval_min,
                     connection->le_conn_interval_max, connection->le_conn_latency, connection->le_supervision_timeout,
-                    0x0000, 0xffff);
+                    0x0000, 0xffff));
                 break;
             case CON_PARAMETER_UPDATE_REPLY:
                 connection->le_con_parameter_update_state = CON_PARAMETER_UPDATE_NONE;
@@ -3546,6 +3884,20 @@ static void hci_run(void){
     }
 }
 
+static void hci_run(void){
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    // keep sending commands as long as the controller accepts more and the last step did send one
+    while (1){
+        uint8_t num_cmd_packets = hci_stack->num_cmd_packets;
+        hci_run_step();
+        if (hci_stack->num_cmd_packets >= num_cmd_packets) break;
+        if (!hci_can_send_command_packet_now()) break;
+    }
+#else
+    hci_run_step();
+#endif
+}
+
 int hci_send_cmd_packet(uint8_t *packet, int size){
     // house-keeping
     
@@ -3671,6 +4023,13 @@ int hci_send_cmd_packet(uint8_t *packet, int size){
 #endif
 
     hci_stack->num_cmd_packets--;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    hci_stack->num_cmds_in_flight++;
+    uint16_t opcode = little_endian_read_16(packet, 0);
+    if (hci_command_requires_serialization(opcode)){
+        hci_stack->serialized_cmd_opcode = opcode;
+    }
+#endif
 
     hci_dump_packet(HCI_COMMAND_DATA_PACKET, 0, packet, size);
     int err = hci_stack->hci_transport->send_packet(HCI_COMMAND_DATA_PACKET, packet, size);
@@ -3718,6 +4077,24 @@ void gap_ssp_set_auto_accept(int auto_accept){
 }
 #endif
 
+#ifdef ENABLE_BLE
+// typed encoder path, see hci_cmd_encoder.h: reserve buffer, encode command, send it
+static uint8_t * hci_reserve_cmd_packet_buffer(void){
+    if (!hci_can_send_command_packet_now()){ 
+        log_error("hci_send_cmd called but cannot send packet now");
+        return NULL;
+    }
+    hci_reserve_packet_buffer();
+    return hci_stack->hci_packet_buffer;
+}
+
+static int hci_send_encoded_cmd_packet(uint16_t size){
+    uint8_t * packet = hci_stack->hci_packet_buffer;
+    hci_stack->last_cmd_opcode = little_endian_read_16(packet, 0);
+    return hci_send_cmd_packet(packet, size);
+}
+#endif
+
 // va_list part of hci_send_cmd
 int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argptr){
     if (!hci_can_send_command_packet_now()){ 
@@ -4152,6 +4529,12 @@ void gap_stop_scan(void){
     hci_run();
 }
 
+#ifdef ENABLE_LE_ADVERTISING_REPORT_FILTER
+void gap_set_advertising_report_filter(ad_filter_t * filter){
+    hci_stack->le_advertising_report_filter = filter;
+}
+#endif
+
 void gap_set_scan_parameters(uint8_t scan_type, uint16_t scan_interval, uint16_t scan_window){
     hci_stack->le_scan_type     = scan_type;
     hci_stack->le_scan_interval = scan_interval;
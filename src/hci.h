@@ -49,6 +49,7 @@
 
 #include "btstack_chipset.h"
 #include "btstack_control.h"
+#include "btstack_latency_trace.h"
 #include "btstack_linked_list.h"
 #include "btstack_util.h"
 #include "classic/btstack_link_key_db.h"
@@ -124,6 +125,11 @@ extern "C" {
 #endif
 #endif
 
+// max number of HCI Commands in flight with ENABLE_HCI_COMMAND_PIPELINING, further limited by Num_HCI_Command_Packets
+#ifndef HCI_COMMAND_PIPELINING_DEPTH
+#define HCI_COMMAND_PIPELINING_DEPTH 4
+#endif
+
 // 
 #define IS_COMMAND(packet, command) (little_endian_read_16(packet,0) == command.opcode)
 
@@ -485,6 +491,15 @@ typedef struct {
     uint8_t num_packets_completed;
 #endif
 
+#ifdef ENABLE_LATENCY_TRACE
+    // reception of first fragment of packet in recombination buffer
+    uint32_t latency_trace_rx_timestamp;
+    // transport send of ACL packets in flight, indexed by sequence number
+    uint32_t latency_trace_tx_timestamps[LATENCY_TRACE_TX_TIMESTAMPS];
+    uint16_t latency_trace_tx_sent;
+    uint16_t latency_trace_tx_completed;
+#endif
+
     // LE Connection parameter update
     le_con_parameter_update_state_t le_con_parameter_update_state;
     uint8_t  le_con_param_update_identifier;
@@ -527,6 +542,8 @@ typedef enum hci_init_state{
     HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT,
     HCI_INIT_W4_CUSTOM_INIT_CSR_WARM_BOOT_LINK_RESET,
     HCI_INIT_W4_CUSTOM_INIT_BCM_DELAY,
+    HCI_INIT_CUSTOM_INIT_SEND_PREPARED,
+    HCI_INIT_CUSTOM_INIT_SCRIPT_DONE,
 
     HCI_INIT_READ_LOCAL_SUPPORTED_COMMANDS,
     HCI_INIT_W4_READ_LOCAL_SUPPORTED_COMMANDS,
@@ -690,6 +707,12 @@ typedef struct {
      
     /* host to controller flow control */
     uint8_t  num_cmd_packets;
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    uint8_t  num_cmds_in_flight;
+    uint8_t  num_cmd_packets_max;
+    // command that has to complete before the next one can be sent, 0 = none
+    uint16_t serialized_cmd_opcode;
+#endif
     uint8_t  acl_packets_total_num;
     uint16_t acl_data_packet_length;
     uint8_t  sco_packets_total_num;
@@ -729,6 +752,16 @@ typedef struct {
 
     uint16_t  last_cmd_opcode;
 
+    // init phase timing for log output
+    uint32_t  init_phase_start_ms;
+    uint16_t  init_script_cmds_num;
+
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    // init commands sent without waiting for their Command Complete
+    uint16_t  init_pipelined_cmd_opcodes[HCI_COMMAND_PIPELINING_DEPTH];
+    uint8_t   init_pipelined_cmds_num;
+#endif
+
     uint8_t   cmds_ready;
 
     /* buffer for scan enable cmd - 0xff no change */
@@ -782,6 +815,10 @@ typedef struct {
     uint16_t le_scan_interval;  
     uint16_t le_scan_window;
 
+#ifdef ENABLE_LE_ADVERTISING_REPORT_FILTER
+    ad_filter_t * le_advertising_report_filter;
+#endif
+
     // LE Whitelist Management
     uint8_t               le_whitelist_capacity;
     btstack_linked_list_t le_whitelist;
@@ -910,6 +947,11 @@ void hci_close(void);
  */
 void hci_add_event_handler(btstack_packet_callback_registration_t * callback_handler);
 
+/**
+ * @brief Remove event packet handler.
+ */
+void hci_remove_event_handler(btstack_packet_callback_registration_t * callback_handler);
+
 /**
  * @brief Registers a packet handler for ACL data. Used by L2CAP
  */
@@ -0,0 +1,2147 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+
+/*
+ *  hci_cmd_encoder.h
+ *
+ *  @brief Typed HCI Command encoders, same output as hci_cmd_create_from_template without format string interpretation
+ *  @note  Don't edit - generated by tool/btstack_hci_cmd_encoder_generator.py
+ *
+ */
+
+#ifndef __HCI_CMD_ENCODER_H
+#define __HCI_CMD_ENCODER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "btstack_config.h"
+#include "bluetooth.h"
+#include "btstack_util.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* API_START */
+
+/**
+ * @brief Encode hci_inquiry into hci_cmd_buffer
+ * @param lap
+ * @param inquiry_length
+ * @param num_responses
+ * @return size of HCI Command packet
+ * @note: format 311
+ */
+static inline uint16_t hci_cmd_encode_inquiry(uint8_t * hci_cmd_buffer, uint32_t lap, uint8_t inquiry_length, uint8_t num_responses){
+    hci_cmd_buffer[0] = 0x01;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 5;
+    hci_cmd_buffer[3] = (uint8_t) (lap);
+    hci_cmd_buffer[4] = (uint8_t) (lap >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (lap >> 16);
+    hci_cmd_buffer[6] = inquiry_length;
+    hci_cmd_buffer[7] = num_responses;
+    return 8;
+}
+
+/**
+ * @brief Encode hci_inquiry_cancel into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_inquiry_cancel(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x02;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_create_connection into hci_cmd_buffer
+ * @param bd_addr
+ * @param packet_type
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @param allow_role_switch
+ * @return size of HCI Command packet
+ * @note: format B21121
+ */
+static inline uint16_t hci_cmd_encode_create_connection(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint16_t packet_type, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset, uint8_t allow_role_switch){
+    hci_cmd_buffer[0] = 0x05;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 13;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = (uint8_t) (packet_type);
+    hci_cmd_buffer[10] = (uint8_t) (packet_type >> 8);
+    hci_cmd_buffer[11] = page_scan_repetition_mode;
+    hci_cmd_buffer[12] = reserved;
+    hci_cmd_buffer[13] = (uint8_t) (clock_offset);
+    hci_cmd_buffer[14] = (uint8_t) (clock_offset >> 8);
+    hci_cmd_buffer[15] = allow_role_switch;
+    return 16;
+}
+
+/**
+ * @brief Encode hci_disconnect into hci_cmd_buffer
+ * @param handle
+ * @param reason
+ * @return size of HCI Command packet
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_disconnect(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint8_t reason){
+    hci_cmd_buffer[0] = 0x06;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 3;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = reason;
+    return 6;
+}
+
+/**
+ * @brief Encode hci_create_connection_cancel into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_create_connection_cancel(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x08;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_accept_connection_request into hci_cmd_buffer
+ * @param bd_addr
+ * @param role
+ * @return size of HCI Command packet
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_accept_connection_request(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t role){
+    hci_cmd_buffer[0] = 0x09;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 7;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = role;
+    return 10;
+}
+
+/**
+ * @brief Encode hci_reject_connection_request into hci_cmd_buffer
+ * @param bd_addr
+ * @param reason
+ * @return size of HCI Command packet
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_reject_connection_request(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t reason){
+    hci_cmd_buffer[0] = 0x0a;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 7;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = reason;
+    return 10;
+}
+
+/**
+ * @brief Encode hci_link_key_request_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @param link_key
+ * @return size of HCI Command packet
+ * @note: format BP
+ */
+static inline uint16_t hci_cmd_encode_link_key_request_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, const uint8_t * link_key){
+    hci_cmd_buffer[0] = 0x0b;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 22;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    memcpy(&hci_cmd_buffer[9], link_key, 16);
+    return 25;
+}
+
+/**
+ * @brief Encode hci_link_key_request_negative_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_link_key_request_negative_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x0c;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_pin_code_request_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @param pin_length
+ * @param pin
+ * @return size of HCI Command packet
+ * @note: format B1P
+ */
+static inline uint16_t hci_cmd_encode_pin_code_request_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t pin_length, const uint8_t * pin){
+    hci_cmd_buffer[0] = 0x0d;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 23;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = pin_length;
+    memcpy(&hci_cmd_buffer[10], pin, 16);
+    return 26;
+}
+
+/**
+ * @brief Encode hci_pin_code_request_negative_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_pin_code_request_negative_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x0e;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_change_connection_packet_type into hci_cmd_buffer
+ * @param handle
+ * @param packet_type
+ * @return size of HCI Command packet
+ * @note: format H2
+ */
+static inline uint16_t hci_cmd_encode_change_connection_packet_type(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint16_t packet_type){
+    hci_cmd_buffer[0] = 0x0f;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 4;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (packet_type);
+    hci_cmd_buffer[6] = (uint8_t) (packet_type >> 8);
+    return 7;
+}
+
+/**
+ * @brief Encode hci_authentication_requested into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_authentication_requested(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x11;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_set_connection_encryption into hci_cmd_buffer
+ * @param handle
+ * @param encryption_enable
+ * @return size of HCI Command packet
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_set_connection_encryption(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint8_t encryption_enable){
+    hci_cmd_buffer[0] = 0x13;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 3;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = encryption_enable;
+    return 6;
+}
+
+/**
+ * @brief Encode hci_change_connection_link_key into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_change_connection_link_key(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x15;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_remote_name_request into hci_cmd_buffer
+ * @param bd_addr
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @return size of HCI Command packet
+ * @note: format B112
+ */
+static inline uint16_t hci_cmd_encode_remote_name_request(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset){
+    hci_cmd_buffer[0] = 0x19;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 10;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = page_scan_repetition_mode;
+    hci_cmd_buffer[10] = reserved;
+    hci_cmd_buffer[11] = (uint8_t) (clock_offset);
+    hci_cmd_buffer[12] = (uint8_t) (clock_offset >> 8);
+    return 13;
+}
+
+/**
+ * @brief Encode hci_remote_name_request_cancel into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_remote_name_request_cancel(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x1a;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_read_remote_supported_features_command into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_remote_supported_features_command(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x1b;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_setup_synchronous_connection into hci_cmd_buffer
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return size of HCI Command packet
+ * @note: format H442212
+ */
+static inline uint16_t hci_cmd_encode_setup_synchronous_connection(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    hci_cmd_buffer[0] = 0x28;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 17;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (transmit_bandwidth);
+    hci_cmd_buffer[6] = (uint8_t) (transmit_bandwidth >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (transmit_bandwidth >> 16);
+    hci_cmd_buffer[8] = (uint8_t) (transmit_bandwidth >> 24);
+    hci_cmd_buffer[9] = (uint8_t) (receive_bandwidth);
+    hci_cmd_buffer[10] = (uint8_t) (receive_bandwidth >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (receive_bandwidth >> 16);
+    hci_cmd_buffer[12] = (uint8_t) (receive_bandwidth >> 24);
+    hci_cmd_buffer[13] = (uint8_t) (max_latency);
+    hci_cmd_buffer[14] = (uint8_t) (max_latency >> 8);
+    hci_cmd_buffer[15] = (uint8_t) (voice_settings);
+    hci_cmd_buffer[16] = (uint8_t) (voice_settings >> 8);
+    hci_cmd_buffer[17] = retransmission_effort;
+    hci_cmd_buffer[18] = (uint8_t) (packet_type);
+    hci_cmd_buffer[19] = (uint8_t) (packet_type >> 8);
+    return 20;
+}
+
+/**
+ * @brief Encode hci_accept_synchronous_connection into hci_cmd_buffer
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return size of HCI Command packet
+ * @note: format B442212
+ */
+static inline uint16_t hci_cmd_encode_accept_synchronous_connection(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    hci_cmd_buffer[0] = 0x29;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 21;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = (uint8_t) (transmit_bandwidth);
+    hci_cmd_buffer[10] = (uint8_t) (transmit_bandwidth >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (transmit_bandwidth >> 16);
+    hci_cmd_buffer[12] = (uint8_t) (transmit_bandwidth >> 24);
+    hci_cmd_buffer[13] = (uint8_t) (receive_bandwidth);
+    hci_cmd_buffer[14] = (uint8_t) (receive_bandwidth >> 8);
+    hci_cmd_buffer[15] = (uint8_t) (receive_bandwidth >> 16);
+    hci_cmd_buffer[16] = (uint8_t) (receive_bandwidth >> 24);
+    hci_cmd_buffer[17] = (uint8_t) (max_latency);
+    hci_cmd_buffer[18] = (uint8_t) (max_latency >> 8);
+    hci_cmd_buffer[19] = (uint8_t) (voice_settings);
+    hci_cmd_buffer[20] = (uint8_t) (voice_settings >> 8);
+    hci_cmd_buffer[21] = retransmission_effort;
+    hci_cmd_buffer[22] = (uint8_t) (packet_type);
+    hci_cmd_buffer[23] = (uint8_t) (packet_type >> 8);
+    return 24;
+}
+
+/**
+ * @brief Encode hci_io_capability_request_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @param io_capability
+ * @param oob_data_present
+ * @param authentication_requirements
+ * @return size of HCI Command packet
+ * @note: format B111
+ */
+static inline uint16_t hci_cmd_encode_io_capability_request_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t io_capability, uint8_t oob_data_present, uint8_t authentication_requirements){
+    hci_cmd_buffer[0] = 0x2b;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 9;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = io_capability;
+    hci_cmd_buffer[10] = oob_data_present;
+    hci_cmd_buffer[11] = authentication_requirements;
+    return 12;
+}
+
+/**
+ * @brief Encode hci_user_confirmation_request_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_user_confirmation_request_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x2c;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_user_confirmation_request_negative_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_user_confirmation_request_negative_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x2d;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_user_passkey_request_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @param numeric_value
+ * @return size of HCI Command packet
+ * @note: format B4
+ */
+static inline uint16_t hci_cmd_encode_user_passkey_request_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint32_t numeric_value){
+    hci_cmd_buffer[0] = 0x2e;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 10;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = (uint8_t) (numeric_value);
+    hci_cmd_buffer[10] = (uint8_t) (numeric_value >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (numeric_value >> 16);
+    hci_cmd_buffer[12] = (uint8_t) (numeric_value >> 24);
+    return 13;
+}
+
+/**
+ * @brief Encode hci_user_passkey_request_negative_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_user_passkey_request_negative_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x2f;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_remote_oob_data_request_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @param c
+ * @param r
+ * @return size of HCI Command packet
+ * @note: format BPP
+ */
+static inline uint16_t hci_cmd_encode_remote_oob_data_request_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, const uint8_t * c, const uint8_t * r){
+    hci_cmd_buffer[0] = 0x30;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 38;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    memcpy(&hci_cmd_buffer[9], c, 16);
+    memcpy(&hci_cmd_buffer[25], r, 16);
+    return 41;
+}
+
+/**
+ * @brief Encode hci_remote_oob_data_request_negative_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_remote_oob_data_request_negative_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x33;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_io_capability_request_negative_reply into hci_cmd_buffer
+ * @param bd_addr
+ * @param reason
+ * @return size of HCI Command packet
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_io_capability_request_negative_reply(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t reason){
+    hci_cmd_buffer[0] = 0x34;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 7;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = reason;
+    return 10;
+}
+
+/**
+ * @brief Encode hci_enhanced_setup_synchronous_connection into hci_cmd_buffer
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return size of HCI Command packet
+ * @note: format H4412212222441221222211111111221
+ */
+static inline uint16_t hci_cmd_encode_enhanced_setup_synchronous_connection(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    hci_cmd_buffer[0] = 0x3d;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 59;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (transmit_bandwidth);
+    hci_cmd_buffer[6] = (uint8_t) (transmit_bandwidth >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (transmit_bandwidth >> 16);
+    hci_cmd_buffer[8] = (uint8_t) (transmit_bandwidth >> 24);
+    hci_cmd_buffer[9] = (uint8_t) (receive_bandwidth);
+    hci_cmd_buffer[10] = (uint8_t) (receive_bandwidth >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (receive_bandwidth >> 16);
+    hci_cmd_buffer[12] = (uint8_t) (receive_bandwidth >> 24);
+    hci_cmd_buffer[13] = transmit_coding_format_type;
+    hci_cmd_buffer[14] = (uint8_t) (transmit_coding_format_company);
+    hci_cmd_buffer[15] = (uint8_t) (transmit_coding_format_company >> 8);
+    hci_cmd_buffer[16] = (uint8_t) (transmit_coding_format_codec);
+    hci_cmd_buffer[17] = (uint8_t) (transmit_coding_format_codec >> 8);
+    hci_cmd_buffer[18] = receive_coding_format_type;
+    hci_cmd_buffer[19] = (uint8_t) (receive_coding_format_company);
+    hci_cmd_buffer[20] = (uint8_t) (receive_coding_format_company >> 8);
+    hci_cmd_buffer[21] = (uint8_t) (receive_coding_format_codec);
+    hci_cmd_buffer[22] = (uint8_t) (receive_coding_format_codec >> 8);
+    hci_cmd_buffer[23] = (uint8_t) (transmit_coding_frame_size);
+    hci_cmd_buffer[24] = (uint8_t) (transmit_coding_frame_size >> 8);
+    hci_cmd_buffer[25] = (uint8_t) (receive_coding_frame_size);
+    hci_cmd_buffer[26] = (uint8_t) (receive_coding_frame_size >> 8);
+    hci_cmd_buffer[27] = (uint8_t) (input_bandwidth);
+    hci_cmd_buffer[28] = (uint8_t) (input_bandwidth >> 8);
+    hci_cmd_buffer[29] = (uint8_t) (input_bandwidth >> 16);
+    hci_cmd_buffer[30] = (uint8_t) (input_bandwidth >> 24);
+    hci_cmd_buffer[31] = (uint8_t) (output_bandwidth);
+    hci_cmd_buffer[32] = (uint8_t) (output_bandwidth >> 8);
+    hci_cmd_buffer[33] = (uint8_t) (output_bandwidth >> 16);
+    hci_cmd_buffer[34] = (uint8_t) (output_bandwidth >> 24);
+    hci_cmd_buffer[35] = input_coding_format_type;
+    hci_cmd_buffer[36] = (uint8_t) (input_coding_format_company);
+    hci_cmd_buffer[37] = (uint8_t) (input_coding_format_company >> 8);
+    hci_cmd_buffer[38] = (uint8_t) (input_coding_format_codec);
+    hci_cmd_buffer[39] = (uint8_t) (input_coding_format_codec >> 8);
+    hci_cmd_buffer[40] = output_coding_format_type;
+    hci_cmd_buffer[41] = (uint8_t) (output_coding_format_company);
+    hci_cmd_buffer[42] = (uint8_t) (output_coding_format_company >> 8);
+    hci_cmd_buffer[43] = (uint8_t) (output_coding_format_codec);
+    hci_cmd_buffer[44] = (uint8_t) (output_coding_format_codec >> 8);
+    hci_cmd_buffer[45] = (uint8_t) (input_coded_data_size);
+    hci_cmd_buffer[46] = (uint8_t) (input_coded_data_size >> 8);
+    hci_cmd_buffer[47] = (uint8_t) (outupt_coded_data_size);
+    hci_cmd_buffer[48] = (uint8_t) (outupt_coded_data_size >> 8);
+    hci_cmd_buffer[49] = input_pcm_data_format;
+    hci_cmd_buffer[50] = output_pcm_data_format;
+    hci_cmd_buffer[51] = input_pcm_sample_payload_msb_position;
+    hci_cmd_buffer[52] = output_pcm_sample_payload_msb_position;
+    hci_cmd_buffer[53] = input_data_path;
+    hci_cmd_buffer[54] = output_data_path;
+    hci_cmd_buffer[55] = input_transport_unit_size;
+    hci_cmd_buffer[56] = output_transport_unit_size;
+    hci_cmd_buffer[57] = (uint8_t) (max_latency);
+    hci_cmd_buffer[58] = (uint8_t) (max_latency >> 8);
+    hci_cmd_buffer[59] = (uint8_t) (packet_type);
+    hci_cmd_buffer[60] = (uint8_t) (packet_type >> 8);
+    hci_cmd_buffer[61] = retransmission_effort;
+    return 62;
+}
+
+/**
+ * @brief Encode hci_enhanced_accept_synchronous_connection into hci_cmd_buffer
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return size of HCI Command packet
+ * @note: format B4412212222441221222211111111221
+ */
+static inline uint16_t hci_cmd_encode_enhanced_accept_synchronous_connection(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    hci_cmd_buffer[0] = 0x3e;
+    hci_cmd_buffer[1] = 0x04;
+    hci_cmd_buffer[2] = 63;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = (uint8_t) (transmit_bandwidth);
+    hci_cmd_buffer[10] = (uint8_t) (transmit_bandwidth >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (transmit_bandwidth >> 16);
+    hci_cmd_buffer[12] = (uint8_t) (transmit_bandwidth >> 24);
+    hci_cmd_buffer[13] = (uint8_t) (receive_bandwidth);
+    hci_cmd_buffer[14] = (uint8_t) (receive_bandwidth >> 8);
+    hci_cmd_buffer[15] = (uint8_t) (receive_bandwidth >> 16);
+    hci_cmd_buffer[16] = (uint8_t) (receive_bandwidth >> 24);
+    hci_cmd_buffer[17] = transmit_coding_format_type;
+    hci_cmd_buffer[18] = (uint8_t) (transmit_coding_format_company);
+    hci_cmd_buffer[19] = (uint8_t) (transmit_coding_format_company >> 8);
+    hci_cmd_buffer[20] = (uint8_t) (transmit_coding_format_codec);
+    hci_cmd_buffer[21] = (uint8_t) (transmit_coding_format_codec >> 8);
+    hci_cmd_buffer[22] = receive_coding_format_type;
+    hci_cmd_buffer[23] = (uint8_t) (receive_coding_format_company);
+    hci_cmd_buffer[24] = (uint8_t) (receive_coding_format_company >> 8);
+    hci_cmd_buffer[25] = (uint8_t) (receive_coding_format_codec);
+    hci_cmd_buffer[26] = (uint8_t) (receive_coding_format_codec >> 8);
+    hci_cmd_buffer[27] = (uint8_t) (transmit_coding_frame_size);
+    hci_cmd_buffer[28] = (uint8_t) (transmit_coding_frame_size >> 8);
+    hci_cmd_buffer[29] = (uint8_t) (receive_coding_frame_size);
+    hci_cmd_buffer[30] = (uint8_t) (receive_coding_frame_size >> 8);
+    hci_cmd_buffer[31] = (uint8_t) (input_bandwidth);
+    hci_cmd_buffer[32] = (uint8_t) (input_bandwidth >> 8);
+    hci_cmd_buffer[33] = (uint8_t) (input_bandwidth >> 16);
+    hci_cmd_buffer[34] = (uint8_t) (input_bandwidth >> 24);
+    hci_cmd_buffer[35] = (uint8_t) (output_bandwidth);
+    hci_cmd_buffer[36] = (uint8_t) (output_bandwidth >> 8);
+    hci_cmd_buffer[37] = (uint8_t) (output_bandwidth >> 16);
+    hci_cmd_buffer[38] = (uint8_t) (output_bandwidth >> 24);
+    hci_cmd_buffer[39] = input_coding_format_type;
+    hci_cmd_buffer[40] = (uint8_t) (input_coding_format_company);
+    hci_cmd_buffer[41] = (uint8_t) (input_coding_format_company >> 8);
+    hci_cmd_buffer[42] = (uint8_t) (input_coding_format_codec);
+    hci_cmd_buffer[43] = (uint8_t) (input_coding_format_codec >> 8);
+    hci_cmd_buffer[44] = output_coding_format_type;
+    hci_cmd_buffer[45] = (uint8_t) (output_coding_format_company);
+    hci_cmd_buffer[46] = (uint8_t) (output_coding_format_company >> 8);
+    hci_cmd_buffer[47] = (uint8_t) (output_coding_format_codec);
+    hci_cmd_buffer[48] = (uint8_t) (output_coding_format_codec >> 8);
+    hci_cmd_buffer[49] = (uint8_t) (input_coded_data_size);
+    hci_cmd_buffer[50] = (uint8_t) (input_coded_data_size >> 8);
+    hci_cmd_buffer[51] = (uint8_t) (outupt_coded_data_size);
+    hci_cmd_buffer[52] = (uint8_t) (outupt_coded_data_size >> 8);
+    hci_cmd_buffer[53] = input_pcm_data_format;
+    hci_cmd_buffer[54] = output_pcm_data_format;
+    hci_cmd_buffer[55] = input_pcm_sample_payload_msb_position;
+    hci_cmd_buffer[56] = output_pcm_sample_payload_msb_position;
+    hci_cmd_buffer[57] = input_data_path;
+    hci_cmd_buffer[58] = output_data_path;
+    hci_cmd_buffer[59] = input_transport_unit_size;
+    hci_cmd_buffer[60] = output_transport_unit_size;
+    hci_cmd_buffer[61] = (uint8_t) (max_latency);
+    hci_cmd_buffer[62] = (uint8_t) (max_latency >> 8);
+    hci_cmd_buffer[63] = (uint8_t) (packet_type);
+    hci_cmd_buffer[64] = (uint8_t) (packet_type >> 8);
+    hci_cmd_buffer[65] = retransmission_effort;
+    return 66;
+}
+
+/**
+ * @brief Encode hci_sniff_mode into hci_cmd_buffer
+ * @param handle
+ * @param sniff_max_interval
+ * @param sniff_min_interval
+ * @param sniff_attempt
+ * @param sniff_timeout
+ * @return size of HCI Command packet
+ * @note: format H2222
+ */
+static inline uint16_t hci_cmd_encode_sniff_mode(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint16_t sniff_max_interval, uint16_t sniff_min_interval, uint16_t sniff_attempt, uint16_t sniff_timeout){
+    hci_cmd_buffer[0] = 0x03;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 10;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (sniff_max_interval);
+    hci_cmd_buffer[6] = (uint8_t) (sniff_max_interval >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (sniff_min_interval);
+    hci_cmd_buffer[8] = (uint8_t) (sniff_min_interval >> 8);
+    hci_cmd_buffer[9] = (uint8_t) (sniff_attempt);
+    hci_cmd_buffer[10] = (uint8_t) (sniff_attempt >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (sniff_timeout);
+    hci_cmd_buffer[12] = (uint8_t) (sniff_timeout >> 8);
+    return 13;
+}
+
+/**
+ * @brief Encode hci_qos_setup into hci_cmd_buffer
+ * @param handle
+ * @param flags
+ * @param service_type
+ * @param token_rate
+ * @param peak_bandwith
+ * @param latency
+ * @param delay_variation
+ * @return size of HCI Command packet
+ * @note: format H114444
+ */
+static inline uint16_t hci_cmd_encode_qos_setup(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint8_t flags, uint8_t service_type, uint32_t token_rate, uint32_t peak_bandwith, uint32_t latency, uint32_t delay_variation){
+    hci_cmd_buffer[0] = 0x07;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 20;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = flags;
+    hci_cmd_buffer[6] = service_type;
+    hci_cmd_buffer[7] = (uint8_t) (token_rate);
+    hci_cmd_buffer[8] = (uint8_t) (token_rate >> 8);
+    hci_cmd_buffer[9] = (uint8_t) (token_rate >> 16);
+    hci_cmd_buffer[10] = (uint8_t) (token_rate >> 24);
+    hci_cmd_buffer[11] = (uint8_t) (peak_bandwith);
+    hci_cmd_buffer[12] = (uint8_t) (peak_bandwith >> 8);
+    hci_cmd_buffer[13] = (uint8_t) (peak_bandwith >> 16);
+    hci_cmd_buffer[14] = (uint8_t) (peak_bandwith >> 24);
+    hci_cmd_buffer[15] = (uint8_t) (latency);
+    hci_cmd_buffer[16] = (uint8_t) (latency >> 8);
+    hci_cmd_buffer[17] = (uint8_t) (latency >> 16);
+    hci_cmd_buffer[18] = (uint8_t) (latency >> 24);
+    hci_cmd_buffer[19] = (uint8_t) (delay_variation);
+    hci_cmd_buffer[20] = (uint8_t) (delay_variation >> 8);
+    hci_cmd_buffer[21] = (uint8_t) (delay_variation >> 16);
+    hci_cmd_buffer[22] = (uint8_t) (delay_variation >> 24);
+    return 23;
+}
+
+/**
+ * @brief Encode hci_role_discovery into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_role_discovery(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x09;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_switch_role_command into hci_cmd_buffer
+ * @param bd_addr
+ * @param role
+ * @return size of HCI Command packet
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_switch_role_command(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t role){
+    hci_cmd_buffer[0] = 0x0b;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 7;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = role;
+    return 10;
+}
+
+/**
+ * @brief Encode hci_read_link_policy_settings into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_link_policy_settings(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x0c;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_write_link_policy_settings into hci_cmd_buffer
+ * @param handle
+ * @param settings
+ * @return size of HCI Command packet
+ * @note: format H2
+ */
+static inline uint16_t hci_cmd_encode_write_link_policy_settings(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint16_t settings){
+    hci_cmd_buffer[0] = 0x0d;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 4;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (settings);
+    hci_cmd_buffer[6] = (uint8_t) (settings >> 8);
+    return 7;
+}
+
+/**
+ * @brief Encode hci_write_default_link_policy_setup into hci_cmd_buffer
+ * @param policy
+ * @return size of HCI Command packet
+ * @note: format 2
+ */
+static inline uint16_t hci_cmd_encode_write_default_link_policy_setup(uint8_t * hci_cmd_buffer, uint16_t policy){
+    hci_cmd_buffer[0] = 0x0f;
+    hci_cmd_buffer[1] = 0x08;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (policy);
+    hci_cmd_buffer[4] = (uint8_t) (policy >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_set_event_mask into hci_cmd_buffer
+ * @param event_mask_lover_octets
+ * @param event_mask_higher_octets
+ * @return size of HCI Command packet
+ * @note: format 44
+ */
+static inline uint16_t hci_cmd_encode_set_event_mask(uint8_t * hci_cmd_buffer, uint32_t event_mask_lover_octets, uint32_t event_mask_higher_octets){
+    hci_cmd_buffer[0] = 0x01;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 8;
+    hci_cmd_buffer[3] = (uint8_t) (event_mask_lover_octets);
+    hci_cmd_buffer[4] = (uint8_t) (event_mask_lover_octets >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (event_mask_lover_octets >> 16);
+    hci_cmd_buffer[6] = (uint8_t) (event_mask_lover_octets >> 24);
+    hci_cmd_buffer[7] = (uint8_t) (event_mask_higher_octets);
+    hci_cmd_buffer[8] = (uint8_t) (event_mask_higher_octets >> 8);
+    hci_cmd_buffer[9] = (uint8_t) (event_mask_higher_octets >> 16);
+    hci_cmd_buffer[10] = (uint8_t) (event_mask_higher_octets >> 24);
+    return 11;
+}
+
+/**
+ * @brief Encode hci_reset into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_reset(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x03;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_flush into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_flush(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x09;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_delete_stored_link_key into hci_cmd_buffer
+ * @param bd_addr
+ * @param delete_all_flags
+ * @return size of HCI Command packet
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_delete_stored_link_key(uint8_t * hci_cmd_buffer, const bd_addr_t bd_addr, uint8_t delete_all_flags){
+    hci_cmd_buffer[0] = 0x12;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 7;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[3]);
+    hci_cmd_buffer[9] = delete_all_flags;
+    return 10;
+}
+
+#ifdef ENABLE_CLASSIC
+
+/**
+ * @brief Encode hci_write_local_name into hci_cmd_buffer
+ * @param local_name
+ * @return size of HCI Command packet
+ * @note: format N
+ */
+static inline uint16_t hci_cmd_encode_write_local_name(uint8_t * hci_cmd_buffer, const char * local_name){
+    hci_cmd_buffer[0] = 0x13;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 248;
+    uint16_t local_name_len = strlen(local_name);
+    if (local_name_len > 248) {
+        local_name_len = 248;
+    }
+    memcpy(&hci_cmd_buffer[3], local_name, local_name_len);
+    memset(&hci_cmd_buffer[3 + local_name_len], 0, 248 - local_name_len);
+    return 251;
+}
+
+#endif
+
+/**
+ * @brief Encode hci_read_local_name into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_local_name(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x14;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_write_page_timeout into hci_cmd_buffer
+ * @param page_timeout
+ * @return size of HCI Command packet
+ * @note: format 2
+ */
+static inline uint16_t hci_cmd_encode_write_page_timeout(uint8_t * hci_cmd_buffer, uint16_t page_timeout){
+    hci_cmd_buffer[0] = 0x18;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (page_timeout);
+    hci_cmd_buffer[4] = (uint8_t) (page_timeout >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_write_scan_enable into hci_cmd_buffer
+ * @param scan_enable
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_scan_enable(uint8_t * hci_cmd_buffer, uint8_t scan_enable){
+    hci_cmd_buffer[0] = 0x1a;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = scan_enable;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_write_authentication_enable into hci_cmd_buffer
+ * @param authentication_enable
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_authentication_enable(uint8_t * hci_cmd_buffer, uint8_t authentication_enable){
+    hci_cmd_buffer[0] = 0x20;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = authentication_enable;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_write_class_of_device into hci_cmd_buffer
+ * @param class_of_device
+ * @return size of HCI Command packet
+ * @note: format 3
+ */
+static inline uint16_t hci_cmd_encode_write_class_of_device(uint8_t * hci_cmd_buffer, uint32_t class_of_device){
+    hci_cmd_buffer[0] = 0x24;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 3;
+    hci_cmd_buffer[3] = (uint8_t) (class_of_device);
+    hci_cmd_buffer[4] = (uint8_t) (class_of_device >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (class_of_device >> 16);
+    return 6;
+}
+
+/**
+ * @brief Encode hci_read_num_broadcast_retransmissions into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_num_broadcast_retransmissions(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x29;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_write_num_broadcast_retransmissions into hci_cmd_buffer
+ * @param num_broadcast_retransmissions
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_num_broadcast_retransmissions(uint8_t * hci_cmd_buffer, uint8_t num_broadcast_retransmissions){
+    hci_cmd_buffer[0] = 0x2a;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = num_broadcast_retransmissions;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_write_synchronous_flow_control_enable into hci_cmd_buffer
+ * @param synchronous_flow_control_enable
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_synchronous_flow_control_enable(uint8_t * hci_cmd_buffer, uint8_t synchronous_flow_control_enable){
+    hci_cmd_buffer[0] = 0x2f;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = synchronous_flow_control_enable;
+    return 4;
+}
+
+#ifdef ENABLE_HCI_CONTROLLER_TO_HOST_FLOW_CONTROL
+
+/**
+ * @brief Encode hci_set_controller_to_host_flow_control into hci_cmd_buffer
+ * @param flow_control_enable
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_set_controller_to_host_flow_control(uint8_t * hci_cmd_buffer, uint8_t flow_control_enable){
+    hci_cmd_buffer[0] = 0x31;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = flow_control_enable;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_host_buffer_size into hci_cmd_buffer
+ * @param host_acl_data_packet_length
+ * @param host_synchronous_data_packet_length
+ * @param host_total_num_acl_data_packets
+ * @param host_total_num_synchronous_data_packets
+ * @return size of HCI Command packet
+ * @note: format 2122
+ */
+static inline uint16_t hci_cmd_encode_host_buffer_size(uint8_t * hci_cmd_buffer, uint16_t host_acl_data_packet_length, uint8_t host_synchronous_data_packet_length, uint16_t host_total_num_acl_data_packets, uint16_t host_total_num_synchronous_data_packets){
+    hci_cmd_buffer[0] = 0x33;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 7;
+    hci_cmd_buffer[3] = (uint8_t) (host_acl_data_packet_length);
+    hci_cmd_buffer[4] = (uint8_t) (host_acl_data_packet_length >> 8);
+    hci_cmd_buffer[5] = host_synchronous_data_packet_length;
+    hci_cmd_buffer[6] = (uint8_t) (host_total_num_acl_data_packets);
+    hci_cmd_buffer[7] = (uint8_t) (host_total_num_acl_data_packets >> 8);
+    hci_cmd_buffer[8] = (uint8_t) (host_total_num_synchronous_data_packets);
+    hci_cmd_buffer[9] = (uint8_t) (host_total_num_synchronous_data_packets >> 8);
+    return 10;
+}
+
+#endif
+
+/**
+ * @brief Encode hci_read_link_supervision_timeout into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_link_supervision_timeout(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x36;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_write_link_supervision_timeout into hci_cmd_buffer
+ * @param handle
+ * @param timeout
+ * @return size of HCI Command packet
+ * @note: format H2
+ */
+static inline uint16_t hci_cmd_encode_write_link_supervision_timeout(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint16_t timeout){
+    hci_cmd_buffer[0] = 0x37;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 4;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (timeout);
+    hci_cmd_buffer[6] = (uint8_t) (timeout >> 8);
+    return 7;
+}
+
+/**
+ * @brief Encode hci_write_inquiry_mode into hci_cmd_buffer
+ * @param inquiry_mode
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_inquiry_mode(uint8_t * hci_cmd_buffer, uint8_t inquiry_mode){
+    hci_cmd_buffer[0] = 0x45;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = inquiry_mode;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_write_extended_inquiry_response into hci_cmd_buffer
+ * @param fec_required
+ * @param exstended_inquiry_response
+ * @return size of HCI Command packet
+ * @note: format 1E
+ */
+static inline uint16_t hci_cmd_encode_write_extended_inquiry_response(uint8_t * hci_cmd_buffer, uint8_t fec_required, const uint8_t * exstended_inquiry_response){
+    hci_cmd_buffer[0] = 0x52;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 241;
+    hci_cmd_buffer[3] = fec_required;
+    memcpy(&hci_cmd_buffer[4], exstended_inquiry_response, 240);
+    return 244;
+}
+
+/**
+ * @brief Encode hci_write_simple_pairing_mode into hci_cmd_buffer
+ * @param mode
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_simple_pairing_mode(uint8_t * hci_cmd_buffer, uint8_t mode){
+    hci_cmd_buffer[0] = 0x56;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = mode;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_read_local_oob_data into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_local_oob_data(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x57;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_write_default_erroneous_data_reporting into hci_cmd_buffer
+ * @param mode
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_default_erroneous_data_reporting(uint8_t * hci_cmd_buffer, uint8_t mode){
+    hci_cmd_buffer[0] = 0x5b;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = mode;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_read_le_host_supported into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_le_host_supported(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x6c;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_write_le_host_supported into hci_cmd_buffer
+ * @param le_supported_host
+ * @param simultaneous_le_host
+ * @return size of HCI Command packet
+ * @note: format 11
+ */
+static inline uint16_t hci_cmd_encode_write_le_host_supported(uint8_t * hci_cmd_buffer, uint8_t le_supported_host, uint8_t simultaneous_le_host){
+    hci_cmd_buffer[0] = 0x6d;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = le_supported_host;
+    hci_cmd_buffer[4] = simultaneous_le_host;
+    return 5;
+}
+
+/**
+ * @brief Encode hci_read_local_extended_ob_data into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_local_extended_ob_data(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x7d;
+    hci_cmd_buffer[1] = 0x0c;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_read_loopback_mode into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_loopback_mode(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x01;
+    hci_cmd_buffer[1] = 0x18;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_write_loopback_mode into hci_cmd_buffer
+ * @param loopback_mode
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_loopback_mode(uint8_t * hci_cmd_buffer, uint8_t loopback_mode){
+    hci_cmd_buffer[0] = 0x02;
+    hci_cmd_buffer[1] = 0x18;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = loopback_mode;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_enable_device_under_test_mode into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_enable_device_under_test_mode(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x03;
+    hci_cmd_buffer[1] = 0x18;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_write_simple_pairing_debug_mode into hci_cmd_buffer
+ * @param simple_pairing_debug_mode
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_simple_pairing_debug_mode(uint8_t * hci_cmd_buffer, uint8_t simple_pairing_debug_mode){
+    hci_cmd_buffer[0] = 0x04;
+    hci_cmd_buffer[1] = 0x18;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = simple_pairing_debug_mode;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_write_secure_connections_test_mode into hci_cmd_buffer
+ * @param handle
+ * @param dm1_acl_u_mode
+ * @param esco_loopback_mode
+ * @return size of HCI Command packet
+ * @note: format H11
+ */
+static inline uint16_t hci_cmd_encode_write_secure_connections_test_mode(uint8_t * hci_cmd_buffer, hci_con_handle_t handle, uint8_t dm1_acl_u_mode, uint8_t esco_loopback_mode){
+    hci_cmd_buffer[0] = 0x0a;
+    hci_cmd_buffer[1] = 0x18;
+    hci_cmd_buffer[2] = 4;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    hci_cmd_buffer[5] = dm1_acl_u_mode;
+    hci_cmd_buffer[6] = esco_loopback_mode;
+    return 7;
+}
+
+/**
+ * @brief Encode hci_read_local_version_information into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_local_version_information(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x01;
+    hci_cmd_buffer[1] = 0x10;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_read_local_supported_commands into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_local_supported_commands(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x02;
+    hci_cmd_buffer[1] = 0x10;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_read_local_supported_features into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_local_supported_features(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x03;
+    hci_cmd_buffer[1] = 0x10;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_read_buffer_size into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_buffer_size(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x05;
+    hci_cmd_buffer[1] = 0x10;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_read_bd_addr into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_read_bd_addr(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x09;
+    hci_cmd_buffer[1] = 0x10;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_read_rssi into hci_cmd_buffer
+ * @param handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_rssi(uint8_t * hci_cmd_buffer, hci_con_handle_t handle){
+    hci_cmd_buffer[0] = 0x05;
+    hci_cmd_buffer[1] = 0x14;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (handle);
+    hci_cmd_buffer[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+#ifdef ENABLE_BLE
+
+/**
+ * @brief Encode hci_le_set_event_mask into hci_cmd_buffer
+ * @param event_mask_lower_octets
+ * @param event_mask_higher_octets
+ * @return size of HCI Command packet
+ * @note: format 44
+ */
+static inline uint16_t hci_cmd_encode_le_set_event_mask(uint8_t * hci_cmd_buffer, uint32_t event_mask_lower_octets, uint32_t event_mask_higher_octets){
+    hci_cmd_buffer[0] = 0x01;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 8;
+    hci_cmd_buffer[3] = (uint8_t) (event_mask_lower_octets);
+    hci_cmd_buffer[4] = (uint8_t) (event_mask_lower_octets >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (event_mask_lower_octets >> 16);
+    hci_cmd_buffer[6] = (uint8_t) (event_mask_lower_octets >> 24);
+    hci_cmd_buffer[7] = (uint8_t) (event_mask_higher_octets);
+    hci_cmd_buffer[8] = (uint8_t) (event_mask_higher_octets >> 8);
+    hci_cmd_buffer[9] = (uint8_t) (event_mask_higher_octets >> 16);
+    hci_cmd_buffer[10] = (uint8_t) (event_mask_higher_octets >> 24);
+    return 11;
+}
+
+/**
+ * @brief Encode hci_le_read_buffer_size into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_buffer_size(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x02;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_read_supported_features into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_supported_features(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x03;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_set_random_address into hci_cmd_buffer
+ * @param random_bd_addr
+ * @return size of HCI Command packet
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_le_set_random_address(uint8_t * hci_cmd_buffer, const bd_addr_t random_bd_addr){
+    hci_cmd_buffer[0] = 0x05;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 6;
+    reverse_bd_addr(random_bd_addr, &hci_cmd_buffer[3]);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_le_set_advertising_parameters into hci_cmd_buffer
+ * @param advertising_interval_min
+ * @param advertising_interval_max
+ * @param advertising_type
+ * @param own_address_type
+ * @param direct_address_type
+ * @param direct_address
+ * @param advertising_channel_map
+ * @param advertising_filter_policy
+ * @return size of HCI Command packet
+ * @note: format 22111B11
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertising_parameters(uint8_t * hci_cmd_buffer, uint16_t advertising_interval_min, uint16_t advertising_interval_max, uint8_t advertising_type, uint8_t own_address_type, uint8_t direct_address_type, const bd_addr_t direct_address, uint8_t advertising_channel_map, uint8_t advertising_filter_policy){
+    hci_cmd_buffer[0] = 0x06;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 15;
+    hci_cmd_buffer[3] = (uint8_t) (advertising_interval_min);
+    hci_cmd_buffer[4] = (uint8_t) (advertising_interval_min >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (advertising_interval_max);
+    hci_cmd_buffer[6] = (uint8_t) (advertising_interval_max >> 8);
+    hci_cmd_buffer[7] = advertising_type;
+    hci_cmd_buffer[8] = own_address_type;
+    hci_cmd_buffer[9] = direct_address_type;
+    reverse_bd_addr(direct_address, &hci_cmd_buffer[10]);
+    hci_cmd_buffer[16] = advertising_channel_map;
+    hci_cmd_buffer[17] = advertising_filter_policy;
+    return 18;
+}
+
+/**
+ * @brief Encode hci_le_read_advertising_channel_tx_power into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_advertising_channel_tx_power(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x07;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_set_advertising_data into hci_cmd_buffer
+ * @param advertising_data_length
+ * @param advertising_data
+ * @return size of HCI Command packet
+ * @note: format 1A
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertising_data(uint8_t * hci_cmd_buffer, uint8_t advertising_data_length, const uint8_t * advertising_data){
+    hci_cmd_buffer[0] = 0x08;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 32;
+    hci_cmd_buffer[3] = advertising_data_length;
+    memcpy(&hci_cmd_buffer[4], advertising_data, 31);
+    return 35;
+}
+
+/**
+ * @brief Encode hci_le_set_scan_response_data into hci_cmd_buffer
+ * @param scan_response_data_length
+ * @param scan_response_data
+ * @return size of HCI Command packet
+ * @note: format 1A
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_response_data(uint8_t * hci_cmd_buffer, uint8_t scan_response_data_length, const uint8_t * scan_response_data){
+    hci_cmd_buffer[0] = 0x09;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 32;
+    hci_cmd_buffer[3] = scan_response_data_length;
+    memcpy(&hci_cmd_buffer[4], scan_response_data, 31);
+    return 35;
+}
+
+/**
+ * @brief Encode hci_le_set_advertise_enable into hci_cmd_buffer
+ * @param advertise_enable
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertise_enable(uint8_t * hci_cmd_buffer, uint8_t advertise_enable){
+    hci_cmd_buffer[0] = 0x0a;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = advertise_enable;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_le_set_scan_parameters into hci_cmd_buffer
+ * @param le_scan_type
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param own_address_type
+ * @param scanning_filter_policy
+ * @return size of HCI Command packet
+ * @note: format 12211
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_parameters(uint8_t * hci_cmd_buffer, uint8_t le_scan_type, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t own_address_type, uint8_t scanning_filter_policy){
+    hci_cmd_buffer[0] = 0x0b;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 7;
+    hci_cmd_buffer[3] = le_scan_type;
+    hci_cmd_buffer[4] = (uint8_t) (le_scan_interval);
+    hci_cmd_buffer[5] = (uint8_t) (le_scan_interval >> 8);
+    hci_cmd_buffer[6] = (uint8_t) (le_scan_window);
+    hci_cmd_buffer[7] = (uint8_t) (le_scan_window >> 8);
+    hci_cmd_buffer[8] = own_address_type;
+    hci_cmd_buffer[9] = scanning_filter_policy;
+    return 10;
+}
+
+/**
+ * @brief Encode hci_le_set_scan_enable into hci_cmd_buffer
+ * @param le_scan_enable
+ * @param filter_duplices
+ * @return size of HCI Command packet
+ * @note: format 11
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_enable(uint8_t * hci_cmd_buffer, uint8_t le_scan_enable, uint8_t filter_duplices){
+    hci_cmd_buffer[0] = 0x0c;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = le_scan_enable;
+    hci_cmd_buffer[4] = filter_duplices;
+    return 5;
+}
+
+/**
+ * @brief Encode hci_le_create_connection into hci_cmd_buffer
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param initiator_filter_policy
+ * @param peer_address_type
+ * @param peer_address
+ * @param own_address_type
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of HCI Command packet
+ * @note: format 2211B1222222
+ */
+static inline uint16_t hci_cmd_encode_le_create_connection(uint8_t * hci_cmd_buffer, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t initiator_filter_policy, uint8_t peer_address_type, const bd_addr_t peer_address, uint8_t own_address_type, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    hci_cmd_buffer[0] = 0x0d;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 25;
+    hci_cmd_buffer[3] = (uint8_t) (le_scan_interval);
+    hci_cmd_buffer[4] = (uint8_t) (le_scan_interval >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (le_scan_window);
+    hci_cmd_buffer[6] = (uint8_t) (le_scan_window >> 8);
+    hci_cmd_buffer[7] = initiator_filter_policy;
+    hci_cmd_buffer[8] = peer_address_type;
+    reverse_bd_addr(peer_address, &hci_cmd_buffer[9]);
+    hci_cmd_buffer[15] = own_address_type;
+    hci_cmd_buffer[16] = (uint8_t) (conn_interval_min);
+    hci_cmd_buffer[17] = (uint8_t) (conn_interval_min >> 8);
+    hci_cmd_buffer[18] = (uint8_t) (conn_interval_max);
+    hci_cmd_buffer[19] = (uint8_t) (conn_interval_max >> 8);
+    hci_cmd_buffer[20] = (uint8_t) (conn_latency);
+    hci_cmd_buffer[21] = (uint8_t) (conn_latency >> 8);
+    hci_cmd_buffer[22] = (uint8_t) (supervision_timeout);
+    hci_cmd_buffer[23] = (uint8_t) (supervision_timeout >> 8);
+    hci_cmd_buffer[24] = (uint8_t) (minimum_ce_length);
+    hci_cmd_buffer[25] = (uint8_t) (minimum_ce_length >> 8);
+    hci_cmd_buffer[26] = (uint8_t) (maximum_ce_length);
+    hci_cmd_buffer[27] = (uint8_t) (maximum_ce_length >> 8);
+    return 28;
+}
+
+/**
+ * @brief Encode hci_le_create_connection_cancel into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_create_connection_cancel(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x0e;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_read_white_list_size into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_white_list_size(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x0f;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_clear_white_list into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_clear_white_list(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x10;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_add_device_to_white_list into hci_cmd_buffer
+ * @param address_type
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format 1B
+ */
+static inline uint16_t hci_cmd_encode_le_add_device_to_white_list(uint8_t * hci_cmd_buffer, uint8_t address_type, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x11;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 7;
+    hci_cmd_buffer[3] = address_type;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[4]);
+    return 10;
+}
+
+/**
+ * @brief Encode hci_le_remove_device_from_white_list into hci_cmd_buffer
+ * @param address_type
+ * @param bd_addr
+ * @return size of HCI Command packet
+ * @note: format 1B
+ */
+static inline uint16_t hci_cmd_encode_le_remove_device_from_white_list(uint8_t * hci_cmd_buffer, uint8_t address_type, const bd_addr_t bd_addr){
+    hci_cmd_buffer[0] = 0x12;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 7;
+    hci_cmd_buffer[3] = address_type;
+    reverse_bd_addr(bd_addr, &hci_cmd_buffer[4]);
+    return 10;
+}
+
+/**
+ * @brief Encode hci_le_connection_update into hci_cmd_buffer
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of HCI Command packet
+ * @note: format H222222
+ */
+static inline uint16_t hci_cmd_encode_le_connection_update(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    hci_cmd_buffer[0] = 0x13;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 14;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (conn_interval_min);
+    hci_cmd_buffer[6] = (uint8_t) (conn_interval_min >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (conn_interval_max);
+    hci_cmd_buffer[8] = (uint8_t) (conn_interval_max >> 8);
+    hci_cmd_buffer[9] = (uint8_t) (conn_latency);
+    hci_cmd_buffer[10] = (uint8_t) (conn_latency >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (supervision_timeout);
+    hci_cmd_buffer[12] = (uint8_t) (supervision_timeout >> 8);
+    hci_cmd_buffer[13] = (uint8_t) (minimum_ce_length);
+    hci_cmd_buffer[14] = (uint8_t) (minimum_ce_length >> 8);
+    hci_cmd_buffer[15] = (uint8_t) (maximum_ce_length);
+    hci_cmd_buffer[16] = (uint8_t) (maximum_ce_length >> 8);
+    return 17;
+}
+
+/**
+ * @brief Encode hci_le_set_host_channel_classification into hci_cmd_buffer
+ * @param channel_map_lower_32bits
+ * @param channel_map_higher_5bits
+ * @return size of HCI Command packet
+ * @note: format 41
+ */
+static inline uint16_t hci_cmd_encode_le_set_host_channel_classification(uint8_t * hci_cmd_buffer, uint32_t channel_map_lower_32bits, uint8_t channel_map_higher_5bits){
+    hci_cmd_buffer[0] = 0x14;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 5;
+    hci_cmd_buffer[3] = (uint8_t) (channel_map_lower_32bits);
+    hci_cmd_buffer[4] = (uint8_t) (channel_map_lower_32bits >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (channel_map_lower_32bits >> 16);
+    hci_cmd_buffer[6] = (uint8_t) (channel_map_lower_32bits >> 24);
+    hci_cmd_buffer[7] = channel_map_higher_5bits;
+    return 8;
+}
+
+/**
+ * @brief Encode hci_le_read_channel_map into hci_cmd_buffer
+ * @param conn_handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_channel_map(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle){
+    hci_cmd_buffer[0] = 0x15;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_le_read_remote_used_features into hci_cmd_buffer
+ * @param conn_handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_remote_used_features(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle){
+    hci_cmd_buffer[0] = 0x16;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_le_encrypt into hci_cmd_buffer
+ * @param key
+ * @param plain_text
+ * @return size of HCI Command packet
+ * @note: format PP
+ */
+static inline uint16_t hci_cmd_encode_le_encrypt(uint8_t * hci_cmd_buffer, const uint8_t * key, const uint8_t * plain_text){
+    hci_cmd_buffer[0] = 0x17;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 32;
+    memcpy(&hci_cmd_buffer[3], key, 16);
+    memcpy(&hci_cmd_buffer[19], plain_text, 16);
+    return 35;
+}
+
+/**
+ * @brief Encode hci_le_rand into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_rand(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x18;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_start_encryption into hci_cmd_buffer
+ * @param conn_handle
+ * @param random_number_lower_32bits
+ * @param random_number_higher_32bits
+ * @param encryption_diversifier
+ * @param long_term_key
+ * @return size of HCI Command packet
+ * @note: format H442P
+ */
+static inline uint16_t hci_cmd_encode_le_start_encryption(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle, uint32_t random_number_lower_32bits, uint32_t random_number_higher_32bits, uint16_t encryption_diversifier, const uint8_t * long_term_key){
+    hci_cmd_buffer[0] = 0x19;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 28;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (random_number_lower_32bits);
+    hci_cmd_buffer[6] = (uint8_t) (random_number_lower_32bits >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (random_number_lower_32bits >> 16);
+    hci_cmd_buffer[8] = (uint8_t) (random_number_lower_32bits >> 24);
+    hci_cmd_buffer[9] = (uint8_t) (random_number_higher_32bits);
+    hci_cmd_buffer[10] = (uint8_t) (random_number_higher_32bits >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (random_number_higher_32bits >> 16);
+    hci_cmd_buffer[12] = (uint8_t) (random_number_higher_32bits >> 24);
+    hci_cmd_buffer[13] = (uint8_t) (encryption_diversifier);
+    hci_cmd_buffer[14] = (uint8_t) (encryption_diversifier >> 8);
+    memcpy(&hci_cmd_buffer[15], long_term_key, 16);
+    return 31;
+}
+
+/**
+ * @brief Encode hci_le_long_term_key_request_reply into hci_cmd_buffer
+ * @param connection_handle
+ * @param long_term_key
+ * @return size of HCI Command packet
+ * @note: format HP
+ */
+static inline uint16_t hci_cmd_encode_le_long_term_key_request_reply(uint8_t * hci_cmd_buffer, hci_con_handle_t connection_handle, const uint8_t * long_term_key){
+    hci_cmd_buffer[0] = 0x1a;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 18;
+    hci_cmd_buffer[3] = (uint8_t) (connection_handle);
+    hci_cmd_buffer[4] = (uint8_t) (connection_handle >> 8);
+    memcpy(&hci_cmd_buffer[5], long_term_key, 16);
+    return 21;
+}
+
+/**
+ * @brief Encode hci_le_long_term_key_negative_reply into hci_cmd_buffer
+ * @param conn_handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_long_term_key_negative_reply(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle){
+    hci_cmd_buffer[0] = 0x1b;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_le_read_supported_states into hci_cmd_buffer
+ * @param conn_handle
+ * @return size of HCI Command packet
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_supported_states(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle){
+    hci_cmd_buffer[0] = 0x1c;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 2;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Encode hci_le_receiver_test into hci_cmd_buffer
+ * @param rx_frequency
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_le_receiver_test(uint8_t * hci_cmd_buffer, uint8_t rx_frequency){
+    hci_cmd_buffer[0] = 0x1d;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = rx_frequency;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_le_transmitter_test into hci_cmd_buffer
+ * @param tx_frequency
+ * @param test_payload_lengh
+ * @param packet_payload
+ * @return size of HCI Command packet
+ * @note: format 111
+ */
+static inline uint16_t hci_cmd_encode_le_transmitter_test(uint8_t * hci_cmd_buffer, uint8_t tx_frequency, uint8_t test_payload_lengh, uint8_t packet_payload){
+    hci_cmd_buffer[0] = 0x1e;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 3;
+    hci_cmd_buffer[3] = tx_frequency;
+    hci_cmd_buffer[4] = test_payload_lengh;
+    hci_cmd_buffer[5] = packet_payload;
+    return 6;
+}
+
+/**
+ * @brief Encode hci_le_test_end into hci_cmd_buffer
+ * @param end_test_cmd
+ * @return size of HCI Command packet
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_le_test_end(uint8_t * hci_cmd_buffer, uint8_t end_test_cmd){
+    hci_cmd_buffer[0] = 0x1f;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 1;
+    hci_cmd_buffer[3] = end_test_cmd;
+    return 4;
+}
+
+/**
+ * @brief Encode hci_le_remote_connection_parameter_request_reply into hci_cmd_buffer
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of HCI Command packet
+ * @note: format H222222
+ */
+static inline uint16_t hci_cmd_encode_le_remote_connection_parameter_request_reply(uint8_t * hci_cmd_buffer, hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    hci_cmd_buffer[0] = 0x20;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 14;
+    hci_cmd_buffer[3] = (uint8_t) (conn_handle);
+    hci_cmd_buffer[4] = (uint8_t) (conn_handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (conn_interval_min);
+    hci_cmd_buffer[6] = (uint8_t) (conn_interval_min >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (conn_interval_max);
+    hci_cmd_buffer[8] = (uint8_t) (conn_interval_max >> 8);
+    hci_cmd_buffer[9] = (uint8_t) (conn_latency);
+    hci_cmd_buffer[10] = (uint8_t) (conn_latency >> 8);
+    hci_cmd_buffer[11] = (uint8_t) (supervision_timeout);
+    hci_cmd_buffer[12] = (uint8_t) (supervision_timeout >> 8);
+    hci_cmd_buffer[13] = (uint8_t) (minimum_ce_length);
+    hci_cmd_buffer[14] = (uint8_t) (minimum_ce_length >> 8);
+    hci_cmd_buffer[15] = (uint8_t) (maximum_ce_length);
+    hci_cmd_buffer[16] = (uint8_t) (maximum_ce_length >> 8);
+    return 17;
+}
+
+/**
+ * @brief Encode hci_le_remote_connection_parameter_request_negative_reply into hci_cmd_buffer
+ * @param con_handle
+ * @param reason
+ * @return size of HCI Command packet
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_le_remote_connection_parameter_request_negative_reply(uint8_t * hci_cmd_buffer, hci_con_handle_t con_handle, uint8_t reason){
+    hci_cmd_buffer[0] = 0x21;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 3;
+    hci_cmd_buffer[3] = (uint8_t) (con_handle);
+    hci_cmd_buffer[4] = (uint8_t) (con_handle >> 8);
+    hci_cmd_buffer[5] = reason;
+    return 6;
+}
+
+/**
+ * @brief Encode hci_le_set_data_length into hci_cmd_buffer
+ * @param con_handle
+ * @param tx_octets
+ * @param tx_time
+ * @return size of HCI Command packet
+ * @note: format H22
+ */
+static inline uint16_t hci_cmd_encode_le_set_data_length(uint8_t * hci_cmd_buffer, hci_con_handle_t con_handle, uint16_t tx_octets, uint16_t tx_time){
+    hci_cmd_buffer[0] = 0x22;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 6;
+    hci_cmd_buffer[3] = (uint8_t) (con_handle);
+    hci_cmd_buffer[4] = (uint8_t) (con_handle >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (tx_octets);
+    hci_cmd_buffer[6] = (uint8_t) (tx_octets >> 8);
+    hci_cmd_buffer[7] = (uint8_t) (tx_time);
+    hci_cmd_buffer[8] = (uint8_t) (tx_time >> 8);
+    return 9;
+}
+
+/**
+ * @brief Encode hci_le_read_suggested_default_data_length into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_suggested_default_data_length(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x23;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_write_suggested_default_data_length into hci_cmd_buffer
+ * @param suggested_max_tx_octets
+ * @param suggested_max_tx_time
+ * @return size of HCI Command packet
+ * @note: format 22
+ */
+static inline uint16_t hci_cmd_encode_le_write_suggested_default_data_length(uint8_t * hci_cmd_buffer, uint16_t suggested_max_tx_octets, uint16_t suggested_max_tx_time){
+    hci_cmd_buffer[0] = 0x24;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 4;
+    hci_cmd_buffer[3] = (uint8_t) (suggested_max_tx_octets);
+    hci_cmd_buffer[4] = (uint8_t) (suggested_max_tx_octets >> 8);
+    hci_cmd_buffer[5] = (uint8_t) (suggested_max_tx_time);
+    hci_cmd_buffer[6] = (uint8_t) (suggested_max_tx_time >> 8);
+    return 7;
+}
+
+/**
+ * @brief Encode hci_le_read_local_p256_public_key into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_local_p256_public_key(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x25;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Encode hci_le_generate_dhkey into hci_cmd_buffer
+ * @param param_public
+ * @param param_private
+ * @return size of HCI Command packet
+ * @note: format QQ
+ */
+static inline uint16_t hci_cmd_encode_le_generate_dhkey(uint8_t * hci_cmd_buffer, const uint8_t * param_public, const uint8_t * param_private){
+    hci_cmd_buffer[0] = 0x26;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 64;
+    reverse_bytes(param_public, &hci_cmd_buffer[3], 32);
+    reverse_bytes(param_private, &hci_cmd_buffer[35], 32);
+    return 67;
+}
+
+/**
+ * @brief Encode hci_le_read_maximum_data_length into hci_cmd_buffer
+ * @return size of HCI Command packet
+ * @note: format 
+ */
+static inline uint16_t hci_cmd_encode_le_read_maximum_data_length(uint8_t * hci_cmd_buffer){
+    hci_cmd_buffer[0] = 0x2f;
+    hci_cmd_buffer[1] = 0x20;
+    hci_cmd_buffer[2] = 0;
+    return 3;
+}
+
+#endif
+
+/**
+ * @brief Encode hci_bcm_write_sco_pcm_int into hci_cmd_buffer
+ * @param sco_routing
+ * @param pcm_interface_rate
+ * @param frame_type
+ * @param sync_mode
+ * @param clock_mode
+ * @return size of HCI Command packet
+ * @note: format 11111
+ */
+static inline uint16_t hci_cmd_encode_bcm_write_sco_pcm_int(uint8_t * hci_cmd_buffer, uint8_t sco_routing, uint8_t pcm_interface_rate, uint8_t frame_type, uint8_t sync_mode, uint8_t clock_mode){
+    hci_cmd_buffer[0] = 0x1c;
+    hci_cmd_buffer[1] = 0xfc;
+    hci_cmd_buffer[2] = 5;
+    hci_cmd_buffer[3] = sco_routing;
+    hci_cmd_buffer[4] = pcm_interface_rate;
+    hci_cmd_buffer[5] = frame_type;
+    hci_cmd_buffer[6] = sync_mode;
+    hci_cmd_buffer[7] = clock_mode;
+    return 8;
+}
+
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __HCI_CMD_ENCODER_H
@@ -46,6 +46,9 @@
  *  - Apple's PacketLogger
  *  - stdout hexdump
  *
+ *  With ENABLE_HCI_DUMP_ASYNC, binary records are appended to a lock-free ring buffer
+ *  and written to file by a background thread.
+ *
  *  Created by Matthias Ringwald on 5/26/09.
  */
 
@@ -57,6 +60,7 @@
 #include "hci_cmd.h"
 #include "btstack_run_loop.h"
 #include <stdio.h>
+#include <string.h>
 
 #ifdef HAVE_POSIX_FILE_IO
 #include <fcntl.h>        // open
@@ -66,6 +70,33 @@
 #include <sys/stat.h>     // for mode flags
 #endif
 
+#ifdef ENABLE_HCI_DUMP_ASYNC
+#ifndef HAVE_POSIX_FILE_IO
+#error "ENABLE_HCI_DUMP_ASYNC requires HAVE_POSIX_FILE_IO"
+#endif
+#include <errno.h>
+#include <pthread.h>
+#include <sys/uio.h>      // writev
+#include "btstack_spsc_ring_buffer.h"
+
+// writer thread polls ring buffer if empty
+#ifndef HCI_DUMP_ASYNC_POLL_MS
+#define HCI_DUMP_ASYNC_POLL_MS 10
+#endif
+
+// max records written by single writev call
+#define HCI_DUMP_ASYNC_MAX_IOV 64
+
+// flag to stop writer thread
+#ifdef __GNUC__
+#define ASYNC_ACTIVE_LOAD()       __atomic_load_n(&async_active, __ATOMIC_ACQUIRE)
+#define ASYNC_ACTIVE_STORE(value) __atomic_store_n(&async_active, (value), __ATOMIC_RELEASE)
+#else
+#define ASYNC_ACTIVE_LOAD()       (async_active)
+#define ASYNC_ACTIVE_STORE(value) (async_active = (value))
+#endif
+#endif
+
 // BLUEZ hcidump - struct not used directly, but left here as documentation
 typedef struct {
     uint16_t    len;
@@ -97,24 +128,289 @@ static char time_string[40];
 static int  max_nr_packets = -1;
 static int  nr_packets = 0;
 static char log_message_buffer[256];
+static char dump_file_name[256];
+static int  max_nr_files = 0;
 #endif
 
+#ifdef ENABLE_HCI_DUMP_ASYNC
+// records are stored with 16-bit little endian length prefix, length 0 requests file rotation
+static btstack_spsc_ring_buffer_t async_ring_buffer;
+static int async_dump_file;         // owned by writer thread
+static pthread_t async_writer_thread;
+static int async_active;
+static uint32_t async_dropped_unreported;
+// written by writer thread, read by hci_dump_close after join
+static uint32_t async_write_failures;
+static int async_write_errno;
+#endif
+
+static uint32_t dropped_packets;
+
+// filter and sampling for HCI Command, ACL, SCO and Event packets
+#define HCI_DUMP_NUM_FILTERED_TYPES (HCI_EVENT_PACKET + 1)
+static hci_dump_packet_filter_t packet_filter[HCI_DUMP_NUM_FILTERED_TYPES];
+static uint16_t packet_sample_rate[HCI_DUMP_NUM_FILTERED_TYPES];
+static uint16_t packet_sample_counter[HCI_DUMP_NUM_FILTERED_TYPES];
+
 // levels: debug, info, error
 static int log_level_enabled[3] = { 1, 1, 1};
 
+#ifdef HAVE_POSIX_FILE_IO
+static int hci_dump_open_file(const char * filename){
+    int oflags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef _WIN32
+    oflags |= O_BINARY;
+#endif
+    return open(filename, oflags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+}
+
+// start new file, either by truncating current one or by renaming it to <name>.1, <name>.1 to <name>.2, ...
+// @returns file descriptor of new file
+static int hci_dump_rotate_file(int file){
+    if (max_nr_files <= 1){
+        lseek(file, 0, SEEK_SET);
+        ftruncate(file, 0);
+        return file;
+    }
+    char old_name[sizeof(dump_file_name) + 12];
+    char new_name[sizeof(dump_file_name) + 12];
+    close(file);
+    int i;
+    for (i = max_nr_files - 1; i > 0; i--){
+        if (i == 1){
+            snprintf(old_name, sizeof(old_name), "%s", dump_file_name);
+        } else {
+            snprintf(old_name, sizeof(old_name), "%s.%u", dump_file_name, i - 1);
+        }
+        snprintf(new_name, sizeof(new_name), "%s.%u", dump_file_name, i);
+        rename(old_name, new_name);
+    }
+    return hci_dump_open_file(dump_file_name);
+}
+
+// @returns header size or 0 if packet type not supported by format
+static int hci_dump_store_header(uint8_t * header, uint8_t packet_type, uint8_t in, uint16_t len, struct timeval * curr_time){
+    switch (dump_format){
+        case HCI_DUMP_BLUEZ:
+            little_endian_store_16( header, 0, 1 + len);
+            header[2] = in;
+            header[3] = 0;
+            little_endian_store_32( header, 4, (uint32_t) curr_time->tv_sec);
+            little_endian_store_32( header, 8,            curr_time->tv_usec);
+            header[12] = packet_type;
+            return HCIDUMP_HDR_SIZE;
+
+        case HCI_DUMP_PACKETLOGGER:
+            big_endian_store_32( header, 0, PKTLOG_HDR_SIZE - 4 + len);
+            big_endian_store_32( header, 4,  (uint32_t) curr_time->tv_sec);
+            big_endian_store_32( header, 8, curr_time->tv_usec);
+            switch (packet_type){
+                case HCI_COMMAND_DATA_PACKET:
+                    header[12] = 0x00;
+                    break;
+                case HCI_ACL_DATA_PACKET:
+                    if (in) {
+                        header[12] = 0x03;
+                    } else {
+                        header[12] = 0x02;
+                    }
+                    break;
+                case HCI_SCO_DATA_PACKET:
+                    if (in) {
+                        header[12] = 0x09;
+                    } else {
+                        header[12] = 0x08;
+                    }
+                    break;
+                case HCI_EVENT_PACKET:
+                    header[12] = 0x01;
+                    break;
+                case LOG_MESSAGE_PACKET:
+                    header[12] = 0xfc;
+                    break;
+                default:
+                    return 0;
+            }
+            return PKTLOG_HDR_SIZE;
+
+        default:
+            return 0;
+    }
+}
+#endif
+
+#ifdef ENABLE_HCI_DUMP_ASYNC
+static void hci_dump_async_span_copy_to(btstack_spsc_ring_buffer_span_t * span, uint32_t offset, const uint8_t * data, uint32_t len){
+    while (len){
+        int region = offset < span->len[0] ? 0 : 1;
+        uint32_t region_offset = region ? offset - span->len[0] : offset;
+        uint32_t bytes_to_copy = btstack_min(len, span->len[region] - region_offset);
+        memcpy(&span->data[region][region_offset], data, bytes_to_copy);
+        offset += bytes_to_copy;
+        data   += bytes_to_copy;
+        len    -= bytes_to_copy;
+    }
+}
+
+static uint8_t hci_dump_async_span_get_byte(btstack_spsc_ring_buffer_span_t * span, uint32_t offset){
+    if (offset < span->len[0]) return span->data[0][offset];
+    return span->data[1][offset - span->len[0]];
+}
+
+// add range of span to iovec array, @returns number of iovecs used
+static int hci_dump_async_span_to_iov(btstack_spsc_ring_buffer_span_t * span, uint32_t offset, uint32_t len, struct iovec * iov){
+    if (offset >= span->len[0]){
+        iov[0].iov_base = &span->data[1][offset - span->len[0]];
+        iov[0].iov_len  = len;
+        return 1;
+    }
+    if (offset + len <= span->len[0]){
+        iov[0].iov_base = &span->data[0][offset];
+        iov[0].iov_len  = len;
+        return 1;
+    }
+    iov[0].iov_base = &span->data[0][offset];
+    iov[0].iov_len  = span->len[0] - offset;
+    iov[1].iov_base = span->data[1];
+    iov[1].iov_len  = len - iov[0].iov_len;
+    return 2;
+}
+
+// @returns 1 if record was stored
+static int hci_dump_async_store_record(const uint8_t * header, uint16_t header_len, const uint8_t * packet, uint16_t len){
+    btstack_spsc_ring_buffer_span_t span;
+    uint32_t record_len = header_len + len;
+    if (btstack_spsc_ring_buffer_reserve(&async_ring_buffer, &span, 2 + record_len) < 2 + record_len) return 0;
+    uint8_t length_prefix[2];
+    little_endian_store_16(length_prefix, 0, record_len);
+    hci_dump_async_span_copy_to(&span, 0, length_prefix, 2);
+    hci_dump_async_span_copy_to(&span, 2, header, header_len);
+    hci_dump_async_span_copy_to(&span, 2 + header_len, packet, len);
+    btstack_spsc_ring_buffer_commit(&async_ring_buffer, 2 + record_len);
+    return 1;
+}
+
+static void hci_dump_async_packet(uint8_t packet_type, uint8_t in, uint8_t * packet, uint16_t len, struct timeval * curr_time){
+    uint8_t header[PKTLOG_HDR_SIZE];
+
+    // report packets dropped while ring buffer was full
+    if (async_dropped_unreported){
+        char message[48];
+        int message_len = snprintf(message, sizeof(message), "hci_dump: %u packets dropped", (unsigned int) async_dropped_unreported);
+        int header_len = hci_dump_store_header(header, LOG_MESSAGE_PACKET, 0, message_len, curr_time);
+        if (!hci_dump_async_store_record(header, header_len, (const uint8_t *) message, message_len)){
+            async_dropped_unreported++;
+            dropped_packets++;
+            return;
+        }
+        async_dropped_unreported = 0;
+    }
+
+    int header_len = hci_dump_store_header(header, packet_type, in, len, curr_time);
+    if (!header_len) return;
+    if (!hci_dump_async_store_record(header, header_len, packet, len)){
+        async_dropped_unreported++;
+        dropped_packets++;
+    }
+}
+
+// write all iovecs, continues after partial writes, @returns 0 or errno
+static int hci_dump_async_writev(int file, struct iovec * iov, int iov_count){
+    while (iov_count){
+        ssize_t written = writev(file, iov, iov_count);
+        if (written < 0){
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (written == 0) return EIO;
+        // skip written iovecs, advance into partially written one
+        while (iov_count && ((size_t) written >= iov->iov_len)){
+            written -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count){
+            iov->iov_base = (uint8_t *) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return 0;
+}
+
+static void * hci_dump_async_writer(void * context){
+    UNUSED(context);
+    struct iovec iov[HCI_DUMP_ASYNC_MAX_IOV];
+    btstack_spsc_ring_buffer_span_t span;
+    while (1){
+        // read flag before ring buffer, all records are committed before flag is cleared
+        int active = ASYNC_ACTIVE_LOAD();
+        uint32_t bytes_available = btstack_spsc_ring_buffer_peek(&async_ring_buffer, &span, 0xffffffff);
+        if (!bytes_available){
+            if (!active) break;
+            usleep(HCI_DUMP_ASYNC_POLL_MS * 1000);
+            continue;
+        }
+        // collect complete records, stop at rotation request
+        int iov_count = 0;
+        int rotate = 0;
+        uint32_t offset = 0;
+        while ((offset < bytes_available) && (iov_count + 2 <= HCI_DUMP_ASYNC_MAX_IOV)){
+            uint16_t record_len = hci_dump_async_span_get_byte(&span, offset) | (hci_dump_async_span_get_byte(&span, offset + 1) << 8);
+            offset += 2;
+            if (record_len == 0){
+                rotate = 1;
+                break;
+            }
+            iov_count += hci_dump_async_span_to_iov(&span, offset, record_len, &iov[iov_count]);
+            offset += record_len;
+        }
+        if (iov_count){
+            // records are consumed even if write fails to not block the run loop, failures are reported on close
+            int err = hci_dump_async_writev(async_dump_file, iov, iov_count);
+            if (err){
+                async_write_failures++;
+                async_write_errno = err;
+            }
+        }
+        btstack_spsc_ring_buffer_consume(&async_ring_buffer, offset);
+        if (rotate){
+            async_dump_file = hci_dump_rotate_file(async_dump_file);
+        }
+    }
+    return NULL;
+}
+
+void hci_dump_open_async(const char *filename, hci_dump_format_t format, uint8_t * storage, uint32_t storage_size){
+    if (format == HCI_DUMP_STDOUT){
+        hci_dump_open(filename, format);
+        return;
+    }
+    hci_dump_open(filename, format);
+    if (dump_file < 0) return;
+    btstack_spsc_ring_buffer_init(&async_ring_buffer, storage, storage_size);
+    async_dump_file = dump_file;
+    async_dropped_unreported = 0;
+    async_write_failures = 0;
+    async_write_errno = 0;
+    async_active = 1;
+    if (pthread_create(&async_writer_thread, NULL, &hci_dump_async_writer, NULL)){
+        printf("hci_dump_open_async: failed to start writer thread\n");
+        async_active = 0;
+    }
+}
+#endif
+
 void hci_dump_open(const char *filename, hci_dump_format_t format){
 #ifdef HAVE_POSIX_FILE_IO
     dump_format = format;
+    nr_packets  = 0;
     if (dump_format == HCI_DUMP_STDOUT) {
         dump_file = fileno(stdout);
     } else {
 
-        int oflags = O_WRONLY | O_CREAT | O_TRUNC;
-#ifdef _WIN32
-        oflags |= O_BINARY;
-#endif
-
-        dump_file = open(filename, oflags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+        strncpy(dump_file_name, filename, sizeof(dump_file_name) - 1);
+        dump_file_name[sizeof(dump_file_name) - 1] = 0;
+        dump_file = hci_dump_open_file(dump_file_name);
         if (dump_file < 0){
             printf("hci_dump_open: failed to open file %s\n", filename);
         }
@@ -131,8 +427,57 @@ void hci_dump_open(const char *filename, hci_dump_format_t format){
 void hci_dump_set_max_packets(int packets){
     max_nr_packets = packets;
 }
+
+void hci_dump_set_max_files(int files){
+    max_nr_files = files;
+}
 #endif
 
+void hci_dump_set_packet_filter(uint8_t packet_type, hci_dump_packet_filter_t filter, uint16_t sample_rate){
+    if (packet_type >= HCI_DUMP_NUM_FILTERED_TYPES) return;
+    packet_filter[packet_type]         = filter;
+    packet_sample_rate[packet_type]    = sample_rate;
+    packet_sample_counter[packet_type] = 0;
+}
+
+uint32_t hci_dump_get_dropped_packets(void){
+    return dropped_packets;
+}
+
+// @returns number of bytes to log
+static int hci_dump_apply_filter(uint8_t packet_type, uint16_t len){
+    if (packet_type >= HCI_DUMP_NUM_FILTERED_TYPES) return len;
+    
+    // only log every n-th packet
+    if (packet_sample_rate[packet_type] > 1){
+        int log_packet = packet_sample_counter[packet_type] == 0;
+        packet_sample_counter[packet_type]++;
+        if (packet_sample_counter[packet_type] >= packet_sample_rate[packet_type]){
+            packet_sample_counter[packet_type] = 0;
+        }
+        if (!log_packet) return -1;
+    }
+
+    switch (packet_filter[packet_type]){
+        case HCI_DUMP_PACKET_FILTER_NONE:
+            return -1;
+        case HCI_DUMP_PACKET_FILTER_HEADER:
+            switch (packet_type){
+                case HCI_COMMAND_DATA_PACKET:
+                case HCI_SCO_DATA_PACKET:
+                    return btstack_min(len, 3);
+                case HCI_ACL_DATA_PACKET:
+                    return btstack_min(len, 4);
+                case HCI_EVENT_PACKET:
+                    return btstack_min(len, 2);
+                default:
+                    return len;
+            }
+        default:
+            return len;
+    }
+}
+
 static void printf_packet(uint8_t packet_type, uint8_t in, uint8_t * packet, uint16_t len){
     switch (packet_type){
         case HCI_COMMAND_DATA_PACKET:
@@ -197,13 +542,17 @@ void hci_dump_packet(uint8_t packet_type, uint8_t in, uint8_t *packet, uint16_t
 
     if (dump_file < 0) return; // not activated yet
 
+    int log_len = hci_dump_apply_filter(packet_type, len);
+    if (log_len < 0) return;
+    len = log_len;
+
 #ifdef HAVE_POSIX_FILE_IO
 
     // don't grow bigger than max_nr_packets
+    int rotate = 0;
     if (dump_format != HCI_DUMP_STDOUT && max_nr_packets > 0){
         if (nr_packets >= max_nr_packets){
-            lseek(dump_file, 0, SEEK_SET);
-            ftruncate(dump_file, 0);
+            rotate = 1;
             nr_packets = 0;
         }
         nr_packets++;
@@ -213,6 +562,24 @@ void hci_dump_packet(uint8_t packet_type, uint8_t in, uint8_t *packet, uint16_t
     struct timeval curr_time;
     gettimeofday(&curr_time, NULL);
 
+#ifdef ENABLE_HCI_DUMP_ASYNC
+    if (async_active){
+        if (rotate){
+            // request rotation from writer thread, retry with next packet if ring buffer is full
+            static const uint8_t rotation_request[2] = { 0, 0 };
+            if (btstack_spsc_ring_buffer_write(&async_ring_buffer, rotation_request, 2) < 2){
+                nr_packets = max_nr_packets;
+            }
+        }
+        hci_dump_async_packet(packet_type, in, packet, len, &curr_time);
+        return;
+    }
+#endif
+
+    if (rotate){
+        dump_file = hci_dump_rotate_file(dump_file);
+    }
+
     switch (dump_format){
         case HCI_DUMP_STDOUT: {
             printf_timestamp();
@@ -221,50 +588,14 @@ void hci_dump_packet(uint8_t packet_type, uint8_t in, uint8_t *packet, uint16_t
         }
             
         case HCI_DUMP_BLUEZ:
-            little_endian_store_16( header_bluez, 0, 1 + len);
-            header_bluez[2] = in;
-            header_bluez[3] = 0;
-            little_endian_store_32( header_bluez, 4, (uint32_t) curr_time.tv_sec);
-            little_endian_store_32( header_bluez, 8,            curr_time.tv_usec);
-            header_bluez[12] = packet_type;
-            write (dump_file, header_bluez, HCIDUMP_HDR_SIZE);
-            write (dump_file, packet, len );
-            break;
-            
-        case HCI_DUMP_PACKETLOGGER:
-            big_endian_store_32( header_packetlogger, 0, PKTLOG_HDR_SIZE - 4 + len);
-            big_endian_store_32( header_packetlogger, 4,  (uint32_t) curr_time.tv_sec);
-            big_endian_store_32( header_packetlogger, 8, curr_time.tv_usec);
-            switch (packet_type){
-                case HCI_COMMAND_DATA_PACKET:
-                    header_packetlogger[12] = 0x00;
-                    break;
-                case HCI_ACL_DATA_PACKET:
-                    if (in) {
-                        header_packetlogger[12] = 0x03;
-                    } else {
-                        header_packetlogger[12] = 0x02;
-                    }
-                    break;
-                case HCI_SCO_DATA_PACKET:
-                    if (in) {
-                        header_packetlogger[12] = 0x09;
-                    } else {
-                        header_packetlogger[12] = 0x08;
-                    }
-                    break;
-                case HCI_EVENT_PACKET:
-                    header_packetlogger[12] = 0x01;
-                    break;
-                case LOG_MESSAGE_PACKET:
-                    header_packetlogger[12] = 0xfc;
-                    break;
-                default:
-                    return;
-            }
-            write (dump_file, &header_packetlogger, PKTLOG_HDR_SIZE);
+        case HCI_DUMP_PACKETLOGGER: {
+            uint8_t * header = (dump_format == HCI_DUMP_BLUEZ) ? header_bluez : header_packetlogger;
+            int header_len = hci_dump_store_header(header, packet_type, in, len, &curr_time);
+            if (!header_len) return;
+            write (dump_file, header, header_len);
             write (dump_file, packet, len );
             break;
+        }
             
         default:
             break;
@@ -320,6 +651,17 @@ void hci_dump_log_P(int log_level, PGM_P format, ...){
 #endif
 
 void hci_dump_close(void){
+#ifdef ENABLE_HCI_DUMP_ASYNC
+    if (async_active){
+        // writer thread drains ring buffer before it exits
+        ASYNC_ACTIVE_STORE(0);
+        pthread_join(async_writer_thread, NULL);
+        dump_file = async_dump_file;
+        if (async_write_failures){
+            printf("hci_dump_close: %u writes failed, last error: %s\n", (unsigned int) async_write_failures, strerror(async_write_errno));
+        }
+    }
+#endif
 #ifdef HAVE_POSIX_FILE_IO
     close(dump_file);
 #endif
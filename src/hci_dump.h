@@ -69,6 +69,12 @@ typedef enum {
     HCI_DUMP_STDOUT
 } hci_dump_format_t;
 
+typedef enum {
+    HCI_DUMP_PACKET_FILTER_FULL = 0,
+    HCI_DUMP_PACKET_FILTER_HEADER,
+    HCI_DUMP_PACKET_FILTER_NONE
+} hci_dump_packet_filter_t;
+
 /*
  * @brief 
  */
@@ -79,6 +85,37 @@ void hci_dump_open(const char *filename, hci_dump_format_t format);
  */
 void hci_dump_set_max_packets(int packets); // -1 for unlimited
 
+/*
+ * @brief Keep up to files log files when max packets is reached: <name>, <name>.1, ... Default: truncate file
+ * @param files
+ */
+void hci_dump_set_max_files(int files);
+
+/*
+ * @brief Open binary log written by background thread (ENABLE_HCI_DUMP_ASYNC). Packets are dropped if ring buffer is full
+ * @note  The ring buffer has a single producer: hci_dump_* and log_* must only be called from the run loop thread
+ *        until hci_dump_close. Failed writes are reported by hci_dump_close
+ * @param filename
+ * @param format HCI_DUMP_BLUEZ or HCI_DUMP_PACKETLOGGER
+ * @param storage for ring buffer
+ * @param storage_size in bytes, rounded down to power of two
+ */
+void hci_dump_open_async(const char *filename, hci_dump_format_t format, uint8_t * storage, uint32_t storage_size);
+
+/*
+ * @brief Log only header or no packets of given type, and/or only every n-th packet
+ * @param packet_type HCI_COMMAND_DATA_PACKET, HCI_ACL_DATA_PACKET, HCI_SCO_DATA_PACKET, or HCI_EVENT_PACKET
+ * @param filter
+ * @param sample_rate log every n-th packet, 0 or 1 for all
+ */
+void hci_dump_set_packet_filter(uint8_t packet_type, hci_dump_packet_filter_t filter, uint16_t sample_rate);
+
+/*
+ * @brief Get number of packets dropped because async ring buffer was full
+ * @returns number of dropped packets
+ */
+uint32_t hci_dump_get_dropped_packets(void);
+
 /*
  * @brief 
  */
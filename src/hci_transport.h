@@ -114,7 +114,8 @@ typedef struct {
 
 typedef enum {
     HCI_TRANSPORT_CONFIG_UART,
-    HCI_TRANSPORT_CONFIG_USB
+    HCI_TRANSPORT_CONFIG_USB,
+    HCI_TRANSPORT_CONFIG_REPLAY
 } hci_transport_config_type_t;
 
 typedef struct {
@@ -129,6 +130,20 @@ typedef struct {
     const char *device_name;
 } hci_transport_config_uart_t;
 
+typedef struct {
+    hci_transport_config_type_t type; // == HCI_TRANSPORT_CONFIG_REPLAY
+    const char * file_name;           // PacketLogger or BTSnoop file
+    int          realtime;            // 1 = deliver packets with recorded delays, 0 = as fast as possible
+} hci_transport_config_replay_t;
+
+typedef struct {
+    uint32_t packets_received;    // delivered to stack
+    uint32_t packets_sent;        // sent by stack
+    uint32_t packets_mismatched;  // sent by stack, different from recorded packet
+    uint32_t packets_unexpected;  // sent by stack after last recorded packet
+    uint32_t stalls;              // recorded packets not sent by stack within timeout
+} hci_transport_replay_stats_t;
+
 
 // inline various hci_transport_X.h files
 
@@ -171,6 +186,23 @@ const hci_transport_t * hci_transport_usb_instance(void);
  */
 void hci_transport_usb_set_path(int len, uint8_t * port_numbers);
 
+/*
+ * @brief Replay PacketLogger or BTSnoop file: received packets are delivered, sent packets are compared with capture
+ */
+const hci_transport_t * hci_transport_replay_instance(void);
+
+/*
+ * @brief Register handler called after all packets in capture have been processed
+ * @param handler
+ */
+void hci_transport_replay_register_done_handler(void (*handler)(void));
+
+/*
+ * @brief Get replay statistics
+ * @param stats
+ */
+void hci_transport_replay_get_stats(hci_transport_replay_stats_t * stats);
+
 /* API_END */
     
 #if defined __cplusplus
@@ -105,6 +105,7 @@ static inline l2cap_service_t * l2cap_le_get_service(uint16_t psm);
 #endif
 #ifdef L2CAP_USES_CHANNELS
 static void l2cap_dispatch_to_channel(l2cap_channel_t *channel, uint8_t type, uint8_t * data, uint16_t size);
+static void l2cap_dispatch_data_to_channel(l2cap_channel_t *channel, uint8_t * data, uint16_t size);
 static l2cap_channel_t * l2cap_get_channel_for_local_cid(uint16_t local_cid);
 static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t packet_handler, l2cap_channel_type_t channel_type, bd_addr_t address, bd_addr_type_t address_type, 
         uint16_t psm, uint16_t local_mtu, gap_security_level_t security_level);
@@ -682,7 +683,7 @@ static void l2cap_ertm_handle_in_sequence_sdu(l2cap_channel_t * l2cap_channel, l
             // assert total packet size <= our mtu
             if (size > l2cap_channel->local_mtu) break;
             // packet complete -> disapatch
-            l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, (uint8_t*) payload, size);
+            l2cap_dispatch_data_to_channel(l2cap_channel, (uint8_t*) payload, size);
             break;
         case L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU:
             // read SDU len
@@ -712,7 +713,7 @@ static void l2cap_ertm_handle_in_sequence_sdu(l2cap_channel_t * l2cap_channel, l
             // assert size of reassembled data matches announced sdu length
             if (l2cap_channel->reassembly_pos != l2cap_channel->reassembly_sdu_length) break;
             // packet complete -> disapatch
-            l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, l2cap_channel->reassembly_buffer, l2cap_channel->reassembly_pos);
+            l2cap_dispatch_data_to_channel(l2cap_channel, l2cap_channel->reassembly_buffer, l2cap_channel->reassembly_pos);
             l2cap_channel->reassembly_pos = 0;    
             break; 
     }
@@ -796,11 +797,17 @@ uint8_t *l2cap_get_outgoing_buffer(void){
 
 // only for L2CAP Basic Channels
 int l2cap_reserve_packet_buffer(void){
+#ifdef ENABLE_LATENCY_TRACE
+    btstack_latency_trace_tx_reserved();
+#endif
     return hci_reserve_packet_buffer();
 }
 
 // only for L2CAP Basic Channels
 void l2cap_release_packet_buffer(void){
+#ifdef ENABLE_LATENCY_TRACE
+    btstack_latency_trace_tx_released();
+#endif
     hci_release_packet_buffer();
 }
 
@@ -845,6 +852,9 @@ int l2cap_send_connectionless(hci_con_handle_t con_handle, uint16_t cid, uint8_t
     }
     
     hci_reserve_packet_buffer();
+#ifdef ENABLE_LATENCY_TRACE
+    btstack_latency_trace_tx_reserved();
+#endif
     uint8_t *acl_buffer = hci_get_outgoing_packet_buffer();
     
     memcpy(&acl_buffer[8], data, len);
@@ -867,6 +877,32 @@ static void l2cap_dispatch_to_channel(l2cap_channel_t *channel, uint8_t type, ui
     (* (channel->packet_handler))(type, channel->local_cid, data, size);
 }
 
+#ifdef ENABLE_LATENCY_TRACE
+static btstack_latency_trace_segment_t l2cap_latency_trace_segment_for_channel(l2cap_channel_t * channel){
+    if (channel->channel_type != L2CAP_CHANNEL_TYPE_CLASSIC) return BTSTACK_LATENCY_TRACE_RX_OTHER;
+    switch (channel->psm){
+        case PSM_RFCOMM:
+            return BTSTACK_LATENCY_TRACE_RX_RFCOMM;
+        case BLUETOOTH_PROTOCOL_AVDTP:
+            return BTSTACK_LATENCY_TRACE_RX_AVDTP;
+        default:
+            return BTSTACK_LATENCY_TRACE_RX_OTHER;
+    }
+}
+#endif
+
+static void l2cap_dispatch_data_to_channel(l2cap_channel_t *channel, uint8_t * data, uint16_t size){
+#ifdef ENABLE_LATENCY_TRACE
+    // channel might get freed by packet handler
+    btstack_latency_trace_segment_t segment = l2cap_latency_trace_segment_for_channel(channel);
+    btstack_latency_trace_rx_dispatch();
+#endif
+    l2cap_dispatch_to_channel(channel, L2CAP_DATA_PACKET, data, size);
+#ifdef ENABLE_LATENCY_TRACE
+    btstack_latency_trace_rx_handled(segment);
+#endif
+}
+
 static void l2cap_emit_simple_event_with_cid(l2cap_channel_t * channel, uint8_t event_code){
     uint8_t event[4];
     event[0] = event_code;
@@ -1172,6 +1208,9 @@ int l2cap_send(uint16_t local_cid, uint8_t *data, uint16_t len){
     }
 
     hci_reserve_packet_buffer();
+#ifdef ENABLE_LATENCY_TRACE
+    btstack_latency_trace_tx_reserved();
+#endif
     uint8_t *acl_buffer = hci_get_outgoing_packet_buffer();
     memcpy(&acl_buffer[8], data, len);
     return l2cap_send_prepared(local_cid, len);
@@ -3059,7 +3098,13 @@ static void l2cap_acl_classic_handler(hci_con_handle_t handle, uint8_t *packet,
             l2cap_fixed_channel = l2cap_fixed_channel_for_channel_id(L2CAP_CID_CONNECTIONLESS_CHANNEL);
             if (!l2cap_fixed_channel) break;
             if (!l2cap_fixed_channel->packet_handler) break;
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_rx_dispatch();
+#endif
             (*l2cap_fixed_channel->packet_handler)(UCD_DATA_PACKET, handle, &packet[COMPLETE_L2CAP_HEADER], size-COMPLETE_L2CAP_HEADER);
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_rx_handled(BTSTACK_LATENCY_TRACE_RX_OTHER);
+#endif
             break;
 
         default: 
@@ -3237,7 +3282,7 @@ static void l2cap_acl_classic_handler(hci_con_handle_t handle, uint8_t *packet,
                     break;
                 }
 #endif                
-                l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, &packet[COMPLETE_L2CAP_HEADER], size-COMPLETE_L2CAP_HEADER);
+                l2cap_dispatch_data_to_channel(l2cap_channel, &packet[COMPLETE_L2CAP_HEADER], size-COMPLETE_L2CAP_HEADER);
             }
             break;
     }
@@ -3274,14 +3319,26 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
             l2cap_fixed_channel = l2cap_fixed_channel_for_channel_id(L2CAP_CID_ATTRIBUTE_PROTOCOL);
             if (!l2cap_fixed_channel) break;
             if (!l2cap_fixed_channel->packet_handler) break;
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_rx_dispatch();
+#endif
             (*l2cap_fixed_channel->packet_handler)(ATT_DATA_PACKET, handle, &packet[COMPLETE_L2CAP_HEADER], size-COMPLETE_L2CAP_HEADER);
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_rx_handled(BTSTACK_LATENCY_TRACE_RX_ATT);
+#endif
             break;
 
         case L2CAP_CID_SECURITY_MANAGER_PROTOCOL:
             l2cap_fixed_channel = l2cap_fixed_channel_for_channel_id(L2CAP_CID_SECURITY_MANAGER_PROTOCOL);
             if (!l2cap_fixed_channel) break;
             if (!l2cap_fixed_channel->packet_handler) break;
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_rx_dispatch();
+#endif
             (*l2cap_fixed_channel->packet_handler)(SM_DATA_PACKET, handle, &packet[COMPLETE_L2CAP_HEADER], size-COMPLETE_L2CAP_HEADER);
+#ifdef ENABLE_LATENCY_TRACE
+            btstack_latency_trace_rx_handled(BTSTACK_LATENCY_TRACE_RX_SM);
+#endif
             break;
 
         default:
@@ -3320,7 +3377,7 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
                 // done?
                 log_debug("le packet pos %u, len %u", l2cap_channel->receive_sdu_pos, l2cap_channel->receive_sdu_len);
                 if (l2cap_channel->receive_sdu_pos >= l2cap_channel->receive_sdu_len){
-                    l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, l2cap_channel->receive_sdu_buffer, l2cap_channel->receive_sdu_len);
+                    l2cap_dispatch_data_to_channel(l2cap_channel, l2cap_channel->receive_sdu_buffer, l2cap_channel->receive_sdu_len);
                     l2cap_channel->receive_sdu_len = 0;
                 }
             } else {
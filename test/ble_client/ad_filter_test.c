@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// test advertising report filter
+//
+// *****************************************************************************
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "bluetooth_data_types.h"
+#include "btstack_event.h"
+#include "hci.h"
+#include "gap.h"
+#include "ad_filter.h"
+
+void le_handle_advertisement_report(uint8_t *packet, uint16_t size);
+
+static bd_addr_t addr_1 = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+static bd_addr_t addr_2 = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x77 };
+
+// flags, incomplete list of 16-bit UUIDs 0x180d + 0x180f
+static const uint8_t ad_heart_rate[] = { 0x02, 0x01, 0x06, 0x05, 0x02, 0x0d, 0x18, 0x0f, 0x18 };
+// flags, manufacturer specific data: company 0x004c, 0x02, 0x15, ...
+static const uint8_t ad_beacon[] = { 0x02, 0x01, 0x06, 0x07, 0xff, 0x4c, 0x00, 0x02, 0x15, 0xaa, 0xbb };
+// complete list of 128-bit UUIDs
+static const uint8_t ad_uuid128[] = { 0x11, 0x07,
+    0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x0d, 0x18, 0x00, 0x00 };
+static const uint8_t uuid128_heart_rate[] = {
+    0x00, 0x00, 0x18, 0x0d, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb };
+// truncated AD structure
+static const uint8_t ad_truncated[] = { 0x02, 0x01, 0x06, 0x05, 0x02, 0x0d };
+
+static ad_filter_t           filter;
+static ad_filter_address_t   filter_addresses[4];
+static ad_filter_matcher_t   filter_matchers[4];
+static ad_filter_duplicate_t filter_duplicates[8];
+
+static int reports_received;
+static bd_addr_t report_address;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+static void (*transport_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (hci_event_packet_get_type(packet) != GAP_EVENT_ADVERTISING_REPORT) return;
+    gap_event_advertising_report_get_address(packet, report_address);
+    reports_received++;
+}
+
+static void transport_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    transport_packet_handler = handler;
+}
+
+// keep hci_run from sending commands
+static int transport_can_send_packet_now(uint8_t packet_type){
+    (void) packet_type;
+    return 0;
+}
+
+static hci_transport_t dummy_transport = {
+  /*  .transport.name                          = */  "DUMMY",
+  /*  .transport.init                          = */  NULL,
+  /*  .transport.open                          = */  NULL,
+  /*  .transport.close                         = */  NULL,
+  /*  .transport.register_packet_handler       = */  &transport_register_packet_handler,
+  /*  .transport.can_send_packet_now           = */  &transport_can_send_packet_now,
+  /*  .transport.send_packet                   = */  NULL,
+  /*  .transport.set_baudrate                  = */  NULL,
+};
+
+static int match(const bd_addr_t addr, int8_t rssi, const uint8_t * data, uint8_t len, uint32_t now_ms){
+    return ad_filter_match(&filter, BD_ADDR_TYPE_LE_PUBLIC, addr, rssi, len, data, now_ms);
+}
+
+static uint16_t build_report(uint8_t * packet, const bd_addr_t addr, int8_t rssi, const uint8_t * data, uint8_t len){
+    uint16_t pos = 0;
+    packet[pos++] = HCI_EVENT_LE_META;
+    pos++;
+    packet[pos++] = HCI_SUBEVENT_LE_ADVERTISING_REPORT;
+    packet[pos++] = 1;  // num reports
+    packet[pos++] = 0;  // ADV_IND
+    packet[pos++] = BD_ADDR_TYPE_LE_PUBLIC;
+    reverse_bd_addr(addr, &packet[pos]);
+    pos += 6;
+    packet[pos++] = len;
+    memcpy(&packet[pos], data, len);
+    pos += len;
+    packet[pos++] = (uint8_t) rssi;
+    packet[1] = pos - 2;
+    return pos;
+}
+
+TEST_GROUP(ADFilter){
+    void setup(void){
+        ad_filter_init(&filter, filter_addresses, 4, filter_matchers, 4);
+    }
+};
+
+TEST(ADFilter, EmptyFilterMatchesAll){
+    CHECK_EQUAL(1, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(1, match(addr_2, -90, ad_beacon, sizeof(ad_beacon), 0));
+    CHECK_EQUAL(2, filter.reports_matched);
+}
+
+TEST(ADFilter, RssiThreshold){
+    ad_filter_set_rssi_threshold(&filter, -70);
+    CHECK_EQUAL(0, match(addr_1, -71, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(1, match(addr_1, -70, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(1, filter.reports_dropped_rssi);
+}
+
+TEST(ADFilter, AddressAllowList){
+    bd_addr_t addr_3 = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    CHECK_EQUAL(0, ad_filter_add_address(&filter, BD_ADDR_TYPE_LE_PUBLIC, addr_2));
+    CHECK_EQUAL(0, ad_filter_add_address(&filter, BD_ADDR_TYPE_LE_RANDOM, addr_1));
+    CHECK_EQUAL(0, ad_filter_add_address(&filter, BD_ADDR_TYPE_LE_PUBLIC, addr_3));
+    CHECK_EQUAL(1, match(addr_2, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(1, match(addr_3, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    // addr_1 only allowed as random address
+    CHECK_EQUAL(0, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(1, ad_filter_match(&filter, BD_ADDR_TYPE_LE_RANDOM, addr_1, -90, sizeof(ad_heart_rate), ad_heart_rate, 0));
+    CHECK_EQUAL(1, filter.reports_dropped_address);
+}
+
+TEST(ADFilter, AddressAllowListFull){
+    int i;
+    for (i = 0; i < 4; i++){
+        CHECK_EQUAL(0, ad_filter_add_address(&filter, BD_ADDR_TYPE_LE_PUBLIC, addr_1));
+    }
+    CHECK_EQUAL(BTSTACK_MEMORY_ALLOC_FAILED, ad_filter_add_address(&filter, BD_ADDR_TYPE_LE_PUBLIC, addr_1));
+}
+
+TEST(ADFilter, Uuid16InIncompleteList){
+    CHECK_EQUAL(0, ad_filter_add_uuid16(&filter, 0x180f));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(0, match(addr_1, -90, ad_beacon, sizeof(ad_beacon), 0));
+    CHECK_EQUAL(1, filter.reports_dropped_data);
+}
+
+TEST(ADFilter, Uuid128){
+    CHECK_EQUAL(0, ad_filter_add_uuid128(&filter, uuid128_heart_rate));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_uuid128, sizeof(ad_uuid128), 0));
+    CHECK_EQUAL(0, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+}
+
+TEST(ADFilter, ManufacturerPrefix){
+    static const uint8_t ibeacon_prefix[] = { 0x02, 0x15 };
+    static const uint8_t other_prefix[]   = { 0x02, 0x16 };
+    CHECK_EQUAL(0, ad_filter_add_manufacturer_prefix(&filter, 0x004c, other_prefix, sizeof(other_prefix)));
+    CHECK_EQUAL(0, match(addr_1, -90, ad_beacon, sizeof(ad_beacon), 0));
+    CHECK_EQUAL(0, ad_filter_add_manufacturer_prefix(&filter, 0x004c, ibeacon_prefix, sizeof(ibeacon_prefix)));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_beacon, sizeof(ad_beacon), 0));
+    CHECK_EQUAL(ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS, ad_filter_add_manufacturer_prefix(&filter, 0x004c, ad_uuid128, 15));
+}
+
+TEST(ADFilter, AdType){
+    // matcher for incomplete list does not match complete list
+    CHECK_EQUAL(0, ad_filter_add_ad_type(&filter, BLUETOOTH_DATA_TYPE_INCOMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS));
+    CHECK_EQUAL(0, ad_filter_add_ad_type(&filter, BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_128_BIT_SERVICE_CLASS_UUIDS));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 0));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_uuid128, sizeof(ad_uuid128), 0));
+    CHECK_EQUAL(0, match(addr_1, -90, ad_beacon, sizeof(ad_beacon), 0));
+}
+
+TEST(ADFilter, TruncatedData){
+    CHECK_EQUAL(0, ad_filter_add_uuid16(&filter, 0x180d));
+    CHECK_EQUAL(0, match(addr_1, -90, ad_truncated, sizeof(ad_truncated), 0));
+}
+
+TEST(ADFilter, DuplicateSuppression){
+    ad_filter_set_duplicate_suppression(&filter, filter_duplicates, 8, 1000);
+    CHECK_EQUAL(1, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 100));
+    CHECK_EQUAL(0, match(addr_1, -80, ad_heart_rate, sizeof(ad_heart_rate), 200));
+    // different address or data is reported
+    CHECK_EQUAL(1, match(addr_2, -90, ad_heart_rate, sizeof(ad_heart_rate), 300));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_beacon, sizeof(ad_beacon), 400));
+    // reported again after window
+    CHECK_EQUAL(0, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 1099));
+    CHECK_EQUAL(1, match(addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate), 1100));
+    CHECK_EQUAL(2, filter.reports_dropped_duplicate);
+    ad_filter_reset_counters(&filter);
+    CHECK_EQUAL(0, filter.reports_matched);
+    CHECK_EQUAL(0, filter.reports_dropped_duplicate);
+}
+
+TEST_GROUP(ADFilterHCI){
+    void setup(void){
+        ad_filter_init(&filter, filter_addresses, 4, filter_matchers, 4);
+        hci_init(&dummy_transport, NULL);
+        hci_event_callback_registration.callback = &packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+        reports_received = 0;
+    }
+    void teardown(void){
+        hci_remove_event_handler(&hci_event_callback_registration);
+    }
+};
+
+TEST(ADFilterHCI, FilteredReportsNotEmitted){
+    uint8_t packet[64];
+    uint16_t size;
+
+    ad_filter_add_uuid16(&filter, 0x180d);
+    ad_filter_set_rssi_threshold(&filter, -80);
+    gap_set_advertising_report_filter(&filter);
+
+    size = build_report(packet, addr_1, -70, ad_heart_rate, sizeof(ad_heart_rate));
+    le_handle_advertisement_report(packet, size);
+    size = build_report(packet, addr_1, -70, ad_beacon, sizeof(ad_beacon));
+    le_handle_advertisement_report(packet, size);
+    size = build_report(packet, addr_1, -90, ad_heart_rate, sizeof(ad_heart_rate));
+    le_handle_advertisement_report(packet, size);
+    CHECK_EQUAL(1, reports_received);
+    CHECK_EQUAL(1, filter.reports_matched);
+    CHECK_EQUAL(1, filter.reports_dropped_data);
+    CHECK_EQUAL(1, filter.reports_dropped_rssi);
+
+    gap_set_advertising_report_filter(NULL);
+    le_handle_advertisement_report(packet, size);
+    CHECK_EQUAL(2, reports_received);
+}
+
+TEST(ADFilterHCI, AddressAllowListForTransportEvent){
+    uint8_t packet[64];
+    uint16_t size;
+
+    ad_filter_add_address(&filter, BD_ADDR_TYPE_LE_PUBLIC, addr_2);
+    gap_set_advertising_report_filter(&filter);
+    gap_start_scan();
+
+    // report from transport carries address in little endian
+    size = build_report(packet, addr_1, -70, ad_heart_rate, sizeof(ad_heart_rate));
+    (*transport_packet_handler)(HCI_EVENT_PACKET, packet, size);
+    CHECK_EQUAL(0, reports_received);
+    size = build_report(packet, addr_2, -70, ad_heart_rate, sizeof(ad_heart_rate));
+    (*transport_packet_handler)(HCI_EVENT_PACKET, packet, size);
+    CHECK_EQUAL(1, reports_received);
+    CHECK_EQUAL(0, memcmp(addr_2, report_address, 6));
+    CHECK_EQUAL(1, filter.reports_matched);
+    CHECK_EQUAL(1, filter.reports_dropped_address);
+
+    gap_stop_scan();
+    gap_set_advertising_report_filter(NULL);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+// *****************************************************************************
+//
+// Link Key DB TLV benchmark
+//
+// Stores NVM_NUM_LINK_KEYS link keys in btstack_tlv_flash_bank and measures
+// index rebuild, lookup, and put with eviction. For comparison, lookups are also
+// done by probing all TLV tags as without the in-RAM index.
+//
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_tlv.h"
+#include "btstack_tlv_flash_bank.h"
+#include "btstack_util.h"
+#include "hci_dump.h"
+#include "hal_flash_bank_memory.h"
+#include "classic/btstack_link_key_db_tlv.h"
+
+#define NUM_LOOKUPS          1000
+#define NUM_LOOKUPS_PROBING  10
+#define NUM_EVICTIONS        100
+
+// TLV entry: 8 byte header + link_key_nvm_t
+#define ENTRY_SIZE 40
+static uint8_t hal_flash_bank_memory_storage[2 * (NVM_NUM_LINK_KEYS + NUM_EVICTIONS + 16) * ENTRY_SIZE];
+
+uint32_t btstack_run_loop_get_time_ms(void) { return 0; }
+
+static const btstack_tlv_t * btstack_tlv_impl;
+static btstack_tlv_flash_bank_t btstack_tlv_context;
+static uint32_t tlv_get_tag_calls;
+
+// forward to btstack_tlv_flash_bank and count get_tag calls
+static int counting_tlv_get_tag(void * context, uint32_t tag, uint8_t * buffer, uint32_t buffer_size){
+    tlv_get_tag_calls++;
+    return btstack_tlv_impl->get_tag(context, tag, buffer, buffer_size);
+}
+
+static int counting_tlv_store_tag(void * context, uint32_t tag, const uint8_t * data, uint32_t data_size){
+    return btstack_tlv_impl->store_tag(context, tag, data, data_size);
+}
+
+static void counting_tlv_delete_tag(void * context, uint32_t tag){
+    btstack_tlv_impl->delete_tag(context, tag);
+}
+
+static const btstack_tlv_t counting_tlv = {
+    &counting_tlv_get_tag,
+    &counting_tlv_store_tag,
+    &counting_tlv_delete_tag,
+};
+
+static double now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static void addr_for_index(uint32_t index, bd_addr_t addr){
+    // spread addresses over address space
+    uint32_t value = index * 2654435761u;
+    addr[0] = 0x00;
+    addr[1] = 0x1b;
+    big_endian_store_32(addr, 2, value);
+}
+
+// lookup without in-RAM index: probe all tags, see btstack_link_key_db_tlv.c
+static int probing_get_link_key(const bd_addr_t bd_addr, link_key_t link_key){
+    uint8_t entry[32];
+    uint32_t index;
+    for (index = 0; index < NVM_NUM_LINK_KEYS; index++){
+        uint32_t tag = index < 0x100 ? (('B' << 24) | ('T' << 16) | ('L' << 8) | index) : (('B' << 24) | ('l' << 16) | index);
+        int size = counting_tlv.get_tag(&btstack_tlv_context, tag, entry, sizeof(entry));
+        if (size == 0) continue;
+        if (memcmp(bd_addr, &entry[4], 6)) continue;
+        memcpy(link_key, &entry[10], 16);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void){
+    const hal_flash_bank_t * hal_flash_bank_impl;
+    hal_flash_bank_memory_t  hal_flash_bank_context;
+    const btstack_link_key_db_t * db;
+    link_key_t link_key;
+    link_key_type_t link_key_type;
+    bd_addr_t addr;
+    uint32_t i;
+    int errors = 0;
+    double start;
+
+    // log output would dominate
+    hci_dump_enable_log_level(LOG_LEVEL_DEBUG, 0);
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+
+    hal_flash_bank_impl = hal_flash_bank_memory_init_instance(&hal_flash_bank_context, hal_flash_bank_memory_storage, sizeof(hal_flash_bank_memory_storage));
+    hal_flash_bank_impl->erase(&hal_flash_bank_context, 0);
+    hal_flash_bank_impl->erase(&hal_flash_bank_context, 1);
+    btstack_tlv_impl = btstack_tlv_flash_bank_init_instance(&btstack_tlv_context, hal_flash_bank_impl, &hal_flash_bank_context);
+
+    printf("Link Key DB TLV with %u entries\n", NVM_NUM_LINK_KEYS);
+
+    // fill
+    db = btstack_link_key_db_tlv_get_instance(&counting_tlv, &btstack_tlv_context);
+    start = now_us();
+    for (i = 0; i < NVM_NUM_LINK_KEYS; i++){
+        addr_for_index(i, addr);
+        memset(link_key, 0, sizeof(link_key));
+        big_endian_store_32(link_key, 0, i);
+        db->put_link_key(addr, link_key, COMBINATION_KEY);
+    }
+    printf("Put (empty slot):        %10.2f us\n", (now_us() - start) / NVM_NUM_LINK_KEYS);
+
+    // startup
+    tlv_get_tag_calls = 0;
+    start = now_us();
+    db = btstack_link_key_db_tlv_get_instance(&counting_tlv, &btstack_tlv_context);
+    printf("Index rebuild:           %10.2f ms, %u TLV reads\n", (now_us() - start) / 1000.0, tlv_get_tag_calls);
+
+    // lookups
+    tlv_get_tag_calls = 0;
+    start = now_us();
+    for (i = 0; i < NUM_LOOKUPS; i++){
+        uint32_t index = (i * 7919) % NVM_NUM_LINK_KEYS;
+        addr_for_index(index, addr);
+        if (!db->get_link_key(addr, link_key, &link_key_type) || big_endian_read_32(link_key, 0) != index){
+            errors++;
+        }
+    }
+    printf("Get (hit):               %10.2f us, %5.2f TLV reads\n", (now_us() - start) / NUM_LOOKUPS, (double) tlv_get_tag_calls / NUM_LOOKUPS);
+
+    tlv_get_tag_calls = 0;
+    start = now_us();
+    for (i = 0; i < NUM_LOOKUPS; i++){
+        addr_for_index(NVM_NUM_LINK_KEYS + NUM_EVICTIONS + i, addr);
+        if (db->get_link_key(addr, link_key, &link_key_type)){
+            errors++;
+        }
+    }
+    printf("Get (miss):              %10.2f us, %5.2f TLV reads\n", (now_us() - start) / NUM_LOOKUPS, (double) tlv_get_tag_calls / NUM_LOOKUPS);
+
+    tlv_get_tag_calls = 0;
+    start = now_us();
+    for (i = 0; i < NUM_LOOKUPS_PROBING; i++){
+        uint32_t index = (i * 7919) % NVM_NUM_LINK_KEYS;
+        addr_for_index(index, addr);
+        if (!probing_get_link_key(addr, link_key) || big_endian_read_32(link_key, 0) != index){
+            errors++;
+        }
+    }
+    printf("Get (hit, probing tags): %10.2f us, %5.0f TLV reads\n", (now_us() - start) / NUM_LOOKUPS_PROBING, (double) tlv_get_tag_calls / NUM_LOOKUPS_PROBING);
+
+    // eviction: all entries but the first NUM_EVICTIONS have been used more recently
+    for (i = NUM_EVICTIONS; i < NVM_NUM_LINK_KEYS; i++){
+        addr_for_index(i, addr);
+        db->get_link_key(addr, link_key, &link_key_type);
+    }
+    start = now_us();
+    for (i = 0; i < NUM_EVICTIONS; i++){
+        addr_for_index(NVM_NUM_LINK_KEYS + i, addr);
+        memset(link_key, 0, sizeof(link_key));
+        db->put_link_key(addr, link_key, COMBINATION_KEY);
+    }
+    printf("Put (evict LRU):         %10.2f us\n", (now_us() - start) / NUM_EVICTIONS);
+    for (i = 0; i < NUM_EVICTIONS && i < NVM_NUM_LINK_KEYS; i++){
+        addr_for_index(i, addr);
+        if (db->get_link_key(addr, link_key, &link_key_type)){
+            errors++;
+        }
+    }
+    for (i = NUM_EVICTIONS; i < NVM_NUM_LINK_KEYS; i++){
+        addr_for_index(i, addr);
+        if (!db->get_link_key(addr, link_key, &link_key_type)){
+            errors++;
+        }
+    }
+
+    if (errors){
+        printf("%u errors\n", errors);
+    }
+    return errors ? 1 : 0;
+}
@@ -23,6 +23,8 @@
 #define ENABLE_LE_SIGNED_WRITE
 #define ENABLE_LE_PERIPHERAL
 #define ENABLE_LE_CENTRAL
+#define ENABLE_GATT_CLIENT_CACHE
+#define ENABLE_GATT_CLIENT_QUEUE
 #define ENABLE_SDP_EXTRA_QUERIES
 #define ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
 
@@ -32,6 +34,9 @@
 
 #define MAX_NR_LE_DEVICE_DB_ENTRIES 4
 
+#define GATT_CLIENT_CACHE_MAX_CHARACTERISTICS 32
+#define GATT_CLIENT_CACHE_MAX_DESCRIPTORS 32
+
 #define NVM_NUM_LINK_KEYS 2
 
 #endif
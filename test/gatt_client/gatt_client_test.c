@@ -21,6 +21,8 @@
 #include "hci_dump.h"
 #include "ble/gatt_client.h"
 #include "ble/att_db.h"
+#include "ble/le_device_db.h"
+#include "btstack_tlv.h"
 #include "profile.h"
 #include "expected_results.h"
 
@@ -73,6 +75,15 @@ static gatt_client_characteristic_descriptor_t descriptors[50];
 
 void mock_simulate_discover_primary_services_response(void);
 void mock_simulate_att_exchange_mtu_response(void);
+void mock_simulate_att_indication(uint16_t value_handle);
+void mock_set_le_device_index(int index);
+int  mock_get_att_pdus_sent(void);
+void mock_set_can_send_now(int enabled);
+void mock_fire_timer(void);
+int  mock_get_timers_started(void);
+int  mock_timer_active(void);
+void mock_set_delayed_responses(int enabled);
+int  mock_deliver_next(void);
 
 void CHECK_EQUAL_ARRAY(const uint8_t * expected, uint8_t * actual, int size){
 	for (int i=0; i<size; i++){
@@ -699,8 +710,377 @@ TEST(GATTClient, TestWriteReliableLongCharacteristicValue){
 	CHECK_EQUAL(gatt_query_complete, 1);
 }
 
+static int queue_order[8];
+static int queue_order_count;
+
+static void queue_record_complete(uint8_t * packet, int id){
+	if (packet[0] != GATT_EVENT_QUERY_COMPLETE) return;
+	CHECK_EQUAL(0, packet[4]);
+	queue_order[queue_order_count++] = id;
+}
+
+static void handle_queue_event_a(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+	queue_record_complete(packet, 'a');
+}
+
+static void handle_queue_event_b(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+	queue_record_complete(packet, 'b');
+}
+
+static void handle_queue_event_c(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+	queue_record_complete(packet, 'c');
+}
+
+TEST(GATTClient, TestOperationQueue){
+	reset_query_state();
+	status = gatt_client_discover_primary_services_by_uuid16(handle_ble_client_event, gatt_client_handle, service_uuid16);
+	CHECK_EQUAL(status, 0);
+	reset_query_state();
+	status = gatt_client_discover_characteristics_for_service_by_uuid16(handle_ble_client_event, gatt_client_handle, &services[0], 0xF10D);
+	CHECK_EQUAL(status, 0);
+	CHECK_EQUAL(1, result_counter);
+
+	// operations and Write Commands submitted at once while ATT cannot send
+	test = WRITE_CHARACTERISTIC_VALUE;
+	reset_query_state();
+	queue_order_count = 0;
+	mock_set_can_send_now(0);
+	int att_pdus_sent = mock_get_att_pdus_sent();
+	uint16_t value_handle = characteristics[0].value_handle;
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_queue_event_a, gatt_client_handle, value_handle));
+	CHECK_EQUAL(0, gatt_client_write_value_of_characteristic(handle_queue_event_b, gatt_client_handle, value_handle, short_value_length, (uint8_t*)short_value));
+	CHECK_EQUAL(0, gatt_client_discover_characteristic_descriptors(handle_queue_event_c, gatt_client_handle, &characteristics[0]));
+	for (int i=0;i<3;i++){
+		CHECK_EQUAL(0, gatt_client_write_value_of_characteristic_without_response(gatt_client_handle, value_handle, short_value_length, (uint8_t*)short_value));
+	}
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_queue_event_a, gatt_client_handle, value_handle));
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_queue_event_b, gatt_client_handle, value_handle));
+	CHECK_EQUAL(GATT_CLIENT_BUSY, gatt_client_read_value_of_characteristic_using_value_handle(handle_queue_event_c, gatt_client_handle, value_handle));
+	CHECK_EQUAL(att_pdus_sent, mock_get_att_pdus_sent());
+
+	// all operations complete in order without retries, Write Commands are sent in between
+	mock_set_can_send_now(1);
+	CHECK_EQUAL(5, queue_order_count);
+	CHECK_EQUAL('a', queue_order[0]);
+	CHECK_EQUAL('b', queue_order[1]);
+	CHECK_EQUAL('c', queue_order[2]);
+	CHECK_EQUAL('a', queue_order[3]);
+	CHECK_EQUAL('b', queue_order[4]);
+	CHECK_EQUAL(4, result_counter);
+	CHECK(gatt_client_is_ready(gatt_client_handle));
+}
+
+static uint8_t timeout_status[4];
+static int timeout_status_count;
+
+static void handle_timeout_event(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+	if (packet[0] != GATT_EVENT_QUERY_COMPLETE) return;
+	timeout_status[timeout_status_count++] = packet[4];
+}
+
+TEST(GATTClient, TestOperationQueueTimeout){
+	test = WRITE_CHARACTERISTIC_VALUE;
+	reset_query_state();
+	timeout_status_count = 0;
+	mock_set_can_send_now(0);
+	uint16_t value_handle = characteristics[0].value_handle;
+
+	// queued operations don't restart the ATT timer of the active one
+	int timers_started = mock_get_timers_started();
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_timeout_event, gatt_client_handle, value_handle));
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_timeout_event, gatt_client_handle, value_handle));
+	CHECK_EQUAL(0, gatt_client_write_value_of_characteristic(handle_timeout_event, gatt_client_handle, value_handle, short_value_length, (uint8_t*)short_value));
+	CHECK_EQUAL(timers_started + 1, mock_get_timers_started());
+
+	// ATT timeout completes active and queued operations
+	mock_fire_timer();
+	CHECK_EQUAL(3, timeout_status_count);
+	for (int i=0;i<3;i++){
+		CHECK_EQUAL(ATT_ERROR_TIMEOUT, timeout_status[i]);
+	}
+	CHECK(gatt_client_is_ready(gatt_client_handle));
+
+	mock_set_can_send_now(1);
+	CHECK_EQUAL(3, timeout_status_count);
+}
+
+TEST(GATTClient, TestOperationQueueSynchronousCompletion){
+	reset_query_state();
+	status = gatt_client_discover_primary_services_by_uuid16(handle_ble_client_event, gatt_client_handle, service_uuid16);
+	CHECK_EQUAL(status, 0);
+	reset_query_state();
+	status = gatt_client_discover_characteristics_for_service_by_uuid16(handle_ble_client_event, gatt_client_handle, &services[0], 0xF10D);
+	CHECK_EQUAL(status, 0);
+	CHECK_EQUAL(1, result_counter);
+
+	// descriptor discovery of characteristic without descriptors completes without ATT request
+	gatt_client_characteristic_t no_descriptors = characteristics[0];
+	no_descriptors.end_handle = no_descriptors.value_handle;
+	uint16_t value_handle = characteristics[0].value_handle;
+
+	// responses arrive later, queued operations are dispatched from the ATT packet handler
+	test = WRITE_CHARACTERISTIC_VALUE;
+	queue_order_count = 0;
+	mock_set_delayed_responses(1);
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_queue_event_a, gatt_client_handle, value_handle));
+	CHECK_EQUAL(0, gatt_client_discover_characteristic_descriptors(handle_queue_event_b, gatt_client_handle, &no_descriptors));
+	CHECK_EQUAL(0, gatt_client_read_value_of_characteristic_using_value_handle(handle_queue_event_c, gatt_client_handle, value_handle));
+	CHECK_EQUAL(0, gatt_client_discover_characteristic_descriptors(handle_queue_event_b, gatt_client_handle, &no_descriptors));
+	CHECK_EQUAL(0, queue_order_count);
+	while (mock_deliver_next());
+	mock_set_delayed_responses(0);
+
+	CHECK_EQUAL(4, queue_order_count);
+	CHECK_EQUAL('a', queue_order[0]);
+	CHECK_EQUAL('b', queue_order[1]);
+	CHECK_EQUAL('c', queue_order[2]);
+	CHECK_EQUAL('b', queue_order[3]);
+	CHECK(gatt_client_is_ready(gatt_client_handle));
+	CHECK(!mock_timer_active());
+}
+
+static int batched_values;
+static int batched_long_values;
+static int batched_complete;
+
+static void handle_batched_read_event(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+	switch (packet[0]){
+		case GATT_EVENT_CHARACTERISTIC_VALUE_QUERY_RESULT:
+			CHECK_EQUAL(short_value_length, little_endian_read_16(packet, 6));
+			CHECK_EQUAL_ARRAY((uint8_t*)short_value, &packet[8], short_value_length);
+			batched_values++;
+			break;
+		case GATT_EVENT_LONG_CHARACTERISTIC_VALUE_QUERY_RESULT:
+			batched_long_values++;
+			break;
+		case GATT_EVENT_QUERY_COMPLETE:
+			CHECK_EQUAL(0, packet[4]);
+			batched_complete++;
+			break;
+		default:
+			break;
+	}
+}
+
+static int read_values_batched(int num_values, uint16_t * value_handles, uint16_t * value_lengths){
+	batched_values = 0;
+	batched_long_values = 0;
+	batched_complete = 0;
+	int att_pdus_sent = mock_get_att_pdus_sent();
+	CHECK_EQUAL(0, gatt_client_read_values_of_characteristics_using_value_handles(handle_batched_read_event, gatt_client_handle, num_values, value_handles, value_lengths));
+	CHECK_EQUAL(1, batched_complete);
+	return mock_get_att_pdus_sent() - att_pdus_sent;
+}
+
+TEST(GATTClient, TestReadValuesBatched){
+	const uint16_t uuids[] = { 0xF100, 0xF101, 0xF10B, 0xF10D, 0xF10C, 0xF10E };
+	const int num_values = sizeof(uuids) / sizeof(uint16_t);
+	uint16_t value_handles[num_values];
+	uint16_t value_lengths[num_values];
+
+	reset_query_state();
+	status = gatt_client_discover_primary_services_by_uuid16(handle_ble_client_event, gatt_client_handle, service_uuid16);
+	CHECK_EQUAL(status, 0);
+	for (int i=0;i<num_values;i++){
+		reset_query_state();
+		status = gatt_client_discover_characteristics_for_service_by_uuid16(handle_ble_client_event, gatt_client_handle, &services[0], uuids[i]);
+		CHECK_EQUAL(status, 0);
+		CHECK_EQUAL(1, result_counter);
+		value_handles[i] = characteristics[0].value_handle;
+	}
+
+	// unknown lengths: one Read Request per value
+	test = READ_CHARACTERISTIC_VALUE;
+	memset(value_lengths, 0, sizeof(value_lengths));
+	CHECK_EQUAL(num_values, read_values_batched(num_values, value_handles, value_lengths));
+	CHECK_EQUAL(num_values, batched_values);
+
+	// known lengths: 4 values fit into a 23 byte MTU, so 6 values take 2 Read Multiple Requests
+	for (int i=0;i<num_values;i++){
+		value_lengths[i] = short_value_length;
+	}
+	CHECK_EQUAL(2, read_values_batched(num_values, value_handles, value_lengths));
+	CHECK_EQUAL(num_values, batched_values);
+
+	// wrong length: first batch is read again value by value
+	value_lengths[0] = short_value_length - 1;
+	CHECK_EQUAL(1 + 4 + 1, read_values_batched(num_values, value_handles, value_lengths));
+	CHECK_EQUAL(num_values, batched_values);
+
+	// values longer than MTU - 1 are read with Read Blob Requests
+	test = READ_LONG_CHARACTERISTIC_VALUE;
+	value_lengths[0] = long_value_length;
+	value_lengths[1] = long_value_length;
+	CHECK_EQUAL(4, read_values_batched(2, value_handles, value_lengths));
+	CHECK_EQUAL(4, batched_long_values);
+	CHECK(gatt_client_is_ready(gatt_client_handle));
+}
+
+// in-memory TLV for GATT Client Cache
+#define TLV_MEMORY_NUM_TAGS 4
+#define TLV_MEMORY_MAX_SIZE 2048
+static struct {
+	uint32_t tag;
+	uint32_t size;
+	uint8_t  data[TLV_MEMORY_MAX_SIZE];
+} tlv_memory_entries[TLV_MEMORY_NUM_TAGS];
+
+static int tlv_memory_find(uint32_t tag){
+	for (int i=0;i<TLV_MEMORY_NUM_TAGS;i++){
+		if (tlv_memory_entries[i].size && tlv_memory_entries[i].tag == tag) return i;
+	}
+	return -1;
+}
+
+static int tlv_memory_get_tag(void * context, uint32_t tag, uint8_t * buffer, uint32_t buffer_size){
+	int i = tlv_memory_find(tag);
+	if (i < 0) return 0;
+	uint32_t size = tlv_memory_entries[i].size;
+	if (size > buffer_size) size = buffer_size;
+	memcpy(buffer, tlv_memory_entries[i].data, size);
+	return size;
+}
+
+static int tlv_memory_store_tag(void * context, uint32_t tag, const uint8_t * data, uint32_t data_size){
+	if (data_size > TLV_MEMORY_MAX_SIZE) return 1;
+	int i = tlv_memory_find(tag);
+	if (i < 0) i = tlv_memory_find(0);
+	if (i < 0){
+		for (i=0;i<TLV_MEMORY_NUM_TAGS;i++){
+			if (tlv_memory_entries[i].size == 0) break;
+		}
+		if (i == TLV_MEMORY_NUM_TAGS) return 1;
+	}
+	tlv_memory_entries[i].tag  = tag;
+	tlv_memory_entries[i].size = data_size;
+	memcpy(tlv_memory_entries[i].data, data, data_size);
+	return 0;
+}
+
+static void tlv_memory_delete_tag(void * context, uint32_t tag){
+	int i = tlv_memory_find(tag);
+	if (i < 0) return;
+	tlv_memory_entries[i].size = 0;
+}
+
+static const btstack_tlv_t tlv_memory = {
+	&tlv_memory_get_tag,
+	&tlv_memory_store_tag,
+	&tlv_memory_delete_tag,
+};
+
+static uint16_t service_changed_value_handle;
+
+// results from cache are reported from the run loop
+static void wait_for_query_complete(void){
+	if (!gatt_query_complete) mock_fire_timer();
+	CHECK_EQUAL(1, gatt_query_complete);
+}
+
+// discover all services, characteristics of GATT and F000 service and descriptors of first F000 characteristic
+// @returns number of reported results
+static int discover_gatt_layout(void){
+	int results = 0;
+	gatt_client_service_t gatt_service;
+	gatt_client_service_t f000_service;
+
+	memset(&gatt_service, 0, sizeof(gatt_service));
+	memset(&f000_service, 0, sizeof(f000_service));
+	gatt_query_complete = 0;
+	result_index = 0;
+	CHECK_EQUAL(0, gatt_client_discover_primary_services(handle_ble_client_event, gatt_client_handle));
+	wait_for_query_complete();
+	verify_primary_services();
+	results += result_index;
+	for (int i=0;i<result_index;i++){
+		if (services[i].uuid16 == 0x1801) gatt_service = services[i];
+		if (services[i].uuid16 == 0xF000) f000_service = services[i];
+	}
+
+	gatt_query_complete = 0;
+	result_index = 0;
+	CHECK_EQUAL(0, gatt_client_discover_characteristics_for_service(handle_ble_client_event, gatt_client_handle, &gatt_service));
+	wait_for_query_complete();
+	CHECK_EQUAL(1, result_index);
+	CHECK_EQUAL(0x2A05, characteristics[0].uuid16);
+	service_changed_value_handle = characteristics[0].value_handle;
+	results += result_index;
+
+	gatt_query_complete = 0;
+	result_index = 0;
+	CHECK_EQUAL(0, gatt_client_discover_characteristics_for_service(handle_ble_client_event, gatt_client_handle, &f000_service));
+	wait_for_query_complete();
+	verify_charasteristics();
+	results += result_index;
+
+	gatt_query_complete = 0;
+	result_index = 0;
+	CHECK_EQUAL(0, gatt_client_discover_characteristic_descriptors(handle_ble_client_event, gatt_client_handle, &characteristics[0]));
+	wait_for_query_complete();
+	CHECK_EQUAL(3, result_index);
+	CHECK_EQUAL(0x2902, descriptors[0].uuid16);
+	results += result_index;
+
+	// matching characteristics by UUID are reported from cache, too
+	gatt_query_complete = 0;
+	result_index = 0;
+	CHECK_EQUAL(0, gatt_client_discover_characteristics_for_service_by_uuid16(handle_ble_client_event, gatt_client_handle, &f000_service, 0xF100));
+	wait_for_query_complete();
+	CHECK_EQUAL(1, result_index);
+	results += result_index;
+	return results;
+}
+
+TEST(GATTClient, TestDiscoveryCache){
+	bd_addr_t addr = { 0x00, 0x1b, 0xdc, 0x07, 0x32, 0xef };
+	sm_key_t irk;
+	memset(irk, 0, sizeof(irk));
+	le_device_db_init();
+	mock_set_le_device_index(le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr, irk));
+
+	// first discovery fills cache
+	int att_pdus_sent = mock_get_att_pdus_sent();
+	int results = discover_gatt_layout();
+	CHECK(mock_get_att_pdus_sent() > att_pdus_sent);
+
+	// repeated discovery is answered from cache, but not from within the call
+	gatt_query_complete = 0;
+	CHECK_EQUAL(0, gatt_client_discover_primary_services(handle_ble_client_event, gatt_client_handle));
+	CHECK_EQUAL(0, gatt_query_complete);
+	CHECK(!gatt_client_is_ready(gatt_client_handle));
+	wait_for_query_complete();
+	CHECK(gatt_client_is_ready(gatt_client_handle));
+	att_pdus_sent = mock_get_att_pdus_sent();
+	CHECK_EQUAL(results, discover_gatt_layout());
+	CHECK_EQUAL(att_pdus_sent, mock_get_att_pdus_sent());
+
+	// after restart, cache is loaded from TLV, only MTU Exchange is sent
+	gatt_client_init();
+	att_pdus_sent = mock_get_att_pdus_sent();
+	CHECK_EQUAL(results, discover_gatt_layout());
+	CHECK_EQUAL(att_pdus_sent + 1, mock_get_att_pdus_sent());
+
+	// Service Changed indication invalidates cache
+	mock_simulate_att_indication(service_changed_value_handle);
+	att_pdus_sent = mock_get_att_pdus_sent();
+	CHECK_EQUAL(results, discover_gatt_layout());
+	CHECK(mock_get_att_pdus_sent() > att_pdus_sent);
+
+	// cache invalidated before scheduled report, services are discovered instead
+	gatt_query_complete = 0;
+	result_index = 0;
+	CHECK_EQUAL(0, gatt_client_discover_primary_services(handle_ble_client_event, gatt_client_handle));
+	att_pdus_sent = mock_get_att_pdus_sent();
+	mock_simulate_att_indication(service_changed_value_handle);
+	wait_for_query_complete();
+	verify_primary_services();
+	CHECK(mock_get_att_pdus_sent() > att_pdus_sent);
+
+	mock_set_le_device_index(-1);
+}
 
 int main (int argc, const char * argv[]){
+	btstack_tlv_set_instance(&tlv_memory, NULL);
 	att_set_db(profile_data);
 	att_set_write_callback(&att_write_callback);
 	att_set_read_callback(&att_read_callback);
@@ -19,6 +19,13 @@ static const uint16_t max_mtu = 23;
 static uint8_t  l2cap_stack_buffer[HCI_INCOMING_PRE_BUFFER_SIZE + 8 + max_mtu];	// pre buffer + HCI Header + L2CAP header
 static uint16_t gatt_client_handle = 0x40;
 static hci_connection_t hci_connection;
+static int le_device_index = -1;
+static int att_pdus_sent;
+static int can_send_now = 1;
+static int can_send_now_requested;
+static int delayed_responses;
+static uint8_t  pending_response[max_mtu];
+static uint16_t pending_response_len;
 
 uint16_t get_gatt_client_handle(void){
 	return gatt_client_handle;
@@ -39,6 +46,51 @@ void mock_simulate_connected(void){
 	registered_hci_event_handler(HCI_EVENT_PACKET, 0, (uint8_t *)&packet, sizeof(packet));
 }
 
+void mock_simulate_att_indication(uint16_t value_handle){
+	uint8_t packet[] = {ATT_HANDLE_VALUE_INDICATION, (uint8_t) (value_handle & 0xff), (uint8_t) (value_handle >> 8), 0x01, 0x00, 0xff, 0xff};
+	att_packet_handler(ATT_DATA_PACKET, gatt_client_handle, (uint8_t *)&packet, sizeof(packet));
+}
+
+void mock_set_le_device_index(int index){
+	le_device_index = index;
+}
+
+void mock_set_can_send_now(int enabled){
+	can_send_now = enabled;
+	if (!can_send_now || !can_send_now_requested) return;
+	can_send_now_requested = 0;
+	uint8_t event[] = { L2CAP_EVENT_CAN_SEND_NOW, 2, 1, 0};
+	att_packet_handler(HCI_EVENT_PACKET, 0, (uint8_t*)event, sizeof(event));
+}
+
+// hold back ATT responses and can send now events until mock_deliver_next is called
+void mock_set_delayed_responses(int enabled){
+	delayed_responses = enabled;
+}
+
+// @returns 1 if ATT response or can send now event was delivered
+int mock_deliver_next(void){
+	if (pending_response_len){
+		uint8_t response[max_mtu];
+		uint16_t response_len = pending_response_len;
+		memcpy(response, pending_response, response_len);
+		pending_response_len = 0;
+		att_packet_handler(ATT_DATA_PACKET, gatt_client_handle, &response[0], response_len);
+		return 1;
+	}
+	if (can_send_now_requested && can_send_now){
+		can_send_now_requested = 0;
+		uint8_t event[] = { L2CAP_EVENT_CAN_SEND_NOW, 2, 1, 0};
+		att_packet_handler(HCI_EVENT_PACKET, 0, (uint8_t*)event, sizeof(event));
+		return 1;
+	}
+	return 0;
+}
+
+int mock_get_att_pdus_sent(void){
+	return att_pdus_sent;
+}
+
 void mock_simulate_scan_response(void){
 	uint8_t packet[] = {0xE2, 0x13, 0xE2, 0x01, 0x34, 0xB1, 0xF7, 0xD1, 0x77, 0x9B, 0xCC, 0x09, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
 	registered_hci_event_handler(HCI_EVENT_PACKET, 0, (uint8_t *)&packet, sizeof(packet));
@@ -100,10 +152,14 @@ int l2cap_reserve_packet_buffer(void){
 }
 
 int l2cap_can_send_fixed_channel_packet_now(uint16_t handle, uint16_t channel_id){
-	return 1;
+	return can_send_now;
 }
 
 void l2cap_request_can_send_fix_channel_now_event(uint16_t handle, uint16_t channel_id){
+	if (!can_send_now || delayed_responses){
+		can_send_now_requested = 1;
+		return;
+	}
 	uint8_t event[] = { L2CAP_EVENT_CAN_SEND_NOW, 2, 1, 0};
 	att_packet_handler(HCI_EVENT_PACKET, 0, (uint8_t*)event, sizeof(event));
 }
@@ -111,8 +167,14 @@ void l2cap_request_can_send_fix_channel_now_event(uint16_t handle, uint16_t chan
 int l2cap_send_prepared_connectionless(uint16_t handle, uint16_t cid, uint16_t len){
 	att_connection_t att_connection;
 	att_init_connection(&att_connection);
+	att_pdus_sent++;
 	uint8_t response[max_mtu];
 	uint16_t response_len = att_handle_request(&att_connection, l2cap_get_outgoing_buffer(), len, &response[0]);
+	if (response_len && delayed_responses){
+		memcpy(pending_response, response, response_len);
+		pending_response_len = response_len;
+		return 0;
+	}
 	if (response_len){
 		att_packet_handler(ATT_DATA_PACKET, gatt_client_handle, &response[0], response_len);
 	}
@@ -126,7 +188,25 @@ void sm_cmac_signed_write_start(const sm_key_t key, uint8_t opcode, uint16_t att
 	//sm_notify_client(SM_EVENT_IDENTITY_RESOLVING_SUCCEEDED, sm_central_device_addr_type, sm_central_device_address, 0, sm_central_device_matched);      
 }
 int sm_le_device_index(uint16_t handle ){
-	return -1;
+	return le_device_index;
+}
+
+static btstack_timer_source_t * active_timer;
+static int timers_started;
+
+void mock_fire_timer(void){
+	btstack_timer_source_t * timer = active_timer;
+	if (!timer) return;
+	active_timer = NULL;
+	timer->process(timer);
+}
+
+int mock_get_timers_started(void){
+	return timers_started;
+}
+
+int mock_timer_active(void){
+	return active_timer != NULL;
 }
 
 void btstack_run_loop_set_timer(btstack_timer_source_t *a, uint32_t timeout_in_ms){
@@ -134,13 +214,19 @@ void btstack_run_loop_set_timer(btstack_timer_source_t *a, uint32_t timeout_in_m
 
 // Set callback that will be executed when timer expires.
 void btstack_run_loop_set_timer_handler(btstack_timer_source_t *ts, void (*process)(btstack_timer_source_t *_ts)){
+	ts->process = process;
 }
 
 // Add/Remove timer source.
 void btstack_run_loop_add_timer(btstack_timer_source_t *timer){
+	active_timer = timer;
+	timers_started++;
 }
 
 int  btstack_run_loop_remove_timer(btstack_timer_source_t *timer){
+	if (active_timer == timer){
+		active_timer = NULL;
+	}
 	return 1;
 }
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hci_cmd_encoder_benchmark.c"
+
+/*
+ * hci_cmd_encoder_benchmark.c
+ *
+ * Compares per-command encode cost of hci_cmd_create_from_template, which interprets the format string
+ * and fetches varargs, with the typed encoders from hci_cmd_encoder.h generated by
+ * tool/btstack_hci_cmd_encoder_generator.py. Fails if both produce different packets.
+ *
+ * Usage: ./hci_cmd_encoder_benchmark [iterations]
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "hci_cmd.h"
+#include "hci_cmd_encoder.h"
+
+static uint8_t template_buffer[300];
+static uint8_t encoder_buffer[300];
+
+static uint32_t num_iterations;
+static uint32_t checksum;
+static int num_mismatches;
+
+static bd_addr_t address = { 0x00, 0x1b, 0xdc, 0x07, 0x32, 0xef };
+static uint8_t adv_data[31] = { 0x02, 0x01, 0x06, 0x0b, 0x09, 'L', 'E', ' ', 'S', 't', 'r', 'e', 'a', 'm', 'e', 'r' };
+static const char * local_name = "BTstack 00:00:00:00:00:00";
+
+static double time_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// same call path as hci_send_cmd
+static uint16_t template_create(const hci_cmd_t * cmd, ...){
+    va_list argptr;
+    va_start(argptr, cmd);
+    uint16_t size = hci_cmd_create_from_template(template_buffer, cmd, argptr);
+    va_end(argptr);
+    return size;
+}
+
+static uint16_t template_le_set_scan_enable(uint32_t i){
+    return template_create(&hci_le_set_scan_enable, i & 1, 0);
+}
+static uint16_t encoder_le_set_scan_enable(uint32_t i){
+    return hci_cmd_encode_le_set_scan_enable(encoder_buffer, i & 1, 0);
+}
+
+static uint16_t template_le_connection_update(uint32_t i){
+    return template_create(&hci_le_connection_update, 0x0040, 6 + (i & 7), 24, 0, 500, 0x0000, 0xffff);
+}
+static uint16_t encoder_le_connection_update(uint32_t i){
+    return hci_cmd_encode_le_connection_update(encoder_buffer, 0x0040, 6 + (i & 7), 24, 0, 500, 0x0000, 0xffff);
+}
+
+static uint16_t template_le_set_advertising_parameters(uint32_t i){
+    return template_create(&hci_le_set_advertising_parameters, 0x30 + (i & 7), 0x30, 0, 0, 0, address, 0x07, 0);
+}
+static uint16_t encoder_le_set_advertising_parameters(uint32_t i){
+    return hci_cmd_encode_le_set_advertising_parameters(encoder_buffer, 0x30 + (i & 7), 0x30, 0, 0, 0, address, 0x07, 0);
+}
+
+static uint16_t template_le_set_advertising_data(uint32_t i){
+    return template_create(&hci_le_set_advertising_data, 16 + (i & 7), adv_data);
+}
+static uint16_t encoder_le_set_advertising_data(uint32_t i){
+    return hci_cmd_encode_le_set_advertising_data(encoder_buffer, 16 + (i & 7), adv_data);
+}
+
+static uint16_t template_disconnect(uint32_t i){
+    return template_create(&hci_disconnect, 0x0040 + (i & 7), 0x13);
+}
+static uint16_t encoder_disconnect(uint32_t i){
+    return hci_cmd_encode_disconnect(encoder_buffer, 0x0040 + (i & 7), 0x13);
+}
+
+static uint16_t template_write_local_name(uint32_t i){
+    (void) i;
+    return template_create(&hci_write_local_name, local_name);
+}
+static uint16_t encoder_write_local_name(uint32_t i){
+    (void) i;
+    return hci_cmd_encode_write_local_name(encoder_buffer, local_name);
+}
+
+static double measure(uint16_t (*encode)(uint32_t i), const uint8_t * buffer){
+    double start = time_ns();
+    uint32_t i;
+    for (i=0;i<num_iterations;i++){
+        uint16_t size = (*encode)(i);
+        checksum += buffer[size - 1];
+    }
+    return (time_ns() - start) / num_iterations;
+}
+
+static void benchmark(const char * name, uint16_t (*template_encode)(uint32_t i), uint16_t (*encoder_encode)(uint32_t i)){
+    // verify
+    uint32_t i;
+    for (i=0;i<8;i++){
+        uint16_t template_size = (*template_encode)(i);
+        uint16_t encoder_size  = (*encoder_encode)(i);
+        if (template_size != encoder_size || memcmp(template_buffer, encoder_buffer, template_size) != 0){
+            printf("%s: encoded packets differ\n", name);
+            num_mismatches++;
+            return;
+        }
+    }
+    double template_ns = measure(template_encode, template_buffer);
+    double encoder_ns  = measure(encoder_encode, encoder_buffer);
+    printf("%-30s | %8.1f ns | %8.1f ns | %5.1fx\n", name, template_ns, encoder_ns, template_ns / encoder_ns);
+}
+
+int main(int argc, const char * argv[]){
+    num_iterations = 1000000;
+    if (argc > 1){
+        num_iterations = atoi(argv[1]);
+    }
+    printf("%-30s | %11s | %11s | %6s\n", "Command", "Template", "Encoder", "Ratio");
+    benchmark("le_set_scan_enable",            &template_le_set_scan_enable,            &encoder_le_set_scan_enable);
+    benchmark("le_connection_update",          &template_le_connection_update,          &encoder_le_connection_update);
+    benchmark("le_set_advertising_parameters", &template_le_set_advertising_parameters, &encoder_le_set_advertising_parameters);
+    benchmark("le_set_advertising_data",       &template_le_set_advertising_data,       &encoder_le_set_advertising_data);
+    benchmark("disconnect",                    &template_disconnect,                    &encoder_disconnect);
+    benchmark("write_local_name",              &template_write_local_name,              &encoder_write_local_name);
+    if (checksum == 0xffffffff) printf("checksum %u\n", checksum);
+    return num_mismatches;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hci_replay.c"
+
+/*
+ * hci_replay.c
+ *
+ * Replays a PacketLogger or BTSnoop capture through HCI and L2CAP using the replay transport and
+ * reports packets per second. Fails if the stack sent packets that differ from the capture.
+ *
+ * Usage: ./hci_replay file [--realtime]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_debug.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "hci.h"
+#include "hci_dump.h"
+#include "hci_transport.h"
+#include "l2cap.h"
+
+static hci_transport_config_replay_t config = {
+    HCI_TRANSPORT_CONFIG_REPLAY,
+    NULL,
+    0,
+};
+
+static double start_s;
+
+static double time_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void replay_done(void){
+    double duration = time_s() - start_s;
+    hci_transport_replay_stats_t stats;
+    hci_transport_replay_get_stats(&stats);
+    uint32_t num_packets = stats.packets_received + stats.packets_sent;
+    printf("%s: received %u, sent %u, mismatched %u, unexpected %u, stalls %u\n", config.file_name,
+        stats.packets_received, stats.packets_sent, stats.packets_mismatched, stats.packets_unexpected, stats.stalls);
+    printf("%s: %.2f ms, %.0f packets/s\n", config.file_name, duration * 1000.0, num_packets / duration);
+    int ok = (stats.packets_mismatched == 0) && (stats.packets_unexpected == 0) && (stats.stalls == 0);
+    exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+int main(int argc, const char * argv[]){
+    if (argc < 2){
+        printf("Usage: %s file [--realtime]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    config.file_name = argv[1];
+    config.realtime  = (argc > 2) && (strcmp(argv[2], "--realtime") == 0);
+
+    // silence log output
+    hci_dump_enable_log_level(LOG_LEVEL_DEBUG, 0);
+    if (!getenv("LOG")) hci_dump_enable_log_level(LOG_LEVEL_INFO,  0);
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+
+    hci_transport_replay_register_done_handler(&replay_done);
+    hci_init(hci_transport_replay_instance(), &config);
+    l2cap_init();
+
+    start_s = time_s();
+    hci_power_control(HCI_POWER_ON);
+    btstack_run_loop_execute();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,512 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hci_startup_benchmark.c"
+
+/*
+ * hci_startup_benchmark.c
+ *
+ * Measures the time from hci_power_control(HCI_POWER_ON) to HCI_STATE_WORKING against a scripted
+ * controller in virtual time. The controller has a command buffer for a configurable number of commands,
+ * processes one command at a time and reports its free buffers in Num_HCI_Command_Packets. For UART,
+ * the time to transfer each packet at the current baud rate is added to the transport latency.
+ *
+ * With an init script, the CC256x chipset driver uploads a generated script. The controller verifies
+ * that all script commands arrived in order and the time from the first to the last script command
+ * complete is reported.
+ *
+ * Build with and without ENABLE_HCI_COMMAND_PIPELINING to compare. Fails if HCI_STATE_WORKING is not
+ * reached or if the host sent more commands than the controller could buffer. Set LOG to see log output.
+ *
+ * Usage: ./hci_startup_benchmark [file] - stores PacketLogger capture of first scenario in file
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "bluetooth_company_id.h"
+#include "btstack_chipset_cc256x.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_linked_list.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+#include "hci_transport.h"
+
+#define MAX_SIM_EVENTS     32
+#define MAX_EVENT_LEN      260
+
+#define INIT_SCRIPT_OPCODE         0xff05
+#define INIT_SCRIPT_PAYLOAD_LEN    250
+#define INIT_SCRIPT_MAX_CMDS       150
+
+typedef struct {
+    const char * name;
+    uint8_t      command_buffers;   // Num_HCI_Command_Packets when idle
+    uint32_t     latency_us;        // one way transport latency
+    uint32_t     processing_us;     // time to execute a command
+    uint32_t     baudrate_init;     // 0 = no UART
+    uint32_t     baudrate_main;     // 0 = no baud rate change
+    uint16_t     init_script_cmds;  // 0 = no chipset
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "1 cmd buffer, USB",          1, 250, 100,      0,      0,   0 },
+    { "4 cmd buffers, USB",         4, 250, 100,      0,      0,   0 },
+    { "1 cmd buffer, UART",         1, 100, 100, 115200,      0,   0 },
+    { "4 cmd buffers, UART",        4, 100, 100, 115200,      0,   0 },
+    { "8 cmd buffers, UART",        8, 100, 100, 115200,      0,   0 },
+    { "CC256x, 1 buffer, 115200",   1, 100, 100, 115200,      0, 120 },
+    { "CC256x, 1 buffer, 921600",   1, 100, 100, 115200, 921600, 120 },
+    { "CC256x, 4 buffers, 921600",  4, 100, 100, 115200, 921600, 120 },
+};
+
+// default init script for cc256x chipset, a generated script is set for each scenario
+const uint8_t  cc256x_init_script[] = { 0 };
+const uint32_t cc256x_init_script_size = 0;
+
+static uint8_t  init_script[INIT_SCRIPT_MAX_CMDS * (4 + INIT_SCRIPT_PAYLOAD_LEN)];
+static uint32_t init_script_hash_expected;
+static uint32_t init_script_hash_received;
+static int      init_script_cmds_received;
+static uint32_t init_script_start_us;
+static uint32_t init_script_end_us;
+
+typedef enum {
+    SIM_COMMAND_ARRIVED,
+    SIM_COMMAND_EXECUTED,
+    SIM_EVENT_DELIVERED,
+} sim_event_type_t;
+
+typedef struct {
+    uint32_t         time_us;
+    sim_event_type_t type;
+    uint16_t         opcode;
+    uint16_t         len;
+    uint8_t          data[MAX_EVENT_LEN];
+} sim_event_t;
+
+static uint32_t    now_us;
+static uint32_t    host_baudrate;
+static uint32_t    tx_free_us;
+static uint32_t    rx_free_us;
+static sim_event_t sim_events[MAX_SIM_EVENTS];
+static int         sim_events_num;
+
+static const scenario_t * scenario;
+static uint16_t controller_queue[16];
+static int      controller_queue_len;
+static int      controller_max_queued;
+static int      controller_overflows;
+static int      commands_sent;
+
+static uint32_t working_time_us;
+static int      working;
+
+static void (*transport_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+static btstack_linked_list_t timers;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+
+// virtual time run loop
+
+static void virtual_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = now_us + timeout_in_ms * 1000;
+}
+
+static void virtual_run_loop_add_timer(btstack_timer_source_t * ts){
+    btstack_linked_list_remove(&timers, (btstack_linked_item_t *) ts);
+    btstack_linked_list_add(&timers, (btstack_linked_item_t *) ts);
+}
+
+static int virtual_run_loop_remove_timer(btstack_timer_source_t * ts){
+    return btstack_linked_list_remove(&timers, (btstack_linked_item_t *) ts);
+}
+
+static uint32_t virtual_run_loop_get_time_ms(void){
+    return now_us / 1000;
+}
+
+static void virtual_run_loop_init(void){
+    timers = NULL;
+}
+
+static const btstack_run_loop_t virtual_run_loop = {
+    &virtual_run_loop_init,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    &virtual_run_loop_set_timer,
+    &virtual_run_loop_add_timer,
+    &virtual_run_loop_remove_timer,
+    NULL,
+    NULL,
+    &virtual_run_loop_get_time_ms,
+};
+
+static btstack_timer_source_t * virtual_run_loop_next_timer(void){
+    btstack_timer_source_t * next = NULL;
+    btstack_linked_item_t * it;
+    for (it = (btstack_linked_item_t *) timers; it ; it = it->next){
+        btstack_timer_source_t * ts = (btstack_timer_source_t *) it;
+        if (!next || ts->timeout < next->timeout){
+            next = ts;
+        }
+    }
+    return next;
+}
+
+// scripted controller
+
+static sim_event_t * sim_schedule(uint32_t time_us, sim_event_type_t type){
+    if (sim_events_num == MAX_SIM_EVENTS){
+        printf("Simulation queue full\n");
+        exit(EXIT_FAILURE);
+    }
+    sim_event_t * event = &sim_events[sim_events_num++];
+    memset(event, 0, sizeof(sim_event_t));
+    event->time_us = time_us;
+    event->type    = type;
+    return event;
+}
+
+static int sim_next_event(void){
+    int i;
+    int next = -1;
+    for (i = 0; i < sim_events_num; i++){
+        // first scheduled event wins on same time to keep order
+        if (next < 0 || sim_events[i].time_us < sim_events[next].time_us){
+            next = i;
+        }
+    }
+    return next;
+}
+
+// FNV-1a
+static uint32_t hash_update(uint32_t hash, const uint8_t * data, int len){
+    int i;
+    for (i = 0; i < len; i++){
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// time on the wire incl. H4 packet type, 10 bits per byte
+static uint32_t transfer_time_us(int len){
+    if (host_baudrate == 0) return 0;
+    return (uint32_t) (((uint64_t) (1 + len) * 10 * 1000000) / host_baudrate);
+}
+
+static void controller_command_complete(uint16_t opcode){
+    uint8_t event[MAX_EVENT_LEN];
+    memset(event, 0, sizeof(event));
+    int num_hci_command_packets = scenario->command_buffers - controller_queue_len;
+    int return_parameters_len = 1 + 64;
+    // event[OFFSET_OF_DATA_IN_COMMAND_COMPLETE] = status = 0
+    if (opcode == hci_read_local_name.opcode){
+        return_parameters_len = 1 + 248;
+        strcpy((char *) &event[6], "scripted controller");
+    }
+    if (opcode == hci_read_local_version_information.opcode){
+        little_endian_store_16(event, 10, scenario->init_script_cmds ? BLUETOOTH_COMPANY_ID_TEXAS_INSTRUMENTS_INC : BLUETOOTH_COMPANY_ID_ERICSSON_TECHNOLOGY_LICENSING);
+    }
+    if (opcode == hci_read_local_supported_commands.opcode){
+        memset(&event[6], 0xff, 64);
+    }
+    if (opcode == hci_read_local_supported_features.opcode){
+        static const uint8_t features[] = { 0xff, 0xff, 0x8f, 0xfe, 0xdb, 0xff, 0x7b, 0x87 };
+        memcpy(&event[6], features, sizeof(features));
+    }
+    if (opcode == hci_read_buffer_size.opcode){
+        little_endian_store_16(event, 6, 1021);
+        event[8] = 64;
+        little_endian_store_16(event,  9, 8);
+        little_endian_store_16(event, 11, 8);
+    }
+    if (opcode == hci_le_read_buffer_size.opcode){
+        little_endian_store_16(event, 6, 251);
+        event[8] = 8;
+    }
+    if (opcode == hci_read_bd_addr.opcode){
+        static const uint8_t addr[] = { 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+        memcpy(&event[6], addr, sizeof(addr));
+    }
+    // vendor commands only return status
+    if ((opcode >> 10) == OGF_VENDOR){
+        return_parameters_len = 1;
+    }
+    event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event[1] = 3 + return_parameters_len;
+    event[2] = num_hci_command_packets > 0 ? num_hci_command_packets : 0;
+    little_endian_store_16(event, 3, opcode);
+    int len = 2 + event[1];
+
+    // events are sent back to back over UART
+    uint32_t start_us = btstack_max(now_us, rx_free_us);
+    rx_free_us = start_us + transfer_time_us(len);
+    sim_event_t * sim_event = sim_schedule(rx_free_us + scenario->latency_us, SIM_EVENT_DELIVERED);
+    sim_event->opcode = opcode;
+    sim_event->len    = len;
+    memcpy(sim_event->data, event, len);
+}
+
+static void controller_run(void){
+    int i;
+    for (i = 0; i < sim_events_num; i++){
+        if (sim_events[i].type == SIM_COMMAND_EXECUTED) return;
+    }
+    if (controller_queue_len == 0) return;
+    sim_schedule(now_us + scenario->processing_us, SIM_COMMAND_EXECUTED);
+}
+
+static void sim_process(sim_event_t * event){
+    switch (event->type){
+        case SIM_COMMAND_ARRIVED:
+            if (controller_queue_len >= scenario->command_buffers){
+                controller_overflows++;
+            }
+            if (controller_queue_len < (int) (sizeof(controller_queue) / sizeof(uint16_t))){
+                controller_queue[controller_queue_len++] = event->opcode;
+            }
+            if (controller_queue_len > controller_max_queued){
+                controller_max_queued = controller_queue_len;
+            }
+            controller_run();
+            break;
+        case SIM_COMMAND_EXECUTED: {
+            uint16_t opcode = controller_queue[0];
+            controller_queue_len--;
+            memmove(&controller_queue[0], &controller_queue[1], controller_queue_len * sizeof(uint16_t));
+            controller_command_complete(opcode);
+            controller_run();
+            break;
+        }
+        case SIM_EVENT_DELIVERED:
+            if (event->opcode == INIT_SCRIPT_OPCODE){
+                init_script_end_us = now_us;
+            }
+            (*transport_packet_handler)(HCI_EVENT_PACKET, event->data, event->len);
+            break;
+        default:
+            break;
+    }
+}
+
+// HCI transport
+
+static int transport_open(void){
+    return 0;
+}
+
+static int transport_close(void){
+    return 0;
+}
+
+static void transport_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    transport_packet_handler = handler;
+}
+
+static int transport_send_packet(uint8_t packet_type, uint8_t * packet, int size){
+    if (packet_type != HCI_COMMAND_DATA_PACKET) return 0;
+    commands_sent++;
+    uint16_t opcode = little_endian_read_16(packet, 0);
+    if (opcode == INIT_SCRIPT_OPCODE){
+        if (init_script_cmds_received == 0){
+            init_script_start_us = now_us;
+        }
+        init_script_cmds_received++;
+        init_script_hash_received = hash_update(init_script_hash_received, packet, size);
+    }
+    // commands are sent back to back over UART
+    uint32_t start_us = btstack_max(now_us, tx_free_us);
+    tx_free_us = start_us + transfer_time_us(size);
+    sim_schedule(tx_free_us + scenario->latency_us, SIM_COMMAND_ARRIVED)->opcode = opcode;
+    return 0;
+}
+
+static int transport_set_baudrate(uint32_t baudrate){
+    host_baudrate = baudrate;
+    return 0;
+}
+
+static const hci_transport_t scripted_transport = {
+    "scripted",
+    NULL,
+    &transport_open,
+    &transport_close,
+    &transport_register_packet_handler,
+    NULL,
+    &transport_send_packet,
+    &transport_set_baudrate,
+    NULL,
+    NULL,
+};
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (hci_event_packet_get_type(packet) != BTSTACK_EVENT_STATE) return;
+    if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) return;
+    working = 1;
+    working_time_us = now_us;
+}
+
+// init script with INIT_SCRIPT_OPCODE commands in TI format, i.e. with packet type
+static uint32_t init_script_generate(int num_commands){
+    uint32_t pos = 0;
+    int i;
+    init_script_hash_expected = 2166136261u;
+    for (i = 0; i < num_commands; i++){
+        uint8_t * cmd = &init_script[pos + 1];
+        int j;
+        init_script[pos] = 0x01;
+        little_endian_store_16(cmd, 0, INIT_SCRIPT_OPCODE);
+        cmd[2] = INIT_SCRIPT_PAYLOAD_LEN;
+        for (j = 0; j < INIT_SCRIPT_PAYLOAD_LEN; j++){
+            cmd[3 + j] = (uint8_t) (i * 7 + j);
+        }
+        init_script_hash_expected = hash_update(init_script_hash_expected, cmd, 3 + INIT_SCRIPT_PAYLOAD_LEN);
+        pos += 4 + INIT_SCRIPT_PAYLOAD_LEN;
+    }
+    return pos;
+}
+
+static int run_scenario(const scenario_t * new_scenario){
+    static hci_transport_config_uart_t config;
+
+    scenario = new_scenario;
+    now_us = 0;
+    host_baudrate = scenario->baudrate_init;
+    tx_free_us = 0;
+    rx_free_us = 0;
+    init_script_hash_received = 2166136261u;
+    init_script_cmds_received = 0;
+    init_script_start_us = 0;
+    init_script_end_us = 0;
+    sim_events_num = 0;
+    controller_queue_len = 0;
+    controller_max_queued = 0;
+    controller_overflows = 0;
+    commands_sent = 0;
+    working = 0;
+
+    timers = NULL;
+    config.type          = HCI_TRANSPORT_CONFIG_UART;
+    config.baudrate_init = scenario->baudrate_init;
+    config.baudrate_main = scenario->baudrate_main;
+    config.flowcontrol   = 1;
+    hci_init(&scripted_transport, scenario->baudrate_init ? &config : NULL);
+    if (scenario->init_script_cmds){
+        uint32_t size = init_script_generate(scenario->init_script_cmds);
+        btstack_chipset_cc256x_set_init_script(init_script, size);
+        hci_set_chipset(btstack_chipset_cc256x_instance());
+    }
+    hci_event_callback_registration.callback = &packet_handler;
+    hci_add_event_handler(&hci_event_callback_registration);
+    hci_power_control(HCI_POWER_ON);
+
+    // run until working or nothing left to do, limit to 10 seconds
+    while (!working && now_us < 10000000){
+        int next = sim_next_event();
+        btstack_timer_source_t * ts = virtual_run_loop_next_timer();
+        if (ts && (next < 0 || ts->timeout < sim_events[next].time_us)){
+            now_us = ts->timeout;
+            btstack_linked_list_remove(&timers, (btstack_linked_item_t *) ts);
+            ts->process(ts);
+            continue;
+        }
+        if (next < 0) break;
+        sim_event_t event = sim_events[next];
+        sim_events_num--;
+        memmove(&sim_events[next], &sim_events[next+1], (sim_events_num - next) * sizeof(sim_event_t));
+        now_us = event.time_us;
+        sim_process(&event);
+    }
+
+    int init_script_ok = (init_script_cmds_received == scenario->init_script_cmds);
+    if (scenario->init_script_cmds){
+        init_script_ok = init_script_ok && (init_script_hash_received == init_script_hash_expected);
+        printf("%-26s | %8s | %9.2f ms | %9.2f ms | %4u | %10u | %9u\n", scenario->name,
+               working ? "working" : "STALLED", working_time_us / 1000.0, (init_script_end_us - init_script_start_us) / 1000.0,
+               commands_sent, controller_max_queued, controller_overflows);
+        if (!init_script_ok){
+            printf("Init script corrupted: received %u of %u commands\n", init_script_cmds_received, scenario->init_script_cmds);
+        }
+    } else {
+        printf("%-26s | %8s | %9.2f ms | %12s | %4u | %10u | %9u\n", scenario->name,
+               working ? "working" : "STALLED", working_time_us / 1000.0, "-",
+               commands_sent, controller_max_queued, controller_overflows);
+    }
+    return working && (controller_overflows == 0) && init_script_ok;
+}
+
+int main(int argc, const char * argv[]){
+    // silence log output
+    hci_dump_enable_log_level(LOG_LEVEL_DEBUG, 0);
+    if (!getenv("LOG")) hci_dump_enable_log_level(LOG_LEVEL_INFO,  0);
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+
+    btstack_memory_init();
+    btstack_run_loop_init(&virtual_run_loop);
+
+#ifdef ENABLE_HCI_COMMAND_PIPELINING
+    printf("HCI startup with ENABLE_HCI_COMMAND_PIPELINING, depth %u\n", HCI_COMMAND_PIPELINING_DEPTH);
+#else
+    printf("HCI startup without command pipelining\n");
+#endif
+    printf("%-26s | %8s | %12s | %12s | %4s | %10s | %9s\n", "Controller", "State", "Startup", "Init script", "Cmds", "Max queued", "Overflows");
+
+    int ok = 1;
+    unsigned int i;
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenario_t); i++){
+        if ((i == 0) && (argc > 1)){
+            hci_dump_open(argv[1], HCI_DUMP_PACKETLOGGER);
+        }
+        ok &= run_scenario(&scenarios[i]);
+        if ((i == 0) && (argc > 1)){
+            hci_dump_close();
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
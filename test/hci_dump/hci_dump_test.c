@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+#include "btstack_util.h"
+#include "bluetooth.h"
+#include "hci_dump.h"
+
+#define LOG_FILE "hci_dump_test.pklg"
+
+static uint8_t acl_packet[100];
+static const uint8_t event_packet[] = { 0x0e, 0x04, 0x01, 0x03, 0x0c, 0x00 };
+
+#ifdef ENABLE_HCI_DUMP_ASYNC
+static uint8_t ring_buffer_storage[4096];
+#endif
+
+static void open_log(void){
+#ifdef ENABLE_HCI_DUMP_ASYNC
+    hci_dump_open_async(LOG_FILE, HCI_DUMP_PACKETLOGGER, ring_buffer_storage, sizeof(ring_buffer_storage));
+#else
+    hci_dump_open(LOG_FILE, HCI_DUMP_PACKETLOGGER);
+#endif
+}
+
+// @returns number of records, stores payload size of each record
+static int read_log(const char * path, int * payload_sizes, int max_records){
+    FILE * file = fopen(path, "rb");
+    if (!file) return -1;
+    int num_records = 0;
+    uint8_t header[13];
+    while (fread(header, 1, sizeof(header), file) == sizeof(header)){
+        int payload_size = big_endian_read_32(header, 0) - 9;
+        if (num_records < max_records){
+            payload_sizes[num_records] = payload_size;
+        }
+        num_records++;
+        fseek(file, payload_size, SEEK_CUR);
+    }
+    fclose(file);
+    return num_records;
+}
+
+TEST_GROUP(HciDump){
+    void setup(void){
+        hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+        hci_dump_set_max_packets(-1);
+        hci_dump_set_max_files(0);
+        hci_dump_set_packet_filter(HCI_ACL_DATA_PACKET, HCI_DUMP_PACKET_FILTER_FULL, 0);
+        hci_dump_set_packet_filter(HCI_EVENT_PACKET,    HCI_DUMP_PACKET_FILTER_FULL, 0);
+        unlink(LOG_FILE);
+        unlink(LOG_FILE ".1");
+        unlink(LOG_FILE ".2");
+    }
+};
+
+TEST(HciDump, Packets){
+    int sizes[10];
+    open_log();
+    hci_dump_packet(HCI_EVENT_PACKET, 1, (uint8_t *) event_packet, sizeof(event_packet));
+    hci_dump_packet(HCI_ACL_DATA_PACKET, 0, acl_packet, sizeof(acl_packet));
+    hci_dump_close();
+    CHECK_EQUAL(2, read_log(LOG_FILE, sizes, 10));
+    CHECK_EQUAL(sizeof(event_packet), sizes[0]);
+    CHECK_EQUAL(sizeof(acl_packet), sizes[1]);
+}
+
+TEST(HciDump, FilterHeader){
+    int sizes[10];
+    hci_dump_set_packet_filter(HCI_ACL_DATA_PACKET, HCI_DUMP_PACKET_FILTER_HEADER, 0);
+    open_log();
+    hci_dump_packet(HCI_ACL_DATA_PACKET, 0, acl_packet, sizeof(acl_packet));
+    hci_dump_packet(HCI_EVENT_PACKET, 1, (uint8_t *) event_packet, sizeof(event_packet));
+    hci_dump_close();
+    CHECK_EQUAL(2, read_log(LOG_FILE, sizes, 10));
+    CHECK_EQUAL(4, sizes[0]);
+    CHECK_EQUAL(sizeof(event_packet), sizes[1]);
+}
+
+TEST(HciDump, FilterNoneAndSampling){
+    int sizes[10];
+    hci_dump_set_packet_filter(HCI_ACL_DATA_PACKET, HCI_DUMP_PACKET_FILTER_NONE, 0);
+    hci_dump_set_packet_filter(HCI_EVENT_PACKET,    HCI_DUMP_PACKET_FILTER_FULL, 3);
+    open_log();
+    int i;
+    for (i = 0; i < 7; i++){
+        hci_dump_packet(HCI_ACL_DATA_PACKET, 0, acl_packet, sizeof(acl_packet));
+        hci_dump_packet(HCI_EVENT_PACKET, 1, (uint8_t *) event_packet, sizeof(event_packet));
+    }
+    hci_dump_close();
+    // events 0, 3, 6
+    CHECK_EQUAL(3, read_log(LOG_FILE, sizes, 10));
+}
+
+TEST(HciDump, Rotate){
+    int sizes[10];
+    hci_dump_set_max_packets(4);
+    hci_dump_set_max_files(3);
+    open_log();
+    int i;
+    for (i = 0; i < 10; i++){
+        hci_dump_packet(HCI_EVENT_PACKET, 1, (uint8_t *) event_packet, sizeof(event_packet));
+    }
+    hci_dump_close();
+    CHECK_EQUAL(2, read_log(LOG_FILE, sizes, 10));
+    CHECK_EQUAL(4, read_log(LOG_FILE ".1", sizes, 10));
+    CHECK_EQUAL(4, read_log(LOG_FILE ".2", sizes, 10));
+}
+
+TEST(HciDump, Truncate){
+    int sizes[10];
+    hci_dump_set_max_packets(4);
+    open_log();
+    int i;
+    for (i = 0; i < 10; i++){
+        hci_dump_packet(HCI_EVENT_PACKET, 1, (uint8_t *) event_packet, sizeof(event_packet));
+    }
+    hci_dump_close();
+    CHECK_EQUAL(2, read_log(LOG_FILE, sizes, 10));
+    CHECK_EQUAL(-1, read_log(LOG_FILE ".1", sizes, 10));
+}
+
+#ifdef ENABLE_HCI_DUMP_ASYNC
+TEST(HciDump, Dropped){
+    int sizes[100];
+    hci_dump_open_async(LOG_FILE, HCI_DUMP_PACKETLOGGER, ring_buffer_storage, 256);
+    uint32_t dropped_before = hci_dump_get_dropped_packets();
+    int i;
+    for (i = 0; i < 20; i++){
+        hci_dump_packet(HCI_ACL_DATA_PACKET, 0, acl_packet, sizeof(acl_packet));
+    }
+    uint32_t dropped = hci_dump_get_dropped_packets() - dropped_before;
+    CHECK(dropped > 0);
+    // wait for writer thread, next packet is preceded by report of dropped packets
+    usleep(100000);
+    hci_dump_packet(HCI_EVENT_PACKET, 1, (uint8_t *) event_packet, sizeof(event_packet));
+    hci_dump_close();
+    CHECK_EQUAL(20 - dropped + 2, read_log(LOG_FILE, sizes, 100));
+}
+#endif
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
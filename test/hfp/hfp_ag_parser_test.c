@@ -274,6 +274,80 @@ TEST(HFPParser, HFP_AG_CONFIRM_COMMON_CODEC){
     CHECK_EQUAL(context.codec_confirmed, codec);
 }
 
+TEST(HFPParser, HFP_AG_RESPONSE_AND_HOLD){
+    sprintf(packet, "\r\nAT%s?\r\n", HFP_RESPONSE_AND_HOLD);
+    for (pos = 0; pos < strlen(packet); pos++){
+        hfp_parse(&context, packet[pos], 0);
+    }
+    CHECK_EQUAL(HFP_CMD_RESPONSE_AND_HOLD_QUERY, context.command);
+
+    sprintf(packet, "\r\nAT%s=1\r\n", HFP_RESPONSE_AND_HOLD);
+    for (pos = 0; pos < strlen(packet); pos++){
+        hfp_parse(&context, packet[pos], 0);
+    }
+    CHECK_EQUAL(HFP_CMD_RESPONSE_AND_HOLD_COMMAND, context.command);
+}
+
+TEST(HFPParser, HFP_AG_CALL_HOLD){
+    sprintf(packet, "\r\nAT%s=?\r\n", HFP_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES);
+    for (pos = 0; pos < strlen(packet); pos++){
+        hfp_parse(&context, packet[pos], 0);
+    }
+    CHECK_EQUAL(HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES, context.command);
+
+    sprintf(packet, "\r\nAT%s=1\r\n", HFP_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES);
+    for (pos = 0; pos < strlen(packet); pos++){
+        hfp_parse(&context, packet[pos], 0);
+    }
+    CHECK_EQUAL(HFP_CMD_CALL_HOLD, context.command);
+}
+
+TEST(HFPParser, HFP_AG_ALL_COMMANDS){
+    // every command name is found by the binary search over the command table
+    const struct {
+        const char *  command;
+        hfp_command_t expected;
+    } commands[] = {
+        { "AT+BAC=1,2",  HFP_CMD_AVAILABLE_CODECS },
+        { "AT+BCC",      HFP_CMD_TRIGGER_CODEC_CONNECTION_SETUP },
+        { "AT+BCS=1",    HFP_CMD_HF_CONFIRMED_CODEC },
+        { "AT+BIA=1",    HFP_CMD_ENABLE_INDIVIDUAL_AG_INDICATOR_STATUS_UPDATE },
+        { "AT+BIEV=1,1", HFP_CMD_HF_INDICATOR_STATUS },
+        { "AT+BIND?",    HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS_STATE },
+        { "AT+BINP=1",   HFP_CMD_HF_REQUEST_PHONE_NUMBER },
+        { "AT+BLDN",     HFP_CMD_REDIAL_LAST_NUMBER },
+        { "AT+BRSF=1",   HFP_CMD_SUPPORTED_FEATURES },
+        { "AT+BSIR=1",   HFP_CMD_CHANGE_IN_BAND_RING_TONE_SETTING },
+        { "AT+BTRH?",    HFP_CMD_RESPONSE_AND_HOLD_QUERY },
+        { "AT+BVRA=1",   HFP_CMD_HF_ACTIVATE_VOICE_RECOGNITION },
+        { "AT+CCWA=1",   HFP_CMD_ENABLE_CALL_WAITING_NOTIFICATION },
+        { "AT+CHLD=?",   HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES },
+        { "AT+CHUP",     HFP_CMD_HANG_UP_CALL },
+        { "AT+CIND?",    HFP_CMD_RETRIEVE_AG_INDICATORS_STATUS },
+        { "AT+CLCC",     HFP_CMD_LIST_CURRENT_CALLS },
+        { "AT+CLIP=1",   HFP_CMD_ENABLE_CLIP },
+        { "AT+CMEE=1",   HFP_CMD_ENABLE_EXTENDED_AUDIO_GATEWAY_ERROR },
+        { "AT+CMER=3",   HFP_CMD_ENABLE_INDICATOR_STATUS_UPDATE },
+        { "AT+CNUM",     HFP_CMD_GET_SUBSCRIBER_NUMBER_INFORMATION },
+        { "AT+COPS?",    HFP_CMD_QUERY_OPERATOR_SELECTION_NAME },
+        { "AT+NREC=0",   HFP_CMD_TURN_OFF_EC_AND_NR },
+        { "AT+VGM=1",    HFP_CMD_SET_MICROPHONE_GAIN },
+        { "AT+VGS=1",    HFP_CMD_SET_SPEAKER_GAIN },
+        { "AT+VTS=1",    HFP_CMD_TRANSMIT_DTMF_CODES },
+        { "AT+XAPL=1",   HFP_CMD_UNKNOWN },
+        { "ATA",         HFP_CMD_CALL_ANSWERED },
+    };
+    unsigned int i;
+    for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++){
+        setup();
+        sprintf(packet, "\r\n%s\r\n", commands[i].command);
+        for (pos = 0; pos < strlen(packet); pos++){
+            hfp_parse(&context, packet[pos], 0);
+        }
+        CHECK_EQUAL(commands[i].expected, context.command);
+    }
+}
+
 int main (int argc, const char * argv[]){
     return CommandLineTestRunner::RunAllTests(argc, argv);
 }
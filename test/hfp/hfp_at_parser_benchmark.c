@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hfp_at_parser_benchmark.c"
+
+/*
+ * hfp_at_parser_benchmark.c
+ *
+ * Feeds a corpus of AG and HF command and response lines through hfp_parse, verifies the detected command
+ * for each line and reports the average parse time per line. Fails if a command is not detected as expected.
+ *
+ * Usage: ./hfp_at_parser_benchmark [iterations]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_debug.h"
+#include "hci_dump.h"
+#include "classic/hfp.h"
+
+void hfp_parse(hfp_connection_t * hfp_connection, uint8_t byte, int isHandsFree);
+
+typedef struct {
+    const char *  line;
+    int           is_hands_free;
+    hfp_command_t command;
+} corpus_entry_t;
+
+static const corpus_entry_t corpus[] = {
+    // received by HF
+    { "\r\nOK\r\n",                                    1, HFP_CMD_OK },
+    { "\r\nERROR\r\n",                                 1, HFP_CMD_ERROR },
+    { "\r\nRING\r\n",                                  1, HFP_CMD_RING },
+    { "\r\n+BRSF: 1007\r\n",                           1, HFP_CMD_SUPPORTED_FEATURES },
+    { "\r\n+CIND: 1,0,0,3,5,0,0\r\n",                  1, HFP_CMD_UNKNOWN },
+    { "\r\n+CIEV: 2,1\r\n",                            1, HFP_CMD_TRANSFER_AG_INDICATOR_STATUS },
+    { "\r\n+CIEV: 5,3\r\n",                            1, HFP_CMD_TRANSFER_AG_INDICATOR_STATUS },
+    { "\r\n+CHLD: (0,1,1x,2,2x,3,4)\r\n",              1, HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES },
+    { "\r\n+BIND: (1,2)\r\n",                          1, HFP_CMD_SET_GENERIC_STATUS_INDICATOR_STATUS },
+    { "\r\n+BCS: 2\r\n",                               1, HFP_CMD_AG_SUGGESTED_CODEC },
+    { "\r\n+BSIR: 1\r\n",                              1, HFP_CMD_CHANGE_IN_BAND_RING_TONE_SETTING },
+    { "\r\n+BVRA: 1\r\n",                              1, HFP_CMD_AG_ACTIVATE_VOICE_RECOGNITION },
+    { "\r\n+BINP: \"+4917012345\"\r\n",                1, HFP_CMD_AG_SENT_PHONE_NUMBER },
+    { "\r\n+BTRH: 0\r\n",                              1, HFP_CMD_RESPONSE_AND_HOLD_STATUS },
+    { "\r\n+CLIP: \"1234567\",129\r\n",                1, HFP_CMD_AG_SENT_CLIP_INFORMATION },
+    { "\r\n+CCWA: \"7654321\",129\r\n",                1, HFP_CMD_AG_SENT_CALL_WAITING_NOTIFICATION_UPDATE },
+    { "\r\n+COPS: 0,0,\"Operator\"\r\n",               1, HFP_CMD_QUERY_OPERATOR_SELECTION_NAME },
+    { "\r\n+CNUM: ,\"5551212\",129,,4\r\n",            1, HFP_CMD_GET_SUBSCRIBER_NUMBER_INFORMATION },
+    { "\r\n+CLCC: 1,1,4,0,0,\"1234567\",129\r\n",      1, HFP_CMD_LIST_CURRENT_CALLS },
+    { "\r\n+VGS: 9\r\n",                               1, HFP_CMD_SET_SPEAKER_GAIN },
+    { "\r\n+VGM: 7\r\n",                               1, HFP_CMD_SET_MICROPHONE_GAIN },
+    { "\r\n+CME ERROR: 30\r\n",                        1, HFP_CMD_EXTENDED_AUDIO_GATEWAY_ERROR },
+    { "\r\n+XAPL: iPhone,6\r\n",                       1, HFP_CMD_UNKNOWN },
+    // received by AG
+    { "AT+BRSF=438\r",                                 0, HFP_CMD_SUPPORTED_FEATURES },
+    { "AT+BAC=1,2\r",                                  0, HFP_CMD_AVAILABLE_CODECS },
+    { "AT+CIND=?\r",                                   0, HFP_CMD_RETRIEVE_AG_INDICATORS },
+    { "AT+CIND?\r",                                    0, HFP_CMD_RETRIEVE_AG_INDICATORS_STATUS },
+    { "AT+CMER=3,0,0,1\r",                             0, HFP_CMD_ENABLE_INDICATOR_STATUS_UPDATE },
+    { "AT+CHLD=?\r",                                   0, HFP_CMD_SUPPORT_CALL_HOLD_AND_MULTIPARTY_SERVICES },
+    { "AT+CHLD=1\r",                                   0, HFP_CMD_CALL_HOLD },
+    { "AT+BIND=1,2\r",                                 0, HFP_CMD_LIST_GENERIC_STATUS_INDICATORS },
+    { "AT+BIND=?\r",                                   0, HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS },
+    { "AT+BIND?\r",                                    0, HFP_CMD_RETRIEVE_GENERIC_STATUS_INDICATORS_STATE },
+    { "AT+BIA=0,1,,1\r",                               0, HFP_CMD_ENABLE_INDIVIDUAL_AG_INDICATOR_STATUS_UPDATE },
+    { "AT+BIEV=2,50\r",                                0, HFP_CMD_HF_INDICATOR_STATUS },
+    { "AT+COPS=3,0\r",                                 0, HFP_CMD_QUERY_OPERATOR_SELECTION_NAME_FORMAT },
+    { "AT+COPS?\r",                                    0, HFP_CMD_QUERY_OPERATOR_SELECTION_NAME },
+    { "AT+CMEE=1\r",                                   0, HFP_CMD_ENABLE_EXTENDED_AUDIO_GATEWAY_ERROR },
+    { "AT+CLIP=1\r",                                   0, HFP_CMD_ENABLE_CLIP },
+    { "AT+CCWA=1\r",                                   0, HFP_CMD_ENABLE_CALL_WAITING_NOTIFICATION },
+    { "AT+BCC\r",                                      0, HFP_CMD_TRIGGER_CODEC_CONNECTION_SETUP },
+    { "AT+BCS=2\r",                                    0, HFP_CMD_HF_CONFIRMED_CODEC },
+    { "ATA\r",                                         0, HFP_CMD_CALL_ANSWERED },
+    { "AT+CHUP\r",                                     0, HFP_CMD_HANG_UP_CALL },
+    { "AT+BLDN\r",                                     0, HFP_CMD_REDIAL_LAST_NUMBER },
+    { "AT+NREC=0\r",                                   0, HFP_CMD_TURN_OFF_EC_AND_NR },
+    { "AT+BVRA=1\r",                                   0, HFP_CMD_HF_ACTIVATE_VOICE_RECOGNITION },
+    { "AT+BINP=1\r",                                   0, HFP_CMD_HF_REQUEST_PHONE_NUMBER },
+    { "AT+VGS=9\r",                                    0, HFP_CMD_SET_SPEAKER_GAIN },
+    { "AT+VGM=7\r",                                    0, HFP_CMD_SET_MICROPHONE_GAIN },
+    { "AT+VTS=5\r",                                    0, HFP_CMD_TRANSMIT_DTMF_CODES },
+    { "AT+CNUM\r",                                     0, HFP_CMD_GET_SUBSCRIBER_NUMBER_INFORMATION },
+    { "AT+CLCC\r",                                     0, HFP_CMD_LIST_CURRENT_CALLS },
+    { "AT+BTRH?\r",                                    0, HFP_CMD_RESPONSE_AND_HOLD_QUERY },
+    { "AT+BTRH=1\r",                                   0, HFP_CMD_RESPONSE_AND_HOLD_COMMAND },
+    { "AT+BSIR=1\r",                                   0, HFP_CMD_CHANGE_IN_BAND_RING_TONE_SETTING },
+    { "AT+XAPL=ABCD-1234-0100,10\r",                   0, HFP_CMD_UNKNOWN },
+};
+
+static const int num_corpus_entries = sizeof(corpus) / sizeof(corpus_entry_t);
+
+static hfp_connection_t hfp_connection;
+
+static double time_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static hfp_command_t parse_line(const corpus_entry_t * entry){
+    hfp_connection.parser_state = HFP_PARSER_CMD_HEADER;
+    hfp_connection.parser_item_index = 0;
+    hfp_connection.line_size = 0;
+    hfp_connection.line_buffer[0] = 0;
+    hfp_connection.keep_byte = 0;
+    hfp_connection.resolve_byte = 0;
+    hfp_connection.command = HFP_CMD_NONE;
+    // lists are filled by each response
+    hfp_connection.remote_call_services_nr = 0;
+    hfp_connection.remote_codecs_nr = 0;
+    hfp_connection.generic_status_indicators_nr = 0;
+    const char * line = entry->line;
+    while (*line){
+        hfp_parse(&hfp_connection, (uint8_t) *line++, entry->is_hands_free);
+    }
+    return hfp_connection.command;
+}
+
+int main(int argc, const char * argv[]){
+    uint32_t num_iterations = 20000;
+    if (argc > 1){
+        num_iterations = atoi(argv[1]);
+    }
+
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+
+    // verify
+    int num_mismatches = 0;
+    int i;
+    for (i=0;i<num_corpus_entries;i++){
+        hfp_command_t command = parse_line(&corpus[i]);
+        if (command != corpus[i].command){
+            printf("%s: expected command %u, got %u\n", corpus[i].line, corpus[i].command, command);
+            num_mismatches++;
+        }
+    }
+
+    // benchmark
+    uint32_t num_bytes = 0;
+    for (i=0;i<num_corpus_entries;i++){
+        num_bytes += strlen(corpus[i].line);
+    }
+    double start = time_ns();
+    uint32_t iteration;
+    for (iteration=0;iteration<num_iterations;iteration++){
+        for (i=0;i<num_corpus_entries;i++){
+            parse_line(&corpus[i]);
+        }
+    }
+    double duration = time_ns() - start;
+    printf("%u lines, %u bytes: %6.1f ns/line, %5.2f ns/byte\n", num_corpus_entries, num_bytes,
+        duration / num_iterations / num_corpus_entries, duration / num_iterations / num_bytes);
+    return num_mismatches;
+}
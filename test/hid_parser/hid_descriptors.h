@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+// *****************************************************************************
+//
+// HID Descriptors and Reports used by HID Parser Test and Benchmark
+//
+// *****************************************************************************
+
+#ifndef __HID_DESCRIPTORS_H
+#define __HID_DESCRIPTORS_H
+
+#include <stdint.h>
+
+const uint8_t mouse_descriptor_without_report_id[] = {
+    0x05, 0x01, /*  Usage Page (Desktop),               */
+    0x09, 0x02, /*  Usage (Mouse),                      */
+    0xA1, 0x01, /*  Collection (Application),           */
+    0x09, 0x01, /*      Usage (Pointer),                */
+    0xA0,       /*      Collection (Physical),          */
+    0x05, 0x09, /*          Usage Page (Button),        */
+    0x19, 0x01, /*          Usage Minimum (01h),        */
+    0x29, 0x03, /*          Usage Maximum (03h),        */
+    0x14,       /*          Logical Minimum (0),        */
+    0x25, 0x01, /*          Logical Maximum (1),        */
+    0x75, 0x01, /*          Report Size (1),            */
+    0x95, 0x03, /*          Report Count (3),           */
+    0x81, 0x02, /*          Input (Variable),           */
+    0x75, 0x05, /*          Report Size (5),            */
+    0x95, 0x01, /*          Report Count (1),           */
+    0x81, 0x01, /*          Input (Constant),           */
+    0x05, 0x01, /*          Usage Page (Desktop),       */
+    0x09, 0x30, /*          Usage (X),                  */
+    0x09, 0x31, /*          Usage (Y),                  */
+    0x15, 0x81, /*          Logical Minimum (-127),     */
+    0x25, 0x7F, /*          Logical Maximum (127),      */
+    0x75, 0x08, /*          Report Size (8),            */
+    0x95, 0x02, /*          Report Count (2),           */
+    0x81, 0x06, /*          Input (Variable, Relative), */
+    0xC0,       /*      End Collection,                 */
+    0xC0        /*  End Collection                      */
+};
+
+const uint8_t mouse_descriptor_with_report_id[] = {
+    0x05, 0x01, /*  Usage Page (Desktop),               */
+    0x09, 0x02, /*  Usage (Mouse),                      */
+    0xA1, 0x01, /*  Collection (Application),           */
+    
+    0x85,  0x01,                    // Report ID 1
+
+    0x09, 0x01, /*      Usage (Pointer),                */
+    0xA0,       /*      Collection (Physical),          */
+    0x05, 0x09, /*          Usage Page (Button),        */
+    0x19, 0x01, /*          Usage Minimum (01h),        */
+    0x29, 0x03, /*          Usage Maximum (03h),        */
+    0x14,       /*          Logical Minimum (0),        */
+    0x25, 0x01, /*          Logical Maximum (1),        */
+    0x75, 0x01, /*          Report Size (1),            */
+    0x95, 0x03, /*          Report Count (3),           */
+    0x81, 0x02, /*          Input (Variable),           */
+    0x75, 0x05, /*          Report Size (5),            */
+    0x95, 0x01, /*          Report Count (1),           */
+    0x81, 0x01, /*          Input (Constant),           */
+    0x05, 0x01, /*          Usage Page (Desktop),       */
+    0x09, 0x30, /*          Usage (X),                  */
+    0x09, 0x31, /*          Usage (Y),                  */
+    0x15, 0x81, /*          Logical Minimum (-127),     */
+    0x25, 0x7F, /*          Logical Maximum (127),      */
+    0x75, 0x08, /*          Report Size (8),            */
+    0x95, 0x02, /*          Report Count (2),           */
+    0x81, 0x06, /*          Input (Variable, Relative), */
+    0xC0,       /*      End Collection,                 */
+    0xC0        /*  End Collection                      */
+};
+
+// from USB HID Specification 1.1, Appendix B.1
+const uint8_t hid_descriptor_keyboard_boot_mode[] = {
+
+    0x05, 0x01,                    // Usage Page (Generic Desktop)
+    0x09, 0x06,                    // Usage (Keyboard)
+    0xa1, 0x01,                    // Collection (Application)
+
+    // Modifier byte
+
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x08,                    //   Report Count (8)
+    0x05, 0x07,                    //   Usage Page (Key codes)
+    0x19, 0xe0,                    //   Usage Minimum (Keyboard LeftControl)
+    0x29, 0xe7,                    //   Usage Maxium (Keyboard Right GUI)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    // Reserved byte
+
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x08,                    //   Report Count (8)
+    0x81, 0x03,                    //   Input (Constant, Variable, Absolute)
+
+    // LED report + padding
+
+    0x95, 0x05,                    //   Report Count (5)
+    0x75, 0x01,                    //   Report Size (1)
+    0x05, 0x08,                    //   Usage Page (LEDs)
+    0x19, 0x01,                    //   Usage Minimum (Num Lock)
+    0x29, 0x05,                    //   Usage Maxium (Kana)
+    0x91, 0x02,                    //   Output (Data, Variable, Absolute)
+
+    0x95, 0x01,                    //   Report Count (1)
+    0x75, 0x03,                    //   Report Size (3)
+    0x91, 0x03,                    //   Output (Constant, Variable, Absolute)
+
+    // Keycodes
+
+    0x95, 0x06,                    //   Report Count (6)
+    0x75, 0x08,                    //   Report Size (8)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0xff,                    //   Logical Maximum (1)
+    0x05, 0x07,                    //   Usage Page (Key codes)
+    0x19, 0x00,                    //   Usage Minimum (Reserved (no event indicated))
+    0x29, 0xff,                    //   Usage Maxium (Reserved)
+    0x81, 0x00,                    //   Input (Data, Array)
+
+    0xc0,                          // End collection  
+};
+
+const uint8_t combo_descriptor_with_report_ids[] = {
+
+    0x05, 0x01, /*  Usage Page (Desktop),               */
+    0x09, 0x02, /*  Usage (Mouse),                      */
+    0xA1, 0x01, /*  Collection (Application),           */
+    
+    0x85, 0x01, // Report ID 1
+
+    0x09, 0x01, /*      Usage (Pointer),                */
+    0xA0,       /*      Collection (Physical),          */
+    0x05, 0x09, /*          Usage Page (Button),        */
+    0x19, 0x01, /*          Usage Minimum (01h),        */
+    0x29, 0x03, /*          Usage Maximum (03h),        */
+    0x14,       /*          Logical Minimum (0),        */
+    0x25, 0x01, /*          Logical Maximum (1),        */
+    0x75, 0x01, /*          Report Size (1),            */
+    0x95, 0x03, /*          Report Count (3),           */
+    0x81, 0x02, /*          Input (Variable),           */
+    0x75, 0x05, /*          Report Size (5),            */
+    0x95, 0x01, /*          Report Count (1),           */
+    0x81, 0x01, /*          Input (Constant),           */
+    0x05, 0x01, /*          Usage Page (Desktop),       */
+    0x09, 0x30, /*          Usage (X),                  */
+    0x09, 0x31, /*          Usage (Y),                  */
+    0x15, 0x81, /*          Logical Minimum (-127),     */
+    0x25, 0x7F, /*          Logical Maximum (127),      */
+    0x75, 0x08, /*          Report Size (8),            */
+    0x95, 0x02, /*          Report Count (2),           */
+    0x81, 0x06, /*          Input (Variable, Relative), */
+    0xC0,       /*      End Collection,                 */
+    0xC0,       /*  End Collection                      */
+
+    0xa1, 0x01,                    // Collection (Application)
+    
+    0x85, 0x02, // Report ID 2
+
+    // Modifier byte
+
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x08,                    //   Report Count (8)
+    0x05, 0x07,                    //   Usage Page (Key codes)
+    0x19, 0xe0,                    //   Usage Minimum (Keyboard LeftControl)
+    0x29, 0xe7,                    //   Usage Maxium (Keyboard Right GUI)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    // Reserved byte
+
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x08,                    //   Report Count (8)
+    0x81, 0x03,                    //   Input (Constant, Variable, Absolute)
+
+    // LED report + padding
+
+    0x95, 0x05,                    //   Report Count (5)
+    0x75, 0x01,                    //   Report Size (1)
+    0x05, 0x08,                    //   Usage Page (LEDs)
+    0x19, 0x01,                    //   Usage Minimum (Num Lock)
+    0x29, 0x05,                    //   Usage Maxium (Kana)
+    0x91, 0x02,                    //   Output (Data, Variable, Absolute)
+
+    0x95, 0x01,                    //   Report Count (1)
+    0x75, 0x03,                    //   Report Size (3)
+    0x91, 0x03,                    //   Output (Constant, Variable, Absolute)
+
+    // Keycodes
+
+    0x95, 0x06,                    //   Report Count (6)
+    0x75, 0x08,                    //   Report Size (8)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0xff,                    //   Logical Maximum (1)
+    0x05, 0x07,                    //   Usage Page (Key codes)
+    0x19, 0x00,                    //   Usage Minimum (Reserved (no event indicated))
+    0x29, 0xff,                    //   Usage Maxium (Reserved)
+    0x81, 0x00,                    //   Input (Data, Array)
+
+    0xc0,                          // En
+
+};
+
+const uint8_t mouse_report_without_id_positive_xy[]    = {       0x03, 0x02, 0x03 };
+const uint8_t mouse_report_without_id_negative_xy[]    = {       0x03, 0xFE, 0xFD };
+const uint8_t mouse_report_with_id_1[]    = { 0x01, 0x03, 0x02, 0x03 };
+
+const uint8_t keyboard_report1[] = { 0x01, 0x00, 0x04, 0x05, 0x06, 0x00, 0x00, 0x00 };
+
+const uint8_t combo_report1[]    = { 0x01, 0x03, 0x02, 0x03 };
+const uint8_t combo_report2[]    = { 0x02, 0x01, 0x00,  0x04, 0x05, 0x06, 0x00, 0x00, 0x00 };
+
+const uint8_t gamepad_digitizer_descriptor_with_report_ids[] = {
+
+    0x05, 0x01,                    // Usage Page (Generic Desktop)
+    0x09, 0x05,                    // Usage (Game Pad)
+    0xa1, 0x01,                    // Collection (Application)
+
+    0x85, 0x01,                    //   Report ID 1
+
+    0x05, 0x09,                    //   Usage Page (Button)
+    0x19, 0x01,                    //   Usage Minimum (1)
+    0x29, 0x10,                    //   Usage Maximum (16)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x10,                    //   Report Count (16)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    0x05, 0x01,                    //   Usage Page (Generic Desktop)
+    0x09, 0x39,                    //   Usage (Hat Switch)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x07,                    //   Logical Maximum (7)
+    0x75, 0x04,                    //   Report Size (4)
+    0x95, 0x01,                    //   Report Count (1)
+    0x81, 0x42,                    //   Input (Data, Variable, Absolute, Null State)
+
+    0x75, 0x04,                    //   Report Size (4)
+    0x95, 0x01,                    //   Report Count (1)
+    0x81, 0x01,                    //   Input (Constant)
+
+    0x09, 0x30,                    //   Usage (X)
+    0x09, 0x31,                    //   Usage (Y)
+    0x09, 0x32,                    //   Usage (Z)
+    0x09, 0x35,                    //   Usage (Rz)
+    0x16, 0x00, 0x80,              //   Logical Minimum (-32768)
+    0x26, 0xff, 0x7f,              //   Logical Maximum (32767)
+    0x75, 0x10,                    //   Report Size (16)
+    0x95, 0x04,                    //   Report Count (4)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    0x09, 0x33,                    //   Usage (Rx)
+    0x09, 0x34,                    //   Usage (Ry)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x26, 0xff, 0x00,              //   Logical Maximum (255)
+    0x75, 0x08,                    //   Report Size (8)
+    0x95, 0x02,                    //   Report Count (2)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    0xc0,                          // End Collection
+
+    0x05, 0x0d,                    // Usage Page (Digitizer)
+    0x09, 0x02,                    // Usage (Pen)
+    0xa1, 0x01,                    // Collection (Application)
+
+    0x85, 0x02,                    //   Report ID 2
+
+    0x09, 0x42,                    //   Usage (Tip Switch)
+    0x09, 0x32,                    //   Usage (In Range)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x25, 0x01,                    //   Logical Maximum (1)
+    0x75, 0x01,                    //   Report Size (1)
+    0x95, 0x02,                    //   Report Count (2)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    0x75, 0x06,                    //   Report Size (6)
+    0x95, 0x01,                    //   Report Count (1)
+    0x81, 0x01,                    //   Input (Constant)
+
+    0x05, 0x01,                    //   Usage Page (Generic Desktop)
+    0x09, 0x30,                    //   Usage (X)
+    0x09, 0x31,                    //   Usage (Y)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x26, 0xff, 0x7f,              //   Logical Maximum (32767)
+    0x75, 0x10,                    //   Report Size (16)
+    0x95, 0x02,                    //   Report Count (2)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    0x05, 0x0d,                    //   Usage Page (Digitizer)
+    0x09, 0x30,                    //   Usage (Tip Pressure)
+    0x15, 0x00,                    //   Logical Minimum (0)
+    0x26, 0xff, 0x0f,              //   Logical Maximum (4095)
+    0x75, 0x0c,                    //   Report Size (12)
+    0x95, 0x01,                    //   Report Count (1)
+    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
+
+    0x75, 0x04,                    //   Report Size (4)
+    0x95, 0x01,                    //   Report Count (1)
+    0x81, 0x01,                    //   Input (Constant)
+
+    0xc0,                          // End Collection
+};
+
+//                                         id    buttons     hat   X           Y           Z           Rz          Rx    Ry
+const uint8_t gamepad_report1[]    = { 0x01, 0x05, 0x80, 0x03, 0x00, 0x80, 0xff, 0x7f, 0xfe, 0xff, 0x10, 0x00, 0x40, 0xc0 };
+//                                         id    tip   X           Y           pressure
+const uint8_t digitizer_report1[]  = { 0x02, 0x03, 0x34, 0x12, 0x78, 0x56, 0x21, 0x03 };
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hid_parser_benchmark.c"
+
+/*
+ * hid_parser_benchmark.c
+ *
+ * Compares report processing by descriptor walk (btstack_hid_parser_init), by compiled layout
+ * via iterator (btstack_hid_parser_init_with_layout) and by btstack_hid_descriptor_layout_process_report.
+ * Verifies that all variants provide identical fields for the test reports and random reports.
+ *
+ * Usage: ./hid_parser_benchmark [reports per descriptor]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bluetooth.h"
+#include "btstack_hid_parser.h"
+
+#include "hid_descriptors.h"
+
+#define MAX_FIELDS 64
+#define MAX_REPORTS 4
+#define MAX_REPORT_LEN 32
+
+typedef struct {
+    const char    * name;
+    const uint8_t * descriptor;
+    uint16_t        descriptor_len;
+    const uint8_t * report;
+    uint16_t        report_len;
+} benchmark_case_t;
+
+#define CASE(name, descriptor, report) { name, descriptor, sizeof(descriptor), report, sizeof(report) }
+
+static const benchmark_case_t cases[] = {
+    CASE("mouse",            mouse_descriptor_without_report_id,           mouse_report_without_id_negative_xy),
+    CASE("mouse report id",  mouse_descriptor_with_report_id,              mouse_report_with_id_1),
+    CASE("boot keyboard",    hid_descriptor_keyboard_boot_mode,            keyboard_report1),
+    CASE("combo mouse",      combo_descriptor_with_report_ids,             combo_report1),
+    CASE("combo keyboard",   combo_descriptor_with_report_ids,             combo_report2),
+    CASE("gamepad",          gamepad_digitizer_descriptor_with_report_ids, gamepad_report1),
+    CASE("digitizer",        gamepad_digitizer_descriptor_with_report_ids, digitizer_report1),
+};
+
+typedef struct {
+    uint16_t usage_page;
+    uint16_t usage;
+    int32_t  value;
+} field_value_t;
+
+typedef struct {
+    field_value_t fields[MAX_FIELDS];
+    int           num_fields;
+    int32_t       checksum;
+} field_list_t;
+
+static btstack_hid_descriptor_layout_t layout;
+static btstack_hid_report_layout_t     layout_reports[MAX_REPORTS];
+static btstack_hid_field_t             layout_fields[MAX_FIELDS];
+
+static int failures;
+
+static uint64_t time_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void field_list_add(field_list_t * list, uint16_t usage_page, uint16_t usage, int32_t value){
+    list->checksum += usage_page + usage + value;
+    if (list->num_fields >= MAX_FIELDS) return;
+    list->fields[list->num_fields].usage_page = usage_page;
+    list->fields[list->num_fields].usage      = usage;
+    list->fields[list->num_fields].value      = value;
+    list->num_fields++;
+}
+
+static void handle_field(uint16_t usage_page, uint16_t usage, int32_t value, void * context){
+    field_list_add((field_list_t *) context, usage_page, usage, value);
+}
+
+static void collect_fields(btstack_hid_parser_t * parser, field_list_t * list){
+    while (btstack_hid_parser_has_more(parser)){
+        uint16_t usage_page;
+        uint16_t usage;
+        int32_t  value;
+        btstack_hid_parser_get_field(parser, &usage_page, &usage, &value);
+        field_list_add(list, usage_page, usage, value);
+    }
+}
+
+static int field_lists_equal(const field_list_t * a, const field_list_t * b){
+    if (a->num_fields != b->num_fields) return 0;
+    return memcmp(a->fields, b->fields, a->num_fields * sizeof(field_value_t)) == 0;
+}
+
+static void verify_report(const benchmark_case_t * test_case, const uint8_t * report, uint16_t report_len){
+    btstack_hid_parser_t parser;
+    field_list_t walk;
+    field_list_t iterator;
+    field_list_t single_pass;
+    memset(&walk, 0, sizeof(walk));
+    memset(&iterator, 0, sizeof(iterator));
+    memset(&single_pass, 0, sizeof(single_pass));
+
+    btstack_hid_parser_init(&parser, test_case->descriptor, test_case->descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT, report, report_len);
+    collect_fields(&parser, &walk);
+    btstack_hid_parser_init_with_layout(&parser, &layout, report, report_len);
+    collect_fields(&parser, &iterator);
+    btstack_hid_descriptor_layout_process_report(&layout, report, report_len, &handle_field, &single_pass);
+
+    if (!field_lists_equal(&walk, &iterator) || !field_lists_equal(&walk, &single_pass)){
+        printf("FAIL: %s: compiled layout differs from descriptor walk\n", test_case->name);
+        failures++;
+    }
+}
+
+static void benchmark_case(const benchmark_case_t * test_case, int num_reports){
+    uint8_t status = btstack_hid_descriptor_layout_compile(&layout, test_case->descriptor, test_case->descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT,
+        layout_reports, MAX_REPORTS, layout_fields, MAX_FIELDS);
+    if (status != ERROR_CODE_SUCCESS){
+        printf("FAIL: %s: compile failed with status 0x%02x\n", test_case->name, status);
+        failures++;
+        return;
+    }
+
+    // verify with test report and random reports of same length and report id
+    uint8_t report[MAX_REPORT_LEN];
+    verify_report(test_case, test_case->report, test_case->report_len);
+    int i, j;
+    for (i=0;i<1000;i++){
+        memcpy(report, test_case->report, test_case->report_len);
+        for (j = layout.has_report_ids ? 1 : 0; j < test_case->report_len; j++){
+            report[j] = rand() & 0xff;
+        }
+        verify_report(test_case, report, test_case->report_len);
+    }
+
+    btstack_hid_parser_t parser;
+    field_list_t list;
+    memset(&list, 0, sizeof(list));
+
+    uint64_t start = time_ns();
+    for (i=0;i<num_reports;i++){
+        list.num_fields = 0;
+        btstack_hid_parser_init(&parser, test_case->descriptor, test_case->descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT, test_case->report, test_case->report_len);
+        collect_fields(&parser, &list);
+    }
+    uint64_t walk_ns = time_ns() - start;
+    int num_fields = list.num_fields;
+
+    start = time_ns();
+    for (i=0;i<num_reports;i++){
+        list.num_fields = 0;
+        btstack_hid_parser_init_with_layout(&parser, &layout, test_case->report, test_case->report_len);
+        collect_fields(&parser, &list);
+    }
+    uint64_t iterator_ns = time_ns() - start;
+
+    start = time_ns();
+    for (i=0;i<num_reports;i++){
+        list.num_fields = 0;
+        btstack_hid_descriptor_layout_process_report(&layout, test_case->report, test_case->report_len, &handle_field, &list);
+    }
+    uint64_t single_pass_ns = time_ns() - start;
+
+    printf("%-16s %6d %7.1f ns  %7.1f ns  %7.1f ns  %5.1fx\n", test_case->name, num_fields,
+        (double) walk_ns / num_reports, (double) iterator_ns / num_reports, (double) single_pass_ns / num_reports,
+        single_pass_ns ? (double) walk_ns / single_pass_ns : 0.0);
+    if (list.checksum == 0x12345678){
+        // keep results alive
+        printf(" ");
+    }
+}
+
+int main(int argc, const char * argv[]){
+    int num_reports = 200000;
+    if (argc > 1){
+        num_reports = atoi(argv[1]);
+    }
+    printf("%d reports per descriptor, time per report\n", num_reports);
+    printf("descriptor       fields    walk        layout      single pass speedup\n");
+    unsigned int i;
+    for (i=0;i<sizeof(cases)/sizeof(cases[0]);i++){
+        benchmark_case(&cases[i], num_reports);
+    }
+    if (failures){
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -14,209 +14,10 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/CommandLineTestRunner.h"
 
+#include "bluetooth.h"
 #include "btstack_hid_parser.h"
 
-const uint8_t mouse_descriptor_without_report_id[] = {
-    0x05, 0x01, /*  Usage Page (Desktop),               */
-    0x09, 0x02, /*  Usage (Mouse),                      */
-    0xA1, 0x01, /*  Collection (Application),           */
-    0x09, 0x01, /*      Usage (Pointer),                */
-    0xA0,       /*      Collection (Physical),          */
-    0x05, 0x09, /*          Usage Page (Button),        */
-    0x19, 0x01, /*          Usage Minimum (01h),        */
-    0x29, 0x03, /*          Usage Maximum (03h),        */
-    0x14,       /*          Logical Minimum (0),        */
-    0x25, 0x01, /*          Logical Maximum (1),        */
-    0x75, 0x01, /*          Report Size (1),            */
-    0x95, 0x03, /*          Report Count (3),           */
-    0x81, 0x02, /*          Input (Variable),           */
-    0x75, 0x05, /*          Report Size (5),            */
-    0x95, 0x01, /*          Report Count (1),           */
-    0x81, 0x01, /*          Input (Constant),           */
-    0x05, 0x01, /*          Usage Page (Desktop),       */
-    0x09, 0x30, /*          Usage (X),                  */
-    0x09, 0x31, /*          Usage (Y),                  */
-    0x15, 0x81, /*          Logical Minimum (-127),     */
-    0x25, 0x7F, /*          Logical Maximum (127),      */
-    0x75, 0x08, /*          Report Size (8),            */
-    0x95, 0x02, /*          Report Count (2),           */
-    0x81, 0x06, /*          Input (Variable, Relative), */
-    0xC0,       /*      End Collection,                 */
-    0xC0        /*  End Collection                      */
-};
-
-const uint8_t mouse_descriptor_with_report_id[] = {
-    0x05, 0x01, /*  Usage Page (Desktop),               */
-    0x09, 0x02, /*  Usage (Mouse),                      */
-    0xA1, 0x01, /*  Collection (Application),           */
-    
-    0x85,  0x01,                    // Report ID 1
-
-    0x09, 0x01, /*      Usage (Pointer),                */
-    0xA0,       /*      Collection (Physical),          */
-    0x05, 0x09, /*          Usage Page (Button),        */
-    0x19, 0x01, /*          Usage Minimum (01h),        */
-    0x29, 0x03, /*          Usage Maximum (03h),        */
-    0x14,       /*          Logical Minimum (0),        */
-    0x25, 0x01, /*          Logical Maximum (1),        */
-    0x75, 0x01, /*          Report Size (1),            */
-    0x95, 0x03, /*          Report Count (3),           */
-    0x81, 0x02, /*          Input (Variable),           */
-    0x75, 0x05, /*          Report Size (5),            */
-    0x95, 0x01, /*          Report Count (1),           */
-    0x81, 0x01, /*          Input (Constant),           */
-    0x05, 0x01, /*          Usage Page (Desktop),       */
-    0x09, 0x30, /*          Usage (X),                  */
-    0x09, 0x31, /*          Usage (Y),                  */
-    0x15, 0x81, /*          Logical Minimum (-127),     */
-    0x25, 0x7F, /*          Logical Maximum (127),      */
-    0x75, 0x08, /*          Report Size (8),            */
-    0x95, 0x02, /*          Report Count (2),           */
-    0x81, 0x06, /*          Input (Variable, Relative), */
-    0xC0,       /*      End Collection,                 */
-    0xC0        /*  End Collection                      */
-};
-
-// from USB HID Specification 1.1, Appendix B.1
-const uint8_t hid_descriptor_keyboard_boot_mode[] = {
-
-    0x05, 0x01,                    // Usage Page (Generic Desktop)
-    0x09, 0x06,                    // Usage (Keyboard)
-    0xa1, 0x01,                    // Collection (Application)
-
-    // Modifier byte
-
-    0x75, 0x01,                    //   Report Size (1)
-    0x95, 0x08,                    //   Report Count (8)
-    0x05, 0x07,                    //   Usage Page (Key codes)
-    0x19, 0xe0,                    //   Usage Minimum (Keyboard LeftControl)
-    0x29, 0xe7,                    //   Usage Maxium (Keyboard Right GUI)
-    0x15, 0x00,                    //   Logical Minimum (0)
-    0x25, 0x01,                    //   Logical Maximum (1)
-    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
-
-    // Reserved byte
-
-    0x75, 0x01,                    //   Report Size (1)
-    0x95, 0x08,                    //   Report Count (8)
-    0x81, 0x03,                    //   Input (Constant, Variable, Absolute)
-
-    // LED report + padding
-
-    0x95, 0x05,                    //   Report Count (5)
-    0x75, 0x01,                    //   Report Size (1)
-    0x05, 0x08,                    //   Usage Page (LEDs)
-    0x19, 0x01,                    //   Usage Minimum (Num Lock)
-    0x29, 0x05,                    //   Usage Maxium (Kana)
-    0x91, 0x02,                    //   Output (Data, Variable, Absolute)
-
-    0x95, 0x01,                    //   Report Count (1)
-    0x75, 0x03,                    //   Report Size (3)
-    0x91, 0x03,                    //   Output (Constant, Variable, Absolute)
-
-    // Keycodes
-
-    0x95, 0x06,                    //   Report Count (6)
-    0x75, 0x08,                    //   Report Size (8)
-    0x15, 0x00,                    //   Logical Minimum (0)
-    0x25, 0xff,                    //   Logical Maximum (1)
-    0x05, 0x07,                    //   Usage Page (Key codes)
-    0x19, 0x00,                    //   Usage Minimum (Reserved (no event indicated))
-    0x29, 0xff,                    //   Usage Maxium (Reserved)
-    0x81, 0x00,                    //   Input (Data, Array)
-
-    0xc0,                          // End collection  
-};
-
-const uint8_t combo_descriptor_with_report_ids[] = {
-
-    0x05, 0x01, /*  Usage Page (Desktop),               */
-    0x09, 0x02, /*  Usage (Mouse),                      */
-    0xA1, 0x01, /*  Collection (Application),           */
-    
-    0x85, 0x01, // Report ID 1
-
-    0x09, 0x01, /*      Usage (Pointer),                */
-    0xA0,       /*      Collection (Physical),          */
-    0x05, 0x09, /*          Usage Page (Button),        */
-    0x19, 0x01, /*          Usage Minimum (01h),        */
-    0x29, 0x03, /*          Usage Maximum (03h),        */
-    0x14,       /*          Logical Minimum (0),        */
-    0x25, 0x01, /*          Logical Maximum (1),        */
-    0x75, 0x01, /*          Report Size (1),            */
-    0x95, 0x03, /*          Report Count (3),           */
-    0x81, 0x02, /*          Input (Variable),           */
-    0x75, 0x05, /*          Report Size (5),            */
-    0x95, 0x01, /*          Report Count (1),           */
-    0x81, 0x01, /*          Input (Constant),           */
-    0x05, 0x01, /*          Usage Page (Desktop),       */
-    0x09, 0x30, /*          Usage (X),                  */
-    0x09, 0x31, /*          Usage (Y),                  */
-    0x15, 0x81, /*          Logical Minimum (-127),     */
-    0x25, 0x7F, /*          Logical Maximum (127),      */
-    0x75, 0x08, /*          Report Size (8),            */
-    0x95, 0x02, /*          Report Count (2),           */
-    0x81, 0x06, /*          Input (Variable, Relative), */
-    0xC0,       /*      End Collection,                 */
-    0xC0,       /*  End Collection                      */
-
-    0xa1, 0x01,                    // Collection (Application)
-    
-    0x85, 0x02, // Report ID 2
-
-    // Modifier byte
-
-    0x75, 0x01,                    //   Report Size (1)
-    0x95, 0x08,                    //   Report Count (8)
-    0x05, 0x07,                    //   Usage Page (Key codes)
-    0x19, 0xe0,                    //   Usage Minimum (Keyboard LeftControl)
-    0x29, 0xe7,                    //   Usage Maxium (Keyboard Right GUI)
-    0x15, 0x00,                    //   Logical Minimum (0)
-    0x25, 0x01,                    //   Logical Maximum (1)
-    0x81, 0x02,                    //   Input (Data, Variable, Absolute)
-
-    // Reserved byte
-
-    0x75, 0x01,                    //   Report Size (1)
-    0x95, 0x08,                    //   Report Count (8)
-    0x81, 0x03,                    //   Input (Constant, Variable, Absolute)
-
-    // LED report + padding
-
-    0x95, 0x05,                    //   Report Count (5)
-    0x75, 0x01,                    //   Report Size (1)
-    0x05, 0x08,                    //   Usage Page (LEDs)
-    0x19, 0x01,                    //   Usage Minimum (Num Lock)
-    0x29, 0x05,                    //   Usage Maxium (Kana)
-    0x91, 0x02,                    //   Output (Data, Variable, Absolute)
-
-    0x95, 0x01,                    //   Report Count (1)
-    0x75, 0x03,                    //   Report Size (3)
-    0x91, 0x03,                    //   Output (Constant, Variable, Absolute)
-
-    // Keycodes
-
-    0x95, 0x06,                    //   Report Count (6)
-    0x75, 0x08,                    //   Report Size (8)
-    0x15, 0x00,                    //   Logical Minimum (0)
-    0x25, 0xff,                    //   Logical Maximum (1)
-    0x05, 0x07,                    //   Usage Page (Key codes)
-    0x19, 0x00,                    //   Usage Minimum (Reserved (no event indicated))
-    0x29, 0xff,                    //   Usage Maxium (Reserved)
-    0x81, 0x00,                    //   Input (Data, Array)
-
-    0xc0,                          // En
-
-};
-
-const uint8_t mouse_report_without_id_positive_xy[]    = {       0x03, 0x02, 0x03 };
-const uint8_t mouse_report_without_id_negative_xy[]    = {       0x03, 0xFE, 0xFD };
-const uint8_t mouse_report_with_id_1[]    = { 0x01, 0x03, 0x02, 0x03 };
-
-const uint8_t keyboard_report1[] = { 0x01, 0x00, 0x04, 0x05, 0x06, 0x00, 0x00, 0x00 };
-
-const uint8_t combo_report1[]    = { 0x01, 0x03, 0x02, 0x03 };
-const uint8_t combo_report2[]    = { 0x02, 0x01, 0x00,  0x04, 0x05, 0x06, 0x00, 0x00, 0x00 };
+#include "hid_descriptors.h"
 
 static void expect_field(btstack_hid_parser_t * parser, uint16_t expected_usage_page, uint16_t expected_usage, int32_t expected_value){
     // printf("expected - usage page %02x, usage %04x, value %02x (bit pos %u)\n", expected_usage_page, expected_usage, expected_value, parser->report_pos_in_bit);
@@ -326,6 +127,112 @@ TEST(HID, Combo2){
     CHECK_EQUAL(0, btstack_hid_parser_has_more(&hid_parser));
 }
 
+TEST(HID, GamepadDigitizer){
+    static btstack_hid_parser_t hid_parser;
+    btstack_hid_parser_init(&hid_parser, gamepad_digitizer_descriptor_with_report_ids, sizeof(gamepad_digitizer_descriptor_with_report_ids), BTSTACK_HID_REPORT_TYPE_INPUT, gamepad_report1, sizeof(gamepad_report1));
+    int i;
+    for (i=1;i<=16;i++){
+        expect_field(&hid_parser, 9, i, (i == 1 || i == 3 || i == 16) ? 1 : 0);
+    }
+    expect_field(&hid_parser, 1, 0x39, 3);
+    expect_field(&hid_parser, 1, 0x30, -32768);
+    expect_field(&hid_parser, 1, 0x31, 32767);
+    expect_field(&hid_parser, 1, 0x32, -2);
+    expect_field(&hid_parser, 1, 0x35, 16);
+    expect_field(&hid_parser, 1, 0x33, 0x40);
+    expect_field(&hid_parser, 1, 0x34, 0xc0);
+    CHECK_EQUAL(112, hid_parser.report_pos_in_bit);
+    CHECK_EQUAL(0, btstack_hid_parser_has_more(&hid_parser));
+
+    btstack_hid_parser_init(&hid_parser, gamepad_digitizer_descriptor_with_report_ids, sizeof(gamepad_digitizer_descriptor_with_report_ids), BTSTACK_HID_REPORT_TYPE_INPUT, digitizer_report1, sizeof(digitizer_report1));
+    expect_field(&hid_parser, 0x0d, 0x42, 1);
+    expect_field(&hid_parser, 0x0d, 0x32, 1);
+    expect_field(&hid_parser, 1, 0x30, 0x1234);
+    expect_field(&hid_parser, 1, 0x31, 0x5678);
+    expect_field(&hid_parser, 0x0d, 0x30, 0x321);
+    CHECK_EQUAL(64, hid_parser.report_pos_in_bit);
+    CHECK_EQUAL(0, btstack_hid_parser_has_more(&hid_parser));
+}
+
+// compiled layout
+
+static btstack_hid_descriptor_layout_t hid_layout;
+static btstack_hid_report_layout_t     hid_layout_reports[4];
+static btstack_hid_field_t             hid_layout_fields[64];
+
+static void compile_layout(const uint8_t * hid_descriptor, uint16_t hid_descriptor_len){
+    uint8_t status = btstack_hid_descriptor_layout_compile(&hid_layout, hid_descriptor, hid_descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT, 
+        hid_layout_reports, 4, hid_layout_fields, 64);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, status);
+}
+
+// compare compiled layout against descriptor walk
+static void expect_same_fields(const uint8_t * hid_descriptor, uint16_t hid_descriptor_len, const uint8_t * report, uint16_t report_len){
+    static btstack_hid_parser_t parser;
+    static btstack_hid_parser_t layout_parser;
+    compile_layout(hid_descriptor, hid_descriptor_len);
+    btstack_hid_parser_init(&parser, hid_descriptor, hid_descriptor_len, BTSTACK_HID_REPORT_TYPE_INPUT, report, report_len);
+    btstack_hid_parser_init_with_layout(&layout_parser, &hid_layout, report, report_len);
+    while (btstack_hid_parser_has_more(&parser)){
+        uint16_t usage_page;
+        uint16_t usage;
+        int32_t  value;
+        btstack_hid_parser_get_field(&parser, &usage_page, &usage, &value);
+        expect_field(&layout_parser, usage_page, usage, value);
+    }
+    CHECK_EQUAL(0, btstack_hid_parser_has_more(&layout_parser));
+    CHECK_EQUAL(parser.report_pos_in_bit, layout_parser.report_pos_in_bit);
+}
+
+TEST(HID, LayoutMatchesParser){
+    expect_same_fields(mouse_descriptor_without_report_id, sizeof(mouse_descriptor_without_report_id), mouse_report_without_id_positive_xy, sizeof(mouse_report_without_id_positive_xy));
+    expect_same_fields(mouse_descriptor_without_report_id, sizeof(mouse_descriptor_without_report_id), mouse_report_without_id_negative_xy, sizeof(mouse_report_without_id_negative_xy));
+    expect_same_fields(mouse_descriptor_with_report_id, sizeof(mouse_descriptor_with_report_id), mouse_report_with_id_1, sizeof(mouse_report_with_id_1));
+    expect_same_fields(hid_descriptor_keyboard_boot_mode, sizeof(hid_descriptor_keyboard_boot_mode), keyboard_report1, sizeof(keyboard_report1));
+    expect_same_fields(combo_descriptor_with_report_ids, sizeof(combo_descriptor_with_report_ids), combo_report1, sizeof(combo_report1));
+    expect_same_fields(combo_descriptor_with_report_ids, sizeof(combo_descriptor_with_report_ids), combo_report2, sizeof(combo_report2));
+    expect_same_fields(gamepad_digitizer_descriptor_with_report_ids, sizeof(gamepad_digitizer_descriptor_with_report_ids), gamepad_report1, sizeof(gamepad_report1));
+    expect_same_fields(gamepad_digitizer_descriptor_with_report_ids, sizeof(gamepad_digitizer_descriptor_with_report_ids), digitizer_report1, sizeof(digitizer_report1));
+}
+
+TEST(HID, LayoutTables){
+    compile_layout(combo_descriptor_with_report_ids, sizeof(combo_descriptor_with_report_ids));
+    CHECK_EQUAL(1, hid_layout.has_report_ids);
+    CHECK_EQUAL(2, hid_layout.num_reports);
+    CHECK_EQUAL(5, hid_layout.reports[0].num_fields);
+    CHECK_EQUAL(32, hid_layout.reports[0].size_in_bits);
+    CHECK_EQUAL(14, hid_layout.reports[1].num_fields);
+    CHECK_EQUAL(72, hid_layout.reports[1].size_in_bits);
+    const uint8_t unknown_report[] = { 0x03, 0x00 };
+    POINTERS_EQUAL(NULL, btstack_hid_descriptor_layout_get_report(&hid_layout, unknown_report, sizeof(unknown_report)));
+}
+
+TEST(HID, LayoutStorageTooSmall){
+    btstack_hid_field_t fields[4];
+    uint8_t status = btstack_hid_descriptor_layout_compile(&hid_layout, combo_descriptor_with_report_ids, sizeof(combo_descriptor_with_report_ids), BTSTACK_HID_REPORT_TYPE_INPUT, 
+        hid_layout_reports, 4, fields, 4);
+    CHECK_EQUAL(ERROR_CODE_MEMORY_CAPACITY_EXCEEDED, status);
+}
+
+static int num_processed_fields;
+static void handle_field(uint16_t usage_page, uint16_t usage, int32_t value, void * context){
+    (void) context;
+    if (num_processed_fields == 3){
+        CHECK_EQUAL(1, usage_page);
+        CHECK_EQUAL(0x30, usage);
+        CHECK_EQUAL(-2, value);
+    }
+    num_processed_fields++;
+}
+
+TEST(HID, LayoutProcessReport){
+    compile_layout(mouse_descriptor_without_report_id, sizeof(mouse_descriptor_without_report_id));
+    num_processed_fields = 0;
+    int num_fields = btstack_hid_descriptor_layout_process_report(&hid_layout, mouse_report_without_id_negative_xy, sizeof(mouse_report_without_id_negative_xy), &handle_field, NULL);
+    CHECK_EQUAL(5, num_fields);
+    CHECK_EQUAL(5, num_processed_fields);
+}
+
 int main (int argc, const char * argv[]){
     // hci_dump_open("hci_dump.pklg", HCI_DUMP_PACKETLOGGER);
     return CommandLineTestRunner::RunAllTests(argc, argv);
@@ -0,0 +1,131 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+#include "btstack_latency_trace.h"
+
+static uint32_t time_us;
+
+static uint32_t get_time_us(void){
+    return time_us;
+}
+
+static const btstack_latency_trace_histogram_t * histogram(btstack_latency_trace_segment_t segment){
+    return btstack_latency_trace_get_histogram(segment);
+}
+
+TEST_GROUP(LatencyTrace){
+    void setup(void){
+        time_us = 1000;
+        btstack_latency_trace_set_clock(&get_time_us);
+        btstack_latency_trace_reset();
+    }
+};
+
+TEST(LatencyTrace, Buckets){
+    uint32_t start = btstack_latency_trace_now();
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_HCI, start);
+    time_us += 1;
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_HCI, start);
+    time_us += 2;
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_HCI, start);
+    time_us += 1000;
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_HCI, start);
+    const btstack_latency_trace_histogram_t * rx_hci = histogram(BTSTACK_LATENCY_TRACE_RX_HCI);
+    CHECK_EQUAL(4, rx_hci->count);
+    CHECK_EQUAL(1003, rx_hci->max_us);
+    CHECK_EQUAL(1, rx_hci->buckets[0]);
+    CHECK_EQUAL(1, rx_hci->buckets[1]);
+    CHECK_EQUAL(1, rx_hci->buckets[2]);
+    CHECK_EQUAL(1, rx_hci->buckets[10]);
+}
+
+TEST(LatencyTrace, LastBucket){
+    uint32_t start = btstack_latency_trace_now();
+    time_us += 0x80000000u;
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_TX_CONTROLLER, start);
+    const btstack_latency_trace_histogram_t * tx_controller = histogram(BTSTACK_LATENCY_TRACE_TX_CONTROLLER);
+    CHECK_EQUAL(1, tx_controller->buckets[BTSTACK_LATENCY_TRACE_NUM_BUCKETS - 1]);
+    CHECK_EQUAL(0x80000000u, btstack_latency_trace_histogram_percentile(tx_controller, 50));
+}
+
+TEST(LatencyTrace, ClockWrapAround){
+    time_us = 0xfffffff0u;
+    uint32_t start = btstack_latency_trace_now();
+    time_us += 0x20;
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_HCI, start);
+    CHECK_EQUAL(0x20, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->max_us);
+}
+
+TEST(LatencyTrace, Percentile){
+    int i;
+    for (i = 0; i < 98; i++){
+        uint32_t start = btstack_latency_trace_now();
+        time_us += 10;
+        btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_ATT, start);
+    }
+    for (i = 0; i < 2; i++){
+        uint32_t start = btstack_latency_trace_now();
+        time_us += 5000;
+        btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_RX_ATT, start);
+    }
+    const btstack_latency_trace_histogram_t * rx_att = histogram(BTSTACK_LATENCY_TRACE_RX_ATT);
+    CHECK_EQUAL(15,   btstack_latency_trace_histogram_percentile(rx_att, 50));
+    CHECK_EQUAL(15,   btstack_latency_trace_histogram_percentile(rx_att, 98));
+    CHECK_EQUAL(5000, btstack_latency_trace_histogram_percentile(rx_att, 99));
+    CHECK_EQUAL(5000, btstack_latency_trace_histogram_percentile(rx_att, 100));
+    CHECK_EQUAL(0,    btstack_latency_trace_histogram_percentile(histogram(BTSTACK_LATENCY_TRACE_RX_SM), 50));
+}
+
+TEST(LatencyTrace, InvalidSegment){
+    POINTERS_EQUAL(NULL, btstack_latency_trace_get_histogram(BTSTACK_LATENCY_TRACE_NUM_SEGMENTS));
+    btstack_latency_trace_record(BTSTACK_LATENCY_TRACE_NUM_SEGMENTS, 0);
+}
+
+TEST(LatencyTrace, Incoming){
+    uint32_t received_us = btstack_latency_trace_now();
+    time_us += 100;
+    btstack_latency_trace_rx_acl(received_us);
+    time_us += 5;
+    btstack_latency_trace_rx_dispatch();
+    time_us += 40;
+    btstack_latency_trace_rx_handled(BTSTACK_LATENCY_TRACE_RX_RFCOMM);
+    CHECK_EQUAL(100, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->max_us);
+    CHECK_EQUAL(5,   histogram(BTSTACK_LATENCY_TRACE_RX_L2CAP)->max_us);
+    CHECK_EQUAL(40,  histogram(BTSTACK_LATENCY_TRACE_RX_RFCOMM)->max_us);
+    CHECK_EQUAL(0,   histogram(BTSTACK_LATENCY_TRACE_RX_ATT)->count);
+}
+
+TEST(LatencyTrace, Outgoing){
+    btstack_latency_trace_tx_reserved();
+    time_us += 20;
+    btstack_latency_trace_tx_acl();
+    time_us += 3;
+    btstack_latency_trace_tx_fragment(0);
+    time_us += 300;
+    btstack_latency_trace_tx_sent();
+    time_us += 7;
+    btstack_latency_trace_tx_fragment(1);
+    time_us += 200;
+    btstack_latency_trace_tx_sent();
+    // packet sent for HCI Command is ignored
+    btstack_latency_trace_tx_sent();
+    CHECK_EQUAL(1,   histogram(BTSTACK_LATENCY_TRACE_TX_L2CAP)->count);
+    CHECK_EQUAL(20,  histogram(BTSTACK_LATENCY_TRACE_TX_L2CAP)->max_us);
+    CHECK_EQUAL(1,   histogram(BTSTACK_LATENCY_TRACE_TX_HCI)->count);
+    CHECK_EQUAL(310, histogram(BTSTACK_LATENCY_TRACE_TX_HCI)->max_us);
+    CHECK_EQUAL(2,   histogram(BTSTACK_LATENCY_TRACE_TX_TRANSPORT)->count);
+    CHECK_EQUAL(300, histogram(BTSTACK_LATENCY_TRACE_TX_TRANSPORT)->max_us);
+}
+
+TEST(LatencyTrace, OutgoingWithoutReserve){
+    btstack_latency_trace_tx_reserved();
+    btstack_latency_trace_tx_released();
+    time_us += 20;
+    btstack_latency_trace_tx_acl();
+    btstack_latency_trace_tx_fragment(1);
+    CHECK_EQUAL(0, histogram(BTSTACK_LATENCY_TRACE_TX_L2CAP)->count);
+    CHECK_EQUAL(1, histogram(BTSTACK_LATENCY_TRACE_TX_HCI)->count);
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,145 @@
+// *****************************************************************************
+//
+// test latency trace for ACL packets passed from HCI Transport through hci.c and l2cap.c
+//
+// *****************************************************************************
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_latency_trace.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "hci.h"
+#include "l2cap.h"
+
+#define CON_HANDLE 0x0040
+
+// LE Connection Complete, handle 0x0040, master role
+static const uint8_t le_connection_complete[] = {
+    0x3E, 0x13, 0x01, 0x00, 0x40, 0x00, 0x00, 0x00, 0x9B, 0x77, 0xD1, 0xF7, 0xB1, 0x34, 0x50, 0x00, 0x00, 0x00, 0xD0, 0x07, 0x05 };
+
+static uint32_t time_us;
+static int att_packets_received;
+static void (*transport_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+static uint32_t get_time_us(void){
+    return time_us;
+}
+
+static void transport_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    transport_packet_handler = handler;
+}
+
+// keep hci_run from sending commands
+static int transport_can_send_packet_now(uint8_t packet_type){
+    (void) packet_type;
+    return 0;
+}
+
+static hci_transport_t dummy_transport = {
+  /*  .transport.name                          = */  "DUMMY",
+  /*  .transport.init                          = */  NULL,
+  /*  .transport.open                          = */  NULL,
+  /*  .transport.close                         = */  NULL,
+  /*  .transport.register_packet_handler       = */  &transport_register_packet_handler,
+  /*  .transport.can_send_packet_now           = */  &transport_can_send_packet_now,
+  /*  .transport.send_packet                   = */  NULL,
+  /*  .transport.set_baudrate                  = */  NULL,
+};
+
+static void att_packet_handler(uint8_t packet_type, uint16_t handle, uint8_t *packet, uint16_t size){
+    (void) packet_type;
+    (void) handle;
+    (void) packet;
+    (void) size;
+    att_packets_received++;
+    time_us += 40;
+}
+
+// ACL packet with L2CAP header for ATT, first fragment carries acl_len bytes
+static uint16_t build_att_fragment(uint8_t * packet, uint8_t pb_flags, uint16_t acl_len, uint16_t l2cap_len){
+    little_endian_store_16(packet, 0, CON_HANDLE | (pb_flags << 12));
+    little_endian_store_16(packet, 2, acl_len);
+    memset(&packet[4], 0x55, acl_len);
+    if (pb_flags == 0x02){
+        little_endian_store_16(packet, 4, l2cap_len);
+        little_endian_store_16(packet, 6, L2CAP_CID_ATTRIBUTE_PROTOCOL);
+    }
+    return 4 + acl_len;
+}
+
+static const btstack_latency_trace_histogram_t * histogram(btstack_latency_trace_segment_t segment){
+    return btstack_latency_trace_get_histogram(segment);
+}
+
+TEST_GROUP(LatencyTraceACL){
+    void setup(void){
+        time_us = 1000;
+        att_packets_received = 0;
+        btstack_latency_trace_set_clock(&get_time_us);
+        btstack_latency_trace_reset();
+    }
+};
+
+TEST(LatencyTraceACL, UnfragmentedPackets){
+    uint8_t packet[32];
+    int i;
+    for (i = 0; i < 3; i++){
+        uint16_t size = build_att_fragment(packet, 0x02, 7, 3);
+        (*transport_packet_handler)(HCI_ACL_DATA_PACKET, packet, size);
+    }
+    CHECK_EQUAL(3, att_packets_received);
+    CHECK_EQUAL(3, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->count);
+    CHECK_EQUAL(3, histogram(BTSTACK_LATENCY_TRACE_RX_L2CAP)->count);
+    CHECK_EQUAL(3, histogram(BTSTACK_LATENCY_TRACE_RX_ATT)->count);
+    CHECK_EQUAL(40, histogram(BTSTACK_LATENCY_TRACE_RX_ATT)->max_us);
+    CHECK_EQUAL(0, histogram(BTSTACK_LATENCY_TRACE_RX_SM)->count);
+    CHECK_EQUAL(0, histogram(BTSTACK_LATENCY_TRACE_RX_OTHER)->count);
+}
+
+TEST(LatencyTraceACL, FragmentedPacket){
+    uint8_t packet[32];
+    uint16_t size;
+
+    // RX HCI starts with first fragment
+    size = build_att_fragment(packet, 0x02, 8, 10);
+    (*transport_packet_handler)(HCI_ACL_DATA_PACKET, packet, size);
+    CHECK_EQUAL(0, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->count);
+    time_us += 500;
+    size = build_att_fragment(packet, 0x01, 6, 0);
+    (*transport_packet_handler)(HCI_ACL_DATA_PACKET, packet, size);
+
+    CHECK_EQUAL(1, att_packets_received);
+    CHECK_EQUAL(1, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->count);
+    CHECK_EQUAL(500, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->max_us);
+    CHECK_EQUAL(1, histogram(BTSTACK_LATENCY_TRACE_RX_L2CAP)->count);
+    CHECK_EQUAL(1, histogram(BTSTACK_LATENCY_TRACE_RX_ATT)->count);
+}
+
+TEST(LatencyTraceACL, UnknownHandle){
+    uint8_t packet[32];
+    uint16_t size = build_att_fragment(packet, 0x02, 7, 3);
+    little_endian_store_16(packet, 0, 0x0041 | (0x02 << 12));
+    (*transport_packet_handler)(HCI_ACL_DATA_PACKET, packet, size);
+    CHECK_EQUAL(0, att_packets_received);
+    CHECK_EQUAL(0, histogram(BTSTACK_LATENCY_TRACE_RX_HCI)->count);
+    CHECK_EQUAL(0, histogram(BTSTACK_LATENCY_TRACE_RX_L2CAP)->count);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_init(&dummy_transport, NULL);
+    l2cap_init();
+    l2cap_register_fixed_channel(&att_packet_handler, L2CAP_CID_ATTRIBUTE_PROTOCOL);
+    (*transport_packet_handler)(HCI_EVENT_PACKET, (uint8_t *) le_connection_complete, sizeof(le_connection_complete));
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_memory_churn_benchmark.c"
+
+/*
+ *  btstack_memory_churn_benchmark.c
+ *
+ *  Connect/disconnect churn through btstack_memory with malloc or slab backend (ENABLE_MEMORY_SLAB).
+ *  Each cycle allocates the objects of a typical connection while long-lived application buffers
+ *  of varying size are allocated from the same heap.
+ */
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_memory.h"
+#include "hci_dump.h"
+
+#define NUM_CYCLES       10000
+#define NUM_APP_BUFFERS  64
+
+#ifdef ENABLE_MEMORY_SLAB
+static const char * backend = "slab";
+#else
+static const char * backend = "malloc";
+#endif
+
+static void * app_buffers[NUM_APP_BUFFERS];
+
+static double time_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void connect_disconnect(uint32_t cycle){
+    hci_connection_t     * hci_connection     = btstack_memory_hci_connection_get();
+    l2cap_channel_t      * l2cap_signaling    = btstack_memory_l2cap_channel_get();
+    rfcomm_multiplexer_t * rfcomm_multiplexer = btstack_memory_rfcomm_multiplexer_get();
+    l2cap_channel_t      * l2cap_rfcomm       = btstack_memory_l2cap_channel_get();
+    rfcomm_channel_t     * rfcomm_channel     = btstack_memory_rfcomm_channel_get();
+    gatt_client_t        * gatt_client        = btstack_memory_gatt_client_get();
+    if (!hci_connection || !l2cap_signaling || !l2cap_rfcomm || !rfcomm_multiplexer || !rfcomm_channel || !gatt_client){
+        printf("allocation failed in cycle %u\n", cycle);
+        exit(10);
+    }
+    memset(hci_connection, 0, sizeof(hci_connection_t));
+    memset(l2cap_rfcomm, 0, sizeof(l2cap_channel_t));
+
+    // application allocates and releases buffers of varying size while connected
+    int index = cycle % NUM_APP_BUFFERS;
+    free(app_buffers[index]);
+    app_buffers[index] = malloc(32 + (cycle * 7919) % 1500);
+
+    btstack_memory_gatt_client_free(gatt_client);
+    btstack_memory_rfcomm_channel_free(rfcomm_channel);
+    btstack_memory_l2cap_channel_free(l2cap_rfcomm);
+    btstack_memory_rfcomm_multiplexer_free(rfcomm_multiplexer);
+    btstack_memory_l2cap_channel_free(l2cap_signaling);
+    btstack_memory_hci_connection_free(hci_connection);
+}
+
+int main(int argc, const char * argv[]){
+    (void) argc;
+    (void) argv;
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+    btstack_memory_init();
+
+    // a few connections stay open during the whole run
+    hci_connection_t * long_lived[4];
+    int i;
+    for (i = 0; i < 4; i++){
+        long_lived[i] = btstack_memory_hci_connection_get();
+    }
+
+    double start = time_s();
+    uint32_t cycle;
+    for (cycle = 0; cycle < NUM_CYCLES; cycle++){
+        connect_disconnect(cycle);
+    }
+    double duration = time_s() - start;
+
+    struct mallinfo2 info = mallinfo2();
+    printf("%-6s: %u connect/disconnect cycles, %6.1f ns/cycle, heap %7zu bytes, in use %7zu bytes, free %7zu bytes\n",
+        backend, NUM_CYCLES, duration * 1e9 / NUM_CYCLES, info.arena, info.uordblks, info.fordblks);
+
+    btstack_memory_pool_stats_t stats;
+    btstack_memory_hci_connection_get_stats(&stats);
+    printf("        hci_connection: in use %u, max %u, count %u\n", stats.in_use, stats.max_in_use, stats.count);
+
+    for (i = 0; i < 4; i++){
+        btstack_memory_hci_connection_free(long_lived[i]);
+    }
+    for (i = 0; i < NUM_APP_BUFFERS; i++){
+        free(app_buffers[i]);
+    }
+    btstack_memory_deinit();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+#include "btstack_memory_pool.h"
+#include "btstack_memory_slab.h"
+
+#include <string.h>
+
+#define NUM_BLOCKS 5
+
+typedef struct {
+    void *   next;
+    uint32_t payload[3];
+} block_t;
+
+static block_t storage[NUM_BLOCKS];
+static btstack_memory_pool_t pool;
+
+TEST_GROUP(MemoryPool){
+    void setup(void){
+        btstack_memory_pool_create(&pool, storage, NUM_BLOCKS, sizeof(block_t));
+    }
+};
+
+TEST(MemoryPool, GetAll){
+    int i;
+    for (i = 0; i < NUM_BLOCKS; i++){
+        // blocks are handed out in storage order
+        POINTERS_EQUAL(&storage[i], btstack_memory_pool_get(&pool));
+    }
+    POINTERS_EQUAL(NULL, btstack_memory_pool_get(&pool));
+}
+
+TEST(MemoryPool, FreeIsLifo){
+    void * a = btstack_memory_pool_get(&pool);
+    void * b = btstack_memory_pool_get(&pool);
+    btstack_memory_pool_free(&pool, a);
+    btstack_memory_pool_free(&pool, b);
+    POINTERS_EQUAL(b, btstack_memory_pool_get(&pool));
+    POINTERS_EQUAL(a, btstack_memory_pool_get(&pool));
+}
+
+TEST(MemoryPool, Stats){
+    btstack_memory_pool_stats_t stats;
+    void * blocks[NUM_BLOCKS];
+    int i;
+    for (i = 0; i < NUM_BLOCKS; i++){
+        blocks[i] = btstack_memory_pool_get(&pool);
+    }
+    POINTERS_EQUAL(NULL, btstack_memory_pool_get(&pool));
+    POINTERS_EQUAL(NULL, btstack_memory_pool_get(&pool));
+    btstack_memory_pool_free(&pool, blocks[0]);
+    btstack_memory_pool_free(&pool, blocks[1]);
+
+    btstack_memory_pool_get_stats(&pool, &stats);
+    CHECK_EQUAL(NUM_BLOCKS, stats.count);
+    CHECK_EQUAL(NUM_BLOCKS - 2, stats.in_use);
+    CHECK_EQUAL(NUM_BLOCKS, stats.max_in_use);
+    CHECK_EQUAL(2, stats.failed);
+}
+
+TEST(MemoryPool, StatsRecord){
+    btstack_memory_pool_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    btstack_memory_pool_stats_record_get(&stats, &storage[0]);
+    btstack_memory_pool_stats_record_get(&stats, &storage[1]);
+    btstack_memory_pool_stats_record_get(&stats, NULL);
+    btstack_memory_pool_stats_record_free(&stats);
+    CHECK_EQUAL(1, stats.in_use);
+    CHECK_EQUAL(2, stats.max_in_use);
+    CHECK_EQUAL(1, stats.failed);
+}
+
+#ifdef ENABLE_MEMORY_POOL_DEBUG
+TEST(MemoryPool, DoubleFree){
+    btstack_memory_pool_stats_t stats;
+    void * a = btstack_memory_pool_get(&pool);
+    void * b = btstack_memory_pool_get(&pool);
+    btstack_memory_pool_free(&pool, a);
+    btstack_memory_pool_free(&pool, a);
+    btstack_memory_pool_get_stats(&pool, &stats);
+    CHECK_EQUAL(1, stats.in_use);
+    // free list not corrupted by second free
+    POINTERS_EQUAL(a, btstack_memory_pool_get(&pool));
+    CHECK(btstack_memory_pool_get(&pool) != a);
+    (void) b;
+}
+
+TEST(MemoryPool, ForeignBlock){
+    btstack_memory_pool_stats_t stats;
+    block_t foreign;
+    btstack_memory_pool_get(&pool);
+    btstack_memory_pool_free(&pool, &foreign);
+    btstack_memory_pool_get_stats(&pool, &stats);
+    CHECK_EQUAL(1, stats.in_use);
+}
+#endif
+
+TEST_GROUP(MemorySlab){
+    btstack_memory_slab_t slab;
+    void setup(void){
+        btstack_memory_slab_init(&slab, sizeof(block_t));
+    }
+    void teardown(void){
+        btstack_memory_slab_release(&slab);
+    }
+};
+
+TEST(MemorySlab, Aligned){
+    int i;
+    for (i = 0; i < 200; i++){
+        void * block = btstack_memory_slab_get(&slab);
+        CHECK(block != NULL);
+        CHECK_EQUAL(0, ((uintptr_t) block) % MEMORY_SLAB_ALIGNMENT);
+    }
+}
+
+TEST(MemorySlab, Stats){
+    btstack_memory_pool_stats_t stats;
+    void * a = btstack_memory_slab_get(&slab);
+    void * b = btstack_memory_slab_get(&slab);
+    btstack_memory_slab_free(&slab, a);
+    POINTERS_EQUAL(a, btstack_memory_slab_get(&slab));
+    btstack_memory_slab_free(&slab, b);
+    btstack_memory_slab_get_stats(&slab, &stats);
+    CHECK_EQUAL(1, stats.in_use);
+    CHECK_EQUAL(2, stats.max_in_use);
+    CHECK_EQUAL(MEMORY_SLAB_CHUNK_SIZE / MEMORY_SLAB_ALIGNMENT, stats.count);
+}
+
+TEST(MemorySlab, Release){
+    btstack_memory_pool_stats_t stats;
+    btstack_memory_slab_get(&slab);
+    btstack_memory_slab_release(&slab);
+    btstack_memory_slab_get_stats(&slab, &stats);
+    CHECK_EQUAL(0, stats.count);
+    CHECK_EQUAL(0, stats.in_use);
+    CHECK(btstack_memory_slab_get(&slab) != NULL);
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
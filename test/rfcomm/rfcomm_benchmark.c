@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "rfcomm_benchmark.c"
+
+/*
+ * rfcomm_benchmark.c
+ *
+ * Transfers data over an RFCOMM channel to and from a scripted remote device in virtual time and counts
+ * the RFCOMM frames sent per payload byte. L2CAP is replaced by a mock that allows a limited number of
+ * outgoing packets per tick (1 ms). The remote sends a limited number of data frames per tick as long
+ * as it has credits and grants 10 new credits whenever the local side has less than 5 left.
+ *
+ * Scenarios: send only, receive only, and both directions at the same time. Reports data frames,
+ * credit-only frames, and L2CAP can send now events per KB of payload sent and received.
+ * Fails if not all data was transferred. Set LOG to see log output.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "bluetooth_sdp.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_util.h"
+#include "classic/rfcomm.h"
+#include "hci_dump.h"
+#include "l2cap.h"
+
+#define L2CAP_CID              0x0041
+#define L2CAP_MTU              1021
+#define SERVER_CHANNEL         1
+#define REMOTE_INITIAL_CREDITS 7
+#define PAYLOAD_SIZE           500
+#define TRANSFER_SIZE          (256 * 1024)
+#define MAX_TICKS              100000
+
+#define MAX_REMOTE_FRAMES      16
+#define MAX_FRAME_LEN          (L2CAP_MTU + 10)
+
+typedef struct {
+    const char * name;
+    uint32_t bytes_to_send;
+    uint32_t bytes_to_receive;
+    int      local_packets_per_tick;
+    int      remote_frames_per_tick;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "send",          TRANSFER_SIZE, 0,             4, 4 },
+    { "receive",       0,             TRANSFER_SIZE, 4, 4 },
+    { "bidirectional", TRANSFER_SIZE, TRANSFER_SIZE, 4, 4 },
+};
+
+// virtual time
+static uint32_t now_ms;
+
+// mock l2cap
+static btstack_packet_handler_t rfcomm_l2cap_handler;
+static uint8_t  l2cap_outgoing_buffer[MAX_FRAME_LEN];
+static int      l2cap_can_send_now_requested;
+static int      l2cap_budget;
+static int      l2cap_open_pending;
+
+// remote device
+static uint8_t  remote_frames[MAX_REMOTE_FRAMES][MAX_FRAME_LEN];
+static uint16_t remote_frame_len[MAX_REMOTE_FRAMES];
+static int      remote_frames_count;
+static uint8_t  remote_dlci;
+static uint16_t remote_credits;          // credits remote can use to send to us
+static uint16_t remote_credits_granted;  // credits we can use to send to remote, as tracked by remote
+static uint32_t remote_bytes_received;
+static uint32_t remote_bytes_to_send;
+
+// local application
+static bd_addr_t remote_addr = { 0x00, 0x1b, 0xdc, 0x07, 0x32, 0xef };
+static uint16_t rfcomm_cid;
+static uint16_t rfcomm_max_frame_size;
+static uint32_t local_bytes_to_send;
+static uint32_t local_bytes_received;
+
+// statistics
+static uint32_t stats_data_frames;
+static uint32_t stats_credit_frames;
+static uint32_t stats_can_send_now_events;
+
+// mock run loop
+void btstack_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    UNUSED(ts);
+    UNUSED(timeout_in_ms);
+}
+void btstack_run_loop_set_timer_handler(btstack_timer_source_t * ts, void (*process)(btstack_timer_source_t * _ts)){
+    ts->process = process;
+}
+void btstack_run_loop_set_timer_context(btstack_timer_source_t * ts, void * context){
+    ts->context = context;
+}
+void * btstack_run_loop_get_timer_context(btstack_timer_source_t * ts){
+    return ts->context;
+}
+void btstack_run_loop_add_timer(btstack_timer_source_t * ts){
+    UNUSED(ts);
+}
+int btstack_run_loop_remove_timer(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    return 1;
+}
+uint32_t btstack_run_loop_get_time_ms(void){
+    return now_ms;
+}
+
+// mock l2cap
+uint16_t l2cap_max_mtu(void){
+    return L2CAP_MTU;
+}
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    UNUSED(psm);
+    UNUSED(mtu);
+    UNUSED(security_level);
+    rfcomm_l2cap_handler = packet_handler;
+    return ERROR_CODE_SUCCESS;
+}
+uint8_t l2cap_unregister_service(uint16_t psm){
+    UNUSED(psm);
+    return ERROR_CODE_SUCCESS;
+}
+uint8_t l2cap_create_channel(btstack_packet_handler_t packet_handler, bd_addr_t address, uint16_t psm, uint16_t mtu, uint16_t * out_local_cid){
+    UNUSED(psm);
+    UNUSED(mtu);
+    rfcomm_l2cap_handler = packet_handler;
+    l2cap_open_pending = 1;
+    *out_local_cid = L2CAP_CID;
+    return ERROR_CODE_SUCCESS;
+}
+void l2cap_accept_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+void l2cap_decline_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+void l2cap_disconnect(uint16_t local_cid, uint8_t reason){
+    UNUSED(local_cid);
+    UNUSED(reason);
+}
+int l2cap_can_send_packet_now(uint16_t local_cid){
+    UNUSED(local_cid);
+    return l2cap_budget > 0;
+}
+int l2cap_can_send_prepared_packet_now(uint16_t local_cid){
+    return l2cap_can_send_packet_now(local_cid);
+}
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    UNUSED(local_cid);
+    l2cap_can_send_now_requested = 1;
+}
+int l2cap_reserve_packet_buffer(void){
+    return 1;
+}
+void l2cap_release_packet_buffer(void){
+}
+uint8_t * l2cap_get_outgoing_buffer(void){
+    return l2cap_outgoing_buffer;
+}
+
+// remote device
+static void remote_queue_frame(uint8_t dlci, uint8_t control, int cr, uint8_t credits, const uint8_t * data, uint16_t len){
+    if (remote_frames_count >= MAX_REMOTE_FRAMES){
+        printf("remote frame queue full\n");
+        exit(1);
+    }
+    uint8_t * frame = remote_frames[remote_frames_count];
+    uint16_t pos = 0;
+    frame[pos++] = (dlci << 2) | (cr << 1) | 1;
+    frame[pos++] = control;
+    if (len < 128){
+        frame[pos++] = (len << 1) | 1;
+    } else {
+        frame[pos++] = (len & 0x7f) << 1;
+        frame[pos++] = len >> 7;
+    }
+    if (control == BT_RFCOMM_UIH_PF){
+        frame[pos++] = credits;
+    }
+    memcpy(&frame[pos], data, len);
+    pos += len;
+    frame[pos++] = 0;   // FCS not checked by RFCOMM
+    remote_frame_len[remote_frames_count++] = pos;
+}
+
+static void remote_handle_multiplexer_uih(const uint8_t * payload){
+    uint8_t response[10];
+    switch (payload[0]){
+        case BT_RFCOMM_PN_CMD:
+            memcpy(response, payload, 10);
+            response[0] = BT_RFCOMM_PN_RSP;
+            response[3] = 0xe0;
+            response[9] = REMOTE_INITIAL_CREDITS;
+            remote_dlci = payload[2];
+            remote_credits_granted = REMOTE_INITIAL_CREDITS;
+            remote_queue_frame(0, BT_RFCOMM_UIH, 0, 0, response, 10);
+            break;
+        case BT_RFCOMM_MSC_CMD:
+            memcpy(response, payload, 4);
+            response[0] = BT_RFCOMM_MSC_RSP;
+            remote_queue_frame(0, BT_RFCOMM_UIH, 0, 0, response, 4);
+            break;
+        default:
+            break;
+    }
+}
+
+static void remote_handle_frame(const uint8_t * frame, uint16_t size){
+    UNUSED(size);
+    uint8_t dlci    = frame[0] >> 2;
+    uint8_t control = frame[1];
+    uint16_t pos = 2;
+    uint16_t len = frame[pos++] >> 1;
+    if ((frame[2] & 1) == 0){
+        len |= frame[pos++] << 7;
+    }
+    uint8_t credits = 0;
+    if (control == BT_RFCOMM_UIH_PF){
+        credits = frame[pos++];
+    }
+    const uint8_t * payload = &frame[pos];
+
+    switch (control){
+        case BT_RFCOMM_SABM:
+            remote_queue_frame(dlci, BT_RFCOMM_UA, 1, 0, NULL, 0);
+            if (dlci){
+                uint8_t msc[4] = { BT_RFCOMM_MSC_CMD, (2 << 1) | 1, (uint8_t)((dlci << 2) | 3), 0x8d };
+                remote_queue_frame(0, BT_RFCOMM_UIH, 0, 0, msc, 4);
+            }
+            break;
+        case BT_RFCOMM_UIH:
+        case BT_RFCOMM_UIH_PF:
+            if (dlci == 0){
+                remote_handle_multiplexer_uih(payload);
+                break;
+            }
+            remote_credits += credits;
+            if (len){
+                stats_data_frames++;
+                remote_bytes_received += len;
+                remote_credits_granted--;
+            } else {
+                stats_credit_frames++;
+            }
+            // grant 10 credits if less than 5 left
+            if (remote_credits_granted < 5){
+                remote_credits_granted += 10;
+                remote_queue_frame(dlci, BT_RFCOMM_UIH_PF, 0, 10, NULL, 0);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+    UNUSED(local_cid);
+    if (l2cap_budget <= 0){
+        printf("l2cap_send_prepared without budget\n");
+        exit(1);
+    }
+    l2cap_budget--;
+    remote_handle_frame(l2cap_outgoing_buffer, len);
+    return ERROR_CODE_SUCCESS;
+}
+
+// local application
+static void send_data(void){
+    uint16_t len = btstack_min(PAYLOAD_SIZE, btstack_min(rfcomm_max_frame_size, local_bytes_to_send));
+    rfcomm_reserve_packet_buffer();
+    uint8_t * buffer = rfcomm_get_outgoing_buffer();
+    memset(buffer, 0x55, len);
+    if (rfcomm_send_prepared(rfcomm_cid, len)){
+        rfcomm_release_packet_buffer();
+        printf("rfcomm_send_prepared failed\n");
+        exit(1);
+    }
+    local_bytes_to_send -= len;
+    if (local_bytes_to_send){
+        rfcomm_request_can_send_now_event(rfcomm_cid);
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    switch (packet_type){
+        case RFCOMM_DATA_PACKET:
+            local_bytes_received += size;
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case RFCOMM_EVENT_CHANNEL_OPENED:
+                    if (rfcomm_event_channel_opened_get_status(packet)) break;
+                    rfcomm_max_frame_size = rfcomm_event_channel_opened_get_max_frame_size(packet);
+                    if (local_bytes_to_send){
+                        rfcomm_request_can_send_now_event(rfcomm_cid);
+                    }
+                    break;
+                case RFCOMM_EVENT_CAN_SEND_NOW:
+                    send_data();
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// simulation
+static void emit_l2cap_channel_opened(void){
+    uint8_t event[21];
+    memset(event, 0, sizeof(event));
+    event[0] = L2CAP_EVENT_CHANNEL_OPENED;
+    event[1] = sizeof(event) - 2;
+    reverse_bd_addr(remote_addr, &event[3]);
+    little_endian_store_16(event, 11, BLUETOOTH_PROTOCOL_RFCOMM);
+    little_endian_store_16(event, 13, L2CAP_CID);
+    little_endian_store_16(event, 17, L2CAP_MTU);
+    little_endian_store_16(event, 19, L2CAP_MTU);
+    (*rfcomm_l2cap_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void emit_l2cap_can_send_now(void){
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CAN_SEND_NOW;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 2, L2CAP_CID);
+    (*rfcomm_l2cap_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void remote_send_data(void){
+    static uint8_t frame[MAX_FRAME_LEN];
+    uint16_t len = btstack_min(PAYLOAD_SIZE, remote_bytes_to_send);
+    memset(frame, 0xaa, sizeof(frame));
+    uint16_t pos = 0;
+    frame[pos++] = (remote_dlci << 2) | 1;
+    frame[pos++] = BT_RFCOMM_UIH;
+    frame[pos++] = (len & 0x7f) << 1;
+    frame[pos++] = len >> 7;
+    pos += len;
+    frame[pos++] = 0;
+    remote_credits--;
+    remote_bytes_to_send -= len;
+    (*rfcomm_l2cap_handler)(L2CAP_DATA_PACKET, L2CAP_CID, frame, pos);
+}
+
+static void reset(const scenario_t * scenario){
+    now_ms = 0;
+    l2cap_can_send_now_requested = 0;
+    l2cap_budget = 0;
+    l2cap_open_pending = 0;
+    remote_frames_count = 0;
+    remote_dlci = 0;
+    remote_credits = 0;
+    remote_credits_granted = 0;
+    remote_bytes_received = 0;
+    remote_bytes_to_send = scenario->bytes_to_receive;
+    rfcomm_cid = 0;
+    rfcomm_max_frame_size = 0;
+    local_bytes_to_send = scenario->bytes_to_send;
+    local_bytes_received = 0;
+    stats_data_frames = 0;
+    stats_credit_frames = 0;
+    stats_can_send_now_events = 0;
+}
+
+static int run_scenario(const scenario_t * scenario){
+    reset(scenario);
+
+    rfcomm_create_channel(&packet_handler, remote_addr, SERVER_CHANNEL, &rfcomm_cid);
+
+    uint32_t start_ms = 0;
+    int opened = 0;
+    while (now_ms < MAX_TICKS){
+        l2cap_budget = scenario->local_packets_per_tick;
+
+        if (l2cap_open_pending){
+            l2cap_open_pending = 0;
+            emit_l2cap_channel_opened();
+        }
+
+        // deliver queued control frames from remote
+        int i;
+        for (i = 0; i < remote_frames_count; i++){
+            (*rfcomm_l2cap_handler)(L2CAP_DATA_PACKET, L2CAP_CID, remote_frames[i], remote_frame_len[i]);
+            // frames queued while delivering are handled in the same loop
+        }
+        remote_frames_count = 0;
+
+        // count once both sides have credits
+        if (!opened && rfcomm_max_frame_size){
+            opened = 1;
+            start_ms = now_ms;
+            stats_data_frames = 0;
+            stats_credit_frames = 0;
+            stats_can_send_now_events = 0;
+        }
+
+        // remote sends data
+        int frames = 0;
+        while (opened && remote_bytes_to_send && remote_credits && frames < scenario->remote_frames_per_tick){
+            remote_send_data();
+            frames++;
+        }
+
+        // local side sends while L2CAP can send
+        while (l2cap_can_send_now_requested && l2cap_budget > 0){
+            l2cap_can_send_now_requested = 0;
+            stats_can_send_now_events++;
+            emit_l2cap_can_send_now();
+        }
+
+        if (opened && local_bytes_to_send == 0 && remote_bytes_to_send == 0 && remote_frames_count == 0
+            && !l2cap_can_send_now_requested) break;
+        now_ms++;
+    }
+
+    uint32_t duration_ms = now_ms - start_ms;
+    uint32_t payload = remote_bytes_received + local_bytes_received;
+    double kb = payload / 1024.0;
+    printf("%-14s %8u bytes %6u ms | data frames %5u (%5.2f/KB) | credit frames %5u (%5.2f/KB) | can send now %5u (%5.2f/KB)\n",
+        scenario->name, payload, duration_ms,
+        stats_data_frames,         stats_data_frames / kb,
+        stats_credit_frames,       stats_credit_frames / kb,
+        stats_can_send_now_events, stats_can_send_now_events / kb);
+
+    if (remote_bytes_received != scenario->bytes_to_send || local_bytes_received != scenario->bytes_to_receive){
+        printf("%s: transfer incomplete, sent %u of %u, received %u of %u\n", scenario->name,
+            remote_bytes_received, scenario->bytes_to_send, local_bytes_received, scenario->bytes_to_receive);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, const char ** argv){
+    UNUSED(argc);
+    UNUSED(argv);
+
+    if (!getenv("LOG")) {
+        hci_dump_enable_log_level(LOG_LEVEL_INFO,  0);
+        hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+    }
+
+    btstack_memory_init();
+
+    int failed = 0;
+    unsigned int i;
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenario_t); i++){
+        rfcomm_init();
+        failed |= run_scenario(&scenarios[i]);
+    }
+    return failed;
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "rfcomm_lookup_benchmark.c"
+
+/*
+ * rfcomm_lookup_benchmark.c
+ *
+ * Opens a growing number of multiplexers with many outgoing channels each and measures the time
+ * to dispatch an incoming UIH data frame to its channel (lookup by l2cap_cid and DLCI) and to
+ * look up a channel by rfcomm_cid via the API. L2CAP and run loop are mocked, frames are received
+ * for channels in pseudo-random order. Fails if a frame is not delivered to the expected channel.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "bluetooth_sdp.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_util.h"
+#include "classic/rfcomm.h"
+#include "hci_dump.h"
+#include "l2cap.h"
+
+#define L2CAP_MTU             1021
+#define L2CAP_CID_BASE        0x0040
+#define MAX_MULTIPLEXERS      64
+#define MAX_SERVER_CHANNELS   30
+#define NUM_FRAMES            1000000
+
+typedef struct {
+    int num_multiplexers;
+    int channels_per_multiplexer;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {  1,  4 },
+    {  4, 16 },
+    { 16, 30 },
+    { 64, 30 },
+};
+
+static btstack_packet_handler_t rfcomm_l2cap_handler;
+static uint8_t  l2cap_outgoing_buffer[L2CAP_MTU + 10];
+static uint16_t l2cap_cid_generator;
+static int      l2cap_can_send_now_requested[MAX_MULTIPLEXERS];
+
+static uint16_t rfcomm_cids[MAX_MULTIPLEXERS][MAX_SERVER_CHANNELS];
+static uint16_t received_cid;
+static uint32_t received_frames;
+
+// mock run loop
+void btstack_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    UNUSED(ts);
+    UNUSED(timeout_in_ms);
+}
+void btstack_run_loop_set_timer_handler(btstack_timer_source_t * ts, void (*process)(btstack_timer_source_t * _ts)){
+    ts->process = process;
+}
+void btstack_run_loop_set_timer_context(btstack_timer_source_t * ts, void * context){
+    ts->context = context;
+}
+void * btstack_run_loop_get_timer_context(btstack_timer_source_t * ts){
+    return ts->context;
+}
+void btstack_run_loop_add_timer(btstack_timer_source_t * ts){
+    UNUSED(ts);
+}
+int btstack_run_loop_remove_timer(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    return 1;
+}
+uint32_t btstack_run_loop_get_time_ms(void){
+    return 0;
+}
+
+// mock l2cap
+uint16_t l2cap_max_mtu(void){
+    return L2CAP_MTU;
+}
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    UNUSED(psm);
+    UNUSED(mtu);
+    UNUSED(security_level);
+    rfcomm_l2cap_handler = packet_handler;
+    return ERROR_CODE_SUCCESS;
+}
+uint8_t l2cap_unregister_service(uint16_t psm){
+    UNUSED(psm);
+    return ERROR_CODE_SUCCESS;
+}
+uint8_t l2cap_create_channel(btstack_packet_handler_t packet_handler, bd_addr_t address, uint16_t psm, uint16_t mtu, uint16_t * out_local_cid){
+    UNUSED(psm);
+    UNUSED(mtu);
+    rfcomm_l2cap_handler = packet_handler;
+    *out_local_cid = l2cap_cid_generator++;
+    return ERROR_CODE_SUCCESS;
+}
+void l2cap_accept_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+void l2cap_decline_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+void l2cap_disconnect(uint16_t local_cid, uint8_t reason){
+    UNUSED(local_cid);
+    UNUSED(reason);
+}
+int l2cap_can_send_packet_now(uint16_t local_cid){
+    UNUSED(local_cid);
+    return 1;
+}
+int l2cap_can_send_prepared_packet_now(uint16_t local_cid){
+    UNUSED(local_cid);
+    return 1;
+}
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    l2cap_can_send_now_requested[local_cid - L2CAP_CID_BASE] = 1;
+}
+int l2cap_reserve_packet_buffer(void){
+    return 1;
+}
+void l2cap_release_packet_buffer(void){
+}
+uint8_t * l2cap_get_outgoing_buffer(void){
+    return l2cap_outgoing_buffer;
+}
+int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+    // remote doesn't respond
+    UNUSED(local_cid);
+    UNUSED(len);
+    return ERROR_CODE_SUCCESS;
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(packet);
+    UNUSED(size);
+    if (packet_type != RFCOMM_DATA_PACKET) return;
+    received_cid = channel;
+    received_frames++;
+}
+
+static void remote_addr_for_multiplexer(int multiplexer, bd_addr_t addr){
+    bd_addr_t base = { 0x00, 0x1b, 0xdc, 0x07, 0x00, 0x00 };
+    memcpy(addr, base, 6);
+    big_endian_store_16(addr, 4, multiplexer);
+}
+
+static void emit_l2cap_channel_opened(int multiplexer){
+    uint8_t event[21];
+    bd_addr_t addr;
+    memset(event, 0, sizeof(event));
+    event[0] = L2CAP_EVENT_CHANNEL_OPENED;
+    event[1] = sizeof(event) - 2;
+    remote_addr_for_multiplexer(multiplexer, addr);
+    reverse_bd_addr(addr, &event[3]);
+    little_endian_store_16(event, 11, BLUETOOTH_PROTOCOL_RFCOMM);
+    little_endian_store_16(event, 13, L2CAP_CID_BASE + multiplexer);
+    little_endian_store_16(event, 17, L2CAP_MTU);
+    little_endian_store_16(event, 19, L2CAP_MTU);
+    (*rfcomm_l2cap_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void emit_pending_can_send_now(int num_multiplexers){
+    int i;
+    for (i = 0; i < num_multiplexers; i++){
+        while (l2cap_can_send_now_requested[i]){
+            l2cap_can_send_now_requested[i] = 0;
+            uint8_t event[4];
+            event[0] = L2CAP_EVENT_CAN_SEND_NOW;
+            event[1] = sizeof(event) - 2;
+            little_endian_store_16(event, 2, L2CAP_CID_BASE + i);
+            (*rfcomm_l2cap_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+        }
+    }
+}
+
+static void receive_ua_0(int multiplexer){
+    // UA for DLCI 0 from responder: C/R = 1
+    uint8_t frame[4] = { (0 << 2) | (1 << 1) | 1, BT_RFCOMM_UA, 1, 0};
+    (*rfcomm_l2cap_handler)(L2CAP_DATA_PACKET, L2CAP_CID_BASE + multiplexer, frame, sizeof(frame));
+}
+
+static void setup(const scenario_t * scenario){
+    rfcomm_init();
+    memset(l2cap_can_send_now_requested, 0, sizeof(l2cap_can_send_now_requested));
+    l2cap_cid_generator = L2CAP_CID_BASE;
+    int i, j;
+    for (i = 0; i < scenario->num_multiplexers; i++){
+        bd_addr_t addr;
+        remote_addr_for_multiplexer(i, addr);
+        for (j = 0; j < scenario->channels_per_multiplexer; j++){
+            uint8_t status = rfcomm_create_channel(&packet_handler, addr, j + 1, &rfcomm_cids[i][j]);
+            if (status){
+                printf("rfcomm_create_channel failed, status 0x%02x\n", status);
+                exit(1);
+            }
+        }
+        // open multiplexer: L2CAP opened, send SABM #0, receive UA #0
+        emit_l2cap_channel_opened(i);
+        emit_pending_can_send_now(scenario->num_multiplexers);
+        receive_ua_0(i);
+    }
+    // let channels send PN, remote doesn't respond
+    emit_pending_can_send_now(scenario->num_multiplexers);
+}
+
+static uint32_t next_random(uint32_t * state){
+    *state = *state * 1664525 + 1013904223;
+    return *state >> 8;
+}
+
+static double now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int run_scenario(const scenario_t * scenario){
+    setup(scenario);
+
+    int num_channels = scenario->num_multiplexers * scenario->channels_per_multiplexer;
+    uint8_t frame[16];
+    uint32_t random_state = 1;
+    int i;
+
+    // dispatch incoming UIH frames with payload to channels, outgoing channel DLCI = server channel << 1
+    received_frames = 0;
+    int errors = 0;
+    double start_ns = now_ns();
+    for (i = 0; i < NUM_FRAMES; i++){
+        uint32_t r = next_random(&random_state);
+        int multiplexer = (r >> 8) % scenario->num_multiplexers;
+        int channel     = r % scenario->channels_per_multiplexer;
+        uint8_t dlci = (channel + 1) << 1;
+        frame[0] = (dlci << 2) | 1;
+        frame[1] = BT_RFCOMM_UIH;
+        frame[2] = (4 << 1) | 1;
+        memset(&frame[3], 0x55, 4);
+        frame[7] = 0;
+        (*rfcomm_l2cap_handler)(L2CAP_DATA_PACKET, L2CAP_CID_BASE + multiplexer, frame, 8);
+        if (received_cid != rfcomm_cids[multiplexer][channel]) errors++;
+    }
+    double dispatch_ns = (now_ns() - start_ns) / NUM_FRAMES;
+
+    // look up channels by rfcomm_cid
+    uint32_t sum = 0;
+    start_ns = now_ns();
+    for (i = 0; i < NUM_FRAMES; i++){
+        uint32_t r = next_random(&random_state);
+        int multiplexer = (r >> 8) % scenario->num_multiplexers;
+        int channel     = r % scenario->channels_per_multiplexer;
+        sum += rfcomm_get_max_frame_size(rfcomm_cids[multiplexer][channel]);
+    }
+    double lookup_ns = (now_ns() - start_ns) / NUM_FRAMES;
+
+    printf("%2u multiplexers, %4u channels: dispatch %6.1f ns/frame, rfcomm_cid lookup %6.1f ns\n",
+        scenario->num_multiplexers, num_channels, dispatch_ns, lookup_ns);
+
+    if (errors || received_frames != NUM_FRAMES || sum == 0){
+        printf("%u frames delivered to wrong channel, %u of %u delivered\n", errors, received_frames, NUM_FRAMES);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, const char ** argv){
+    UNUSED(argc);
+    UNUSED(argv);
+
+    hci_dump_enable_log_level(LOG_LEVEL_INFO,  0);
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+
+    btstack_memory_init();
+
+    int failed = 0;
+    unsigned int i;
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenario_t); i++){
+        failed |= run_scenario(&scenarios[i]);
+    }
+    return failed;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_spsc_ring_buffer_benchmark.c"
+
+/*
+ *  btstack_spsc_ring_buffer_benchmark.c
+ *
+ *  Compares btstack_ring_buffer with btstack_spsc_ring_buffer copy and in-place span access
+ *  in a single thread, and measures producer/consumer throughput with two threads
+ *
+ *  Usage: ./btstack_spsc_ring_buffer_benchmark [megabytes]
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_ring_buffer.h"
+#include "btstack_spsc_ring_buffer.h"
+
+#define BUFFER_SIZE 4096
+#define MAX_CHUNK   512
+
+static uint8_t storage[BUFFER_SIZE];
+static uint8_t chunk_data[MAX_CHUNK];
+static uint8_t chunk_buffer[MAX_CHUNK];
+static uint32_t num_bytes;
+
+static btstack_spsc_ring_buffer_t spsc_ring_buffer;
+static uint32_t thread_chunk_size;
+
+static double time_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char * name, uint32_t chunk_size, double duration){
+    printf("%-26s chunk %3u: %8.1f MB/s, %6.1f ns/chunk\n", name, chunk_size,
+        num_bytes / duration / 1e6, duration * 1e9 / (num_bytes / chunk_size));
+}
+
+static void benchmark_ring_buffer(uint32_t chunk_size){
+    btstack_ring_buffer_t ring_buffer;
+    btstack_ring_buffer_init(&ring_buffer, storage, sizeof(storage));
+    uint32_t num_chunks = num_bytes / chunk_size;
+    double start = time_s();
+    uint32_t i;
+    for (i=0;i<num_chunks;i++){
+        uint32_t bytes_read;
+        btstack_ring_buffer_write(&ring_buffer, chunk_data, chunk_size);
+        btstack_ring_buffer_read(&ring_buffer, chunk_buffer, chunk_size, &bytes_read);
+    }
+    report("btstack_ring_buffer", chunk_size, time_s() - start);
+}
+
+static void benchmark_spsc_copy(uint32_t chunk_size){
+    btstack_spsc_ring_buffer_init(&spsc_ring_buffer, storage, sizeof(storage));
+    uint32_t num_chunks = num_bytes / chunk_size;
+    double start = time_s();
+    uint32_t i;
+    for (i=0;i<num_chunks;i++){
+        btstack_spsc_ring_buffer_write(&spsc_ring_buffer, chunk_data, chunk_size);
+        btstack_spsc_ring_buffer_read(&spsc_ring_buffer, chunk_buffer, chunk_size);
+    }
+    report("spsc write/read", chunk_size, time_s() - start);
+}
+
+static void benchmark_spsc_spans(uint32_t chunk_size){
+    btstack_spsc_ring_buffer_init(&spsc_ring_buffer, storage, sizeof(storage));
+    btstack_spsc_ring_buffer_span_t span;
+    uint32_t num_chunks = num_bytes / chunk_size;
+    uint32_t checksum = 0;
+    double start = time_s();
+    uint32_t i;
+    for (i=0;i<num_chunks;i++){
+        // produce in place
+        uint32_t len = btstack_spsc_ring_buffer_reserve(&spsc_ring_buffer, &span, chunk_size);
+        memset(span.data[0], (uint8_t) i, span.len[0]);
+        memset(span.data[1], (uint8_t) i, span.len[1]);
+        btstack_spsc_ring_buffer_commit(&spsc_ring_buffer, len);
+        // consume in place
+        len = btstack_spsc_ring_buffer_peek(&spsc_ring_buffer, &span, chunk_size);
+        checksum += span.data[0][0];
+        btstack_spsc_ring_buffer_consume(&spsc_ring_buffer, len);
+    }
+    report("spsc reserve/peek", chunk_size, time_s() - start);
+    if (checksum == 0xffffffff) printf("checksum %u\n", checksum);
+}
+
+static void * producer_thread(void * context){
+    (void) context;
+    uint32_t written = 0;
+    while (written < num_bytes){
+        uint32_t len = btstack_spsc_ring_buffer_write(&spsc_ring_buffer, chunk_data, thread_chunk_size);
+        written += len;
+        if (len == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static void * consumer_thread(void * context){
+    (void) context;
+    uint32_t read = 0;
+    while (read < num_bytes){
+        uint32_t len = btstack_spsc_ring_buffer_read(&spsc_ring_buffer, chunk_buffer, thread_chunk_size);
+        read += len;
+        if (len == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static void benchmark_spsc_threads(uint32_t chunk_size){
+    btstack_spsc_ring_buffer_init(&spsc_ring_buffer, storage, sizeof(storage));
+    thread_chunk_size = chunk_size;
+    pthread_t producer;
+    pthread_t consumer;
+    double start = time_s();
+    pthread_create(&producer, NULL, &producer_thread, NULL);
+    pthread_create(&consumer, NULL, &consumer_thread, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    report("spsc producer/consumer", chunk_size, time_s() - start);
+}
+
+int main(int argc, const char * argv[]){
+    uint32_t megabytes = 256;
+    if (argc > 1){
+        megabytes = atoi(argv[1]);
+    }
+    num_bytes = megabytes * 1024 * 1024;
+    memset(chunk_data, 0x55, sizeof(chunk_data));
+
+    const uint32_t chunk_sizes[] = { 4, 64, 512 };
+    unsigned int i;
+    for (i=0;i<sizeof(chunk_sizes)/sizeof(uint32_t);i++){
+        benchmark_ring_buffer(chunk_sizes[i]);
+        benchmark_spsc_copy(chunk_sizes[i]);
+        benchmark_spsc_spans(chunk_sizes[i]);
+        benchmark_spsc_threads(chunk_sizes[i]);
+    }
+    return 0;
+}
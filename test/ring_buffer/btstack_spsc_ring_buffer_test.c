@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_spsc_ring_buffer_test.c
+ *
+ *  Functional test and producer/consumer stress test, also built with ThreadSanitizer via 'make tsan'
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_spsc_ring_buffer.h"
+
+#define STRESS_BUFFER_SIZE 256
+#define STRESS_MAX_CHUNK   100
+
+#ifndef STRESS_NUM_MEGABYTES
+#define STRESS_NUM_MEGABYTES 16
+#endif
+
+TEST_GROUP(SPSCRingBuffer){
+    btstack_spsc_ring_buffer_t ring_buffer;
+    btstack_spsc_ring_buffer_span_t span;
+};
+
+TEST(SPSCRingBuffer, Init){
+    uint8_t storage[100];
+    CHECK_EQUAL(64, btstack_spsc_ring_buffer_init(&ring_buffer, storage, sizeof(storage)));
+    CHECK_EQUAL(64, btstack_spsc_ring_buffer_init(&ring_buffer, storage, 64));
+    CHECK_EQUAL(1,  btstack_spsc_ring_buffer_init(&ring_buffer, storage, 1));
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_init(&ring_buffer, storage, 0));
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_bytes_available(&ring_buffer));
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_bytes_free(&ring_buffer));
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_write(&ring_buffer, storage, 10));
+}
+
+TEST(SPSCRingBuffer, Spans){
+    uint8_t storage[16];
+    uint8_t data[16];
+    uint8_t buffer[16];
+    int i;
+    for (i=0;i<16;i++){
+        data[i] = i;
+    }
+    btstack_spsc_ring_buffer_init(&ring_buffer, storage, sizeof(storage));
+
+    // fill buffer completely
+    CHECK_EQUAL(16, btstack_spsc_ring_buffer_write(&ring_buffer, data, 20));
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_bytes_free(&ring_buffer));
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_reserve(&ring_buffer, &span, 4));
+    CHECK_EQUAL(16, btstack_spsc_ring_buffer_read(&ring_buffer, buffer, 16));
+    CHECK_EQUAL(0,  memcmp(data, buffer, 16));
+
+    // read index at 10, write index at 12
+    CHECK_EQUAL(12, btstack_spsc_ring_buffer_write(&ring_buffer, data, 12));
+    CHECK_EQUAL(10, btstack_spsc_ring_buffer_read(&ring_buffer, buffer, 10));
+
+    // reserve wraps around end of storage
+    CHECK_EQUAL(8,  btstack_spsc_ring_buffer_reserve(&ring_buffer, &span, 8));
+    CHECK_EQUAL(4,  span.len[0]);
+    CHECK_EQUAL(4,  span.len[1]);
+    memcpy(span.data[0], &data[12], 4);
+    memcpy(span.data[1], &data[0], 4);
+    btstack_spsc_ring_buffer_commit(&ring_buffer, 8);
+    CHECK_EQUAL(10, btstack_spsc_ring_buffer_bytes_available(&ring_buffer));
+
+    // peek returns two regions
+    CHECK_EQUAL(10, btstack_spsc_ring_buffer_peek(&ring_buffer, &span, 100));
+    CHECK_EQUAL(6,  span.len[0]);
+    CHECK_EQUAL(4,  span.len[1]);
+    CHECK_EQUAL(0,  memcmp(span.data[0], &data[10], 6));
+    CHECK_EQUAL(0,  memcmp(span.data[1], &data[0], 4));
+
+    // partial consume
+    btstack_spsc_ring_buffer_consume(&ring_buffer, 7);
+    CHECK_EQUAL(3,  btstack_spsc_ring_buffer_peek(&ring_buffer, &span, 100));
+    CHECK_EQUAL(3,  span.len[0]);
+    CHECK_EQUAL(0,  span.len[1]);
+    CHECK_EQUAL(1,  span.data[0][0]);
+
+    btstack_spsc_ring_buffer_reset(&ring_buffer);
+    CHECK_EQUAL(0,  btstack_spsc_ring_buffer_bytes_available(&ring_buffer));
+    CHECK_EQUAL(16, btstack_spsc_ring_buffer_bytes_free(&ring_buffer));
+}
+
+// stress test: producer writes running counter, consumer verifies it
+static btstack_spsc_ring_buffer_t stress_ring_buffer;
+static uint8_t stress_storage[STRESS_BUFFER_SIZE];
+static const uint32_t stress_num_bytes = STRESS_NUM_MEGABYTES * 1024 * 1024;
+
+static uint32_t next_random(uint32_t * seed){
+    *seed = *seed * 1103515245 + 12345;
+    return (*seed >> 16) & 0x7fff;
+}
+
+static void * stress_producer(void * context){
+    (void) context;
+    uint32_t seed = 1;
+    uint32_t counter = 0;
+    while (counter < stress_num_bytes){
+        uint32_t chunk = 1 + next_random(&seed) % STRESS_MAX_CHUNK;
+        chunk = chunk < stress_num_bytes - counter ? chunk : stress_num_bytes - counter;
+        if (next_random(&seed) & 1){
+            btstack_spsc_ring_buffer_span_t span;
+            uint32_t len = btstack_spsc_ring_buffer_reserve(&stress_ring_buffer, &span, chunk);
+            uint32_t i;
+            int j;
+            for (j=0;j<2;j++){
+                for (i=0;i<span.len[j];i++){
+                    span.data[j][i] = (uint8_t) counter++;
+                }
+            }
+            btstack_spsc_ring_buffer_commit(&stress_ring_buffer, len);
+            if (len == 0) sched_yield();
+        } else {
+            uint8_t data[STRESS_MAX_CHUNK];
+            uint32_t i;
+            for (i=0;i<chunk;i++){
+                data[i] = (uint8_t) (counter + i);
+            }
+            uint32_t len = btstack_spsc_ring_buffer_write(&stress_ring_buffer, data, chunk);
+            counter += len;
+            if (len == 0) sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void * stress_consumer(void * context){
+    (void) context;
+    uint32_t seed = 2;
+    uint32_t counter = 0;
+    uint32_t errors = 0;
+    while (counter < stress_num_bytes){
+        uint32_t chunk = 1 + next_random(&seed) % STRESS_MAX_CHUNK;
+        uint32_t i;
+        if (next_random(&seed) & 1){
+            btstack_spsc_ring_buffer_span_t span;
+            uint32_t len = btstack_spsc_ring_buffer_peek(&stress_ring_buffer, &span, chunk);
+            int j;
+            for (j=0;j<2;j++){
+                for (i=0;i<span.len[j];i++){
+                    if (span.data[j][i] != (uint8_t) counter) errors++;
+                    counter++;
+                }
+            }
+            btstack_spsc_ring_buffer_consume(&stress_ring_buffer, len);
+            if (len == 0) sched_yield();
+        } else {
+            uint8_t buffer[STRESS_MAX_CHUNK];
+            uint32_t len = btstack_spsc_ring_buffer_read(&stress_ring_buffer, buffer, chunk);
+            for (i=0;i<len;i++){
+                if (buffer[i] != (uint8_t) counter) errors++;
+                counter++;
+            }
+            if (len == 0) sched_yield();
+        }
+    }
+    return (void *)(uintptr_t) errors;
+}
+
+TEST_GROUP(SPSCRingBufferStress){
+};
+
+TEST(SPSCRingBufferStress, ProducerConsumer){
+    btstack_spsc_ring_buffer_init(&stress_ring_buffer, stress_storage, sizeof(stress_storage));
+    pthread_t producer;
+    pthread_t consumer;
+    void * errors;
+    pthread_create(&producer, NULL, &stress_producer, NULL);
+    pthread_create(&consumer, NULL, &stress_consumer, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, &errors);
+    CHECK_EQUAL(0, (uintptr_t) errors);
+    CHECK_EQUAL(0, btstack_spsc_ring_buffer_bytes_available(&stress_ring_buffer));
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
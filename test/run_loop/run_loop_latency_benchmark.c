@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "run_loop_latency_benchmark.c"
+
+/*
+ *  run_loop_latency_benchmark.c
+ *
+ *  Measures latency from posting a callback on another thread until it is executed on the run loop thread,
+ *  using btstack_run_loop_execute_on_main_thread and, for comparison, polling a shared counter from a timer
+ *
+ *  Usage: ./run_loop_latency_benchmark [samples]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+
+#define MAX_SAMPLES       10000
+#define POST_INTERVAL_US  500
+#define POLL_INTERVAL_MS  10
+#define BURST_SIZE        1000
+
+static uint32_t num_samples;
+
+static double post_time_us[MAX_SAMPLES];
+static double latency_us[MAX_SAMPLES];
+static uint32_t num_executed;
+
+static btstack_context_callback_registration_t registrations[MAX_SAMPLES];
+
+// polled baseline
+static btstack_timer_source_t poll_timer;
+static uint32_t num_polled_posted;
+
+static double burst_start_us;
+
+static double time_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void sleep_us(uint32_t us){
+    struct timespec ts;
+    ts.tv_sec  = 0;
+    ts.tv_nsec = us * 1000;
+    nanosleep(&ts, NULL);
+}
+
+static int compare_double(const void * a, const void * b){
+    double da = *(const double *) a;
+    double db = *(const double *) b;
+    return (da > db) - (da < db);
+}
+
+static void report(const char * name){
+    double sum = 0;
+    uint32_t i;
+    for (i=0;i<num_samples;i++){
+        sum += latency_us[i];
+    }
+    qsort(latency_us, num_samples, sizeof(double), &compare_double);
+    printf("%-22s samples %5u: min %8.1f, avg %8.1f, p50 %8.1f, p99 %8.1f, max %8.1f us\n", name, num_samples,
+        latency_us[0], sum / num_samples, latency_us[num_samples / 2], latency_us[num_samples * 99 / 100], latency_us[num_samples - 1]);
+}
+
+static void start_burst(void);
+static void start_polled(void);
+
+// burst: post all callbacks back-to-back, measures throughput of the queue
+
+static void burst_callback(void * context){
+    UNUSED(context);
+    num_executed++;
+    if (num_executed < BURST_SIZE) return;
+    double duration_us = time_us() - burst_start_us;
+    printf("%-22s callbacks %4u: %8.1f us total, %6.3f us/callback\n", "burst", BURST_SIZE, duration_us, duration_us / BURST_SIZE);
+    exit(0);
+}
+
+static void * burst_thread(void * context){
+    UNUSED(context);
+    burst_start_us = time_us();
+    uint32_t i;
+    for (i=0;i<BURST_SIZE;i++){
+        registrations[i].callback = &burst_callback;
+        registrations[i].context  = NULL;
+        btstack_run_loop_execute_on_main_thread(&registrations[i]);
+    }
+    return NULL;
+}
+
+static void start_burst(void){
+    num_executed = 0;
+    pthread_t thread;
+    pthread_create(&thread, NULL, &burst_thread, NULL);
+    pthread_detach(thread);
+}
+
+// polled: poster only updates shared state, run loop checks it from a periodic timer
+
+static void poll_timer_handler(btstack_timer_source_t * ts){
+    uint32_t posted = __atomic_load_n(&num_polled_posted, __ATOMIC_ACQUIRE);
+    double now_us = time_us();
+    while (num_executed < posted){
+        latency_us[num_executed] = now_us - post_time_us[num_executed];
+        num_executed++;
+    }
+    if (num_executed == num_samples){
+        report("timer poll (10 ms)");
+        start_burst();
+        return;
+    }
+    btstack_run_loop_set_timer(ts, POLL_INTERVAL_MS);
+    btstack_run_loop_add_timer(ts);
+}
+
+static void * polled_thread(void * context){
+    UNUSED(context);
+    uint32_t i;
+    for (i=0;i<num_samples;i++){
+        sleep_us(POST_INTERVAL_US);
+        post_time_us[i] = time_us();
+        __atomic_store_n(&num_polled_posted, i + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void start_polled(void){
+    num_executed = 0;
+    num_polled_posted = 0;
+    btstack_run_loop_set_timer_handler(&poll_timer, &poll_timer_handler);
+    btstack_run_loop_set_timer(&poll_timer, POLL_INTERVAL_MS);
+    btstack_run_loop_add_timer(&poll_timer);
+    pthread_t thread;
+    pthread_create(&thread, NULL, &polled_thread, NULL);
+    pthread_detach(thread);
+}
+
+// posted: each callback is posted with btstack_run_loop_execute_on_main_thread
+
+static void posted_callback(void * context){
+    uint32_t index = (uint32_t)(uintptr_t) context;
+    latency_us[index] = time_us() - post_time_us[index];
+    num_executed++;
+    if (num_executed < num_samples) return;
+    report("execute_on_main_thread");
+    start_polled();
+}
+
+static void * posted_thread(void * context){
+    UNUSED(context);
+    uint32_t i;
+    for (i=0;i<num_samples;i++){
+        sleep_us(POST_INTERVAL_US);
+        registrations[i].callback = &posted_callback;
+        registrations[i].context  = (void *)(uintptr_t) i;
+        post_time_us[i] = time_us();
+        btstack_run_loop_execute_on_main_thread(&registrations[i]);
+    }
+    return NULL;
+}
+
+int main(int argc, const char * argv[]){
+    num_samples = 2000;
+    if (argc > 1){
+        num_samples = atoi(argv[1]);
+    }
+    if (num_samples < 1 || num_samples > MAX_SAMPLES){
+        printf("samples must be in 1..%u\n", MAX_SAMPLES);
+        return 1;
+    }
+
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, &posted_thread, NULL);
+    pthread_detach(thread);
+
+    btstack_run_loop_execute();
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "a2dp_sink_media_engine_test.c"
+
+/*
+ * a2dp_sink_media_engine_test.c
+ *
+ * Simulates an A2DP stream with source clock drift and packet arrival jitter and checks that
+ * the A2DP Sink media engine estimates the drift and plays without underruns or overflows.
+ *
+ * Usage: ./a2dp_sink_media_engine_test [seconds]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "btstack_util.h"
+#include "classic/a2dp_sink_media_engine.h"
+#include "classic/btstack_sbc.h"
+
+#define SAMPLE_RATE 44100
+#define SBC_FRAMES_PER_PACKET 5
+#define MAX_JITTER_MS 30
+#define NUM_JITTER_BUFFER_FRAMES 128
+#define MAX_QUEUED_PACKETS 64
+#define MAX_PACKET_SIZE 1000
+
+typedef struct {
+    uint32_t delivery_ms;
+    uint16_t len;
+    uint8_t  data[MAX_PACKET_SIZE];
+} packet_t;
+
+static uint32_t sim_time_ms;
+static packet_t packets[MAX_QUEUED_PACKETS];
+static int packets_head;
+static int packets_count;
+
+static uint8_t jitter_buffer_storage[A2DP_SINK_MEDIA_ENGINE_STORAGE_SIZE(NUM_JITTER_BUFFER_FRAMES)];
+static a2dp_sink_media_engine_t engine;
+static btstack_sbc_encoder_state_t encoder_state;
+
+// simulated time instead of btstack_run_loop.c
+uint32_t btstack_run_loop_get_time_ms(void){
+    return sim_time_ms;
+}
+
+static void queue_packet(uint32_t rtp_timestamp, uint16_t sequence_number, double * phase){
+    packet_t * packet = &packets[(packets_head + packets_count) % MAX_QUEUED_PACKETS];
+    if (packets_count == MAX_QUEUED_PACKETS){
+        printf("packet queue full\n");
+        exit(10);
+    }
+    // RTP header
+    packet->data[0] = 0x80;
+    packet->data[1] = 0x60;
+    big_endian_store_16(packet->data, 2, sequence_number);
+    big_endian_store_32(packet->data, 4, rtp_timestamp);
+    big_endian_store_32(packet->data, 8, 0x1234);
+    packet->data[12] = SBC_FRAMES_PER_PACKET;
+    int pos = 13;
+    int i;
+    for (i=0;i<SBC_FRAMES_PER_PACKET;i++){
+        int16_t pcm[16 * 8 * 2];
+        int num_audio_frames = btstack_sbc_encoder_num_audio_frames();
+        int j;
+        for (j=0;j<num_audio_frames;j++){
+            int16_t value = (int16_t) (8000.0 * sin(*phase));
+            pcm[j*2]   = value;
+            pcm[j*2+1] = value;
+            *phase += 2.0 * M_PI * 440.0 / SAMPLE_RATE;
+        }
+        btstack_sbc_encoder_process_data(pcm);
+        memcpy(&packet->data[pos], btstack_sbc_encoder_sbc_buffer(), btstack_sbc_encoder_sbc_buffer_length());
+        pos += btstack_sbc_encoder_sbc_buffer_length();
+    }
+    packet->len = pos;
+
+    // random delay, but keep packet order
+    uint32_t delivery_ms = sim_time_ms + (rand() % MAX_JITTER_MS);
+    if (packets_count){
+        packet_t * previous = &packets[(packets_head + packets_count - 1) % MAX_QUEUED_PACKETS];
+        if (delivery_ms < previous->delivery_ms){
+            delivery_ms = previous->delivery_ms;
+        }
+    }
+    packet->delivery_ms = delivery_ms;
+    packets_count++;
+}
+
+static int run_test(int seconds, int drift_ppm){
+    memset(packets, 0, sizeof(packets));
+    packets_head = 0;
+    packets_count = 0;
+    sim_time_ms = 0;
+    srand(drift_ppm + 1000);
+
+    btstack_sbc_encoder_init(&encoder_state, SBC_MODE_STANDARD, 16, 8, 0, SAMPLE_RATE, 53, 3);
+    a2dp_sink_media_engine_init(&engine, jitter_buffer_storage, sizeof(jitter_buffer_storage));
+    a2dp_sink_media_engine_start(&engine);
+
+    int samples_per_packet = SBC_FRAMES_PER_PACKET * btstack_sbc_encoder_num_audio_frames();
+    double source_rate = SAMPLE_RATE * (1.0 + drift_ppm / 1000000.0);
+    double phase = 0;
+    uint32_t rtp_timestamp = 0;
+    uint16_t sequence_number = 0;
+    uint32_t audio_frames_played = 0;
+    uint32_t underruns_after_start = 0;
+    uint32_t concealed_after_start = 0;
+
+    a2dp_sink_media_engine_stats_t stats;
+    int16_t pcm[2 * (SAMPLE_RATE / 1000 + 1)];
+    uint32_t total_ms = seconds * 1000;
+    uint32_t settle_ms = total_ms / 2;
+    for (sim_time_ms = 0; sim_time_ms < total_ms; sim_time_ms++){
+        // source sends packet when enough audio has been produced at its clock
+        while (rtp_timestamp + samples_per_packet <= (uint32_t) (sim_time_ms * source_rate / 1000.0)){
+            queue_packet(rtp_timestamp, sequence_number++, &phase);
+            rtp_timestamp += samples_per_packet;
+        }
+        // deliver packets
+        while (packets_count && packets[packets_head].delivery_ms <= sim_time_ms){
+            a2dp_sink_media_engine_handle_media_packet(&engine, packets[packets_head].data, packets[packets_head].len);
+            packets_head = (packets_head + 1) % MAX_QUEUED_PACKETS;
+            packets_count--;
+        }
+        // audio output consumes audio at exact sample rate
+        uint32_t target_played = (uint32_t)(((uint64_t) (sim_time_ms + 1)) * SAMPLE_RATE / 1000);
+        int num_audio_frames = target_played - audio_frames_played;
+        a2dp_sink_media_engine_read_pcm(&engine, pcm, num_audio_frames);
+        audio_frames_played += num_audio_frames;
+
+        if (sim_time_ms == settle_ms){
+            a2dp_sink_media_engine_get_stats(&engine, &stats);
+            underruns_after_start = stats.num_underruns;
+            concealed_after_start = stats.num_frames_concealed;
+        }
+    }
+
+    a2dp_sink_media_engine_get_stats(&engine, &stats);
+    printf("drift %+5d ppm: estimated %+5d ppm, fill %3u ms, target %3u ms, jitter %2u ms, received %u, late %u, overflow %u, concealed %u, underruns %u\n",
+        drift_ppm, (int) stats.drift_ppm, stats.fill_level_ms, stats.target_latency_ms, stats.jitter_ms,
+        stats.num_frames_received, stats.num_frames_late, stats.num_frames_overflow, stats.num_frames_concealed, stats.num_underruns);
+
+    int ok = 1;
+    if (abs((int) stats.drift_ppm - drift_ppm) > 50){
+        printf("- FAIL: drift estimate off by more than 50 ppm\n");
+        ok = 0;
+    }
+    if (stats.num_underruns != underruns_after_start || stats.num_frames_concealed != concealed_after_start){
+        printf("- FAIL: underrun or concealed frames after settling\n");
+        ok = 0;
+    }
+    if (stats.num_frames_overflow || stats.num_frames_late){
+        printf("- FAIL: jitter buffer overflow or late frames\n");
+        ok = 0;
+    }
+    if (abs((int) stats.fill_level_ms - (int) stats.target_latency_ms) > 20){
+        printf("- FAIL: fill level not at target latency\n");
+        ok = 0;
+    }
+    return ok;
+}
+
+int main(int argc, const char * argv[]){
+    int seconds = 120;
+    if (argc > 1){
+        seconds = atoi(argv[1]);
+    }
+    const int drifts_ppm[] = { 0, 100, -100, 300, -300, 800, -800 };
+    int failures = 0;
+    unsigned int i;
+    for (i=0;i<sizeof(drifts_ppm)/sizeof(int);i++){
+        if (!run_test(seconds, drifts_ppm[i])){
+            failures++;
+        }
+    }
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
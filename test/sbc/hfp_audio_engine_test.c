@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "hfp_audio_engine_test.c"
+
+/*
+ * hfp_audio_engine_test.c
+ *
+ * Runs several mSBC streams through separate HFP audio engine instances in SCO loopback, 
+ * with packets of all streams interleaved. Checks that each stream decodes bit-exact to the 
+ * same stream processed alone, that H2 sync survives lost packets and that bridging works.
+ * Reports CPU time per stream.
+ *
+ * Usage: ./hfp_audio_engine_test [seconds]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "btstack_util.h"
+#include "classic/hfp.h"
+#include "classic/hfp_audio_engine.h"
+
+#define NUM_STREAMS 4
+#define MSBC_SAMPLE_RATE 16000
+#define SCO_PAYLOAD_SIZE 24
+#define SCO_PACKET_INTERVAL_US 3000
+#define MAX_SAMPLES (MSBC_SAMPLE_RATE * 30)
+
+typedef struct {
+    hfp_audio_engine_t engine;
+    int      frequency;
+    uint32_t phase;
+    int16_t  * output;
+    int      num_output;
+    double   energy;
+    uint64_t cpu_ns;
+} stream_t;
+
+static stream_t streams[NUM_STREAMS];
+static int16_t  reference[NUM_STREAMS][MAX_SAMPLES];
+static int16_t  interleaved[NUM_STREAMS][MAX_SAMPLES];
+static int      num_reference[NUM_STREAMS];
+
+static int failures;
+
+static uint64_t cpu_time_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void check(int condition, const char * message){
+    if (condition) return;
+    printf("FAIL: %s\n", message);
+    failures++;
+}
+
+static void handle_pcm(hfp_audio_engine_t * engine, int16_t * samples, int num_samples, int sample_rate, void * context){
+    UNUSED(engine);
+    UNUSED(sample_rate);
+    stream_t * stream = (stream_t *) context;
+    int i;
+    for (i=0;i<num_samples;i++){
+        stream->energy += (double) samples[i] * samples[i];
+        if (stream->output && stream->num_output < MAX_SAMPLES){
+            stream->output[stream->num_output++] = samples[i];
+        }
+    }
+}
+
+static void stream_provide_audio(stream_t * stream){
+    // keep one mSBC frame queued
+    int16_t samples[HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME];
+    int num_samples = btstack_ring_buffer_bytes_free(&stream->engine.tx_pcm_buffer) / 2;
+    if (num_samples > HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME) {
+        num_samples = HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME;
+    }
+    int i;
+    for (i=0;i<num_samples;i++){
+        samples[i] = (int16_t) (8000.0 * sin(2.0 * M_PI * stream->frequency * stream->phase++ / MSBC_SAMPLE_RATE));
+    }
+    hfp_audio_engine_write_pcm(&stream->engine, samples, num_samples);
+}
+
+static void stream_init(stream_t * stream, int index, int16_t * output){
+    memset(stream, 0, sizeof(stream_t));
+    stream->frequency = 300 + index * 200;
+    stream->output = output;
+    hfp_audio_engine_init(&stream->engine, &handle_pcm, stream);
+    hfp_audio_engine_start(&stream->engine, 0x100 + index, HFP_CODEC_MSBC);
+}
+
+// send one SCO packet and receive it again, lost packets are delivered with 'no data' packet status
+static void stream_loopback_packet(stream_t * stream, int lost){
+    uint8_t packet[3 + SCO_PAYLOAD_SIZE];
+    uint64_t start = cpu_time_ns();
+    stream_provide_audio(stream);
+    little_endian_store_16(packet, 0, stream->engine.sco_handle | (lost ? 0x2000 : 0));
+    packet[2] = SCO_PAYLOAD_SIZE;
+    hfp_audio_engine_fill_sco_payload(&stream->engine, &packet[3], SCO_PAYLOAD_SIZE);
+    if (lost){
+        memset(&packet[3], 0, SCO_PAYLOAD_SIZE);
+    }
+    hfp_audio_engine_receive_sco_packet(&stream->engine, packet, sizeof(packet));
+    stream->cpu_ns += cpu_time_ns() - start;
+}
+
+static void test_isolation(int num_packets){
+    int i, p;
+
+    // reference: each stream alone
+    for (i=0;i<NUM_STREAMS;i++){
+        stream_init(&streams[i], i, reference[i]);
+        for (p=0;p<num_packets;p++){
+            stream_loopback_packet(&streams[i], 0);
+        }
+        num_reference[i] = streams[i].num_output;
+        hfp_audio_engine_stop(&streams[i].engine);
+    }
+
+    // all streams interleaved packet by packet
+    for (i=0;i<NUM_STREAMS;i++){
+        stream_init(&streams[i], i, interleaved[i]);
+    }
+    for (i=0;i<NUM_STREAMS;i++){
+        check(hfp_audio_engine_for_sco_handle(0x100 + i) == &streams[i].engine, "lookup by SCO handle");
+    }
+    for (p=0;p<num_packets;p++){
+        for (i=0;i<NUM_STREAMS;i++){
+            stream_loopback_packet(&streams[i], 0);
+        }
+    }
+
+    double audio_ns = (double) num_packets * SCO_PACKET_INTERVAL_US * 1000.0;
+    printf("%d mSBC streams, %.1f s audio each\n", NUM_STREAMS, audio_ns / 1e9);
+    printf("stream  freq  encoded  decoded  concealed  h2 errors  CPU/frame  CPU load\n");
+    for (i=0;i<NUM_STREAMS;i++){
+        stream_t * stream = &streams[i];
+        hfp_audio_engine_stats_t stats;
+        hfp_audio_engine_get_stats(&stream->engine, &stats);
+        double cpu_per_frame_us = stats.frames_encoded ? stream->cpu_ns / 1000.0 / stats.frames_encoded : 0;
+        printf("%6d  %4d  %7u  %7u  %9u  %9u  %6.1f us  %6.3f %%\n", i, stream->frequency, 
+            stats.frames_encoded, stats.frames_decoded, stats.frames_concealed, stats.h2_sync_lost + stats.h2_sequence_errors,
+            cpu_per_frame_us, 100.0 * stream->cpu_ns / audio_ns);
+
+        check(stream->num_output == num_reference[i], "interleaved stream decodes same number of samples");
+        check(memcmp(interleaved[i], reference[i], stream->num_output * sizeof(int16_t)) == 0, "interleaved stream bit-exact to isolated stream");
+        check(stats.frames_concealed == 0, "no concealed frames without loss");
+        check(stats.h2_sync_lost == 0 && stats.h2_sequence_errors == 0, "no H2 errors without loss");
+        check(stats.tx_underruns == 0, "no tx underruns");
+        check(stream->num_output > 0 && stream->energy / stream->num_output > 1e6, "decoded audio not silent");
+        hfp_audio_engine_stop(&stream->engine);
+    }
+}
+
+static void test_packet_loss(int num_packets){
+    stream_t * stream = &streams[0];
+    stream_init(stream, 0, NULL);
+    int p;
+    for (p=0;p<num_packets;p++){
+        stream_loopback_packet(stream, p > 100 && (p % 50) == 0);
+    }
+    hfp_audio_engine_stats_t stats;
+    hfp_audio_engine_get_stats(&stream->engine, &stats);
+    printf("packet loss: decoded %u, concealed %u, sync lost %u, sequence errors %u\n", 
+        stats.frames_decoded, stats.frames_concealed, stats.h2_sync_lost, stats.h2_sequence_errors);
+    check(stats.frames_concealed > 0, "lost packets concealed");
+    check(stats.h2_sync_lost == 0, "H2 sync kept on reported packet loss");
+    check(stats.frames_decoded + stats.frames_concealed + 2 >= stats.frames_encoded, "all frames decoded or concealed");
+    hfp_audio_engine_stop(&stream->engine);
+}
+
+static void test_bridge(int num_packets){
+    // mSBC call in loopback bridged to CVSD call without local audio
+    stream_t * msbc = &streams[0];
+    stream_t * cvsd = &streams[1];
+    stream_init(msbc, 0, NULL);
+    memset(cvsd, 0, sizeof(stream_t));
+    hfp_audio_engine_init(&cvsd->engine, NULL, NULL);
+    hfp_audio_engine_start(&cvsd->engine, 0x200, HFP_CODEC_CVSD);
+    hfp_audio_engine_bridge(&msbc->engine, &cvsd->engine);
+
+    uint8_t payload[48];
+    double energy = 0;
+    int p, i;
+    for (p=0;p<num_packets;p++){
+        stream_loopback_packet(msbc, 0);
+        if (p % 4 == 0){
+            hfp_audio_engine_fill_sco_payload(&cvsd->engine, payload, sizeof(payload));
+            for (i=0;i<24;i++){
+                int16_t sample = (int16_t) little_endian_read_16(payload, i * 2);
+                energy += (double) sample * sample;
+            }
+        }
+    }
+    printf("bridge: CVSD call energy %.0f\n", energy);
+    check(energy > 0, "bridged audio forwarded to CVSD call");
+    hfp_audio_engine_stop(&msbc->engine);
+    check(cvsd->engine.bridge == NULL, "stop removes bridge");
+    hfp_audio_engine_stop(&cvsd->engine);
+}
+
+int main(int argc, const char * argv[]){
+    int seconds = 10;
+    if (argc > 1){
+        seconds = atoi(argv[1]);
+    }
+    int num_packets = seconds * 1000000 / SCO_PACKET_INTERVAL_US;
+    if (num_packets * SCO_PAYLOAD_SIZE / HFP_AUDIO_ENGINE_MSBC_STREAM_FRAME_SIZE * HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME >= MAX_SAMPLES){
+        num_packets = MAX_SAMPLES / HFP_AUDIO_ENGINE_MSBC_SAMPLES_PER_FRAME * HFP_AUDIO_ENGINE_MSBC_STREAM_FRAME_SIZE / SCO_PAYLOAD_SIZE - 1;
+    }
+
+    test_isolation(num_packets);
+    test_packet_loss(num_packets);
+    test_bridge(500);
+
+    if (failures){
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
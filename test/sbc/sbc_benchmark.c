@@ -0,0 +1,532 @@
+/*
+ * Copyright (C) 2014 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+// *****************************************************************************
+//
+// SBC, mSBC and CVSD PLC benchmark and conformance test
+//
+// Usage:
+//   ./sbc_benchmark [num_frames]        - benchmark all codec configurations
+//   ./sbc_benchmark -c [data_dir]       - check against reference vectors
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "btstack.h"
+#include "btstack_sbc.h"
+#include "btstack_cvsd_plc.h"
+#include "hfp_msbc.h"
+#include "wav_util.h"
+
+#ifndef M_PI
+#define M_PI  3.14159265
+#endif
+
+#define SBC_CHANNEL_MODE_MONO         0
+#define SBC_CHANNEL_MODE_DUAL_CHANNEL 1
+#define SBC_CHANNEL_MODE_STEREO       2
+#define SBC_CHANNEL_MODE_JOINT_STEREO 3
+
+#define SBC_ALLOCATION_LOUDNESS       0
+
+#define SBC_MAX_FRAME_SIZE            512
+
+// A2DP media packet: 12 bytes RTP header + 1 byte SBC media payload header
+#define A2DP_MEDIA_HEADER_SIZE 13
+#define A2DP_L2CAP_MTU         672
+
+#define MSBC_PACKET_SIZE       60
+
+#define MAX_PCM_SAMPLES        (16*8*2)
+#define DEFAULT_NUM_FRAMES     2000
+
+// max. SNR loss of our encoder compared to the reference stream in conformance mode
+#define CONFORMANCE_MAX_SNR_LOSS_DB 3.0
+// min. SNR for mSBC round trip
+#define CONFORMANCE_MIN_MSBC_SNR_DB 20.0
+
+static const char * channel_mode_names[] = { "mono", "dual", "stereo", "joint" };
+static const char * allocation_names[]   = { "loudness", "snr" };
+
+static int16_t  pcm_input[MAX_PCM_SAMPLES];
+static uint8_t  sbc_frame_storage[A2DP_L2CAP_MTU];
+static uint8_t  msbc_packet[MSBC_PACKET_SIZE];
+static int16_t  cvsd_in[CVSD_FS];
+static int16_t  cvsd_out[CVSD_FS];
+
+static btstack_sbc_encoder_state_t encoder_state;
+static btstack_sbc_decoder_state_t decoder_state;
+static btstack_cvsd_plc_state_t    cvsd_plc_state;
+static hfp_msbc_encoder_t          msbc_encoder;
+
+static int decoded_samples;
+
+// decoded PCM capture for conformance mode
+static int16_t * pcm_capture;
+static int pcm_capture_size;
+static int pcm_capture_len;
+static int pcm_capture_channels;
+
+typedef struct {
+    const char * name;
+    int num_frames;
+    uint64_t duration_ns;
+} benchmark_result_t;
+
+static uint64_t time_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static long peak_rss_kb(void){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+static void report(const char * group, const char * config, benchmark_result_t * result){
+    double ns_per_frame  = (double) result->duration_ns / result->num_frames;
+    double frames_per_s  = ns_per_frame > 0 ? 1e9 / ns_per_frame : 0;
+    printf("%-8s %-36s %-8s %12.0f frames/s %10.0f ns/frame %8ld kB peak RSS\n",
+        group, config, result->name, frames_per_s, ns_per_frame, peak_rss_kb());
+}
+
+static void fill_sine(int16_t * buffer, int num_samples, int num_channels, int period){
+    static int phase = 0;
+    int i;
+    for (i=0;i<num_samples;i++){
+        int16_t value = (int16_t) (sin(2.0 * M_PI * phase / period) * 16000.0);
+        int ch;
+        for (ch=0;ch<num_channels;ch++){
+            buffer[i*num_channels+ch] = value;
+        }
+        phase = (phase + 1) % period;
+    }
+}
+
+static void handle_pcm_data(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context){
+    UNUSED(data);
+    UNUSED(sample_rate);
+    UNUSED(context);
+    decoded_samples += num_samples * num_channels;
+}
+
+static void handle_pcm_data_capture(int16_t * data, int num_samples, int num_channels, int sample_rate, void * context){
+    UNUSED(sample_rate);
+    UNUSED(context);
+    // SBC decoder always provides stereo output, even for mono streams
+    if (decoder_state.mode == SBC_MODE_STANDARD){
+        num_channels = 2;
+    }
+    int len = num_samples * num_channels;
+    pcm_capture_channels = num_channels;
+    if (pcm_capture_len + len > pcm_capture_size){
+        pcm_capture_size = (pcm_capture_len + len) * 2;
+        pcm_capture = realloc(pcm_capture, pcm_capture_size * sizeof(int16_t));
+    }
+    memcpy(&pcm_capture[pcm_capture_len], data, len * sizeof(int16_t));
+    pcm_capture_len += len;
+}
+
+static int sbc_max_bitpool(int subbands, int channel_mode){
+    if (channel_mode == SBC_CHANNEL_MODE_MONO || channel_mode == SBC_CHANNEL_MODE_DUAL_CHANNEL){
+        return 16 * subbands;
+    }
+    return btstack_min(32 * subbands, 250);
+}
+
+// SBC: encode, decode and decode with every 10th frame corrupted (PLC)
+static void benchmark_sbc_configuration(int num_frames, int blocks, int subbands, int allocation, int channel_mode, int bitpool){
+    char config[60];
+    int num_channels = channel_mode == SBC_CHANNEL_MODE_MONO ? 1 : 2;
+    snprintf(config, sizeof(config), "%2u blk %u sb %-6s %-8s bp %3u", blocks, subbands,
+        channel_mode_names[channel_mode], allocation_names[allocation], bitpool);
+
+    btstack_sbc_encoder_init(&encoder_state, SBC_MODE_STANDARD, blocks, subbands, allocation, 44100, bitpool, channel_mode);
+    int num_samples = btstack_sbc_encoder_num_audio_frames();
+    fill_sine(pcm_input, num_samples, num_channels, 100);
+
+    // encode
+    benchmark_result_t encode = { "encode", num_frames, 0};
+    uint64_t start = time_ns();
+    int i;
+    for (i=0;i<num_frames;i++){
+        btstack_sbc_encoder_process_data(pcm_input);
+    }
+    encode.duration_ns = time_ns() - start;
+    report("sbc", config, &encode);
+
+    // keep one encoded frame for decoding
+    uint16_t frame_len = btstack_sbc_encoder_sbc_buffer_length();
+    memcpy(sbc_frame_storage, btstack_sbc_encoder_sbc_buffer(), frame_len);
+
+    // decode
+    benchmark_result_t decode = { "decode", num_frames, 0};
+    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_STANDARD, &handle_pcm_data, NULL);
+    start = time_ns();
+    for (i=0;i<num_frames;i++){
+        btstack_sbc_decoder_process_data(&decoder_state, 0, sbc_frame_storage, frame_len);
+    }
+    decode.duration_ns = time_ns() - start;
+    report("sbc", config, &decode);
+
+    // decode with PLC
+    benchmark_result_t plc = { "plc", num_frames, 0};
+    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_STANDARD, &handle_pcm_data, NULL);
+    btstack_sbc_decoder_test_simulate_corrupt_frames(10);
+    start = time_ns();
+    for (i=0;i<num_frames;i++){
+        btstack_sbc_decoder_process_data(&decoder_state, 0, sbc_frame_storage, frame_len);
+    }
+    plc.duration_ns = time_ns() - start;
+    btstack_sbc_decoder_test_simulate_corrupt_frames(-1);
+    report("sbc", config, &plc);
+}
+
+static void benchmark_sbc(int num_frames){
+    static const int blocks_list[]   = { 4, 8, 12, 16 };
+    static const int subbands_list[] = { 4, 8 };
+    int b, s, allocation, channel_mode;
+    for (b = 0; b < 4; b++){
+        for (s = 0; s < 2; s++){
+            for (channel_mode = SBC_CHANNEL_MODE_MONO; channel_mode <= SBC_CHANNEL_MODE_JOINT_STEREO; channel_mode++){
+                for (allocation = 0; allocation < 2; allocation++){
+                    // lowest, high quality and highest bitpool
+                    int max_bitpool = sbc_max_bitpool(subbands_list[s], channel_mode);
+                    int bitpools[] = { 2, btstack_min(53, max_bitpool), max_bitpool };
+                    int i;
+                    for (i=0;i<3;i++){
+                        if (i > 0 && bitpools[i] == bitpools[i-1]) continue;
+                        benchmark_sbc_configuration(num_frames, blocks_list[b], subbands_list[s], allocation, channel_mode, bitpools[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A2DP: encode, pack as many SBC frames into an L2CAP MTU as possible, decode media packets
+static void benchmark_a2dp_pipeline(int num_frames){
+    const int num_channels = 2;
+    btstack_sbc_encoder_init(&encoder_state, SBC_MODE_STANDARD, 16, 8, SBC_ALLOCATION_LOUDNESS, 44100, 53, SBC_CHANNEL_MODE_JOINT_STEREO);
+    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_STANDARD, &handle_pcm_data, NULL);
+    int num_samples = btstack_sbc_encoder_num_audio_frames();
+
+    benchmark_result_t pipeline = { "pipeline", num_frames, 0};
+    int sbc_storage_len = 0;
+    int i;
+    uint64_t start = time_ns();
+    for (i=0;i<num_frames;i++){
+        fill_sine(pcm_input, num_samples, num_channels, 100);
+        btstack_sbc_encoder_process_data(pcm_input);
+        uint16_t frame_len = btstack_sbc_encoder_sbc_buffer_length();
+        if (A2DP_MEDIA_HEADER_SIZE + sbc_storage_len + frame_len > A2DP_L2CAP_MTU){
+            btstack_sbc_decoder_process_data(&decoder_state, 0, sbc_frame_storage, sbc_storage_len);
+            sbc_storage_len = 0;
+        }
+        memcpy(&sbc_frame_storage[sbc_storage_len], btstack_sbc_encoder_sbc_buffer(), frame_len);
+        sbc_storage_len += frame_len;
+    }
+    pipeline.duration_ns = time_ns() - start;
+    report("a2dp", "16 blk 8 sb joint  loudness bp  53", &pipeline);
+}
+
+// HFP mSBC: encode incl. H2 header, transfer as 60 byte SCO packets, decode incl. PLC every 20th packet
+static void benchmark_msbc_pipeline(int num_frames){
+    hfp_msbc_init(&msbc_encoder);
+    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_mSBC, &handle_pcm_data, NULL);
+    int num_samples = hfp_msbc_num_audio_samples_per_frame(&msbc_encoder);
+
+    benchmark_result_t encode = { "encode", num_frames, 0};
+    int i;
+    uint64_t start = time_ns();
+    for (i=0;i<num_frames;i++){
+        fill_sine(pcm_input, num_samples, 1, 16);
+        hfp_msbc_encode_audio_frame(&msbc_encoder, pcm_input);
+        hfp_msbc_read_from_stream(&msbc_encoder, msbc_packet, sizeof(msbc_packet));
+    }
+    encode.duration_ns = time_ns() - start;
+    report("hfp", "msbc", &encode);
+
+    benchmark_result_t pipeline = { "pipeline", num_frames, 0};
+    start = time_ns();
+    for (i=0;i<num_frames;i++){
+        fill_sine(pcm_input, num_samples, 1, 16);
+        hfp_msbc_encode_audio_frame(&msbc_encoder, pcm_input);
+        hfp_msbc_read_from_stream(&msbc_encoder, msbc_packet, sizeof(msbc_packet));
+        int packet_status_flag = (i % 20) == 19 ? 2 : 0;
+        btstack_sbc_decoder_process_data(&decoder_state, packet_status_flag, msbc_packet, sizeof(msbc_packet));
+    }
+    pipeline.duration_ns = time_ns() - start;
+    report("hfp", "msbc", &pipeline);
+}
+
+// HFP CVSD: PLC on CVSD_FS sample frames, every 20th frame lost
+static void benchmark_cvsd_pipeline(int num_frames){
+    btstack_cvsd_plc_init(&cvsd_plc_state);
+
+    benchmark_result_t plc = { "plc", num_frames, 0};
+    int i;
+    uint64_t start = time_ns();
+    for (i=0;i<num_frames;i++){
+        fill_sine(cvsd_in, CVSD_FS, 1, 8);
+        if ((i % 20) == 19){
+            memset(cvsd_in, 0, sizeof(cvsd_in));
+        }
+        btstack_cvsd_plc_process_data(&cvsd_plc_state, cvsd_in, CVSD_FS, cvsd_out);
+    }
+    plc.duration_ns = time_ns() - start;
+    report("hfp", "cvsd", &plc);
+}
+
+// Conformance
+static int16_t * read_wav_file(const char * path, int num_channels, int * num_samples){
+    if (wav_reader_open(path) != 0) return NULL;
+    int size = 0;
+    int len  = 0;
+    int16_t * samples = NULL;
+    while (1){
+        if (len + num_channels > size){
+            size = (size + num_channels) * 2;
+            samples = realloc(samples, size * sizeof(int16_t));
+        }
+        if (wav_reader_read_int16(num_channels, &samples[len])) break;
+        len += num_channels;
+    }
+    wav_reader_close();
+    *num_samples = len;
+    return samples;
+}
+
+static uint8_t * read_file(const char * path, int * size){
+    FILE * f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *size = (int) ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t * data = malloc(*size);
+    if (fread(data, 1, *size, f) != (size_t) *size){
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static void decode_sbc_buffer(uint8_t * data, int size){
+    pcm_capture_len = 0;
+    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_STANDARD, &handle_pcm_data_capture, NULL);
+    btstack_sbc_decoder_process_data(&decoder_state, 0, data, size);
+}
+
+// SNR of captured PCM against source, best alignment within max_delay samples
+static double snr_db(const int16_t * source, int source_len, int num_channels, int max_delay){
+    double best = -999.0;
+    int delay;
+    for (delay = 0; delay <= max_delay; delay++){
+        double signal = 0;
+        double noise  = 0;
+        int i;
+        for (i=0; i < source_len; i++){
+            int ch  = i % num_channels;
+            int pos = (delay + i / num_channels) * pcm_capture_channels + ch;
+            if (pos >= pcm_capture_len) break;
+            double expected = source[i];
+            double diff = expected - pcm_capture[pos];
+            signal += expected * expected;
+            noise  += diff * diff;
+        }
+        double snr = noise == 0 ? 999.0 : 10.0 * log10(signal / noise);
+        if (snr > best){
+            best = snr;
+        }
+    }
+    return best;
+}
+
+// encode source wav with parameters of the reference vector, check frame headers and compare quality of both streams
+static int check_reference_vector(const char * data_dir, const char * name, const char * wav_name){
+    char path[1000];
+    int ref_size;
+    snprintf(path, sizeof(path), "%s/%s", data_dir, name);
+    uint8_t * ref_sbc = read_file(path, &ref_size);
+    if (!ref_sbc || ref_size < 4){
+        printf("%-24s: cannot read\n", name);
+        free(ref_sbc);
+        return 1;
+    }
+
+    // parse first SBC frame header
+    static const int sample_rates[] = { 16000, 32000, 44100, 48000 };
+    int sample_rate  = sample_rates[(ref_sbc[1] >> 6) & 0x03];
+    int blocks       = (((ref_sbc[1] >> 4) & 0x03) + 1) * 4;
+    int channel_mode = (ref_sbc[1] >> 2) & 0x03;
+    int allocation   = (ref_sbc[1] >> 1) & 0x01;
+    int subbands     = (ref_sbc[1] & 0x01) ? 8 : 4;
+    int bitpool      = ref_sbc[2];
+    int num_channels = channel_mode == SBC_CHANNEL_MODE_MONO ? 1 : 2;
+
+    snprintf(path, sizeof(path), "%s/%s", data_dir, wav_name);
+    int wav_len;
+    int16_t * wav = read_wav_file(path, num_channels, &wav_len);
+    if (!wav){
+        printf("%-24s: cannot read %s\n", name, wav_name);
+        free(ref_sbc);
+        return 1;
+    }
+
+    // encode, frame headers have to match reference (CRC excluded)
+    btstack_sbc_encoder_init(&encoder_state, SBC_MODE_STANDARD, blocks, subbands, allocation, sample_rate, bitpool, channel_mode);
+    int samples_per_frame = btstack_sbc_encoder_num_audio_frames() * num_channels;
+    int sbc_size = 0;
+    uint8_t * sbc = malloc(ref_size + SBC_MAX_FRAME_SIZE);
+    int header_mismatch = 0;
+    int pos;
+    for (pos = 0; pos + samples_per_frame <= wav_len; pos += samples_per_frame){
+        btstack_sbc_encoder_process_data(&wav[pos]);
+        uint16_t frame_len = btstack_sbc_encoder_sbc_buffer_length();
+        if (sbc_size + frame_len > ref_size) break;
+        uint8_t * frame = btstack_sbc_encoder_sbc_buffer();
+        if (memcmp(frame, &ref_sbc[sbc_size], 3) != 0){
+            header_mismatch++;
+        }
+        memcpy(&sbc[sbc_size], frame, frame_len);
+        sbc_size += frame_len;
+    }
+    int exact = sbc_size == ref_size && memcmp(sbc, ref_sbc, sbc_size) == 0;
+
+    // decode both streams and compare against source
+    int max_delay = blocks * subbands;
+    decode_sbc_buffer(ref_sbc, ref_size);
+    double ref_snr = snr_db(wav, wav_len, num_channels, max_delay);
+    decode_sbc_buffer(sbc, sbc_size);
+    double snr     = snr_db(wav, wav_len, num_channels, max_delay);
+
+    int failed = header_mismatch || sbc_size == 0 || snr < ref_snr - CONFORMANCE_MAX_SNR_LOSS_DB;
+
+    printf("%-24s: %u Hz, %2u blk, %u sb, %-6s, %-8s, bp %3u: %-13s, SNR %5.1f dB (reference %5.1f dB), %s\n",
+        name, sample_rate, blocks, subbands, channel_mode_names[channel_mode], allocation_names[allocation], bitpool,
+        exact ? "bit-exact" : "not bit-exact", snr, ref_snr, failed ? "FAIL" : "OK");
+
+    free(sbc);
+    free(wav);
+    free(ref_sbc);
+    return failed;
+}
+
+// mSBC round trip incl. H2 header in 60 byte SCO packets, no frame may be lost
+static int check_msbc_round_trip(const char * data_dir, const char * wav_name){
+    char path[1000];
+    int wav_len;
+    snprintf(path, sizeof(path), "%s/%s", data_dir, wav_name);
+    int16_t * wav = read_wav_file(path, 1, &wav_len);
+    if (!wav){
+        printf("%-24s: cannot read\n", wav_name);
+        return 1;
+    }
+    hfp_msbc_init(&msbc_encoder);
+    pcm_capture_len = 0;
+    btstack_sbc_decoder_init(&decoder_state, SBC_MODE_mSBC, &handle_pcm_data_capture, NULL);
+    int num_samples = hfp_msbc_num_audio_samples_per_frame(&msbc_encoder);
+    int pos;
+    for (pos = 0; pos + num_samples <= wav_len; pos += num_samples){
+        hfp_msbc_encode_audio_frame(&msbc_encoder, &wav[pos]);
+        hfp_msbc_read_from_stream(&msbc_encoder, msbc_packet, sizeof(msbc_packet));
+        btstack_sbc_decoder_process_data(&decoder_state, 0, msbc_packet, sizeof(msbc_packet));
+    }
+    double snr = snr_db(wav, wav_len, 1, 2 * num_samples);
+    int failed = decoder_state.good_frames_nr == 0 || decoder_state.bad_frames_nr > 0 || snr < CONFORMANCE_MIN_MSBC_SNR_DB;
+    printf("%-24s: mSBC round trip, %u good, %u bad frames, SNR %5.1f dB, %s\n", wav_name,
+        decoder_state.good_frames_nr, decoder_state.bad_frames_nr, snr, failed ? "FAIL" : "OK");
+    free(wav);
+    return failed;
+}
+
+static int conformance(const char * data_dir){
+    static const char * vectors[][2] = {
+        { "fanfare-4sb-mono.sbc",   "fanfare-mono.wav"   },
+        { "fanfare-8sb-mono.sbc",   "fanfare-mono.wav"   },
+        { "fanfare-4sb-stereo.sbc", "fanfare-stereo.wav" },
+        { "fanfare-8sb-stereo.sbc", "fanfare-stereo.wav" },
+        { "sine-8sb-mono.sbc",      "sine-mono.wav"      },
+        { "sine-4sb-stereo.sbc",    "sine-stereo.wav"    },
+        { "sine-8sb-stereo.sbc",    "sine-stereo.wav"    },
+    };
+    int failures = 0;
+    unsigned int i;
+    for (i=0;i<sizeof(vectors)/sizeof(vectors[0]);i++){
+        failures += check_reference_vector(data_dir, vectors[i][0], vectors[i][1]);
+    }
+    failures += check_msbc_round_trip(data_dir, "fanfare-mono.wav");
+    printf("Conformance: %u vectors, %u failed\n", (int) (sizeof(vectors)/sizeof(vectors[0])) + 1, failures);
+    return failures ? 1 : 0;
+}
+
+int main (int argc, const char * argv[]){
+    if (argc > 1 && strcmp(argv[1], "-c") == 0){
+        return conformance(argc > 2 ? argv[2] : "data");
+    }
+
+    int num_frames = DEFAULT_NUM_FRAMES;
+    if (argc > 1){
+        num_frames = atoi(argv[1]);
+    }
+    if (num_frames <= 0){
+        printf("Usage: %s [num_frames] | -c [data_dir]\n", argv[0]);
+        return -1;
+    }
+
+    benchmark_sbc(num_frames);
+    benchmark_a2dp_pipeline(num_frames);
+    benchmark_msbc_pipeline(num_frames);
+    benchmark_cvsd_pipeline(num_frames);
+    return 0;
+}
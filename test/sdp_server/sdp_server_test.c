@@ -0,0 +1,405 @@
+
+// *****************************************************************************
+//
+// test SDP server: UUID index and response cache
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bluetooth_sdp.h"
+#include "btstack_memory.h"
+#include "btstack_util.h"
+#include "l2cap.h"
+#include "classic/sdp_server.h"
+#include "classic/sdp_util.h"
+#include "classic/spp_server.h"
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#define NUM_RECORDS 6
+
+static uint8_t  records[NUM_RECORDS][300];
+static uint32_t record_handles[NUM_RECORDS];
+static int      record_registered[NUM_RECORDS];
+// record indices, most recently registered first
+static int      record_order[NUM_RECORDS];
+static int      num_records_registered;
+
+static const uint8_t custom_uuid128[] = { 0x1C, 0x6F, 0x6D, 0x98, 0xF2, 0x3C, 0x3A, 0x11, 0xD6, 0x95, 0x6A, 0x00, 0x03, 0x93, 0x53, 0xE8 };
+static const uint8_t other_uuid128[]  = { 0x1C, 0x6F, 0x6D, 0x98, 0xF2, 0x3C, 0x3A, 0x11, 0xD6, 0x95, 0x6A, 0x00, 0x03, 0x93, 0x53, 0xE9 };
+
+#define TEST_CID 0x41
+
+static btstack_packet_handler_t sdp_server_packet_handler;
+static uint16_t remote_mtu;
+static uint8_t  request[300];
+static uint8_t  response[1000];
+static uint16_t response_len;
+static uint8_t  response_lists[4000];
+static uint8_t  reference_lists[4000];
+
+// mocks
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    (void) psm;
+    (void) mtu;
+    (void) security_level;
+    sdp_server_packet_handler = packet_handler;
+    return 0;
+}
+uint16_t l2cap_get_remote_mtu_for_local_cid(uint16_t local_cid){
+    (void) local_cid;
+    return remote_mtu;
+}
+int l2cap_send(uint16_t local_cid, uint8_t *data, uint16_t len){
+    CHECK_EQUAL(TEST_CID, local_cid);
+    CHECK(len <= remote_mtu);
+    memcpy(response, data, len);
+    response_len = len;
+    return 0;
+}
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    (void) local_cid;
+}
+void l2cap_accept_connection(uint16_t local_cid){
+    (void) local_cid;
+}
+void l2cap_decline_connection(uint16_t local_cid){
+    (void) local_cid;
+}
+service_record_item_t * btstack_memory_service_record_item_get(void){
+    return (service_record_item_t*) calloc(1, sizeof(service_record_item_t));
+}
+void btstack_memory_service_record_item_free(service_record_item_t * service_record_item){
+    free(service_record_item);
+}
+
+// record with 128-bit UUID and 32-bit encoded Audio Source UUID
+static void create_custom_record(uint8_t * service, uint32_t service_record_handle){
+    de_create_sequence(service);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_RECORD_HANDLE);
+    de_add_number(service, DE_UINT, DE_SIZE_32, service_record_handle);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_CLASS_ID_LIST);
+    uint8_t * attribute = de_push_sequence(service);
+    de_add_uuid128(attribute, (uint8_t *) custom_uuid128);
+    de_add_number(attribute, DE_UUID, DE_SIZE_32, BLUETOOTH_SERVICE_CLASS_AUDIO_SOURCE);
+    de_pop_sequence(service, attribute);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_PROTOCOL_DESCRIPTOR_LIST);
+    attribute = de_push_sequence(service);
+    uint8_t * l2cap = de_push_sequence(attribute);
+    de_add_number(l2cap, DE_UUID, DE_SIZE_16, BLUETOOTH_PROTOCOL_L2CAP);
+    de_add_number(l2cap, DE_UINT, DE_SIZE_16, BLUETOOTH_PROTOCOL_AVDTP);
+    de_pop_sequence(attribute, l2cap);
+    de_pop_sequence(service, attribute);
+}
+
+// record with more UUIDs than fit into UUID index
+static void create_many_uuids_record(uint8_t * service, uint32_t service_record_handle){
+    de_create_sequence(service);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_RECORD_HANDLE);
+    de_add_number(service, DE_UINT, DE_SIZE_32, service_record_handle);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_CLASS_ID_LIST);
+    uint8_t * attribute = de_push_sequence(service);
+    int i;
+    for (i=0;i<SDP_RECORD_UUID_INDEX_SIZE + 5;i++){
+        de_add_number(attribute, DE_UUID, DE_SIZE_16, 0x2000 + i);
+    }
+    de_pop_sequence(service, attribute);
+}
+
+static void register_record(int index){
+    CHECK_EQUAL(0, sdp_register_service(records[index]));
+    record_registered[index] = 1;
+    memmove(&record_order[1], &record_order[0], num_records_registered * sizeof(int));
+    record_order[0] = index;
+    num_records_registered++;
+}
+
+static void unregister_record(int index){
+    sdp_unregister_service(record_handles[index]);
+    record_registered[index] = 0;
+    int i;
+    for (i=0;i<num_records_registered;i++){
+        if (record_order[i] != index) continue;
+        num_records_registered--;
+        memmove(&record_order[i], &record_order[i+1], (num_records_registered - i) * sizeof(int));
+        break;
+    }
+}
+
+// expected results: records are stored in reverse registration order, matched without UUID index
+static int reference_service_search(uint8_t * pattern, uint32_t * handles){
+    int count = 0;
+    int j;
+    for (j=0;j<num_records_registered;j++){
+        int i = record_order[j];
+        if (!sdp_record_matches_service_search_pattern(records[i], pattern)) continue;
+        handles[count++] = record_handles[i];
+    }
+    return count;
+}
+
+static int reference_service_search_attribute(uint8_t * pattern, uint8_t * attribute_list, uint8_t * buffer){
+    int pos = 3;
+    int j;
+    for (j=0;j<num_records_registered;j++){
+        int i = record_order[j];
+        if (!sdp_record_matches_service_search_pattern(records[i], pattern)) continue;
+        uint16_t filtered_size = spd_get_filtered_size(records[i], attribute_list);
+        de_store_descriptor_with_len(&buffer[pos], DE_DES, DE_SIZE_VAR_16, filtered_size);
+        pos += 3;
+        uint16_t bytes_used;
+        sdp_filter_attributes_in_attributeIDList(records[i], attribute_list, 0, filtered_size, &bytes_used, &buffer[pos]);
+        pos += bytes_used;
+    }
+    de_store_descriptor_with_len(buffer, DE_DES, DE_SIZE_VAR_16, pos - 3);
+    return pos;
+}
+
+static void send_request(uint16_t len){
+    uint8_t event[] = { L2CAP_EVENT_CAN_SEND_NOW, 2, TEST_CID, 0};
+    response_len = 0;
+    (*sdp_server_packet_handler)(L2CAP_DATA_PACKET, TEST_CID, request, len);
+    (*sdp_server_packet_handler)(HCI_EVENT_PACKET, TEST_CID, event, sizeof(event));
+    CHECK(response_len >= 5);
+}
+
+static int service_search(uint8_t * pattern, uint32_t * handles){
+    uint16_t pattern_len = de_get_len(pattern);
+    request[0] = SDP_ServiceSearchRequest;
+    big_endian_store_16(request, 1, 1);
+    big_endian_store_16(request, 3, pattern_len + 3);
+    memcpy(&request[5], pattern, pattern_len);
+    big_endian_store_16(request, 5 + pattern_len, 0xffff);
+    request[5 + pattern_len + 2] = 0;
+    send_request(5 + pattern_len + 3);
+    CHECK_EQUAL(SDP_ServiceSearchResponse, response[0]);
+    int count = big_endian_read_16(response, 7);
+    int i;
+    for (i=0;i<count;i++){
+        handles[i] = big_endian_read_32(response, 9 + 4*i);
+    }
+    // complete
+    CHECK_EQUAL(0, response[9 + 4*count]);
+    return count;
+}
+
+// issue request and follow continuation state, returns number of fragments
+static int service_search_attribute(uint8_t * pattern, uint8_t * attribute_list, uint8_t * buffer, int * buffer_len){
+    uint16_t pattern_len   = de_get_len(pattern);
+    uint16_t attribute_len = de_get_len(attribute_list);
+    uint8_t  continuation_state[17];
+    int      fragments = 0;
+    *buffer_len = 0;
+    continuation_state[0] = 0;
+    while (1){
+        uint16_t pos = 5;
+        memcpy(&request[pos], pattern, pattern_len);
+        pos += pattern_len;
+        big_endian_store_16(request, pos, 0xffff);
+        pos += 2;
+        memcpy(&request[pos], attribute_list, attribute_len);
+        pos += attribute_len;
+        memcpy(&request[pos], continuation_state, 1 + continuation_state[0]);
+        pos += 1 + continuation_state[0];
+        request[0] = SDP_ServiceSearchAttributeRequest;
+        big_endian_store_16(request, 1, fragments);
+        big_endian_store_16(request, 3, pos - 5);
+        send_request(pos);
+        CHECK_EQUAL(SDP_ServiceSearchAttributeResponse, response[0]);
+        CHECK_EQUAL(fragments, big_endian_read_16(response, 1));
+        uint16_t attribute_lists_len = big_endian_read_16(response, 5);
+        memcpy(&buffer[*buffer_len], &response[7], attribute_lists_len);
+        *buffer_len += attribute_lists_len;
+        fragments++;
+        uint8_t * response_continuation_state = &response[7 + attribute_lists_len];
+        CHECK(response_continuation_state[0] <= 16);
+        CHECK_EQUAL(response_len, 7 + attribute_lists_len + 1 + response_continuation_state[0]);
+        if (response_continuation_state[0] == 0) break;
+        memcpy(continuation_state, response_continuation_state, 1 + response_continuation_state[0]);
+        CHECK(fragments < 100);
+    }
+    return fragments;
+}
+
+static void check_service_search(uint8_t * pattern, int expected_count){
+    uint32_t handles[NUM_RECORDS];
+    uint32_t reference_handles[NUM_RECORDS];
+    int count = service_search(pattern, handles);
+    CHECK_EQUAL(expected_count, count);
+    CHECK_EQUAL(reference_service_search(pattern, reference_handles), count);
+    CHECK(memcmp(handles, reference_handles, count * sizeof(uint32_t)) == 0);
+}
+
+static void check_service_search_attribute(uint8_t * pattern, uint8_t * attribute_list){
+    int reference_len = reference_service_search_attribute(pattern, attribute_list, reference_lists);
+    uint16_t mtus[] = { 48, 64, 100, 200, 672 };
+    unsigned int i;
+    for (i=0;i<sizeof(mtus)/sizeof(uint16_t);i++){
+        remote_mtu = mtus[i];
+        // run twice to get served from cache if enabled
+        int run;
+        for (run=0;run<2;run++){
+            int len;
+            int fragments = service_search_attribute(pattern, attribute_list, response_lists, &len);
+            CHECK_EQUAL(reference_len, len);
+            CHECK(memcmp(reference_lists, response_lists, len) == 0);
+            if (reference_len > mtus[i] - 12){
+                CHECK(fragments > 1);
+            }
+        }
+    }
+    remote_mtu = 672;
+}
+
+static uint8_t pattern_buffer[100];
+static uint8_t attribute_list_buffer[20];
+
+static uint8_t * pattern_for_uuid16s(const uint16_t * uuids, int num_uuids){
+    de_create_sequence(pattern_buffer);
+    int i;
+    for (i=0;i<num_uuids;i++){
+        de_add_number(pattern_buffer, DE_UUID, DE_SIZE_16, uuids[i]);
+    }
+    return pattern_buffer;
+}
+
+static uint8_t * attribute_list_for_range(uint16_t start, uint16_t end){
+    de_create_sequence(attribute_list_buffer);
+    de_add_number(attribute_list_buffer, DE_UINT, DE_SIZE_32, (start << 16) | end);
+    return attribute_list_buffer;
+}
+
+TEST_GROUP(SDPServer){
+    void setup(void){
+        sdp_init();
+        remote_mtu = 672;
+        uint8_t event[] = { L2CAP_EVENT_INCOMING_CONNECTION, 0};
+        (*sdp_server_packet_handler)(HCI_EVENT_PACKET, TEST_CID, event, sizeof(event));
+
+        int i;
+        for (i=0;i<NUM_RECORDS;i++){
+            record_handles[i] = sdp_create_service_record_handle();
+            memset(records[i], 0, sizeof(records[i]));
+            switch (i){
+                case 1:
+                    create_custom_record(records[i], record_handles[i]);
+                    break;
+                case 3:
+                    create_many_uuids_record(records[i], record_handles[i]);
+                    break;
+                default:
+                    spp_create_sdp_record(records[i], record_handles[i], i + 1, "Serial Port Profile with a somewhat longer service name");
+                    break;
+            }
+            register_record(i);
+        }
+    }
+    void teardown(void){
+        uint8_t event[] = { L2CAP_EVENT_CHANNEL_CLOSED, 0};
+        (*sdp_server_packet_handler)(HCI_EVENT_PACKET, TEST_CID, event, sizeof(event));
+        int i;
+        for (i=0;i<NUM_RECORDS;i++){
+            if (record_registered[i]){
+                unregister_record(i);
+            }
+        }
+    }
+};
+
+TEST(SDPServer, ServiceSearchUUID16){
+    uint16_t spp[]   = { BLUETOOTH_SERVICE_CLASS_SERIAL_PORT };
+    uint16_t l2cap[] = { BLUETOOTH_PROTOCOL_L2CAP };
+    uint16_t both[]  = { BLUETOOTH_PROTOCOL_RFCOMM, BLUETOOTH_SERVICE_CLASS_SERIAL_PORT };
+    uint16_t none[]  = { BLUETOOTH_SERVICE_CLASS_HANDSFREE };
+    check_service_search(pattern_for_uuid16s(spp, 1), 4);
+    check_service_search(pattern_for_uuid16s(l2cap, 1), 5);
+    check_service_search(pattern_for_uuid16s(both, 2), 4);
+    check_service_search(pattern_for_uuid16s(none, 1), 0);
+}
+
+TEST(SDPServer, ServiceSearchUUID32And128){
+    // Audio Source stored as UUID32 in record
+    uint16_t audio_source[] = { BLUETOOTH_SERVICE_CLASS_AUDIO_SOURCE };
+    check_service_search(pattern_for_uuid16s(audio_source, 1), 1);
+
+    // search for Audio Source as UUID128
+    uint8_t uuid128[16];
+    uuid_add_bluetooth_prefix(uuid128, BLUETOOTH_SERVICE_CLASS_AUDIO_SOURCE);
+    de_create_sequence(pattern_buffer);
+    de_add_uuid128(pattern_buffer, uuid128);
+    check_service_search(pattern_buffer, 1);
+
+    // custom UUID128
+    de_create_sequence(pattern_buffer);
+    de_add_uuid128(pattern_buffer, (uint8_t *) custom_uuid128);
+    check_service_search(pattern_buffer, 1);
+    de_create_sequence(pattern_buffer);
+    de_add_uuid128(pattern_buffer, (uint8_t *) other_uuid128);
+    check_service_search(pattern_buffer, 0);
+}
+
+TEST(SDPServer, ServiceSearchIndexOverflow){
+    // UUIDs beyond index size are found by traversing the record
+    uint16_t first[] = { 0x2000 };
+    uint16_t last[]  = { 0x2000 + SDP_RECORD_UUID_INDEX_SIZE + 4 };
+    uint16_t none[]  = { 0x2000 + SDP_RECORD_UUID_INDEX_SIZE + 5 };
+    check_service_search(pattern_for_uuid16s(first, 1), 1);
+    check_service_search(pattern_for_uuid16s(last, 1), 1);
+    check_service_search(pattern_for_uuid16s(none, 1), 0);
+}
+
+TEST(SDPServer, ServiceSearchAttribute){
+    uint16_t l2cap[] = { BLUETOOTH_PROTOCOL_L2CAP };
+    uint16_t spp[]   = { BLUETOOTH_SERVICE_CLASS_SERIAL_PORT };
+    uint16_t none[]  = { BLUETOOTH_SERVICE_CLASS_HANDSFREE };
+    check_service_search_attribute(pattern_for_uuid16s(l2cap, 1), attribute_list_for_range(0x0000, 0xffff));
+    check_service_search_attribute(pattern_for_uuid16s(l2cap, 1), attribute_list_for_range(0x0004, 0x0100));
+    check_service_search_attribute(pattern_for_uuid16s(spp, 1), attribute_list_for_range(0x0000, 0xffff));
+    check_service_search_attribute(pattern_for_uuid16s(none, 1), attribute_list_for_range(0x0000, 0xffff));
+}
+
+TEST(SDPServer, ServiceSearchAttributeAfterUnregister){
+    uint16_t spp[] = { BLUETOOTH_SERVICE_CLASS_SERIAL_PORT };
+    check_service_search_attribute(pattern_for_uuid16s(spp, 1), attribute_list_for_range(0x0000, 0xffff));
+    unregister_record(2);
+    check_service_search_attribute(pattern_for_uuid16s(spp, 1), attribute_list_for_range(0x0000, 0xffff));
+    register_record(2);
+    check_service_search_attribute(pattern_for_uuid16s(spp, 1), attribute_list_for_range(0x0000, 0xffff));
+}
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+TEST(SDPServer, InvalidContinuationState){
+    uint16_t l2cap[] = { BLUETOOTH_PROTOCOL_L2CAP };
+    uint8_t * pattern = pattern_for_uuid16s(l2cap, 1);
+    uint8_t * attribute_list = attribute_list_for_range(0x0000, 0xffff);
+    uint16_t pattern_len   = de_get_len(pattern);
+    uint16_t attribute_len = de_get_len(attribute_list);
+    uint16_t pos = 5;
+    memcpy(&request[pos], pattern, pattern_len);
+    pos += pattern_len;
+    big_endian_store_16(request, pos, 0xffff);
+    pos += 2;
+    memcpy(&request[pos], attribute_list, attribute_len);
+    pos += attribute_len;
+    request[pos++] = 2;
+    big_endian_store_16(request, pos, 0xfff0);
+    pos += 2;
+    request[0] = SDP_ServiceSearchAttributeRequest;
+    big_endian_store_16(request, 1, 1);
+    big_endian_store_16(request, 3, pos - 5);
+    send_request(pos);
+    CHECK_EQUAL(SDP_ErrorResponse, response[0]);
+    CHECK_EQUAL(0x0005, big_endian_read_16(response, 5));
+}
+#endif
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "ecc_p256_latency_benchmark.c"
+
+/*
+ * ecc_p256_latency_benchmark.c
+ *
+ * Measures how software ECC P-256 operations in btstack_crypto delay a 1 ms timer on the POSIX run loop.
+ * DHKey calculations are run back to back, first on the run loop, then with the POSIX crypto executor.
+ * For each phase, the largest interval between two timer ticks is reported.
+ *
+ * Afterwards, the key pool is filled while idle and the time from btstack_crypto_ecc_p256_generate_key
+ * to its callback is compared with the first key generation that had to wait for the key.
+ *
+ * HCI is replaced by a minimal mock that answers HCI LE Rand on the run loop.
+ * Fails if an operation does not complete or if the DHKeys differ between phases. Set LOG to see log output.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "btstack_config.h"
+#include "btstack_crypto.h"
+#include "btstack_crypto_executor_posix.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+
+#define NUM_DHKEY_CALCULATIONS  20
+#define NUM_POOL_KEYS           2
+#define TICK_MS                 1
+
+// public key B from P-256 Data Set 1, Core Spec Vol 2, Part G, 7.1.2
+static const char * peer_public_key_string =
+    "1ea1f0f01faf1d9609592284f19e4c0047b58afd8615a69f559077b22faaa190"
+    "4c55f33e429dad377356703a9ab85160472d1130e28e36765f89aff915b1214a";
+
+typedef enum {
+    PHASE_FIRST_KEY,
+    PHASE_RUN_LOOP,
+    PHASE_EXECUTOR,
+    PHASE_POOL_FILL,
+    PHASE_KEY_POOL,
+    PHASE_DONE,
+} phase_t;
+
+static const char * phase_names[] = {
+    "first key",
+    "run loop",
+    "executor",
+    "pool fill",
+    "key pool",
+    "done",
+};
+
+static btstack_crypto_ecc_p256_t ecc_request;
+static uint8_t peer_public_key[64];
+static uint8_t local_public_key[64];
+static uint8_t previous_public_key[64];
+static uint8_t dhkey[32];
+static uint8_t dhkey_expected[32];
+static int     dhkey_expected_set;
+
+static phase_t  phase;
+static int      operations_done;
+static uint32_t request_us;
+static uint32_t first_key_us;
+static uint32_t pool_key_max_us;
+static uint32_t max_tick_interval_us[PHASE_DONE + 1];
+static uint32_t last_tick_us;
+static int      failures;
+
+static btstack_timer_source_t tick_timer;
+static btstack_timer_source_t phase_timer;
+
+static void start_phase(phase_t next_phase);
+static void start_phase_pool(btstack_timer_source_t * ts);
+static void start_phase_after_dhkey(void * arg);
+static void start_phase_after_key(void * arg);
+
+static uint32_t now_us(void){
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t) (tv.tv_sec * 1000000 + tv.tv_usec);
+}
+
+// minimal HCI
+
+static btstack_packet_handler_t hci_event_handler;
+static btstack_timer_source_t   le_rand_timer;
+
+HCI_STATE hci_get_state(void){
+    return HCI_STATE_WORKING;
+}
+
+int hci_can_send_command_packet_now(void){
+    return 1;
+}
+
+void hci_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    hci_event_handler = callback_handler->callback;
+}
+
+static void le_rand_complete(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    uint8_t event[14];
+    event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, hci_le_rand.opcode);
+    event[5] = ERROR_CODE_SUCCESS;
+    int i;
+    for (i=0;i<8;i++){
+        event[6+i] = (uint8_t) rand();
+    }
+    (*hci_event_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+int hci_send_cmd(const hci_cmd_t *cmd, ...){
+    if (cmd->opcode != hci_le_rand.opcode){
+        printf("Unexpected HCI Command 0x%04x\n", cmd->opcode);
+        failures++;
+        return 0;
+    }
+    btstack_run_loop_set_timer_handler(&le_rand_timer, &le_rand_complete);
+    btstack_run_loop_set_timer(&le_rand_timer, 0);
+    btstack_run_loop_add_timer(&le_rand_timer);
+    return 0;
+}
+
+// benchmark
+
+static void tick_handler(btstack_timer_source_t * ts){
+    uint32_t tick_us = now_us();
+    uint32_t interval_us = tick_us - last_tick_us;
+    if (interval_us > max_tick_interval_us[phase]){
+        max_tick_interval_us[phase] = interval_us;
+    }
+    last_tick_us = tick_us;
+    btstack_run_loop_set_timer(ts, TICK_MS);
+    btstack_run_loop_add_timer(ts);
+}
+
+static void start_dhkey_calculation(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    request_us = now_us();
+    btstack_crypto_ecc_p256_calculate_dhkey(&ecc_request, peer_public_key, dhkey, &start_phase_after_dhkey, NULL);
+}
+
+static void start_key_generation(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    memcpy(previous_public_key, local_public_key, 64);
+    request_us = now_us();
+    btstack_crypto_ecc_p256_generate_key(&ecc_request, local_public_key, &start_phase_after_key, NULL);
+}
+
+// schedule next operation via timer to allow tick timer to run in between
+static void schedule(void (*handler)(btstack_timer_source_t * ts), uint32_t timeout_ms){
+    btstack_run_loop_set_timer_handler(&phase_timer, handler);
+    btstack_run_loop_set_timer(&phase_timer, timeout_ms);
+    btstack_run_loop_add_timer(&phase_timer);
+}
+
+static void start_phase_after_dhkey(void * arg){
+    UNUSED(arg);
+    if (!dhkey_expected_set){
+        memcpy(dhkey_expected, dhkey, 32);
+        dhkey_expected_set = 1;
+    }
+    if (memcmp(dhkey, dhkey_expected, 32) != 0){
+        printf("DHKey mismatch in phase %s\n", phase_names[phase]);
+        failures++;
+    }
+    operations_done++;
+    if (operations_done < NUM_DHKEY_CALCULATIONS){
+        schedule(&start_dhkey_calculation, 0);
+        return;
+    }
+    start_phase((phase_t) (phase + 1));
+}
+
+static void start_phase_after_key(void * arg){
+    UNUSED(arg);
+    uint32_t key_us = now_us() - request_us;
+    if (memcmp(previous_public_key, local_public_key, 64) == 0){
+        printf("Key pair not renewed in phase %s\n", phase_names[phase]);
+        failures++;
+    }
+    operations_done++;
+    if (phase == PHASE_FIRST_KEY){
+        first_key_us = key_us;
+        start_phase(PHASE_RUN_LOOP);
+        return;
+    }
+    if (key_us > pool_key_max_us){
+        pool_key_max_us = key_us;
+    }
+    if (operations_done < NUM_POOL_KEYS){
+        schedule(&start_key_generation, 0);
+        return;
+    }
+    start_phase(PHASE_DONE);
+}
+
+static void report(void){
+    printf("ECC P-256 timer latency with %u DHKey calculations, tick %u ms\n", NUM_DHKEY_CALCULATIONS, TICK_MS);
+    printf("- max tick interval, DHKey on run loop: %6u us\n", max_tick_interval_us[PHASE_RUN_LOOP]);
+    printf("- max tick interval, DHKey on executor: %6u us\n", max_tick_interval_us[PHASE_EXECUTOR]);
+    printf("Key generation, request to callback\n");
+    printf("- first key, no pool:                   %6u us\n", first_key_us);
+    printf("- key from pool, max of %u:              %6u us\n", NUM_POOL_KEYS, pool_key_max_us);
+    printf("%s\n", failures ? "FAILED" : "OK");
+    exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+static void start_phase(phase_t next_phase){
+    phase = next_phase;
+    operations_done = 0;
+    last_tick_us = now_us();
+    switch (phase){
+        case PHASE_FIRST_KEY:
+            schedule(&start_key_generation, 0);
+            break;
+        case PHASE_RUN_LOOP:
+            btstack_crypto_ecc_p256_set_executor(NULL);
+            schedule(&start_dhkey_calculation, 0);
+            break;
+        case PHASE_EXECUTOR:
+            btstack_crypto_ecc_p256_set_executor(btstack_crypto_executor_posix_get_instance());
+            schedule(&start_dhkey_calculation, 0);
+            break;
+        case PHASE_POOL_FILL:
+            // pool gets filled by executor while idle
+            schedule(&start_phase_pool, 500);
+            break;
+        case PHASE_KEY_POOL:
+            schedule(&start_key_generation, 0);
+            break;
+        default:
+            report();
+            break;
+    }
+}
+
+static void start_phase_pool(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    start_phase(PHASE_KEY_POOL);
+}
+
+static void watchdog_handler(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    printf("Timeout in phase %s after %u operations\n", phase_names[phase], operations_done);
+    failures++;
+    report();
+}
+
+int main(void){
+
+    if (getenv("LOG")){
+        hci_dump_open(NULL, HCI_DUMP_STDOUT);
+    } else {
+        hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+    }
+
+    int i;
+    for (i=0;i<64;i++){
+        unsigned int byte;
+        sscanf(&peer_public_key_string[i*2], "%2x", &byte);
+        peer_public_key[i] = (uint8_t) byte;
+    }
+
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    btstack_crypto_init();
+
+    btstack_run_loop_set_timer_handler(&tick_timer, &tick_handler);
+    btstack_run_loop_set_timer(&tick_timer, TICK_MS);
+    btstack_run_loop_add_timer(&tick_timer);
+
+    static btstack_timer_source_t watchdog;
+    btstack_run_loop_set_timer_handler(&watchdog, &watchdog_handler);
+    btstack_run_loop_set_timer(&watchdog, 30000);
+    btstack_run_loop_add_timer(&watchdog);
+
+    start_phase(PHASE_FIRST_KEY);
+    btstack_run_loop_execute();
+    return 0;
+}
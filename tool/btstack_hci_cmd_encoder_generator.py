@@ -0,0 +1,255 @@
+#!/usr/bin/env python
+# BlueKitchen GmbH (c) 2018
+
+# Creates typed HCI Command encoders in src/hci_cmd_encoder.h from the hci_cmd_t definitions in src/hci_cmd.c
+
+import re
+import sys
+import os
+
+program_info = """
+BTstack HCI Command Encoder Generator for BTstack
+Copyright 2018, BlueKitchen GmbH
+"""
+
+copyright = """/*
+ * Copyright (C) 2018 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+"""
+
+hfile_header_begin = """
+
+/*
+ *  hci_cmd_encoder.h
+ *
+ *  @brief Typed HCI Command encoders, same output as hci_cmd_create_from_template without format string interpretation
+ *  @note  Don't edit - generated by tool/btstack_hci_cmd_encoder_generator.py
+ *
+ */
+
+#ifndef __HCI_CMD_ENCODER_H
+#define __HCI_CMD_ENCODER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "btstack_config.h"
+#include "bluetooth.h"
+#include "btstack_util.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* API_START */
+
+"""
+
+hfile_header_end = """
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __HCI_CMD_ENCODER_H
+"""
+
+encoder_template = """/**
+ * @brief Encode {cmd_name} into hci_cmd_buffer{param_docs}
+ * @return size of HCI Command packet
+ * @note: format {format}
+ */
+static inline uint16_t {fn_name}({params}){{
+    hci_cmd_buffer[0] = 0x{opcode_lo:02x};
+    hci_cmd_buffer[1] = 0x{opcode_hi:02x};
+    hci_cmd_buffer[2] = {param_len};
+{code}    return {total_len};
+}}
+
+"""
+
+ogf_values = {
+    'OGF_LINK_CONTROL'             : 0x01,
+    'OGF_LINK_POLICY'              : 0x02,
+    'OGF_CONTROLLER_BASEBAND'      : 0x03,
+    'OGF_INFORMATIONAL_PARAMETERS' : 0x04,
+    'OGF_STATUS_PARAMETERS'        : 0x05,
+    'OGF_TESTING'                  : 0x06,
+    'OGF_LE_CONTROLLER'            : 0x08,
+    'OGF_BTSTACK'                  : 0x3d,
+    'OGF_VENDOR'                   : 0x3f,
+}
+
+param_types = {
+    '1' : 'uint8_t',
+    '2' : 'uint16_t',
+    'H' : 'hci_con_handle_t',
+    '3' : 'uint32_t',
+    '4' : 'uint32_t',
+    'B' : 'const bd_addr_t',
+    'D' : 'const uint8_t *',
+    'E' : 'const uint8_t *',
+    'N' : 'const char *',
+    'P' : 'const uint8_t *',
+    'A' : 'const uint8_t *',
+    'Q' : 'const uint8_t *',
+}
+
+param_sizes = {
+    '1' : 1, '2' : 2, 'H' : 2, '3' : 3, '4' : 4, 'B' : 6, 'D' : 8, 'E' : 240, 'N' : 248, 'P' : 16, 'A' : 31, 'Q' : 32,
+}
+
+# C and C++ keywords, hci.c is compiled as C++ in unit tests
+c_keywords = ['int', 'char', 'short', 'long', 'default', 'register', 'auto', 'const', 'static', 'public', 'private', 'protected', 'new', 'delete', 'class', 'hci_cmd_buffer']
+
+def param_code(format, name, pos):
+    if format == '1':
+        return ['hci_cmd_buffer[%u] = %s;' % (pos, name)]
+    if format in '2H34':
+        return ['hci_cmd_buffer[%u] = (uint8_t) (%s%s);' % (pos + i, name, ' >> %u' % (8*i) if i else '') for i in range(param_sizes[format])]
+    if format == 'B':
+        return ['reverse_bd_addr(%s, &hci_cmd_buffer[%u]);' % (name, pos)]
+    if format in 'DEPA':
+        return ['memcpy(&hci_cmd_buffer[%u], %s, %u);' % (pos, name, param_sizes[format])]
+    if format == 'Q':
+        return ['reverse_bytes(%s, &hci_cmd_buffer[%u], 32);' % (name, pos)]
+    if format == 'N':
+        return ['uint16_t %s_len = strlen(%s);' % (name, name),
+                'if (%s_len > 248) {' % name,
+                '    %s_len = 248;' % name,
+                '}',
+                'memcpy(&hci_cmd_buffer[%u], %s, %s_len);' % (pos, name, name),
+                'memset(&hci_cmd_buffer[%u + %s_len], 0, 248 - %s_len);' % (pos, name, name)]
+    raise ValueError("unsupported format '%s'" % format)
+
+def param_names_for(cmd_name, format, comment_params):
+    names = []
+    for param in comment_params:
+        name = re.sub('[^a-z0-9_]', '_', param.lower()).strip('_')
+        if not name or name[0].isdigit() or name in c_keywords:
+            name = 'param_%s' % name
+        names.append(name)
+    if len(names) != len(format) or len(set(names)) != len(names):
+        print("%-50s format '%s' does not match params %s, using generic names" % (cmd_name, format, comment_params))
+        names = ['param_%u' % i for i in range(len(format))]
+    return names
+
+def parse_commands(path):
+    commands = []
+    conditions = []
+    comment_params = []
+    in_comment = False
+    pending = None
+    with open(path, 'rt') as fin:
+        for line in fin:
+            stripped = line.strip()
+            if stripped.startswith('/**'):
+                in_comment = True
+                comment_params = []
+            if in_comment:
+                match = re.search(r'@param\s+(\w+)', stripped)
+                if match:
+                    comment_params.append(match.group(1))
+                if '*/' in stripped:
+                    in_comment = False
+                continue
+            if stripped.startswith('#if'):
+                conditions.append(stripped)
+                continue
+            if stripped.startswith('#else'):
+                conditions[-1] = '#if !(%s)' % conditions[-1]
+                continue
+            if stripped.startswith('#endif'):
+                conditions.pop()
+                continue
+            match = re.match(r'const hci_cmd_t (\w+)\s*=', stripped)
+            if match:
+                pending = match.group(1)
+            if pending:
+                match = re.search(r'OPCODE\s*\((\w+),\s*(0x[0-9a-fA-F]+)\)\s*,\s*"([^"]*)"', stripped)
+                if match:
+                    ogf = match.group(1)
+                    ogf = int(ogf, 16) if ogf.startswith('0x') else ogf_values[ogf]
+                    opcode = int(match.group(2), 16) | (ogf << 10)
+                    commands.append((pending, opcode, match.group(3), comment_params, list(conditions)))
+                    pending = None
+                    comment_params = []
+    return commands
+
+def create_encoders(commands, gen_path):
+    with open(gen_path, 'wt') as fout:
+        fout.write(copyright)
+        fout.write(hfile_header_begin)
+        active_conditions = []
+        for cmd_name, opcode, format, comment_params, conditions in commands:
+            if '#if 0' in conditions:
+                continue
+            names = param_names_for(cmd_name, format, comment_params)
+            params = ['uint8_t * hci_cmd_buffer'] + ['%s %s' % (param_types[f], n) for f, n in zip(format, names)]
+            code = ''
+            pos = 3
+            for f, n in zip(format, names):
+                for statement in param_code(f, n, pos):
+                    code += '    %s\n' % statement
+                pos += param_sizes[f]
+            param_docs = ''.join(['\n * @param %s' % n for n in names])
+            # keep commands with same conditions in one block
+            if conditions != active_conditions:
+                for condition in active_conditions:
+                    fout.write('#endif\n\n')
+                for condition in conditions:
+                    fout.write(condition + '\n\n')
+                active_conditions = conditions
+            fout.write(encoder_template.format(cmd_name=cmd_name, param_docs=param_docs, format=format,
+                fn_name='hci_cmd_encode_' + cmd_name[4:] if cmd_name.startswith('hci_') else 'hci_cmd_encode_' + cmd_name,
+                params=', '.join(params), opcode_lo=opcode & 0xff, opcode_hi=opcode >> 8,
+                param_len=pos - 3, code=code, total_len=pos))
+        for condition in active_conditions:
+            fout.write('#endif\n')
+        fout.write(hfile_header_end)
+
+btstack_root = os.path.abspath(os.path.dirname(sys.argv[0]) + '/..')
+gen_path = btstack_root + '/src/hci_cmd_encoder.h'
+
+print(program_info)
+
+commands = parse_commands(btstack_root + '/src/hci_cmd.c')
+create_encoders(commands, gen_path)
+print('%u HCI Commands' % len(commands))
+
+# done
+print('Done!')
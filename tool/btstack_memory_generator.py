@@ -55,6 +55,7 @@ extern "C" {
 #endif
 
 #include "btstack_config.h"
+#include "btstack_memory_pool.h"
     
 // Core
 #include "hci.h"
@@ -84,6 +85,17 @@ extern "C" {
  */
 void btstack_memory_init(void);
 
+/**
+ * @brief Releases all memory allocated via slab allocator (ENABLE_MEMORY_SLAB) in bulk,
+ *        objects must not be used afterwards. Called by hci_close.
+ */
+void btstack_memory_deinit(void);
+
+/**
+ * @brief Log usage statistics of all memory pools via log_info
+ */
+void btstack_memory_dump_stats(void);
+
 /* API_END */
 """
 
@@ -107,13 +119,18 @@ cfile_header_begin = """
 
 #include "btstack_memory.h"
 #include "btstack_memory_pool.h"
+#ifdef ENABLE_MEMORY_SLAB
+#include "btstack_memory_slab.h"
+#endif
 
 #include <stdlib.h>
+#include <string.h>
 
 """
 
 header_template = """STRUCT_NAME_t * btstack_memory_STRUCT_NAME_get(void);
-void   btstack_memory_STRUCT_NAME_free(STRUCT_NAME_t *STRUCT_NAME);"""
+void   btstack_memory_STRUCT_NAME_free(STRUCT_NAME_t *STRUCT_NAME);
+void   btstack_memory_STRUCT_NAME_get_stats(btstack_memory_pool_stats_t * stats);"""
 
 code_template = """
 // MARK: STRUCT_TYPE
@@ -135,6 +152,9 @@ STRUCT_NAME_t * btstack_memory_STRUCT_NAME_get(void){
 void btstack_memory_STRUCT_NAME_free(STRUCT_NAME_t *STRUCT_NAME){
     btstack_memory_pool_free(&STRUCT_NAME_pool, STRUCT_NAME);
 }
+void btstack_memory_STRUCT_NAME_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_pool_get_stats(&STRUCT_NAME_pool, stats);
+}
 #else
 STRUCT_NAME_t * btstack_memory_STRUCT_NAME_get(void){
     return NULL;
@@ -143,21 +163,51 @@ void btstack_memory_STRUCT_NAME_free(STRUCT_NAME_t *STRUCT_NAME){
     // silence compiler warning about unused parameter in a portable way
     (void) STRUCT_NAME;
 };
+void btstack_memory_STRUCT_NAME_get_stats(btstack_memory_pool_stats_t * stats){
+    memset(stats, 0, sizeof(btstack_memory_pool_stats_t));
+}
 #endif
+#elif defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+static btstack_memory_slab_t STRUCT_NAME_slab;
+STRUCT_NAME_t * btstack_memory_STRUCT_NAME_get(void){
+    return (STRUCT_NAME_t *) btstack_memory_slab_get(&STRUCT_NAME_slab);
+}
+void btstack_memory_STRUCT_NAME_free(STRUCT_NAME_t *STRUCT_NAME){
+    btstack_memory_slab_free(&STRUCT_NAME_slab, STRUCT_NAME);
+}
+void btstack_memory_STRUCT_NAME_get_stats(btstack_memory_pool_stats_t * stats){
+    btstack_memory_slab_get_stats(&STRUCT_NAME_slab, stats);
+}
 #elif defined(HAVE_MALLOC)
+static btstack_memory_pool_stats_t STRUCT_NAME_stats;
 STRUCT_NAME_t * btstack_memory_STRUCT_NAME_get(void){
-    return (STRUCT_NAME_t*) malloc(sizeof(STRUCT_TYPE));
+    STRUCT_NAME_t * STRUCT_NAME = (STRUCT_NAME_t*) malloc(sizeof(STRUCT_TYPE));
+    btstack_memory_pool_stats_record_get(&STRUCT_NAME_stats, STRUCT_NAME);
+    return STRUCT_NAME;
 }
 void btstack_memory_STRUCT_NAME_free(STRUCT_NAME_t *STRUCT_NAME){
+    btstack_memory_pool_stats_record_free(&STRUCT_NAME_stats);
     free(STRUCT_NAME);
 }
+void btstack_memory_STRUCT_NAME_get_stats(btstack_memory_pool_stats_t * stats){
+    *stats = STRUCT_NAME_stats;
+}
 #endif
 """
 
 init_template = """#if POOL_COUNT > 0
     btstack_memory_pool_create(&STRUCT_NAME_pool, STRUCT_NAME_storage, POOL_COUNT, sizeof(STRUCT_TYPE));
+#elif !defined(POOL_COUNT) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_init(&STRUCT_NAME_slab, sizeof(STRUCT_TYPE));
+#endif"""
+
+deinit_template = """#if !defined(POOL_COUNT) && defined(HAVE_MALLOC) && defined(ENABLE_MEMORY_SLAB)
+    btstack_memory_slab_release(&STRUCT_NAME_slab);
 #endif"""
 
+stats_template = """    btstack_memory_STRUCT_NAME_get_stats(&stats);
+    btstack_memory_pool_stats_log("STRUCT_NAME", &stats);"""
+
 def writeln(f, data):
     f.write(data + "\n")
 
@@ -233,5 +283,32 @@ for struct_names in list_of_le_structs:
         writeln(f, replacePlaceholder(init_template, struct_name))
 writeln(f, "#endif")
 writeln(f, "}")
+
+writeln(f, "")
+writeln(f, "// deinit")
+writeln(f, "void btstack_memory_deinit(void){")
+for struct_names in list_of_structs:
+    for struct_name in struct_names:
+        writeln(f, replacePlaceholder(deinit_template, struct_name))
+writeln(f, "#ifdef ENABLE_BLE")
+for struct_names in list_of_le_structs:
+    for struct_name in struct_names:
+        writeln(f, replacePlaceholder(deinit_template, struct_name))
+writeln(f, "#endif")
+writeln(f, "}")
+
+writeln(f, "")
+writeln(f, "// stats")
+writeln(f, "void btstack_memory_dump_stats(void){")
+writeln(f, "    btstack_memory_pool_stats_t stats;")
+for struct_names in list_of_structs:
+    for struct_name in struct_names:
+        writeln(f, replacePlaceholder(stats_template, struct_name))
+writeln(f, "#ifdef ENABLE_BLE")
+for struct_names in list_of_le_structs:
+    for struct_name in struct_names:
+        writeln(f, replacePlaceholder(stats_template, struct_name))
+writeln(f, "#endif")
+writeln(f, "}")
 f.close();
     